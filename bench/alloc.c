@@ -0,0 +1,101 @@
+#include "bench.h"
+
+// Allocations are counted by interposing the C allocator, which captures those made by the shared library as well as
+// any made by third-party callbacks, without requiring a specially built copy of the library. This relies on the glibc
+// internal entry points, other platforms simply report that counters are unavailable.
+
+#if defined(__GLIBC__)
+
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t count, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+extern void __libc_free(void *ptr);
+
+static TMXbenchallocs counters;
+
+void *
+malloc(size_t size)
+{
+    counters.count++;
+    counters.bytes += size;
+    return __libc_malloc(size);
+}
+
+void *
+calloc(size_t count, size_t size)
+{
+    counters.count++;
+    counters.bytes += count * size;
+    return __libc_calloc(count, size);
+}
+
+void *
+realloc(void *ptr, size_t size)
+{
+    if (size)
+    {
+        counters.count++;
+        counters.bytes += size;
+    }
+    return __libc_realloc(ptr, size);
+}
+
+void
+free(void *ptr)
+{
+    __libc_free(ptr);
+}
+
+TMX_BOOL
+tmxBenchAllocCounters(TMXbenchallocs *result)
+{
+    *result = counters;
+    return TMX_TRUE;
+}
+
+#else
+
+TMX_BOOL
+tmxBenchAllocCounters(TMXbenchallocs *result)
+{
+    memset(result, 0, sizeof(TMXbenchallocs));
+    return TMX_FALSE;
+}
+
+#endif
+
+void
+tmxBenchResetPeakRss(void)
+{
+#if defined(__linux__)
+    // Writing "5" to clear_refs resets the peak RSS (VmHWM) to the current RSS (Linux 4.0+).
+    FILE *fp = fopen("/proc/self/clear_refs", "w");
+    if (fp)
+    {
+        fputs("5", fp);
+        fclose(fp);
+    }
+#endif
+}
+
+long
+tmxBenchPeakRss(void)
+{
+    long result = -1;
+#if defined(__linux__)
+    char line[256];
+    FILE *fp = fopen("/proc/self/status", "r");
+    if (!fp)
+        return -1;
+    while (fgets(line, sizeof(line), fp))
+    {
+        if (!strncmp(line, "VmHWM:", 6))
+        {
+            result = strtol(line + 6, NULL, 10);
+            break;
+        }
+    }
+    fclose(fp);
+#endif
+    return result;
+}
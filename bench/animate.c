@@ -0,0 +1,260 @@
+#include "bench.h"
+#include "tmx/animation.h"
+#include <math.h>
+
+/**
+ * @brief The time between updates, in milliseconds, as when updating at 60 frames per second.
+ */
+#define TMX_ANIMATE_FRAME_TIME (1000.0 / 60.0)
+
+/**
+ * @brief A dense copy of the tiles of a layer over the rectangle containing all of its chunks.
+ */
+typedef struct TMXanimategrid
+{
+    TMXrect bounds;
+    TMXgid *gids;
+} TMXanimategrid;
+
+static TMX_BOOL
+tmxAnimateGridInit(TMXanimategrid *grid, const TMXlayer *layer)
+{
+    size_t i;
+    int y;
+
+    grid->bounds = (TMXrect){.x = 0, .y = 0, .w = layer->size.w, .h = layer->size.h};
+    if (layer->type == TMX_LAYER_CHUNK)
+    {
+        for (i = 0; i < layer->count; i++)
+        {
+            const TMXrect *b = &layer->data.chunks[i].bounds;
+            grid->bounds.x   = TMX_MIN(grid->bounds.x, b->x);
+            grid->bounds.y   = TMX_MIN(grid->bounds.y, b->y);
+            grid->bounds.w   = TMX_MAX(grid->bounds.w, b->x + b->w - grid->bounds.x);
+            grid->bounds.h   = TMX_MAX(grid->bounds.h, b->y + b->h - grid->bounds.y);
+        }
+    }
+
+    grid->gids = calloc((size_t) grid->bounds.w * (size_t) grid->bounds.h, sizeof(TMXgid));
+    if (!grid->gids)
+        return TMX_FALSE;
+
+    if (layer->type == TMX_LAYER_TILE)
+    {
+        memcpy(grid->gids, layer->data.tiles, (size_t) layer->size.w * (size_t) layer->size.h * sizeof(TMXgid));
+        return TMX_TRUE;
+    }
+    for (i = 0; i < layer->count; i++)
+    {
+        const TMXchunk *chunk = &layer->data.chunks[i];
+        for (y = 0; y < chunk->bounds.h; y++)
+        {
+            size_t row = (size_t) (chunk->bounds.y - grid->bounds.y + y) * (size_t) grid->bounds.w + (size_t) (chunk->bounds.x - grid->bounds.x);
+            memcpy(&grid->gids[row], &chunk->gids[y * chunk->bounds.w], (size_t) chunk->bounds.w * sizeof(TMXgid));
+        }
+    }
+    return TMX_TRUE;
+}
+
+static TMX_INLINE TMXgid *
+tmxAnimateGridCell(const TMXanimategrid *grid, TMXpoint position)
+{
+    if (position.x < grid->bounds.x || position.y < grid->bounds.y || position.x >= grid->bounds.x + grid->bounds.w ||
+        position.y >= grid->bounds.y + grid->bounds.h)
+        return NULL;
+    return &grid->gids[(size_t) (position.y - grid->bounds.y) * (size_t) grid->bounds.w + (size_t) (position.x - grid->bounds.x)];
+}
+
+/**
+ * @brief Computes the GID displayed by a cell at a time, independently of the animator, or 0 if the tile is not animated.
+ */
+static TMXgid
+tmxAnimateReference(const TMXmap *map, TMXgid gid, double time)
+{
+    TMXtid id;
+    TMXtileset *tileset = tmxMapTileset(map, gid, &id);
+    const TMXtile *tile = NULL;
+    size_t i;
+
+    if (tileset && tileset->columns > 0 && id < tileset->tile_count)
+        tile = &tileset->tiles[id];
+    for (i = 0; tileset && tileset->columns <= 0 && i < tileset->tile_count && !tile; i++)
+    {
+        if (tileset->tiles[i].id == id)
+            tile = &tileset->tiles[i];
+    }
+    if (!tile || !tile->animation.count)
+        return 0;
+
+    const TMXanimation *animation = &tile->animation;
+    double period                 = 0.0;
+    for (i = 0; i < animation->count; i++)
+        period += animation->frames[i].duration;
+
+    double t = period > 0.0 ? fmod(time, period) : 0.0;
+    for (i = 0; i + 1 < animation->count && t >= animation->frames[i].duration; i++)
+        t -= animation->frames[i].duration;
+
+    return (gid & TMX_GID_FLAG_MASK) | ((gid & TMX_GID_TILE_MASK) - id + animation->frames[i].id);
+}
+
+/**
+ * @brief Updates an animator over a series of uneven steps, and compares the displayed tiles against the reference.
+ */
+static int
+tmxAnimateVerify(const TMXmap *map, const TMXlayer *layer, TMXanimator *animator, uint64_t seed)
+{
+    TMXanimategrid source, display;
+    const TMXanimcell *cells;
+    size_t i, count, step, animated = 0, errors = 0;
+    uint64_t state = seed ? seed : 1;
+    double time    = 0.0;
+
+    if (!tmxAnimateGridInit(&source, layer) || !tmxAnimateGridInit(&display, layer))
+    {
+        free(source.gids);
+        return 0;
+    }
+
+    count = tmxAnimatorCells(animator, &cells);
+    for (i = 0; i < count; i++)
+    {
+        TMXgid *cell = tmxAnimateGridCell(&display, cells[i].position);
+        if (cell)
+            *cell = cells[i].gid;
+        else
+            errors++;
+    }
+
+    // Steps include zero, short, frame-length, and multi-period jumps.
+    for (step = 0; step < 64 && !errors; step++)
+    {
+        double delta = (double) (tmxBenchRandom(&state) % 4) * (double) (tmxBenchRandom(&state) % 160);
+        if (step % 16 == 15)
+            delta = 12345.0;
+        time += delta;
+
+        count = tmxAnimatorAdvance(animator, delta, &cells);
+        for (i = 0; i < count; i++)
+        {
+            TMXgid *cell = tmxAnimateGridCell(&display, cells[i].position);
+            if (!cell || *cell == cells[i].gid)
+                errors++;
+            else
+                *cell = cells[i].gid;
+        }
+
+        animated = 0;
+        for (i = 0; i < (size_t) source.bounds.w * (size_t) source.bounds.h; i++)
+        {
+            TMXgid expected = tmxAnimateReference(map, source.gids[i], time);
+            animated += expected != 0;
+            if (display.gids[i] != (expected ? expected : source.gids[i]))
+                errors++;
+        }
+    }
+
+    if (tmxAnimatorCells(animator, &cells) != animated)
+        errors++;
+    tmxAnimatorReset(animator);
+
+    if (errors)
+        fprintf(stderr, "animate: %s layer displayed %zu incorrect tiles\n", layer->type == TMX_LAYER_CHUNK ? "infinite" : "finite",
+                errors);
+    free(source.gids);
+    free(display.gids);
+    return errors == 0;
+}
+
+/**
+ * @brief Measures the baseline of finding the changed cells by scanning the whole layer, as without an animator.
+ */
+static double
+tmxAnimateScan(const TMXmap *map, const TMXanimategrid *grid, double time, size_t *changes)
+{
+    size_t i, count = (size_t) grid->bounds.w * (size_t) grid->bounds.h;
+    double start = tmxBenchNow();
+
+    *changes = 0;
+    for (i = 0; i < count; i++)
+    {
+        TMXgid before = tmxAnimateReference(map, grid->gids[i], time);
+        *changes += before != tmxAnimateReference(map, grid->gids[i], time + TMX_ANIMATE_FRAME_TIME);
+    }
+    return tmxBenchNow() - start;
+}
+
+static int
+tmxAnimateMeasure(TMXmap *map, const TMXbenchopts *opts)
+{
+    const TMXlayer *layer = map->layers[0];
+    const TMXanimcell *changes;
+    TMXanimategrid grid;
+    size_t n, cells, updates = 0, changed = 0, scanChanges;
+    double start, create, elapsed = 0.0;
+
+    start                 = tmxBenchNow();
+    TMXanimator *animator = tmxAnimatorCreate(map, layer);
+    create                = tmxBenchNow() - start;
+    if (!animator || !tmxAnimateVerify(map, layer, animator, opts->seed) || !tmxAnimateGridInit(&grid, layer))
+    {
+        tmxFreeAnimator(animator);
+        return 0;
+    }
+    cells = tmxAnimatorCells(animator, &changes);
+
+    for (n = 0; n < opts->iterations || (!opts->iterations && elapsed < opts->minSeconds); n++)
+    {
+        start = tmxBenchNow();
+        changed += tmxAnimatorAdvance(animator, TMX_ANIMATE_FRAME_TIME, &changes);
+        elapsed += tmxBenchNow() - start;
+        updates++;
+    }
+    double scan = tmxAnimateScan(map, &grid, 0.0, &scanChanges);
+
+    printf("{\"bench\":\"animate\",\"infinite\":%s,\"width\":%d,\"height\":%d,\"animated_cells\":%zu,\"create_ms\":%.3f,"
+           "\"updates\":%zu,\"changes_per_update\":%.1f,\"us_per_update\":%.3f,\"ns_per_change\":%.2f,\"scan_us\":%.3f}\n",
+           layer->type == TMX_LAYER_CHUNK ? "true" : "false", map->size.w, map->size.h, cells, create * 1e3, updates,
+           (double) changed / (double) updates, elapsed / (double) updates * 1e6, changed ? elapsed / (double) changed * 1e9 : 0.0,
+           scan * 1e6);
+
+    free(grid.gids);
+    tmxFreeAnimator(animator);
+    return 1;
+}
+
+int
+tmxBenchAnimate(int argc, char *argv[], const TMXbenchopts *opts)
+{
+    TMXmapspec spec = {0};
+    size_t s;
+    int inf, ok = 1;
+    (void) argc;
+    (void) argv;
+
+    spec.format      = TMX_FORMAT_XML;
+    spec.encoding    = TMX_ENCODING_BASE64;
+    spec.compression = TMX_COMPRESSION_ZLIB;
+    spec.tileLayers  = 1;
+    spec.seed        = opts->seed;
+
+    for (s = 0; s < opts->sizeCount; s++)
+    {
+        for (inf = 0; inf < 2; inf++)
+        {
+            spec.size     = opts->sizes[s];
+            spec.infinite = inf;
+            TMXmap *map   = tmxBenchLoadGenerated(&spec);
+            if (!map || !map->layer_count)
+            {
+                fprintf(stderr, "animate: failed to load a generated map\n");
+                tmxFreeMap(map);
+                return 1;
+            }
+
+            ok &= tmxAnimateMeasure(map, opts);
+            tmxFreeMap(map);
+        }
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,291 @@
+#include "bench.h"
+#include "tmx/coords.h"
+#include "tmx/quads.h"
+#include <math.h>
+
+/**
+ * @brief A layout to bake the generated maps with, which are applied to the map after loading.
+ */
+typedef struct TMXbakecase
+{
+    const char *name;
+    TMX_ORIENTATION orientation;
+    TMX_RENDER_ORDER renderOrder;
+    TMX_AXIS axis;
+    TMX_INDEX index;
+    int hexSide;
+} TMXbakecase;
+
+static const TMXbakecase cases[] = {
+    {"orthogonal-right-down", TMX_ORIENTATION_ORTHOGONAL, TMX_RENDER_RIGHT_DOWN, TMX_AXIS_Y, TMX_INDEX_ODD, 0},
+    {"orthogonal-left-up", TMX_ORIENTATION_ORTHOGONAL, TMX_RENDER_LEFT_UP, TMX_AXIS_Y, TMX_INDEX_ODD, 0},
+    {"isometric", TMX_ORIENTATION_ISOMETRIC, TMX_RENDER_RIGHT_DOWN, TMX_AXIS_Y, TMX_INDEX_ODD, 0},
+    {"staggered-y-odd", TMX_ORIENTATION_STAGGERED, TMX_RENDER_RIGHT_DOWN, TMX_AXIS_Y, TMX_INDEX_ODD, 0},
+    {"staggered-x-even", TMX_ORIENTATION_STAGGERED, TMX_RENDER_RIGHT_DOWN, TMX_AXIS_X, TMX_INDEX_EVEN, 0},
+    {"hexagonal-y-even", TMX_ORIENTATION_HEXAGONAL, TMX_RENDER_RIGHT_DOWN, TMX_AXIS_Y, TMX_INDEX_EVEN, 8},
+    {"hexagonal-x-odd", TMX_ORIENTATION_HEXAGONAL, TMX_RENDER_RIGHT_DOWN, TMX_AXIS_X, TMX_INDEX_ODD, 8},
+};
+
+static TMXgid
+tmxBakeCellGid(const TMXlayer *layer, int x, int y)
+{
+    size_t i;
+    if (layer->type == TMX_LAYER_TILE)
+    {
+        if (x < 0 || y < 0 || x >= layer->size.w || y >= layer->size.h)
+            return 0;
+        return layer->data.tiles[y * layer->size.w + x];
+    }
+
+    for (i = 0; i < layer->count; i++)
+    {
+        const TMXrect *b = &layer->data.chunks[i].bounds;
+        if (x >= b->x && y >= b->y && x < b->x + b->w && y < b->y + b->h)
+            return layer->data.chunks[i].gids[(y - b->y) * b->w + (x - b->x)];
+    }
+    return 0;
+}
+
+/**
+ * @brief Gives every non-empty cell of a layer one of the 16 combinations of the flip and rotation flags, so that each
+ * is baked in every layout.
+ */
+static void
+tmxBakeFlags(TMXlayer *layer)
+{
+    size_t chunks = layer->type == TMX_LAYER_CHUNK ? layer->count : 1, i, k;
+    for (i = 0; i < chunks; i++)
+    {
+        TMXgid *gids = layer->type == TMX_LAYER_CHUNK ? layer->data.chunks[i].gids : layer->data.tiles;
+        size_t count = layer->type == TMX_LAYER_CHUNK ? layer->data.chunks[i].count : (size_t) layer->size.w * (size_t) layer->size.h;
+        for (k = 0; gids && k < count; k++)
+        {
+            if (gids[k] & TMX_GID_TILE_MASK)
+                gids[k] = (gids[k] & TMX_GID_TILE_MASK) | ((TMXgid) ((k * 7 + k / 16) % 16) << 28);
+        }
+    }
+}
+
+/**
+ * @brief Checks the texture coordinates and shape of a quad against the source rectangle of its tile and its flags.
+ *
+ * @details Tiled applies the diagonal flip first and then the horizontal and vertical flips, so each corner of the quad
+ * samples the texture where undoing them in reverse order leads. On hexagonal maps the diagonal flag and
+ * @ref TMX_GID_ROTATE_120 instead rotate the upright quad clockwise by 60 and 120 degrees around its center.
+ */
+static TMX_BOOL
+tmxBakeVerifyQuad(const TMXmap *map, const TMXvertex *quad, TMXgid gid)
+{
+    static const float corners[4][2] = {{0.0f, 0.0f}, {1.0f, 0.0f}, {1.0f, 1.0f}, {0.0f, 1.0f}};
+    TMX_BOOL hexagonal = map->orientation == TMX_ORIENTATION_HEXAGONAL;
+    TMX_BOOL diagonal  = (gid & TMX_GID_FLIP_DIAGONAL) != 0;
+    TMXtid id;
+    int i;
+
+    const TMXtileset *tileset = tmxMapTileset(map, gid, &id);
+    const TMXtilerects *rects = tileset->rects;
+    float width               = (float) rects->width[id];
+    float height              = (float) rects->height[id];
+    double angle              = 0.0;
+    if (hexagonal)
+        angle = ((diagonal ? 60.0 : 0.0) + (gid & TMX_GID_ROTATE_120 ? 120.0 : 0.0)) * 3.14159265358979323846 / 180.0;
+    else if (diagonal)
+        width = (float) rects->height[id], height = (float) rects->width[id];
+
+    float cx = (quad[0].x + quad[2].x) * 0.5f, cy = (quad[0].y + quad[2].y) * 0.5f;
+    for (i = 0; i < 4; i++)
+    {
+        float s = corners[i][0], t = corners[i][1], swap;
+        if (gid & TMX_GID_FLIP_VERTICAL)
+            t = 1.0f - t;
+        if (gid & TMX_GID_FLIP_HORIZONTAL)
+            s = 1.0f - s;
+        if (diagonal && !hexagonal)
+            swap = s, s = t, t = swap;
+        if (quad[i].u != (s ? rects->u1[id] : rects->u0[id]) || quad[i].v != (t ? rects->v1[id] : rects->v0[id]))
+            return TMX_FALSE;
+
+        // Generated tilesets are drawn at the size of their tiles, which is the size of the grid.
+        float dx = (corners[i][0] - 0.5f) * width, dy = (corners[i][1] - 0.5f) * height;
+        float ex = cx + (float) (dx * cos(angle) - dy * sin(angle));
+        float ey = cy + (float) (dx * sin(angle) + dy * cos(angle));
+        if (fabsf(quad[i].x - ex) > 0.01f || fabsf(quad[i].y - ey) > 0.01f)
+            return TMX_FALSE;
+    }
+    return TMX_TRUE;
+}
+
+/**
+ * @brief Verifies a baked layer: every non-empty cell has exactly one quad centered on it, quads are in draw order, and
+ * each has the texture coordinates and shape of its flipped or rotated tile.
+ */
+static int
+tmxBakeVerify(const TMXbakecase *c, const TMXmap *map, const TMXlayer *layer, const TMXquadmesh *mesh)
+{
+    TMXrect bounds = {.x = 0, .y = 0, .w = layer->size.w, .h = layer->size.h};
+    size_t i, expected = 0, ranged = 0, errors = 0, textured = 0;
+    int x, y;
+
+    if (layer->type == TMX_LAYER_CHUNK)
+    {
+        for (i = 0; i < layer->count; i++)
+        {
+            const TMXrect *b = &layer->data.chunks[i].bounds;
+            bounds.x         = TMX_MIN(bounds.x, b->x);
+            bounds.y         = TMX_MIN(bounds.y, b->y);
+            bounds.w         = TMX_MAX(bounds.w, b->x + b->w - bounds.x);
+            bounds.h         = TMX_MAX(bounds.h, b->y + b->h - bounds.y);
+        }
+    }
+
+    for (y = bounds.y; y < bounds.y + bounds.h; y++)
+    {
+        for (x = bounds.x; x < bounds.x + bounds.w; x++)
+            expected += tmxMapTileset(map, tmxBakeCellGid(layer, x, y), NULL) != NULL;
+    }
+    for (i = 0; i < mesh->range_count; i++)
+    {
+        if (mesh->ranges[i].first != ranged)
+            errors++;
+        ranged += mesh->ranges[i].count;
+    }
+    if (expected != mesh->quad_count || ranged != mesh->quad_count)
+    {
+        fprintf(stderr, "bake: %s produced %zu quads (%zu in ranges) for %zu tiles\n", c->name, mesh->quad_count, ranged, expected);
+        return 0;
+    }
+
+    uint8_t *seen = calloc((size_t) bounds.w * (size_t) bounds.h, 1);
+    TMXvec2 previous = {0.0f, 0.0f};
+    for (i = 0; i < mesh->quad_count; i++)
+    {
+        const TMXvertex *quad = &mesh->vertices[i * 4];
+        TMXvec2 center        = {(quad[0].x + quad[2].x) * 0.5f, (quad[0].y + quad[2].y) * 0.5f};
+        TMXpoint cell         = tmxPixelToTile(map, center);
+        size_t index          = (size_t) (cell.y - bounds.y) * (size_t) bounds.w + (size_t) (cell.x - bounds.x);
+
+        if (cell.x < bounds.x || cell.y < bounds.y || cell.x >= bounds.x + bounds.w || cell.y >= bounds.y + bounds.h ||
+            seen[index]++ || !tmxMapTileset(map, tmxBakeCellGid(layer, cell.x, cell.y), NULL))
+        {
+            errors++;
+            continue;
+        }
+        if (!tmxBakeVerifyQuad(map, quad, tmxBakeCellGid(layer, cell.x, cell.y)))
+            textured++;
+
+        // Rows are drawn in order along the y-axis, and orthogonal maps also follow the render order within a row.
+        if (i > 0 && layer->type == TMX_LAYER_TILE)
+        {
+            TMX_BOOL up   = map->render_order == TMX_RENDER_RIGHT_UP || map->render_order == TMX_RENDER_LEFT_UP;
+            TMX_BOOL left = map->render_order == TMX_RENDER_LEFT_DOWN || map->render_order == TMX_RENDER_LEFT_UP;
+            float dy      = up && map->orientation == TMX_ORIENTATION_ORTHOGONAL ? previous.y - center.y : center.y - previous.y;
+            if (dy < 0.0f)
+                errors++;
+            else if (dy == 0.0f && map->orientation == TMX_ORIENTATION_ORTHOGONAL && (left ? center.x > previous.x : center.x < previous.x))
+                errors++;
+        }
+        previous = center;
+    }
+    free(seen);
+
+    if (errors)
+        fprintf(stderr, "bake: %s produced %zu misplaced quads\n", c->name, errors);
+    if (textured)
+        fprintf(stderr, "bake: %s produced %zu quads with the wrong texture coordinates or rotation\n", c->name, textured);
+    return errors == 0 && textured == 0;
+}
+
+static void
+tmxBakeApply(TMXmap *map, const TMXbakecase *c)
+{
+    map->orientation   = c->orientation;
+    map->render_order  = c->renderOrder;
+    map->stagger.axis  = c->axis;
+    map->stagger.index = c->index;
+    map->hex_side      = c->hexSide;
+}
+
+static int
+tmxBakeMeasure(const TMXbakecase *c, TMXmap *map, const TMXbenchopts *opts)
+{
+    const TMXlayer *layer = map->layers[0];
+    TMXquadmesh *mesh     = tmxQuadMeshCreate();
+    size_t i, n, iterations = 0;
+    double start, elapsed = 0.0;
+    int ok;
+
+    tmxBakeApply(map, c);
+    ok = tmxBakeLayer(map, layer, mesh) && tmxBakeVerify(c, map, layer, mesh);
+    if (!ok)
+    {
+        tmxFreeQuadMesh(mesh);
+        return 0;
+    }
+
+    // Infinite layers are rebaked a chunk at a time into the same mesh, as when updating modified chunks each frame.
+    for (n = 0; n < opts->iterations || (!opts->iterations && elapsed < opts->minSeconds); n++)
+    {
+        start = tmxBenchNow();
+        if (layer->type == TMX_LAYER_CHUNK)
+        {
+            for (i = 0; i < layer->count; i++)
+                tmxBakeChunk(map, layer, i, mesh);
+        }
+        else
+        {
+            tmxBakeLayer(map, layer, mesh);
+        }
+        elapsed += tmxBenchNow() - start;
+        iterations++;
+    }
+
+    tmxBakeLayer(map, layer, mesh);
+    printf("{\"bench\":\"bake\",\"layout\":\"%s\",\"infinite\":%s,\"width\":%d,\"height\":%d,\"quads\":%zu,\"ranges\":%zu,"
+           "\"iterations\":%zu,\"seconds\":%.6f,\"mquads_per_s\":%.2f",
+           c->name, layer->type == TMX_LAYER_CHUNK ? "true" : "false", map->size.w, map->size.h, mesh->quad_count, mesh->range_count,
+           iterations, elapsed, (double) mesh->quad_count * (double) iterations / elapsed / 1e6);
+    if (layer->type == TMX_LAYER_CHUNK)
+        printf(",\"chunks\":%zu,\"us_per_chunk\":%.3f", layer->count, elapsed / (double) iterations / (double) layer->count * 1e6);
+    printf("}\n");
+
+    tmxFreeQuadMesh(mesh);
+    return 1;
+}
+
+int
+tmxBenchBake(int argc, char *argv[], const TMXbenchopts *opts)
+{
+    TMXmapspec spec = {0};
+    size_t s, k;
+    int inf, ok = 1;
+    (void) argc;
+    (void) argv;
+
+    spec.format      = TMX_FORMAT_XML;
+    spec.encoding    = TMX_ENCODING_BASE64;
+    spec.compression = TMX_COMPRESSION_ZLIB;
+    spec.tileLayers  = 1;
+    spec.seed        = opts->seed;
+
+    for (s = 0; s < opts->sizeCount; s++)
+    {
+        for (inf = 0; inf < 2; inf++)
+        {
+            spec.size     = opts->sizes[s];
+            spec.infinite = inf;
+            TMXmap *map   = tmxBenchLoadGenerated(&spec);
+            if (!map || !map->layer_count)
+            {
+                fprintf(stderr, "bake: failed to load a generated map\n");
+                tmxFreeMap(map);
+                return 1;
+            }
+
+            tmxBakeFlags(map->layers[0]);
+            for (k = 0; k < sizeof(cases) / sizeof(cases[0]); k++)
+                ok &= tmxBakeMeasure(&cases[k], map, opts);
+            tmxFreeMap(map);
+        }
+    }
+    return ok ? 0 : 1;
+}
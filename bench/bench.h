@@ -0,0 +1,210 @@
+/**
+ * @file bench.h
+ * @brief Shared helpers for the tmx_bench benchmark tool.
+ * @version 0.1
+ *
+ * @details Results are written to stdout as JSON lines (one object per measurement), so that they can be collected and
+ * compared across builds with standard tools.
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#ifndef TMX_BENCH_H
+#define TMX_BENCH_H
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "tmx.h"
+
+/**
+ * @brief Common options parsed from the command line, shared by all benchmarks.
+ */
+typedef struct TMXbenchopts
+{
+    double minSeconds;   /** The minimum time to spend on each measurement, used when @a iterations is 0. */
+    size_t iterations;   /** A fixed number of iterations to run each measurement, or 0 to calibrate by time. */
+    uint64_t seed;       /** The seed for generated data. */
+    const int *sizes;    /** Array of square map dimensions (in tiles) to measure. */
+    size_t sizeCount;    /** The number of elements in @a sizes. */
+} TMXbenchopts;
+
+/**
+ * @brief Describes a map for the generator to write.
+ */
+typedef struct TMXmapspec
+{
+    TMX_FORMAT format;           /** The document format, either XML or JSON. */
+    TMX_ENCODING encoding;       /** The encoding of tile layer data. @ref TMX_ENCODING_NONE is only valid for XML. */
+    TMX_COMPRESSION compression; /** The compression of tile layer data. Only applicable to Base64 encoding. */
+    int size;                    /** The width and height of the map, in tiles. */
+    TMX_BOOL infinite;           /** Flag indicating if tile data is written as 16x16 chunks. */
+    int tileLayers;              /** The number of tile layers. */
+    int objectCount;             /** The number of objects in the object layer, or 0 to omit the layer. */
+    TMX_BOOL externalTileset;    /** Flag indicating if the tileset is written to a separate file. */
+    uint64_t seed;               /** The seed for the generator. The same spec always produces identical output. */
+    int occupancy;               /** The percentage of 16x16 chunks with tiles, or 0 for all of them, or two thirds if infinite. */
+} TMXmapspec;
+
+/**
+ * @brief Allocation counters, see @ref tmxBenchAllocCounters.
+ */
+typedef struct TMXbenchallocs
+{
+    size_t count; /** The number of allocations (including reallocations). */
+    size_t bytes; /** The total number of bytes requested. */
+} TMXbenchallocs;
+
+/**
+ * @brief Retrieves a monotonic timestamp, in seconds.
+ */
+static inline double
+tmxBenchNow(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec + (double) ts.tv_nsec * 1e-9;
+}
+
+/**
+ * @brief Deterministic pseudo-random generator (xorshift64*), so that generated data is identical across runs and hosts.
+ */
+static inline uint32_t
+tmxBenchRandom(uint64_t *state)
+{
+    uint64_t x = *state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *state = x;
+    return (uint32_t) ((x * 0x2545F4914F6CDD1DULL) >> 32);
+}
+
+/**
+ * @brief Fills a buffer with tile data resembling a hand-made layer: runs of a few common tiles, scattered detail tiles,
+ * occasional flip flags, and empty areas.
+ *
+ * @param[out] gids The buffer to fill, with room for @a count elements.
+ * @param[in] count The number of tiles to generate.
+ * @param[in] seed The seed for the generator.
+ */
+void tmxBenchTileData(uint32_t *gids, size_t count, uint64_t seed);
+
+/**
+ * @brief Writes @a gids in the little-endian byte order used by TMX documents.
+ */
+void tmxBenchStoreLE(uint8_t *output, const uint32_t *gids, size_t count);
+
+/**
+ * @brief Compresses @a data with the specified method, returning a buffer that must be freed with @c free.
+ *
+ * @details Gzip and Zlib use miniz at the given @a level. Zstandard output consists of raw blocks, as only the decoder is
+ * available. @ref TMX_COMPRESSION_NONE returns a copy.
+ */
+uint8_t *tmxBenchCompress(TMX_COMPRESSION compression, const uint8_t *data, size_t size, int level, size_t *outSize);
+
+/**
+ * @brief Decompresses Zlib data with miniz directly, as a reference for comparing the library backend against.
+ */
+size_t tmxBenchZlibReference(const void *input, size_t inputSize, void *output, size_t outputSize);
+
+/**
+ * @brief Tests whether the combination of format, encoding and compression in @a spec is valid for a TMX document.
+ */
+TMX_BOOL tmxBenchSpecValid(const TMXmapspec *spec);
+
+/**
+ * @brief Writes a short, unique name for @a spec (i.e. "xml-base64-zlib-256-inf-ext") into @a buffer.
+ */
+void tmxBenchSpecName(const TMXmapspec *spec, char *buffer, size_t bufferSize);
+
+/**
+ * @brief Writes the map (and tileset, if external) described by @a spec into @a directory.
+ *
+ * @param[in] spec Describes the map to write.
+ * @param[in] directory An existing directory to write the files into.
+ * @param[out] path A buffer to receive the path of the written map file.
+ * @param[in] pathSize The size of the @a path buffer.
+ *
+ * @return The size of the map file in bytes, or 0 on failure.
+ */
+size_t tmxBenchGenerate(const TMXmapspec *spec, const char *directory, char *path, size_t pathSize);
+
+/**
+ * @brief Generates the map described by @a spec into a temporary directory and loads it, removing the files afterwards.
+ *
+ * @return The map, which must be freed with @ref tmxFreeMap, or @c NULL on failure.
+ */
+TMXmap *tmxBenchLoadGenerated(const TMXmapspec *spec);
+
+/**
+ * @brief Callback prototype for measuring a single tile or chunk layer, see @ref tmxBenchLayers.
+ *
+ * @return Non-zero on success, or 0 if the measurement failed its verification.
+ */
+typedef int (*TMXbenchlayerfunc)(const char *source, const TMXlayer *layer, const TMXbenchopts *opts);
+
+/**
+ * @brief Measures every tile and chunk layer of the maps given on the command line, or otherwise of a finite and an
+ * infinite map generated from @a spec for each size in @a opts.
+ *
+ * @param[in] command The name of the command, which prefixes error messages.
+ * @param[in] spec The map to generate, with its size and whether it is infinite set for each map.
+ * @param[in] measure The function to invoke for each layer, with the path of the map or the name of the @a spec.
+ *
+ * @return The exit code of the command.
+ */
+int tmxBenchLayers(const char *command, int argc, char *argv[], const TMXmapspec *spec, const TMXbenchopts *opts,
+                   TMXbenchlayerfunc measure);
+
+/**
+ * @brief Copies the cells of a layer into a row-major array of GIDs over @a region, which contains every chunk of an
+ * infinite layer, as a reference to compare other storage against. Cells outside of any chunk are empty.
+ */
+void tmxBenchDenseLayer(const TMXlayer *layer, TMXrect region, TMXgid *gids);
+
+/**
+ * @brief Retrieves the allocation counters, which track every allocation made by the process (including the library).
+ *
+ * @return @ref TMX_FALSE if allocations cannot be tracked on this platform.
+ */
+TMX_BOOL tmxBenchAllocCounters(TMXbenchallocs *counters);
+
+/**
+ * @brief Resets the peak resident set size of the process, where supported, so that it may be measured per phase.
+ */
+void tmxBenchResetPeakRss(void);
+
+/**
+ * @brief Retrieves the peak resident set size of the process since the last reset (or process start), in kilobytes.
+ */
+long tmxBenchPeakRss(void);
+
+int tmxBenchAnimate(int argc, char *argv[], const TMXbenchopts *opts);
+int tmxBenchBake(int argc, char *argv[], const TMXbenchopts *opts);
+int tmxBenchBlocked(int argc, char *argv[], const TMXbenchopts *opts);
+int tmxBenchColliders(int argc, char *argv[], const TMXbenchopts *opts);
+int tmxBenchCompact(int argc, char *argv[], const TMXbenchopts *opts);
+int tmxBenchCoords(int argc, char *argv[], const TMXbenchopts *opts);
+int tmxBenchCull(int argc, char *argv[], const TMXbenchopts *opts);
+int tmxBenchDistance(int argc, char *argv[], const TMXbenchopts *opts);
+int tmxBenchFlatten(int argc, char *argv[], const TMXbenchopts *opts);
+int tmxBenchGrids(int argc, char *argv[], const TMXbenchopts *opts);
+int tmxBenchInflate(int argc, char *argv[], const TMXbenchopts *opts);
+int tmxBenchObjects(int argc, char *argv[], const TMXbenchopts *opts);
+int tmxBenchGenerateCommand(int argc, char *argv[], const TMXbenchopts *opts);
+int tmxBenchPaths(int argc, char *argv[], const TMXbenchopts *opts);
+int tmxBenchRaycast(int argc, char *argv[], const TMXbenchopts *opts);
+int tmxBenchRegions(int argc, char *argv[], const TMXbenchopts *opts);
+int tmxBenchSparse(int argc, char *argv[], const TMXbenchopts *opts);
+int tmxBenchTilesets(int argc, char *argv[], const TMXbenchopts *opts);
+int tmxBenchOccupancy(int argc, char *argv[], const TMXbenchopts *opts);
+int tmxBenchLoad(int argc, char *argv[], const TMXbenchopts *opts);
+
+#endif /* TMX_BENCH_H */
@@ -0,0 +1,326 @@
+#include "bench.h"
+#include "tmx/blocked.h"
+
+/**
+ * @brief The number of random cells whose neighborhood is read, and of steps taken by the random walks.
+ */
+#define TMX_BLOCKED_SAMPLES 1000000
+
+/**
+ * @brief The number of steps of each random walk, between jumps to a random cell.
+ */
+#define TMX_BLOCKED_WALK 256
+
+typedef struct TMXblockedlayout
+{
+    const char *name;
+    int size;
+    TMX_BLOCKED_ORDER order;
+} TMXblockedlayout;
+
+static const TMXblockedlayout tmxBlockedLayouts[] = {
+    {"rows8", 8, TMX_BLOCKED_ROWS},     {"rows32", 32, TMX_BLOCKED_ROWS},     {"rows64", 64, TMX_BLOCKED_ROWS},
+    {"morton32", 32, TMX_BLOCKED_MORTON}, {"morton64", 64, TMX_BLOCKED_MORTON}, {"morton256", 256, TMX_BLOCKED_MORTON},
+};
+
+/**
+ * @brief Reads a cell of a row-major array, with cells outside of it empty, for comparison with @ref tmxBlockedGet.
+ */
+static inline TMXgid
+tmxBlockedDenseGet(const TMXgid *gids, TMXrect region, int x, int y)
+{
+    if (x < region.x || y < region.y || x >= region.x + region.w || y >= region.y + region.h)
+        return 0;
+    return gids[(size_t) (y - region.y) * (size_t) region.w + (size_t) (x - region.x)];
+}
+
+/**
+ * @brief Reads the 3x3 neighborhood of a cell of a row-major array, in the same way as @ref tmxBlockedNeighborhood.
+ */
+static inline void
+tmxBlockedDenseNeighborhood(const TMXgid *gids, TMXrect region, int x, int y, TMXgid output[9])
+{
+    int dx, dy;
+    if (x > region.x && y > region.y && x < region.x + region.w - 1 && y < region.y + region.h - 1)
+    {
+        const TMXgid *center = gids + (size_t) (y - region.y) * (size_t) region.w + (size_t) (x - region.x);
+        memcpy(output, center - region.w - 1, 3 * sizeof(TMXgid));
+        memcpy(output + 3, center - 1, 3 * sizeof(TMXgid));
+        memcpy(output + 6, center + region.w - 1, 3 * sizeof(TMXgid));
+        return;
+    }
+    for (dy = -1; dy <= 1; dy++)
+    {
+        for (dx = -1; dx <= 1; dx++)
+            output[(dy + 1) * 3 + dx + 1] = tmxBlockedDenseGet(gids, region, x + dx, y + dy);
+    }
+}
+
+/**
+ * @brief Counts the cells of a layout that differ from the reference, read one at a time, by span, by decoded row with a
+ * margin of empty cells on each side, and as a whole grid.
+ */
+static size_t
+tmxBlockedVerify(const TMXblocked *blocked, const TMXgid *gids, TMXgid *row, TMXgid *grid)
+{
+    TMXrect region = tmxBlockedRegion(blocked);
+    size_t errors  = 0, count, i;
+    int x, y;
+
+    for (y = region.y - 1; y <= region.y + region.h; y++)
+    {
+        for (x = region.x - 1; x <= region.x + region.w; x++)
+            errors += tmxBlockedGet(blocked, x, y) != tmxBlockedDenseGet(gids, region, x, y);
+
+        tmxBlockedDecode(blocked, region.x - 3, y, (size_t) region.w + 6, row);
+        for (x = 0; x < region.w + 6; x++)
+            errors += row[x] != tmxBlockedDenseGet(gids, region, region.x - 3 + x, y);
+
+        for (x = region.x; y >= region.y && y < region.y + region.h && x < region.x + region.w; x += (int) count)
+        {
+            const TMXgid *span = tmxBlockedSpan(blocked, x, y, &count);
+            for (i = 0; span && i < count; i++)
+                errors += span[i] != tmxBlockedDenseGet(gids, region, x + (int) i, y);
+            if (!span || !count)
+            {
+                errors++;
+                break;
+            }
+        }
+    }
+
+    tmxBlockedToGrid(blocked, grid);
+    errors += region.w && region.h && memcmp(grid, gids, (size_t) region.w * (size_t) region.h * sizeof(TMXgid));
+    return errors;
+}
+
+/**
+ * @brief Sums the neighborhoods of cells taken by random walks, in the manner of a search expanding from a cell to its
+ * neighbors, which jump to a random cell after a number of steps.
+ */
+static uint64_t
+tmxBlockedWalk(const TMXblocked *blocked, const TMXgid *gids, TMXrect region, const uint32_t *points, const uint8_t *steps)
+{
+    static const int moves[4][2] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
+    uint64_t sum = 0;
+    TMXgid cells[9];
+    int x = 0, y = 0, k;
+    size_t i;
+
+    for (i = 0; i < TMX_BLOCKED_SAMPLES; i++)
+    {
+        if (i % TMX_BLOCKED_WALK == 0)
+        {
+            x = region.x + (int) points[i * 2];
+            y = region.y + (int) points[i * 2 + 1];
+        }
+        x = TMX_MIN(TMX_MAX(x + moves[steps[i]][0], region.x), region.x + region.w - 1);
+        y = TMX_MIN(TMX_MAX(y + moves[steps[i]][1], region.y), region.y + region.h - 1);
+        if (blocked)
+            tmxBlockedNeighborhood(blocked, x, y, cells);
+        else
+            tmxBlockedDenseNeighborhood(gids, region, x, y, cells);
+        for (k = 0; k < 9; k++)
+            sum += cells[k];
+    }
+    return sum;
+}
+
+/**
+ * @brief Sums the neighborhoods of random cells.
+ */
+static uint64_t
+tmxBlockedScatter(const TMXblocked *blocked, const TMXgid *gids, TMXrect region, const uint32_t *points)
+{
+    uint64_t sum = 0;
+    TMXgid cells[9];
+    size_t i;
+    int k;
+
+    for (i = 0; i < TMX_BLOCKED_SAMPLES; i++)
+    {
+        int x = region.x + (int) points[i * 2], y = region.y + (int) points[i * 2 + 1];
+        if (blocked)
+            tmxBlockedNeighborhood(blocked, x, y, cells);
+        else
+            tmxBlockedDenseNeighborhood(gids, region, x, y, cells);
+        for (k = 0; k < 9; k++)
+            sum += cells[k];
+    }
+    return sum;
+}
+
+/**
+ * @brief Sums every cell one column at a time, the worst case of a row-major layout.
+ */
+static uint64_t
+tmxBlockedColumns(const TMXblocked *blocked, const TMXgid *gids, TMXrect region)
+{
+    uint64_t sum = 0;
+    int x, y;
+    for (x = region.x; x < region.x + region.w; x++)
+    {
+        for (y = region.y; y < region.y + region.h; y++)
+            sum += blocked ? tmxBlockedGet(blocked, x, y) : tmxBlockedDenseGet(gids, region, x, y);
+    }
+    return sum;
+}
+
+static int
+tmxBlockedMeasure(const char *source, const TMXlayer *layer, const TMXblockedlayout *layout, const TMXbenchopts *opts)
+{
+    double start, create = 0.0, grid = 0.0, walk = 0.0, denseWalk = 0.0, scatter = 0.0, denseScatter = 0.0, columns = 0.0,
+                  denseColumns = 0.0;
+    size_t n, i, errors = 0, bytes;
+    uint64_t state = opts->seed ? opts->seed : 1;
+    volatile uint64_t sink = 0;
+    uint64_t sum           = 0;
+
+    TMXblocked *blocked = tmxBlockedCreate(layer, layout->size, layout->order);
+    if (!blocked)
+    {
+        fprintf(stderr, "blocked: failed to create the layout of %s (%s)\n", source, layout->name);
+        return 0;
+    }
+
+    TMXrect region   = tmxBlockedRegion(blocked);
+    size_t cells     = (size_t) region.w * (size_t) region.h;
+    TMXgid *gids     = malloc(TMX_MAX(cells, 1) * sizeof(TMXgid));
+    TMXgid *output   = malloc(TMX_MAX(cells, 1) * sizeof(TMXgid));
+    TMXgid *row      = malloc(((size_t) region.w + 6) * sizeof(TMXgid));
+    uint32_t *points = malloc(TMX_BLOCKED_SAMPLES * 2 * sizeof(uint32_t));
+    uint8_t *steps   = malloc(TMX_BLOCKED_SAMPLES);
+    if (!cells)
+    {
+        fprintf(stderr, "blocked: %s has no cells\n", source);
+        errors++;
+    }
+
+    tmxBenchDenseLayer(layer, region, gids);
+    errors += tmxBlockedVerify(blocked, gids, row, output);
+    for (i = 0; cells && i < TMX_BLOCKED_SAMPLES; i++)
+    {
+        points[i * 2]     = tmxBenchRandom(&state) % (uint32_t) region.w;
+        points[i * 2 + 1] = tmxBenchRandom(&state) % (uint32_t) region.h;
+        steps[i]          = (uint8_t) (tmxBenchRandom(&state) % 4);
+    }
+
+    // Neighborhoods along every edge of the layout and of the blocks, against the reference.
+    for (i = 0; cells && i < TMX_BLOCKED_SAMPLES / 16; i++)
+    {
+        TMXgid a[9], b[9];
+        int x = region.x - 1 + (int) (points[i * 2] % (uint32_t) (region.w + 2));
+        int y = region.y - 1 + (int) (points[i * 2 + 1] % (uint32_t) (region.h + 2));
+        if (i % 2)
+            x = region.x + (int) (points[i * 2] & ~(uint32_t) (layout->size - 1)) - (int) (i / 2 % 2);
+        tmxBlockedNeighborhood(blocked, x, y, a);
+        tmxBlockedDenseNeighborhood(gids, region, x, y, b);
+        errors += memcmp(a, b, sizeof(a)) != 0;
+    }
+
+    for (n = 0; cells && (n < opts->iterations || (!opts->iterations && create + walk + denseWalk < opts->minSeconds)); n++)
+    {
+        tmxFreeBlocked(blocked);
+        start   = tmxBenchNow();
+        blocked = tmxBlockedCreate(layer, layout->size, layout->order);
+        create += tmxBenchNow() - start;
+
+        start = tmxBenchNow();
+        tmxBlockedToGrid(blocked, output);
+        grid += tmxBenchNow() - start;
+
+        start = tmxBenchNow();
+        sum += tmxBlockedWalk(blocked, gids, region, points, steps);
+        walk += tmxBenchNow() - start;
+        start = tmxBenchNow();
+        sum -= tmxBlockedWalk(NULL, gids, region, points, steps);
+        denseWalk += tmxBenchNow() - start;
+
+        start = tmxBenchNow();
+        sum += tmxBlockedScatter(blocked, gids, region, points);
+        scatter += tmxBenchNow() - start;
+        start = tmxBenchNow();
+        sum -= tmxBlockedScatter(NULL, gids, region, points);
+        denseScatter += tmxBenchNow() - start;
+
+        start = tmxBenchNow();
+        sum += tmxBlockedColumns(blocked, gids, region);
+        columns += tmxBenchNow() - start;
+        start = tmxBenchNow();
+        sum -= tmxBlockedColumns(NULL, gids, region);
+        denseColumns += tmxBenchNow() - start;
+    }
+    sink = sum;
+    (void) sink;
+    errors += sum != 0;
+
+    // Random writes of single cells and spans, mirrored into the reference.
+    for (i = 0; cells && i < TMX_BLOCKED_SAMPLES / 16; i++)
+    {
+        uint32_t r = tmxBenchRandom(&state);
+        int x = (int) points[i * 2], y = (int) points[i * 2 + 1];
+        size_t count = TMX_MIN((size_t) (r >> 8) % 100, (size_t) (region.w - x)), k;
+        for (k = 0; k < count; k++)
+            row[k] = 1 + (r + (uint32_t) k) % 1024;
+        if (r % 2)
+        {
+            errors += !tmxBlockedEncode(blocked, region.x + x, region.y + y, count, row);
+            memcpy(gids + (size_t) y * (size_t) region.w + (size_t) x, row, count * sizeof(TMXgid));
+        }
+        else
+        {
+            errors += !tmxBlockedSet(blocked, region.x + x, region.y + y, row[0]);
+            gids[(size_t) y * (size_t) region.w + (size_t) x] = row[0];
+        }
+    }
+    errors += tmxBlockedVerify(blocked, gids, row, output);
+    bytes = tmxBlockedMemory(blocked);
+
+    n = TMX_MAX(n, 1);
+    printf("{\"bench\":\"blocked\",\"source\":\"%s\",\"layer\":\"%s\",\"infinite\":%s,\"width\":%d,\"height\":%d,\"layout\":\"%s\","
+           "\"iterations\":%zu,\"dense_bytes\":%zu,\"bytes\":%zu,\"create_ns_per_cell\":%.3f,\"to_grid_ns_per_cell\":%.3f,"
+           "\"walk_ns\":%.3f,\"dense_walk_ns\":%.3f,\"scatter_ns\":%.3f,\"dense_scatter_ns\":%.3f,\"columns_ns_per_cell\":%.3f,"
+           "\"dense_columns_ns_per_cell\":%.3f}\n",
+           source, layer->name ? layer->name : "", layer->type == TMX_LAYER_CHUNK ? "true" : "false", region.w, region.h,
+           layout->name, n, cells * sizeof(TMXgid), bytes, create / (double) n / (double) TMX_MAX(cells, 1) * 1e9,
+           grid / (double) n / (double) TMX_MAX(cells, 1) * 1e9, walk / (double) n / TMX_BLOCKED_SAMPLES * 1e9,
+           denseWalk / (double) n / TMX_BLOCKED_SAMPLES * 1e9, scatter / (double) n / TMX_BLOCKED_SAMPLES * 1e9,
+           denseScatter / (double) n / TMX_BLOCKED_SAMPLES * 1e9, columns / (double) n / (double) TMX_MAX(cells, 1) * 1e9,
+           denseColumns / (double) n / (double) TMX_MAX(cells, 1) * 1e9);
+
+    if (errors)
+        fprintf(stderr, "blocked: %zu mismatches against the layer (%s, %s)\n", errors, source, layout->name);
+
+    free(gids);
+    free(output);
+    free(row);
+    free(points);
+    free(steps);
+    tmxFreeBlocked(blocked);
+    return errors == 0;
+}
+
+/**
+ * @brief Measures a tile layer with each layout.
+ */
+static int
+tmxBlockedLayer(const char *source, const TMXlayer *layer, const TMXbenchopts *opts)
+{
+    size_t k;
+    int ok = 1;
+    for (k = 0; k < sizeof(tmxBlockedLayouts) / sizeof(tmxBlockedLayouts[0]); k++)
+        ok &= tmxBlockedMeasure(source, layer, &tmxBlockedLayouts[k], opts);
+    return ok;
+}
+
+int
+tmxBenchBlocked(int argc, char *argv[], const TMXbenchopts *opts)
+{
+    TMXmapspec spec  = {0};
+    spec.format      = TMX_FORMAT_XML;
+    spec.encoding    = TMX_ENCODING_BASE64;
+    spec.compression = TMX_COMPRESSION_ZLIB;
+    spec.tileLayers  = 1;
+    spec.seed        = opts->seed;
+    return tmxBenchLayers("blocked", argc, argv, &spec, opts, tmxBlockedLayer);
+}
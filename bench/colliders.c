@@ -0,0 +1,327 @@
+#include "bench.h"
+#include "tmx/colliders.h"
+#include <math.h>
+
+/**
+ * @brief The width and height of the regions finite layers are baked in, in tiles, matching the chunks of infinite maps.
+ */
+#define TMX_COLLIDERS_REGION 16
+
+/**
+ * @brief The number of regions verified for each map, which are compared pixel by pixel.
+ */
+#define TMX_COLLIDERS_VERIFY 64
+
+typedef struct TMXcolliderscase
+{
+    const char *name;
+    TMX_BOOL solid; /** Indicates every cell is changed to a tile with a collision rectangle covering the whole tile. */
+} TMXcolliderscase;
+
+/**
+ * @brief The cases for each map, in order, as the "solid" case modifies the tiles of the layer.
+ */
+static const TMXcolliderscase cases[] = {
+    {"inset", TMX_FALSE},
+    {"solid", TMX_TRUE},
+};
+
+/**
+ * @brief Sets the size of the collision rectangles of every tile, covering either the whole tile or an inset area.
+ */
+static void
+tmxCollidersApply(TMXmap *map, const TMXcolliderscase *c)
+{
+    TMXlayer *layer = map->layers[0];
+    size_t i, k, n;
+
+    // Generated tilesets give every 8th tile a collision shape, so cells are moved to the previous such tile.
+    if (c->solid)
+    {
+        size_t chunks = layer->type == TMX_LAYER_CHUNK ? layer->count : 1;
+        for (i = 0; i < chunks; i++)
+        {
+            TMXgid *gids = layer->type == TMX_LAYER_CHUNK ? layer->data.chunks[i].gids : layer->data.tiles;
+            size_t count = layer->type == TMX_LAYER_CHUNK ? layer->data.chunks[i].count : (size_t) layer->size.w * (size_t) layer->size.h;
+            for (k = 0; k < count; k++)
+            {
+                TMXgid id = (gids[k] & TMX_GID_TILE_MASK) - 1;
+                if (gids[k] & TMX_GID_TILE_MASK)
+                    gids[k] = (gids[k] & TMX_GID_FLAG_MASK) | (id - id % 8 + 1);
+            }
+        }
+    }
+
+    for (i = 0; i < map->tileset_count; i++)
+    {
+        TMXtileset *tileset = map->tilesets[i].tileset;
+        for (k = 0; k < tileset->tile_count && tileset->tiles; k++)
+        {
+            for (n = 0; n < tileset->tiles[k].collision.count; n++)
+            {
+                TMXobject *object = tileset->tiles[k].collision.objects[n];
+                float inset       = c->solid ? 0.0f : 2.0f;
+                object->position.x = object->position.y = inset;
+                object->size.x     = (float) tileset->tile_size.w - inset * 2.0f;
+                object->size.y     = (float) tileset->tile_size.h - inset * 2.0f;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Marks the pixels of a rectangle in a coverage bitmap of a region.
+ */
+static void
+tmxCollidersFill(uint8_t *pixels, int width, int height, float x0, float y0, float x1, float y1)
+{
+    int x, y;
+    int left = TMX_MAX((int) floorf(x0 + 0.5f), 0), right = TMX_MIN((int) floorf(x1 + 0.5f), width);
+    int top = TMX_MAX((int) floorf(y0 + 0.5f), 0), bottom = TMX_MIN((int) floorf(y1 + 0.5f), height);
+    for (y = top; y < bottom; y++)
+    {
+        for (x = left; x < right; x++)
+            pixels[y * width + x] = 1;
+    }
+}
+
+/**
+ * @brief Verifies the colliders of an orthogonal region: the merged rectangles cover exactly the pixels of the collision
+ * rectangles of each tile, computed independently, and the outlines enclose the same area.
+ */
+static int
+tmxCollidersVerify(const TMXmap *map, const TMXlayer *layer, TMXrect region, const TMXcolliders *colliders)
+{
+    int tw = map->tile_size.w, th = map->tile_size.h;
+    int width = region.w * tw, height = region.h * th;
+    uint8_t *expected = calloc((size_t) width * (size_t) height, 1);
+    uint8_t *actual   = calloc((size_t) width * (size_t) height, 1);
+    float ox = (float) (region.x * tw), oy = (float) (region.y * th);
+    size_t i, k, errors = 0, covered = 0;
+    int x, y;
+
+    for (y = region.y; y < region.y + region.h; y++)
+    {
+        for (x = region.x; x < region.x + region.w; x++)
+        {
+            TMXgid gid = 0;
+            TMXtid id;
+            if (layer->type == TMX_LAYER_TILE)
+            {
+                if (x < layer->size.w && y < layer->size.h)
+                    gid = layer->data.tiles[y * layer->size.w + x];
+            }
+            else
+            {
+                for (i = 0; i < layer->count; i++)
+                {
+                    const TMXchunk *chunk = &layer->data.chunks[i];
+                    if (x >= chunk->bounds.x && y >= chunk->bounds.y && x < chunk->bounds.x + chunk->bounds.w &&
+                        y < chunk->bounds.y + chunk->bounds.h)
+                        gid = chunk->gids[(y - chunk->bounds.y) * chunk->bounds.w + (x - chunk->bounds.x)];
+                }
+            }
+
+            TMXtileset *tileset = tmxMapTileset(map, gid, &id);
+            if (!tileset || id >= tileset->tile_count)
+                continue;
+
+            // Generated tilesets have the same tile size as the map, so tiles fill their cell exactly.
+            const TMXtile *tile = &tileset->tiles[id];
+            for (k = 0; k < tile->collision.count; k++)
+            {
+                const TMXobject *object = tile->collision.objects[k];
+                float x0 = object->position.x, y0 = object->position.y;
+                float x1 = x0 + object->size.x, y1 = y0 + object->size.y;
+                if (gid & TMX_GID_FLIP_DIAGONAL)
+                {
+                    float t0 = x0, t1 = x1;
+                    x0 = y0, x1 = y1, y0 = t0, y1 = t1;
+                }
+                if (gid & TMX_GID_FLIP_HORIZONTAL)
+                {
+                    float t = x0;
+                    x0      = (float) tw - x1;
+                    x1      = (float) tw - t;
+                }
+                if (gid & TMX_GID_FLIP_VERTICAL)
+                {
+                    float t = y0;
+                    y0      = (float) th - y1;
+                    y1      = (float) th - t;
+                }
+                tmxCollidersFill(expected, width, height, (float) ((x - region.x) * tw) + x0, (float) ((y - region.y) * th) + y0,
+                                 (float) ((x - region.x) * tw) + x1, (float) ((y - region.y) * th) + y1);
+            }
+        }
+    }
+
+    for (i = 0; i < colliders->count; i++)
+    {
+        const TMXcollider *c = &colliders->colliders[i];
+        if (c->type != TMX_OBJECT_RECT)
+        {
+            errors++;
+            continue;
+        }
+        tmxCollidersFill(actual, width, height, c->position.x - ox, c->position.y - oy, c->position.x + c->size.x - ox,
+                         c->position.y + c->size.y - oy);
+    }
+    for (i = 0; i < (size_t) width * (size_t) height; i++)
+    {
+        covered += expected[i];
+        errors += expected[i] != actual[i];
+    }
+
+    // The signed areas of the outlines (positive for outer outlines, negative for holes) add up to the covered area.
+    double area = 0.0;
+    for (i = 0; i < colliders->outline_count; i++)
+    {
+        const TMXoutline *outline = &colliders->outlines[i];
+        const TMXvec2 *points     = &colliders->points[outline->first];
+        double signedArea         = 0.0;
+        for (k = 0; k < outline->count; k++)
+        {
+            const TMXvec2 *a = &points[k], *b = &points[(k + 1) % outline->count];
+            signedArea += ((double) a->x * b->y - (double) b->x * a->y) * 0.5;
+        }
+        if ((signedArea < 0.0) != outline->hole)
+            errors++;
+        area += signedArea;
+    }
+    if (fabs(area - (double) covered) > 0.5)
+        errors++;
+
+    free(expected);
+    free(actual);
+    return errors == 0;
+}
+
+static int
+tmxCollidersMeasure(const TMXcolliderscase *c, TMXmap *map, const TMXbenchopts *opts)
+{
+    const TMXlayer *layer  = map->layers[0];
+    TMXcolliders *colliders = tmxCollidersCreate();
+    size_t i, n, regionCount, iterations = 0, inputs = 0, outputs = 0, outlines = 0;
+    double start, elapsed = 0.0;
+    TMXrect *regions;
+    int x, y;
+
+    tmxCollidersApply(map, c);
+
+    // Infinite layers are baked by chunk, and finite layers by regions of the same size.
+    if (layer->type == TMX_LAYER_CHUNK)
+    {
+        regionCount = layer->count;
+        regions     = malloc(regionCount * sizeof(TMXrect));
+        for (i = 0; i < regionCount; i++)
+            regions[i] = layer->data.chunks[i].bounds;
+    }
+    else
+    {
+        int columns = (layer->size.w + TMX_COLLIDERS_REGION - 1) / TMX_COLLIDERS_REGION;
+        int rows    = (layer->size.h + TMX_COLLIDERS_REGION - 1) / TMX_COLLIDERS_REGION;
+        regionCount = (size_t) columns * (size_t) rows;
+        regions     = malloc(regionCount * sizeof(TMXrect));
+        for (y = 0, i = 0; y < rows; y++)
+        {
+            for (x = 0; x < columns; x++, i++)
+                regions[i] = (TMXrect){.x = x * TMX_COLLIDERS_REGION, .y = y * TMX_COLLIDERS_REGION, .w = TMX_COLLIDERS_REGION, .h = TMX_COLLIDERS_REGION};
+        }
+    }
+
+    for (i = 0; i < regionCount; i++)
+    {
+        TMX_BOOL ok = layer->type == TMX_LAYER_CHUNK ? tmxBakeCollidersChunk(map, layer, i, colliders)
+                                                     : tmxBakeCollidersRegion(map, layer, regions[i], colliders);
+        if (!ok || (i < TMX_COLLIDERS_VERIFY && !tmxCollidersVerify(map, layer, regions[i], colliders)))
+        {
+            fprintf(stderr, "colliders: %s produced incorrect colliders for the region at %d,%d\n", c->name, regions[i].x, regions[i].y);
+            free(regions);
+            tmxFreeColliders(colliders);
+            return 0;
+        }
+        outputs += colliders->count;
+        outlines += colliders->outline_count;
+    }
+
+    for (i = 0; i < regionCount; i++)
+    {
+        const TMXrect *r = &regions[i];
+        for (y = r->y; y < r->y + r->h; y++)
+        {
+            for (x = r->x; x < r->x + r->w; x++)
+            {
+                TMXgid gid = 0;
+                TMXtid id;
+                if (layer->type == TMX_LAYER_CHUNK)
+                    gid = layer->data.chunks[i].gids[(y - r->y) * r->w + (x - r->x)];
+                else if (x < layer->size.w && y < layer->size.h)
+                    gid = layer->data.tiles[y * layer->size.w + x];
+                TMXtileset *tileset = tmxMapTileset(map, gid, &id);
+                if (tileset && id < tileset->tile_count)
+                    inputs += tileset->tiles[id].collision.count;
+            }
+        }
+    }
+
+    for (n = 0; n < opts->iterations || (!opts->iterations && elapsed < opts->minSeconds); n++)
+    {
+        start = tmxBenchNow();
+        for (i = 0; i < regionCount; i++)
+        {
+            if (layer->type == TMX_LAYER_CHUNK)
+                tmxBakeCollidersChunk(map, layer, i, colliders);
+            else
+                tmxBakeCollidersRegion(map, layer, regions[i], colliders);
+        }
+        elapsed += tmxBenchNow() - start;
+        iterations++;
+    }
+
+    printf("{\"bench\":\"colliders\",\"shapes\":\"%s\",\"infinite\":%s,\"width\":%d,\"height\":%d,\"regions\":%zu,\"tile_shapes\":%zu,"
+           "\"colliders\":%zu,\"outlines\":%zu,\"reduction\":%.2f,\"iterations\":%zu,\"seconds\":%.6f,\"us_per_region\":%.3f}\n",
+           c->name, layer->type == TMX_LAYER_CHUNK ? "true" : "false", map->size.w, map->size.h, regionCount, inputs, outputs, outlines,
+           outputs ? (double) inputs / (double) outputs : 0.0, iterations, elapsed, elapsed / (double) iterations / (double) regionCount * 1e6);
+
+    free(regions);
+    tmxFreeColliders(colliders);
+    return 1;
+}
+
+int
+tmxBenchColliders(int argc, char *argv[], const TMXbenchopts *opts)
+{
+    TMXmapspec spec = {0};
+    size_t s, k;
+    int inf, ok = 1;
+    (void) argc;
+    (void) argv;
+
+    spec.format      = TMX_FORMAT_XML;
+    spec.encoding    = TMX_ENCODING_BASE64;
+    spec.compression = TMX_COMPRESSION_ZLIB;
+    spec.tileLayers  = 1;
+    spec.seed        = opts->seed;
+
+    for (s = 0; s < opts->sizeCount; s++)
+    {
+        for (inf = 0; inf < 2; inf++)
+        {
+            spec.size     = opts->sizes[s];
+            spec.infinite = inf;
+            TMXmap *map   = tmxBenchLoadGenerated(&spec);
+            if (!map || !map->layer_count)
+            {
+                fprintf(stderr, "colliders: failed to load a generated map\n");
+                tmxFreeMap(map);
+                return 1;
+            }
+
+            for (k = 0; k < sizeof(cases) / sizeof(cases[0]); k++)
+                ok &= tmxCollidersMeasure(&cases[k], map, opts);
+            tmxFreeMap(map);
+        }
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,176 @@
+#include "bench.h"
+#include "tmx/compact.h"
+
+/**
+ * @brief The number of random cells read and written for each measurement.
+ */
+#define TMX_COMPACT_SAMPLES 1000000
+
+static const int tmxCompactSizes[] = {0, 16, 32, 64};
+
+static int
+tmxCompactCompareGids(const void *a, const void *b)
+{
+    TMXgid x = *(const TMXgid *) a, y = *(const TMXgid *) b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Counts the distinct GIDs of a layer, flip flags included, which describes how well the map suits palettes.
+ */
+static size_t
+tmxCompactDistinct(const TMXgid *gids, size_t count, TMXgid *sorted)
+{
+    size_t i, distinct = count > 0;
+    memcpy(sorted, gids, count * sizeof(TMXgid));
+    qsort(sorted, count, sizeof(TMXgid), tmxCompactCompareGids);
+    for (i = 1; i < count; i++)
+        distinct += sorted[i] != sorted[i - 1];
+    return distinct;
+}
+
+/**
+ * @brief Decodes every row of the storage, and counts the cells that differ from the reference, including a margin of
+ * empty cells on each side.
+ */
+static size_t
+tmxCompactVerify(const TMXcompact *compact, const TMXgid *gids, TMXgid *row)
+{
+    TMXrect region = tmxCompactRegion(compact);
+    size_t errors  = 0;
+    int x, y;
+
+    for (y = region.y - 1; y <= region.y + region.h; y++)
+    {
+        tmxCompactDecode(compact, region.x - 3, y, (size_t) region.w + 6, row);
+        for (x = 0; x < region.w + 6; x++)
+        {
+            TMXgid expected = (y >= region.y && y < region.y + region.h && x >= 3 && x < region.w + 3)
+                                  ? gids[(size_t) (y - region.y) * (size_t) region.w + (size_t) (x - 3)]
+                                  : 0;
+            errors += row[x] != expected;
+        }
+    }
+    return errors;
+}
+
+static int
+tmxCompactMeasure(const char *source, const TMXlayer *layer, int size, const TMXbenchopts *opts)
+{
+    double start, create = 0.0, get = 0.0, dense = 0.0, decode = 0.0, set = 0.0;
+    size_t n, i, errors = 0, samples, writes, bytes = 0, distinct;
+    uint64_t state = opts->seed ? opts->seed : 1;
+    volatile TMXgid sink = 0;
+    TMXgid sum           = 0;
+
+    TMXcompact *compact = tmxCompactCreate(layer, size);
+    if (!compact)
+    {
+        fprintf(stderr, "compact: failed to create the storage of %s (block %d)\n", source, size);
+        return 0;
+    }
+
+    TMXrect region   = tmxCompactRegion(compact);
+    size_t cells     = (size_t) region.w * (size_t) region.h;
+    TMXgid *gids     = malloc(TMX_MAX(cells, 1) * sizeof(TMXgid));
+    TMXgid *row      = malloc(((size_t) region.w + 6) * sizeof(TMXgid));
+    TMXgid *output   = malloc(TMX_MAX(cells, 1) * sizeof(TMXgid));
+    uint32_t *points = malloc(TMX_COMPACT_SAMPLES * 2 * sizeof(uint32_t));
+
+    tmxBenchDenseLayer(layer, region, gids);
+    distinct = tmxCompactDistinct(gids, cells, output);
+    errors += tmxCompactVerify(compact, gids, row);
+    samples = cells ? TMX_COMPACT_SAMPLES : 0;
+    for (i = 0; i < samples; i++)
+    {
+        points[i * 2]     = (uint32_t) (tmxBenchRandom(&state) % (uint32_t) region.w);
+        points[i * 2 + 1] = (uint32_t) (tmxBenchRandom(&state) % (uint32_t) region.h);
+    }
+
+    for (n = 0; n < opts->iterations || (!opts->iterations && create + get + decode < opts->minSeconds); n++)
+    {
+        tmxFreeCompact(compact);
+        start   = tmxBenchNow();
+        compact = tmxCompactCreate(layer, size);
+        create += tmxBenchNow() - start;
+
+        start = tmxBenchNow();
+        for (i = 0; i < samples; i++)
+            sum += tmxCompactGet(compact, region.x + (int) points[i * 2], region.y + (int) points[i * 2 + 1]);
+        get += tmxBenchNow() - start;
+
+        start = tmxBenchNow();
+        for (i = 0; i < samples; i++)
+            sum -= gids[(size_t) points[i * 2 + 1] * (size_t) region.w + points[i * 2]];
+        dense += tmxBenchNow() - start;
+
+        start = tmxBenchNow();
+        for (i = 0; i < (size_t) region.h; i++)
+            tmxCompactDecode(compact, region.x, region.y + (int) i, (size_t) region.w, output + i * (size_t) region.w);
+        decode += tmxBenchNow() - start;
+    }
+    sink = sum;
+    (void) sink;
+    errors += sum != 0;
+    errors += cells && memcmp(output, gids, cells * sizeof(TMXgid));
+    bytes = tmxCompactMemory(compact);
+
+    // Random writes to a quarter of the cells, with a wider set of tiles than the map uses, which grows the palettes and
+    // widens their indices.
+    writes = TMX_MIN(samples, cells / 4);
+    start  = tmxBenchNow();
+    for (i = 0; i < writes; i++)
+    {
+        uint32_t r = tmxBenchRandom(&state);
+        TMXgid gid = (r % 4) ? gids[(size_t) points[(i ^ 1) % samples * 2 + 1] * (size_t) region.w + points[(i ^ 1) % samples * 2]]
+                             : 1 + (r >> 2) % 1024;
+        gids[(size_t) points[i * 2 + 1] * (size_t) region.w + points[i * 2]] = gid;
+        errors += !tmxCompactSet(compact, region.x + (int) points[i * 2], region.y + (int) points[i * 2 + 1], gid);
+    }
+    set = tmxBenchNow() - start;
+    errors += tmxCompactVerify(compact, gids, row);
+
+    printf("{\"bench\":\"compact\",\"source\":\"%s\",\"layer\":\"%s\",\"infinite\":%s,\"width\":%d,\"height\":%d,\"gids\":%zu,"
+           "\"block\":%d,\"iterations\":%zu,\"dense_bytes\":%zu,\"bytes\":%zu,\"bits_per_cell\":%.3f,\"create_ns_per_cell\":%.3f,"
+           "\"get_ns\":%.3f,\"dense_get_ns\":%.3f,\"decode_ns_per_cell\":%.3f,\"set_ns\":%.3f,\"bytes_after_writes\":%zu}\n",
+           source, layer->name ? layer->name : "", layer->type == TMX_LAYER_CHUNK ? "true" : "false", region.w, region.h, distinct, size, n,
+           cells * sizeof(TMXgid), bytes, (double) bytes * 8.0 / (double) TMX_MAX(cells, 1),
+           create / (double) n / (double) TMX_MAX(cells, 1) * 1e9, get / (double) n / (double) TMX_MAX(samples, 1) * 1e9,
+           dense / (double) n / (double) TMX_MAX(samples, 1) * 1e9, decode / (double) n / (double) TMX_MAX(cells, 1) * 1e9,
+           set / (double) TMX_MAX(writes, 1) * 1e9, tmxCompactMemory(compact));
+
+    if (errors)
+        fprintf(stderr, "compact: %zu mismatches against the layer (%s, block %d)\n", errors, source, size);
+
+    free(gids);
+    free(row);
+    free(output);
+    free(points);
+    tmxFreeCompact(compact);
+    return errors == 0;
+}
+
+/**
+ * @brief Measures a tile layer with each block size.
+ */
+static int
+tmxCompactLayer(const char *source, const TMXlayer *layer, const TMXbenchopts *opts)
+{
+    size_t k;
+    int ok = 1;
+    for (k = 0; k < sizeof(tmxCompactSizes) / sizeof(tmxCompactSizes[0]); k++)
+        ok &= tmxCompactMeasure(source, layer, tmxCompactSizes[k], opts);
+    return ok;
+}
+
+int
+tmxBenchCompact(int argc, char *argv[], const TMXbenchopts *opts)
+{
+    TMXmapspec spec  = {0};
+    spec.format      = TMX_FORMAT_XML;
+    spec.encoding    = TMX_ENCODING_BASE64;
+    spec.compression = TMX_COMPRESSION_ZLIB;
+    spec.tileLayers  = 2;
+    spec.seed        = opts->seed;
+    return tmxBenchLayers("compact", argc, argv, &spec, opts, tmxCompactLayer);
+}
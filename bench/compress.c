@@ -0,0 +1,158 @@
+#include "bench.h"
+
+// The vendored miniz is trimmed down to what the library uses, which excludes the checksum functions the compressor
+// refers to, so supply them here.
+static unsigned long tmxBenchAdler32(unsigned long adler, const unsigned char *data, size_t size);
+static unsigned long tmxBenchCrc32(unsigned long crc, const unsigned char *data, size_t size);
+
+#define mz_adler32 tmxBenchAdler32
+#define mz_crc32   tmxBenchCrc32
+
+#define MINIZ_NO_STDIO
+#define MINIZ_NO_ARCHIVE_APIS
+#define MINIZ_NO_ZLIB_APIS
+
+// Warnings from the vendored header are not ours to fix: its functions are static, and the coroutine state of the
+// decompressor is only read after it has been assigned, which the compiler cannot prove once it is inlined.
+#if defined(__GNUC__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-function"
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#endif
+#include "miniz.h"
+#if defined(__GNUC__)
+#pragma GCC diagnostic pop
+#endif
+
+#define TMX_ZSTD_MAGIC          0xFD2FB528U
+#define TMX_ZSTD_MAX_BLOCK_SIZE (128 * 1024)
+
+static unsigned long
+tmxBenchAdler32(unsigned long adler, const unsigned char *data, size_t size)
+{
+    uint32_t a = adler & 0xFFFF, b = (uint32_t) (adler >> 16);
+    size_t i;
+    for (i = 0; i < size; i++)
+    {
+        a = (a + data[i]) % 65521U;
+        b = (b + a) % 65521U;
+    }
+    return ((unsigned long) b << 16) | a;
+}
+
+static unsigned long
+tmxBenchCrc32(unsigned long crc, const unsigned char *data, size_t size)
+{
+    uint32_t c = ~(uint32_t) crc;
+    size_t i;
+    int k;
+    for (i = 0; i < size; i++)
+    {
+        c ^= data[i];
+        for (k = 0; k < 8; k++)
+            c = (c >> 1) ^ (0xEDB88320U & (0U - (c & 1)));
+    }
+    return ~c;
+}
+
+/**
+ * @brief Compresses @a data into a Gzip member, with the optional FEXTRA and FNAME header fields present so that the
+ * full header parser is exercised.
+ */
+static uint8_t *
+tmxBenchGzip(const uint8_t *data, size_t size, int level, size_t *outSize)
+{
+    static const uint8_t header[] = {0x1F, 0x8B, 8, 0x04 | 0x08, 0, 0, 0, 0, 0, 3, 4, 0, 'T', 'X', 0, 0, 'l', 'a', 'y', 'e', 'r', 0};
+
+    size_t rawSize;
+    void *raw = tdefl_compress_mem_to_heap(data, size, &rawSize, tdefl_create_comp_flags_from_zip_params(level, -15, MZ_DEFAULT_STRATEGY));
+    if (!raw)
+        return NULL;
+
+    uint8_t *result = malloc(sizeof(header) + rawSize + 8);
+    uint8_t *p      = result;
+    memcpy(p, header, sizeof(header));
+    p += sizeof(header);
+    memcpy(p, raw, rawSize);
+    p += rawSize;
+
+    uint32_t crc = (uint32_t) tmxBenchCrc32(0, data, size);
+    tmxBenchStoreLE(p, &crc, 1);
+    uint32_t isize = (uint32_t) size;
+    tmxBenchStoreLE(p + 4, &isize, 1);
+
+    free(raw);
+    *outSize = sizeof(header) + rawSize + 8;
+    return result;
+}
+
+/**
+ * @brief Wraps @a data in a Zstandard frame of raw (stored) blocks. The library only includes the Zstandard decoder, so
+ * this measures the framing and copy overhead rather than entropy decoding.
+ */
+static uint8_t *
+tmxBenchZstd(const uint8_t *data, size_t size, size_t *outSize)
+{
+    size_t blocks   = size ? (size + TMX_ZSTD_MAX_BLOCK_SIZE - 1) / TMX_ZSTD_MAX_BLOCK_SIZE : 1;
+    uint8_t *result = malloc(4 + 1 + 8 + blocks * 3 + size);
+    uint8_t *p      = result;
+    size_t offset   = 0, blockSize;
+    uint32_t magic  = TMX_ZSTD_MAGIC;
+    uint32_t word;
+
+    tmxBenchStoreLE(p, &magic, 1);
+    p += 4;
+
+    // Frame header: 8-byte content size, single segment (no window descriptor), no checksum or dictionary.
+    *p++ = 0xE0;
+    word = (uint32_t) size;
+    tmxBenchStoreLE(p, &word, 1);
+    word = (uint32_t) ((uint64_t) size >> 32);
+    tmxBenchStoreLE(p + 4, &word, 1);
+    p += 8;
+
+    do
+    {
+        blockSize = size - offset;
+        if (blockSize > TMX_ZSTD_MAX_BLOCK_SIZE)
+            blockSize = TMX_ZSTD_MAX_BLOCK_SIZE;
+
+        // Block header: last-block flag, type (0 = raw), and size.
+        word = (offset + blockSize == size ? 1U : 0U) | ((uint32_t) blockSize << 3);
+        p[0] = (uint8_t) word;
+        p[1] = (uint8_t) (word >> 8);
+        p[2] = (uint8_t) (word >> 16);
+        memcpy(p + 3, data + offset, blockSize);
+        p += 3 + blockSize;
+        offset += blockSize;
+    } while (offset < size);
+
+    *outSize = (size_t) (p - result);
+    return result;
+}
+
+uint8_t *
+tmxBenchCompress(TMX_COMPRESSION compression, const uint8_t *data, size_t size, int level, size_t *outSize)
+{
+    uint8_t *result;
+    switch (compression)
+    {
+        case TMX_COMPRESSION_GZIP: return tmxBenchGzip(data, size, level, outSize);
+        case TMX_COMPRESSION_ZLIB:
+            return tdefl_compress_mem_to_heap(data, size, outSize,
+                                              tdefl_create_comp_flags_from_zip_params(level, 15, MZ_DEFAULT_STRATEGY));
+        case TMX_COMPRESSION_ZSTD: return tmxBenchZstd(data, size, outSize);
+        default:
+            result = malloc(size ? size : 1);
+            memcpy(result, data, size);
+            *outSize = size;
+            return result;
+    }
+}
+
+size_t
+tmxBenchZlibReference(const void *input, size_t inputSize, void *output, size_t outputSize)
+{
+    size_t result = tinfl_decompress_mem_to_mem(output, outputSize, input, inputSize, TINFL_FLAG_PARSE_ZLIB_HEADER);
+    return result == TINFL_DECOMPRESS_MEM_TO_MEM_FAILED ? 0 : result;
+}
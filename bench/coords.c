@@ -0,0 +1,255 @@
+#include "bench.h"
+#include "tmx/coords.h"
+#include <math.h>
+
+/**
+ * @brief A grid layout to verify and measure, covering every orientation and stagger axis/index combination.
+ */
+typedef struct TMXcoordscase
+{
+    const char *name;
+    TMX_ORIENTATION orientation;
+    TMX_AXIS axis;
+    TMX_INDEX index;
+    int tileWidth;
+    int tileHeight;
+    int hexSide;
+} TMXcoordscase;
+
+static const TMXcoordscase cases[] = {
+    {"orthogonal", TMX_ORIENTATION_ORTHOGONAL, TMX_AXIS_Y, TMX_INDEX_ODD, 32, 32, 0},
+    {"isometric", TMX_ORIENTATION_ISOMETRIC, TMX_AXIS_Y, TMX_INDEX_ODD, 64, 32, 0},
+    {"staggered-y-odd", TMX_ORIENTATION_STAGGERED, TMX_AXIS_Y, TMX_INDEX_ODD, 64, 32, 0},
+    {"staggered-y-even", TMX_ORIENTATION_STAGGERED, TMX_AXIS_Y, TMX_INDEX_EVEN, 64, 32, 0},
+    {"staggered-x-odd", TMX_ORIENTATION_STAGGERED, TMX_AXIS_X, TMX_INDEX_ODD, 64, 32, 0},
+    {"staggered-x-even", TMX_ORIENTATION_STAGGERED, TMX_AXIS_X, TMX_INDEX_EVEN, 64, 32, 0},
+    {"hexagonal-y-odd", TMX_ORIENTATION_HEXAGONAL, TMX_AXIS_Y, TMX_INDEX_ODD, 28, 32, 16},
+    {"hexagonal-y-even", TMX_ORIENTATION_HEXAGONAL, TMX_AXIS_Y, TMX_INDEX_EVEN, 28, 32, 16},
+    {"hexagonal-x-odd", TMX_ORIENTATION_HEXAGONAL, TMX_AXIS_X, TMX_INDEX_ODD, 32, 28, 16},
+    {"hexagonal-x-even", TMX_ORIENTATION_HEXAGONAL, TMX_AXIS_X, TMX_INDEX_EVEN, 32, 28, 16},
+    {"hexagonal-y-odd-uneven", TMX_ORIENTATION_HEXAGONAL, TMX_AXIS_Y, TMX_INDEX_ODD, 29, 33, 11},
+    {"hexagonal-x-even-uneven", TMX_ORIENTATION_HEXAGONAL, TMX_AXIS_X, TMX_INDEX_EVEN, 33, 29, 11},
+    {"hexagonal-y-even-flat", TMX_ORIENTATION_HEXAGONAL, TMX_AXIS_Y, TMX_INDEX_EVEN, 32, 32, 32},
+    {"hexagonal-x-odd-flat", TMX_ORIENTATION_HEXAGONAL, TMX_AXIS_X, TMX_INDEX_ODD, 32, 32, 32},
+};
+
+typedef struct TMXcoordsdata
+{
+    const TMXmap *map;
+    size_t count;
+    TMXvec2 *pixels;
+    TMXpoint *tiles;
+    TMXpoint *tileOutput;
+    TMXvec2 *pixelOutput;
+} TMXcoordsdata;
+
+typedef void (*TMXcoordsfunc)(const TMXcoordsdata *data);
+
+static void
+tmxCoordsPixelsScalar(const TMXcoordsdata *data)
+{
+    size_t i;
+    for (i = 0; i < data->count; i++)
+        data->tileOutput[i] = tmxPixelToTile(data->map, data->pixels[i]);
+}
+
+static void
+tmxCoordsPixelsBatch(const TMXcoordsdata *data)
+{
+    tmxPixelsToTiles(data->map, data->pixels, data->tileOutput, data->count);
+}
+
+static void
+tmxCoordsTilesScalar(const TMXcoordsdata *data)
+{
+    size_t i;
+    for (i = 0; i < data->count; i++)
+        data->pixelOutput[i] = tmxTileToPixel(data->map, data->tiles[i]);
+}
+
+static void
+tmxCoordsTilesBatch(const TMXcoordsdata *data)
+{
+    tmxTilesToPixels(data->map, data->tiles, data->pixelOutput, data->count);
+}
+
+/**
+ * @brief Tests whether the shape of a cell centered at @a center contains @a pixel, computed independently of the library.
+ */
+static TMX_BOOL
+tmxCoordsContains(const TMXcoordscase *c, TMXvec2 center, TMXvec2 pixel)
+{
+    const double epsilon = 1e-3;
+    double dx            = fabs((double) pixel.x - center.x);
+    double dy            = fabs((double) pixel.y - center.y);
+    double halfWidth     = c->tileWidth * 0.5;
+    double halfHeight    = c->tileHeight * 0.5;
+    double side          = c->orientation == TMX_ORIENTATION_HEXAGONAL ? c->hexSide * 0.5 : 0.0;
+
+    if (c->orientation == TMX_ORIENTATION_ORTHOGONAL)
+        return dx <= halfWidth + epsilon && dy <= halfHeight + epsilon;
+
+    // Diamonds and hexagons: the flat side spans the staggered axis, and the slanted edges meet at the cross axis.
+    if (c->axis == TMX_AXIS_X && c->orientation != TMX_ORIENTATION_ISOMETRIC)
+    {
+        double t = dx, h = halfWidth;
+        dx = dy, dy = t;
+        halfWidth = halfHeight, halfHeight = h;
+    }
+    if (dx > halfWidth + epsilon)
+        return TMX_FALSE;
+    if (dy <= side + epsilon)
+        return TMX_TRUE;
+    return (dy - side) / (halfHeight - side) + dx / halfWidth <= 1.0 + epsilon;
+}
+
+static int
+tmxCoordsVerify(const TMXcoordscase *c, const TMXcoordsdata *data)
+{
+    TMXpoint *reference = malloc(data->count * sizeof(TMXpoint));
+    TMXvec2 *centers    = malloc(data->count * sizeof(TMXvec2));
+    size_t i, mismatches = 0;
+
+    // The scalar functions are the reference for the batch functions, and must match them exactly.
+    tmxCoordsPixelsScalar(data);
+    memcpy(reference, data->tileOutput, data->count * sizeof(TMXpoint));
+    tmxCoordsPixelsBatch(data);
+    for (i = 0; i < data->count; i++)
+    {
+        if (reference[i].x != data->tileOutput[i].x || reference[i].y != data->tileOutput[i].y)
+            mismatches++;
+    }
+
+    tmxCoordsTilesScalar(data);
+    memcpy(centers, data->pixelOutput, data->count * sizeof(TMXvec2));
+    tmxCoordsTilesBatch(data);
+    if (memcmp(centers, data->pixelOutput, data->count * sizeof(TMXvec2)))
+        mismatches++;
+
+    // The center of each cell converts back to the same cell, and the cell found for each pixel contains it.
+    tmxPixelsToTiles(data->map, centers, data->tileOutput, data->count);
+    for (i = 0; i < data->count; i++)
+    {
+        if (data->tileOutput[i].x != data->tiles[i].x || data->tileOutput[i].y != data->tiles[i].y)
+            mismatches++;
+        if (!tmxCoordsContains(c, tmxTileToPixel(data->map, reference[i]), data->pixels[i]))
+            mismatches++;
+    }
+
+    if (mismatches)
+        fprintf(stderr, "coords: %s produced %zu incorrect results\n", c->name, mismatches);
+    free(reference);
+    free(centers);
+    return mismatches == 0;
+}
+
+static double
+tmxCoordsMeasure(TMXcoordsfunc func, const TMXcoordsdata *data, const TMXbenchopts *opts, size_t *iterations)
+{
+    double start, elapsed;
+    size_t n;
+
+    if (opts->iterations)
+    {
+        start = tmxBenchNow();
+        for (n = 0; n < opts->iterations; n++)
+            func(data);
+        *iterations = opts->iterations;
+        return tmxBenchNow() - start;
+    }
+
+    // Double the batch until it runs for the requested minimum time.
+    for (n = 1;; n *= 2)
+    {
+        size_t i;
+        start = tmxBenchNow();
+        for (i = 0; i < n; i++)
+            func(data);
+        elapsed = tmxBenchNow() - start;
+        if (elapsed >= opts->minSeconds)
+            break;
+    }
+    *iterations = n;
+    return elapsed;
+}
+
+static void
+tmxCoordsReport(const TMXcoordscase *c, const char *direction, const char *mode, TMXcoordsfunc func, const TMXcoordsdata *data,
+                const TMXbenchopts *opts)
+{
+    size_t iterations;
+    double seconds = tmxCoordsMeasure(func, data, opts, &iterations);
+    printf("{\"bench\":\"coords\",\"layout\":\"%s\",\"direction\":\"%s\",\"mode\":\"%s\",\"points\":%zu,\"iterations\":%zu,"
+           "\"seconds\":%.6f,\"mpoints_per_s\":%.2f}\n",
+           c->name, direction, mode, data->count, iterations, seconds, (double) data->count * (double) iterations / seconds / 1e6);
+}
+
+int
+tmxBenchCoords(int argc, char *argv[], const TMXbenchopts *opts)
+{
+    size_t s, k, i;
+    int ok = 1;
+    (void) argc;
+    (void) argv;
+
+    for (s = 0; s < opts->sizeCount; s++)
+    {
+        int size = opts->sizes[s];
+        TMXcoordsdata data;
+        data.count       = (size_t) size * (size_t) size;
+        data.pixels      = malloc(data.count * sizeof(TMXvec2));
+        data.tiles       = malloc(data.count * sizeof(TMXpoint));
+        data.tileOutput  = malloc(data.count * sizeof(TMXpoint));
+        data.pixelOutput = malloc(data.count * sizeof(TMXvec2));
+
+        for (k = 0; k < sizeof(cases) / sizeof(cases[0]); k++)
+        {
+            const TMXcoordscase *c = &cases[k];
+            uint64_t state         = opts->seed ? opts->seed : 1;
+            TMXmap map;
+
+            memset(&map, 0, sizeof(TMXmap));
+            map.orientation   = c->orientation;
+            map.size.w        = size;
+            map.size.h        = size;
+            map.tile_size.w   = c->tileWidth;
+            map.tile_size.h   = c->tileHeight;
+            map.hex_side      = c->hexSide;
+            map.stagger.axis  = c->axis;
+            map.stagger.index = c->index;
+            data.map          = &map;
+
+            // Points cover the map with a margin of a few tiles beyond each edge, to include negative coordinates. Every
+            // other point is on a whole pixel, which places many of them exactly on the edges between cells.
+            for (i = 0; i < data.count; i++)
+            {
+                float range      = (float) (size + 8);
+                data.pixels[i].x = ((float) tmxBenchRandom(&state) / 4294967296.0f * range - 4.0f) * (float) c->tileWidth;
+                data.pixels[i].y = ((float) tmxBenchRandom(&state) / 4294967296.0f * range - 4.0f) * (float) c->tileHeight;
+                if (i & 1)
+                {
+                    data.pixels[i].x = floorf(data.pixels[i].x);
+                    data.pixels[i].y = floorf(data.pixels[i].y);
+                }
+                data.tiles[i].x = (int) (tmxBenchRandom(&state) % (uint32_t) (size + 8)) - 4;
+                data.tiles[i].y = (int) (tmxBenchRandom(&state) % (uint32_t) (size + 8)) - 4;
+            }
+
+            if (!tmxCoordsVerify(c, &data))
+            {
+                ok = 0;
+                continue;
+            }
+            tmxCoordsReport(c, "pixel_to_tile", "scalar", tmxCoordsPixelsScalar, &data, opts);
+            tmxCoordsReport(c, "pixel_to_tile", "batch", tmxCoordsPixelsBatch, &data, opts);
+            tmxCoordsReport(c, "tile_to_pixel", "scalar", tmxCoordsTilesScalar, &data, opts);
+            tmxCoordsReport(c, "tile_to_pixel", "batch", tmxCoordsTilesBatch, &data, opts);
+        }
+
+        free(data.pixels);
+        free(data.tiles);
+        free(data.tileOutput);
+        free(data.pixelOutput);
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,527 @@
+#include "bench.h"
+#include "tmx/coords.h"
+#include "tmx/cull.h"
+#include <math.h>
+
+/**
+ * @brief The number of random viewports verified and timed for each orientation and layer.
+ */
+#define TMX_CULL_VIEWPORTS 400
+
+/**
+ * @brief The size of the chunks of regular chunk layers, in tiles, as written by Tiled.
+ */
+#define TMX_CULL_CHUNK 16
+
+/**
+ * @brief A grid layout to verify and measure, covering every orientation and stagger axis/index combination.
+ */
+typedef struct TMXcullcase
+{
+    const char *name;
+    TMX_ORIENTATION orientation;
+    TMX_AXIS axis;
+    TMX_INDEX index;
+    int tileWidth;
+    int tileHeight;
+    int hexSide;
+} TMXcullcase;
+
+static const TMXcullcase cullCases[] = {
+    {"orthogonal", TMX_ORIENTATION_ORTHOGONAL, TMX_AXIS_Y, TMX_INDEX_ODD, 32, 32, 0},
+    {"isometric", TMX_ORIENTATION_ISOMETRIC, TMX_AXIS_Y, TMX_INDEX_ODD, 64, 32, 0},
+    {"staggered-y-odd", TMX_ORIENTATION_STAGGERED, TMX_AXIS_Y, TMX_INDEX_ODD, 64, 32, 0},
+    {"staggered-y-even", TMX_ORIENTATION_STAGGERED, TMX_AXIS_Y, TMX_INDEX_EVEN, 64, 32, 0},
+    {"staggered-x-odd", TMX_ORIENTATION_STAGGERED, TMX_AXIS_X, TMX_INDEX_ODD, 64, 32, 0},
+    {"staggered-x-even", TMX_ORIENTATION_STAGGERED, TMX_AXIS_X, TMX_INDEX_EVEN, 64, 32, 0},
+    {"hexagonal-y-odd-uneven", TMX_ORIENTATION_HEXAGONAL, TMX_AXIS_Y, TMX_INDEX_ODD, 29, 33, 11},
+    {"hexagonal-y-even", TMX_ORIENTATION_HEXAGONAL, TMX_AXIS_Y, TMX_INDEX_EVEN, 28, 32, 16},
+    {"hexagonal-x-odd", TMX_ORIENTATION_HEXAGONAL, TMX_AXIS_X, TMX_INDEX_ODD, 32, 28, 16},
+    {"hexagonal-x-even-uneven", TMX_ORIENTATION_HEXAGONAL, TMX_AXIS_X, TMX_INDEX_EVEN, 33, 29, 11},
+};
+
+/**
+ * @brief The kinds of layers culled for each layout: a finite layer, and chunk layers that are indexed densely, sorted
+ * because they are far apart, and sorted because their sizes and positions are irregular.
+ */
+typedef enum TMX_CULL_LAYER
+{
+    TMX_CULL_FINITE,
+    TMX_CULL_DENSE,
+    TMX_CULL_SPARSE,
+    TMX_CULL_IRREGULAR,
+    TMX_CULL_LAYER_COUNT
+} TMX_CULL_LAYER;
+
+static const char *cullLayerNames[TMX_CULL_LAYER_COUNT] = {"finite", "chunks-dense", "chunks-sparse", "chunks-irregular"};
+
+typedef struct TMXcullviewport
+{
+    float x, y, w, h;
+    TMX_BOOL gap; /** Indicates the viewport lies between the chunks of a chunk layer, which must then be omitted. */
+} TMXcullviewport;
+
+/**
+ * @brief Fills a tile or chunk layer of the given kind for a map of @a size tiles.
+ */
+static void
+tmxCullFillLayer(TMXlayer *layer, TMX_CULL_LAYER kind, int size, uint64_t *state)
+{
+    int chunks = (size + TMX_CULL_CHUNK - 1) / TMX_CULL_CHUNK, x, y;
+    TMXchunk *chunk;
+
+    memset(layer, 0, sizeof(TMXlayer));
+    layer->visible = TMX_TRUE;
+    layer->opacity = 1.0f;
+    if (kind == TMX_CULL_FINITE)
+    {
+        layer->type   = TMX_LAYER_TILE;
+        layer->size.w = size;
+        layer->size.h = size;
+        layer->count  = (size_t) size * (size_t) size;
+        return;
+    }
+
+    layer->type        = TMX_LAYER_CHUNK;
+    layer->data.chunks = calloc((size_t) chunks * (size_t) chunks + 16, sizeof(TMXchunk));
+    switch (kind)
+    {
+        case TMX_CULL_DENSE:
+            // Two thirds of the chunks of the map, beginning left of and above the origin as infinite maps often do.
+            for (y = 0; y < chunks; y++)
+            {
+                for (x = 0; x < chunks; x++)
+                {
+                    if (tmxBenchRandom(state) % 3 == 0)
+                        continue;
+                    chunk         = &layer->data.chunks[layer->count++];
+                    chunk->bounds = (TMXrect){.x = (x - 1) * TMX_CULL_CHUNK, .y = (y - 1) * TMX_CULL_CHUNK};
+                    chunk->bounds.w = TMX_CULL_CHUNK;
+                    chunk->bounds.h = TMX_CULL_CHUNK;
+                }
+            }
+            break;
+        case TMX_CULL_SPARSE:
+            // Few chunks spread over an area with 64 times as many cells, too sparse for a dense index.
+            for (x = 0; x < chunks * chunks / 4 + 16; x++)
+            {
+                chunk           = &layer->data.chunks[layer->count++];
+                chunk->bounds.x = ((int) (tmxBenchRandom(state) % (uint32_t) (chunks * 8)) - chunks) * TMX_CULL_CHUNK;
+                chunk->bounds.y = ((int) (tmxBenchRandom(state) % (uint32_t) (chunks * 8)) - chunks) * TMX_CULL_CHUNK;
+                chunk->bounds.w = TMX_CULL_CHUNK;
+                chunk->bounds.h = TMX_CULL_CHUNK;
+            }
+            break;
+        default:
+            // Chunks of varying size at arbitrary positions, which may overlap.
+            for (x = 0; x < chunks * chunks + 16; x++)
+            {
+                chunk           = &layer->data.chunks[layer->count++];
+                chunk->bounds.x = (int) (tmxBenchRandom(state) % (uint32_t) (size * 2)) - size / 2;
+                chunk->bounds.y = (int) (tmxBenchRandom(state) % (uint32_t) (size * 2)) - size / 2;
+                chunk->bounds.w = 1 + (int) (tmxBenchRandom(state) % 24);
+                chunk->bounds.h = 1 + (int) (tmxBenchRandom(state) % 24);
+            }
+            break;
+    }
+    for (x = 0; x < (int) layer->count; x++)
+        layer->data.chunks[x].count = (size_t) layer->data.chunks[x].bounds.w * (size_t) layer->data.chunks[x].bounds.h;
+}
+
+/**
+ * @brief Retrieves the rectangle containing every cell of a layer, in tile units.
+ */
+static TMXrect
+tmxCullLayerBounds(const TMXlayer *layer)
+{
+    TMXrect bounds = {.x = 0, .y = 0, .w = layer->size.w, .h = layer->size.h};
+    int right, bottom;
+    size_t i;
+
+    if (layer->type != TMX_LAYER_CHUNK || !layer->count)
+        return bounds;
+
+    bounds = layer->data.chunks[0].bounds;
+    right  = bounds.x + bounds.w;
+    bottom = bounds.y + bounds.h;
+    for (i = 1; i < layer->count; i++)
+    {
+        const TMXrect *r = &layer->data.chunks[i].bounds;
+        bounds.x         = TMX_MIN(bounds.x, r->x);
+        bounds.y         = TMX_MIN(bounds.y, r->y);
+        right            = TMX_MAX(right, r->x + r->w);
+        bottom           = TMX_MAX(bottom, r->y + r->h);
+    }
+    bounds.w = right - bounds.x;
+    bounds.h = bottom - bounds.y;
+    return bounds;
+}
+
+/**
+ * @brief Tests whether any chunk of a chunk layer lies within @a margin cells of a cell.
+ */
+static TMX_BOOL
+tmxCullNearChunk(const TMXlayer *layer, int x, int y, int margin)
+{
+    size_t i;
+    for (i = 0; i < layer->count; i++)
+    {
+        const TMXrect *r = &layer->data.chunks[i].bounds;
+        if (x + margin >= r->x && x - margin < r->x + r->w && y + margin >= r->y && y - margin < r->y + r->h)
+            return TMX_TRUE;
+    }
+    return TMX_FALSE;
+}
+
+/**
+ * @brief Tests whether the bounding rectangle of a cell intersects a viewport, computed from the center of the cell
+ * rather than the culling arithmetic. Every shape is as large as the tile size of the map, centered on its cell.
+ */
+static TMX_BOOL
+tmxCullCellVisible(const TMXmap *map, int x, int y, const TMXcullviewport *v, TMXvec2 offset)
+{
+    TMXvec2 center = tmxTileToPixel(map, (TMXpoint){.x = x, .y = y});
+    double left    = center.x + offset.x - map->tile_size.w * 0.5;
+    double top     = center.y + offset.y - map->tile_size.h * 0.5;
+    return left < v->x + v->w && left + map->tile_size.w > v->x && top < v->y + v->h && top + map->tile_size.h > v->y;
+}
+
+static const TMXtilespan *
+tmxCullFindSpan(const TMXvisiblelayer *visible, int y)
+{
+    size_t lo = 0, hi = visible->span_count, mid;
+    while (lo < hi)
+    {
+        mid = lo + (hi - lo) / 2;
+        if (visible->spans[mid].y < y)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo < visible->span_count && visible->spans[lo].y == y ? &visible->spans[lo] : NULL;
+}
+
+static TMX_BOOL
+tmxCullContains(const TMXvisiblelayer *visible, int x, int y)
+{
+    const TMXtilespan *span = visible ? tmxCullFindSpan(visible, y) : NULL;
+    return span && x >= span->first && x <= span->last;
+}
+
+/**
+ * @brief Compares the result of a query with a brute-force test of the cells near the viewport and of every chunk.
+ *
+ * @return The number of incorrect cells and chunks.
+ */
+static size_t
+tmxCullVerify(const TMXmap *map, const TMXlayer *layer, const TMXvisiblelayer *visible, const TMXcullviewport *v, TMXvec2 offset,
+              unsigned char *marks)
+{
+    TMXrect bounds      = tmxCullLayerBounds(layer);
+    TMX_BOOL staggerX   = map->orientation != TMX_ORIENTATION_ISOMETRIC && map->orientation != TMX_ORIENTATION_ORTHOGONAL &&
+                        map->stagger.axis == TMX_AXIS_X;
+    size_t i, s, errors = 0;
+    int x, y;
+
+    // Cells that are visible lie within a few cells of those under the corners of the viewport, in every orientation.
+    int left = INT32_MAX, right = INT32_MIN, top = INT32_MAX, bottom = INT32_MIN;
+    for (i = 0; i < 4; i++)
+    {
+        TMXvec2 corner = {.x = v->x - offset.x + ((i & 1) ? v->w : 0.0f), .y = v->y - offset.y + ((i & 2) ? v->h : 0.0f)};
+        TMXpoint tile  = tmxPixelToTile(map, corner);
+        left           = TMX_MIN(left, tile.x - 3);
+        right          = TMX_MAX(right, tile.x + 3);
+        top            = TMX_MIN(top, tile.y - 3);
+        bottom         = TMX_MAX(bottom, tile.y + 3);
+    }
+    left   = TMX_MAX(left, bounds.x);
+    top    = TMX_MAX(top, bounds.y);
+    right  = TMX_MIN(right, bounds.x + bounds.w - 1);
+    bottom = TMX_MIN(bottom, bounds.y + bounds.h - 1);
+
+    // A chunk layer is omitted when no chunk is visible, and then only the cells of its chunks must have been culled.
+    for (y = top; y <= bottom; y++)
+    {
+        for (x = left; x <= right; x++)
+        {
+            if (tmxCullCellVisible(map, x, y, v, offset) && !tmxCullContains(visible, x, y) &&
+                (visible || layer->type != TMX_LAYER_CHUNK || tmxCullNearChunk(layer, x, y, 0)))
+                errors++;
+        }
+    }
+    if (!visible)
+        return errors;
+
+    // Each culled cell is visible, except for the cells between the visible columns at the ends of stagger-x spans.
+    for (s = 0; s < visible->span_count; s++)
+    {
+        const TMXtilespan *span = &visible->spans[s];
+        if ((s && span->y <= visible->spans[s - 1].y) || span->first < bounds.x || span->last >= bounds.x + bounds.w ||
+            span->y < bounds.y || span->y >= bounds.y + bounds.h)
+            errors++;
+        for (x = span->first; x <= span->last; x++)
+        {
+            if (tmxCullCellVisible(map, x, span->y, v, offset))
+                continue;
+            if (!staggerX || x == span->first || x == span->last || !tmxCullCellVisible(map, x - 1, span->y, v, offset) ||
+                !tmxCullCellVisible(map, x + 1, span->y, v, offset))
+                errors++;
+        }
+    }
+
+    // The chunks are those with a culled cell, each listed once and ordered by row, and a listed layer has at least one.
+    if (layer->type != TMX_LAYER_CHUNK)
+        return errors + (visible->chunk_count != 0);
+    if (!visible->chunk_count)
+        errors++;
+
+    memset(marks, 0, layer->count);
+    for (i = 0; i < visible->chunk_count; i++)
+    {
+        size_t c = visible->chunks[i];
+        if (c >= layer->count || marks[c]++ ||
+            (i && layer->data.chunks[c].bounds.y < layer->data.chunks[visible->chunks[i - 1]].bounds.y))
+            errors++;
+    }
+    for (i = 0; i < layer->count; i++)
+    {
+        const TMXrect *r = &layer->data.chunks[i].bounds;
+        TMX_BOOL culled  = TMX_FALSE;
+        for (s = 0; !culled && s < visible->span_count; s++)
+        {
+            const TMXtilespan *span = &visible->spans[s];
+            culled = span->y >= r->y && span->y < r->y + r->h && span->last >= r->x && span->first < r->x + r->w;
+        }
+        if (culled != (marks[i] != 0))
+            errors++;
+    }
+    return errors;
+}
+
+/**
+ * @brief Generates viewports around the pixel extent of a layer, half of them centered on a chunk so that sparse layers
+ * are hit, and some of chunk layers on a cell between chunks. Positions are a quarter pixel off the grid, so that no
+ * edge of a cell lies exactly on an edge of a viewport.
+ */
+static void
+tmxCullViewports(const TMXmap *map, const TMXlayer *layer, TMXcullviewport *viewports, uint64_t *state)
+{
+    TMXrect bounds = tmxCullLayerBounds(layer);
+    float minX = 1e30f, minY = 1e30f, maxX = -1e30f, maxY = -1e30f;
+    size_t i, n;
+
+    for (i = 0; i < 4; i++)
+    {
+        TMXpoint corner = {.x = bounds.x + ((i & 1) ? bounds.w : 0), .y = bounds.y + ((i & 2) ? bounds.h : 0)};
+        TMXvec2 pixel   = tmxTileToPixel(map, corner);
+        minX            = TMX_MIN(minX, pixel.x);
+        minY            = TMX_MIN(minY, pixel.y);
+        maxX            = TMX_MAX(maxX, pixel.x);
+        maxY            = TMX_MAX(maxY, pixel.y);
+    }
+
+    for (i = 0; i < TMX_CULL_VIEWPORTS; i++)
+    {
+        TMXcullviewport *v = &viewports[i];
+        v->w               = (float) (1 + tmxBenchRandom(state) % 40) * (float) map->tile_size.w + 0.5f;
+        v->h               = (float) (1 + tmxBenchRandom(state) % 30) * (float) map->tile_size.h + 0.5f;
+        v->gap             = TMX_FALSE;
+
+        // A small viewport on a cell that is two cells from any chunk only overlaps empty cells, whatever the layout.
+        if (i % 8 == 2 && layer->type == TMX_LAYER_CHUNK)
+        {
+            for (n = 0; n < 256 && !v->gap; n++)
+            {
+                TMXpoint cell = {.x = bounds.x + (int) (tmxBenchRandom(state) % (uint32_t) bounds.w),
+                                 .y = bounds.y + (int) (tmxBenchRandom(state) % (uint32_t) bounds.h)};
+                if (tmxCullNearChunk(layer, cell.x, cell.y, 2))
+                    continue;
+                TMXvec2 center = tmxTileToPixel(map, cell);
+                v->x           = floorf(center.x) - 1.75f;
+                v->y           = floorf(center.y) - 1.75f;
+                v->w           = 3.0f;
+                v->h           = 3.0f;
+                v->gap         = TMX_TRUE;
+            }
+            if (v->gap)
+                continue;
+        }
+        if ((i & 1) && layer->type == TMX_LAYER_CHUNK && layer->count)
+        {
+            const TMXrect *r = &layer->data.chunks[tmxBenchRandom(state) % layer->count].bounds;
+            TMXvec2 center   = tmxTileToPixel(map, (TMXpoint){.x = r->x + r->w / 2, .y = r->y + r->h / 2});
+            v->x             = floorf(center.x - v->w * 0.5f) + 0.25f;
+            v->y             = floorf(center.y - v->h * 0.5f) + 0.25f;
+            continue;
+        }
+        v->x = floorf(minX - v->w + (float) (tmxBenchRandom(state) % (uint32_t) (maxX - minX + v->w * 2.0f))) + 0.25f;
+        v->y = floorf(minY - v->h + (float) (tmxBenchRandom(state) % (uint32_t) (maxY - minY + v->h * 2.0f))) + 0.25f;
+    }
+}
+
+/**
+ * @brief Times the culling of every viewport, and a linear pass testing each chunk against the visible bounds of each
+ * viewport, which is the least work a culler that scans every chunk does in addition to computing the spans.
+ */
+static void
+tmxCullMeasure(TMXculler *culler, const TMXlayer *layer, const TMXcullviewport *viewports, const TMXrect *bounds,
+               const TMXbenchopts *opts, double *cullSeconds, double *scanSeconds, size_t *iterations)
+{
+    const TMXvisiblelayer *visible;
+    volatile size_t sink = 0;
+    size_t n, i, c, rounds = opts->iterations ? opts->iterations : 1;
+    double start;
+
+    for (;;)
+    {
+        start = tmxBenchNow();
+        for (n = 0; n < rounds; n++)
+        {
+            for (i = 0; i < TMX_CULL_VIEWPORTS; i++)
+                sink += tmxCull(culler, viewports[i].x, viewports[i].y, viewports[i].w, viewports[i].h, &visible);
+        }
+        *cullSeconds = tmxBenchNow() - start;
+        if (opts->iterations || *cullSeconds >= opts->minSeconds)
+            break;
+        rounds *= 2;
+    }
+    *iterations = rounds;
+
+    *scanSeconds = 0.0;
+    if (layer->type != TMX_LAYER_CHUNK)
+        return;
+
+    start = tmxBenchNow();
+    for (n = 0; n < rounds; n++)
+    {
+        for (i = 0; i < TMX_CULL_VIEWPORTS; i++)
+        {
+            if (!bounds[i].w)
+                continue;
+            for (c = 0; c < layer->count; c++)
+            {
+                const TMXrect *r = &layer->data.chunks[c].bounds;
+                sink += r->x < bounds[i].x + bounds[i].w && r->x + r->w > bounds[i].x && r->y < bounds[i].y + bounds[i].h &&
+                        r->y + r->h > bounds[i].y;
+            }
+        }
+    }
+    *scanSeconds = tmxBenchNow() - start;
+}
+
+int
+tmxBenchCull(int argc, char *argv[], const TMXbenchopts *opts)
+{
+    TMXcullviewport *viewports = malloc(TMX_CULL_VIEWPORTS * sizeof(TMXcullviewport));
+    TMXrect *bounds            = calloc(TMX_CULL_VIEWPORTS, sizeof(TMXrect));
+    TMXlayer layer, *layerPtr = &layer;
+    TMXflatlayer flatLayer;
+    TMXflatlayers flat;
+    TMXmap map;
+    size_t s, k, i;
+    int kind, ok = 1;
+    (void) argc;
+    (void) argv;
+
+    for (s = 0; s < opts->sizeCount; s++)
+    {
+        int size = opts->sizes[s];
+        for (kind = 0; kind < TMX_CULL_LAYER_COUNT; kind++)
+        {
+            uint64_t state = opts->seed ? opts->seed : 1;
+            tmxCullFillLayer(&layer, (TMX_CULL_LAYER) kind, size, &state);
+            unsigned char *marks = malloc(layer.count + 1);
+
+            for (k = 0; k < sizeof(cullCases) / sizeof(cullCases[0]); k++)
+            {
+                const TMXcullcase *c = &cullCases[k];
+                const TMXvisiblelayer *visible;
+                size_t errors = 0, chunks = 0, cells = 0, gaps = 0, iterations;
+                double cullSeconds, scanSeconds;
+
+                memset(&map, 0, sizeof(TMXmap));
+                map.orientation   = c->orientation;
+                map.size.w        = size;
+                map.size.h        = size;
+                map.tile_size.w   = c->tileWidth;
+                map.tile_size.h   = c->tileHeight;
+                map.hex_side      = c->hexSide;
+                map.stagger.axis  = c->axis;
+                map.stagger.index = c->index;
+                map.layer_count   = 1;
+                map.layers        = &layerPtr;
+
+                // The layer is drawn with an offset, which the culler applies to the viewport.
+                memset(&flatLayer, 0, sizeof(TMXflatlayer));
+                flatLayer.layer      = &layer;
+                flatLayer.opacity    = 1.0f;
+                flatLayer.visible    = TMX_TRUE;
+                flatLayer.offset.x   = 3;
+                flatLayer.offset.y   = -5;
+                flatLayer.parallax.x = 1.0f;
+                flatLayer.parallax.y = 1.0f;
+                flat.count           = 1;
+                flat.layers          = &flatLayer;
+                flat.groups          = NULL;
+
+                TMXculler *culler = tmxCullerCreate(&map, &flat);
+                TMXvec2 offset    = {.x = 3.0f, .y = -5.0f};
+                if (!culler)
+                {
+                    fprintf(stderr, "cull: failed to create a culler\n");
+                    ok = 0;
+                    continue;
+                }
+
+                tmxCullViewports(&map, &layer, viewports, &state);
+                for (i = 0; i < TMX_CULL_VIEWPORTS; i++)
+                {
+                    const TMXcullviewport *v = &viewports[i];
+                    size_t count             = tmxCull(culler, v->x, v->y, v->w, v->h, &visible);
+                    errors += tmxCullVerify(&map, &layer, count ? visible : NULL, v, offset, marks);
+                    bounds[i] = count ? visible->bounds : (TMXrect){0};
+                    if (v->gap)
+                    {
+                        errors += count != 0;
+                        gaps++;
+                    }
+                    if (count)
+                    {
+                        chunks += visible->chunk_count;
+                        for (size_t n = 0; n < visible->span_count; n++)
+                            cells += (size_t) (visible->spans[n].last - visible->spans[n].first + 1);
+                    }
+                }
+                if (layer.type == TMX_LAYER_CHUNK && !gaps)
+                {
+                    fprintf(stderr, "cull: %s %s has no viewport between its chunks\n", c->name, cullLayerNames[kind]);
+                    errors++;
+                }
+                if (errors)
+                {
+                    fprintf(stderr, "cull: %s %s culled %zu incorrect cells or chunks\n", c->name, cullLayerNames[kind], errors);
+                    ok = 0;
+                    tmxFreeCuller(culler);
+                    continue;
+                }
+
+                tmxCullMeasure(culler, &layer, viewports, bounds, opts, &cullSeconds, &scanSeconds, &iterations);
+                printf("{\"bench\":\"cull\",\"layout\":\"%s\",\"layer\":\"%s\",\"size\":%d,\"chunks\":%zu,\"viewports\":%d,"
+                       "\"mean_cells\":%.1f,\"mean_chunks\":%.2f,\"iterations\":%zu,\"cull_us\":%.3f,\"scan_us\":%.3f}\n",
+                       c->name, cullLayerNames[kind], size, layer.type == TMX_LAYER_CHUNK ? layer.count : 0, TMX_CULL_VIEWPORTS,
+                       (double) cells / TMX_CULL_VIEWPORTS, (double) chunks / TMX_CULL_VIEWPORTS, iterations,
+                       cullSeconds * 1e6 / ((double) iterations * TMX_CULL_VIEWPORTS),
+                       scanSeconds * 1e6 / ((double) iterations * TMX_CULL_VIEWPORTS));
+                tmxFreeCuller(culler);
+            }
+
+            free(marks);
+            if (layer.type == TMX_LAYER_CHUNK)
+                free(layer.data.chunks);
+        }
+    }
+
+    free(viewports);
+    free(bounds);
+    return ok ? 0 : 1;
+}
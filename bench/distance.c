@@ -0,0 +1,300 @@
+#include "bench.h"
+#include "tmx/distance.h"
+#include "tmx/grids.h"
+#include <math.h>
+#include <pthread.h>
+
+/**
+ * @brief The number of threads computing ranges of columns and rows at the same time.
+ */
+#define TMX_DISTANCE_THREADS 4
+
+/**
+ * @brief The largest grid that is compared against the distance to every feature from every cell.
+ */
+#define TMX_DISTANCE_REFERENCE_SIZE 96
+
+/**
+ * @brief The number of cells of larger grids whose Euclidean distance is compared against every feature.
+ */
+#define TMX_DISTANCE_SAMPLES 64
+
+typedef struct TMXdistancethread
+{
+    TMXdistance *distance;
+    int first;
+    int count;
+    void *output;
+} TMXdistancethread;
+
+static const char *const tmxDistanceNames[] = {"euclidean", "manhattan", "chebyshev"};
+
+static uint8_t
+tmxDistanceTileSolid(const TMXmap *map, const TMXtileset *tileset, const TMXtile *tile, void *user)
+{
+    TMXproperty *property;
+    (void) map;
+    (void) tileset;
+    (void) user;
+    return tile->properties && (property = tmxGetProperty(tile->properties, "walkable")) && !property->value.integer;
+}
+
+/**
+ * @brief Computes the distance from a cell to the nearest of a list of features, in the same way as the library stores it.
+ */
+static float
+tmxDistanceNearest(TMX_DISTANCE_METRIC metric, int x, int y, const uint32_t *features, size_t count, int width)
+{
+    int64_t best = INT64_MAX;
+    size_t i;
+    for (i = 0; i < count; i++)
+    {
+        int64_t dx = llabs((int64_t) (features[i] % (uint32_t) width) - x), dy = llabs((int64_t) (features[i] / (uint32_t) width) - y);
+        int64_t d  = metric == TMX_DISTANCE_MANHATTAN ? dx + dy : metric == TMX_DISTANCE_CHEBYSHEV ? TMX_MAX(dx, dy) : dx * dx + dy * dy;
+        best       = TMX_MIN(best, d);
+    }
+    if (best == INT64_MAX)
+        return INFINITY;
+    return metric == TMX_DISTANCE_EUCLIDEAN ? (float) sqrt((double) best) : (float) best;
+}
+
+/**
+ * @brief Finds the number of steps from each cell to the nearest feature with a breadth-first search from every feature
+ * at once, the way distances to walls are often computed. Moves to the cells sharing an edge, or also a corner.
+ */
+static void
+tmxDistanceSearch(const uint8_t *grid, int width, int height, TMX_BOOL corners, uint32_t *queue, float *output)
+{
+    static const int steps[8][2] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}, {1, 1}, {-1, 1}, {1, -1}, {-1, -1}};
+    size_t cells = (size_t) width * (size_t) height, head = 0, tail = 0, i;
+    int k;
+
+    for (i = 0; i < cells; i++)
+    {
+        output[i] = grid[i] ? 0.0f : INFINITY;
+        if (grid[i])
+            queue[tail++] = (uint32_t) i;
+    }
+    while (head < tail)
+    {
+        uint32_t index = queue[head++];
+        int x = (int) (index % (uint32_t) width), y = (int) (index / (uint32_t) width);
+        for (k = 0; k < (corners ? 8 : 4); k++)
+        {
+            int nx = x + steps[k][0], ny = y + steps[k][1];
+            if (nx < 0 || ny < 0 || nx >= width || ny >= height)
+                continue;
+
+            size_t next = (size_t) ny * (size_t) width + (size_t) nx;
+            if (isinf(output[next]))
+            {
+                output[next]  = output[index] + 1.0f;
+                queue[tail++] = (uint32_t) next;
+            }
+        }
+    }
+}
+
+static void *
+tmxDistanceColumnsWorker(void *arg)
+{
+    TMXdistancethread *thread = arg;
+    tmxDistanceColumns(thread->distance, thread->first, thread->count);
+    return NULL;
+}
+
+static void *
+tmxDistanceRowsWorker(void *arg)
+{
+    TMXdistancethread *thread = arg;
+    tmxDistanceRows(thread->distance, thread->first, thread->count, TMX_DISTANCE_FLOAT, thread->output);
+    return NULL;
+}
+
+/**
+ * @brief Computes a field on several threads, splitting the columns between them and then the rows.
+ */
+static void
+tmxDistanceThreads(TMXdistance *distance, float *output)
+{
+    pthread_t threads[TMX_DISTANCE_THREADS];
+    TMXdistancethread args[TMX_DISTANCE_THREADS];
+    TMXrect region = tmxDistanceRegion(distance);
+    int i, phase;
+
+    for (phase = 0; phase < 2; phase++)
+    {
+        int length = phase ? region.h : region.w, step = (length + TMX_DISTANCE_THREADS - 1) / TMX_DISTANCE_THREADS;
+        for (i = 0; i < TMX_DISTANCE_THREADS; i++)
+        {
+            args[i].distance = distance;
+            args[i].first    = i * step;
+            args[i].count    = step;
+            args[i].output   = output;
+            pthread_create(&threads[i], NULL, phase ? tmxDistanceRowsWorker : tmxDistanceColumnsWorker, &args[i]);
+        }
+        for (i = 0; i < TMX_DISTANCE_THREADS; i++)
+            pthread_join(threads[i], NULL);
+    }
+}
+
+/**
+ * @brief Compares a field against the reference, the rounded field, and the field computed on several threads.
+ */
+static size_t
+tmxDistanceVerify(TMXdistance *distance, TMX_DISTANCE_METRIC metric, const uint8_t *grid, const float *field, const float *expected,
+                  const uint16_t *rounded, const float *threaded, uint64_t *state)
+{
+    TMXrect region = tmxDistanceRegion(distance);
+    size_t cells   = (size_t) region.w * (size_t) region.h, features = 0, errors = 0, i;
+    uint32_t *list = malloc(TMX_MAX(cells, 1) * sizeof(uint32_t));
+
+    for (i = 0; i < cells; i++)
+    {
+        if (grid[i])
+            list[features++] = (uint32_t) i;
+        if (expected && field[i] != expected[i])
+            errors++;
+        if (rounded[i] != (isinf(field[i]) ? UINT16_MAX : (uint16_t) TMX_MIN(floor((double) field[i] + 0.5), UINT16_MAX)))
+            errors++;
+    }
+    if (memcmp(field, threaded, cells * sizeof(float)))
+        errors++;
+
+    // Without a search to compare against, every cell of small grids and a sample of larger ones are measured directly.
+    if (!expected)
+    {
+        TMX_BOOL all = region.w <= TMX_DISTANCE_REFERENCE_SIZE && region.h <= TMX_DISTANCE_REFERENCE_SIZE;
+        size_t n     = all ? cells : TMX_MIN(cells, TMX_DISTANCE_SAMPLES);
+        for (i = 0; i < n; i++)
+        {
+            size_t index = all ? i : (size_t) (tmxBenchRandom(state) % cells);
+            int x = (int) (index % (size_t) region.w), y = (int) (index / (size_t) region.w);
+            float d = tmxDistanceNearest(metric, x, y, list, features, region.w);
+            if (d != field[index] && !(fabsf(d - field[index]) <= 1e-5f * d))
+                errors++;
+        }
+    }
+    free(list);
+    return errors;
+}
+
+static int
+tmxDistanceMeasure(const TMXlayer *layer, const TMXtiletable *table, TMX_DISTANCE_METRIC metric, const TMXbenchopts *opts)
+{
+    TMXdistance *distance = tmxDistanceCreate(&layer, 1, table, metric);
+    if (!distance)
+    {
+        fprintf(stderr, "distance: failed to create the transform\n");
+        return 0;
+    }
+
+    TMXrect region     = tmxDistanceRegion(distance);
+    size_t cells       = (size_t) region.w * (size_t) region.h, features = 0, errors = 0, n, i;
+    uint8_t *grid      = malloc(TMX_MAX(cells, 1));
+    float *field       = malloc(TMX_MAX(cells, 1) * sizeof(float));
+    float *threaded    = malloc(TMX_MAX(cells, 1) * sizeof(float));
+    float *expected    = NULL;
+    uint16_t *rounded  = malloc(TMX_MAX(cells, 1) * sizeof(uint16_t));
+    uint32_t *queue    = NULL;
+    uint64_t state     = opts->seed ? opts->seed : 1;
+    double start, single = 0.0, small = 0.0, parallel = 0.0, search = 0.0;
+    char baseline[64]  = "";
+
+    if (cells)
+        tmxGridFill(&layer, 1, table, region, TMX_GRID_MAX, grid);
+    for (i = 0; i < cells; i++)
+        features += grid[i] != 0;
+
+    // Manhattan and Chebyshev distances are the number of steps of a search that moves to the cells sharing an edge, or also
+    // a corner, which is also the baseline the transform is measured against.
+    if (metric != TMX_DISTANCE_EUCLIDEAN)
+    {
+        expected = malloc(TMX_MAX(cells, 1) * sizeof(float));
+        queue    = malloc(TMX_MAX(cells, 1) * sizeof(uint32_t));
+        start    = tmxBenchNow();
+        tmxDistanceSearch(grid, region.w, region.h, metric == TMX_DISTANCE_CHEBYSHEV, queue, expected);
+        search = tmxBenchNow() - start;
+        snprintf(baseline, sizeof(baseline), ",\"bfs_ns_per_cell\":%.3f", search / (double) TMX_MAX(cells, 1) * 1e9);
+    }
+
+    tmxDistanceTransform(distance, TMX_DISTANCE_FLOAT, field);
+    tmxDistanceTransform(distance, TMX_DISTANCE_UINT16, rounded);
+    tmxDistanceThreads(distance, threaded);
+    errors += tmxDistanceVerify(distance, metric, grid, field, expected, rounded, threaded, &state);
+
+    for (n = 0; n < opts->iterations || (!opts->iterations && single + small + parallel < opts->minSeconds); n++)
+    {
+        start = tmxBenchNow();
+        tmxDistanceTransform(distance, TMX_DISTANCE_FLOAT, field);
+        single += tmxBenchNow() - start;
+
+        start = tmxBenchNow();
+        tmxDistanceTransform(distance, TMX_DISTANCE_UINT16, rounded);
+        small += tmxBenchNow() - start;
+
+        start = tmxBenchNow();
+        tmxDistanceThreads(distance, threaded);
+        parallel += tmxBenchNow() - start;
+    }
+
+    printf("{\"bench\":\"distance\",\"infinite\":%s,\"width\":%d,\"height\":%d,\"metric\":\"%s\",\"features\":%zu,\"iterations\":%zu,"
+           "\"ns_per_cell\":%.3f,\"uint16_ns_per_cell\":%.3f,\"threads\":%d,\"threaded_ns_per_cell\":%.3f%s}\n",
+           layer->type == TMX_LAYER_CHUNK ? "true" : "false", region.w, region.h, tmxDistanceNames[metric], features, n,
+           single / (double) n / (double) TMX_MAX(cells, 1) * 1e9, small / (double) n / (double) TMX_MAX(cells, 1) * 1e9,
+           TMX_DISTANCE_THREADS, parallel / (double) n / (double) TMX_MAX(cells, 1) * 1e9, baseline);
+
+    if (errors)
+        fprintf(stderr, "distance: %zu mismatches against the reference (%s, %dx%d)\n", errors, tmxDistanceNames[metric], region.w,
+                region.h);
+
+    free(grid);
+    free(field);
+    free(threaded);
+    free(expected);
+    free(rounded);
+    free(queue);
+    tmxFreeDistance(distance);
+    return errors == 0;
+}
+
+int
+tmxBenchDistance(int argc, char *argv[], const TMXbenchopts *opts)
+{
+    TMXmapspec spec = {0};
+    size_t s;
+    int ok = 1, inf, metric;
+    (void) argc;
+    (void) argv;
+
+    spec.format      = TMX_FORMAT_XML;
+    spec.encoding    = TMX_ENCODING_BASE64;
+    spec.compression = TMX_COMPRESSION_ZLIB;
+    spec.tileLayers  = 1;
+    spec.seed        = opts->seed;
+
+    for (s = 0; s < opts->sizeCount; s++)
+    {
+        for (inf = 0; inf < 2; inf++)
+        {
+            spec.size     = opts->sizes[s];
+            spec.infinite = inf;
+            TMXmap *map   = tmxBenchLoadGenerated(&spec);
+            if (!map || !map->layer_count)
+            {
+                fprintf(stderr, "distance: failed to load a generated map\n");
+                tmxFreeMap(map);
+                return 1;
+            }
+
+            TMXtiletable *table = tmxTileTableCreate(map, tmxDistanceTileSolid, NULL, 0);
+            for (metric = TMX_DISTANCE_EUCLIDEAN; table && metric <= TMX_DISTANCE_CHEBYSHEV; metric++)
+                ok &= tmxDistanceMeasure(map->layers[0], table, (TMX_DISTANCE_METRIC) metric, opts);
+            ok &= table != NULL;
+
+            tmxFreeTileTable(table);
+            tmxFreeMap(map);
+        }
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,435 @@
+#include "bench.h"
+
+/**
+ * @brief The deepest level of nesting of the generated groups, where top-level layers are at depth 0.
+ */
+#define TMX_FLATTEN_DEPTH 3
+
+/**
+ * @brief The tolerance of the comparison of opacity, tint and parallax, which are products of floats.
+ */
+#define TMX_FLATTEN_EPSILON 1e-5f
+
+/**
+ * @brief The attributes of a layer with those of its ancestors applied, as computed by the reference.
+ */
+typedef struct TMXflattenstate
+{
+    const TMXlayer *parent; /** The group directly containing the layer, or NULL at the top level. */
+    float opacity;          /** The product of the opacities. */
+    TMX_BOOL visible;       /** Indicates that the layer and all of its ancestors are visible. */
+    TMXpoint offset;        /** The sum of the offsets. */
+    TMXcolorf tint;         /** The product of the tints, white when none is defined. */
+    TMXvec2 parallax;       /** The product of the parallax factors. */
+} TMXflattenstate;
+
+/**
+ * @brief Writes randomly chosen attributes of a layer, leaving some of them out so that the defaults are used.
+ */
+static void
+tmxFlattenAttributes(FILE *fp, TMX_BOOL json, uint64_t *state)
+{
+    uint32_t r = tmxBenchRandom(state);
+
+    if (r % 3)
+        fprintf(fp, json ? ",\"opacity\":%.2f" : " opacity=\"%.2f\"", 0.1 + (double) ((r >> 2) % 91) / 100.0);
+    if (r % 11 == 0)
+        fputs(json ? ",\"visible\":false" : " visible=\"0\"", fp);
+    if ((r >> 8) % 2)
+        fprintf(fp, json ? ",\"offsetx\":%d,\"offsety\":%d" : " offsetx=\"%d\" offsety=\"%d\"", (int) ((r >> 9) % 129) - 64,
+                (int) ((r >> 16) % 129) - 64);
+    if ((r >> 24) % 4 == 0)
+        fprintf(fp, json ? ",\"parallaxx\":%.1f,\"parallaxy\":%.1f" : " parallaxx=\"%.1f\" parallaxy=\"%.1f\"",
+                0.5 + (double) ((r >> 26) % 11) / 10.0, 1.5 - (double) ((r >> 20) % 11) / 10.0);
+    if ((r >> 28) % 3 == 0)
+        fprintf(fp, json ? ",\"tintcolor\":\"#%08x\"" : " tintcolor=\"#%08x\"", tmxBenchRandom(state));
+}
+
+/**
+ * @brief Writes the children of a group, or the top-level layers of the map: tile, object and image layers, and groups
+ * up to @ref TMX_FLATTEN_DEPTH. The first groups are nested within each other, so that every level is present.
+ */
+static void
+tmxFlattenWrite(FILE *fp, TMX_BOOL json, int depth, int children, int *leaves, int *groups, int *nextId, uint64_t *state)
+{
+    static const char *types[] = {"tilelayer", "objectgroup", "imagelayer"};
+    int i, kind, id;
+    uint32_t r;
+
+    for (i = 0; i < children && *leaves > 0; i++)
+    {
+        r  = tmxBenchRandom(state);
+        id = (*nextId)++;
+        if (depth < TMX_FLATTEN_DEPTH && (*groups < TMX_FLATTEN_DEPTH ? i == 0 : r % 3 == 0))
+        {
+            (*groups)++;
+            if (json)
+            {
+                fprintf(fp, "%s\n{\"type\":\"group\",\"id\":%d,\"name\":\"group %d\"", i ? "," : "", id, id);
+                tmxFlattenAttributes(fp, json, state);
+                fputs(",\"layers\":[", fp);
+                tmxFlattenWrite(fp, json, depth + 1, 2 + (int) ((r >> 4) % 4), leaves, groups, nextId, state);
+                fputs("]}", fp);
+            }
+            else
+            {
+                fprintf(fp, "<group id=\"%d\" name=\"group %d\"", id, id);
+                tmxFlattenAttributes(fp, json, state);
+                fputs(">\n", fp);
+                tmxFlattenWrite(fp, json, depth + 1, 2 + (int) ((r >> 4) % 4), leaves, groups, nextId, state);
+                fputs("</group>\n", fp);
+            }
+            continue;
+        }
+
+        (*leaves)--;
+        kind = (int) ((r >> 8) % 3);
+        if (json)
+        {
+            fprintf(fp, "%s\n{\"type\":\"%s\",\"id\":%d,\"name\":\"layer %d\"", i ? "," : "", types[kind], id, id);
+            tmxFlattenAttributes(fp, json, state);
+            switch (kind)
+            {
+                case 0: fputs(",\"width\":1,\"height\":1,\"encoding\":\"csv\",\"data\":[0]}", fp); break;
+                case 1: fputs(",\"draworder\":\"topdown\",\"objects\":[]}", fp); break;
+                default: fputs(",\"image\":\"background.png\"}", fp); break;
+            }
+            continue;
+        }
+
+        fprintf(fp, "<%s id=\"%d\" name=\"layer %d\"", kind == 0 ? "layer" : types[kind], id, id);
+        tmxFlattenAttributes(fp, json, state);
+        switch (kind)
+        {
+            case 0: fputs(" width=\"1\" height=\"1\">\n <data encoding=\"csv\">0</data>\n</layer>\n", fp); break;
+            case 1: fputs("/>\n", fp); break;
+            default: fputs(">\n <image source=\"background.png\" width=\"16\" height=\"16\"/>\n</imagelayer>\n", fp); break;
+        }
+    }
+}
+
+/**
+ * @brief Writes a map with at least @a leaves tile, object and image layers within nested groups.
+ *
+ * @param[out] groups Receives the number of groups.
+ */
+static char *
+tmxFlattenDocument(TMX_FORMAT format, int leaves, uint64_t seed, int *groups)
+{
+    TMX_BOOL json  = format == TMX_FORMAT_JSON;
+    uint64_t state = seed ? seed : 1;
+    char *text     = NULL;
+    int nextId     = 1;
+    size_t length;
+
+    FILE *fp = open_memstream(&text, &length);
+    if (!fp)
+        return NULL;
+
+    *groups = 0;
+    if (json)
+    {
+        fputs("{\"type\":\"map\",\"version\":\"1.10\",\"tiledversion\":\"1.10.1\",\"orientation\":\"orthogonal\",\"renderorder\":"
+              "\"right-down\",\"width\":1,\"height\":1,\"tilewidth\":16,\"tileheight\":16,\"infinite\":false,\"nextobjectid\":1,"
+              "\"tilesets\":[],\n\"layers\":[",
+              fp);
+        tmxFlattenWrite(fp, json, 0, INT32_MAX, &leaves, groups, &nextId, &state);
+        fprintf(fp, "],\"nextlayerid\":%d}\n", nextId);
+    }
+    else
+    {
+        fputs("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<map version=\"1.10\" tiledversion=\"1.10.1\" orientation=\"orthogonal\" "
+              "renderorder=\"right-down\" width=\"1\" height=\"1\" tilewidth=\"16\" tileheight=\"16\" infinite=\"0\" "
+              "nextobjectid=\"1\">\n",
+              fp);
+        tmxFlattenWrite(fp, json, 0, INT32_MAX, &leaves, groups, &nextId, &state);
+        fputs("</map>\n", fp);
+    }
+
+    fclose(fp);
+    return text;
+}
+
+/**
+ * @brief Retrieves the tint of a layer as a vector color, white when none is defined.
+ */
+static TMXcolorf
+tmxFlattenTint(const TMXlayer *layer)
+{
+    TMXcolorf white = {1.0f, 1.0f, 1.0f, 1.0f};
+    if (!TMX_HAS_FLAG(layer->flags, TMX_FLAG_COLOR))
+        return white;
+#ifdef TMX_VECTOR_COLOR
+    return layer->tint_color;
+#else
+    return tmxColorF(layer->tint_color);
+#endif
+}
+
+static TMX_BOOL
+tmxFlattenNear(float a, float b)
+{
+    return a - b <= TMX_FLATTEN_EPSILON && b - a <= TMX_FLATTEN_EPSILON;
+}
+
+/**
+ * @brief Walks the layer hierarchy, applying the attributes of each group to its children, and compares the state of
+ * each leaf layer with the next entry of the flattened list.
+ *
+ * @return The number of entries that differ.
+ */
+static size_t
+tmxFlattenVerifyRange(const TMXflatlayers *flat, TMXlayer **layers, size_t count, const TMXflattenstate *parent, size_t *index,
+                     int depth, int *maxDepth)
+{
+    TMXflattenstate state;
+    const TMXflatlayer *entry;
+    TMXcolorf tint;
+    size_t i, errors = 0;
+
+    for (i = 0; i < count; i++)
+    {
+        const TMXlayer *layer = layers[i];
+        tint                  = tmxFlattenTint(layer);
+        state.parent          = depth ? parent->parent : NULL;
+        state.opacity         = parent->opacity * layer->opacity;
+        state.visible         = parent->visible && layer->visible;
+        state.offset.x        = parent->offset.x + layer->offset.x;
+        state.offset.y        = parent->offset.y + layer->offset.y;
+        state.tint.r          = parent->tint.r * tint.r;
+        state.tint.g          = parent->tint.g * tint.g;
+        state.tint.b          = parent->tint.b * tint.b;
+        state.tint.a          = parent->tint.a * tint.a;
+        state.parallax.x      = parent->parallax.x * layer->parallax.x;
+        state.parallax.y      = parent->parallax.y * layer->parallax.y;
+
+        if (layer->type == TMX_LAYER_GROUP)
+        {
+            *maxDepth    = TMX_MAX(*maxDepth, depth + 1);
+            state.parent = layer;
+            errors += tmxFlattenVerifyRange(flat, layer->data.group, layer->count, &state, index, depth + 1, maxDepth);
+            continue;
+        }
+
+        if (*index >= flat->count)
+        {
+            errors++;
+            continue;
+        }
+        entry = &flat->layers[(*index)++];
+        if (entry->layer != layer || entry->parent != state.parent || entry->visible != state.visible ||
+            entry->offset.x != state.offset.x || entry->offset.y != state.offset.y || !tmxFlattenNear(entry->opacity, state.opacity) ||
+            !tmxFlattenNear(entry->tint.r, state.tint.r) || !tmxFlattenNear(entry->tint.g, state.tint.g) ||
+            !tmxFlattenNear(entry->tint.b, state.tint.b) || !tmxFlattenNear(entry->tint.a, state.tint.a) ||
+            !tmxFlattenNear(entry->parallax.x, state.parallax.x) || !tmxFlattenNear(entry->parallax.y, state.parallax.y))
+            errors++;
+    }
+    return errors;
+}
+
+/**
+ * @brief Compares every entry of the flattened list with the reference, and that the list has one entry per leaf layer.
+ *
+ * @return The number of entries that differ.
+ */
+static size_t
+tmxFlattenVerify(const TMXmap *map, const TMXflatlayers *flat, int *maxDepth)
+{
+    TMXflattenstate root = {NULL, 1.0f, TMX_TRUE, {0, 0}, {1.0f, 1.0f, 1.0f, 1.0f}, {1.0f, 1.0f}};
+    size_t index = 0, errors;
+
+    *maxDepth = 0;
+    errors    = tmxFlattenVerifyRange(flat, map->layers, map->layer_count, &root, &index, 0, maxDepth);
+    return errors + (index != flat->count);
+}
+
+/**
+ * @brief Collects the groups of a layer list and its descendants in document order, so that parents precede children.
+ */
+static size_t
+tmxFlattenGroups(TMXlayer **layers, size_t count, TMXlayer **output, size_t capacity, size_t found)
+{
+    size_t i;
+    for (i = 0; i < count; i++)
+    {
+        if (layers[i]->type != TMX_LAYER_GROUP)
+            continue;
+        if (found < capacity)
+            output[found++] = layers[i];
+        found = tmxFlattenGroups(layers[i]->data.group, layers[i]->count, output, capacity, found);
+    }
+    return found;
+}
+
+/**
+ * @brief Changes every attribute that groups pass on to their children. The tint is removed when defined, and otherwise
+ * copied from @a donor.
+ */
+static void
+tmxFlattenEdit(TMXlayer *layer, const TMXlayer *donor, size_t n)
+{
+    layer->opacity *= 0.5f;
+    layer->visible = !layer->visible;
+    layer->offset.x += 7 + (int) n;
+    layer->offset.y -= 5;
+    layer->parallax.x *= 1.5f;
+    layer->parallax.y = 0.25f + (float) (n % 4) * 0.25f;
+    if (TMX_HAS_FLAG(layer->flags, TMX_FLAG_COLOR))
+        layer->flags &= ~TMX_FLAG_COLOR;
+    else if (TMX_HAS_FLAG(donor->flags, TMX_FLAG_COLOR))
+    {
+        layer->tint_color = donor->tint_color;
+        layer->flags |= TMX_FLAG_COLOR;
+    }
+}
+
+/**
+ * @brief Changes the attributes of each group in turn, outermost first, and then of some of the leaf layers, updating
+ * the list with @ref tmxFlatLayersUpdate and comparing it with the reference after each change.
+ *
+ * @return Non-zero when the list matches the reference after every update.
+ */
+static int
+tmxFlattenVerifyUpdates(TMXmap *map, TMXflatlayers *flat, TMXlayer **groups, size_t groupCount, const char *name)
+{
+    size_t i, errors;
+    int depth;
+
+    for (i = 0; i < groupCount; i++)
+    {
+        tmxFlattenEdit(groups[i], groups[(i + 1) % groupCount], i);
+        if (!tmxFlatLayersUpdate(flat, groups[i]) || (errors = tmxFlattenVerify(map, flat, &depth)))
+        {
+            fprintf(stderr, "flatten: %zu layers of the %s map differ from the reference after changing group %d\n", errors, name,
+                    groups[i]->id);
+            return 0;
+        }
+    }
+
+    for (i = 0; i < flat->count; i += 7)
+    {
+        TMXlayer *layer = (TMXlayer *) flat->layers[i].layer;
+        tmxFlattenEdit(layer, groups[i % groupCount], i);
+        if (!tmxFlatLayersUpdate(flat, layer) || (errors = tmxFlattenVerify(map, flat, &depth)))
+        {
+            fprintf(stderr, "flatten: %zu layers of the %s map differ from the reference after changing layer %d\n", errors, name,
+                    layer->id);
+            return 0;
+        }
+    }
+
+    // Every layer at once, after changing the top-level layers.
+    for (i = 0; i < map->layer_count; i++)
+        tmxFlattenEdit(map->layers[i], groups[0], i);
+    if (!tmxFlatLayersUpdate(flat, NULL) || (errors = tmxFlattenVerify(map, flat, &depth)))
+    {
+        fprintf(stderr, "flatten: %zu layers of the %s map differ from the reference after updating every layer\n", errors, name);
+        return 0;
+    }
+    return 1;
+}
+
+/**
+ * @brief Times creating and freeing the list, updating every layer, and updating the layers of each group in turn.
+ */
+static void
+tmxFlattenMeasure(const TMXmap *map, TMXflatlayers *flat, TMXlayer **groups, size_t groupCount, const TMXbenchopts *opts,
+                 double *flattenSeconds, double *updateSeconds, double *groupSeconds, size_t *iterations)
+{
+    size_t n, i, rounds = opts->iterations ? opts->iterations : 1;
+    double start;
+
+    for (;;)
+    {
+        start = tmxBenchNow();
+        for (n = 0; n < rounds; n++)
+            tmxFreeFlatLayers(tmxMapFlattenLayers(map));
+        *flattenSeconds = tmxBenchNow() - start;
+        if (opts->iterations || *flattenSeconds >= opts->minSeconds)
+            break;
+        rounds *= 2;
+    }
+    *iterations = rounds;
+
+    start = tmxBenchNow();
+    for (n = 0; n < rounds; n++)
+        tmxFlatLayersUpdate(flat, NULL);
+    *updateSeconds = tmxBenchNow() - start;
+
+    start = tmxBenchNow();
+    for (n = 0; n < rounds; n++)
+    {
+        for (i = 0; i < groupCount; i++)
+            tmxFlatLayersUpdate(flat, groups[i]);
+    }
+    *groupSeconds = tmxBenchNow() - start;
+}
+
+int
+tmxBenchFlatten(int argc, char *argv[], const TMXbenchopts *opts)
+{
+    static const TMX_FORMAT formats[] = {TMX_FORMAT_XML, TMX_FORMAT_JSON};
+    double flattenSeconds, updateSeconds, groupSeconds;
+    size_t s, f, errors, groupCount, iterations;
+    TMXflatlayers *flat;
+    TMXlayer **groups;
+    const char *name;
+    TMXmap *map;
+    char *text;
+    int ok = 1, groupTotal, depth;
+    (void) argc;
+    (void) argv;
+
+    for (s = 0; ok && s < opts->sizeCount; s++)
+    {
+        for (f = 0; ok && f < sizeof(formats) / sizeof(formats[0]); f++)
+        {
+            name = formats[f] == TMX_FORMAT_JSON ? "json" : "xml";
+            if (!(text = tmxFlattenDocument(formats[f], opts->sizes[s], opts->seed, &groupTotal)))
+            {
+                fprintf(stderr, "flatten: failed to write a map\n");
+                ok = 0;
+                break;
+            }
+            map = tmxParseMap(text, NULL, formats[f]);
+            free(text);
+            if (!map || !(flat = tmxMapFlattenLayers(map)))
+            {
+                fprintf(stderr, "flatten: failed to parse and flatten a map\n");
+                tmxFreeMap(map);
+                ok = 0;
+                break;
+            }
+
+            groups     = malloc((size_t) groupTotal * sizeof(TMXlayer *));
+            groupCount = groups ? tmxFlattenGroups(map->layers, map->layer_count, groups, (size_t) groupTotal, 0) : 0;
+            if ((errors = tmxFlattenVerify(map, flat, &depth)))
+            {
+                fprintf(stderr, "flatten: %zu of %zu layers of the %s map differ from the reference\n", errors, flat->count, name);
+                ok = 0;
+            }
+            else if (depth < TMX_FLATTEN_DEPTH || groupCount != (size_t) groupTotal)
+            {
+                fprintf(stderr, "flatten: the %s map has %zu groups nested %d deep instead of %d groups nested %d deep\n", name,
+                        groupCount, depth, groupTotal, TMX_FLATTEN_DEPTH);
+                ok = 0;
+            }
+            else
+            {
+                tmxFlattenMeasure(map, flat, groups, groupCount, opts, &flattenSeconds, &updateSeconds, &groupSeconds, &iterations);
+                ok = tmxFlattenVerifyUpdates(map, flat, groups, groupCount, name);
+                if (ok)
+                    printf("{\"bench\":\"flatten\",\"format\":\"%s\",\"layers\":%zu,\"groups\":%zu,\"depth\":%d,\"iterations\":%zu,"
+                           "\"flatten_us\":%.3f,\"update_us\":%.3f,\"group_ns\":%.3f}\n",
+                           name, flat->count, groupCount, depth, iterations, flattenSeconds * 1e6 / (double) iterations,
+                           updateSeconds * 1e6 / (double) iterations,
+                           groupSeconds * 1e9 / (double) (iterations * groupCount));
+            }
+
+            free(groups);
+            tmxFreeFlatLayers(flat);
+            tmxFreeMap(map);
+        }
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,263 @@
+#include "bench.h"
+#include "tmx/grids.h"
+
+/**
+ * @brief Evaluates the movement cost of a tile from its properties, or 0 when it cannot be walked on.
+ */
+static uint8_t
+tmxGridsCost(const TMXtile *tile)
+{
+    TMXproperty *property;
+    if (!tile || !tile->properties)
+        return 1;
+    if ((property = tmxGetProperty(tile->properties, "walkable")) && !property->value.integer)
+        return 0;
+    if ((property = tmxGetProperty(tile->properties, "cost")))
+        return (uint8_t) TMX_MAX(1, TMX_MIN(255, property->value.integer));
+    return 1;
+}
+
+static uint8_t
+tmxGridsTileCost(const TMXmap *map, const TMXtileset *tileset, const TMXtile *tile, void *user)
+{
+    (void) map;
+    (void) tileset;
+    (void) user;
+    return tmxGridsCost(tile);
+}
+
+/**
+ * @brief Computes the value of a cell as without a table: finding the tile of its GID, and looking up its properties.
+ */
+static uint8_t
+tmxGridsReference(const TMXmap *map, TMXgid gid, uint8_t empty)
+{
+    TMXtid id;
+    TMXtileset *tileset;
+    size_t i;
+
+    if (!(gid & TMX_GID_TILE_MASK) || !(tileset = tmxMapTileset(map, gid & TMX_GID_TILE_MASK, &id)))
+        return empty;
+    if (tileset->columns > 0 && id < tileset->tile_count)
+        return tmxGridsCost(&tileset->tiles[id]);
+    for (i = 0; tileset->columns <= 0 && i < tileset->tile_count; i++)
+    {
+        if (tileset->tiles[i].id == id)
+            return tmxGridsCost(&tileset->tiles[i]);
+    }
+    return empty;
+}
+
+/**
+ * @brief Retrieves the GID of a cell of a layer, or 0 when outside of it.
+ */
+static TMXgid
+tmxGridsCell(const TMXlayer *layer, int x, int y)
+{
+    size_t i;
+    if (layer->type == TMX_LAYER_TILE)
+    {
+        if (x < 0 || y < 0 || x >= layer->size.w || y >= layer->size.h)
+            return 0;
+        return layer->data.tiles[(size_t) y * (size_t) layer->size.w + (size_t) x];
+    }
+    for (i = 0; i < layer->count; i++)
+    {
+        const TMXchunk *chunk = &layer->data.chunks[i];
+        if (x >= chunk->bounds.x && y >= chunk->bounds.y && x < chunk->bounds.x + chunk->bounds.w && y < chunk->bounds.y + chunk->bounds.h)
+            return chunk->gids[(size_t) (y - chunk->bounds.y) * (size_t) chunk->bounds.w + (size_t) (x - chunk->bounds.x)];
+    }
+    return 0;
+}
+
+/**
+ * @brief Computes the combined value of a cell of a layer stack with the reference lookup.
+ */
+static uint8_t
+tmxGridsCombined(const TMXmap *map, const TMXlayer *const *layers, size_t count, int x, int y, TMX_GRID_COMBINE combine, uint8_t empty)
+{
+    uint8_t result = empty;
+    size_t i;
+    for (i = 0; i < count; i++)
+    {
+        TMXgid gid    = tmxGridsCell(layers[i], x, y);
+        uint8_t value = tmxGridsReference(map, gid, empty);
+        if (combine == TMX_GRID_TOP)
+            result = (gid & TMX_GID_TILE_MASK) ? value : result;
+        else if (i == 0)
+            result = value;
+        else
+            result = combine == TMX_GRID_MIN ? TMX_MIN(result, value) : TMX_MAX(result, value);
+    }
+    return result;
+}
+
+/**
+ * @brief Fills bytes and bits for every combine mode over a region overhanging the top-left of the map, and compares each
+ * cell. Large maps are only compared near the corner, as the reference searches the chunks of each cell. The region must
+ * contain tiles with a cost and tiles that cannot be walked on, so that the properties are known to have been read.
+ */
+static int
+tmxGridsVerify(const TMXmap *map, const TMXlayer *const *layers, size_t count, const TMXtiletable *table, uint8_t empty)
+{
+    TMXrect region = {.x = -5, .y = -3, .w = TMX_MIN(map->size.w, 160) + 9, .h = TMX_MIN(map->size.h, 90) + 70};
+    size_t words   = ((size_t) region.w + 63) / 64;
+    uint8_t *bytes = malloc((size_t) region.w * (size_t) region.h);
+    uint64_t *bits = malloc(words * (size_t) region.h * sizeof(uint64_t));
+    size_t errors = 0, costly = 0, blocked = 0, n;
+    int x, y, mode;
+
+    for (n = 1; n <= count && bytes && bits; n++)
+    {
+        for (mode = TMX_GRID_TOP; mode <= TMX_GRID_MAX; mode++)
+        {
+            if (!tmxGridFill(layers, n, table, region, (TMX_GRID_COMBINE) mode, bytes) ||
+                !tmxGridFillBits(layers, n, table, region, (TMX_GRID_COMBINE) mode, bits))
+            {
+                errors++;
+                continue;
+            }
+            for (y = 0; y < region.h; y++)
+            {
+                for (x = 0; x < region.w; x++)
+                {
+                    uint8_t expected = tmxGridsCombined(map, layers, n, region.x + x, region.y + y, (TMX_GRID_COMBINE) mode, empty);
+                    uint64_t bit     = (bits[(size_t) y * words + (size_t) x / 64] >> (x % 64)) & 1;
+                    errors += bytes[(size_t) y * (size_t) region.w + (size_t) x] != expected;
+                    errors += bit != (expected != 0);
+                    costly += expected > 1;
+                    blocked += expected == 0;
+                }
+                for (x = region.w; x < (int) (words * 64); x++)
+                    errors += (bits[(size_t) y * words + (size_t) x / 64] >> (x % 64)) & 1;
+            }
+        }
+    }
+
+    if (errors || !bytes || !bits)
+        fprintf(stderr, "grids: %s layers filled %zu incorrect cells\n", layers[0]->type == TMX_LAYER_CHUNK ? "infinite" : "finite",
+                errors);
+    else if (!costly || !blocked)
+        fprintf(stderr, "grids: %s layers have %zu cells with a cost and %zu that cannot be walked on\n",
+                layers[0]->type == TMX_LAYER_CHUNK ? "infinite" : "finite", costly, blocked);
+    free(bytes);
+    free(bits);
+    return errors == 0 && costly && blocked && bytes && bits;
+}
+
+static int
+tmxGridsMeasure(TMXmap *map, const TMXbenchopts *opts)
+{
+    const TMXlayer *layers[2];
+    TMXrect region = {.x = 0, .y = 0, .w = map->size.w, .h = map->size.h};
+    size_t i, n, iterations, count = 0, cells = (size_t) region.w * (size_t) region.h;
+    size_t words = ((size_t) region.w + 63) / 64;
+    double start, create, fill = 0.0, bits = 0.0, stack = 0.0, lookup;
+    volatile uint8_t sink = 0;
+
+    for (i = 0; i < map->layer_count && count < 2; i++)
+    {
+        if (map->layers[i]->type == TMX_LAYER_TILE || map->layers[i]->type == TMX_LAYER_CHUNK)
+            layers[count++] = map->layers[i];
+    }
+
+    start               = tmxBenchNow();
+    TMXtiletable *table = tmxTileTableCreate(map, tmxGridsTileCost, NULL, 1);
+    create              = tmxBenchNow() - start;
+    if (!table || !count || !tmxGridsVerify(map, layers, count, table, 1))
+    {
+        tmxFreeTileTable(table);
+        return 0;
+    }
+
+    uint8_t *output  = malloc(cells);
+    uint64_t *bitmap = malloc(words * (size_t) region.h * sizeof(uint64_t));
+    if (!output || !bitmap)
+    {
+        free(output);
+        free(bitmap);
+        tmxFreeTileTable(table);
+        return 0;
+    }
+
+    for (n = 0; n < opts->iterations || (!opts->iterations && fill < opts->minSeconds); n++)
+    {
+        start = tmxBenchNow();
+        tmxGridFill(layers, 1, table, region, TMX_GRID_TOP, output);
+        fill += tmxBenchNow() - start;
+
+        start = tmxBenchNow();
+        tmxGridFillBits(layers, 1, table, region, TMX_GRID_TOP, bitmap);
+        bits += tmxBenchNow() - start;
+
+        start = tmxBenchNow();
+        tmxGridFill(layers, count, table, region, TMX_GRID_MAX, output);
+        stack += tmxBenchNow() - start;
+    }
+    iterations = n;
+
+    // The baseline looks up the properties of the tile of every cell, as without a table.
+    start = tmxBenchNow();
+    if (layers[0]->type == TMX_LAYER_TILE)
+    {
+        for (i = 0; i < cells; i++)
+            sink ^= tmxGridsReference(map, layers[0]->data.tiles[i], 1);
+    }
+    for (i = 0; layers[0]->type == TMX_LAYER_CHUNK && i < layers[0]->count; i++)
+    {
+        const TMXchunk *chunk = &layers[0]->data.chunks[i];
+        for (n = 0; n < chunk->count; n++)
+            sink ^= tmxGridsReference(map, chunk->gids[n], 1);
+    }
+    lookup = tmxBenchNow() - start;
+    (void) sink;
+
+    printf("{\"bench\":\"grids\",\"infinite\":%s,\"width\":%d,\"height\":%d,\"layers\":%zu,\"gids\":%zu,\"table_us\":%.3f,"
+           "\"iterations\":%zu,\"ns_per_cell\":%.3f,\"bits_ns_per_cell\":%.3f,\"stack_ns_per_cell\":%.3f,\"lookup_ns_per_cell\":%.3f,"
+           "\"grid_bytes\":%zu,\"bitmap_bytes\":%zu}\n",
+           layers[0]->type == TMX_LAYER_CHUNK ? "true" : "false", map->size.w, map->size.h, count, table->count, create * 1e6, iterations,
+           fill / (double) iterations / (double) cells * 1e9, bits / (double) iterations / (double) cells * 1e9,
+           stack / (double) iterations / (double) cells * 1e9,
+           lookup / (double) cells * 1e9, cells, words * (size_t) region.h * sizeof(uint64_t));
+
+    free(output);
+    free(bitmap);
+    tmxFreeTileTable(table);
+    return 1;
+}
+
+int
+tmxBenchGrids(int argc, char *argv[], const TMXbenchopts *opts)
+{
+    TMXmapspec spec = {0};
+    size_t s;
+    int inf, ok = 1;
+    (void) argc;
+    (void) argv;
+
+    spec.format      = TMX_FORMAT_XML;
+    spec.encoding    = TMX_ENCODING_BASE64;
+    spec.compression = TMX_COMPRESSION_ZLIB;
+    spec.tileLayers  = 2;
+    spec.seed        = opts->seed;
+
+    for (s = 0; s < opts->sizeCount; s++)
+    {
+        for (inf = 0; inf < 2; inf++)
+        {
+            spec.size     = opts->sizes[s];
+            spec.infinite = inf;
+            TMXmap *map   = tmxBenchLoadGenerated(&spec);
+            if (!map || !map->layer_count)
+            {
+                fprintf(stderr, "grids: failed to load a generated map\n");
+                tmxFreeMap(map);
+                return 1;
+            }
+
+            ok &= tmxGridsMeasure(map, opts);
+            tmxFreeMap(map);
+        }
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,93 @@
+#include "bench.h"
+#include "tmx/compression.h"
+
+typedef size_t (*TMXinflatefunc)(const void *input, size_t inputSize, void *output, size_t outputSize);
+
+static int
+tmxBenchMeasure(const char *format, const char *backend, int level, int size, TMXinflatefunc func, const uint8_t *input,
+                size_t inputSize, const uint8_t *expected, size_t expectedSize, const TMXbenchopts *opts)
+{
+    uint8_t *output = malloc(expectedSize);
+    size_t iterations, n;
+    double start, elapsed;
+
+    // Validate once before timing, so that a broken decoder cannot report a result.
+    if (func(input, inputSize, output, expectedSize) != expectedSize || memcmp(output, expected, expectedSize))
+    {
+        fprintf(stderr, "inflate: %s/%s produced incorrect output\n", format, backend);
+        free(output);
+        return 0;
+    }
+
+    iterations = opts->iterations;
+    if (!iterations)
+    {
+        // Double the batch until it runs for the requested minimum time.
+        for (n = 1;; n *= 2)
+        {
+            size_t i;
+            start = tmxBenchNow();
+            for (i = 0; i < n; i++)
+                func(input, inputSize, output, expectedSize);
+            elapsed = tmxBenchNow() - start;
+            if (elapsed >= opts->minSeconds)
+                break;
+        }
+        iterations = n;
+    }
+    else
+    {
+        start = tmxBenchNow();
+        for (n = 0; n < iterations; n++)
+            func(input, inputSize, output, expectedSize);
+        elapsed = tmxBenchNow() - start;
+    }
+
+    printf("{\"bench\":\"inflate\",\"format\":\"%s\",\"backend\":\"%s\",\"level\":%d,\"width\":%d,\"height\":%d,"
+           "\"compressed_bytes\":%zu,\"bytes\":%zu,\"iterations\":%zu,\"seconds\":%.6f,\"mb_per_s\":%.2f}\n",
+           format, backend, level, size, size, inputSize, expectedSize, iterations, elapsed,
+           (double) expectedSize * (double) iterations / elapsed / 1e6);
+    free(output);
+    return 1;
+}
+
+int
+tmxBenchInflate(int argc, char *argv[], const TMXbenchopts *opts)
+{
+    static const int levels[] = {1, 6, 9};
+    size_t s, l;
+    int ok = 1;
+
+    (void) argc;
+    (void) argv;
+
+    for (s = 0; s < opts->sizeCount; s++)
+    {
+        int size     = opts->sizes[s];
+        size_t count = (size_t) size * (size_t) size;
+        size_t bytes = count * sizeof(uint32_t);
+
+        uint32_t *gids = malloc(bytes);
+        uint8_t *data  = malloc(bytes);
+        tmxBenchTileData(gids, count, opts->seed);
+        tmxBenchStoreLE(data, gids, count);
+
+        for (l = 0; l < sizeof(levels) / sizeof(levels[0]); l++)
+        {
+            size_t gzipSize = 0, zlibSize = 0;
+            uint8_t *gzip = tmxBenchCompress(TMX_COMPRESSION_GZIP, data, bytes, levels[l], &gzipSize);
+            uint8_t *zlib = tmxBenchCompress(TMX_COMPRESSION_ZLIB, data, bytes, levels[l], &zlibSize);
+
+            ok &= tmxBenchMeasure("gzip", tmxInflateBackend(), levels[l], size, tmxInflateGzip, gzip, gzipSize, data, bytes, opts);
+            ok &= tmxBenchMeasure("zlib", tmxInflateBackend(), levels[l], size, tmxInflateZlib, zlib, zlibSize, data, bytes, opts);
+            ok &= tmxBenchMeasure("zlib", "reference", levels[l], size, tmxBenchZlibReference, zlib, zlibSize, data, bytes, opts);
+
+            free(gzip);
+            free(zlib);
+        }
+
+        free(gids);
+        free(data);
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,354 @@
+#include "bench.h"
+#include "tmx/memory.h"
+#include "tmx/stats.h"
+#include "tmx/trace.h"
+#include <unistd.h>
+
+typedef enum TMX_BENCH_PHASE
+{
+    TMX_BENCH_READ,
+    TMX_BENCH_PARSE,
+    TMX_BENCH_FREE,
+    TMX_BENCH_PHASE_COUNT
+} TMX_BENCH_PHASE;
+
+static const char *phaseNames[TMX_BENCH_PHASE_COUNT] = {"read", "parse", "free"};
+
+typedef struct TMXbenchphase
+{
+    double seconds;
+    TMXbenchallocs allocs;
+    long peakRss;
+} TMXbenchphase;
+
+typedef struct TMXbenchtimer
+{
+    double start;
+    TMXbenchallocs allocs;
+} TMXbenchtimer;
+
+static void
+tmxPhaseBegin(TMXbenchtimer *timer)
+{
+    tmxBenchResetPeakRss();
+    tmxBenchAllocCounters(&timer->allocs);
+    timer->start = tmxBenchNow();
+}
+
+static void
+tmxPhaseEnd(TMXbenchtimer *timer, TMXbenchphase *stats, TMX_BOOL first)
+{
+    TMXbenchallocs allocs;
+    stats->seconds += tmxBenchNow() - timer->start;
+    tmxBenchAllocCounters(&allocs);
+
+    // Allocations and memory are deterministic, so only the first iteration is recorded.
+    if (first)
+    {
+        stats->allocs.count = allocs.count - timer->allocs.count;
+        stats->allocs.bytes = allocs.bytes - timer->allocs.bytes;
+        stats->peakRss      = tmxBenchPeakRss();
+    }
+}
+
+/**
+ * @brief Accumulates the timings of the library's own load statistics, keeping the (deterministic) counters of the latest load.
+ */
+static void
+tmxBenchAddLoadStats(TMXloadstats *total, const TMXloadstats *stats)
+{
+    int p;
+    double seconds = total->seconds + stats->seconds;
+    TMXphasestats phases[TMX_PHASE_COUNT];
+
+    for (p = 0; p < TMX_PHASE_COUNT; p++)
+    {
+        phases[p]              = stats->phases[p];
+        phases[p].seconds      += total->phases[p].seconds;
+        phases[p].self_seconds += total->phases[p].self_seconds;
+    }
+
+    *total         = *stats;
+    total->seconds = seconds;
+    memcpy(total->phases, phases, sizeof(phases));
+}
+
+static void
+tmxBenchPrintLoadStats(const TMXloadstats *stats, size_t iterations)
+{
+    int p;
+    double n = (double) iterations;
+
+    printf(",\"library\":{\"seconds\":%.6f,\"files_read\":%zu,\"cache_hits\":%zu,\"cache_misses\":%zu,\"allocations\":%zu,"
+           "\"allocated_bytes\":%zu,\"phases\":{",
+           stats->seconds / n, stats->files_read, stats->cache_hits, stats->cache_misses, stats->allocations, stats->allocated_bytes);
+    for (p = 0; p < TMX_PHASE_COUNT; p++)
+    {
+        const TMXphasestats *phase = &stats->phases[p];
+        printf("%s\"%s\":{\"seconds\":%.6f,\"self_seconds\":%.6f,\"bytes\":%zu,\"count\":%zu}", p ? "," : "", tmxPhaseName(p),
+               phase->seconds / n, phase->self_seconds / n, phase->bytes, phase->count);
+    }
+    printf("}}");
+}
+
+static char *
+tmxBenchReadFile(const char *path, size_t *size)
+{
+    FILE *fp = fopen(path, "rb");
+    char *text;
+    long len;
+
+    if (!fp)
+        return NULL;
+    fseek(fp, 0, SEEK_END);
+    len = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+
+    text = malloc((size_t) len + 1);
+    *size = fread(text, 1, (size_t) len, fp);
+    text[*size] = '\0';
+    fclose(fp);
+    return text;
+}
+
+static void
+tmxBenchCountMap(const TMXmap *map, size_t *tiles, size_t *objects)
+{
+    size_t i, j;
+    *tiles   = 0;
+    *objects = 0;
+    for (i = 0; i < map->layer_count; i++)
+    {
+        const TMXlayer *layer = map->layers[i];
+        switch (layer->type)
+        {
+            case TMX_LAYER_TILE: *tiles += layer->count; break;
+            case TMX_LAYER_CHUNK:
+                for (j = 0; j < layer->count; j++)
+                    *tiles += layer->data.chunks[j].count;
+                break;
+            case TMX_LAYER_OBJGROUP: *objects += layer->count; break;
+            default: break;
+        }
+    }
+}
+
+/**
+ * @brief Measures loading of a single generated map, split into reading the file, parsing, and freeing the result.
+ *
+ * @details With @a withStats, the library's own per-phase statistics (see tmx/stats.h) are also reported. They are left
+ * disabled otherwise, so that the headline numbers are not affected by the instrumentation. With @a withPools, nodes
+ * are taken from the library's node pools, so after the first iteration objects and layers are recycled rather than
+ * allocated.
+ */
+static int
+tmxBenchLoadMap(const TMXmapspec *spec, const char *filename, size_t fileBytes, TMX_BOOL withStats, TMX_BOOL withPools,
+                const TMXbenchopts *opts)
+{
+    TMXbenchphase stats[TMX_BENCH_PHASE_COUNT];
+    TMXbenchtimer timer;
+    TMXloadstats loadStats, loadTotal;
+    size_t iterations = opts->iterations ? opts->iterations : 1, n, size, tiles = 0, objects = 0, retained = 0;
+    double elapsed = 0.0;
+    char name[128];
+    char *text;
+    TMXmap *map;
+    int p;
+
+    memset(stats, 0, sizeof(stats));
+    memset(&loadTotal, 0, sizeof(loadTotal));
+    tmxLoadStats(withStats ? &loadStats : NULL);
+    tmxMemoryPools(withPools);
+    for (n = 0; n < iterations || (!opts->iterations && elapsed < opts->minSeconds); n++)
+    {
+        tmxPhaseBegin(&timer);
+        text = tmxBenchReadFile(filename, &size);
+        tmxPhaseEnd(&timer, &stats[TMX_BENCH_READ], n == 0);
+        if (!text)
+        {
+            fprintf(stderr, "load: failed to read \"%s\"\n", filename);
+            tmxLoadStats(NULL);
+            tmxMemoryPools(TMX_FALSE);
+            return 0;
+        }
+
+        tmxPhaseBegin(&timer);
+        map = tmxParseMap(text, NULL, spec->format);
+        tmxPhaseEnd(&timer, &stats[TMX_BENCH_PARSE], n == 0);
+        if (withStats)
+            tmxBenchAddLoadStats(&loadTotal, &loadStats);
+        free(text);
+        if (!map)
+        {
+            fprintf(stderr, "load: failed to parse \"%s\"\n", filename);
+            tmxLoadStats(NULL);
+            tmxMemoryPools(TMX_FALSE);
+            return 0;
+        }
+        if (n == 0)
+        {
+            tmxBenchCountMap(map, &tiles, &objects);
+            retained = tmxMapMemoryUsage(map);
+        }
+
+        tmxPhaseBegin(&timer);
+        tmxFreeMap(map);
+        tmxPhaseEnd(&timer, &stats[TMX_BENCH_FREE], n == 0);
+
+        elapsed = stats[TMX_BENCH_READ].seconds + stats[TMX_BENCH_PARSE].seconds + stats[TMX_BENCH_FREE].seconds;
+    }
+    iterations = n;
+    tmxLoadStats(NULL);
+    tmxMemoryPools(TMX_FALSE);
+    tmxMemoryTrim();
+
+    tmxBenchSpecName(spec, name, sizeof(name));
+    printf("{\"bench\":\"load\",\"map\":\"%s\",\"format\":\"%s\",\"encoding\":\"%s\",\"compression\":\"%s\",\"size\":%d,"
+           "\"infinite\":%s,\"external_tileset\":%s,\"pools\":%s,\"file_bytes\":%zu,\"tiles\":%zu,\"objects\":%zu,\"retained_bytes\":%zu,"
+           "\"iterations\":%zu,\"phases\":{",
+           name, spec->format == TMX_FORMAT_JSON ? "json" : "xml",
+           spec->encoding == TMX_ENCODING_BASE64 ? "base64" : (spec->encoding == TMX_ENCODING_CSV ? "csv" : "tiles"),
+           spec->compression == TMX_COMPRESSION_GZIP   ? "gzip"
+           : spec->compression == TMX_COMPRESSION_ZLIB ? "zlib"
+           : spec->compression == TMX_COMPRESSION_ZSTD ? "zstd"
+                                                       : "none",
+           spec->size, spec->infinite ? "true" : "false", spec->externalTileset ? "true" : "false",
+           withPools ? "true" : "false", fileBytes, tiles, objects, retained,
+           iterations);
+
+    for (p = 0; p < TMX_BENCH_PHASE_COUNT; p++)
+    {
+        double seconds = stats[p].seconds / (double) iterations;
+        printf("%s\"%s\":{\"seconds\":%.6f,\"mb_per_s\":%.2f,\"allocations\":%zu,\"allocated_bytes\":%zu,\"peak_rss_kb\":%ld}",
+               p ? "," : "", phaseNames[p], seconds, seconds > 0.0 ? (double) fileBytes / seconds / 1e6 : 0.0, stats[p].allocs.count,
+               stats[p].allocs.bytes, stats[p].peakRss);
+    }
+    printf("}");
+    if (withStats)
+        tmxBenchPrintLoadStats(&loadTotal, iterations);
+    printf("}\n");
+    fflush(stdout);
+    return 1;
+}
+
+int
+tmxBenchLoad(int argc, char *argv[], const TMXbenchopts *opts)
+{
+    TMXmapspec spec      = {0};
+    char directory[1024] = "";
+    char path[1024];
+    const char *filter   = NULL;
+    TMX_BOOL keep        = TMX_FALSE;
+    TMX_BOOL withStats   = TMX_FALSE;
+    TMX_BOOL withPools   = TMX_FALSE;
+    const char *trace    = NULL;
+    size_t s, bytes;
+    int i, f, e, c, inf, ok = 1;
+
+    spec.tileLayers      = 2;
+    spec.objectCount     = 1000;
+    spec.externalTileset = TMX_TRUE;
+    spec.seed            = opts->seed;
+
+    for (i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "--dir") && i + 1 < argc)
+        {
+            snprintf(directory, sizeof(directory), "%s", argv[++i]);
+            keep = TMX_TRUE;
+        }
+        else if (!strcmp(argv[i], "--filter") && i + 1 < argc)
+            filter = argv[++i];
+        else if (!strcmp(argv[i], "--objects") && i + 1 < argc)
+            spec.objectCount = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--layers") && i + 1 < argc)
+            spec.tileLayers = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--embedded-tileset"))
+            spec.externalTileset = TMX_FALSE;
+        else if (!strcmp(argv[i], "--stats"))
+            withStats = TMX_TRUE;
+        else if (!strcmp(argv[i], "--pools"))
+            withPools = TMX_TRUE;
+        else if (!strcmp(argv[i], "--trace") && i + 1 < argc)
+            trace = argv[++i];
+        else
+        {
+            fprintf(stderr, "usage: load [--dir DIR] [--filter SUBSTRING] [--objects N] [--layers N] [--embedded-tileset] [--stats] [--pools] [--trace FILE]\n");
+            return 1;
+        }
+    }
+
+    // Started before changing directory, so that a relative trace path is relative to where the benchmark was run.
+    if (trace && !tmxTraceStart(trace))
+    {
+        fprintf(stderr, "load: unable to record trace (is the library built with TMX_TRACE?)\n");
+        return 1;
+    }
+
+    if (!directory[0])
+    {
+        snprintf(directory, sizeof(directory), "/tmp/tmx_bench.XXXXXX");
+        if (!mkdtemp(directory))
+        {
+            perror("load");
+            return 1;
+        }
+    }
+
+    // Work from the output directory, so that parsing from memory resolves the external tileset by its relative path.
+    if (chdir(directory))
+    {
+        perror("load");
+        return 1;
+    }
+
+    for (s = 0; s < opts->sizeCount; s++)
+    {
+        spec.size = opts->sizes[s];
+        for (f = TMX_FORMAT_XML; f <= TMX_FORMAT_JSON; f++)
+        {
+            for (e = TMX_ENCODING_NONE; e <= TMX_ENCODING_BASE64; e++)
+            {
+                for (c = TMX_COMPRESSION_NONE; c <= TMX_COMPRESSION_ZSTD; c++)
+                {
+                    for (inf = 0; inf < 2; inf++)
+                    {
+                        spec.format      = (TMX_FORMAT) f;
+                        spec.encoding    = (TMX_ENCODING) e;
+                        spec.compression = (TMX_COMPRESSION) c;
+                        spec.infinite    = inf;
+                        if (!tmxBenchSpecValid(&spec))
+                            continue;
+
+                        char name[128];
+                        tmxBenchSpecName(&spec, name, sizeof(name));
+                        if (filter && !strstr(name, filter))
+                            continue;
+
+                        if (!(bytes = tmxBenchGenerate(&spec, ".", path, sizeof(path))))
+                        {
+                            fprintf(stderr, "load: failed to generate %s\n", name);
+                            tmxTraceStop();
+                            return 1;
+                        }
+
+                        ok &= tmxBenchLoadMap(&spec, path, bytes, withStats, withPools, opts);
+                        if (!keep)
+                            remove(path);
+                    }
+                }
+            }
+        }
+    }
+
+    tmxTraceStop();
+    if (!keep)
+    {
+        remove("terrain.tsx");
+        remove("terrain.tsj");
+        if (chdir("/") == 0)
+            rmdir(directory);
+    }
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,133 @@
+#include "bench.h"
+
+#define TMX_BENCH_MAX_SIZES 16
+
+typedef int (*TMXbenchfunc)(int argc, char *argv[], const TMXbenchopts *opts);
+
+typedef struct TMXbenchcmd
+{
+    const char *name;
+    TMXbenchfunc func;
+    const char *description;
+} TMXbenchcmd;
+
+static const TMXbenchcmd commands[] = {
+    {"animate", tmxBenchAnimate, "Animated tile updates per frame for finite and infinite layers, verified against a full scan"},
+    {"bake", tmxBenchBake, "Quad baking throughput of tile layers and chunks for each orientation, verified for placement and order"},
+    {"blocked", tmxBenchBlocked, "Blocked and Morton layouts of tile layers: neighborhoods, random walks and column scans, verified"},
+    {"colliders", tmxBenchColliders, "Collision shape baking and merging by chunk, verified pixel by pixel against the tile shapes"},
+    {"compact", tmxBenchCompact, "Palette storage of tile layers with narrow indices: memory, reads, span decodes and writes, verified"},
+    {"coords", tmxBenchCoords, "Pixel/tile coordinate conversion throughput, verified against the scalar reference"},
+    {"cull", tmxBenchCull, "Viewport culling of finite and chunk layers for every orientation, verified against a brute-force test"},
+    {"distance", tmxBenchDistance, "Exact Euclidean, Manhattan and Chebyshev distance fields, verified against a BFS and brute force"},
+    {"flatten", tmxBenchFlatten, "Flattened layers of nested groups with resolved attributes and incremental updates, verified"},
+    {"generate", tmxBenchGenerateCommand, "Write the generated maps for every format/encoding/compression to a directory"},
+    {"grids", tmxBenchGrids, "Walkability and cost grid extraction from layer stacks, verified against per-cell property lookups"},
+    {"inflate", tmxBenchInflate, "Gzip/Zlib decompression throughput of tile layer data"},
+    {"load", tmxBenchLoad, "Read, parse and free time, allocations and peak RSS of generated maps"},
+    {"objects", tmxBenchObjects, "Object views of nested and empty object layers: bounds queries, verified against the objects"},
+    {"occupancy", tmxBenchOccupancy, "Occupancy pyramids of tile layers: skipping empty blocks when iterating, baking and culling, verified"},
+    {"paths", tmxBenchPaths, "A* and jump point search over walkability grids with four, eight and hex neighbors, verified for cost"},
+    {"raycast", tmxBenchRaycast, "Raycasts, line of sight and field of view over finite and infinite layers, verified exactly"},
+    {"regions", tmxBenchRegions, "Connected region labeling and flood fill with four, eight and hex neighbors, verified against a BFS"},
+    {"sparse", tmxBenchSparse, "Sparse storage of mostly empty layers: memory, load, iteration and random reads, verified exactly"},
+    {"tilesets", tmxBenchTilesets, "Tile source rectangles of image and collection tilesets from their tables, verified for every ID"},
+};
+
+void
+tmxBenchTileData(uint32_t *gids, size_t count, uint64_t seed)
+{
+    uint64_t state = seed ? seed : 1;
+    uint32_t current = 1, r;
+    size_t i, run = 0;
+
+    for (i = 0; i < count; i++)
+    {
+        if (!run)
+        {
+            r   = tmxBenchRandom(&state);
+            run = 1 + (r % 24);
+            switch ((r >> 8) % 8)
+            {
+                case 0: current = 0; break;                          // empty
+                case 1: current = 1 + ((r >> 12) % 256); break;      // detail
+                case 2: current = (1 + ((r >> 12) % 64)) | (1U << 31); break; // flipped
+                default: current = 1 + ((r >> 12) % 8); break;       // ground
+            }
+        }
+        gids[i] = current;
+        run--;
+    }
+}
+
+void
+tmxBenchStoreLE(uint8_t *output, const uint32_t *gids, size_t count)
+{
+    size_t i;
+    for (i = 0; i < count; i++, output += 4)
+    {
+        output[0] = (uint8_t) gids[i];
+        output[1] = (uint8_t) (gids[i] >> 8);
+        output[2] = (uint8_t) (gids[i] >> 16);
+        output[3] = (uint8_t) (gids[i] >> 24);
+    }
+}
+
+static void
+tmxBenchUsage(const char *program)
+{
+    size_t i;
+    fprintf(stderr, "usage: %s COMMAND [--iterations N] [--min-time SECONDS] [--seed N] [--sizes N,N,...] [MAP...]\n\ncommands:\n",
+            program);
+    for (i = 0; i < sizeof(commands) / sizeof(commands[0]); i++)
+        fprintf(stderr, "  %-10s %s\n", commands[i].name, commands[i].description);
+    fprintf(stderr, "\nThe blocked and compact commands measure the .tmx/.tmj maps given in MAP instead of generated maps.\n");
+}
+
+int
+main(int argc, char *argv[])
+{
+    static int sizes[TMX_BENCH_MAX_SIZES] = {64, 256, 1024};
+    TMXbenchopts opts = {0.25, 0, 0x544D58, sizes, 3};
+    int i;
+
+    if (argc < 2)
+    {
+        tmxBenchUsage(argv[0]);
+        return 1;
+    }
+
+    // Common options are consumed here, anything unrecognized is left for the command.
+    int rest = 2;
+    for (i = 2; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "--iterations") && i + 1 < argc)
+            opts.iterations = strtoul(argv[++i], NULL, 10);
+        else if (!strcmp(argv[i], "--min-time") && i + 1 < argc)
+            opts.minSeconds = strtod(argv[++i], NULL);
+        else if (!strcmp(argv[i], "--seed") && i + 1 < argc)
+            opts.seed = strtoull(argv[++i], NULL, 0);
+        else if (!strcmp(argv[i], "--sizes") && i + 1 < argc)
+        {
+            char *p = argv[++i];
+            opts.sizeCount = 0;
+            while (*p && opts.sizeCount < TMX_BENCH_MAX_SIZES)
+            {
+                sizes[opts.sizeCount++] = (int) strtol(p, &p, 10);
+                if (*p == ',')
+                    p++;
+            }
+        }
+        else
+            argv[rest++] = argv[i];
+    }
+
+    for (i = 0; i < (int) (sizeof(commands) / sizeof(commands[0])); i++)
+    {
+        if (!strcmp(argv[1], commands[i].name))
+            return commands[i].func(rest - 1, &argv[1], &opts);
+    }
+
+    tmxBenchUsage(argv[0]);
+    return 1;
+}
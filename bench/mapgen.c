@@ -0,0 +1,641 @@
+#include "bench.h"
+#include <unistd.h>
+
+#define TMX_GEN_CHUNK_SIZE   16
+#define TMX_GEN_TILE_COUNT   256
+#define TMX_GEN_TILE_COLUMNS 16
+#define TMX_GEN_TILE_SIZE    16
+#define TMX_GEN_LEVEL        6
+
+static const char *encodingNames[]    = {"tiles", "csv", "base64"};
+static const char *compressionNames[] = {"none", "gzip", "zlib", "zstd"};
+
+TMX_BOOL
+tmxBenchSpecValid(const TMXmapspec *spec)
+{
+    if (spec->format != TMX_FORMAT_XML && spec->format != TMX_FORMAT_JSON)
+        return TMX_FALSE;
+    // XML <tile> elements have no JSON equivalent (a JSON array is the "CSV" encoding)
+    if (spec->encoding == TMX_ENCODING_NONE && spec->format != TMX_FORMAT_XML)
+        return TMX_FALSE;
+    // Compression is only applicable to Base64
+    if (spec->encoding != TMX_ENCODING_BASE64 && spec->compression != TMX_COMPRESSION_NONE)
+        return TMX_FALSE;
+    return spec->size > 0;
+}
+
+void
+tmxBenchSpecName(const TMXmapspec *spec, char *buffer, size_t bufferSize)
+{
+    char occupancy[16] = "";
+    if (spec->occupancy)
+        snprintf(occupancy, sizeof(occupancy), "-occ%d", spec->occupancy);
+    snprintf(buffer, bufferSize, "%s-%s-%s-%d%s%s%s%s", spec->format == TMX_FORMAT_JSON ? "json" : "xml", encodingNames[spec->encoding],
+             compressionNames[spec->compression], spec->size, spec->infinite ? "-inf" : "", spec->externalTileset ? "-ext" : "",
+             spec->objectCount ? "-obj" : "", occupancy);
+}
+
+#pragma region Encoding
+
+static void
+tmxGenBase64(FILE *fp, const uint8_t *data, size_t size)
+{
+    static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    char buffer[4096];
+    size_t i, n = 0;
+    uint32_t v;
+
+    for (i = 0; i < size; i += 3)
+    {
+        v = (uint32_t) data[i] << 16;
+        if (i + 1 < size)
+            v |= (uint32_t) data[i + 1] << 8;
+        if (i + 2 < size)
+            v |= data[i + 2];
+
+        buffer[n++] = alphabet[(v >> 18) & 63];
+        buffer[n++] = alphabet[(v >> 12) & 63];
+        buffer[n++] = i + 1 < size ? alphabet[(v >> 6) & 63] : '=';
+        buffer[n++] = i + 2 < size ? alphabet[v & 63] : '=';
+
+        if (n == sizeof(buffer))
+        {
+            fwrite(buffer, 1, n, fp);
+            n = 0;
+        }
+    }
+    fwrite(buffer, 1, n, fp);
+}
+
+/**
+ * @brief Writes a block of tile data in the encoding and compression of @a spec.
+ *
+ * @param[in] fp The file to write to.
+ * @param[in] spec The map description.
+ * @param[in] gids The tile data, in row-major order.
+ * @param[in] width The number of tiles in each row.
+ * @param[in] height The number of rows.
+ * @param[in] stride The number of elements between the start of each row in @a gids.
+ */
+static void
+tmxGenTileData(FILE *fp, const TMXmapspec *spec, const uint32_t *gids, int width, int height, size_t stride)
+{
+    int x, y;
+    const uint32_t *row;
+    TMX_BOOL json = spec->format == TMX_FORMAT_JSON;
+
+    if (spec->encoding == TMX_ENCODING_BASE64)
+    {
+        size_t rowBytes = (size_t) width * 4, size;
+        uint8_t *data   = malloc(rowBytes * (size_t) height);
+        for (y = 0; y < height; y++)
+            tmxBenchStoreLE(data + rowBytes * (size_t) y, gids + stride * (size_t) y, (size_t) width);
+
+        uint8_t *compressed = tmxBenchCompress(spec->compression, data, rowBytes * (size_t) height, TMX_GEN_LEVEL, &size);
+        fputs(json ? "\"" : "\n", fp);
+        tmxGenBase64(fp, compressed, size);
+        fputs(json ? "\"" : "\n", fp);
+
+        free(compressed);
+        free(data);
+        return;
+    }
+
+    if (spec->encoding == TMX_ENCODING_NONE)
+    {
+        fputc('\n', fp);
+        for (y = 0; y < height; y++)
+        {
+            row = gids + stride * (size_t) y;
+            for (x = 0; x < width; x++)
+            {
+                if (row[x])
+                    fprintf(fp, "<tile gid=\"%u\"/>\n", row[x]);
+                else
+                    fputs("<tile/>\n", fp);
+            }
+        }
+        return;
+    }
+
+    fputs(json ? "[" : "\n", fp);
+    for (y = 0; y < height; y++)
+    {
+        row = gids + stride * (size_t) y;
+        for (x = 0; x < width; x++)
+        {
+            if (x + 1 < width || y + 1 < height)
+                fprintf(fp, "%u,", row[x]);
+            else
+                fprintf(fp, "%u", row[x]);
+        }
+        if (!json)
+            fputc('\n', fp);
+    }
+    if (json)
+        fputc(']', fp);
+}
+
+#pragma endregion
+
+#pragma region Tileset
+
+static void
+tmxGenTilesetXml(FILE *fp, const char *attributes)
+{
+    int i;
+    fprintf(fp,
+            "<tileset %sname=\"terrain\" tilewidth=\"%d\" tileheight=\"%d\" spacing=\"1\" margin=\"1\" tilecount=\"%d\" columns=\"%d\">\n"
+            " <image source=\"terrain.png\" width=\"%d\" height=\"%d\"/>\n",
+            attributes, TMX_GEN_TILE_SIZE, TMX_GEN_TILE_SIZE, TMX_GEN_TILE_COUNT, TMX_GEN_TILE_COLUMNS,
+            1 + TMX_GEN_TILE_COLUMNS * (TMX_GEN_TILE_SIZE + 1), 1 + (TMX_GEN_TILE_COUNT / TMX_GEN_TILE_COLUMNS) * (TMX_GEN_TILE_SIZE + 1));
+
+    // Every 8th tile has properties and a collision shape, and every 16th an animation and cannot be walked on.
+    for (i = 0; i < TMX_GEN_TILE_COUNT; i += 8)
+    {
+        fprintf(fp, " <tile id=\"%d\" type=\"solid\">\n", i);
+        fprintf(fp, "  <properties>\n   <property name=\"cost\" type=\"int\" value=\"%d\"/>\n   <property name=\"walkable\" "
+                    "type=\"bool\" value=\"%s\"/>\n  </properties>\n", 1 + i % 7, i % 16 ? "true" : "false");
+        fprintf(fp, "  <objectgroup draworder=\"index\" id=\"2\">\n   <object id=\"1\" x=\"2\" y=\"2\" width=\"12\" height=\"12\"/>\n"
+                    "  </objectgroup>\n");
+        if (i % 16 == 0)
+            fprintf(fp, "  <animation>\n   <frame tileid=\"%d\" duration=\"100\"/>\n   <frame tileid=\"%d\" duration=\"100\"/>\n"
+                        "  </animation>\n", i, i + 1);
+        fprintf(fp, " </tile>\n");
+    }
+    fprintf(fp, "</tileset>\n");
+}
+
+static void
+tmxGenTilesetJson(FILE *fp, const char *members)
+{
+    int i;
+    fprintf(fp,
+            "{%s\"name\":\"terrain\",\"tilewidth\":%d,\"tileheight\":%d,\"spacing\":1,\"margin\":1,\"tilecount\":%d,\"columns\":%d,"
+            "\"image\":\"terrain.png\",\"imagewidth\":%d,\"imageheight\":%d,\"tiles\":[",
+            members, TMX_GEN_TILE_SIZE, TMX_GEN_TILE_SIZE, TMX_GEN_TILE_COUNT, TMX_GEN_TILE_COLUMNS,
+            1 + TMX_GEN_TILE_COLUMNS * (TMX_GEN_TILE_SIZE + 1), 1 + (TMX_GEN_TILE_COUNT / TMX_GEN_TILE_COLUMNS) * (TMX_GEN_TILE_SIZE + 1));
+
+    for (i = 0; i < TMX_GEN_TILE_COUNT; i += 8)
+    {
+        fprintf(fp, "%s\n{\"id\":%d,\"type\":\"solid\",", i ? "," : "", i);
+        fprintf(fp, "\"properties\":[{\"name\":\"cost\",\"type\":\"int\",\"value\":%d},{\"name\":\"walkable\",\"type\":\"bool\","
+                    "\"value\":%s}],", 1 + i % 7, i % 16 ? "true" : "false");
+        fprintf(fp, "\"objectgroup\":{\"draworder\":\"index\",\"id\":2,\"name\":\"\",\"objects\":[{\"id\":1,\"x\":2,\"y\":2,"
+                    "\"width\":12,\"height\":12,\"rotation\":0,\"visible\":true}]}");
+        if (i % 16 == 0)
+            fprintf(fp, ",\"animation\":[{\"tileid\":%d,\"duration\":100},{\"tileid\":%d,\"duration\":100}]", i, i + 1);
+        fputc('}', fp);
+    }
+    fprintf(fp, "]}");
+}
+
+static TMX_BOOL
+tmxGenExternalTileset(const TMXmapspec *spec, const char *directory, char *filename, size_t filenameSize)
+{
+    char path[1024];
+    FILE *fp;
+
+    snprintf(filename, filenameSize, "terrain.%s", spec->format == TMX_FORMAT_JSON ? "tsj" : "tsx");
+    snprintf(path, sizeof(path), "%s/%s", directory, filename);
+    if (!(fp = fopen(path, "w")))
+        return TMX_FALSE;
+
+    if (spec->format == TMX_FORMAT_JSON)
+    {
+        tmxGenTilesetJson(fp, "\"type\":\"tileset\",\"version\":\"1.10\",\"tiledversion\":\"1.10.1\",");
+    }
+    else
+    {
+        fputs("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n", fp);
+        tmxGenTilesetXml(fp, "version=\"1.10\" tiledversion=\"1.10.1\" ");
+    }
+
+    fclose(fp);
+    return TMX_TRUE;
+}
+
+#pragma endregion
+
+#pragma region Objects
+
+static void
+tmxGenObjects(FILE *fp, const TMXmapspec *spec, int firstId)
+{
+    static const char *kinds[] = {"rect", "ellipse", "point", "polygon", "polyline", "text", "tile"};
+
+    uint64_t state  = spec->seed ^ 0x4F424A;
+    TMX_BOOL json   = spec->format == TMX_FORMAT_JSON;
+    float extent    = (float) (spec->size * TMX_GEN_TILE_SIZE);
+    int i, k, id;
+    float x, y, w, h;
+    uint32_t r;
+
+    for (i = 0; i < spec->objectCount; i++)
+    {
+        r  = tmxBenchRandom(&state);
+        id = firstId + i;
+        x  = (float) (tmxBenchRandom(&state) % 100000) / 100000.0f * extent;
+        y  = (float) (tmxBenchRandom(&state) % 100000) / 100000.0f * extent;
+        w  = (float) (8 + r % 120);
+        h  = (float) (8 + (r >> 8) % 120);
+        k  = (int) ((r >> 16) % 7);
+
+        if (json)
+        {
+            fprintf(fp, "%s\n{\"id\":%d,\"name\":\"%s %d\",\"type\":\"%s\",\"x\":%.2f,\"y\":%.2f,\"width\":%.0f,\"height\":%.0f,"
+                        "\"rotation\":%d,\"visible\":true,",
+                    i ? "," : "", id, kinds[k], id, kinds[k], x, y, k == 2 ? 0.0f : w, k == 2 ? 0.0f : h, (int) (r % 4) * 90);
+            fprintf(fp, "\"properties\":[{\"name\":\"health\",\"type\":\"int\",\"value\":%u},{\"name\":\"label\",\"type\":\"string\","
+                        "\"value\":\"object-%d\"}]", r % 1000, id);
+            switch (k)
+            {
+                case 1: fputs(",\"ellipse\":true", fp); break;
+                case 2: fputs(",\"point\":true", fp); break;
+                case 3:
+                case 4:
+                    fprintf(fp, ",\"%s\":[{\"x\":0,\"y\":0},{\"x\":%.0f,\"y\":0},{\"x\":%.0f,\"y\":%.0f},{\"x\":%.0f,\"y\":%.0f},"
+                                "{\"x\":0,\"y\":%.0f}]",
+                            k == 3 ? "polygon" : "polyline", w, w, h / 2, w / 2, h, h);
+                    break;
+                case 5: fprintf(fp, ",\"text\":{\"text\":\"Sign %d\",\"wrap\":true,\"fontfamily\":\"sans-serif\"}", id); break;
+                case 6: fprintf(fp, ",\"gid\":%u", 1 + (r >> 4) % TMX_GEN_TILE_COUNT); break;
+                default: break;
+            }
+            fputc('}', fp);
+            continue;
+        }
+
+        fprintf(fp, "  <object id=\"%d\" name=\"%s %d\" type=\"%s\" x=\"%.2f\" y=\"%.2f\"", id, kinds[k], id, kinds[k], x, y);
+        if (k != 2)
+            fprintf(fp, " width=\"%.0f\" height=\"%.0f\"", w, h);
+        if (r % 4)
+            fprintf(fp, " rotation=\"%d\"", (int) (r % 4) * 90);
+        if (k == 6)
+            fprintf(fp, " gid=\"%u\"", 1 + (r >> 4) % TMX_GEN_TILE_COUNT);
+        fprintf(fp, ">\n   <properties>\n    <property name=\"health\" type=\"int\" value=\"%u\"/>\n    <property name=\"label\" "
+                    "value=\"object-%d\"/>\n   </properties>\n", r % 1000, id);
+        switch (k)
+        {
+            case 1: fputs("   <ellipse/>\n", fp); break;
+            case 2: fputs("   <point/>\n", fp); break;
+            case 3:
+            case 4:
+                fprintf(fp, "   <%s points=\"0,0 %.0f,0 %.0f,%.0f %.0f,%.0f 0,%.0f\"/>\n", k == 3 ? "polygon" : "polyline", w, w,
+                        h / 2, w / 2, h, h);
+                break;
+            case 5: fprintf(fp, "   <text fontfamily=\"sans-serif\" wrap=\"1\">Sign %d</text>\n", id); break;
+            default: break;
+        }
+        fputs("  </object>\n", fp);
+    }
+}
+
+#pragma endregion
+
+/**
+ * @brief Writes a single tile layer, either as a whole or divided into chunks for infinite maps. Chunks that would be
+ * entirely empty are omitted, as Tiled does.
+ */
+static void
+tmxGenTileLayer(FILE *fp, const TMXmapspec *spec, int id, const uint32_t *gids)
+{
+    TMX_BOOL json = spec->format == TMX_FORMAT_JSON;
+    int size      = spec->size;
+    int origin    = -(size / 2 / TMX_GEN_CHUNK_SIZE) * TMX_GEN_CHUNK_SIZE;
+    int cx, cy, x, y, w, h, first = 1;
+    const char *encoding = spec->encoding == TMX_ENCODING_BASE64 ? "base64" : "csv";
+
+    if (json)
+    {
+        fprintf(fp, "%s\n{\"id\":%d,\"name\":\"Tile Layer %d\",\"type\":\"tilelayer\",\"x\":0,\"y\":0,\"width\":%d,\"height\":%d,"
+                    "\"opacity\":1,\"visible\":true,\"encoding\":\"%s\"",
+                id > 1 ? "," : "", id, id, size, size, encoding);
+        if (spec->compression)
+            fprintf(fp, ",\"compression\":\"%s\"", compressionNames[spec->compression]);
+    }
+    else
+    {
+        fprintf(fp, " <layer id=\"%d\" name=\"Tile Layer %d\" width=\"%d\" height=\"%d\">\n  <data", id, id, size, size);
+        if (spec->encoding != TMX_ENCODING_NONE)
+            fprintf(fp, " encoding=\"%s\"", encoding);
+        if (spec->compression)
+            fprintf(fp, " compression=\"%s\"", compressionNames[spec->compression]);
+        fputc('>', fp);
+    }
+
+    if (!spec->infinite)
+    {
+        if (json)
+            fputs(",\"data\":", fp);
+        tmxGenTileData(fp, spec, gids, size, size, (size_t) size);
+    }
+    else
+    {
+        if (json)
+            fprintf(fp, ",\"startx\":%d,\"starty\":%d,\"chunks\":[", origin, origin);
+
+        for (cy = 0; cy < size; cy += TMX_GEN_CHUNK_SIZE)
+        {
+            for (cx = 0; cx < size; cx += TMX_GEN_CHUNK_SIZE)
+            {
+                w = TMX_MIN(TMX_GEN_CHUNK_SIZE, size - cx);
+                h = TMX_MIN(TMX_GEN_CHUNK_SIZE, size - cy);
+
+                const uint32_t *chunk = gids + (size_t) cy * (size_t) size + (size_t) cx;
+                TMX_BOOL empty        = TMX_TRUE;
+                for (y = 0; y < h && empty; y++)
+                {
+                    for (x = 0; x < w && empty; x++)
+                        empty = chunk[(size_t) y * (size_t) size + (size_t) x] == 0;
+                }
+                if (empty)
+                    continue;
+
+                if (json)
+                {
+                    fprintf(fp, "%s\n{\"x\":%d,\"y\":%d,\"width\":%d,\"height\":%d,\"data\":", first ? "" : ",", origin + cx,
+                            origin + cy, w, h);
+                    tmxGenTileData(fp, spec, chunk, w, h, (size_t) size);
+                    fputc('}', fp);
+                }
+                else
+                {
+                    fprintf(fp, "\n   <chunk x=\"%d\" y=\"%d\" width=\"%d\" height=\"%d\">", origin + cx, origin + cy, w, h);
+                    tmxGenTileData(fp, spec, chunk, w, h, (size_t) size);
+                    fputs("</chunk>", fp);
+                }
+                first = 0;
+            }
+        }
+        if (json)
+            fputc(']', fp);
+    }
+
+    fputs(json ? "}" : "</data>\n </layer>\n", fp);
+}
+
+/**
+ * @brief Fills a layer with tile data. For infinite maps, roughly a third of the chunks are left empty, so that the
+ * layer is sparse as it would typically be. An explicit occupancy leaves the other chunks empty in either kind of map.
+ */
+static void
+tmxGenLayerData(const TMXmapspec *spec, int layer, uint32_t *gids)
+{
+    size_t count = (size_t) spec->size * (size_t) spec->size;
+    tmxBenchTileData(gids, count, spec->seed + (uint64_t) layer * 0x9E3779B97F4A7C15ULL);
+
+    if (!spec->infinite && !spec->occupancy)
+        return;
+
+    uint64_t state = spec->seed ^ (uint64_t) layer;
+    int cx, cy, y;
+    for (cy = 0; cy < spec->size; cy += TMX_GEN_CHUNK_SIZE)
+    {
+        for (cx = 0; cx < spec->size; cx += TMX_GEN_CHUNK_SIZE)
+        {
+            uint32_t r = tmxBenchRandom(&state);
+            if (spec->occupancy ? (int) (r % 100) < spec->occupancy : r % 3 != 0)
+                continue;
+            for (y = cy; y < TMX_MIN(cy + TMX_GEN_CHUNK_SIZE, spec->size); y++)
+                memset(&gids[(size_t) y * (size_t) spec->size + (size_t) cx], 0,
+                       (size_t) TMX_MIN(TMX_GEN_CHUNK_SIZE, spec->size - cx) * sizeof(uint32_t));
+        }
+    }
+}
+
+size_t
+tmxBenchGenerate(const TMXmapspec *spec, const char *directory, char *path, size_t pathSize)
+{
+    char name[128], tileset[64];
+    TMX_BOOL json = spec->format == TMX_FORMAT_JSON;
+    FILE *fp;
+    int i;
+
+    if (!tmxBenchSpecValid(spec))
+        return 0;
+    if (spec->externalTileset && !tmxGenExternalTileset(spec, directory, tileset, sizeof(tileset)))
+        return 0;
+
+    tmxBenchSpecName(spec, name, sizeof(name));
+    snprintf(path, pathSize, "%s/%s.%s", directory, name, json ? "tmj" : "tmx");
+    if (!(fp = fopen(path, "w")))
+        return 0;
+
+    int nextLayer = spec->tileLayers + (spec->objectCount ? 1 : 0) + 1;
+    if (json)
+    {
+        fprintf(fp, "{\"type\":\"map\",\"version\":\"1.10\",\"tiledversion\":\"1.10.1\",\"orientation\":\"orthogonal\","
+                    "\"renderorder\":\"right-down\",\"width\":%d,\"height\":%d,\"tilewidth\":%d,\"tileheight\":%d,\"infinite\":%s,"
+                    "\"nextlayerid\":%d,\"nextobjectid\":%d,\n\"tilesets\":[",
+                spec->size, spec->size, TMX_GEN_TILE_SIZE, TMX_GEN_TILE_SIZE, spec->infinite ? "true" : "false", nextLayer,
+                spec->objectCount + 1);
+        if (spec->externalTileset)
+            fprintf(fp, "{\"firstgid\":1,\"source\":\"%s\"}", tileset);
+        else
+            tmxGenTilesetJson(fp, "\"firstgid\":1,");
+        fputs("],\n\"layers\":[", fp);
+    }
+    else
+    {
+        fprintf(fp, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<map version=\"1.10\" tiledversion=\"1.10.1\" orientation=\"orthogonal\" "
+                    "renderorder=\"right-down\" width=\"%d\" height=\"%d\" tilewidth=\"%d\" tileheight=\"%d\" infinite=\"%d\" "
+                    "nextlayerid=\"%d\" nextobjectid=\"%d\">\n",
+                spec->size, spec->size, TMX_GEN_TILE_SIZE, TMX_GEN_TILE_SIZE, spec->infinite ? 1 : 0, nextLayer, spec->objectCount + 1);
+        if (spec->externalTileset)
+            fprintf(fp, " <tileset firstgid=\"1\" source=\"%s\"/>\n", tileset);
+        else
+            tmxGenTilesetXml(fp, "firstgid=\"1\" ");
+    }
+
+    uint32_t *gids = malloc((size_t) spec->size * (size_t) spec->size * sizeof(uint32_t));
+    for (i = 0; i < spec->tileLayers; i++)
+    {
+        tmxGenLayerData(spec, i, gids);
+        tmxGenTileLayer(fp, spec, i + 1, gids);
+    }
+    free(gids);
+
+    if (spec->objectCount)
+    {
+        if (json)
+        {
+            fprintf(fp, "%s\n{\"id\":%d,\"name\":\"Objects\",\"type\":\"objectgroup\",\"draworder\":\"topdown\",\"x\":0,\"y\":0,"
+                        "\"opacity\":1,\"visible\":true,\"objects\":[",
+                    spec->tileLayers ? "," : "", nextLayer - 1);
+            tmxGenObjects(fp, spec, 1);
+            fputs("]}", fp);
+        }
+        else
+        {
+            fprintf(fp, " <objectgroup id=\"%d\" name=\"Objects\">\n", nextLayer - 1);
+            tmxGenObjects(fp, spec, 1);
+            fputs(" </objectgroup>\n", fp);
+        }
+    }
+
+    fputs(json ? "]}\n" : "</map>\n", fp);
+
+    long size = ftell(fp);
+    fclose(fp);
+    return size > 0 ? (size_t) size : 0;
+}
+
+TMXmap *
+tmxBenchLoadGenerated(const TMXmapspec *spec)
+{
+    char directory[] = "/tmp/tmx_bench.XXXXXX";
+    char path[1024];
+    TMXmap *map = NULL;
+
+    if (!mkdtemp(directory))
+    {
+        perror("mkdtemp");
+        return NULL;
+    }
+
+    if (tmxBenchGenerate(spec, directory, path, sizeof(path)))
+    {
+        map = tmxLoadMap(path, NULL, spec->format);
+        remove(path);
+    }
+
+    snprintf(path, sizeof(path), "%s/terrain.%s", directory, spec->format == TMX_FORMAT_JSON ? "tsj" : "tsx");
+    remove(path);
+    rmdir(directory);
+    return map;
+}
+
+/**
+ * @brief Measures every tile and chunk layer of a map.
+ */
+static int
+tmxBenchMapLayers(const char *source, const TMXmap *map, const TMXbenchopts *opts, TMXbenchlayerfunc measure)
+{
+    TMXflatlayers *flat = tmxMapFlattenLayers(map);
+    size_t i;
+    int ok = flat != NULL;
+
+    for (i = 0; flat && i < flat->count; i++)
+    {
+        const TMXlayer *layer = flat->layers[i].layer;
+        if (layer->type == TMX_LAYER_TILE || layer->type == TMX_LAYER_CHUNK)
+            ok &= measure(source, layer, opts);
+    }
+    tmxFreeFlatLayers(flat);
+    return ok;
+}
+
+int
+tmxBenchLayers(const char *command, int argc, char *argv[], const TMXmapspec *spec, const TMXbenchopts *opts,
+               TMXbenchlayerfunc measure)
+{
+    TMXmapspec generated = *spec;
+    char name[256];
+    size_t s;
+    int ok = 1, inf, i, files = 0;
+
+    // Maps given on the command line are measured instead of generated maps.
+    for (i = 1; i < argc; i++)
+    {
+        TMXmap *map = tmxLoadMap(argv[i], NULL, TMX_FORMAT_AUTO);
+        if (!map)
+        {
+            fprintf(stderr, "%s: failed to load %s\n", command, argv[i]);
+            return 1;
+        }
+        ok &= tmxBenchMapLayers(argv[i], map, opts, measure);
+        tmxFreeMap(map);
+        files++;
+    }
+
+    for (s = 0; !files && s < opts->sizeCount; s++)
+    {
+        for (inf = 0; inf < 2; inf++)
+        {
+            generated.size     = opts->sizes[s];
+            generated.infinite = inf;
+            TMXmap *map        = tmxBenchLoadGenerated(&generated);
+            if (!map)
+            {
+                fprintf(stderr, "%s: failed to load a generated map\n", command);
+                return 1;
+            }
+
+            tmxBenchSpecName(&generated, name, sizeof(name));
+            ok &= tmxBenchMapLayers(name, map, opts, measure);
+            tmxFreeMap(map);
+        }
+    }
+    return ok ? 0 : 1;
+}
+
+void
+tmxBenchDenseLayer(const TMXlayer *layer, TMXrect region, TMXgid *gids)
+{
+    size_t i;
+    int y;
+
+    memset(gids, 0, (size_t) region.w * (size_t) region.h * sizeof(TMXgid));
+    if (layer->type == TMX_LAYER_TILE)
+    {
+        if (layer->data.tiles)
+            memcpy(gids, layer->data.tiles, (size_t) region.w * (size_t) region.h * sizeof(TMXgid));
+        return;
+    }
+    for (i = 0; i < layer->count; i++)
+    {
+        const TMXchunk *chunk = &layer->data.chunks[i];
+        for (y = 0; chunk->gids && y < chunk->bounds.h; y++)
+        {
+            memcpy(gids + (size_t) (chunk->bounds.y - region.y + y) * (size_t) region.w + (size_t) (chunk->bounds.x - region.x),
+                   chunk->gids + (size_t) y * (size_t) chunk->bounds.w, (size_t) chunk->bounds.w * sizeof(TMXgid));
+        }
+    }
+}
+
+int
+tmxBenchGenerateCommand(int argc, char *argv[], const TMXbenchopts *opts)
+{
+    TMXmapspec spec = {0};
+    const char *directory = argc > 1 ? argv[1] : ".";
+    char path[1024];
+    size_t s, bytes;
+    int f, e, c, inf;
+
+    spec.tileLayers      = 2;
+    spec.objectCount     = 1000;
+    spec.externalTileset = TMX_TRUE;
+    spec.seed            = opts->seed;
+
+    for (s = 0; s < opts->sizeCount; s++)
+    {
+        spec.size = opts->sizes[s];
+        for (f = TMX_FORMAT_XML; f <= TMX_FORMAT_JSON; f++)
+        {
+            for (e = TMX_ENCODING_NONE; e <= TMX_ENCODING_BASE64; e++)
+            {
+                for (c = TMX_COMPRESSION_NONE; c <= TMX_COMPRESSION_ZSTD; c++)
+                {
+                    for (inf = 0; inf < 2; inf++)
+                    {
+                        spec.format      = (TMX_FORMAT) f;
+                        spec.encoding    = (TMX_ENCODING) e;
+                        spec.compression = (TMX_COMPRESSION) c;
+                        spec.infinite    = inf;
+                        if (!tmxBenchSpecValid(&spec))
+                            continue;
+
+                        if (!(bytes = tmxBenchGenerate(&spec, directory, path, sizeof(path))))
+                        {
+                            fprintf(stderr, "generate: failed to write map to \"%s\"\n", directory);
+                            return 1;
+                        }
+                        printf("{\"bench\":\"generate\",\"path\":\"%s\",\"bytes\":%zu}\n", path, bytes);
+                    }
+                }
+            }
+        }
+    }
+    return 0;
+}
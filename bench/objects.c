@@ -0,0 +1,384 @@
+#include "bench.h"
+
+/**
+ * @brief The number of random rectangles queried against the objects of each map for each measurement.
+ */
+#define TMX_OBJECTS_QUERIES 64
+
+/**
+ * @brief The object layers of the generated document, with their nesting depth and the number of objects per map size.
+ * The empty layer verifies that a view is still built, with a count of zero.
+ */
+static const struct
+{
+    const char *name;
+    int depth;
+    int perSize;
+} objectsLayers[] = {{"props", 0, 16}, {"empty", 0, 0}, {"triggers", 1, 4}, {"spawns", 2, 1}};
+
+#define TMX_OBJECTS_LAYERS (sizeof(objectsLayers) / sizeof(objectsLayers[0]))
+
+/**
+ * @brief A rectangle queried against the bounds of the objects, in pixel units.
+ */
+typedef struct TMXobjectsquery
+{
+    float x, y, w, h;
+} TMXobjectsquery;
+
+/**
+ * @brief Writes the objects of a layer, with fractional positions and rotations, tile objects with flipped GIDs, and
+ * hidden objects, so that every array of the view holds distinct values.
+ */
+static void
+tmxObjectsWrite(FILE *fp, TMX_FORMAT format, int count, int size, int *nextId, uint64_t *state)
+{
+    static const char *kinds[] = {"rect", "ellipse", "point", "tile"};
+    float extent = (float) (size * 16);
+    float x, y, w, h, rotation;
+    uint32_t r, gid;
+    int i, k;
+
+    for (i = 0; i < count; i++, (*nextId)++)
+    {
+        r        = tmxBenchRandom(state);
+        k        = (int) (r % 4);
+        x        = (float) (tmxBenchRandom(state) % 100000) / 100000.0f * extent;
+        y        = (float) (tmxBenchRandom(state) % 100000) / 100000.0f * extent;
+        w        = k == 2 ? 0.0f : (float) (4 + (r >> 2) % 120) + 0.5f;
+        h        = k == 2 ? 0.0f : (float) (4 + (r >> 9) % 120) + 0.25f;
+        rotation = (r >> 16) % 3 ? (float) ((r >> 18) % 3600) / 10.0f : 0.0f;
+        gid      = k == 3 ? (1 + (r >> 4) % 256) | ((r >> 24) & 7U) << 29 : 0;
+
+        if (format == TMX_FORMAT_JSON)
+        {
+            fprintf(fp, "%s\n{\"id\":%d,\"name\":\"%s %d\",\"x\":%.2f,\"y\":%.2f,\"width\":%.2f,\"height\":%.2f,\"rotation\":%.1f,"
+                        "\"visible\":%s",
+                    i ? "," : "", *nextId, kinds[k], *nextId, x, y, w, h, rotation, r % 5 ? "true" : "false");
+            if (k == 1)
+                fputs(",\"ellipse\":true", fp);
+            else if (k == 2)
+                fputs(",\"point\":true", fp);
+            else if (k == 3)
+                fprintf(fp, ",\"gid\":%u", gid);
+            fputc('}', fp);
+            continue;
+        }
+
+        fprintf(fp, "   <object id=\"%d\" name=\"%s %d\" x=\"%.2f\" y=\"%.2f\"", *nextId, kinds[k], *nextId, x, y);
+        if (k != 2)
+            fprintf(fp, " width=\"%.2f\" height=\"%.2f\"", w, h);
+        if (rotation != 0.0f)
+            fprintf(fp, " rotation=\"%.1f\"", rotation);
+        if (k == 3)
+            fprintf(fp, " gid=\"%u\"", gid);
+        if (r % 5 == 0)
+            fputs(" visible=\"0\"", fp);
+        if (k == 1)
+            fputs(">\n    <ellipse/>\n   </object>\n", fp);
+        else if (k == 2)
+            fputs(">\n    <point/>\n   </object>\n", fp);
+        else
+            fputs("/>\n", fp);
+    }
+}
+
+/**
+ * @brief Writes a map with several object layers, one of them empty and two of them nested within groups, and a single
+ * tileset for the GIDs of tile objects.
+ */
+static char *
+tmxObjectsDocument(TMX_FORMAT format, int size, uint64_t seed)
+{
+    uint64_t state = seed ? seed : 1;
+    char *text     = NULL;
+    int nextId     = 1, depth = 0;
+    size_t length, i;
+
+    FILE *fp = open_memstream(&text, &length);
+    if (!fp)
+        return NULL;
+
+    if (format == TMX_FORMAT_JSON)
+    {
+        fprintf(fp, "{\"type\":\"map\",\"version\":\"1.10\",\"tiledversion\":\"1.10.1\",\"orientation\":\"orthogonal\","
+                    "\"renderorder\":\"right-down\",\"width\":%d,\"height\":%d,\"tilewidth\":16,\"tileheight\":16,\"infinite\":false,"
+                    "\"nextlayerid\":7,\"nextobjectid\":1,\"tilesets\":[{\"firstgid\":1,\"name\":\"terrain\",\"tilewidth\":16,"
+                    "\"tileheight\":16,\"tilecount\":256,\"columns\":16,\"image\":\"terrain.png\",\"imagewidth\":256,"
+                    "\"imageheight\":256}],\n\"layers\":[",
+                size, size);
+        for (i = 0; i < TMX_OBJECTS_LAYERS; i++)
+        {
+            for (; depth < objectsLayers[i].depth; depth++)
+                fprintf(fp, "%s\n{\"id\":%d,\"name\":\"group %d\",\"type\":\"group\",\"layers\":[", i ? "," : "", 5 + depth, depth);
+            fprintf(fp, "%s\n{\"id\":%zu,\"name\":\"%s\",\"type\":\"objectgroup\",\"draworder\":\"topdown\",\"objects\":[",
+                    i && objectsLayers[i - 1].depth == depth ? "," : "", i + 1, objectsLayers[i].name);
+            tmxObjectsWrite(fp, format, objectsLayers[i].perSize * size, size, &nextId, &state);
+            fputs("]}", fp);
+        }
+        for (; depth > 0; depth--)
+            fputs("]}", fp);
+        fputs("]}\n", fp);
+    }
+    else
+    {
+        fprintf(fp, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<map version=\"1.10\" tiledversion=\"1.10.1\" orientation=\"orthogonal\" "
+                    "renderorder=\"right-down\" width=\"%d\" height=\"%d\" tilewidth=\"16\" tileheight=\"16\" infinite=\"0\" "
+                    "nextlayerid=\"7\" nextobjectid=\"1\">\n <tileset firstgid=\"1\" name=\"terrain\" tilewidth=\"16\" "
+                    "tileheight=\"16\" tilecount=\"256\" columns=\"16\">\n  <image source=\"terrain.png\" width=\"256\" "
+                    "height=\"256\"/>\n </tileset>\n",
+                size, size);
+        for (i = 0; i < TMX_OBJECTS_LAYERS; i++)
+        {
+            for (; depth < objectsLayers[i].depth; depth++)
+                fprintf(fp, " <group id=\"%d\" name=\"group %d\">\n", 5 + depth, depth);
+            if (!objectsLayers[i].perSize)
+            {
+                fprintf(fp, "  <objectgroup id=\"%zu\" name=\"%s\"/>\n", i + 1, objectsLayers[i].name);
+                continue;
+            }
+            fprintf(fp, "  <objectgroup id=\"%zu\" name=\"%s\">\n", i + 1, objectsLayers[i].name);
+            tmxObjectsWrite(fp, format, objectsLayers[i].perSize * size, size, &nextId, &state);
+            fputs("  </objectgroup>\n", fp);
+        }
+        for (; depth > 0; depth--)
+            fputs(" </group>\n", fp);
+        fputs("</map>\n", fp);
+    }
+
+    fclose(fp);
+    return text;
+}
+
+/**
+ * @brief Compares each entry of the view of an object layer with the object at the same index.
+ *
+ * @return The number of entries that differ, or at least 1 when the layer has no view or its count differs.
+ */
+static size_t
+tmxObjectsVerifyLayer(const TMXlayer *layer)
+{
+    const TMXobjectview *view = layer->view;
+    const TMXobject *object;
+    size_t i, errors = 0;
+
+    if (!view || view->count != layer->count)
+        return TMX_MAX(layer->count, 1);
+
+    for (i = 0; i < view->count; i++)
+    {
+        if (!(object = layer->data.objects[i]))
+            continue;
+        if (view->id[i] != object->id || view->x[i] != object->position.x || view->y[i] != object->position.y ||
+            view->width[i] != object->size.x || view->height[i] != object->size.y || view->rotation[i] != object->rotation ||
+            view->gid[i] != object->gid || view->type[i] != object->type || view->visible[i] != object->visible)
+            errors++;
+    }
+    return errors;
+}
+
+/**
+ * @brief Collects the object layers of a layer list and its groups, in document order.
+ */
+static size_t
+tmxObjectsCollect(TMXlayer **layers, size_t count, TMXlayer **output, size_t capacity, size_t found)
+{
+    size_t i;
+    for (i = 0; i < count; i++)
+    {
+        if (layers[i]->type == TMX_LAYER_GROUP)
+            found = tmxObjectsCollect(layers[i]->data.group, layers[i]->count, output, capacity, found);
+        else if (layers[i]->type == TMX_LAYER_OBJGROUP && found < capacity)
+            output[found++] = layers[i];
+    }
+    return found;
+}
+
+/**
+ * @brief Verifies the views built while loading, and again after moving every object and rebuilding the views with
+ * @ref tmxLayerObjectView.
+ *
+ * @return Non-zero when every view matches its objects.
+ */
+static int
+tmxObjectsVerify(TMXmap *map, TMXlayer **layers, int size, const char *name)
+{
+    size_t i, j, errors = 0;
+
+    if (tmxObjectsCollect(map->layers, map->layer_count, layers, TMX_OBJECTS_LAYERS, 0) != TMX_OBJECTS_LAYERS)
+    {
+        fprintf(stderr, "objects: the %s map with size %d does not have %zu object layers\n", name, size, TMX_OBJECTS_LAYERS);
+        return 0;
+    }
+
+    for (i = 0; i < TMX_OBJECTS_LAYERS; i++)
+    {
+        if (layers[i]->count != (size_t) (objectsLayers[i].perSize * size))
+        {
+            fprintf(stderr, "objects: layer %s of the %s map has %zu objects instead of %d\n", objectsLayers[i].name, name,
+                    layers[i]->count, objectsLayers[i].perSize * size);
+            return 0;
+        }
+        if ((errors = tmxObjectsVerifyLayer(layers[i])))
+        {
+            fprintf(stderr, "objects: %zu entries of the view of layer %s of the %s map differ from its objects\n", errors,
+                    objectsLayers[i].name, name);
+            return 0;
+        }
+    }
+
+    // The view is a snapshot: it only reflects modified objects once rebuilt.
+    for (i = 0; i < TMX_OBJECTS_LAYERS; i++)
+    {
+        for (j = 0; j < layers[i]->count; j++)
+        {
+            TMXobject *object = layers[i]->data.objects[j];
+            object->position.x += 3.0f;
+            object->size.y *= 2.0f;
+            object->rotation = (float) ((j * 37) % 360);
+            object->visible  = !object->visible;
+        }
+        if (!tmxLayerObjectView(layers[i]) || (errors = tmxObjectsVerifyLayer(layers[i])))
+        {
+            fprintf(stderr, "objects: %zu entries of the rebuilt view of layer %s of the %s map differ from its objects\n", errors,
+                    objectsLayers[i].name, name);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/**
+ * @brief Counts the objects whose unrotated bounds intersect each query, once from the views and once from the objects.
+ *
+ * @return Non-zero when both counts are the same for every query.
+ */
+static int
+tmxObjectsMeasure(TMXlayer **layers, const TMXobjectsquery *queries, const TMXbenchopts *opts, double *viewSeconds,
+                  double *objectSeconds, size_t *iterations)
+{
+    size_t viewCounts[TMX_OBJECTS_QUERIES] = {0}, objectCounts[TMX_OBJECTS_QUERIES] = {0};
+    size_t n, q, i, j, rounds = opts->iterations ? opts->iterations : 1;
+    double start;
+
+    for (;;)
+    {
+        start = tmxBenchNow();
+        for (n = 0; n < rounds; n++)
+        {
+            for (q = 0; q < TMX_OBJECTS_QUERIES; q++)
+            {
+                const TMXobjectsquery *r = &queries[q];
+                size_t hits       = 0;
+                for (i = 0; i < TMX_OBJECTS_LAYERS; i++)
+                {
+                    const TMXobjectview *view = layers[i]->view;
+                    for (j = 0; j < view->count; j++)
+                        hits += view->x[j] < r->x + r->w && view->x[j] + view->width[j] >= r->x && view->y[j] < r->y + r->h &&
+                                view->y[j] + view->height[j] >= r->y;
+                }
+                viewCounts[q] = hits;
+            }
+        }
+        *viewSeconds = tmxBenchNow() - start;
+        if (opts->iterations || *viewSeconds >= opts->minSeconds)
+            break;
+        rounds *= 2;
+    }
+    *iterations = rounds;
+
+    start = tmxBenchNow();
+    for (n = 0; n < rounds; n++)
+    {
+        for (q = 0; q < TMX_OBJECTS_QUERIES; q++)
+        {
+            const TMXobjectsquery *r = &queries[q];
+            size_t hits       = 0;
+            for (i = 0; i < TMX_OBJECTS_LAYERS; i++)
+            {
+                for (j = 0; j < layers[i]->count; j++)
+                {
+                    const TMXobject *o = layers[i]->data.objects[j];
+                    hits += o->position.x < r->x + r->w && o->position.x + o->size.x >= r->x && o->position.y < r->y + r->h &&
+                            o->position.y + o->size.y >= r->y;
+                }
+            }
+            objectCounts[q] = hits;
+        }
+    }
+    *objectSeconds = tmxBenchNow() - start;
+
+    return !memcmp(viewCounts, objectCounts, sizeof(viewCounts));
+}
+
+int
+tmxBenchObjects(int argc, char *argv[], const TMXbenchopts *opts)
+{
+    static const TMX_FORMAT formats[] = {TMX_FORMAT_XML, TMX_FORMAT_JSON};
+    TMXlayer *layers[TMX_OBJECTS_LAYERS];
+    TMXobjectsquery queries[TMX_OBJECTS_QUERIES];
+    double viewSeconds, objectSeconds;
+    size_t s, f, q, iterations;
+    uint64_t state;
+    const char *name;
+    TMXmap *map;
+    char *text;
+    int ok = 1, size, objects = 0;
+    (void) argc;
+    (void) argv;
+
+    for (q = 0; q < TMX_OBJECTS_LAYERS; q++)
+        objects += objectsLayers[q].perSize;
+
+    for (s = 0; ok && s < opts->sizeCount; s++)
+    {
+        size  = opts->sizes[s];
+        state = opts->seed ? opts->seed : 1;
+        for (q = 0; q < TMX_OBJECTS_QUERIES; q++)
+        {
+            queries[q].x = (float) (tmxBenchRandom(&state) % (uint32_t) (size * 16));
+            queries[q].y = (float) (tmxBenchRandom(&state) % (uint32_t) (size * 16));
+            queries[q].w = (float) (64 + tmxBenchRandom(&state) % 512);
+            queries[q].h = (float) (64 + tmxBenchRandom(&state) % 512);
+        }
+
+        for (f = 0; ok && f < sizeof(formats) / sizeof(formats[0]); f++)
+        {
+            name = formats[f] == TMX_FORMAT_JSON ? "json" : "xml";
+            if (!(text = tmxObjectsDocument(formats[f], size, opts->seed)))
+            {
+                fprintf(stderr, "objects: failed to write a map\n");
+                ok = 0;
+                break;
+            }
+            tmxObjectViews(TMX_TRUE);
+            map = tmxParseMap(text, NULL, formats[f]);
+            tmxObjectViews(TMX_FALSE);
+            free(text);
+            if (!map)
+            {
+                fprintf(stderr, "objects: failed to parse a map\n");
+                ok = 0;
+                break;
+            }
+
+            if (!(ok = tmxObjectsVerify(map, layers, size, name)))
+            {
+                tmxFreeMap(map);
+                break;
+            }
+            if (!(ok = tmxObjectsMeasure(layers, queries, opts, &viewSeconds, &objectSeconds, &iterations)))
+                fprintf(stderr, "objects: queries of the views and objects of the %s map with size %d differ\n", name, size);
+            else
+            {
+                printf("{\"bench\":\"objects\",\"format\":\"%s\",\"size\":%d,\"layers\":%zu,\"objects\":%d,\"queries\":%d,"
+                       "\"iterations\":%zu,\"view_ns\":%.3f,\"objects_ns\":%.3f}\n",
+                       name, size, TMX_OBJECTS_LAYERS, objects * size, TMX_OBJECTS_QUERIES, iterations,
+                       viewSeconds * 1e9 / (double) (iterations * TMX_OBJECTS_QUERIES * (size_t) (objects * size)),
+                       objectSeconds * 1e9 / (double) (iterations * TMX_OBJECTS_QUERIES * (size_t) (objects * size)));
+            }
+            tmxFreeMap(map);
+        }
+    }
+    return ok ? 0 : 1;
+}
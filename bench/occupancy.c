@@ -0,0 +1,451 @@
+#include "bench.h"
+#include "tmx/animation.h"
+#include "tmx/colliders.h"
+#include "tmx/cull.h"
+#include "tmx/quads.h"
+#include <unistd.h>
+
+/**
+ * @brief The number of random regions tested for emptiness, and of random edits.
+ */
+#define TMX_OCCUPANCY_SAMPLES 2000
+
+static const int tmxOccupancyPercents[] = {3, 25, 100};
+
+static const TMX_RENDER_ORDER tmxOccupancyOrders[] = {TMX_RENDER_RIGHT_DOWN, TMX_RENDER_RIGHT_UP, TMX_RENDER_LEFT_DOWN,
+                                                      TMX_RENDER_LEFT_UP};
+
+/**
+ * @brief Counts the visited cells and hashes their order, so both layers can be compared.
+ */
+typedef struct TMXoccupancyvisit
+{
+    size_t count;
+    uint64_t hash;
+} TMXoccupancyvisit;
+
+static TMXoccupancyvisit occupancyVisit;
+
+static TMX_BOOL
+tmxOccupancyVisit(const TMXmap *map, const TMXlayer *layer, const TMXtile *tile, int x, int y, TMXgid gid)
+{
+    (void) map;
+    (void) layer;
+    (void) tile;
+    occupancyVisit.count++;
+    occupancyVisit.hash = (occupancyVisit.hash ^ (gid + (uint64_t) x * 0x9E3779B1u + (uint64_t) y * 0x85EBCA77u)) * 0x100000001B3ULL;
+    return TMX_TRUE;
+}
+
+static TMXoccupancyvisit
+tmxOccupancyForeach(TMXmap *map, TMXlayer *layer)
+{
+    memset(&occupancyVisit, 0, sizeof(occupancyVisit));
+    tmxTileForeach(map, layer, TMX_FALSE, tmxOccupancyVisit);
+    return occupancyVisit;
+}
+
+static TMXlayer *
+tmxOccupancyFirstLayer(TMXmap *map)
+{
+    size_t i;
+    for (i = 0; map && i < map->layer_count; i++)
+    {
+        if (map->layers[i]->type == TMX_LAYER_TILE)
+            return map->layers[i];
+    }
+    return NULL;
+}
+
+/**
+ * @brief Counts the blocks of every level of a pyramid that differ from a scan of the tiles.
+ */
+static size_t
+tmxOccupancyCheck(const TMXlayer *layer)
+{
+    const TMXoccupancy *occupancy = layer->occupancy;
+    size_t errors                 = 0;
+    int level, bx, by, x, y;
+
+    if (!occupancy)
+        return 1;
+    for (level = 0; level < TMX_OCCUPANCY_LEVELS; level++)
+    {
+        int size = 1 << (TMX_OCCUPANCY_SHIFT * (level + 1));
+        for (by = 0; by < occupancy->size[level].h; by++)
+        {
+            for (bx = 0; bx < occupancy->size[level].w; bx++)
+            {
+                TMX_BOOL any = TMX_FALSE;
+                for (y = by * size; y < TMX_MIN((by + 1) * size, layer->size.h) && !any; y++)
+                {
+                    for (x = bx * size; x < TMX_MIN((bx + 1) * size, layer->size.w) && !any; x++)
+                        any = layer->data.tiles[(size_t) y * (size_t) layer->size.w + (size_t) x] != 0;
+                }
+                uint64_t word = occupancy->bits[level][(size_t) by * occupancy->stride[level] + (size_t) bx / 64];
+                errors += (TMX_BOOL) ((word >> (bx % 64)) & 1) != any;
+            }
+        }
+    }
+    return errors;
+}
+
+/**
+ * @brief Compares the spans of a culled layer with a pyramid to those without: each span must lie within the span of the
+ * same row, and cover the same tiles.
+ */
+static size_t
+tmxOccupancyCompareCull(const TMXlayer *layer, const TMXvisiblelayer *plain, size_t plainCount, const TMXvisiblelayer *trimmed,
+                        size_t trimmedCount)
+{
+    size_t i, k = 0, errors = 0, tiles[2] = {0, 0};
+    int x, pass;
+
+    if (!plainCount)
+        return trimmedCount != 0;
+    for (pass = 0; pass < 2; pass++)
+    {
+        const TMXvisiblelayer *visible = pass ? (trimmedCount ? trimmed : NULL) : plain;
+        for (i = 0; visible && i < visible->span_count; i++)
+        {
+            const TMXtilespan *span = &visible->spans[i];
+            for (x = span->first; x <= span->last; x++)
+                tiles[pass] += tmxLayerGid(layer, x - layer->position.x, span->y - layer->position.y) != 0;
+        }
+    }
+    errors += tiles[0] != tiles[1];
+
+    for (i = 0; trimmedCount && i < trimmed->span_count; i++)
+    {
+        const TMXtilespan *span = &trimmed->spans[i];
+        while (k < plain->span_count && plain->spans[k].y < span->y)
+            k++;
+        errors += k == plain->span_count || plain->spans[k].y != span->y || span->first < plain->spans[k].first ||
+                  span->last > plain->spans[k].last;
+    }
+    return errors;
+}
+
+/**
+ * @brief Bakes the colliders of the whole layer with a pyramid and of the plain layer, and counts the shapes, outlines
+ * and points that differ.
+ */
+static size_t
+tmxOccupancyCompareColliders(const TMXmap *plainMap, const TMXlayer *plain, const TMXmap *map, const TMXlayer *layer)
+{
+    TMXcolliders *a = tmxCollidersCreate(), *b = tmxCollidersCreate();
+    TMXrect region  = {.x = 0, .y = 0, .w = layer->size.w, .h = layer->size.h};
+    size_t i, errors = 0;
+
+    if (!a || !b || !tmxBakeCollidersRegion(plainMap, plain, region, a) || !tmxBakeCollidersRegion(map, layer, region, b))
+    {
+        tmxFreeColliders(a);
+        tmxFreeColliders(b);
+        return 1;
+    }
+
+    errors += a->count != b->count || a->outline_count != b->outline_count || a->point_count != b->point_count;
+    for (i = 0; i < TMX_MIN(a->count, b->count); i++)
+    {
+        const TMXcollider *p = &a->colliders[i], *q = &b->colliders[i];
+        errors += p->type != q->type || p->position.x != q->position.x || p->position.y != q->position.y ||
+                  p->size.x != q->size.x || p->size.y != q->size.y || p->first != q->first || p->count != q->count;
+    }
+    for (i = 0; i < TMX_MIN(a->outline_count, b->outline_count); i++)
+    {
+        const TMXoutline *p = &a->outlines[i], *q = &b->outlines[i];
+        errors += p->first != q->first || p->count != q->count || p->hole != q->hole;
+    }
+    for (i = 0; i < TMX_MIN(a->point_count, b->point_count); i++)
+        errors += a->points[i].x != b->points[i].x || a->points[i].y != b->points[i].y;
+
+    tmxFreeColliders(a);
+    tmxFreeColliders(b);
+    return errors;
+}
+
+static size_t
+tmxOccupancyCompareCells(const TMXanimcell *a, size_t aCount, const TMXanimcell *b, size_t bCount)
+{
+    size_t i, errors = aCount != bCount;
+    for (i = 0; i < TMX_MIN(aCount, bCount); i++)
+    {
+        errors += a[i].position.x != b[i].position.x || a[i].position.y != b[i].position.y || a[i].gid != b[i].gid ||
+                  a[i].chunk != b[i].chunk;
+    }
+    return errors;
+}
+
+/**
+ * @brief Creates animators for the layer with a pyramid and the plain layer, and counts the cells that differ, both
+ * initially and as their animations advance.
+ */
+static size_t
+tmxOccupancyCompareAnimators(const TMXmap *plainMap, const TMXlayer *plain, const TMXmap *map, const TMXlayer *layer, size_t *cells)
+{
+    TMXanimator *a = tmxAnimatorCreate(plainMap, plain), *b = tmxAnimatorCreate(map, layer);
+    const TMXanimcell *p, *q;
+    size_t i, changed, count, errors = 0;
+
+    if (!a || !b)
+    {
+        tmxFreeAnimator(a);
+        tmxFreeAnimator(b);
+        return 1;
+    }
+
+    *cells = tmxAnimatorCells(a, &p);
+    count  = tmxAnimatorCells(b, &q);
+    errors += tmxOccupancyCompareCells(p, *cells, q, count);
+    for (i = 0; i < 8; i++)
+    {
+        changed = tmxAnimatorAdvance(a, 75.0 * (double) (i + 1), &p);
+        count   = tmxAnimatorAdvance(b, 75.0 * (double) (i + 1), &q);
+        errors += tmxOccupancyCompareCells(p, changed, q, count);
+    }
+
+    tmxFreeAnimator(a);
+    tmxFreeAnimator(b);
+    return errors;
+}
+
+/**
+ * @brief Makes random edits to the layer with a pyramid, mirroring them into the plain layer, and clears random squares
+ * of up to 80x80 cells one tile at a time so that whole blocks of every level become empty.
+ */
+static void
+tmxOccupancyEdit(TMXlayer *layer, TMXlayer *plain, uint64_t *state)
+{
+    int width = layer->size.w, height = layer->size.h, i, x, y;
+    for (i = 0; i < TMX_OCCUPANCY_SAMPLES; i++)
+    {
+        uint32_t r = tmxBenchRandom(state);
+        x          = (int) (tmxBenchRandom(state) % (uint32_t) width);
+        y          = (int) (tmxBenchRandom(state) % (uint32_t) height);
+        if (r % 64 == 0)
+        {
+            int size = 1 + (int) ((r >> 8) % 80), cx, cy;
+            for (cy = y; cy < TMX_MIN(y + size, height); cy++)
+            {
+                for (cx = x; cx < TMX_MIN(x + size, width); cx++)
+                {
+                    tmxLayerSetGid(layer, cx, cy, 0);
+                    plain->data.tiles[(size_t) cy * (size_t) width + (size_t) cx] = 0;
+                }
+            }
+            continue;
+        }
+
+        TMXgid gid = (r % 3) ? 0 : 1 + (r >> 8) % 8;
+        tmxLayerSetGid(layer, x, y, gid);
+        plain->data.tiles[(size_t) y * (size_t) width + (size_t) x] = gid;
+    }
+}
+
+static int
+tmxOccupancyMeasure(const char *path, const TMXmapspec *spec, const TMXbenchopts *opts)
+{
+    double build = 0.0, foreachPlain = 0.0, foreachPyramid = 0.0, bakePlain = 0.0, bakePyramid = 0.0, cullPlain = 0.0,
+           cullPyramid = 0.0, start;
+    uint64_t state = opts->seed ? opts->seed : 1;
+    size_t n, i, k, errors = 0, spans[2] = {0, 0}, visits = 0, animated = 0;
+    char name[256];
+    int x, y;
+
+    tmxOccupancyPyramids(TMX_FALSE);
+    TMXmap *plainMap = tmxLoadMap(path, NULL, spec->format);
+    tmxOccupancyPyramids(TMX_TRUE);
+    TMXmap *map = tmxLoadMap(path, NULL, spec->format);
+    tmxOccupancyPyramids(TMX_FALSE);
+
+    TMXlayer *plain = tmxOccupancyFirstLayer(plainMap);
+    TMXlayer *layer = tmxOccupancyFirstLayer(map);
+    if (!plain || !layer || plain->occupancy || !layer->occupancy)
+    {
+        fprintf(stderr, "occupancy: failed to load %s\n", path);
+        tmxFreeMap(plainMap);
+        tmxFreeMap(map);
+        return 0;
+    }
+
+    TMXflatlayers *plainFlat   = tmxMapFlattenLayers(plainMap);
+    TMXflatlayers *flat        = tmxMapFlattenLayers(map);
+    TMXculler *plainCuller     = tmxCullerCreate(plainMap, plainFlat);
+    TMXculler *culler          = tmxCullerCreate(map, flat);
+    TMXquadmesh *plainMesh     = tmxQuadMeshCreate();
+    TMXquadmesh *mesh          = tmxQuadMeshCreate();
+    const TMXvisiblelayer *pv  = NULL, *v = NULL;
+    int width = layer->size.w, height = layer->size.h;
+    float mapWidth  = (float) (width * map->tile_size.w);
+    float mapHeight = (float) (height * map->tile_size.h);
+
+    errors += tmxOccupancyCheck(layer);
+    for (n = 0; n < opts->iterations || (!opts->iterations && build + foreachPyramid + bakePyramid + cullPyramid < opts->minSeconds); n++)
+    {
+        start = tmxBenchNow();
+        tmxLayerOccupancy(layer);
+        build += tmxBenchNow() - start;
+
+        start                  = tmxBenchNow();
+        TMXoccupancyvisit full = tmxOccupancyForeach(plainMap, plain);
+        foreachPlain += tmxBenchNow() - start;
+        start                    = tmxBenchNow();
+        TMXoccupancyvisit jumped = tmxOccupancyForeach(map, layer);
+        foreachPyramid += tmxBenchNow() - start;
+        errors += full.count != jumped.count || full.hash != jumped.hash;
+        visits = full.count;
+
+        // The meshes are large enough that the second bake is slowed by the first, so the order alternates.
+        for (k = 0; k < 2; k++)
+        {
+            TMX_BOOL pyramid = (k + n) % 2 != 0;
+            start            = tmxBenchNow();
+            tmxBakeLayer(pyramid ? map : plainMap, pyramid ? layer : plain, pyramid ? mesh : plainMesh);
+            *(pyramid ? &bakePyramid : &bakePlain) += tmxBenchNow() - start;
+        }
+
+        start            = tmxBenchNow();
+        size_t plainCull = tmxCull(plainCuller, 0.0f, 0.0f, mapWidth, mapHeight, &pv);
+        cullPlain += tmxBenchNow() - start;
+        start       = tmxBenchNow();
+        size_t cull = tmxCull(culler, 0.0f, 0.0f, mapWidth, mapHeight, &v);
+        cullPyramid += tmxBenchNow() - start;
+        spans[0] = plainCull ? pv->span_count : 0;
+        spans[1] = cull ? v->span_count : 0;
+    }
+
+    // Every render order and a staggered layout must visit and bake the same tiles in the same order.
+    for (k = 0; k < sizeof(tmxOccupancyOrders) / sizeof(tmxOccupancyOrders[0]) + 1; k++)
+    {
+        TMX_BOOL staggered = k == sizeof(tmxOccupancyOrders) / sizeof(tmxOccupancyOrders[0]);
+        map->render_order = plainMap->render_order = staggered ? TMX_RENDER_RIGHT_DOWN : tmxOccupancyOrders[k];
+        map->orientation = plainMap->orientation = staggered ? TMX_ORIENTATION_STAGGERED : TMX_ORIENTATION_ORTHOGONAL;
+
+        TMXoccupancyvisit a = tmxOccupancyForeach(plainMap, plain), b = tmxOccupancyForeach(map, layer);
+        errors += a.count != b.count || a.hash != b.hash;
+        errors += !tmxBakeLayer(plainMap, plain, plainMesh) || !tmxBakeLayer(map, layer, mesh);
+        errors += plainMesh->quad_count != mesh->quad_count || plainMesh->range_count != mesh->range_count;
+        errors += mesh->quad_count && memcmp(plainMesh->vertices, mesh->vertices, mesh->quad_count * 4 * sizeof(TMXvertex));
+    }
+    errors += tmxOccupancyCompareColliders(plainMap, plain, map, layer);
+    errors += tmxOccupancyCompareAnimators(plainMap, plain, map, layer, &animated);
+    map->render_order = plainMap->render_order = TMX_RENDER_RIGHT_DOWN;
+    map->orientation = plainMap->orientation = TMX_ORIENTATION_ORTHOGONAL;
+
+    // Random viewports, culled with and without the pyramid.
+    for (i = 0; i < 64; i++)
+    {
+        float vx = (float) (tmxBenchRandom(&state) % (uint32_t) (width * map->tile_size.w));
+        float vy = (float) (tmxBenchRandom(&state) % (uint32_t) (height * map->tile_size.h));
+        float vw = (float) (1 + tmxBenchRandom(&state) % 2048), vh = (float) (1 + tmxBenchRandom(&state) % 2048);
+        size_t a = tmxCull(plainCuller, vx, vy, vw, vh, &pv);
+        size_t b = tmxCull(culler, vx, vy, vw, vh, &v);
+        errors += tmxOccupancyCompareCull(plain, pv, a, v, b);
+    }
+
+    // Edits keep the pyramid exact, and the two layers identical.
+    tmxOccupancyEdit(layer, plain, &state);
+    errors += tmxOccupancyCheck(layer);
+    TMXoccupancyvisit a = tmxOccupancyForeach(plainMap, plain), b = tmxOccupancyForeach(map, layer);
+    errors += a.count != b.count || a.hash != b.hash;
+    errors += tmxOccupancyCompareColliders(plainMap, plain, map, layer);
+    errors += tmxOccupancyCompareAnimators(plainMap, plain, map, layer, &animated);
+
+    // Direct writes to the tiles are applied with an update of the region.
+    for (i = 0; i < 16; i++)
+    {
+        int rx = (int) (tmxBenchRandom(&state) % (uint32_t) width), ry = (int) (tmxBenchRandom(&state) % (uint32_t) height);
+        int rw = 1 + (int) (tmxBenchRandom(&state) % 600), rh = 1 + (int) (tmxBenchRandom(&state) % 600);
+        TMXrect region = {.x = rx, .y = ry, .w = TMX_MIN(rw, width - rx), .h = TMX_MIN(rh, height - ry)};
+        TMXgid gid     = (i % 2) ? 0 : 3;
+        for (y = region.y; y < region.y + region.h; y++)
+        {
+            for (x = region.x; x < region.x + region.w; x++)
+                layer->data.tiles[(size_t) y * (size_t) width + (size_t) x] = gid;
+        }
+        tmxLayerUpdateOccupancy(layer, region);
+    }
+    errors += tmxOccupancyCheck(layer);
+
+    // Random regions tested for emptiness, against a scan of the tiles.
+    for (i = 0; i < TMX_OCCUPANCY_SAMPLES; i++)
+    {
+        TMXrect region = {.x = (int) (tmxBenchRandom(&state) % (uint32_t) width) - 8,
+                          .y = (int) (tmxBenchRandom(&state) % (uint32_t) height) - 8,
+                          .w = 1 + (int) (tmxBenchRandom(&state) % 700),
+                          .h = 1 + (int) (tmxBenchRandom(&state) % 700)};
+        TMX_BOOL empty = TMX_TRUE;
+        for (y = TMX_MAX(region.y, 0); y < TMX_MIN(region.y + region.h, height) && empty; y++)
+        {
+            for (x = TMX_MAX(region.x, 0); x < TMX_MIN(region.x + region.w, width) && empty; x++)
+                empty = layer->data.tiles[(size_t) y * (size_t) width + (size_t) x] == 0;
+        }
+        errors += tmxLayerRegionEmpty(layer, region) != empty;
+    }
+
+    tmxBenchSpecName(spec, name, sizeof(name));
+    printf("{\"bench\":\"occupancy\",\"map\":\"%s\",\"occupancy\":%d,\"iterations\":%zu,\"tiles\":%zu,\"pyramid_bytes\":%zu,"
+           "\"build_ms\":%.3f,\"foreach_ms\":%.3f,\"pyramid_foreach_ms\":%.3f,\"bake_ms\":%.3f,\"pyramid_bake_ms\":%.3f,"
+           "\"cull_ms\":%.3f,\"pyramid_cull_ms\":%.3f,\"spans\":%zu,\"pyramid_spans\":%zu,\"animated\":%zu}\n",
+           name, spec->occupancy, n, visits, tmxMapMemoryUsage(map) - tmxMapMemoryUsage(plainMap), build / (double) n * 1e3,
+           foreachPlain / (double) n * 1e3, foreachPyramid / (double) n * 1e3, bakePlain / (double) n * 1e3,
+           bakePyramid / (double) n * 1e3, cullPlain / (double) n * 1e3, cullPyramid / (double) n * 1e3, spans[0], spans[1], animated);
+
+    if (errors)
+        fprintf(stderr, "occupancy: %zu mismatches with the occupancy pyramid of %s\n", errors, name);
+
+    tmxFreeQuadMesh(plainMesh);
+    tmxFreeQuadMesh(mesh);
+    tmxFreeCuller(plainCuller);
+    tmxFreeCuller(culler);
+    tmxFreeFlatLayers(plainFlat);
+    tmxFreeFlatLayers(flat);
+    tmxFreeMap(plainMap);
+    tmxFreeMap(map);
+    return errors == 0;
+}
+
+int
+tmxBenchOccupancy(int argc, char *argv[], const TMXbenchopts *opts)
+{
+    TMXmapspec spec = {0};
+    char path[1024], directory[] = "/tmp/tmx_bench.XXXXXX";
+    size_t s, k;
+    int ok = 1;
+    (void) argc;
+    (void) argv;
+
+    if (!mkdtemp(directory))
+    {
+        perror("mkdtemp");
+        return 1;
+    }
+
+    spec.format      = TMX_FORMAT_XML;
+    spec.encoding    = TMX_ENCODING_BASE64;
+    spec.compression = TMX_COMPRESSION_ZLIB;
+    spec.tileLayers  = 1;
+    spec.seed        = opts->seed;
+
+    for (s = 0; ok && s < opts->sizeCount; s++)
+    {
+        for (k = 0; ok && k < sizeof(tmxOccupancyPercents) / sizeof(tmxOccupancyPercents[0]); k++)
+        {
+            spec.size      = opts->sizes[s];
+            spec.occupancy = tmxOccupancyPercents[k];
+            if (!tmxBenchGenerate(&spec, directory, path, sizeof(path)))
+            {
+                fprintf(stderr, "occupancy: failed to generate a map\n");
+                ok = 0;
+                break;
+            }
+            ok &= tmxOccupancyMeasure(path, &spec, opts);
+            remove(path);
+        }
+    }
+
+    snprintf(path, sizeof(path), "%s/terrain.tsx", directory);
+    remove(path);
+    rmdir(directory);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,353 @@
+#include "bench.h"
+#include "tmx/grids.h"
+#include "tmx/paths.h"
+#include <math.h>
+
+/**
+ * @brief The number of searches in each batch.
+ */
+#define TMX_PATHS_QUERIES 16
+
+/**
+ * @brief The largest grid that is compared against the reference, which relaxes every cell until nothing changes.
+ */
+#define TMX_PATHS_REFERENCE_SIZE 96
+
+/**
+ * @brief The cost of a tile from its properties, or 0 when it cannot be walked on.
+ */
+static uint8_t
+tmxPathsTileCost(const TMXmap *map, const TMXtileset *tileset, const TMXtile *tile, void *user)
+{
+    TMXproperty *property;
+    (void) map;
+    (void) tileset;
+    (void) user;
+
+    if (!tile->properties)
+        return 1;
+    if ((property = tmxGetProperty(tile->properties, "walkable")) && !property->value.integer)
+        return 0;
+    if ((property = tmxGetProperty(tile->properties, "cost")))
+        return (uint8_t) TMX_MAX(1, TMX_MIN(255, property->value.integer));
+    return 1;
+}
+
+/**
+ * @brief Describes the grid being searched, for the reference and path validation.
+ */
+typedef struct TMXpathsgrid
+{
+    const uint8_t *costs;
+    int size;
+    TMX_PATH_NEIGHBORS neighbors;
+    TMX_BOOL staggerX;
+    TMX_BOOL staggerEven;
+} TMXpathsgrid;
+
+static TMX_BOOL
+tmxPathsOpen(const TMXpathsgrid *grid, int x, int y)
+{
+    return x >= 0 && y >= 0 && x < grid->size && y < grid->size && grid->costs[(size_t) y * (size_t) grid->size + (size_t) x];
+}
+
+/**
+ * @brief Computes the center of a hexagonal cell with sides of length 1, where neighboring centers are 1 apart.
+ */
+static void
+tmxPathsHexCenter(const TMXpathsgrid *grid, int x, int y, double *cx, double *cy)
+{
+    int along      = grid->staggerX ? x : y;
+    int across     = grid->staggerX ? y : x;
+    double shifted = ((along & 1) ^ grid->staggerEven) ? 0.5 : 0.0;
+    double a       = (double) along * sqrt(0.75);
+    double b       = (double) across + shifted;
+    *cx            = grid->staggerX ? a : b;
+    *cy            = grid->staggerX ? b : a;
+}
+
+/**
+ * @brief Computes the cost of a single step between two cells, or 0 when they are not connected.
+ */
+static uint32_t
+tmxPathsStep(const TMXpathsgrid *grid, int x, int y, int nx, int ny)
+{
+    int dx = nx - x, dy = ny - y;
+    if ((!dx && !dy) || abs(dx) > 1 || abs(dy) > 1 || !tmxPathsOpen(grid, x, y) || !tmxPathsOpen(grid, nx, ny))
+        return 0;
+
+    uint32_t cost = grid->costs[(size_t) ny * (size_t) grid->size + (size_t) nx];
+    if (grid->neighbors == TMX_PATH_HEX)
+    {
+        double ax, ay, bx, by;
+        tmxPathsHexCenter(grid, x, y, &ax, &ay);
+        tmxPathsHexCenter(grid, nx, ny, &bx, &by);
+        return (ax - bx) * (ax - bx) + (ay - by) * (ay - by) < 1.5 ? TMX_PATH_STRAIGHT_COST * cost : 0;
+    }
+    if (!dx || !dy)
+        return TMX_PATH_STRAIGHT_COST * cost;
+    if (grid->neighbors == TMX_PATH_FOUR || !tmxPathsOpen(grid, nx, y) || !tmxPathsOpen(grid, x, ny))
+        return 0;
+    return TMX_PATH_DIAGONAL_COST * cost;
+}
+
+/**
+ * @brief Computes the least cost between two cells by relaxing every cell until nothing changes.
+ */
+static uint32_t
+tmxPathsReference(const TMXpathsgrid *grid, TMXpoint start, TMXpoint goal)
+{
+    size_t cells    = (size_t) grid->size * (size_t) grid->size;
+    uint32_t *dist  = malloc(cells * sizeof(uint32_t));
+    TMX_BOOL change = TMX_TRUE;
+    int x, y, dx, dy;
+
+    for (size_t i = 0; i < cells; i++)
+        dist[i] = UINT32_MAX;
+    dist[(size_t) start.y * (size_t) grid->size + (size_t) start.x] = 0;
+
+    while (change)
+    {
+        change = TMX_FALSE;
+        for (y = 0; y < grid->size; y++)
+        {
+            for (x = 0; x < grid->size; x++)
+            {
+                uint32_t d = dist[(size_t) y * (size_t) grid->size + (size_t) x];
+                for (dy = -1; d != UINT32_MAX && dy <= 1; dy++)
+                {
+                    for (dx = -1; dx <= 1; dx++)
+                    {
+                        uint32_t step = tmxPathsStep(grid, x, y, x + dx, y + dy);
+                        uint32_t *n   = step ? &dist[(size_t) (y + dy) * (size_t) grid->size + (size_t) (x + dx)] : NULL;
+                        if (n && d + step < *n)
+                        {
+                            *n     = d + step;
+                            change = TMX_TRUE;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    uint32_t result = dist[(size_t) goal.y * (size_t) grid->size + (size_t) goal.x];
+    free(dist);
+    return result;
+}
+
+/**
+ * @brief Tests that a path connects its endpoints with valid steps, and that its cost is the sum of the steps.
+ */
+static TMX_BOOL
+tmxPathsValid(const TMXpathsgrid *grid, const TMXpathlist *list, const TMXpath *path, TMXpoint start, TMXpoint goal)
+{
+    const TMXpoint *points = &list->points[path->first];
+    uint32_t cost          = 0;
+    size_t i;
+
+    if (!path->count || points[0].x != start.x || points[0].y != start.y || points[path->count - 1].x != goal.x ||
+        points[path->count - 1].y != goal.y)
+        return TMX_FALSE;
+    for (i = 1; i < path->count; i++)
+    {
+        uint32_t step = tmxPathsStep(grid, points[i - 1].x, points[i - 1].y, points[i].x, points[i].y);
+        if (!step)
+            return TMX_FALSE;
+        cost += step;
+    }
+    return cost == path->cost;
+}
+
+static TMXpoint
+tmxPathsRandomCell(const TMXpathsgrid *grid, uint64_t *state)
+{
+    TMXpoint point;
+    do
+    {
+        point.x = (int) (tmxBenchRandom(state) % (uint32_t) grid->size);
+        point.y = (int) (tmxBenchRandom(state) % (uint32_t) grid->size);
+    } while (!tmxPathsOpen(grid, point.x, point.y));
+    return point;
+}
+
+static const char *
+tmxPathsNeighborName(TMX_PATH_NEIGHBORS neighbors)
+{
+    switch (neighbors)
+    {
+        case TMX_PATH_FOUR: return "four";
+        case TMX_PATH_EIGHT: return "eight";
+        default: return "hex";
+    }
+}
+
+static const char *
+tmxPathsStaggerName(const TMXpathsgrid *grid)
+{
+    if (grid->neighbors != TMX_PATH_HEX)
+        return "none";
+    if (grid->staggerX)
+        return grid->staggerEven ? "x-even" : "x-odd";
+    return grid->staggerEven ? "y-even" : "y-odd";
+}
+
+/**
+ * @brief Runs a batch of searches, validating each path, and comparing the costs against a reference or another method.
+ *
+ * @param[in] expected The cost of each search from another method, or @c NULL to use the reference. Larger grids than
+ * @ref TMX_PATHS_REFERENCE_SIZE are then only validated.
+ * @param[out] costs Receives the cost of each search, or @c UINT32_MAX when no path was found.
+ */
+static int
+tmxPathsMeasure(const TMXmap *map, const TMXpathsgrid *grid, TMX_PATH_METHOD method, const char *weights, const TMXpoint *starts,
+                const TMXpoint *goals, const uint32_t *expected, uint32_t *costs, const TMXbenchopts *opts)
+{
+    TMXrect region = {.x = 0, .y = 0, .w = grid->size, .h = grid->size};
+    double start, create, elapsed = 0.0;
+    size_t i, n, found = 0, points = 0, errors = 0;
+
+    start                 = tmxBenchNow();
+    TMXpathfinder *finder = tmxPathfinderCreate(map, grid->costs, region, grid->neighbors);
+    create                = tmxBenchNow() - start;
+    TMXpathlist *list     = tmxPathListCreate();
+    if (!finder || !list)
+    {
+        tmxFreePathfinder(finder);
+        tmxFreePathList(list);
+        return 0;
+    }
+
+    for (n = 0; n < opts->iterations || (!opts->iterations && elapsed < opts->minSeconds); n++)
+    {
+        start = tmxBenchNow();
+        found = tmxPathFindBatch(finder, starts, goals, TMX_PATHS_QUERIES, method, list);
+        elapsed += tmxBenchNow() - start;
+    }
+
+    for (i = 0; i < TMX_PATHS_QUERIES; i++)
+    {
+        const TMXpath *path = &list->paths[i];
+        costs[i]            = path->count ? path->cost : UINT32_MAX;
+        uint32_t reference  = costs[i];
+        if (expected)
+            reference = expected[i];
+        else if (grid->size <= TMX_PATHS_REFERENCE_SIZE)
+            reference = tmxPathsReference(grid, starts[i], goals[i]);
+        points += path->count;
+        if (costs[i] != reference || (path->count && !tmxPathsValid(grid, list, path, starts[i], goals[i])))
+            errors++;
+    }
+
+    // A single search reuses the workspace, and must give the same result as within the batch.
+    if (tmxPathFind(finder, starts[0], goals[0], method, list) != (costs[0] != UINT32_MAX) ||
+        (list->paths[0].count && list->paths[0].cost != costs[0]))
+        errors++;
+
+    if (errors)
+        fprintf(stderr, "paths: %s %s search on %s grid found %zu incorrect paths\n", tmxPathsNeighborName(grid->neighbors),
+                method == TMX_PATH_JPS ? "jps" : "astar", weights, errors);
+    else
+        printf("{\"bench\":\"paths\",\"width\":%d,\"height\":%d,\"neighbors\":\"%s\",\"method\":\"%s\",\"weights\":\"%s\","
+               "\"stagger\":\"%s\",\"queries\":%d,\"found\":%zu,\"avg_length\":%.1f,\"create_ms\":%.3f,\"batches\":%zu,\"us_per_query\":%.3f}\n",
+               grid->size, grid->size, tmxPathsNeighborName(grid->neighbors), method == TMX_PATH_JPS ? "jps" : "astar", weights,
+               tmxPathsStaggerName(grid), TMX_PATHS_QUERIES, found, found ? (double) points / (double) found : 0.0, create * 1e3, n,
+               elapsed / (double) n / TMX_PATHS_QUERIES * 1e6);
+
+    tmxFreePathfinder(finder);
+    tmxFreePathList(list);
+    return errors == 0;
+}
+
+static int
+tmxPathsRun(TMXmap *map, const TMXbenchopts *opts)
+{
+    TMXrect region = {.x = 0, .y = 0, .w = map->size.w, .h = map->size.h};
+    size_t i, cells = (size_t) region.w * (size_t) region.h;
+    uint8_t *costs = malloc(cells), *uniform = malloc(cells);
+    TMXpoint starts[TMX_PATHS_QUERIES], goals[TMX_PATHS_QUERIES];
+    uint32_t astar[TMX_PATHS_QUERIES], other[TMX_PATHS_QUERIES];
+    uint64_t state = opts->seed ? opts->seed : 1;
+    int ok = 1, axis, index;
+
+    TMXtiletable *table = tmxTileTableCreate(map, tmxPathsTileCost, NULL, 1);
+    if (!costs || !uniform || !table || !tmxGridFill((const TMXlayer *const *) map->layers, 1, table, region, TMX_GRID_TOP, costs))
+    {
+        fprintf(stderr, "paths: failed to fill the grid\n");
+        free(costs);
+        free(uniform);
+        tmxFreeTileTable(table);
+        return 0;
+    }
+    for (i = 0; i < cells; i++)
+        uniform[i] = costs[i] ? 1 : 0;
+
+    TMXpathsgrid grid = {.costs = uniform, .size = map->size.w, .neighbors = TMX_PATH_EIGHT};
+    for (i = 0; i < TMX_PATHS_QUERIES; i++)
+    {
+        starts[i] = tmxPathsRandomCell(&grid, &state);
+        goals[i]  = tmxPathsRandomCell(&grid, &state);
+    }
+
+    // Jump point search must find paths of the same cost as A* on the same grid.
+    ok &= tmxPathsMeasure(map, &grid, TMX_PATH_ASTAR, "uniform", starts, goals, NULL, astar, opts);
+    ok &= tmxPathsMeasure(map, &grid, TMX_PATH_JPS, "uniform", starts, goals, astar, other, opts);
+
+    grid.costs = costs;
+    ok &= tmxPathsMeasure(map, &grid, TMX_PATH_ASTAR, "cost", starts, goals, NULL, astar, opts);
+    grid.neighbors = TMX_PATH_FOUR;
+    ok &= tmxPathsMeasure(map, &grid, TMX_PATH_ASTAR, "cost", starts, goals, NULL, astar, opts);
+
+    // Hexagonal grids are searched with every stagger axis and index, as if the map were hexagonal.
+    TMXmap hex      = *map;
+    hex.orientation = TMX_ORIENTATION_HEXAGONAL;
+    grid.neighbors  = TMX_PATH_HEX;
+    for (axis = 0; axis < 2; axis++)
+    {
+        for (index = 0; index < 2; index++)
+        {
+            hex.stagger.axis  = axis ? TMX_AXIS_X : TMX_AXIS_Y;
+            hex.stagger.index = index ? TMX_INDEX_EVEN : TMX_INDEX_ODD;
+            grid.staggerX     = axis;
+            grid.staggerEven  = index;
+            ok &= tmxPathsMeasure(&hex, &grid, TMX_PATH_ASTAR, "cost", starts, goals, NULL, astar, opts);
+        }
+    }
+
+    free(costs);
+    free(uniform);
+    tmxFreeTileTable(table);
+    return ok;
+}
+
+int
+tmxBenchPaths(int argc, char *argv[], const TMXbenchopts *opts)
+{
+    TMXmapspec spec = {0};
+    size_t s;
+    int ok = 1;
+    (void) argc;
+    (void) argv;
+
+    spec.format      = TMX_FORMAT_XML;
+    spec.encoding    = TMX_ENCODING_BASE64;
+    spec.compression = TMX_COMPRESSION_ZLIB;
+    spec.tileLayers  = 1;
+    spec.seed        = opts->seed;
+
+    for (s = 0; s < opts->sizeCount; s++)
+    {
+        spec.size   = opts->sizes[s];
+        TMXmap *map = tmxBenchLoadGenerated(&spec);
+        if (!map || !map->layer_count)
+        {
+            fprintf(stderr, "paths: failed to load a generated map\n");
+            tmxFreeMap(map);
+            return 1;
+        }
+
+        ok &= tmxPathsRun(map, opts);
+        tmxFreeMap(map);
+    }
+    return ok ? 0 : 1;
+}
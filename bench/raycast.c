@@ -0,0 +1,375 @@
+#include "bench.h"
+#include "tmx/raycast.h"
+#include <math.h>
+
+/**
+ * @brief The number of rays in each batch.
+ */
+#define TMX_RAYCAST_RAYS 4096
+
+/**
+ * @brief The longest ray, in tiles.
+ */
+#define TMX_RAYCAST_LENGTH 48.0f
+
+/**
+ * @brief The number of rays compared against the reference, which tests every cell around each.
+ */
+#define TMX_RAYCAST_VERIFY 1024
+
+/**
+ * @brief The directions along the axes and diagonals.
+ */
+static const int tmxOctants[8][2] = {{1, 0}, {1, 1}, {0, 1}, {-1, 1}, {-1, 0}, {-1, -1}, {0, -1}, {1, -1}};
+
+static uint8_t
+tmxRaycastTileSolid(const TMXmap *map, const TMXtileset *tileset, const TMXtile *tile, void *user)
+{
+    TMXproperty *property;
+    (void) map;
+    (void) tileset;
+    (void) user;
+    return tile->properties && (property = tmxGetProperty(tile->properties, "walkable")) && !property->value.integer;
+}
+
+static float
+tmxRaycastUniform(uint64_t *state)
+{
+    return (float) (tmxBenchRandom(state) & 0xFFFFFF) / (float) 0x1000000;
+}
+
+/**
+ * @brief Finds the first solid cell a segment passes through the interior of, other than the cell of its start, by
+ * intersecting the segment with every cell around it.
+ */
+static TMX_BOOL
+tmxRaycastReference(const TMXraycaster *caster, const TMXray *ray, TMXpoint *cell, double *distance)
+{
+    double sx = ray->start.x, sy = ray->start.y, dx = ray->end.x - sx, dy = ray->end.y - sy;
+    int x0 = (int) floor(TMX_MIN(sx, ray->end.x)), x1 = (int) floor(TMX_MAX(sx, ray->end.x));
+    int y0 = (int) floor(TMX_MIN(sy, ray->end.y)), y1 = (int) floor(TMX_MAX(sy, ray->end.y));
+    double best = INFINITY;
+    TMXrect region;
+    int x, y;
+
+    const uint64_t *bits = tmxRaycasterBits(caster, &region);
+    size_t stride        = ((size_t) region.w + 63) / 64;
+    for (y = TMX_MAX(y0, region.y); y <= TMX_MIN(y1, region.y + region.h - 1); y++)
+    {
+        for (x = TMX_MAX(x0, region.x); x <= TMX_MIN(x1, region.x + region.w - 1); x++)
+        {
+            size_t lx = (size_t) (x - region.x), ly = (size_t) (y - region.y);
+            if (!((bits[ly * stride + lx / 64] >> (lx % 64)) & 1) || (x == (int) floor(sx) && y == (int) floor(sy)))
+                continue;
+
+            double lo = 0.0, hi = 1.0;
+            double a  = dx != 0.0 ? (x - sx) / dx : (sx >= x && sx < x + 1 ? -INFINITY : INFINITY);
+            double b  = dx != 0.0 ? (x + 1 - sx) / dx : -a;
+            lo        = TMX_MAX(lo, TMX_MIN(a, b));
+            hi        = TMX_MIN(hi, TMX_MAX(a, b));
+            a         = dy != 0.0 ? (y - sy) / dy : (sy >= y && sy < y + 1 ? -INFINITY : INFINITY);
+            b         = dy != 0.0 ? (y + 1 - sy) / dy : -a;
+            lo        = TMX_MAX(lo, TMX_MIN(a, b));
+            hi        = TMX_MIN(hi, TMX_MAX(a, b));
+            if (hi - lo > 1e-9 && lo < best)
+            {
+                best    = lo;
+                cell->x = x;
+                cell->y = y;
+            }
+        }
+    }
+    *distance = best * sqrt(dx * dx + dy * dy);
+    return best != INFINITY;
+}
+
+/**
+ * @brief Compares rays against the reference, and against a raycaster over a copy of the bitmap provided by the caller.
+ */
+static size_t
+tmxRaycastVerifyRays(TMXraycaster *caster, const TMXray *rays, TMXrayhit *hits)
+{
+    TMXrect region;
+    const uint64_t *bits = tmxRaycasterBits(caster, &region);
+    TMXraycaster *shared = tmxRaycasterCreateBits(bits, region);
+    TMXrayhit other;
+    uint8_t visible;
+    size_t i, errors = 0;
+
+    tmxRaycast(caster, rays, TMX_RAYCAST_VERIFY, hits);
+    for (i = 0; i < TMX_RAYCAST_VERIFY; i++)
+    {
+        TMXpoint cell;
+        double distance;
+        TMX_BOOL hit = tmxRaycastReference(caster, &rays[i], &cell, &distance);
+        if (hit != hits[i].hit)
+            errors++;
+        else if (hit && (cell.x != hits[i].cell.x || cell.y != hits[i].cell.y || fabs(distance - hits[i].distance) > 1e-3))
+            errors++;
+
+        tmxRaycast(shared, &rays[i], 1, &other);
+        tmxLineOfSight(caster, &rays[i], 1, &visible);
+        if (other.hit != hits[i].hit || other.distance != hits[i].distance || visible == hits[i].hit)
+            errors++;
+
+        // Clearing the cell that was hit lets the ray continue to the next one, or its end.
+        if (hit)
+        {
+            tmxRaycasterSetCell(caster, cell, TMX_FALSE);
+            tmxRaycast(caster, &rays[i], 1, &other);
+            if (other.hit && other.distance < hits[i].distance)
+                errors++;
+            tmxRaycasterSetCell(caster, cell, TMX_TRUE);
+        }
+    }
+
+    tmxFreeRaycaster(shared);
+    return errors;
+}
+
+/**
+ * @brief A slope that is in the shadow of a solid cell when strictly between @a low and @a high.
+ */
+typedef struct TMXraycastshadow
+{
+    double low, high;
+} TMXraycastshadow;
+
+static int
+tmxRaycastCompareShadows(const void *a, const void *b)
+{
+    double x = ((const TMXraycastshadow *) a)->low, y = ((const TMXraycastshadow *) b)->low;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Tests whether a cell is visible by the rule of the field of view, by testing its slopes against the shadows of
+ * every solid cell.
+ *
+ * @details The cells around the origin are split into eight octants, each a triangle of rows outwards from the origin
+ * along an axis. The slopes from the center of the origin to the corners of a cell are the range that the cell covers
+ * in its octant, from 0 on the axis to 1 on the diagonal. A cell is visible in an octant when a slope of its range, its
+ * corners included, is not strictly inside the range of a solid cell in a nearer row, and is visible when it is in any
+ * of the octants that contain it, so that cells on the axes and diagonals are tested on both sides.
+ */
+static TMX_BOOL
+tmxRaycastViewReference(const TMXraycaster *caster, TMXpoint origin, int dx, int dy, TMXraycastshadow *shadows)
+{
+    TMXrect region;
+    const uint64_t *bits = tmxRaycasterBits(caster, &region);
+    size_t stride = ((size_t) region.w + 63) / 64, count, i;
+    int octant, row, column, k, u;
+
+    if (!dx && !dy)
+        return TMX_TRUE;
+
+    // Each octant is a choice of axis and of a direction along each axis.
+    for (octant = 0; octant < 8; octant++)
+    {
+        int major = octant & 1, sx = octant & 2 ? -1 : 1, sy = octant & 4 ? -1 : 1;
+        row    = major ? abs(dx) : abs(dy);
+        column = major ? abs(dy) : abs(dx);
+        if (column > row || (dx && (dx > 0) != (sx > 0)) || (dy && (dy > 0) != (sy > 0)))
+            continue;
+
+        count = 0;
+        for (k = 1; k < row; k++)
+        {
+            for (u = 0; u <= k; u++)
+            {
+                int x = origin.x + sx * (major ? k : u) - region.x, y = origin.y + sy * (major ? u : k) - region.y;
+                if (x < 0 || y < 0 || x >= region.w || y >= region.h || !((bits[(size_t) y * stride + (size_t) x / 64] >> (x % 64)) & 1))
+                    continue;
+                shadows[count].low    = (u - 0.5) / (k + 0.5);
+                shadows[count++].high = (u + 0.5) / (k - 0.5);
+            }
+        }
+
+        // Sweeping the shadows in order finds the lowest slope of the cell that none of them contains.
+        double slope = TMX_MAX(0.0, (column - 0.5) / (row + 0.5)), last = TMX_MIN(1.0, (column + 0.5) / (row - 0.5));
+        qsort(shadows, count, sizeof(TMXraycastshadow), tmxRaycastCompareShadows);
+        for (i = 0; i < count && shadows[i].low < slope; i++)
+            slope = TMX_MAX(slope, shadows[i].high);
+        if (slope <= last)
+            return TMX_TRUE;
+    }
+    return TMX_FALSE;
+}
+
+/**
+ * @brief Tests that the field of view is within its radius, and that a cell is lit exactly when it is visible by the
+ * reference rule. Every cell with line of sight between centers, including along the axes and diagonals, must be lit.
+ */
+static size_t
+tmxRaycastVerifyView(const TMXraycaster *caster, TMXpoint origin, int radius, const uint64_t *view, size_t count)
+{
+    size_t stride = (size_t) (2 * radius + 64) / 64, visible = 0, errors = 0;
+    TMXraycastshadow *shadows = malloc((size_t) (radius + 1) * (size_t) (radius + 2) / 2 * sizeof(TMXraycastshadow));
+    int i, j;
+
+    if (!shadows)
+        return 1;
+
+    for (j = 0; j <= 2 * radius; j++)
+    {
+        for (i = 0; i <= 2 * radius; i++)
+        {
+            int dx = i - radius, dy = j - radius;
+            TMX_BOOL lit = (view[(size_t) j * stride + (size_t) i / 64] >> (i % 64)) & 1;
+            TMXray ray   = {{origin.x + 0.5f, origin.y + 0.5f}, {origin.x + dx + 0.5f, origin.y + dy + 0.5f}};
+            uint8_t sight;
+
+            visible += lit;
+            if (dx * dx + dy * dy > radius * radius)
+            {
+                errors += lit;
+                continue;
+            }
+
+            tmxLineOfSight(caster, &ray, 1, &sight);
+            errors += lit != tmxRaycastViewReference(caster, origin, dx, dy, shadows);
+            errors += sight && !lit;
+        }
+    }
+    free(shadows);
+    return errors + (visible != count) + !((view[(size_t) radius * stride + (size_t) radius / 64] >> (radius % 64)) & 1);
+}
+
+static int
+tmxRaycastMeasure(TMXmap *map, const TMXbenchopts *opts)
+{
+    const TMXlayer *layer = map->layers[0];
+    TMXray *rays          = malloc(TMX_RAYCAST_RAYS * sizeof(TMXray));
+    TMXrayhit *hits       = malloc(TMX_RAYCAST_RAYS * sizeof(TMXrayhit));
+    uint8_t *visible      = malloc(TMX_RAYCAST_RAYS);
+    uint64_t state        = opts->seed ? opts->seed : 1;
+    static const int radii[] = {8, 16, 32};
+    double start, create, cast = 0.0, sight = 0.0;
+    size_t i, n, hitCount = 0, errors = 0;
+
+    TMXtiletable *table  = tmxTileTableCreate(map, tmxRaycastTileSolid, NULL, 0);
+    start                = tmxBenchNow();
+    TMXraycaster *caster = table ? tmxRaycasterCreate(&layer, 1, table) : NULL;
+    create               = tmxBenchNow() - start;
+    if (!rays || !hits || !visible || !caster)
+    {
+        fprintf(stderr, "raycast: failed to create the raycaster\n");
+        free(rays);
+        free(hits);
+        free(visible);
+        tmxFreeRaycaster(caster);
+        tmxFreeTileTable(table);
+        return 0;
+    }
+
+    // Rays begin anywhere around the map, including outside of it, and point in any direction.
+    for (i = 0; i < TMX_RAYCAST_RAYS; i++)
+    {
+        float angle     = tmxRaycastUniform(&state) * 6.2831853f;
+        float length    = tmxRaycastUniform(&state) * TMX_RAYCAST_LENGTH;
+        rays[i].start.x = tmxRaycastUniform(&state) * (float) (map->size.w + 16) - 8.0f;
+        rays[i].start.y = tmxRaycastUniform(&state) * (float) (map->size.h + 16) - 8.0f;
+        rays[i].end.x   = rays[i].start.x + cosf(angle) * length;
+        rays[i].end.y   = rays[i].start.y + sinf(angle) * length;
+
+        // Some rays run from the center of a cell along an axis or a diagonal, passing exactly through cell corners.
+        if (i % 8 == 0)
+        {
+            int direction   = (int) (tmxBenchRandom(&state) % 8), steps = 1 + (int) (length / 1.5f);
+            rays[i].start.x = floorf(rays[i].start.x) + 0.5f;
+            rays[i].start.y = floorf(rays[i].start.y) + 0.5f;
+            rays[i].end.x   = rays[i].start.x + (float) (tmxOctants[direction][0] * steps);
+            rays[i].end.y   = rays[i].start.y + (float) (tmxOctants[direction][1] * steps);
+        }
+    }
+    errors += tmxRaycastVerifyRays(caster, rays, hits);
+
+    for (n = 0; n < opts->iterations || (!opts->iterations && cast + sight < opts->minSeconds); n++)
+    {
+        start    = tmxBenchNow();
+        hitCount = tmxRaycast(caster, rays, TMX_RAYCAST_RAYS, hits);
+        cast += tmxBenchNow() - start;
+
+        start = tmxBenchNow();
+        tmxLineOfSight(caster, rays, TMX_RAYCAST_RAYS, visible);
+        sight += tmxBenchNow() - start;
+    }
+
+    printf("{\"bench\":\"raycast\",\"infinite\":%s,\"width\":%d,\"height\":%d,\"create_ms\":%.3f,\"rays\":%d,\"hits\":%zu,"
+           "\"batches\":%zu,\"ns_per_ray\":%.2f,\"ns_per_sight\":%.2f}\n",
+           layer->type == TMX_LAYER_CHUNK ? "true" : "false", map->size.w, map->size.h, create * 1e3, TMX_RAYCAST_RAYS, hitCount, n,
+           cast / (double) n / TMX_RAYCAST_RAYS * 1e9, sight / (double) n / TMX_RAYCAST_RAYS * 1e9);
+
+    for (i = 0; i < sizeof(radii) / sizeof(radii[0]); i++)
+    {
+        uint64_t *view = malloc(tmxFieldOfViewSize(radii[i]) * sizeof(uint64_t));
+        double elapsed = 0.0;
+        size_t k, cells = 0, views = 0;
+        for (k = 0; view && k < 16; k++)
+        {
+            TMXpoint origin;
+            origin.x     = (int) (tmxBenchRandom(&state) % (uint32_t) map->size.w);
+            origin.y     = (int) (tmxBenchRandom(&state) % (uint32_t) map->size.h);
+            size_t count = tmxFieldOfView(caster, origin, radii[i], view);
+            errors += tmxRaycastVerifyView(caster, origin, radii[i], view, count);
+
+            for (n = 0; n < opts->iterations || (!opts->iterations && elapsed < opts->minSeconds / 16.0); n++)
+            {
+                start = tmxBenchNow();
+                cells += tmxFieldOfView(caster, origin, radii[i], view);
+                elapsed += tmxBenchNow() - start;
+                views++;
+            }
+        }
+        printf("{\"bench\":\"fov\",\"infinite\":%s,\"width\":%d,\"height\":%d,\"radius\":%d,\"views\":%zu,\"visible_cells\":%.1f,"
+               "\"us_per_view\":%.3f}\n",
+               layer->type == TMX_LAYER_CHUNK ? "true" : "false", map->size.w, map->size.h, radii[i], views,
+               views ? (double) cells / (double) views : 0.0, views ? elapsed / (double) views * 1e6 : 0.0);
+        free(view);
+    }
+
+    if (errors)
+        fprintf(stderr, "raycast: %s layer gave %zu incorrect results\n", layer->type == TMX_LAYER_CHUNK ? "infinite" : "finite", errors);
+    free(rays);
+    free(hits);
+    free(visible);
+    tmxFreeRaycaster(caster);
+    tmxFreeTileTable(table);
+    return errors == 0;
+}
+
+int
+tmxBenchRaycast(int argc, char *argv[], const TMXbenchopts *opts)
+{
+    TMXmapspec spec = {0};
+    size_t s;
+    int inf, ok = 1;
+    (void) argc;
+    (void) argv;
+
+    spec.format      = TMX_FORMAT_XML;
+    spec.encoding    = TMX_ENCODING_BASE64;
+    spec.compression = TMX_COMPRESSION_ZLIB;
+    spec.tileLayers  = 1;
+    spec.seed        = opts->seed;
+
+    for (s = 0; s < opts->sizeCount; s++)
+    {
+        for (inf = 0; inf < 2; inf++)
+        {
+            spec.size     = opts->sizes[s];
+            spec.infinite = inf;
+            TMXmap *map   = tmxBenchLoadGenerated(&spec);
+            if (!map || !map->layer_count)
+            {
+                fprintf(stderr, "raycast: failed to load a generated map\n");
+                tmxFreeMap(map);
+                return 1;
+            }
+
+            ok &= tmxRaycastMeasure(map, opts);
+            tmxFreeMap(map);
+        }
+    }
+    return ok ? 0 : 1;
+}
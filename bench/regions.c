@@ -0,0 +1,376 @@
+#include "bench.h"
+#include "tmx/grids.h"
+#include "tmx/regions.h"
+#include <pthread.h>
+
+/**
+ * @brief The width and height of the tiles labeled by each thread.
+ */
+#define TMX_REGIONS_TILE 256
+
+/**
+ * @brief The number of threads labeling tiles at the same time.
+ */
+#define TMX_REGIONS_THREADS 4
+
+/**
+ * @brief The neighbors of a cell for the reference, which are listed separately from the library.
+ */
+typedef struct TMXregionsref
+{
+    TMX_REGION_CONNECT connect;
+    TMX_BOOL staggerX;
+    TMX_BOOL staggerEven;
+    const char *name;
+} TMXregionsref;
+
+typedef struct TMXregionsthread
+{
+    const TMXlabeler *labeler;
+    TMXregions *regions;
+    size_t tiles;
+    size_t first;
+} TMXregionsthread;
+
+static uint8_t
+tmxRegionsTileSolid(const TMXmap *map, const TMXtileset *tileset, const TMXtile *tile, void *user)
+{
+    TMXproperty *property;
+    (void) map;
+    (void) tileset;
+    (void) user;
+    return tile->properties && (property = tmxGetProperty(tile->properties, "walkable")) && !property->value.integer;
+}
+
+static uint8_t
+tmxRegionsTileWalkable(const TMXmap *map, const TMXtileset *tileset, const TMXtile *tile, void *user)
+{
+    return !tmxRegionsTileSolid(map, tileset, tile, user);
+}
+
+static int
+tmxRegionsNeighbors(const TMXregionsref *ref, int x, int y, int (*cells)[2])
+{
+    static const int eight[8][2] = {{-1, -1}, {0, -1}, {1, -1}, {-1, 0}, {1, 0}, {-1, 1}, {0, 1}, {1, 1}};
+    int i, n = 0;
+
+    for (i = 0; i < 8; i++)
+    {
+        int dx = eight[i][0], dy = eight[i][1];
+        if (ref->connect == TMX_REGION_HEX)
+        {
+            // Shifted rows (or columns) are offset by half a cell, so hexagons touch where their centers are a cell apart.
+            int along = ref->staggerX ? x : y, step = ref->staggerX ? dx : dy, cross = ref->staggerX ? dy : dx;
+            double a  = (((along & 1) ^ ref->staggerEven) ? 0.5 : 0.0);
+            double b  = ((((along + step) & 1) ^ ref->staggerEven) ? 0.5 : 0.0);
+            double d  = (double) cross + b - a;
+            if (step ? d * d != 0.25 : cross * cross != 1)
+                continue;
+        }
+        else if (ref->connect == TMX_REGION_FOUR && dx && dy)
+            continue;
+        cells[n][0] = dx;
+        cells[n][1] = dy;
+        n++;
+    }
+    return n;
+}
+
+/**
+ * @brief Labels a grid with a breadth-first search from the first unlabeled cell of each region, in row-major order.
+ */
+static size_t
+tmxRegionsReference(const TMXregionsref *ref, const uint8_t *grid, TMXrect region, uint32_t *labels, uint32_t *queue)
+{
+    size_t cells = (size_t) region.w * (size_t) region.h, i, head, tail;
+    uint32_t count = 0;
+    int cellsOf[8][2], n, k;
+
+    memset(labels, 0, cells * sizeof(uint32_t));
+    for (i = 0; i < cells; i++)
+    {
+        if (!grid[i] || labels[i])
+            continue;
+
+        labels[i] = ++count;
+        queue[0]  = (uint32_t) i;
+        for (head = 0, tail = 1; head < tail; head++)
+        {
+            int x = (int) (queue[head] % (uint32_t) region.w), y = (int) (queue[head] / (uint32_t) region.w);
+            n     = tmxRegionsNeighbors(ref, x + region.x, y + region.y, cellsOf);
+            for (k = 0; k < n; k++)
+            {
+                int nx = x + cellsOf[k][0], ny = y + cellsOf[k][1];
+                if (nx < 0 || ny < 0 || nx >= region.w || ny >= region.h)
+                    continue;
+
+                size_t index = (size_t) ny * (size_t) region.w + (size_t) nx;
+                if (grid[index] && !labels[index])
+                {
+                    labels[index]   = count;
+                    queue[tail++]   = (uint32_t) index;
+                }
+            }
+        }
+    }
+    return count;
+}
+
+/**
+ * @brief Compares labeled regions against the reference labels, including the bounds and size of each region.
+ */
+static size_t
+tmxRegionsVerify(const TMXregions *regions, const uint32_t *expected, size_t count, TMXrect region)
+{
+    size_t cells = (size_t) region.w * (size_t) region.h, errors = 0, i;
+    size_t *sizes;
+    TMXrect *bounds;
+
+    if (regions->count != count || memcmp(&regions->bounds, &region, sizeof(TMXrect)))
+        return 1;
+    if (memcmp(regions->labels, expected, cells * sizeof(uint32_t)))
+        return 1;
+
+    sizes  = calloc(count + 1, sizeof(size_t));
+    bounds = malloc((count + 1) * sizeof(TMXrect));
+    for (i = 0; i <= count; i++)
+    {
+        bounds[i].x = bounds[i].y = INT32_MAX;
+        bounds[i].w = bounds[i].h = INT32_MIN;
+    }
+    for (i = 0; i < cells; i++)
+    {
+        uint32_t label = expected[i];
+        int x = (int) (i % (size_t) region.w) + region.x, y = (int) (i / (size_t) region.w) + region.y;
+        sizes[label]++;
+        bounds[label].x = TMX_MIN(bounds[label].x, x);
+        bounds[label].y = TMX_MIN(bounds[label].y, y);
+        bounds[label].w = TMX_MAX(bounds[label].w, x);
+        bounds[label].h = TMX_MAX(bounds[label].h, y);
+    }
+    for (i = 0; i < count; i++)
+    {
+        const TMXregion *r = &regions->regions[i];
+        const TMXrect *b   = &bounds[i + 1];
+        if (r->cells != sizes[i + 1] || r->bounds.x != b->x || r->bounds.y != b->y || r->bounds.w != b->w - b->x + 1 ||
+            r->bounds.h != b->h - b->y + 1)
+            errors++;
+    }
+    free(sizes);
+    free(bounds);
+    return errors;
+}
+
+static void *
+tmxRegionsWorker(void *arg)
+{
+    TMXregionsthread *thread = arg;
+    size_t i;
+    for (i = thread->first; i < thread->tiles; i += TMX_REGIONS_THREADS)
+        tmxLabelTile(thread->labeler, thread->regions, i);
+    return NULL;
+}
+
+/**
+ * @brief Labels the tiles of a grid on several threads, joining them once every thread is done.
+ */
+static TMX_BOOL
+tmxRegionsLabelThreads(TMXlabeler *labeler, TMXregions *regions)
+{
+    pthread_t threads[TMX_REGIONS_THREADS];
+    TMXregionsthread args[TMX_REGIONS_THREADS];
+    size_t tiles;
+    int i;
+
+    if (!tmxLabelBegin(labeler, regions, TMX_REGIONS_TILE, &tiles))
+        return TMX_FALSE;
+    for (i = 0; i < TMX_REGIONS_THREADS; i++)
+    {
+        args[i] = (TMXregionsthread){labeler, regions, tiles, (size_t) i};
+        pthread_create(&threads[i], NULL, tmxRegionsWorker, &args[i]);
+    }
+    for (i = 0; i < TMX_REGIONS_THREADS; i++)
+        pthread_join(threads[i], NULL);
+    return tmxLabelEnd(labeler, regions);
+}
+
+static TMX_BOOL
+tmxRegionsLabelTiles(TMXlabeler *labeler, TMXregions *regions)
+{
+    size_t tiles, i;
+    if (!tmxLabelBegin(labeler, regions, TMX_REGIONS_TILE, &tiles))
+        return TMX_FALSE;
+    for (i = 0; i < tiles; i++)
+        tmxLabelTile(labeler, regions, i);
+    return tmxLabelEnd(labeler, regions);
+}
+
+/**
+ * @brief Fills every region in order of its first cell, accumulating in one bitmap, and compares each with its label.
+ */
+static size_t
+tmxRegionsFillAll(TMXlabeler *labeler, const uint8_t *grid, const TMXregions *regions, uint64_t *bitmap, size_t *filled)
+{
+    TMXrect region = tmxLabelerRegion(labeler), bounds;
+    size_t stride  = ((size_t) region.w + 63) / 64, errors = 0, count = 0, cells;
+    int x, y;
+
+    memset(bitmap, 0, stride * (size_t) region.h * sizeof(uint64_t));
+    *filled = 0;
+    for (y = 0; y < region.h; y++)
+    {
+        for (x = 0; x < region.w; x++)
+        {
+            if (!grid[(size_t) y * (size_t) region.w + (size_t) x] || ((bitmap[(size_t) y * stride + (size_t) (x >> 6)] >> (x & 63)) & 1))
+                continue;
+
+            TMXpoint seed = {x + region.x, y + region.y};
+            cells         = tmxFloodFill(labeler, seed, bitmap, &bounds);
+            *filled += cells;
+            if (regions && (count >= regions->count || cells != regions->regions[count].cells ||
+                            memcmp(&bounds, &regions->regions[count].bounds, sizeof(TMXrect))))
+                errors++;
+            count++;
+        }
+    }
+    return errors + (regions && count != regions->count);
+}
+
+static int
+tmxRegionsMeasure(const TMXmap *map, const TMXlayer *layer, const TMXtiletable *table, const char *predicate, const TMXregionsref *ref,
+                  const TMXbenchopts *opts)
+{
+    TMXmap hex      = *map;
+    hex.orientation = TMX_ORIENTATION_HEXAGONAL;
+    hex.stagger.axis  = ref->staggerX ? TMX_AXIS_X : TMX_AXIS_Y;
+    hex.stagger.index = ref->staggerEven ? TMX_INDEX_EVEN : TMX_INDEX_ODD;
+
+    TMXlabeler *labeler = tmxLabelerCreateLayer(&hex, layer, table, ref->connect);
+    TMXregions *regions = tmxRegionsCreate();
+    if (!labeler || !regions)
+    {
+        fprintf(stderr, "regions: failed to create the labeler\n");
+        tmxFreeLabeler(labeler);
+        tmxFreeRegions(regions);
+        return 0;
+    }
+
+    TMXrect region  = tmxLabelerRegion(labeler);
+    size_t cells    = (size_t) region.w * (size_t) region.h;
+    uint8_t *grid   = malloc(TMX_MAX(cells, 1));
+    uint32_t *ref0  = malloc(TMX_MAX(cells, 1) * sizeof(uint32_t));
+    uint32_t *queue = malloc(TMX_MAX(cells, 1) * sizeof(uint32_t));
+    uint64_t *bits  = malloc(TMX_MAX(((size_t) region.w + 63) / 64 * (size_t) region.h, 1) * sizeof(uint64_t));
+    TMXlabeler *bytes = NULL;
+    double start, single = 0.0, tiled = 0.0, threaded = 0.0, fill = 0.0;
+    size_t n, expected, errors = 0, filled = 0, open = 0, i;
+
+    if (cells)
+        tmxGridFill(&layer, 1, table, region, TMX_GRID_TOP, grid);
+    for (i = 0; i < cells; i++)
+        open += grid[i] != 0;
+    bytes    = tmxLabelerCreate(&hex, grid, region, ref->connect);
+    expected = tmxRegionsReference(ref, grid, region, ref0, queue);
+
+    // Each way of labeling must produce the same labels as the reference, in the same order.
+    errors += !tmxLabel(labeler, regions) || tmxRegionsVerify(regions, ref0, expected, region);
+    errors += !tmxRegionsLabelTiles(bytes, regions) || tmxRegionsVerify(regions, ref0, expected, region);
+    errors += !tmxRegionsLabelThreads(labeler, regions) || tmxRegionsVerify(regions, ref0, expected, region);
+    errors += !tmxRegionsLabelThreads(bytes, regions) || tmxRegionsVerify(regions, ref0, expected, region);
+    errors += !tmxLabel(bytes, regions) || tmxRegionsVerify(regions, ref0, expected, region);
+    errors += tmxRegionsFillAll(labeler, grid, regions, bits, &filled);
+    errors += filled != open;
+
+    for (n = 0; n < opts->iterations || (!opts->iterations && single + tiled + threaded + fill < opts->minSeconds); n++)
+    {
+        start = tmxBenchNow();
+        tmxLabel(labeler, regions);
+        single += tmxBenchNow() - start;
+
+        start = tmxBenchNow();
+        tmxRegionsLabelTiles(labeler, regions);
+        tiled += tmxBenchNow() - start;
+
+        start = tmxBenchNow();
+        tmxRegionsLabelThreads(labeler, regions);
+        threaded += tmxBenchNow() - start;
+
+        start = tmxBenchNow();
+        tmxRegionsFillAll(labeler, grid, NULL, bits, &filled);
+        fill += tmxBenchNow() - start;
+    }
+
+    printf("{\"bench\":\"regions\",\"infinite\":%s,\"width\":%d,\"height\":%d,\"cells\":\"%s\",\"connect\":\"%s\",\"regions\":%zu,"
+           "\"open_cells\":%zu,\"iterations\":%zu,\"ns_per_cell\":%.3f,\"tiled_ns_per_cell\":%.3f,\"threads\":%d,"
+           "\"threaded_ns_per_cell\":%.3f,\"fill_ns_per_cell\":%.3f}\n",
+           layer->type == TMX_LAYER_CHUNK ? "true" : "false", region.w, region.h, predicate, ref->name, expected, open, n,
+           single / (double) n / (double) TMX_MAX(cells, 1) * 1e9, tiled / (double) n / (double) TMX_MAX(cells, 1) * 1e9,
+           TMX_REGIONS_THREADS, threaded / (double) n / (double) TMX_MAX(cells, 1) * 1e9,
+           fill / (double) n / (double) TMX_MAX(cells, 1) * 1e9);
+
+    if (errors)
+        fprintf(stderr, "regions: %zu mismatches against the reference (%s, %s, %dx%d)\n", errors, predicate, ref->name, region.w,
+                region.h);
+
+    free(grid);
+    free(ref0);
+    free(queue);
+    free(bits);
+    tmxFreeLabeler(bytes);
+    tmxFreeLabeler(labeler);
+    tmxFreeRegions(regions);
+    return errors == 0;
+}
+
+int
+tmxBenchRegions(int argc, char *argv[], const TMXbenchopts *opts)
+{
+    static const TMXregionsref refs[] = {
+        {TMX_REGION_FOUR, TMX_FALSE, TMX_FALSE, "four"},
+        {TMX_REGION_EIGHT, TMX_FALSE, TMX_FALSE, "eight"},
+        {TMX_REGION_HEX, TMX_FALSE, TMX_FALSE, "hex-y-odd"},
+        {TMX_REGION_HEX, TMX_TRUE, TMX_TRUE, "hex-x-even"},
+    };
+    TMXmapspec spec = {0};
+    size_t s, i;
+    int ok = 1, inf;
+    (void) argc;
+    (void) argv;
+
+    spec.format      = TMX_FORMAT_XML;
+    spec.encoding    = TMX_ENCODING_BASE64;
+    spec.compression = TMX_COMPRESSION_ZLIB;
+    spec.tileLayers  = 1;
+    spec.seed        = opts->seed;
+
+    for (s = 0; s < opts->sizeCount; s++)
+    {
+        for (inf = 0; inf < 2; inf++)
+        {
+            spec.size     = opts->sizes[s];
+            spec.infinite = inf;
+            TMXmap *map   = tmxBenchLoadGenerated(&spec);
+            if (!map || !map->layer_count)
+            {
+                fprintf(stderr, "regions: failed to load a generated map\n");
+                tmxFreeMap(map);
+                return 1;
+            }
+
+            // Solid cells form many small regions, and walkable cells a few that span most of the map.
+            TMXtiletable *solid    = tmxTileTableCreate(map, tmxRegionsTileSolid, NULL, 0);
+            TMXtiletable *walkable = tmxTileTableCreate(map, tmxRegionsTileWalkable, NULL, 0);
+            for (i = 0; solid && walkable && i < sizeof(refs) / sizeof(refs[0]); i++)
+            {
+                ok &= tmxRegionsMeasure(map, map->layers[0], solid, "solid", &refs[i], opts);
+                ok &= tmxRegionsMeasure(map, map->layers[0], walkable, "walkable", &refs[i], opts);
+            }
+            ok &= solid && walkable;
+
+            tmxFreeTileTable(solid);
+            tmxFreeTileTable(walkable);
+            tmxFreeMap(map);
+        }
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,263 @@
+#include "bench.h"
+#include <unistd.h>
+
+/**
+ * @brief The number of random cells read for each measurement.
+ */
+#define TMX_SPARSE_SAMPLES 1000000
+
+/**
+ * @brief The threshold the sparse maps are loaded with, which stores every generated layer sparsely except the densest.
+ */
+#define TMX_SPARSE_THRESHOLD 0.5f
+
+static const int tmxSparseOccupancies[] = {2, 5, 20, 60, 100};
+
+/**
+ * @brief Counts the visited cells, sums their GIDs and hashes their order, so both layouts can be compared.
+ */
+typedef struct TMXsparsevisit
+{
+    size_t count;
+    uint64_t sum;
+    uint64_t hash;
+} TMXsparsevisit;
+
+static TMXsparsevisit sparseVisit;
+
+static void
+tmxSparseAdd(TMXsparsevisit *visit, int x, int y, TMXgid gid)
+{
+    visit->count++;
+    visit->sum += gid + (uint64_t) x * 31 + (uint64_t) y * 17;
+    visit->hash = (visit->hash ^ (gid + (uint64_t) (uint32_t) x * 0x9E3779B1u + (uint64_t) (uint32_t) y * 0x85EBCA77u)) *
+                  0x100000001B3ULL;
+}
+
+static TMX_BOOL
+tmxSparseVisit(const TMXmap *map, const TMXlayer *layer, const TMXtile *tile, int x, int y, TMXgid gid)
+{
+    (void) map;
+    (void) layer;
+    (void) tile;
+    tmxSparseAdd(&sparseVisit, x, y, gid);
+    return TMX_TRUE;
+}
+
+/**
+ * @brief Iterates both layouts in each render order, and compares the cells, their coordinates and their order with the
+ * non-empty cells of the dense layer visited row by row in that order.
+ *
+ * @return The number of render orders that either layout visited differently.
+ */
+static size_t
+tmxSparseVerifyOrders(TMXmap *denseMap, TMXlayer *layer, TMXmap *sparseMap, TMXlayer *sparse)
+{
+    static const TMX_RENDER_ORDER orders[] = {TMX_RENDER_RIGHT_DOWN, TMX_RENDER_RIGHT_UP, TMX_RENDER_LEFT_DOWN, TMX_RENDER_LEFT_UP};
+    TMX_RENDER_ORDER original = denseMap->render_order;
+    int r, c, x, y, width = layer->size.w, height = layer->size.h;
+    size_t k, errors = 0;
+
+    for (k = 0; k < sizeof(orders) / sizeof(orders[0]); k++)
+    {
+        TMX_BOOL up = orders[k] == TMX_RENDER_RIGHT_UP || orders[k] == TMX_RENDER_LEFT_UP;
+        TMX_BOOL left = orders[k] == TMX_RENDER_LEFT_DOWN || orders[k] == TMX_RENDER_LEFT_UP;
+        TMXsparsevisit expected = {0};
+
+        for (r = 0; r < height; r++)
+        {
+            y = up ? height - 1 - r : r;
+            for (c = 0; c < width; c++)
+            {
+                x          = left ? width - 1 - c : c;
+                TMXgid gid = layer->data.tiles[(size_t) y * (size_t) width + (size_t) x];
+                if (gid & TMX_GID_TILE_MASK)
+                    tmxSparseAdd(&expected, x, y, gid);
+            }
+        }
+
+        denseMap->render_order  = orders[k];
+        sparseMap->render_order = orders[k];
+        memset(&sparseVisit, 0, sizeof(sparseVisit));
+        tmxTileForeach(denseMap, layer, TMX_FALSE, tmxSparseVisit);
+        errors += sparseVisit.count != expected.count || sparseVisit.hash != expected.hash;
+
+        memset(&sparseVisit, 0, sizeof(sparseVisit));
+        tmxTileForeach(sparseMap, sparse, TMX_FALSE, tmxSparseVisit);
+        errors += sparseVisit.count != expected.count || sparseVisit.hash != expected.hash;
+    }
+
+    denseMap->render_order  = original;
+    sparseMap->render_order = original;
+    return errors;
+}
+
+static TMXlayer *
+tmxSparseFirstLayer(TMXmap *map)
+{
+    size_t i;
+    for (i = 0; map && i < map->layer_count; i++)
+    {
+        if (map->layers[i]->type == TMX_LAYER_TILE || map->layers[i]->type == TMX_LAYER_CHUNK)
+            return map->layers[i];
+    }
+    return NULL;
+}
+
+/**
+ * @brief Loads a map with the given threshold, accumulating the time spent.
+ */
+static TMXmap *
+tmxSparseLoad(const char *path, const TMXmapspec *spec, float threshold, double *elapsed)
+{
+    tmxSparseLayers(threshold);
+    double start = tmxBenchNow();
+    TMXmap *map  = tmxLoadMap(path, NULL, spec->format);
+    *elapsed += tmxBenchNow() - start;
+    tmxSparseLayers(-1.0f);
+    return map;
+}
+
+static int
+tmxSparseMeasure(const char *path, const TMXmapspec *spec, const TMXbenchopts *opts)
+{
+    double loadDense = 0.0, loadSparse = 0.0, foreachDense = 0.0, foreachSparse = 0.0, get = 0.0, dense = 0.0, start;
+    uint64_t state = opts->seed ? opts->seed : 1;
+    TMXsparsevisit denseVisits = {0}, sparseVisits = {0};
+    volatile TMXgid sink = 0;
+    TMXgid sum           = 0;
+    size_t n, i, errors = 0;
+    char name[256];
+    int x, y;
+
+    TMXmap *denseMap  = tmxSparseLoad(path, spec, -1.0f, &loadDense);
+    TMXmap *sparseMap = tmxSparseLoad(path, spec, TMX_SPARSE_THRESHOLD, &loadSparse);
+    TMXlayer *layer   = tmxSparseFirstLayer(denseMap);
+    TMXlayer *sparse  = tmxSparseFirstLayer(sparseMap);
+    if (!layer || !sparse || layer->type != TMX_LAYER_TILE)
+    {
+        fprintf(stderr, "sparse: failed to load %s\n", path);
+        tmxFreeMap(denseMap);
+        tmxFreeMap(sparseMap);
+        return 0;
+    }
+
+    // Every cell, and a margin around the layer, must read the same from both layouts.
+    int width = layer->size.w, height = layer->size.h;
+    for (y = -2; y < height + 2; y++)
+    {
+        for (x = -2; x < width + 2; x++)
+        {
+            TMX_BOOL inside = x >= 0 && y >= 0 && x < width && y < height;
+            errors += tmxLayerGid(sparse, x, y) != (inside ? layer->data.tiles[(size_t) y * (size_t) width + (size_t) x] : 0);
+        }
+    }
+
+    errors += tmxSparseVerifyOrders(denseMap, layer, sparseMap, sparse);
+
+    uint32_t *points = malloc(TMX_SPARSE_SAMPLES * 2 * sizeof(uint32_t));
+    for (i = 0; i < TMX_SPARSE_SAMPLES; i++)
+    {
+        points[i * 2]     = tmxBenchRandom(&state) % (uint32_t) width;
+        points[i * 2 + 1] = tmxBenchRandom(&state) % (uint32_t) height;
+    }
+
+    for (n = 0; n < opts->iterations || (!opts->iterations && foreachDense + foreachSparse + get + dense < opts->minSeconds); n++)
+    {
+        memset(&sparseVisit, 0, sizeof(sparseVisit));
+        start = tmxBenchNow();
+        tmxTileForeach(denseMap, layer, TMX_FALSE, tmxSparseVisit);
+        foreachDense += tmxBenchNow() - start;
+        denseVisits = sparseVisit;
+
+        memset(&sparseVisit, 0, sizeof(sparseVisit));
+        start = tmxBenchNow();
+        tmxTileForeach(sparseMap, sparse, TMX_FALSE, tmxSparseVisit);
+        foreachSparse += tmxBenchNow() - start;
+        sparseVisits = sparseVisit;
+        errors += denseVisits.count != sparseVisits.count || denseVisits.sum != sparseVisits.sum;
+
+        start = tmxBenchNow();
+        for (i = 0; i < TMX_SPARSE_SAMPLES; i++)
+            sum += tmxLayerGid(sparse, (int) points[i * 2], (int) points[i * 2 + 1]);
+        get += tmxBenchNow() - start;
+
+        start = tmxBenchNow();
+        for (i = 0; i < TMX_SPARSE_SAMPLES; i++)
+            sum -= layer->data.tiles[(size_t) points[i * 2 + 1] * (size_t) width + points[i * 2]];
+        dense += tmxBenchNow() - start;
+    }
+    sink = sum;
+    (void) sink;
+    errors += sum != 0;
+
+    // The remaining loads, so that load times are averaged over the same number of iterations.
+    for (i = 1; i < n; i++)
+    {
+        tmxFreeMap(tmxSparseLoad(path, spec, -1.0f, &loadDense));
+        tmxFreeMap(tmxSparseLoad(path, spec, TMX_SPARSE_THRESHOLD, &loadSparse));
+    }
+
+    tmxBenchSpecName(spec, name, sizeof(name));
+    printf("{\"bench\":\"sparse\",\"map\":\"%s\",\"occupancy\":%d,\"iterations\":%zu,\"sparse\":%s,\"chunks\":%zu,\"tiles\":%zu,"
+           "\"dense_bytes\":%zu,\"sparse_bytes\":%zu,\"dense_load_ms\":%.3f,\"sparse_load_ms\":%.3f,\"dense_foreach_ms\":%.3f,"
+           "\"sparse_foreach_ms\":%.3f,\"get_ns\":%.3f,\"dense_get_ns\":%.3f}\n",
+           name, spec->occupancy, n, sparse->type == TMX_LAYER_CHUNK ? "true" : "false",
+           sparse->type == TMX_LAYER_CHUNK ? sparse->count : 0,
+           denseVisits.count, tmxMapMemoryUsage(denseMap), tmxMapMemoryUsage(sparseMap), loadDense / (double) n * 1e3,
+           loadSparse / (double) n * 1e3, foreachDense / (double) n * 1e3, foreachSparse / (double) n * 1e3,
+           get / (double) n / TMX_SPARSE_SAMPLES * 1e9, dense / (double) n / TMX_SPARSE_SAMPLES * 1e9);
+
+    if (errors)
+        fprintf(stderr, "sparse: %zu mismatches between the dense and sparse layers of %s\n", errors, name);
+
+    free(points);
+    tmxFreeMap(denseMap);
+    tmxFreeMap(sparseMap);
+    return errors == 0;
+}
+
+int
+tmxBenchSparse(int argc, char *argv[], const TMXbenchopts *opts)
+{
+    TMXmapspec spec = {0};
+    char path[1024], directory[] = "/tmp/tmx_bench.XXXXXX";
+    size_t s, k;
+    int ok = 1;
+    (void) argc;
+    (void) argv;
+
+    if (!mkdtemp(directory))
+    {
+        perror("mkdtemp");
+        return 1;
+    }
+
+    spec.format      = TMX_FORMAT_XML;
+    spec.encoding    = TMX_ENCODING_BASE64;
+    spec.compression = TMX_COMPRESSION_ZLIB;
+    spec.tileLayers  = 1;
+    spec.seed        = opts->seed;
+
+    for (s = 0; ok && s < opts->sizeCount; s++)
+    {
+        for (k = 0; ok && k < sizeof(tmxSparseOccupancies) / sizeof(tmxSparseOccupancies[0]); k++)
+        {
+            spec.size      = opts->sizes[s];
+            spec.occupancy = tmxSparseOccupancies[k];
+            if (!tmxBenchGenerate(&spec, directory, path, sizeof(path)))
+            {
+                fprintf(stderr, "sparse: failed to generate a map\n");
+                ok = 0;
+                break;
+            }
+            ok &= tmxSparseMeasure(path, &spec, opts);
+            remove(path);
+        }
+    }
+
+    snprintf(path, sizeof(path), "%s/terrain.tsx", directory);
+    remove(path);
+    rmdir(directory);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,361 @@
+#include "bench.h"
+
+/**
+ * @brief The number of random GIDs resolved for each measurement.
+ */
+#define TMX_TILESETS_SAMPLES 100000
+
+/**
+ * @brief The layout of the image tileset, which has uneven tiles, margin and spacing so that every term of the source
+ * rectangle is distinct.
+ */
+#define TMX_TILESETS_TILE_W  16
+#define TMX_TILESETS_TILE_H  12
+#define TMX_TILESETS_MARGIN  2
+#define TMX_TILESETS_SPACING 3
+#define TMX_TILESETS_COLUMNS 8
+
+/**
+ * @brief The source rectangle and image size of a tile, as expected from the generated documents.
+ */
+typedef struct TMXtilesetsrect
+{
+    int x, y, w, h;
+    int imageWidth, imageHeight;
+} TMXtilesetsrect;
+
+/**
+ * @brief Computes the dimensions of the image of the atlas tileset with @a count tiles.
+ */
+static TMXsize
+tmxTilesetsAtlasSize(int count)
+{
+    int rows = (count + TMX_TILESETS_COLUMNS - 1) / TMX_TILESETS_COLUMNS;
+    TMXsize size;
+    size.w = TMX_TILESETS_MARGIN * 2 + TMX_TILESETS_COLUMNS * TMX_TILESETS_TILE_W + (TMX_TILESETS_COLUMNS - 1) * TMX_TILESETS_SPACING;
+    size.h = TMX_TILESETS_MARGIN * 2 + rows * TMX_TILESETS_TILE_H + (rows - 1) * TMX_TILESETS_SPACING;
+    return size;
+}
+
+/**
+ * @brief Computes the expected rectangle of the tile with local ID @a id in the atlas tileset.
+ */
+static TMXtilesetsrect
+tmxTilesetsAtlasRect(int count, int id)
+{
+    TMXsize size         = tmxTilesetsAtlasSize(count);
+    TMXtilesetsrect rect = {0};
+    rect.x               = TMX_TILESETS_MARGIN + (id % TMX_TILESETS_COLUMNS) * (TMX_TILESETS_TILE_W + TMX_TILESETS_SPACING);
+    rect.y               = TMX_TILESETS_MARGIN + (id / TMX_TILESETS_COLUMNS) * (TMX_TILESETS_TILE_H + TMX_TILESETS_SPACING);
+    rect.w               = TMX_TILESETS_TILE_W;
+    rect.h               = TMX_TILESETS_TILE_H;
+    rect.imageWidth      = size.w;
+    rect.imageHeight     = size.h;
+    return rect;
+}
+
+/**
+ * @brief Computes the expected rectangle of the tile at index @a i of the collection tileset. Tiles have every other ID,
+ * images of varying sizes, and every third one uses a sub-rectangle of its image.
+ */
+static TMXtilesetsrect
+tmxTilesetsCollectionRect(int i, TMX_BOOL *subRect)
+{
+    TMXtilesetsrect rect = {0};
+    rect.imageWidth      = 8 + (i % 5) * 4;
+    rect.imageHeight     = 8 + (i % 7) * 4;
+    *subRect             = (TMX_BOOL) (i % 3 == 0);
+    if (*subRect)
+    {
+        rect.x = 1;
+        rect.y = 2;
+        rect.w = rect.imageWidth - 2;
+        rect.h = rect.imageHeight - 3;
+    }
+    else
+    {
+        rect.w = rect.imageWidth;
+        rect.h = rect.imageHeight;
+    }
+    return rect;
+}
+
+/**
+ * @brief Writes a map with an atlas tileset of @a count tiles, followed by a collection tileset of @a count / 2 tiles.
+ *
+ * @return The document, which must be freed with @c free, or @c NULL on failure.
+ */
+static char *
+tmxTilesetsDocument(TMX_FORMAT format, int count)
+{
+    TMXsize atlas = tmxTilesetsAtlasSize(count);
+    TMXtilesetsrect rect;
+    TMX_BOOL subRect;
+    char *text = NULL;
+    size_t size;
+    int i;
+
+    FILE *fp = open_memstream(&text, &size);
+    if (!fp)
+        return NULL;
+
+    if (format == TMX_FORMAT_JSON)
+    {
+        fprintf(fp,
+                "{\"type\":\"map\",\"version\":\"1.10\",\"tiledversion\":\"1.10.1\",\"orientation\":\"orthogonal\",\"renderorder\":"
+                "\"right-down\",\"width\":1,\"height\":1,\"tilewidth\":16,\"tileheight\":16,\"infinite\":false,\"nextlayerid\":2,"
+                "\"nextobjectid\":1,\"layers\":[{\"type\":\"tilelayer\",\"id\":1,\"name\":\"ground\",\"x\":0,\"y\":0,\"width\":1,"
+                "\"height\":1,\"opacity\":1,\"visible\":true,\"encoding\":\"csv\",\"data\":[1]}],\"tilesets\":[\n");
+        fprintf(fp,
+                "{\"firstgid\":1,\"name\":\"atlas\",\"tilewidth\":%d,\"tileheight\":%d,\"spacing\":%d,\"margin\":%d,\"tilecount\":%d,"
+                "\"columns\":%d,\"image\":\"atlas.png\",\"imagewidth\":%d,\"imageheight\":%d},\n",
+                TMX_TILESETS_TILE_W, TMX_TILESETS_TILE_H, TMX_TILESETS_SPACING, TMX_TILESETS_MARGIN, count, TMX_TILESETS_COLUMNS,
+                atlas.w, atlas.h);
+        fprintf(fp, "{\"firstgid\":%d,\"name\":\"props\",\"tilewidth\":32,\"tileheight\":32,\"tilecount\":%d,\"columns\":0,\"tiles\":[",
+                count + 1, count / 2);
+        for (i = 0; i < count / 2; i++)
+        {
+            rect = tmxTilesetsCollectionRect(i, &subRect);
+            fprintf(fp, "%s\n{\"id\":%d,\"image\":\"prop%d.png\",\"imagewidth\":%d,\"imageheight\":%d", i ? "," : "", i * 2, i,
+                    rect.imageWidth, rect.imageHeight);
+            if (subRect)
+                fprintf(fp, ",\"x\":%d,\"y\":%d,\"width\":%d,\"height\":%d", rect.x, rect.y, rect.w, rect.h);
+            fputc('}', fp);
+        }
+        fprintf(fp, "]}]}\n");
+    }
+    else
+    {
+        fprintf(fp, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<map version=\"1.10\" tiledversion=\"1.10.1\" orientation=\"orthogonal\" "
+                    "renderorder=\"right-down\" width=\"1\" height=\"1\" tilewidth=\"16\" tileheight=\"16\" infinite=\"0\" "
+                    "nextlayerid=\"2\" nextobjectid=\"1\">\n");
+        fprintf(fp,
+                " <tileset firstgid=\"1\" name=\"atlas\" tilewidth=\"%d\" tileheight=\"%d\" spacing=\"%d\" margin=\"%d\" tilecount=\"%d\" "
+                "columns=\"%d\">\n  <image source=\"atlas.png\" width=\"%d\" height=\"%d\"/>\n </tileset>\n",
+                TMX_TILESETS_TILE_W, TMX_TILESETS_TILE_H, TMX_TILESETS_SPACING, TMX_TILESETS_MARGIN, count, TMX_TILESETS_COLUMNS,
+                atlas.w, atlas.h);
+        fprintf(fp, " <tileset firstgid=\"%d\" name=\"props\" tilewidth=\"32\" tileheight=\"32\" tilecount=\"%d\" columns=\"0\">\n",
+                count + 1, count / 2);
+        for (i = 0; i < count / 2; i++)
+        {
+            rect = tmxTilesetsCollectionRect(i, &subRect);
+            fprintf(fp, "  <tile id=\"%d\"", i * 2);
+            if (subRect)
+                fprintf(fp, " x=\"%d\" y=\"%d\" width=\"%d\" height=\"%d\"", rect.x, rect.y, rect.w, rect.h);
+            fprintf(fp, ">\n   <image source=\"prop%d.png\" width=\"%d\" height=\"%d\"/>\n  </tile>\n", i, rect.imageWidth,
+                    rect.imageHeight);
+        }
+        fprintf(fp, " </tileset>\n <layer id=\"1\" name=\"ground\" width=\"1\" height=\"1\">\n  <data encoding=\"csv\">1</data>\n"
+                    " </layer>\n</map>\n");
+    }
+
+    if (fclose(fp))
+    {
+        free(text);
+        return NULL;
+    }
+    return text;
+}
+
+/**
+ * @brief Finds the tile of a GID as without a table: resolving its tileset, and searching its tiles for the local ID.
+ */
+static const TMXtile *
+tmxTilesetsReference(const TMXmap *map, TMXgid gid, const TMXtileset **tileset)
+{
+    TMXtid id;
+    size_t i;
+
+    if (!(*tileset = tmxMapTileset(map, gid, &id)))
+        return NULL;
+    for (i = 0; i < (*tileset)->tile_count; i++)
+    {
+        if ((*tileset)->tiles[i].id == id)
+            return &(*tileset)->tiles[i];
+    }
+    return NULL;
+}
+
+/**
+ * @brief Tests whether an entry of a table matches the expected rectangle, texture coordinates and image.
+ */
+static TMX_BOOL
+tmxTilesetsEntryEqual(const TMXtilerects *rects, TMXtid id, const TMXtilesetsrect *expected, const TMXimage *image)
+{
+    if (rects->x[id] != expected->x || rects->y[id] != expected->y || rects->width[id] != expected->w ||
+        rects->height[id] != expected->h || rects->images[id] != image)
+        return TMX_FALSE;
+    return rects->u0[id] == (float) expected->x / (float) expected->imageWidth &&
+           rects->v0[id] == (float) expected->y / (float) expected->imageHeight &&
+           rects->u1[id] == (float) (expected->x + expected->w) / (float) expected->imageWidth &&
+           rects->v1[id] == (float) (expected->y + expected->h) / (float) expected->imageHeight;
+}
+
+/**
+ * @brief Compares every entry of the tables of both tilesets with the rectangle of the tile it belongs to, the rectangle
+ * expected from the document, and checks that the IDs a collection skips have empty entries.
+ *
+ * @return The number of incorrect entries.
+ */
+static size_t
+tmxTilesetsVerify(const TMXmap *map, int count)
+{
+    const TMXtileset *atlas = map->tileset_count == 2 ? map->tilesets[0].tileset : NULL;
+    const TMXtileset *props = map->tileset_count == 2 ? map->tilesets[1].tileset : NULL;
+    const TMXtileset *tileset;
+    const TMXtile *tile;
+    TMXtilesetsrect expected;
+    TMX_BOOL subRect;
+    size_t errors = 0;
+    TMXtid id;
+    int i;
+
+    if (!atlas || !props || !atlas->rects || !props->rects || atlas->rects->count != (size_t) count ||
+        props->rects->count != (size_t) (count / 2) * 2 - 1)
+        return 1;
+
+    for (i = 0; i < count; i++)
+    {
+        tile     = tmxTilesetsReference(map, (TMXgid) (1 + i), &tileset);
+        expected = tmxTilesetsAtlasRect(count, i);
+        if (tileset != atlas || !tile || tile->rect.x != expected.x || tile->rect.y != expected.y || tile->rect.w != expected.w ||
+            tile->rect.h != expected.h || !tmxTilesetsEntryEqual(atlas->rects, (TMXtid) i, &expected, atlas->image))
+            errors++;
+    }
+
+    // The IDs of a collection have gaps, which the table indexes as empty entries.
+    for (id = 0; id < (TMXtid) props->rects->count; id++)
+    {
+        tile = tmxTilesetsReference(map, (TMXgid) count + 1 + id, &tileset);
+        if (id % 2)
+        {
+            if (tileset != props || tile || props->rects->width[id] || props->rects->height[id] || props->rects->images[id])
+                errors++;
+            continue;
+        }
+
+        expected = tmxTilesetsCollectionRect((int) id / 2, &subRect);
+        if (tileset != props || !tile || !tile->image || tile->image->size.w != expected.imageWidth ||
+            tile->image->size.h != expected.imageHeight || !tmxTilesetsEntryEqual(props->rects, id, &expected, tile->image))
+            errors++;
+
+        // Without a sub-rectangle, a tile uses its whole image, which the JSON parser stores as its size.
+        else if ((tile->rect.w || tile->rect.h) && (tile->rect.x != expected.x || tile->rect.y != expected.y ||
+                                                    tile->rect.w != expected.w || tile->rect.h != expected.h))
+            errors++;
+    }
+    return errors;
+}
+
+/**
+ * @brief Times resolving random GIDs to their normalized source rectangle, through the table and through the tiles.
+ */
+static void
+tmxTilesetsMeasure(const TMXmap *map, const TMXgid *gids, const TMXbenchopts *opts, double *tableSeconds, double *tileSeconds,
+                   size_t *iterations)
+{
+    const TMXtileset *tileset;
+    const TMXtile *tile;
+    volatile float sink = 0.0f;
+    size_t n, i, rounds = opts->iterations ? opts->iterations : 1;
+    TMXtid id;
+    double start;
+
+    for (;;)
+    {
+        start = tmxBenchNow();
+        for (n = 0; n < rounds; n++)
+        {
+            for (i = 0; i < TMX_TILESETS_SAMPLES; i++)
+            {
+                if ((tileset = tmxMapTileset(map, gids[i], &id)))
+                    sink += tileset->rects->u0[id] + tileset->rects->v0[id] + tileset->rects->u1[id] + tileset->rects->v1[id];
+            }
+        }
+        *tableSeconds = tmxBenchNow() - start;
+        if (opts->iterations || *tableSeconds >= opts->minSeconds)
+            break;
+        rounds *= 2;
+    }
+    *iterations = rounds;
+
+    start = tmxBenchNow();
+    for (n = 0; n < rounds; n++)
+    {
+        for (i = 0; i < TMX_TILESETS_SAMPLES; i++)
+        {
+            if (!(tile = tmxTilesetsReference(map, gids[i], &tileset)))
+                continue;
+            TMXsize size = tile->image ? tile->image->size : tileset->image->size;
+            TMXrect rect = tile->rect;
+            if (rect.w <= 0 || rect.h <= 0)
+                rect.size = size;
+            sink += (float) rect.x / (float) size.w + (float) rect.y / (float) size.h + (float) (rect.x + rect.w) / (float) size.w +
+                    (float) (rect.y + rect.h) / (float) size.h;
+        }
+    }
+    *tileSeconds = tmxBenchNow() - start;
+}
+
+int
+tmxBenchTilesets(int argc, char *argv[], const TMXbenchopts *opts)
+{
+    static const TMX_FORMAT formats[] = {TMX_FORMAT_XML, TMX_FORMAT_JSON};
+    TMXgid *gids = malloc(TMX_TILESETS_SAMPLES * sizeof(TMXgid));
+    double tableSeconds, tileSeconds;
+    size_t s, f, i, errors, iterations;
+    uint64_t state = opts->seed ? opts->seed : 1;
+    TMXmap *map;
+    char *text;
+    int ok = 1, count;
+    (void) argc;
+    (void) argv;
+
+    if (!gids)
+        return 1;
+
+    for (s = 0; ok && s < opts->sizeCount; s++)
+    {
+        count = TMX_MAX(opts->sizes[s], 4);
+        for (i = 0; i < TMX_TILESETS_SAMPLES; i++)
+            gids[i] = 1 + tmxBenchRandom(&state) % (TMXgid) (count + (count / 2) * 2 - 1);
+
+        for (f = 0; ok && f < sizeof(formats) / sizeof(formats[0]); f++)
+        {
+            if (!(text = tmxTilesetsDocument(formats[f], count)))
+            {
+                fprintf(stderr, "tilesets: failed to write a map\n");
+                ok = 0;
+                break;
+            }
+            map = tmxParseMap(text, NULL, formats[f]);
+            free(text);
+            if (!map)
+            {
+                fprintf(stderr, "tilesets: failed to parse a map\n");
+                ok = 0;
+                break;
+            }
+
+            if ((errors = tmxTilesetsVerify(map, count)))
+            {
+                fprintf(stderr, "tilesets: %zu incorrect source rectangles in the %s map with %d tiles\n", errors,
+                        formats[f] == TMX_FORMAT_JSON ? "json" : "xml", count);
+                ok = 0;
+            }
+            else
+            {
+                tmxTilesetsMeasure(map, gids, opts, &tableSeconds, &tileSeconds, &iterations);
+                printf("{\"bench\":\"tilesets\",\"format\":\"%s\",\"tiles\":%d,\"samples\":%d,\"iterations\":%zu,\"table_ns\":%.3f,"
+                       "\"tiles_ns\":%.3f}\n",
+                       formats[f] == TMX_FORMAT_JSON ? "json" : "xml", count + count / 2, TMX_TILESETS_SAMPLES, iterations,
+                       tableSeconds * 1e9 / (double) (iterations * TMX_TILESETS_SAMPLES),
+                       tileSeconds * 1e9 / (double) (iterations * TMX_TILESETS_SAMPLES));
+            }
+            tmxFreeMap(map);
+        }
+    }
+
+    free(gids);
+    return ok ? 0 : 1;
+}
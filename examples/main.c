@@ -1,12 +1,19 @@
-#include "TMX/tmx.h"
+#include "tmx.h"
 #include <stdio.h>
 
 int main(int argc, const char *argv[])
 {
+    if (argc < 2)
+    {
+        fprintf(stderr, "usage: %s MAP\n", argv[0]);
+        return 1;
+    }
 
-    TMXmap map;
-    map.name = "Hello world!";
+    TMXmap *map = tmxLoadMap(argv[1], NULL, TMX_FORMAT_AUTO);
+    if (!map)
+        return 1;
 
-    printf("%s\n", map.name);
+    printf("%s: %dx%d, %zu layers, %zu tilesets\n", argv[1], map->size.w, map->size.h, map->layer_count, map->tileset_count);
+    tmxFreeMap(map);
     return 0;
-}
\ No newline at end of file
+}
@@ -18,6 +18,8 @@
  */
 #define TMX_GID_CLEAN(gid) ((gid) & TMX_GID_TILE_MASK)
 
+#define TMX_SPARSE_CHUNK_SIZE 16 /** The width and height of the chunks of layers stored sparsely, see @ref tmxSparseLayers. */
+
 #define TMX_FALSE 0 /** Boolean false value. */
 #define TMX_TRUE  1 /** Boolean true value. */
 
@@ -158,7 +160,7 @@ typedef enum
 {
     TMX_LAYER_NONE     = 0, /** An invalid/undefined type. */
     TMX_LAYER_TILE     = 1, /** A tile layer with tile data. */
-    TMX_LAYER_CHUNK    = 2, /** A tile layer for an infinite map and chunked tile data. */
+    TMX_LAYER_CHUNK    = 2, /** A tile layer for an infinite map or a sparse layer, with chunked tile data. */
     TMX_LAYER_OBJGROUP = 3, /** A layer with a collection of map objects. */
     TMX_LAYER_IMAGE    = 4, /** A layer with a single image. */
     TMX_LAYER_GROUP    = 5, /** A container of child layers. Its offset, tint, opacity, and visibility recursively affect child layers.*/
@@ -423,6 +425,7 @@ typedef struct TMXchunk
     TMXrect bounds; /** A rectangle describing the position/size of the chunk. */
     size_t count;   /** The number of global tile IDs in the `gids` array. */
     TMXgid *gids;   /** An array of global tile IDs. */
+    uint64_t *mask; /** One bit for each GID, set when it is not empty, as bit `i % 64` of word `i / 64`. Only built for sparse layers. */
 } TMXchunk;
 
 /**
@@ -477,6 +480,45 @@ typedef struct TMXobject
     TMXuserptr user;           /** User-defined value that can be attached to this object. Will never be modified by this library. */
 } TMXobject;
 
+/**
+ * @brief A struct-of-arrays copy of the commonly queried fields of the objects in an object layer.
+ *
+ * @details Each array has `count` elements, with the same order as the objects of the layer, and begins on a 16-byte
+ * boundary, so that positions and bounds can be processed in bulk (i.e. for culling or a collision broad-phase) without
+ * touching the objects themselves. The view is a snapshot, and is not updated when objects are modified.
+ */
+typedef struct TMXobjectview
+{
+    size_t count;          /** The number of objects, and the length of each array. */
+    int *id;               /** The unique IDs of the objects. */
+    float *x;              /** The coordinates of the objects on the x-axis, in pixel units. */
+    float *y;              /** The coordinates of the objects on the y-axis, in pixel units. */
+    float *width;          /** The widths of the objects, in pixel units. */
+    float *height;         /** The heights of the objects, in pixel units. */
+    float *rotation;       /** The rotations of the objects, in degrees clockwise around their position. */
+    TMXgid *gid;           /** The tile references of the objects, or 0 when not defined. */
+    TMX_OBJECT_TYPE *type; /** The types of the objects. */
+    TMX_BOOL *visible;     /** Indicates whether each object is shown or hidden. */
+} TMXobjectview;
+
+#define TMX_OCCUPANCY_LEVELS 3 /** The number of levels of an occupancy pyramid, see @ref TMXoccupancy. */
+#define TMX_OCCUPANCY_SHIFT  3 /** Each level of an occupancy pyramid has blocks 8 times the width and height of the one below. */
+
+/**
+ * @brief A pyramid of bitmaps of the blocks of a tile layer that contain at least one tile.
+ *
+ * @details Level `n` divides the layer into blocks of `1 << (TMX_OCCUPANCY_SHIFT * (n + 1))` cells along each axis, i.e.
+ * 8x8, 64x64 and 512x512, and a block is only set when one of its blocks in the level below is set. Iterating a layer can
+ * then jump over an empty 512x512 area with a single test. The pyramid is kept up to date by @ref tmxLayerSetGid, and by
+ * @ref tmxLayerUpdateOccupancy after writing the tiles of the layer directly.
+ */
+typedef struct TMXoccupancy
+{
+    TMXsize size[TMX_OCCUPANCY_LEVELS];   /** The number of columns and rows of blocks at each level. */
+    size_t stride[TMX_OCCUPANCY_LEVELS];  /** The number of 64-bit words for each row of blocks at each level. */
+    uint64_t *bits[TMX_OCCUPANCY_LEVELS]; /** The bitmap of each level, block `(x, y)` being bit `x % 64` of word `y * stride + x / 64`. */
+} TMXoccupancy;
+
 /**
  * @brief Describes a layer within a map.
  */
@@ -512,6 +554,8 @@ typedef struct TMXlayer
     draw_order; /** Indicates the order in which objects should be drawn. Applicable when the layer type is TMX_LAYER_OBJGROUP. */
     TMXproperties *properties; /** Named property hash/dictionary containing arbitrary values. */
     TMXuserptr user;           /** User-defined value that can be attached to this object. Will never be modified by this library. */
+    TMXobjectview *view;       /** Struct-of-arrays view of the objects when enabled with @ref tmxObjectViews, otherwise NULL. */
+    TMXoccupancy *occupancy;   /** Occupancy pyramid of a tile layer when enabled with @ref tmxOccupancyPyramids, otherwise NULL. */
 } TMXlayer;
 
 /**
@@ -556,6 +600,28 @@ typedef struct TMXtile
     TMXuserptr user;           /** User-defined value that can be attached to this object. Will never be modified by this library. */
 } TMXtile;
 
+/**
+ * @brief A struct-of-arrays table of the source rectangle of each tile within its image, indexed by local tile ID.
+ *
+ * @details Rectangles are in pixel units, and include the `margin` and `spacing` of the tileset. Texture coordinates
+ * are normalized to the size of the image containing the tile, with @a u0/@a v0 at the top-left corner and @a u1/@a v1
+ * at the bottom-right. Each array has `count` elements and begins on a 16-byte boundary. In image collections, IDs that
+ * have no tile have an empty rectangle and a NULL image.
+ */
+typedef struct TMXtilerects
+{
+    size_t count;            /** The number of local tile IDs, and the length of each array. */
+    int *x;                  /** The position of each rectangle on the x-axis, in pixel units. */
+    int *y;                  /** The position of each rectangle on the y-axis, in pixel units. */
+    int *width;              /** The width of each rectangle, in pixel units. */
+    int *height;             /** The height of each rectangle, in pixel units. */
+    float *u0;               /** The normalized left edge of each rectangle. */
+    float *v0;               /** The normalized top edge of each rectangle. */
+    float *u1;               /** The normalized right edge of each rectangle. */
+    float *v1;               /** The normalized bottom edge of each rectangle. */
+    const TMXimage **images; /** The image containing each tile: the image of the tileset, or of the tile itself in a collection. */
+} TMXtilerects;
+
 /**
  * @brief
  *
@@ -593,6 +659,7 @@ typedef struct TMXtileset
     } grid;
     TMXproperties *properties;
     TMXuserptr user;
+    TMXtilerects *rects; /** The source rectangle of each tile, indexed by local ID. */
 } TMXtileset;
 
 typedef struct TMXmaptileset
@@ -629,6 +696,30 @@ typedef struct TMXmap
     TMXuserptr user;              /** User-defined value that can be attached to this object. Will never be modified by this library. */
 } TMXmap;
 
+/**
+ * @brief A leaf layer of a map with the attributes it inherits from its ancestor groups applied.
+ */
+typedef struct TMXflatlayer
+{
+    const TMXlayer *layer;  /** The tile, object, or image layer. */
+    const TMXlayer *parent; /** The group layer that directly contains the layer, or NULL for top-level layers. */
+    float opacity;          /** The opacity of the layer multiplied by the opacity of each ancestor. */
+    TMX_BOOL visible;       /** Indicates if the layer and each of its ancestors are visible. */
+    TMXpoint offset;        /** The offset of the layer plus the offset of each ancestor, in pixel units. */
+    TMXcolorf tint;         /** The tint color of the layer multiplied by the tint of each ancestor, white when none is defined. */
+    TMXvec2 parallax;       /** The parallax factor of the layer multiplied by the parallax factor of each ancestor. */
+} TMXflatlayer;
+
+/**
+ * @brief A contiguous list of the leaf layers of a map in draw order, created with @ref tmxMapFlattenLayers.
+ */
+typedef struct TMXflatlayers
+{
+    size_t count;                 /** The number of layers in the `layers` array. */
+    TMXflatlayer *layers;         /** The leaf layers, ordered from the bottom-most to the top-most layer. */
+    struct TMXflatgroups *groups; /** The group hierarchy, used internally for incremental updates. */
+} TMXflatlayers;
+
 struct TMXtemplate
 {
     TMX_FLAG flags;      /** Meta-data flags that can provide additional information about the template. */
@@ -645,8 +736,8 @@ struct TMXtemplate
  * @param[in] map The parent map.
  * @param[in] layer The parent tile layer within the @a map.
  * @param[in] tile The tile to be rendered, or can be @c NULL if specified to yield empty tiles.
- * @param[in] x The location the tile should be rendered on the x-axis, in tile units.
- * @param[in] y The location the tile should be rendered on the y-axis, in tile units.
+ * @param[in] x The column of the cell within the layer, in tile units, regardless of the render order.
+ * @param[in] y The row of the cell within the layer, in tile units, regardless of the render order.
  * @param[in] gid The raw global tile ID, with flip/rotate flags present if set.
  *
  * @return @ref TMX_TRUE to continue iteration, otherwise @ref TMX_FALSE to stop.
@@ -747,8 +838,47 @@ TMXproperty *tmxGetPropertiesHead(const TMXproperties *properties);
  */
 TMX_PUBLIC void tmxImageCallback(TMXimageloadfunc load, TMXimagefreefunc free, TMXuserptr user);
 
+/**
+ * @brief Invokes a callback for each cell of a tile layer, in the render order of the map.
+ *
+ * @details The render order only determines the order of the calls: rows are visited upwards or downwards, and the cells
+ * of each row to the left or right. The coordinates passed to the callback are always the column and row of the cell
+ * within the layer, the same for finite and chunk layers in every render order.
+ *
+ * Only the cells of the chunks of a chunk layer are visited, and the empty cells of chunks with a mask are skipped
+ * without reading their GIDs unless @a includeEmpty is set.
+ *
+ * @param[in] map The map containing the layer.
+ * @param[in] layer A tile or chunk layer.
+ * @param[in] includeEmpty @c TMX_TRUE to also yield empty cells, otherwise @c TMX_FALSE.
+ * @param[in] foreachFunc The callback to invoke.
+ */
 TMX_PUBLIC void tmxTileForeach(TMXmap *map, TMXlayer *layer, TMX_BOOL includeEmpty, TMXforeachfunc foreachFunc);
 
+/**
+ * @brief Retrieves the GID of a single cell of a tile or chunk layer.
+ *
+ * @param[in] layer A tile or chunk layer.
+ * @param[in] x The column of the cell, in tile units.
+ * @param[in] y The row of the cell, in tile units.
+ * @return The GID of the cell with its flip flags, or 0 if the cell is empty or outside of the layer and its chunks.
+ */
+TMX_PUBLIC TMXgid tmxLayerGid(const TMXlayer *layer, int x, int y);
+
+/**
+ * @brief Sets the occupancy at or below which the tile layers of subsequently loaded finite maps are stored as chunks,
+ * which keeps only the blocks of the layer that contain a tile. Sparse storage is disabled by default.
+ *
+ * @details A layer is divided into blocks of @ref TMX_SPARSE_CHUNK_SIZE cells, and its occupancy is the fraction of the
+ * blocks with at least one tile. Layers at or below the threshold become @ref TMX_LAYER_CHUNK layers with a chunk for each
+ * occupied block, clipped to the size of the layer, while the size of the layer is unchanged. When enabled, the chunks of
+ * infinite maps without any tiles are also removed. Every chunk of a sparse layer has a mask of its non-empty cells.
+ *
+ * @param[in] threshold The largest fraction of occupied blocks of a sparse layer, from 0.0 to 1.0, or a negative value to
+ * disable sparse storage.
+ */
+TMX_PUBLIC void tmxSparseLayers(float threshold);
+
 /**
  * @brief Frees a previously created map and all of its child objects.
  *
@@ -757,6 +887,136 @@ TMX_PUBLIC void tmxTileForeach(TMXmap *map, TMXlayer *layer, TMX_BOOL includeEmp
  */
 TMX_PUBLIC void tmxFreeMap(TMXmap *map);
 
+/**
+ * @brief Enables or disables building an object view for each object layer of subsequently loaded maps. Views are
+ * disabled by default.
+ *
+ * @param[in] enabled @c TMX_TRUE to build a @ref TMXobjectview for each object layer when a map is loaded, otherwise
+ * @c TMX_FALSE.
+ */
+TMX_PUBLIC void tmxObjectViews(TMX_BOOL enabled);
+
+/**
+ * @brief Builds or rebuilds the object view of an object layer, i.e. after objects have been modified, or when views
+ * were not enabled while the map was loaded.
+ *
+ * @param[in] layer An object layer.
+ * @return The view, which is owned by the @a layer, or @c NULL if the layer is not an object layer or memory could not
+ * be allocated.
+ */
+TMX_PUBLIC const TMXobjectview *tmxLayerObjectView(TMXlayer *layer);
+
+/**
+ * @brief Enables or disables building an occupancy pyramid for each finite tile layer of subsequently loaded maps.
+ * Pyramids are disabled by default.
+ *
+ * @details Iterating a layer with @ref tmxTileForeach, culling, baking quads and colliders, and scanning for animated
+ * tiles all skip the empty blocks of a layer with a pyramid. Chunk layers skip missing chunks and the empty cells of their
+ * masks instead.
+ *
+ * @param[in] enabled @c TMX_TRUE to build a @ref TMXoccupancy for each tile layer when a map is loaded, otherwise
+ * @c TMX_FALSE.
+ */
+TMX_PUBLIC void tmxOccupancyPyramids(TMX_BOOL enabled);
+
+/**
+ * @brief Builds or rebuilds the occupancy pyramid of a tile layer, i.e. when pyramids were not enabled while the map was
+ * loaded.
+ *
+ * @param[in] layer A finite tile layer.
+ * @return The pyramid, which is owned by the @a layer, or @c NULL if the layer is not a finite tile layer or memory could
+ * not be allocated.
+ */
+TMX_PUBLIC const TMXoccupancy *tmxLayerOccupancy(TMXlayer *layer);
+
+/**
+ * @brief Refreshes the occupancy pyramid of a tile layer, or the masks of the chunks of a chunk layer, after the tiles
+ * within a region were written directly.
+ *
+ * @param[in] layer A tile or chunk layer.
+ * @param[in] region The cells that were written, in tile units.
+ */
+TMX_PUBLIC void tmxLayerUpdateOccupancy(TMXlayer *layer, TMXrect region);
+
+/**
+ * @brief Writes the GID of a single cell of a tile or chunk layer, keeping its occupancy pyramid and chunk masks current.
+ *
+ * @param[in] layer A tile or chunk layer.
+ * @param[in] x The column of the cell, in tile units.
+ * @param[in] y The row of the cell, in tile units.
+ * @param[in] gid The GID to write, with its flip flags.
+ * @return @c TMX_TRUE on success, otherwise @c TMX_FALSE if the cell is outside of the layer or of every chunk.
+ */
+TMX_PUBLIC TMX_BOOL tmxLayerSetGid(TMXlayer *layer, int x, int y, TMXgid gid);
+
+/**
+ * @brief Tests whether a region of a tile or chunk layer has no tiles, testing only the cells of the blocks its occupancy
+ * pyramid or chunk masks do not rule out.
+ *
+ * @param[in] layer A tile or chunk layer.
+ * @param[in] region The cells to test, in tile units.
+ * @return @c TMX_TRUE if every cell of the region is empty or outside of the layer, otherwise @c TMX_FALSE.
+ */
+TMX_PUBLIC TMX_BOOL tmxLayerRegionEmpty(const TMXlayer *layer, TMXrect region);
+
+/**
+ * @brief Rebuilds the table of source rectangles of a tileset, i.e. after its tiles, image, margin, or spacing have been
+ * modified. The table is built automatically when a tileset is loaded.
+ *
+ * @param[in] tileset The tileset to process.
+ * @return The table, which is owned by the @a tileset, or @c NULL if memory could not be allocated.
+ */
+TMX_PUBLIC const TMXtilerects *tmxTilesetRects(TMXtileset *tileset);
+
+/**
+ * @brief Finds the tileset of a map that a global tile ID refers to.
+ *
+ * @param[in] map The map to search.
+ * @param[in] gid A global tile ID. Flip flags are ignored.
+ * @param[out] id Receives the local ID of the tile within the tileset, which indexes its @ref TMXtilerects. May be @c NULL.
+ * @return The tileset, or @c NULL when @a gid is empty or outside the range of every tileset.
+ */
+TMX_PUBLIC TMXtileset *tmxMapTileset(const TMXmap *map, TMXgid gid, TMXtid *id);
+
+/**
+ * @brief Computes the number of bytes retained by a map and all of its child objects.
+ *
+ * @param[in] map The map to measure.
+ * @return The combined size of the blocks that would be released by @ref tmxFreeMap, in bytes.
+ * @note Cached tilesets and templates are owned by the cache and not included, nor is memory returned by image callbacks.
+ */
+TMX_PUBLIC size_t tmxMapMemoryUsage(const TMXmap *map);
+
+/**
+ * @brief Creates a list of the tile, object, and image layers of a map in draw order, with the opacity, visibility,
+ * offset, tint, and parallax inherited from their groups resolved, so that they can be rendered without walking the
+ * layer hierarchy.
+ *
+ * @param[in] map The map to flatten.
+ * @return The flattened layers, which must be freed with @ref tmxFreeFlatLayers, or @c NULL on failure.
+ * @note The list refers to the layers of the @a map, and must not outlive it.
+ */
+TMX_PUBLIC TMXflatlayers *tmxMapFlattenLayers(const TMXmap *map);
+
+/**
+ * @brief Recomputes the effective attributes affected by a change to the attributes of a single layer.
+ *
+ * @details When @a layer is a group, only the layers it contains are updated, otherwise only the entry of the layer
+ * itself. Changes to the structure of the map, such as adding or removing layers, require the list to be recreated.
+ *
+ * @param[in] flat The flattened layers to update.
+ * @param[in] layer The layer that has changed, or @c NULL to update every layer.
+ * @return @c TMX_TRUE on success, otherwise @c TMX_FALSE if @a layer is not part of the list.
+ */
+TMX_PUBLIC TMX_BOOL tmxFlatLayersUpdate(TMXflatlayers *flat, const TMXlayer *layer);
+
+/**
+ * @brief Frees a list of flattened layers. The layers it refers to are not affected.
+ *
+ * @param[in] flat The list to free.
+ */
+TMX_PUBLIC void tmxFreeFlatLayers(TMXflatlayers *flat);
+
 /**
  * @brief Frees a previously created tileset.
  *
@@ -996,12 +1256,9 @@ TMX_PUBLIC TMXcolorf tmxColorF(TMXcolor color);
 #define tmxUserPtr(ptr) ((TMXuserptr){ptr})
 #define tmxNullUserPtr  tmxUserPtr(NULL)
 
-#ifndef TMX_DEBUG
-
 /**
  * @brief Prints allocation/deallocation details to the standard output.
  */
 void tmxMemoryLeakCheck(void);
-#endif
 
 #endif /* TMX_H */
\ No newline at end of file
@@ -0,0 +1,89 @@
+/**
+ * @file animation.h
+ * @brief Provides scheduling of the animated tiles of a layer, reporting only the cells whose displayed tile changes.
+ * @version 0.1
+ *
+ * @details An animator indexes the cells of a tile layer that contain an animated tile once, when it is created. Cells
+ * with the same tile share a single clock, and the clocks are kept in a queue ordered by when their next frame begins,
+ * so that advancing the time only visits the tiles whose frame changes. The cost of each update is proportional to the
+ * number of cells that change, rather than to the size of the layer.
+ *
+ * As in Tiled, every animation starts on its first frame at time 0, and loops indefinitely. The displayed GID of a cell
+ * keeps the flip flags of the GID in the layer. The layer itself is never modified: changes can be written to the layer
+ * data, or used to rebake the affected chunks (see @ref tmxBakeChunk).
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#ifndef TMX_ANIMATION_H
+#define TMX_ANIMATION_H
+
+#include "../tmx.h"
+
+/**
+ * @brief A cell containing an animated tile.
+ */
+typedef struct TMXanimcell
+{
+    TMXpoint position; /** The position of the cell within the layer, in tile units. */
+    TMXgid gid;        /** The GID of the tile currently displayed, including the flip flags of the cell. */
+    size_t chunk;      /** For infinite maps, the index of the chunk containing the cell, otherwise 0. */
+} TMXanimcell;
+
+/**
+ * @brief Opaque type that holds the animated cells of a layer and the state of their animations.
+ */
+typedef struct TMXanimator TMXanimator;
+
+/**
+ * @brief Creates an animator for the animated tiles of a tile layer, with every animation on its first frame.
+ *
+ * @param[in] map The map containing the layer.
+ * @param[in] layer A tile layer.
+ * @return The animator, which must be freed with @ref tmxFreeAnimator, or @c NULL on failure. The @a map must remain
+ * valid for its lifetime, and the animator must be recreated if the tiles of the @a layer are modified.
+ */
+TMXanimator *tmxAnimatorCreate(const TMXmap *map, const TMXlayer *layer);
+
+/**
+ * @brief Retrieves every animated cell of the layer with the tile it currently displays.
+ *
+ * @details The first frame of an animation is not necessarily the tile it is defined on, so this should be used to
+ * initialize the displayed tiles after creating or resetting the animator.
+ *
+ * @param[in] animator The animator to query.
+ * @param[out] cells A pointer to receive the array of cells, grouped by tile. The array belongs to the @a animator, and
+ * is updated in place as it advances.
+ * @return The number of cells in the array.
+ */
+size_t tmxAnimatorCells(const TMXanimator *animator, const TMXanimcell **cells);
+
+/**
+ * @brief Advances the time of every animation, and retrieves the cells whose displayed tile changed.
+ *
+ * @details Only the displayed tile after the full @a milliseconds have elapsed is reported, so a cell appears at most
+ * once in the result even when several frames elapsed. A cell whose animation returns to the same tile is not reported.
+ *
+ * @param[in] animator The animator to advance.
+ * @param[in] milliseconds The time elapsed since the previous update, in milliseconds. Negative values are ignored.
+ * @param[out] changes A pointer to receive an array of the cells that changed, grouped by tile. The array belongs to the
+ * @a animator, and remains valid until the next update.
+ * @return The number of cells in the array.
+ */
+size_t tmxAnimatorAdvance(TMXanimator *animator, double milliseconds, const TMXanimcell **changes);
+
+/**
+ * @brief Returns every animation to its first frame at time 0.
+ *
+ * @param[in] animator The animator to reset.
+ */
+void tmxAnimatorReset(TMXanimator *animator);
+
+/**
+ * @brief Frees an animator.
+ *
+ * @param[in] animator The animator to free.
+ */
+void tmxFreeAnimator(TMXanimator *animator);
+
+#endif /* TMX_ANIMATION_H */
@@ -0,0 +1,182 @@
+/**
+ * @file blocked.h
+ * @brief Provides a cache-blocked layout of the tiles of a layer, for access patterns that move in two dimensions.
+ * @version 0.1
+ *
+ * @details Tile layers store their cells in row-major order, so cells that are vertically adjacent are a full row of the
+ * layer apart, and each step up or down a large layer touches another cache line and often another page. Queries of the
+ * neighborhood of a cell, pathfinding and flood fills, and the rendering of small areas all move in both directions.
+ *
+ * A blocked layout divides the cells into square blocks of 8 to 256 cells per side, stores the cells of each block
+ * contiguously, and the blocks in row-major order. Within a block, the cells are either in row-major order, or in Morton
+ * (Z-order), which interleaves the bits of the column and row so that every aligned square of 2x2, 4x4 or more cells is
+ * contiguous as well. Blocks along the right and bottom edges are padded with empty cells.
+ *
+ * Cells can be read and written individually, along with the 3x3 neighborhood of a cell, and spans of a row can be read
+ * directly from the storage, or converted to and from arrays of GIDs in row-major order.
+ *
+ * Reading does not modify the storage, so it can be shared between threads as long as no cells are written.
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#ifndef TMX_BLOCKED_H
+#define TMX_BLOCKED_H
+
+#include "../tmx.h"
+
+/**
+ * @brief The smallest width and height of a block in cells.
+ */
+#define TMX_BLOCKED_MIN_BLOCK 8
+
+/**
+ * @brief The largest width and height of a block in cells.
+ */
+#define TMX_BLOCKED_MAX_BLOCK 256
+
+/**
+ * @brief Describes the order of the cells within each block.
+ */
+typedef enum TMX_BLOCKED_ORDER
+{
+    TMX_BLOCKED_ROWS   = 0, /** Row-major order, so that each row of a block is contiguous. */
+    TMX_BLOCKED_MORTON = 1  /** Morton order, so that each aligned square of cells within a block is contiguous. */
+} TMX_BLOCKED_ORDER;
+
+/**
+ * @brief Opaque type for the blocked layout of a layer.
+ */
+typedef struct TMXblocked TMXblocked;
+
+/**
+ * @brief Creates a blocked layout from the tiles of a layer.
+ *
+ * @param[in] layer A tile layer, finite or infinite. The layout covers all of the chunks of an infinite layer, and cells
+ * outside of every chunk are empty.
+ * @param[in] size The width and height of each block in cells, a power of two from @ref TMX_BLOCKED_MIN_BLOCK to
+ * @ref TMX_BLOCKED_MAX_BLOCK. Blocks of 32 or 64 cells keep the rows of a block within a few cache lines.
+ * @param[in] order The order of the cells within each block.
+ * @return The layout, which must be freed with @ref tmxFreeBlocked, or @c NULL on failure.
+ */
+TMXblocked *tmxBlockedCreate(const TMXlayer *layer, int size, TMX_BLOCKED_ORDER order);
+
+/**
+ * @brief Creates a blocked layout from an array of GIDs.
+ *
+ * @param[in] gids An array of `region.w * region.h` GIDs in row-major order, which is copied.
+ * @param[in] region The cells of the array, in tile units.
+ * @param[in] size The width and height of each block in cells, as with @ref tmxBlockedCreate.
+ * @param[in] order The order of the cells within each block.
+ * @return The layout, which must be freed with @ref tmxFreeBlocked, or @c NULL on failure.
+ */
+TMXblocked *tmxBlockedCreateGrid(const TMXgid *gids, TMXrect region, int size, TMX_BLOCKED_ORDER order);
+
+/**
+ * @brief Retrieves the cells of a blocked layout.
+ *
+ * @param[in] blocked The layout to query.
+ * @return The cells, in tile units.
+ */
+TMXrect tmxBlockedRegion(const TMXblocked *blocked);
+
+/**
+ * @brief Retrieves the GID of a single cell.
+ *
+ * @param[in] blocked The layout to read.
+ * @param[in] x The column of the cell, in tile units.
+ * @param[in] y The row of the cell, in tile units.
+ * @return The GID of the cell with its flip flags, or 0 if the cell is outside of the layout.
+ */
+TMXgid tmxBlockedGet(const TMXblocked *blocked, int x, int y);
+
+/**
+ * @brief Retrieves the GIDs of a cell and the eight cells surrounding it.
+ *
+ * @details When the neighborhood is within a single block, which is the case for all but the cells along the edges of a
+ * block, the cells are read at fixed offsets from the center without locating each of them.
+ *
+ * @param[in] blocked The layout to read.
+ * @param[in] x The column of the center cell, in tile units.
+ * @param[in] y The row of the center cell, in tile units.
+ * @param[out] output An array of 9 elements to receive the GIDs of the cells in row-major order, from the cell above and
+ * left of the center to the cell below and right of it. Cells outside of the layout are empty.
+ */
+void tmxBlockedNeighborhood(const TMXblocked *blocked, int x, int y, TMXgid output[9]);
+
+/**
+ * @brief Retrieves the cells stored contiguously along a row, beginning at a cell, without copying them.
+ *
+ * @details A row can be read in place by advancing the column by the returned count until the end of the row. With
+ * @ref TMX_BLOCKED_ROWS the span extends to the end of the row of the block, while with @ref TMX_BLOCKED_MORTON only pairs
+ * of cells are contiguous along a row, and @ref tmxBlockedDecode is faster for long spans.
+ *
+ * @param[in] blocked The layout to read.
+ * @param[in] x The column of the first cell, in tile units.
+ * @param[in] y The row of the cells, in tile units.
+ * @param[out] count The number of cells of the span, which do not extend past the right edge of the layout, or 0 if the
+ * cell is outside of the layout.
+ * @return The GIDs of the cells of the span, or @c NULL if the cell is outside of the layout. The pointer is valid until
+ * the layout is freed.
+ */
+const TMXgid *tmxBlockedSpan(const TMXblocked *blocked, int x, int y, size_t *count);
+
+/**
+ * @brief Copies a span of cells along a row into an array of GIDs.
+ *
+ * @param[in] blocked The layout to read.
+ * @param[in] x The column of the first cell, in tile units.
+ * @param[in] y The row of the cells, in tile units.
+ * @param[in] count The number of cells to copy. Cells outside of the layout are empty.
+ * @param[out] output An array of @a count elements to receive the GID of each cell.
+ */
+void tmxBlockedDecode(const TMXblocked *blocked, int x, int y, size_t count, TMXgid *output);
+
+/**
+ * @brief Copies every cell of a blocked layout into an array of GIDs in row-major order, one block at a time.
+ *
+ * @param[in] blocked The layout to read.
+ * @param[out] output An array of `region.w * region.h` elements, with the region returned by @ref tmxBlockedRegion.
+ */
+void tmxBlockedToGrid(const TMXblocked *blocked, TMXgid *output);
+
+/**
+ * @brief Writes the GID of a single cell.
+ *
+ * @param[in] blocked The layout to write.
+ * @param[in] x The column of the cell, in tile units, within the layout.
+ * @param[in] y The row of the cell, in tile units, within the layout.
+ * @param[in] gid The GID to write, with its flip flags.
+ * @return @c TMX_TRUE on success, otherwise @c TMX_FALSE if the cell is outside of the layout.
+ */
+TMX_BOOL tmxBlockedSet(TMXblocked *blocked, int x, int y, TMXgid gid);
+
+/**
+ * @brief Writes a span of cells along a row from an array of GIDs.
+ *
+ * @param[in] blocked The layout to write.
+ * @param[in] x The column of the first cell, in tile units, within the layout.
+ * @param[in] y The row of the cells, in tile units, within the layout.
+ * @param[in] count The number of cells to write, which must all be within the layout.
+ * @param[in] gids An array of @a count elements with the GID of each cell.
+ * @return @c TMX_TRUE on success, otherwise @c TMX_FALSE if any of the cells are outside of the layout, in which case none
+ * are written.
+ */
+TMX_BOOL tmxBlockedEncode(TMXblocked *blocked, int x, int y, size_t count, const TMXgid *gids);
+
+/**
+ * @brief Retrieves the memory used by a blocked layout, including the padding of the blocks along the edges.
+ *
+ * @param[in] blocked The layout to query.
+ * @return The size of the layout and its cells, in bytes.
+ */
+size_t tmxBlockedMemory(const TMXblocked *blocked);
+
+/**
+ * @brief Frees a blocked layout.
+ *
+ * @param[in] blocked The layout to free.
+ */
+void tmxFreeBlocked(TMXblocked *blocked);
+
+#endif /* TMX_BLOCKED_H */
@@ -0,0 +1,104 @@
+/**
+ * @file colliders.h
+ * @brief Provides baking of the collision shapes of tiles into a compact list of colliders for a region of a layer.
+ * @version 0.1
+ *
+ * @details The collision objects of each tile (see @ref TMXtile.collision) are placed at its cell, following the
+ * orientation of the map and the tile offset, render size, and fill mode of its tileset, as with @ref tmxBakeRegion.
+ * Flip flags mirror the shapes within the tile, and the rotations of hexagonal maps rotate them around its center.
+ *
+ * Axis-aligned rectangles are then greedily merged: first into runs along each row, and then into columns of runs with
+ * the same extent. A layer of solid tiles becomes a handful of rectangles rather than one per cell. The outlines of the
+ * areas covered by the rectangles are also traced as closed polygons, with holes, for physics engines that prefer
+ * chains of edges. Ellipses, polygons, polylines, and rotated shapes are placed but not merged; rotated rectangles and
+ * ellipses become polygons. Points and text are ignored.
+ *
+ * Shapes are only merged within a single bake, so the chunks of an infinite layer (or regions of a finite one) can each
+ * be baked into their own list, and rebaked when modified. A list keeps its memory between bakes. All positions are in
+ * pixel units relative to the map, without the offset or parallax of the layer.
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#ifndef TMX_COLLIDERS_H
+#define TMX_COLLIDERS_H
+
+#include "../tmx.h"
+
+/**
+ * @brief A single collision shape.
+ */
+typedef struct TMXcollider
+{
+    TMX_OBJECT_TYPE type; /** Either @ref TMX_OBJECT_RECT, @ref TMX_OBJECT_ELLIPSE, @ref TMX_OBJECT_POLYGON, or @ref TMX_OBJECT_POLYLINE. */
+    TMXvec2 position;     /** The top-left corner of the shape's bounding rectangle, in pixel units. */
+    TMXvec2 size;         /** The size of the shape's bounding rectangle, in pixel units. */
+    size_t first;         /** For polygons and polylines, the index of the first point in the `points` array. */
+    size_t count;         /** For polygons and polylines, the number of points. Otherwise 0. */
+} TMXcollider;
+
+/**
+ * @brief The closed outline of an area covered by rectangles, or of a hole within one.
+ */
+typedef struct TMXoutline
+{
+    size_t first;  /** The index of the first point in the `points` array. */
+    size_t count;  /** The number of points, each a corner of the outline. The last point connects to the first. */
+    TMX_BOOL hole; /** Indicates the outline is a hole. Outer outlines are clockwise (with the y-axis pointing down), and holes counter-clockwise. */
+} TMXoutline;
+
+/**
+ * @brief The colliders of a baked chunk or region.
+ */
+typedef struct TMXcolliders
+{
+    size_t count;            /** The number of elements in the `colliders` array. */
+    TMXcollider *colliders;  /** The merged rectangles, followed by the remaining shapes. */
+    size_t outline_count;    /** The number of elements in the `outlines` array. */
+    TMXoutline *outlines;    /** The outlines of the areas covered by the merged rectangles, and of their holes. */
+    size_t point_count;      /** The number of elements in the `points` array. */
+    TMXvec2 *points;         /** The points of the polygons, polylines, and outlines. */
+    size_t capacity;         /** The number of colliders that can be stored without reallocating. */
+    size_t outline_capacity; /** The number of outlines that can be stored without reallocating. */
+    size_t point_capacity;   /** The number of points that can be stored without reallocating. */
+} TMXcolliders;
+
+/**
+ * @brief Creates an empty collider list.
+ *
+ * @return The list, which must be freed with @ref tmxFreeColliders, or @c NULL if memory could not be allocated.
+ */
+TMXcolliders *tmxCollidersCreate(void);
+
+/**
+ * @brief Bakes the collision shapes of the cells of a tile layer within a rectangle, replacing the previous contents
+ * of a collider list.
+ *
+ * @param[in] map The map containing the layer.
+ * @param[in] layer A tile layer.
+ * @param[in] region The cells to bake, in tile units. Cells outside of the layer are ignored.
+ * @param[in,out] colliders The list to receive the colliders.
+ * @return @c TMX_TRUE on success, otherwise @c TMX_FALSE.
+ */
+TMX_BOOL tmxBakeCollidersRegion(const TMXmap *map, const TMXlayer *layer, TMXrect region, TMXcolliders *colliders);
+
+/**
+ * @brief Bakes the collision shapes of a single chunk of an infinite tile layer, replacing the previous contents of a
+ * collider list.
+ *
+ * @param[in] map The map containing the layer.
+ * @param[in] layer A tile layer of an infinite map.
+ * @param[in] index The index of the chunk within the layer.
+ * @param[in,out] colliders The list to receive the colliders.
+ * @return @c TMX_TRUE on success, otherwise @c TMX_FALSE.
+ */
+TMX_BOOL tmxBakeCollidersChunk(const TMXmap *map, const TMXlayer *layer, size_t index, TMXcolliders *colliders);
+
+/**
+ * @brief Frees a collider list.
+ *
+ * @param[in] colliders The list to free.
+ */
+void tmxFreeColliders(TMXcolliders *colliders);
+
+#endif /* TMX_COLLIDERS_H */
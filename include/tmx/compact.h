@@ -0,0 +1,130 @@
+/**
+ * @file compact.h
+ * @brief Provides compact storage of the tiles of a layer, with a palette of distinct GIDs and narrow indices into it.
+ * @version 0.1
+ *
+ * @details Tile layers store a 32-bit GID for every cell, although most layers only use a few distinct tiles. Compact
+ * storage divides the cells into square blocks, and stores the distinct GIDs of each block (including their flip flags)
+ * in a palette, along with the index of each cell into the palette packed into as few bits as the palette requires, from
+ * 1 to 16 bits. A block of a single GID, such as an empty area, stores no indices at all. Blocks may also be as large as
+ * the layer, for a single palette shared by every cell.
+ *
+ * Reading a cell is a constant-time lookup of its block, its index, and the GID in the palette, and rows of cells can be
+ * decoded into arrays of GIDs one span at a time. Cells can also be written, which adds GIDs to the palette of the block
+ * as needed, and widens its indices when the palette no longer fits. Palettes keep GIDs that are no longer used until the
+ * palette is full, and are then compacted before the indices are widened.
+ *
+ * Reading does not modify the storage, so it can be shared between threads as long as no cells are written.
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#ifndef TMX_COMPACT_H
+#define TMX_COMPACT_H
+
+#include "../tmx.h"
+
+/**
+ * @brief The largest width and height of a block in cells, so that each palette fits 16-bit indices.
+ */
+#define TMX_COMPACT_MAX_BLOCK 256
+
+/**
+ * @brief Opaque type for the compact storage of a layer.
+ */
+typedef struct TMXcompact TMXcompact;
+
+/**
+ * @brief Creates compact storage from the tiles of a layer.
+ *
+ * @param[in] layer A tile layer, finite or infinite. The storage covers all of the chunks of an infinite layer, and cells
+ * outside of every chunk are empty.
+ * @param[in] size The width and height of each block in cells, a power of two from 4 to @ref TMX_COMPACT_MAX_BLOCK, or 0
+ * for a single block with one palette for the entire layer, which fails if the layer has more than 65536 distinct GIDs.
+ * @return The storage, which must be freed with @ref tmxFreeCompact, or @c NULL on failure.
+ */
+TMXcompact *tmxCompactCreate(const TMXlayer *layer, int size);
+
+/**
+ * @brief Creates compact storage from an array of GIDs.
+ *
+ * @param[in] gids An array of `region.w * region.h` GIDs in row-major order, which is copied.
+ * @param[in] region The cells of the array, in tile units.
+ * @param[in] size The width and height of each block in cells, as with @ref tmxCompactCreate.
+ * @return The storage, which must be freed with @ref tmxFreeCompact, or @c NULL on failure.
+ */
+TMXcompact *tmxCompactCreateGrid(const TMXgid *gids, TMXrect region, int size);
+
+/**
+ * @brief Retrieves the cells of compact storage.
+ *
+ * @param[in] compact The storage to query.
+ * @return The cells, in tile units.
+ */
+TMXrect tmxCompactRegion(const TMXcompact *compact);
+
+/**
+ * @brief Retrieves the GID of a single cell.
+ *
+ * @param[in] compact The storage to read.
+ * @param[in] x The column of the cell, in tile units.
+ * @param[in] y The row of the cell, in tile units.
+ * @return The GID of the cell with its flip flags, or 0 if the cell is outside of the storage.
+ */
+TMXgid tmxCompactGet(const TMXcompact *compact, int x, int y);
+
+/**
+ * @brief Decodes a span of cells along a row into an array of GIDs.
+ *
+ * @param[in] compact The storage to read.
+ * @param[in] x The column of the first cell, in tile units.
+ * @param[in] y The row of the cells, in tile units.
+ * @param[in] count The number of cells to decode. Cells outside of the storage are empty.
+ * @param[out] output An array of @a count elements to receive the GID of each cell.
+ */
+void tmxCompactDecode(const TMXcompact *compact, int x, int y, size_t count, TMXgid *output);
+
+/**
+ * @brief Writes the GID of a single cell.
+ *
+ * @details Finding the GID in the palette of the block takes time proportional to the size of the palette, and adding a
+ * GID to a full palette takes time proportional to the number of cells of the block.
+ *
+ * @param[in] compact The storage to write.
+ * @param[in] x The column of the cell, in tile units, within the storage.
+ * @param[in] y The row of the cell, in tile units, within the storage.
+ * @param[in] gid The GID to write, with its flip flags.
+ * @return @c TMX_TRUE on success, otherwise @c TMX_FALSE if the cell is outside of the storage, memory could not be
+ * allocated, or the palette of a single block would exceed 65536 distinct GIDs.
+ */
+TMX_BOOL tmxCompactSet(TMXcompact *compact, int x, int y, TMXgid gid);
+
+/**
+ * @brief Writes a span of cells along a row from an array of GIDs.
+ *
+ * @param[in] compact The storage to write.
+ * @param[in] x The column of the first cell, in tile units, within the storage.
+ * @param[in] y The row of the cells, in tile units, within the storage.
+ * @param[in] count The number of cells to write, which must all be within the storage.
+ * @param[in] gids An array of @a count elements with the GID of each cell.
+ * @return @c TMX_TRUE on success, otherwise @c TMX_FALSE as with @ref tmxCompactSet. Cells before the one that failed are
+ * written.
+ */
+TMX_BOOL tmxCompactEncode(TMXcompact *compact, int x, int y, size_t count, const TMXgid *gids);
+
+/**
+ * @brief Retrieves the memory used by compact storage, for comparison with the 4 bytes per cell of a tile layer.
+ *
+ * @param[in] compact The storage to query.
+ * @return The size of the storage, its blocks, palettes and indices, in bytes.
+ */
+size_t tmxCompactMemory(const TMXcompact *compact);
+
+/**
+ * @brief Frees compact storage.
+ *
+ * @param[in] compact The storage to free.
+ */
+void tmxFreeCompact(TMXcompact *compact);
+
+#endif /* TMX_COMPACT_H */
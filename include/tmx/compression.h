@@ -73,6 +73,13 @@ size_t tmxInflateGzip(const void *input, size_t inputSize, void *output, size_t
  */
 size_t tmxInflateZlib(const void *input, size_t inputSize, void *output, size_t outputSize);
 
+/**
+ * @brief Retrieves the name of the DEFLATE implementation used by @ref tmxInflateGzip and @ref tmxInflateZlib.
+ *
+ * @return The backend name, either @c "builtin" or @c "miniz", as selected with the @c TMX_INFLATE_BACKEND CMake option.
+ */
+const char *tmxInflateBackend(void);
+
 /**
  * @brief Inflates a Zstd-compressed block of memory into an @a output buffer.
  *
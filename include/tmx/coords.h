@@ -0,0 +1,60 @@
+/**
+ * @file coords.h
+ * @brief Provides conversion between pixel and tile coordinates for each map orientation.
+ * @version 0.1
+ *
+ * @details Pixel coordinates are relative to the top-left corner of the map, as drawn by Tiled, without the offset of
+ * any layer applied. A pixel is converted to the cell whose shape (rectangle, diamond or hexagon) contains it, and a
+ * cell is converted to the pixel at the center of its shape, so that converting the result back yields the same cell.
+ *
+ * The batch functions produce results identical to their single-point counterparts, processing several points at a
+ * time with SIMD instructions where available (SSE2), and are intended for converting large numbers of points at once.
+ * Coordinates whose tile position does not fit within an @c int produce undefined results.
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#ifndef TMX_COORDS_H
+#define TMX_COORDS_H
+
+#include "../tmx.h"
+
+/**
+ * @brief Converts a position in pixel units to the cell of the map that contains it.
+ *
+ * @param[in] map The map that defines the layout of the grid.
+ * @param[in] pixel The position to convert, in pixel units.
+ * @return The position of the cell, in tile units. Positions outside the bounds of the map are not clamped.
+ */
+TMXpoint tmxPixelToTile(const TMXmap *map, TMXvec2 pixel);
+
+/**
+ * @brief Converts the position of a cell to the position of its center.
+ *
+ * @param[in] map The map that defines the layout of the grid.
+ * @param[in] tile The position of the cell, in tile units.
+ * @return The center of the cell, in pixel units.
+ */
+TMXvec2 tmxTileToPixel(const TMXmap *map, TMXpoint tile);
+
+/**
+ * @brief Converts an array of positions in pixel units to the cells of the map that contain them.
+ *
+ * @param[in] map The map that defines the layout of the grid.
+ * @param[in] pixels An array of positions to convert, in pixel units.
+ * @param[out] tiles An array with room for @a count elements to receive the cells, in tile units.
+ * @param[in] count The number of elements in the @a pixels array.
+ */
+void tmxPixelsToTiles(const TMXmap *map, const TMXvec2 *pixels, TMXpoint *tiles, size_t count);
+
+/**
+ * @brief Converts an array of cell positions to the positions of their centers.
+ *
+ * @param[in] map The map that defines the layout of the grid.
+ * @param[in] tiles An array of cells to convert, in tile units.
+ * @param[out] pixels An array with room for @a count elements to receive the centers, in pixel units.
+ * @param[in] count The number of elements in the @a tiles array.
+ */
+void tmxTilesToPixels(const TMXmap *map, const TMXpoint *tiles, TMXvec2 *pixels, size_t count);
+
+#endif /* TMX_COORDS_H */
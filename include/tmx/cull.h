@@ -0,0 +1,88 @@
+/**
+ * @file cull.h
+ * @brief Provides queries for the tiles of each layer that are visible within a viewport.
+ * @version 0.1
+ *
+ * @details A culler is created once for a map and its flattened layers (see @ref tmxMapFlattenLayers), and then
+ * queried each frame with the viewport in pixel units. The effective offset and parallax factor of each layer are
+ * applied, so the result is in the tile coordinates of each layer. Orthogonal, isometric, staggered, and hexagonal
+ * orientations are supported, and the cost of a query depends on the size of the viewport rather than the map.
+ *
+ * Tiles are considered visible when their bounding rectangle on the grid intersects the viewport. Tiles from tilesets
+ * with a tile size larger than the map's extend above and to the right of their cell, which can be accounted for by
+ * enlarging the viewport by the difference in size. For maps staggered along the x-axis, the first and last rows that
+ * are visible may only be visible in every other column, and their spans include the columns in between.
+ *
+ * Tile layers with an occupancy pyramid (see @ref tmxOccupancyPyramids) omit the ends of spans within empty 8x8 blocks,
+ * and the spans and layers that are entirely empty. Layers of infinite maps are omitted when no chunk is visible.
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#ifndef TMX_CULL_H
+#define TMX_CULL_H
+
+#include "../tmx.h"
+
+/**
+ * @brief A horizontal run of visible tiles within a single row of a layer.
+ */
+typedef struct TMXtilespan
+{
+    int y;     /** The row of the tiles, in tile units. */
+    int first; /** The column of the first visible tile, in tile units. */
+    int last;  /** The column of the last visible tile (inclusive), in tile units. */
+} TMXtilespan;
+
+/**
+ * @brief Describes the visible portion of a single tile layer.
+ */
+typedef struct TMXvisiblelayer
+{
+    const TMXflatlayer *flat; /** The layer and its effective attributes. */
+    TMXvec2 offset;           /** The offset to draw the layer with, combining its effective offset and parallax scrolling. */
+    TMXrect bounds;           /** The rectangle containing every visible tile, in tile units. */
+    size_t span_count;        /** The number of spans in the `spans` array. */
+    const TMXtilespan *spans; /** The visible tiles as runs of columns, ordered by row. */
+    size_t chunk_count;       /** The number of indices in the `chunks` array. Always 0 for finite layers. */
+    const size_t *chunks;     /** For infinite layers, the indices of the chunks that intersect the viewport, ordered by row. */
+} TMXvisiblelayer;
+
+/**
+ * @brief Opaque type that holds the indices and buffers used to cull the layers of a map.
+ */
+typedef struct TMXculler TMXculler;
+
+/**
+ * @brief Creates a culler for the tile layers of a map.
+ *
+ * @param[in] map The map to cull.
+ * @param[in] layers The flattened layers of the @a map. Changes to the attributes of the layers are observed by each
+ * query, once applied with @ref tmxFlatLayersUpdate.
+ * @return The culler, which must be freed with @ref tmxFreeCuller, or @c NULL on failure. Both the @a map and @a layers
+ * must remain valid for its lifetime.
+ */
+TMXculler *tmxCullerCreate(const TMXmap *map, const TMXflatlayers *layers);
+
+/**
+ * @brief Computes the visible tiles of each visible tile layer.
+ *
+ * @param[in] culler The culler to query.
+ * @param[in] x The position of the top-left corner of the viewport on the x-axis, in pixel units.
+ * @param[in] y The position of the top-left corner of the viewport on the y-axis, in pixel units.
+ * @param[in] width The width of the viewport, in pixel units.
+ * @param[in] height The height of the viewport, in pixel units.
+ * @param[out] layers A pointer to receive an array of the layers with at least one visible tile, in draw order. The
+ * array belongs to the @a culler, and remains valid until the next query.
+ * @return The number of layers in the array.
+ */
+size_t tmxCull(TMXculler *culler, float x, float y, float width, float height, const TMXvisiblelayer **layers);
+
+/**
+ * @brief Frees a culler.
+ *
+ * @param[in] culler The culler to free.
+ */
+void tmxFreeCuller(TMXculler *culler);
+
+#endif /* TMX_CULL_H */
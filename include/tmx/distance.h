@@ -0,0 +1,121 @@
+/**
+ * @file distance.h
+ * @brief Provides distance fields over the cells of tile layers, such as the distance from each cell to the nearest wall.
+ * @version 0.1
+ *
+ * @details A distance field holds the distance from the center of each cell to the center of the nearest feature cell,
+ * in cells, where feature cells are those with a non-zero value in a grid of one byte per cell (see @ref tmxGridFill).
+ * Distances are exact for each metric, and computed in time linear in the number of cells.
+ *
+ * The transform is separable, and done in two phases. The first phase finds the distance to the nearest feature in the
+ * same column of each cell, sweeping down and up each column, and the second combines the columns along each row with
+ * the lower envelope of the distances of each cell in the row. Columns are independent of each other during the first
+ * phase, and rows during the second, so that each phase can be split between several threads.
+ *
+ * The Manhattan distance is the length of the shortest path to a feature moving between cells that share an edge, and
+ * the Chebyshev distance also allows moving between cells that share a corner, as found by a breadth-first search from
+ * every feature cell at once.
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#ifndef TMX_DISTANCE_H
+#define TMX_DISTANCE_H
+
+#include "grids.h"
+
+/**
+ * @brief Describes how the distance between two cells is measured.
+ */
+typedef enum TMX_DISTANCE_METRIC
+{
+    TMX_DISTANCE_EUCLIDEAN = 0, /** The straight-line distance between the centers of the cells. */
+    TMX_DISTANCE_MANHATTAN = 1, /** The sum of the horizontal and vertical distances between the cells. */
+    TMX_DISTANCE_CHEBYSHEV = 2  /** The largest of the horizontal and vertical distances between the cells. */
+} TMX_DISTANCE_METRIC;
+
+/**
+ * @brief Describes the type of each element of a distance field.
+ */
+typedef enum TMX_DISTANCE_FORMAT
+{
+    TMX_DISTANCE_FLOAT  = 0, /** A @c float for each cell, which is @c INFINITY when there are no feature cells. */
+    TMX_DISTANCE_UINT16 = 1  /** A @c uint16_t for each cell, rounded to the nearest integer and limited to @c UINT16_MAX. */
+} TMX_DISTANCE_FORMAT;
+
+/**
+ * @brief Opaque type for the workspace of a distance transform.
+ */
+typedef struct TMXdistance TMXdistance;
+
+/**
+ * @brief Creates a distance transform from the tiles of one or more layers.
+ *
+ * @param[in] layers The tile layers to combine. A cell is a feature when the value of its tile in any layer is non-zero.
+ * @param[in] count The number of elements in the @a layers array.
+ * @param[in] table The value of each tile, with an empty value of 0.
+ * @param[in] metric Describes how distances are measured.
+ * @return The transform, which must be freed with @ref tmxFreeDistance, or @c NULL on failure.
+ */
+TMXdistance *tmxDistanceCreate(const TMXlayer *const *layers, size_t count, const TMXtiletable *table, TMX_DISTANCE_METRIC metric);
+
+/**
+ * @brief Creates a distance transform over a grid of one byte per cell provided by the caller.
+ *
+ * @param[in] values An array of `region.w * region.h` bytes in row-major order, where any non-zero value is a feature.
+ * The array is not copied, and must remain valid for the life of the transform.
+ * @param[in] region The cells of the grid, in tile units, as passed to @ref tmxGridFill.
+ * @param[in] metric Describes how distances are measured.
+ * @return The transform, which must be freed with @ref tmxFreeDistance, or @c NULL on failure.
+ */
+TMXdistance *tmxDistanceCreateGrid(const uint8_t *values, TMXrect region, TMX_DISTANCE_METRIC metric);
+
+/**
+ * @brief Retrieves the cells of a distance transform.
+ *
+ * @param[in] distance The transform to query.
+ * @return The cells of the grid, in tile units. The distance field has an element for each, in row-major order.
+ */
+TMXrect tmxDistanceRegion(const TMXdistance *distance);
+
+/**
+ * @brief Computes the distance field of every cell.
+ *
+ * @param[in] distance The transform to compute.
+ * @param[in] format The type of each element of the field.
+ * @param[out] output An array with an element of @a format for each cell.
+ * @return @c TMX_TRUE on success, otherwise @c TMX_FALSE if memory could not be allocated.
+ */
+TMX_BOOL tmxDistanceTransform(TMXdistance *distance, TMX_DISTANCE_FORMAT format, void *output);
+
+/**
+ * @brief Performs the first phase of a transform for a range of columns. Different ranges may be computed at the same time.
+ *
+ * @param[in] distance The transform to compute.
+ * @param[in] first The index of the first column, relative to the first cell of the grid.
+ * @param[in] count The number of columns.
+ */
+void tmxDistanceColumns(TMXdistance *distance, int first, int count);
+
+/**
+ * @brief Performs the second phase of a transform for a range of rows, once the first phase is done for every column.
+ * Different ranges may be computed at the same time.
+ *
+ * @param[in] distance The transform to compute.
+ * @param[in] first The index of the first row, relative to the first cell of the grid.
+ * @param[in] count The number of rows.
+ * @param[in] format The type of each element of the field.
+ * @param[out] output An array with an element of @a format for each cell of the grid, of which only the elements of the
+ * rows in the range are written.
+ * @return @c TMX_TRUE on success, otherwise @c TMX_FALSE if memory could not be allocated.
+ */
+TMX_BOOL tmxDistanceRows(const TMXdistance *distance, int first, int count, TMX_DISTANCE_FORMAT format, void *output);
+
+/**
+ * @brief Frees a distance transform.
+ *
+ * @param[in] distance The transform to free.
+ */
+void tmxFreeDistance(TMXdistance *distance);
+
+#endif /* TMX_DISTANCE_H */
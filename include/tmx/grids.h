@@ -0,0 +1,102 @@
+/**
+ * @file grids.h
+ * @brief Provides extraction of per-cell values from tile layers, such as walkability or movement cost for pathfinding.
+ * @version 0.1
+ *
+ * @details Values are derived from the tiles of a map in two steps. First, a table is built by evaluating a function
+ * once for each tile of every tileset, typically by testing the class of the tile or one of its properties, and storing
+ * the result by GID. Cells are then filled from the table with a single lookup each, ignoring flip flags, into either
+ * one byte per cell or one bit per cell. The cost of filling a grid is independent of how the value of a tile is
+ * determined, and a table can be reused for every layer of the map.
+ *
+ * Grids are filled for a rectangular region of cells, so that the chunks of infinite layers (which may have negative
+ * coordinates) can be combined into a single grid. Several layers can be combined into one grid, such as the ground
+ * and the walls of a level.
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#ifndef TMX_GRIDS_H
+#define TMX_GRIDS_H
+
+#include "../tmx.h"
+
+/**
+ * @brief Prototype for a function that computes the value of a tile.
+ *
+ * @param[in] map The map containing the tileset.
+ * @param[in] tileset The tileset containing the tile.
+ * @param[in] tile The tile to evaluate.
+ * @param[in] user The user-defined value that was passed to @ref tmxTileTableCreate.
+ * @return The value of every cell containing the tile.
+ */
+typedef uint8_t (*TMXtilefunc)(const TMXmap *map, const TMXtileset *tileset, const TMXtile *tile, void *user);
+
+/**
+ * @brief The value of each tile of a map, indexed by GID.
+ */
+typedef struct TMXtiletable
+{
+    size_t count;    /** The number of GIDs in the table, one more than the largest GID of the map. */
+    uint8_t *values; /** The value of each GID. Has an additional element after the last, which is the value of empty cells. */
+} TMXtiletable;
+
+/**
+ * @brief Describes how the values of several layers are combined into a single cell.
+ */
+typedef enum TMX_GRID_COMBINE
+{
+    TMX_GRID_TOP = 0, /** The value of the last layer with a tile in the cell, as drawn on top, or the empty value otherwise. */
+    TMX_GRID_MIN = 1, /** The smallest value of every layer, including the empty value of layers without a tile in the cell. */
+    TMX_GRID_MAX = 2  /** The largest value of every layer, including the empty value of layers without a tile in the cell. */
+} TMX_GRID_COMBINE;
+
+/**
+ * @brief Creates a table of the value of every tile of a map.
+ *
+ * @param[in] map The map whose tilesets to evaluate.
+ * @param[in] func The function to invoke once for each tile, in order of GID.
+ * @param[in] user A user-defined value that is passed to the @a func.
+ * @param[in] empty The value of empty cells, and of GIDs without a tile (such as the gaps of an image collection).
+ * @return The table, which must be freed with @ref tmxFreeTileTable, or @c NULL on failure.
+ */
+TMXtiletable *tmxTileTableCreate(const TMXmap *map, TMXtilefunc func, void *user, uint8_t empty);
+
+/**
+ * @brief Fills a grid with one byte per cell from the tiles of one or more layers.
+ *
+ * @param[in] layers The tile layers to combine, in draw order.
+ * @param[in] count The number of elements in the @a layers array.
+ * @param[in] table The value of each tile.
+ * @param[in] region The cells to fill, in tile units. Cells outside of a layer or its chunks are empty.
+ * @param[in] combine Describes how the values of the layers are combined.
+ * @param[out] output An array of `region.w * region.h` bytes to receive the value of each cell, in row-major order.
+ * @return @c TMX_TRUE on success, otherwise @c TMX_FALSE.
+ */
+TMX_BOOL tmxGridFill(const TMXlayer *const *layers, size_t count, const TMXtiletable *table, TMXrect region, TMX_GRID_COMBINE combine,
+                     uint8_t *output);
+
+/**
+ * @brief Fills a grid with one bit per cell from the tiles of one or more layers, which is set when the combined value is
+ * non-zero.
+ *
+ * @param[in] layers The tile layers to combine, in draw order.
+ * @param[in] count The number of elements in the @a layers array.
+ * @param[in] table The value of each tile.
+ * @param[in] region The cells to fill, in tile units. Cells outside of a layer or its chunks are empty.
+ * @param[in] combine Describes how the values of the layers are combined.
+ * @param[out] output An array of `(region.w + 63) / 64 * region.h` words to receive the bits, in row-major order. Each row
+ * begins on a new word, and the bit of column @c x is `1 << (x % 64)` of word `x / 64`. Unused bits are cleared.
+ * @return @c TMX_TRUE on success, otherwise @c TMX_FALSE.
+ */
+TMX_BOOL tmxGridFillBits(const TMXlayer *const *layers, size_t count, const TMXtiletable *table, TMXrect region,
+                         TMX_GRID_COMBINE combine, uint64_t *output);
+
+/**
+ * @brief Frees a tile table.
+ *
+ * @param[in] table The table to free.
+ */
+void tmxFreeTileTable(TMXtiletable *table);
+
+#endif /* TMX_GRIDS_H */
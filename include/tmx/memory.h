@@ -19,6 +19,10 @@
  * memory with the use of only @c realloc is not considered portable, and typically associated with glib. 
  * 
  * You really want to at least provide @c TMX_REALLOC and @c TMX_FREE in most scenarios.
+ *
+ * Allocators can also be installed at runtime with @ref tmxMemoryAllocator, which takes precedence over the macros for
+ * any memory allocated while it is active. Each block remembers the allocator that created it, so different maps can be
+ * loaded with different allocators (i.e. a pool per zone) and still be freed with @ref tmxFreeMap as usual.
  * 
  * @copyright Copyright (c) 2023
  * 
@@ -28,6 +32,81 @@
 
 #include "common.h"
 
+/**
+ * @brief Describes what an allocation is used for, for the purpose of memory accounting.
+ */
+typedef enum TMX_MEMORY_CATEGORY
+{
+    TMX_MEMORY_GENERAL    = 0, /** Allocations not covered by another category, such as maps, layers, and images. */
+    TMX_MEMORY_TILES      = 1, /** Tile layer data and chunks. */
+    TMX_MEMORY_OBJECTS    = 2, /** Objects, their points and text, and templates. */
+    TMX_MEMORY_PROPERTIES = 3, /** Custom properties and their hash tables. */
+    TMX_MEMORY_STRINGS    = 4, /** Names, classes, paths, and other strings. */
+    TMX_MEMORY_TILESETS   = 5, /** Tilesets and their tiles, animations, and collision arrays. */
+    TMX_MEMORY_TEMPORARY  = 6, /** Buffers used only while parsing, such as file contents, XML/JSON state, and decoded data. */
+    TMX_MEMORY_CATEGORY_COUNT  /** The number of categories, not a valid value. */
+} TMX_MEMORY_CATEGORY;
+
+/**
+ * @brief A set of functions used to allocate memory at runtime.
+ *
+ * @details The sizes passed to the functions include a small header the library prefixes to each block, and the same
+ * size that was requested for a block is passed when it is freed, so sized and pool allocators do not need to store a
+ * header of their own. Blocks are expected to be aligned suitably for any type, as with @c malloc.
+ */
+typedef struct TMXallocator
+{
+    /**
+     * @brief Allocates a block of memory.
+     * @param[in] size The size of the block, in bytes.
+     * @param[in] user The user-defined value of the allocator.
+     * @return A pointer to the block, or @c NULL if the request fails.
+     */
+    void *(*alloc)(size_t size, TMXuserptr user);
+
+    /**
+     * @brief Resizes a block of memory, preserving its contents. May be @c NULL, in which case blocks are resized by
+     * allocating a new block, copying, and freeing the previous.
+     * @param[in] memory The block to resize.
+     * @param[in] oldSize The current size of the block, in bytes.
+     * @param[in] newSize The requested size of the block, in bytes.
+     * @param[in] user The user-defined value of the allocator.
+     * @return A pointer to the resized block, or @c NULL if the request fails, in which case @a memory is left unchanged.
+     */
+    void *(*realloc)(void *memory, size_t oldSize, size_t newSize, TMXuserptr user);
+
+    /**
+     * @brief Frees a block of memory.
+     * @param[in] memory The block to free. Never @c NULL.
+     * @param[in] size The size of the block, in bytes.
+     * @param[in] user The user-defined value of the allocator.
+     */
+    void (*free)(void *memory, size_t size, TMXuserptr user);
+
+    TMXuserptr user; /** A user-defined value passed to each function. */
+} TMXallocator;
+
+/**
+ * @brief Memory accounting for a single category.
+ */
+typedef struct TMXmemoryusage
+{
+    size_t live_bytes; /** The number of bytes currently allocated. */
+    size_t peak_bytes; /** The highest value of @a live_bytes since the last reset. */
+    size_t live_count; /** The number of blocks currently allocated. */
+    size_t count;      /** The number of blocks allocated since the last reset. */
+} TMXmemoryusage;
+
+/**
+ * @brief Memory accounting for all allocations made through the library.
+ */
+typedef struct TMXmemorystats
+{
+    TMXmemoryusage categories[TMX_MEMORY_CATEGORY_COUNT]; /** Accounting for each category, indexed by @ref TMX_MEMORY_CATEGORY. */
+    TMXmemoryusage total;                                 /** Accounting for all categories combined. */
+    size_t pool_bytes;                                    /** The number of bytes reserved by node pools, including free nodes. */
+} TMXmemorystats;
+
 /**
  * @brief Assigns a user-pointer that will be passed to custom memory allocation/deallocation functions.
  *
@@ -72,4 +151,89 @@ void *tmxCalloc(size_t elemCount, size_t elemSize);
  */
 void tmxFree(void *memory);
 
+/**
+ * @brief Retrieves the requested size of a block of memory.
+ *
+ * @param[in] memory Pointer to a memory block previously allocated with @ref tmxMalloc, @ref tmxCalloc, or @ref tmxRealloc.
+ * @return The size of the block, in bytes, or @c 0 if @a memory is @c NULL.
+ */
+size_t tmxMemorySize(const void *memory);
+
+/**
+ * @brief Retrieves accounting for all memory allocated through the library.
+ *
+ * @details Each block records its size and category in a small header, so accounting is always available and costs a
+ * few additions per allocation. The counters are not synchronized, so they are only exact when a single thread is
+ * allocating at a time.
+ *
+ * @param[out] stats A structure to receive the current figures.
+ */
+void tmxMemoryStats(TMXmemorystats *stats);
+
+/**
+ * @brief Resets the peak bytes and allocation counts of each category to the current live figures.
+ */
+void tmxMemoryStatsReset(void);
+
+/**
+ * @brief Retrieves a short human-readable name for a memory category, suitable for reports.
+ *
+ * @param[in] category The category to query.
+ * @return The name of the category, or @c NULL if @a category is invalid.
+ */
+const char *tmxMemoryCategoryName(TMX_MEMORY_CATEGORY category);
+
+/**
+ * @brief Sets the allocator used for subsequent allocations, such as a load or series of loads.
+ *
+ * @details Blocks are always resized and freed by the allocator that created them, regardless of the allocator that is
+ * active at that time, so the @a allocator must remain valid until every block it allocated has been freed.
+ *
+ * @code
+ * const TMXallocator *previous = tmxMemoryAllocator(&zoneAllocator);
+ * TMXmap *map                  = tmxLoadMap("zone.tmx", NULL, TMX_FORMAT_AUTO);
+ * tmxMemoryAllocator(previous);
+ * // ...
+ * tmxFreeMap(map); // Released to zoneAllocator
+ * @endcode
+ *
+ * @param[in] allocator The allocator to use, or @c NULL to use the default (compile-time) functions. The @c alloc and
+ * @c free functions are required.
+ * @return The previous allocator, which should be restored by the caller.
+ */
+const TMXallocator *tmxMemoryAllocator(const TMXallocator *allocator);
+
+/**
+ * @brief Sets the category of subsequent allocations made by @ref tmxMalloc, @ref tmxCalloc, and @ref tmxRealloc (when
+ * @c NULL is passed as the previous pointer). Reallocations retain the category of the original block.
+ *
+ * @details The library sets this while parsing, and restores the previous value when done, so user code typically
+ * has no need for it, but it can be used to tag memory allocated for the library (i.e. in callbacks).
+ *
+ * @param[in] category The category to apply.
+ * @return The previous category, which should be restored by the caller.
+ */
+TMX_MEMORY_CATEGORY tmxMemoryCategory(TMX_MEMORY_CATEGORY category);
+
+/**
+ * @brief Enables or disables node pools for subsequent allocations. Pools are disabled by default.
+ *
+ * @details When enabled, objects, layers, object text, and property entries are taken from fixed-size pools instead of
+ * individual heap allocations, and freed nodes are kept for reuse by later loads. This avoids fragmenting the heap when
+ * maps are repeatedly loaded and unloaded, and reduces the cost of allocation for maps with many objects. Nodes are
+ * still allocated and freed with the usual functions, and are accounted to their category as any other block.
+ *
+ * Pools are shared by all threads and not synchronized, so they should only be enabled when maps are loaded and freed
+ * from a single thread. While an allocator is installed with @ref tmxMemoryAllocator, it is used instead of the pools.
+ *
+ * @param[in] enabled @c TMX_TRUE to take nodes from pools, otherwise @c TMX_FALSE to allocate them individually. Nodes
+ * already taken from a pool are returned to it when freed either way.
+ */
+void tmxMemoryPools(TMX_BOOL enabled);
+
+/**
+ * @brief Releases the memory reserved by each node pool that has no nodes in use.
+ */
+void tmxMemoryTrim(void);
+
 #endif /* TMX_MEMORY_H */
\ No newline at end of file
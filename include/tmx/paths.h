@@ -0,0 +1,156 @@
+/**
+ * @file paths.h
+ * @brief Provides shortest path searches over a grid of movement costs, such as one filled from the layers of a map.
+ * @version 0.1
+ *
+ * @details A pathfinder searches a grid of one byte per cell (see @ref tmxGridFill), where 0 is a blocked cell and any
+ * other value is the cost of entering the cell. Cells are connected to their four edge neighbors, their eight neighbors
+ * (diagonals only where both adjacent edges are open, so paths never cut corners), or the six neighbors of a hexagonal or
+ * staggered map.
+ *
+ * Two methods are available. A* considers the cost of each cell, with a diagonal step costing 1.4 times a straight one.
+ * Jump point search (JPS) treats every open cell as the same cost, and skips over the straight and diagonal runs of open
+ * cells between turning points, expanding only a fraction of the cells A* does. Straight runs are scanned 64 cells at a
+ * time, from bitmaps of the open cells of each row and column. It applies to eight neighbors only; other neighbor rules
+ * fall back to A*. Both methods find a path of the least cost, although not necessarily the same one when several exist.
+ *
+ * A pathfinder is a workspace for searches over a grid that it does not copy, and keeps its memory between searches.
+ * The open and closed sets are bitsets, and only the words touched by a search are cleared for the next one. Once it has
+ * grown to fit the frontier of the largest search, searching allocates nothing. Several pathfinders can share the same
+ * grid, such as one for each thread, as long as the grid is not modified during a search.
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#ifndef TMX_PATHS_H
+#define TMX_PATHS_H
+
+#include "../tmx.h"
+
+/**
+ * @brief Describes which cells are connected to each other.
+ */
+typedef enum TMX_PATH_NEIGHBORS
+{
+    TMX_PATH_FOUR  = 0, /** The cells sharing an edge. */
+    TMX_PATH_EIGHT = 1, /** The cells sharing an edge or a corner, moving diagonally only when both adjacent edges are open. */
+    TMX_PATH_HEX   = 2  /** The six cells surrounding a cell of a hexagonal or staggered map, following its stagger axis and index. */
+} TMX_PATH_NEIGHBORS;
+
+/**
+ * @brief Describes the method of a path search.
+ */
+typedef enum TMX_PATH_METHOD
+{
+    TMX_PATH_ASTAR = 0, /** A* search, considering the cost of each cell. */
+    TMX_PATH_JPS   = 1  /** Jump point search, treating every open cell as the same cost. Requires @ref TMX_PATH_EIGHT. */
+} TMX_PATH_METHOD;
+
+/**
+ * @brief The cost of a straight step into a cell with a cost of 1. A diagonal step costs @ref TMX_PATH_DIAGONAL_COST.
+ */
+#define TMX_PATH_STRAIGHT_COST 10
+
+/**
+ * @brief The cost of a diagonal step into a cell with a cost of 1.
+ */
+#define TMX_PATH_DIAGONAL_COST 14
+
+/**
+ * @brief The result of a single search.
+ */
+typedef struct TMXpath
+{
+    size_t first;  /** The index of the first point in the `points` array. */
+    size_t count;  /** The number of points, from the start to the goal inclusive, one per cell. 0 when no path exists. */
+    uint32_t cost; /** The total cost of the steps of the path, in units of @ref TMX_PATH_STRAIGHT_COST. */
+} TMXpath;
+
+/**
+ * @brief The results of one or more searches.
+ */
+typedef struct TMXpathlist
+{
+    size_t count;          /** The number of elements in the `paths` array, one for each search. */
+    TMXpath *paths;        /** The result of each search, in order. */
+    size_t point_count;    /** The number of elements in the `points` array. */
+    TMXpoint *points;      /** The cells of the paths, in tile units. */
+    size_t capacity;       /** The number of paths that can be stored without reallocating. */
+    size_t point_capacity; /** The number of points that can be stored without reallocating. */
+} TMXpathlist;
+
+/**
+ * @brief Opaque type for a search workspace over a grid of movement costs.
+ */
+typedef struct TMXpathfinder TMXpathfinder;
+
+/**
+ * @brief Creates a pathfinder over a grid of movement costs.
+ *
+ * @param[in] map The map the grid was filled from, which determines the stagger axis and index for @ref TMX_PATH_HEX.
+ * @param[in] costs An array of `region.w * region.h` bytes in row-major order, where 0 is a blocked cell and any other
+ * value is the cost of entering the cell. The array is not copied, and must remain valid for the life of the pathfinder.
+ * When cells are opened or blocked, call @ref tmxPathfinderUpdate before the next search.
+ * @param[in] region The cells of the grid, in tile units, as passed to @ref tmxGridFill.
+ * @param[in] neighbors Describes which cells are connected to each other.
+ * @return The pathfinder, which must be freed with @ref tmxFreePathfinder, or @c NULL on failure.
+ */
+TMXpathfinder *tmxPathfinderCreate(const TMXmap *map, const uint8_t *costs, TMXrect region, TMX_PATH_NEIGHBORS neighbors);
+
+/**
+ * @brief Updates a pathfinder after cells of its grid were opened or blocked. Changes to the costs of open cells do not
+ * require an update.
+ *
+ * @param[in] finder The pathfinder to update.
+ */
+void tmxPathfinderUpdate(TMXpathfinder *finder);
+
+/**
+ * @brief Creates an empty path list.
+ *
+ * @return The list, which must be freed with @ref tmxFreePathList, or @c NULL if memory could not be allocated.
+ */
+TMXpathlist *tmxPathListCreate(void);
+
+/**
+ * @brief Searches for a path between two cells, replacing the previous contents of a path list with its result.
+ *
+ * @param[in] finder The pathfinder to search with.
+ * @param[in] start The cell to begin at, in tile units.
+ * @param[in] goal The cell to reach, in tile units.
+ * @param[in] method The method of the search.
+ * @param[in,out] paths The list to receive the result.
+ * @return @c TMX_TRUE if a path was found, otherwise @c TMX_FALSE.
+ */
+TMX_BOOL tmxPathFind(TMXpathfinder *finder, TMXpoint start, TMXpoint goal, TMX_PATH_METHOD method, TMXpathlist *paths);
+
+/**
+ * @brief Searches for the paths between several pairs of cells, replacing the previous contents of a path list with a
+ * result for each pair.
+ *
+ * @param[in] finder The pathfinder to search with.
+ * @param[in] starts The cells to begin at, in tile units.
+ * @param[in] goals The cells to reach, in tile units, with the same number of elements as @a starts.
+ * @param[in] count The number of searches.
+ * @param[in] method The method of the searches.
+ * @param[in,out] paths The list to receive the results, in order.
+ * @return The number of paths that were found.
+ */
+size_t tmxPathFindBatch(TMXpathfinder *finder, const TMXpoint *starts, const TMXpoint *goals, size_t count, TMX_PATH_METHOD method,
+                        TMXpathlist *paths);
+
+/**
+ * @brief Frees a path list.
+ *
+ * @param[in] paths The list to free.
+ */
+void tmxFreePathList(TMXpathlist *paths);
+
+/**
+ * @brief Frees a pathfinder.
+ *
+ * @param[in] finder The pathfinder to free.
+ */
+void tmxFreePathfinder(TMXpathfinder *finder);
+
+#endif /* TMX_PATHS_H */
@@ -0,0 +1,114 @@
+/**
+ * @file quads.h
+ * @brief Provides baking of tile layers into vertex and index arrays, ready to be uploaded for rendering.
+ * @version 0.1
+ *
+ * @details Each non-empty cell becomes a textured quad of four vertices and six indices, with its position following
+ * the orientation of the map and the tile offset, render size, and fill mode of its tileset. Flip flags are applied to
+ * the texture coordinates. On hexagonal maps, the diagonal flag and @ref TMX_GID_ROTATE_120 instead rotate the quad
+ * around its center by 60 and 120 degrees clockwise, as in Tiled.
+ *
+ * Quads are emitted in draw order: following the render order of orthogonal maps, by diagonal for isometric maps, and
+ * row by row for staggered and hexagonal maps (with the upper columns of each row first when staggered on the x-axis).
+ * Consecutive quads that use the same image are grouped into ranges, each of which can be drawn with a single call.
+ *
+ * Positions are in pixel units relative to the map, without the offset or parallax of the layer. A mesh keeps its
+ * memory between bakes, so that the chunks (or regions) of a layer can each be baked into their own mesh and rebaked
+ * when modified, without allocating.
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#ifndef TMX_QUADS_H
+#define TMX_QUADS_H
+
+#include "../tmx.h"
+
+/**
+ * @brief A single vertex of a quad.
+ */
+typedef struct TMXvertex
+{
+    float x; /** The position of the vertex on the x-axis, in pixel units. */
+    float y; /** The position of the vertex on the y-axis, in pixel units. */
+    float u; /** The normalized texture coordinate on the x-axis. */
+    float v; /** The normalized texture coordinate on the y-axis. */
+} TMXvertex;
+
+/**
+ * @brief A run of consecutive quads that use the same image.
+ */
+typedef struct TMXquadrange
+{
+    const TMXimage *image; /** The image of the tiles, which is either the image of a tileset or of a tile in a collection. */
+    size_t first;          /** The index of the first quad. Its first index is at `first * 6` of the `indices` array. */
+    size_t count;          /** The number of quads. */
+} TMXquadrange;
+
+/**
+ * @brief Vertex and index arrays describing the quads of a baked layer, chunk, or region.
+ *
+ * @details The vertices of each quad are ordered top-left, top-right, bottom-right, bottom-left before any rotation, and
+ * are indexed as two clockwise triangles.
+ */
+typedef struct TMXquadmesh
+{
+    size_t quad_count;      /** The number of quads. The `vertices` array has 4 elements for each, and `indices` 6. */
+    TMXvertex *vertices;    /** The vertices of the quads. */
+    uint32_t *indices;      /** The indices of the vertices of each triangle. */
+    size_t range_count;     /** The number of elements in the `ranges` array. */
+    TMXquadrange *ranges;   /** The quads grouped by image, in draw order. */
+    size_t capacity;        /** The number of quads that can be baked without reallocating. */
+    size_t range_capacity;  /** The number of ranges that can be stored without reallocating. */
+} TMXquadmesh;
+
+/**
+ * @brief Creates an empty mesh.
+ *
+ * @return The mesh, which must be freed with @ref tmxFreeQuadMesh, or @c NULL if memory could not be allocated.
+ */
+TMXquadmesh *tmxQuadMeshCreate(void);
+
+/**
+ * @brief Bakes every cell of a tile layer into a mesh, replacing its previous contents.
+ *
+ * @param[in] map The map containing the layer.
+ * @param[in] layer A tile layer. For infinite maps, cells are emitted chunk by chunk, in the order of the chunks.
+ * @param[in,out] mesh The mesh to receive the quads.
+ * @return @c TMX_TRUE on success, otherwise @c TMX_FALSE.
+ */
+TMX_BOOL tmxBakeLayer(const TMXmap *map, const TMXlayer *layer, TMXquadmesh *mesh);
+
+/**
+ * @brief Bakes the cells of a tile layer within a rectangle into a mesh, replacing its previous contents.
+ *
+ * @details Splitting a finite layer into regions allows each to be rebaked independently, like the chunks of an
+ * infinite layer.
+ *
+ * @param[in] map The map containing the layer.
+ * @param[in] layer A tile layer.
+ * @param[in] region The cells to bake, in tile units. Cells outside of the layer are ignored.
+ * @param[in,out] mesh The mesh to receive the quads.
+ * @return @c TMX_TRUE on success, otherwise @c TMX_FALSE.
+ */
+TMX_BOOL tmxBakeRegion(const TMXmap *map, const TMXlayer *layer, TMXrect region, TMXquadmesh *mesh);
+
+/**
+ * @brief Bakes a single chunk of an infinite tile layer into a mesh, replacing its previous contents.
+ *
+ * @param[in] map The map containing the layer.
+ * @param[in] layer A tile layer of an infinite map.
+ * @param[in] index The index of the chunk within the layer.
+ * @param[in,out] mesh The mesh to receive the quads.
+ * @return @c TMX_TRUE on success, otherwise @c TMX_FALSE.
+ */
+TMX_BOOL tmxBakeChunk(const TMXmap *map, const TMXlayer *layer, size_t index, TMXquadmesh *mesh);
+
+/**
+ * @brief Frees a mesh.
+ *
+ * @param[in] mesh The mesh to free.
+ */
+void tmxFreeQuadMesh(TMXquadmesh *mesh);
+
+#endif /* TMX_QUADS_H */
@@ -0,0 +1,145 @@
+/**
+ * @file raycast.h
+ * @brief Provides batched raycasts, line of sight checks, and field of view against the solid cells of tile layers.
+ * @version 0.1
+ *
+ * @details A raycaster tests segments against a bitmap of solid cells, with one bit per cell in the layout of
+ * @ref tmxGridFillBits. The bitmap is either filled from tile layers when the raycaster is created, combining the chunks
+ * of infinite layers into a single grid, or provided by the caller and read in place.
+ *
+ * Positions are in tile units, where the cell at column @c x and row @c y covers the square from `(x, y)` to
+ * `(x + 1, y + 1)`, so a position in pixel units of an orthogonal map is divided by the tile size. Rays step from cell
+ * to cell along the segment (a digital differential analyzer), testing only the cells the segment passes through. The
+ * cell containing the start of a ray is never tested, so that rays may begin inside of a solid cell, such as a turret
+ * mounted in a wall. Cells outside of the grid are empty.
+ *
+ * Field of view is computed with recursive shadowcasting, in each of the eight octants around the origin. Solid cells
+ * are visible themselves, and block the cells behind them.
+ *
+ * A raycaster is not modified by casting rays, so it can be shared between threads.
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#ifndef TMX_RAYCAST_H
+#define TMX_RAYCAST_H
+
+#include "grids.h"
+
+/**
+ * @brief A segment to cast, in tile units.
+ */
+typedef struct TMXray
+{
+    TMXvec2 start; /** The position the ray begins at. */
+    TMXvec2 end;   /** The position the ray ends at. */
+} TMXray;
+
+/**
+ * @brief The result of a single ray.
+ */
+typedef struct TMXrayhit
+{
+    TMX_BOOL hit;   /** Indicates the ray entered a solid cell before its end. */
+    TMXpoint cell;  /** The solid cell that was hit. Undefined when there is no hit. */
+    float distance; /** The distance from the start of the ray to the point it entered the cell, or the length of the ray. */
+} TMXrayhit;
+
+/**
+ * @brief Opaque type for a grid of solid cells to cast rays against.
+ */
+typedef struct TMXraycaster TMXraycaster;
+
+/**
+ * @brief Creates a raycaster from the tiles of one or more layers.
+ *
+ * @param[in] layers The tile layers to combine. A cell is solid when the value of its tile in any layer is non-zero.
+ * @param[in] count The number of elements in the @a layers array.
+ * @param[in] table The value of each tile, with an empty value of 0.
+ * @return The raycaster, which must be freed with @ref tmxFreeRaycaster, or @c NULL on failure.
+ */
+TMXraycaster *tmxRaycasterCreate(const TMXlayer *const *layers, size_t count, const TMXtiletable *table);
+
+/**
+ * @brief Creates a raycaster over a bitmap of solid cells provided by the caller.
+ *
+ * @param[in] bits The bitmap, as filled by @ref tmxGridFillBits, where set bits are solid cells. The bitmap is not copied,
+ * and must remain valid for the life of the raycaster. Changes to the bitmap apply to later casts.
+ * @param[in] region The cells of the bitmap, in tile units.
+ * @return The raycaster, which must be freed with @ref tmxFreeRaycaster, or @c NULL on failure.
+ */
+TMXraycaster *tmxRaycasterCreateBits(const uint64_t *bits, TMXrect region);
+
+/**
+ * @brief Retrieves the bitmap of solid cells of a raycaster, such as to share it with other raycasters or searches.
+ *
+ * @param[in] caster The raycaster to query.
+ * @param[out] region Receives the cells of the bitmap, in tile units. May be @c NULL.
+ * @return The bitmap, in the layout of @ref tmxGridFillBits.
+ */
+const uint64_t *tmxRaycasterBits(const TMXraycaster *caster, TMXrect *region);
+
+/**
+ * @brief Marks a single cell of a raycaster created from layers as solid or empty.
+ *
+ * @param[in] caster A raycaster created with @ref tmxRaycasterCreate.
+ * @param[in] cell The cell to modify, in tile units. Cells outside of the grid are ignored.
+ * @param[in] solid The state of the cell.
+ */
+void tmxRaycasterSetCell(TMXraycaster *caster, TMXpoint cell, TMX_BOOL solid);
+
+/**
+ * @brief Casts a batch of rays, finding the first solid cell along each.
+ *
+ * @param[in] caster The raycaster to cast against.
+ * @param[in] rays The rays to cast.
+ * @param[in] count The number of rays.
+ * @param[out] hits An array with room for @a count results, in the order of @a rays.
+ * @return The number of rays that hit a solid cell.
+ */
+size_t tmxRaycast(const TMXraycaster *caster, const TMXray *rays, size_t count, TMXrayhit *hits);
+
+/**
+ * @brief Tests a batch of rays for line of sight, which exists when no solid cell lies between the start and the end.
+ *
+ * @details The cell containing the end of a ray is tested, so a target standing in an open cell is visible, and one
+ * inside of a solid cell is not.
+ *
+ * @param[in] caster The raycaster to cast against.
+ * @param[in] rays The rays to test.
+ * @param[in] count The number of rays.
+ * @param[out] visible An array with room for @a count flags, each set to 1 when there is line of sight, otherwise 0.
+ * @return The number of rays with line of sight.
+ */
+size_t tmxLineOfSight(const TMXraycaster *caster, const TMXray *rays, size_t count, uint8_t *visible);
+
+/**
+ * @brief Computes the number of words of a field of view bitmap.
+ *
+ * @param[in] radius The radius of the field of view, in cells.
+ * @return The number of words, which is `2 * radius + 1` rows of `(2 * radius + 64) / 64` words.
+ */
+size_t tmxFieldOfViewSize(int radius);
+
+/**
+ * @brief Computes the cells visible from a cell within a radius.
+ *
+ * @param[in] caster The raycaster to cast against.
+ * @param[in] origin The cell to view from, in tile units. It is always visible.
+ * @param[in] radius The distance to view, in cells. Cells are within the radius when the distance between their centers
+ * and the center of the origin is not greater.
+ * @param[out] output The bitmap to receive the visible cells, with at least @ref tmxFieldOfViewSize words. Each row begins
+ * on a new word, and the bit of the cell at `(origin.x - radius + i, origin.y - radius + j)` is `1 << (i % 64)` of word
+ * `j * ((2 * radius + 64) / 64) + i / 64`. The bitmap is cleared first, so it can be reused between calls.
+ * @return The number of visible cells, or 0 on failure.
+ */
+size_t tmxFieldOfView(const TMXraycaster *caster, TMXpoint origin, int radius, uint64_t *output);
+
+/**
+ * @brief Frees a raycaster.
+ *
+ * @param[in] caster The raycaster to free.
+ */
+void tmxFreeRaycaster(TMXraycaster *caster);
+
+#endif /* TMX_RAYCAST_H */
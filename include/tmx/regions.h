@@ -0,0 +1,180 @@
+/**
+ * @file regions.h
+ * @brief Provides connected region labeling and flood fill over the cells of a grid or tile layer, such as to find rooms,
+ * zones, or the cells reachable from one another.
+ * @version 0.1
+ *
+ * @details A labeler reads the cells of a grid of one byte per cell (see @ref tmxGridFill), or the tiles of a single layer
+ * through a table of tile values, without copying them. Cells with a non-zero value are open, and two open cells are
+ * connected when they share an edge, an edge or a corner, or are neighbors on a hexagonal or staggered map.
+ *
+ * Labeling assigns every open cell the number of its region with two passes over the cells. The first pass joins each
+ * cell to its neighbors in the rows above and to its left with a union-find, storing the links in the label grid itself,
+ * and the second replaces the links with consecutive numbers while measuring each region. The first pass works on tiles
+ * of the grid (or the chunks of an infinite layer) independently of each other, so that the tiles can be labeled by
+ * several threads, followed by a pass that joins the regions along the edges of the tiles.
+ *
+ * Flood fill follows the open cells connected to a single cell one row span at a time, for when only one region is of
+ * interest.
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#ifndef TMX_REGIONS_H
+#define TMX_REGIONS_H
+
+#include "grids.h"
+
+/**
+ * @brief Describes which cells are connected to each other.
+ */
+typedef enum TMX_REGION_CONNECT
+{
+    TMX_REGION_FOUR  = 0, /** The cells sharing an edge. */
+    TMX_REGION_EIGHT = 1, /** The cells sharing an edge or a corner. */
+    TMX_REGION_HEX   = 2  /** The six cells surrounding a cell of a hexagonal or staggered map, following its stagger axis and index. */
+} TMX_REGION_CONNECT;
+
+/**
+ * @brief Describes a single region of connected cells.
+ */
+typedef struct TMXregion
+{
+    TMXrect bounds; /** The smallest rectangle containing the cells of the region, in tile units. */
+    size_t cells;   /** The number of cells in the region. */
+} TMXregion;
+
+/**
+ * @brief The result of labeling the regions of a grid.
+ */
+typedef struct TMXregions
+{
+    TMXrect bounds;        /** The cells of the label grid, in tile units. */
+    uint32_t *labels;      /** The label of each cell in row-major order, 0 when closed, or one more than the index of its region. */
+    size_t count;          /** The number of elements in the `regions` array. */
+    TMXregion *regions;    /** The regions, in order of their first cell in row-major order. */
+    size_t capacity;       /** The number of regions that can be stored without reallocating. */
+    size_t label_capacity; /** The number of labels that can be stored without reallocating. */
+} TMXregions;
+
+/**
+ * @brief Opaque type for reading the open cells of a grid or tile layer.
+ */
+typedef struct TMXlabeler TMXlabeler;
+
+/**
+ * @brief Creates a labeler over a grid of one byte per cell.
+ *
+ * @param[in] map The map the grid was filled from, which determines the stagger axis and index for @ref TMX_REGION_HEX.
+ * @param[in] values An array of `region.w * region.h` bytes in row-major order, where any non-zero value is an open cell.
+ * The array is not copied, and must remain valid for the life of the labeler.
+ * @param[in] region The cells of the grid, in tile units, as passed to @ref tmxGridFill.
+ * @param[in] connect Describes which cells are connected to each other.
+ * @return The labeler, which must be freed with @ref tmxFreeLabeler, or @c NULL on failure.
+ */
+TMXlabeler *tmxLabelerCreate(const TMXmap *map, const uint8_t *values, TMXrect region, TMX_REGION_CONNECT connect);
+
+/**
+ * @brief Creates a labeler over the tiles of a layer, reading its global tile IDs directly.
+ *
+ * @details The grid of an infinite layer covers all of its chunks, and cells outside of every chunk have the empty value
+ * of the table. When the chunks are all the same size and aligned to it, as written by Tiled, each chunk is read in place
+ * and labeled as a tile. Otherwise, the chunks are first combined into a grid of bytes.
+ *
+ * @param[in] map The map containing the layer.
+ * @param[in] layer A tile layer, finite or infinite. The layer is not copied, and must remain valid for the life of the
+ * labeler.
+ * @param[in] table The value of each tile, where any non-zero value is an open cell. The table is not copied, and must
+ * remain valid for the life of the labeler.
+ * @param[in] connect Describes which cells are connected to each other.
+ * @return The labeler, which must be freed with @ref tmxFreeLabeler, or @c NULL on failure.
+ */
+TMXlabeler *tmxLabelerCreateLayer(const TMXmap *map, const TMXlayer *layer, const TMXtiletable *table, TMX_REGION_CONNECT connect);
+
+/**
+ * @brief Creates an empty set of regions.
+ *
+ * @return The regions, which must be freed with @ref tmxFreeRegions, or @c NULL if memory could not be allocated.
+ */
+TMXregions *tmxRegionsCreate(void);
+
+/**
+ * @brief Labels the regions of connected open cells, replacing the previous contents of @a regions.
+ *
+ * @param[in] labeler The labeler to read cells from.
+ * @param[in,out] regions The regions to receive the label grid and the region of each label.
+ * @return @c TMX_TRUE if the regions were labeled, otherwise @c TMX_FALSE if memory could not be allocated.
+ */
+TMX_BOOL tmxLabel(TMXlabeler *labeler, TMXregions *regions);
+
+/**
+ * @brief Begins labeling the regions of connected open cells in tiles, such as to label the tiles on several threads.
+ *
+ * @details After this call, @ref tmxLabelTile is called once with each index less than the number of tiles, in any order
+ * and from any thread, followed by @ref tmxLabelEnd once every tile is done.
+ *
+ * @param[in] labeler The labeler to read cells from.
+ * @param[in,out] regions The regions to receive the result, whose label grid is allocated by this call.
+ * @param[in] size The width and height of each tile in cells, or 0 or less for a single tile. Ignored when the labeler
+ * reads the chunks of an infinite layer in place, which are labeled as tiles of their own.
+ * @param[out] tiles Receives the number of tiles.
+ * @return @c TMX_TRUE on success, otherwise @c TMX_FALSE if memory could not be allocated.
+ */
+TMX_BOOL tmxLabelBegin(TMXlabeler *labeler, TMXregions *regions, int size, size_t *tiles);
+
+/**
+ * @brief Labels the cells of a single tile. Different tiles of the same regions may be labeled at the same time.
+ *
+ * @param[in] labeler The labeler passed to @ref tmxLabelBegin.
+ * @param[in,out] regions The regions passed to @ref tmxLabelBegin.
+ * @param[in] index The index of the tile, less than the number of tiles.
+ */
+void tmxLabelTile(const TMXlabeler *labeler, TMXregions *regions, size_t index);
+
+/**
+ * @brief Joins the regions along the edges of the tiles, and assigns the final labels and measures each region.
+ *
+ * @param[in] labeler The labeler passed to @ref tmxLabelBegin.
+ * @param[in,out] regions The regions passed to @ref tmxLabelBegin, after every tile was labeled.
+ * @return @c TMX_TRUE on success, otherwise @c TMX_FALSE if memory could not be allocated.
+ */
+TMX_BOOL tmxLabelEnd(const TMXlabeler *labeler, TMXregions *regions);
+
+/**
+ * @brief Fills the region of open cells connected to a single cell.
+ *
+ * @details The bitmap is not cleared, and cells that are already set are treated as filled, so that several fills can
+ * accumulate in the same bitmap, such as to find every region without labeling. A labeler keeps the memory of the fill
+ * between calls, so it must only be used by one thread at a time.
+ *
+ * @param[in] labeler The labeler to read cells from.
+ * @param[in] seed The cell to begin at, in tile units.
+ * @param[in,out] output The bitmap of filled cells, in the layout of @ref tmxGridFillBits over the cells of the labeler.
+ * @param[out] bounds Receives the smallest rectangle containing the filled cells, in tile units. May be @c NULL.
+ * @return The number of cells that were filled, which is 0 if the seed is closed, outside of the grid, or already set.
+ */
+size_t tmxFloodFill(TMXlabeler *labeler, TMXpoint seed, uint64_t *output, TMXrect *bounds);
+
+/**
+ * @brief Retrieves the cells a labeler reads.
+ *
+ * @param[in] labeler The labeler to query.
+ * @return The cells of the grid, in tile units.
+ */
+TMXrect tmxLabelerRegion(const TMXlabeler *labeler);
+
+/**
+ * @brief Frees a set of regions.
+ *
+ * @param[in] regions The regions to free.
+ */
+void tmxFreeRegions(TMXregions *regions);
+
+/**
+ * @brief Frees a labeler.
+ *
+ * @param[in] labeler The labeler to free.
+ */
+void tmxFreeLabeler(TMXlabeler *labeler);
+
+#endif /* TMX_REGIONS_H */
@@ -0,0 +1,83 @@
+/**
+ * @file stats.h
+ * @brief Provides optional instrumentation for measuring where time and memory are spent while loading documents.
+ * @version 0.1
+ *
+ * @details Statistics are disabled by default. When a @ref TMXloadstats structure is assigned with @ref tmxLoadStats,
+ * it is cleared at the start of each top-level load/parse call (i.e. @ref tmxLoadMap, @ref tmxParseTileset, etc.) and
+ * filled as the document is processed, including any external tilesets and templates it references. When disabled,
+ * the cost of the instrumentation is a single pointer comparison at each measuring point.
+ *
+ * The time of each phase is tracked both inclusively (all time spent within the phase) and exclusively (time not
+ * spent in a nested phase), so that the exclusive times of all phases add up to the total time of the load.
+ *
+ * Like the other global callbacks of the library, the assigned structure is shared by all threads, so statistics
+ * should only be enabled while loading from a single thread.
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#ifndef TMX_STATS_H
+#define TMX_STATS_H
+
+#include "common.h"
+
+/**
+ * @brief Describes a distinct phase of loading a document.
+ */
+typedef enum TMX_PHASE
+{
+    TMX_PHASE_LOAD     = 0, /** Loading a map, excluding time spent in the other phases. */
+    TMX_PHASE_READ     = 1, /** Reading a file from disk, or from the user-defined read callback. */
+    TMX_PHASE_PARSE    = 2, /** Tokenizing the XML/JSON document and building the objects it describes. */
+    TMX_PHASE_CSV      = 3, /** Decoding CSV-encoded tile data. */
+    TMX_PHASE_BASE64   = 4, /** Decoding Base64-encoded tile data. */
+    TMX_PHASE_INFLATE  = 5, /** Decompressing Gzip, Zlib, or Zstandard tile data. */
+    TMX_PHASE_TILESET  = 6, /** Loading a tileset, excluding time spent in the other phases. */
+    TMX_PHASE_TEMPLATE = 7, /** Loading a template, excluding time spent in the other phases. */
+    TMX_PHASE_IMAGE    = 8, /** Invoking the user-defined image loading callback. */
+    TMX_PHASE_COUNT    = 9  /** The number of phases, not a valid value. */
+} TMX_PHASE;
+
+/**
+ * @brief Measurements for a single phase of loading.
+ */
+typedef struct TMXphasestats
+{
+    double seconds;      /** The wall time spent in the phase, including nested phases. */
+    double self_seconds; /** The wall time spent in the phase, excluding nested phases. */
+    size_t bytes;        /** The number of input bytes processed by the phase. */
+    size_t count;        /** The number of times the phase was entered. */
+} TMXphasestats;
+
+/**
+ * @brief Statistics gathered during a load.
+ */
+typedef struct TMXloadstats
+{
+    double seconds;                        /** The total wall time of the load. */
+    TMXphasestats phases[TMX_PHASE_COUNT]; /** Measurements for each phase, indexed by @ref TMX_PHASE. */
+    size_t files_read;                     /** The number of files that were successfully read. */
+    size_t cache_hits;                     /** The number of external tilesets/templates that were retrieved from the cache. */
+    size_t cache_misses;                   /** The number of external tilesets/templates that were not found in the cache. */
+    size_t allocations;                    /** The number of allocations and reallocations that were made. */
+    size_t allocated_bytes;                /** The total number of bytes requested by allocations and reallocations. */
+} TMXloadstats;
+
+/**
+ * @brief Assigns a structure that will receive statistics for each subsequent load.
+ *
+ * @param[in] stats The structure to fill, or @c NULL to disable statistics. The pointer must remain valid until
+ * statistics are disabled.
+ */
+void tmxLoadStats(TMXloadstats *stats);
+
+/**
+ * @brief Retrieves a short human-readable name for a phase, suitable for reports.
+ *
+ * @param[in] phase The phase to query.
+ * @return The name of the phase, or @c NULL if @a phase is invalid.
+ */
+const char *tmxPhaseName(TMX_PHASE phase);
+
+#endif /* TMX_STATS_H */
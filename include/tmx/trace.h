@@ -0,0 +1,40 @@
+/**
+ * @file trace.h
+ * @brief Provides recording of nested parse spans as a Chrome trace-event file.
+ * @version 0.1
+ *
+ * @details Tracing is only available when the library is built with the @c TMX_TRACE CMake option, otherwise the
+ * functions in this header are still present, but @ref tmxTraceStart fails and no spans are recorded.
+ *
+ * While a trace is active, each load records a span for the document itself, and nested spans for reading files,
+ * parsing, each layer, decoding and decompressing tile data, external tilesets/templates, and image callbacks, i.e.
+ * <tt>map → parse → layer Ground → base64 → inflate zstd</tt>. Spans are written as "complete" events as soon as they
+ * end, so a trace of a long batch of loads does not accumulate in memory. The resulting file can be opened directly
+ * in Perfetto (https://ui.perfetto.dev) or @c chrome://tracing.
+ *
+ * Like the other global callbacks of the library, a trace is shared by all threads, so loads should only be traced
+ * from a single thread.
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#ifndef TMX_TRACE_H
+#define TMX_TRACE_H
+
+#include "common.h"
+
+/**
+ * @brief Begins recording spans to a trace file, replacing any existing file.
+ *
+ * @param[in] filename The path of the JSON file to write.
+ * @return @c TMX_TRUE if the trace was started, otherwise @c TMX_FALSE if the file could not be opened, a trace is
+ * already active, or tracing was not compiled into the library.
+ */
+TMX_BOOL tmxTraceStart(const char *filename);
+
+/**
+ * @brief Stops recording spans and finishes writing the trace file. Does nothing if no trace is active.
+ */
+void tmxTraceStop(void);
+
+#endif /* TMX_TRACE_H */
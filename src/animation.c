@@ -0,0 +1,348 @@
+#include "tmx/animation.h"
+#include "internal.h"
+#include <math.h>
+#include <string.h>
+
+/**
+ * @brief The cells that share an animated tile, and the state of its animation.
+ */
+typedef struct TMXanimgroup
+{
+    const TMXanimation *animation;
+    TMXgid firstGid;     /** The first GID of the tileset defining the tile. */
+    size_t first;        /** The index of the first cell of the group. */
+    size_t count;        /** The number of cells in the group. */
+    size_t frame;        /** The index of the frame currently displayed. */
+    double end;          /** The time the current frame ends, in milliseconds. */
+    unsigned int period; /** The total duration of the frames, in milliseconds. */
+} TMXanimgroup;
+
+struct TMXanimator
+{
+    TMXanimgroup *groups;
+    size_t groupCount;
+    size_t *queue;         /** A binary min-heap of the indices of the groups that change over time, ordered by `end`. */
+    size_t queueCount;
+    TMXanimcell *cells;    /** The animated cells, ordered by group. */
+    size_t cellCount;
+    TMXanimcell *changes;  /** The cells that changed during the last update, with room for every cell. */
+    double time;           /** The time elapsed since the first frame, in milliseconds. */
+};
+
+static TMX_INLINE TMX_BOOL
+tmxAnimatorBefore(const TMXanimator *animator, size_t a, size_t b)
+{
+    return animator->groups[animator->queue[a]].end < animator->groups[animator->queue[b]].end;
+}
+
+static void
+tmxAnimatorSiftDown(TMXanimator *animator, size_t i)
+{
+    for (;;)
+    {
+        size_t least = i, left = i * 2 + 1, right = left + 1;
+        if (left < animator->queueCount && tmxAnimatorBefore(animator, left, least))
+            least = left;
+        if (right < animator->queueCount && tmxAnimatorBefore(animator, right, least))
+            least = right;
+        if (least == i)
+            return;
+
+        size_t swap            = animator->queue[i];
+        animator->queue[i]     = animator->queue[least];
+        animator->queue[least] = swap;
+        i                      = least;
+    }
+}
+
+/**
+ * @brief Writes the GID of the current frame of a group to each of its cells, keeping their flip flags.
+ */
+static void
+tmxAnimatorApply(TMXanimator *animator, const TMXanimgroup *group)
+{
+    TMXgid gid        = group->firstGid + group->animation->frames[group->frame].id;
+    TMXanimcell *cell = &animator->cells[group->first];
+    size_t i;
+
+    for (i = 0; i < group->count; i++)
+        cell[i].gid = (cell[i].gid & TMX_GID_FLAG_MASK) | gid;
+}
+
+/**
+ * @brief Visits every cell of a layer, either counting the cells of each group or storing them.
+ *
+ * @param[in] lookup One plus the index of the group for each GID, or 0 when the tile is not animated.
+ * @param[in] store When @c TMX_FALSE, only the `count` of each group is incremented. Otherwise, the cells are stored at
+ * `first + count`, with `count` starting from 0.
+ */
+static void
+tmxAnimatorScan(TMXanimator *animator, const TMXlayer *layer, const size_t *lookup, size_t lookupCount, TMX_BOOL store)
+{
+    size_t chunk, chunkCount       = layer->type == TMX_LAYER_CHUNK ? layer->count : 1;
+    const TMXoccupancy *occupancy = layer->type == TMX_LAYER_TILE ? layer->occupancy : NULL;
+    int x, y, end;
+
+    for (chunk = 0; chunk < chunkCount; chunk++)
+    {
+        TMXrect bounds     = {.x = 0, .y = 0, .w = layer->size.w, .h = layer->size.h};
+        const TMXgid *gids = layer->data.tiles;
+        if (layer->type == TMX_LAYER_CHUNK)
+        {
+            bounds = layer->data.chunks[chunk].bounds;
+            gids   = layer->data.chunks[chunk].gids;
+        }
+        if (!gids)
+            continue;
+
+        for (y = 0; y < bounds.h; y++)
+        {
+            // Only the occupied blocks of a tile layer with an occupancy pyramid are scanned.
+            for (x = 0; x < bounds.w; x = end)
+            {
+                end = bounds.w;
+                if (occupancy && (x = tmxOccupancyNext(occupancy, x, y, bounds.w)) < bounds.w)
+                    end = tmxOccupancyRunEnd(occupancy, x, y, bounds.w);
+                for (; x < end; x++)
+                {
+                    TMXgid gid = gids[y * bounds.w + x];
+                    TMXgid id  = gid & TMX_GID_TILE_MASK;
+                    if (id >= lookupCount || !lookup[id])
+                        continue;
+
+                    TMXanimgroup *group = &animator->groups[lookup[id] - 1];
+                    if (store)
+                    {
+                        TMXanimcell *cell = &animator->cells[group->first + group->count];
+                        cell->position.x  = bounds.x + x;
+                        cell->position.y  = bounds.y + y;
+                        cell->gid         = gid;
+                        cell->chunk       = layer->type == TMX_LAYER_CHUNK ? chunk : 0;
+                    }
+                    group->count++;
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief Maps each GID of an animated tile to a new group, returning the lookup table.
+ */
+static size_t *
+tmxAnimatorLookup(TMXanimator *animator, const TMXmap *map, size_t *lookupCount)
+{
+    size_t i, k, tiles = 0, count = 1;
+
+    for (i = 0; i < map->tileset_count; i++)
+    {
+        const TMXtileset *tileset = map->tilesets[i].tileset;
+        if (!tileset)
+            continue;
+        for (k = 0; k < tileset->tile_count && tileset->tiles; k++)
+        {
+            const TMXtile *tile = &tileset->tiles[k];
+            count               = TMX_MAX(count, (size_t) map->tilesets[i].first_gid + tile->id + 1);
+            tiles += tile->animation.count > 0;
+        }
+    }
+
+    size_t *lookup   = tmxCalloc(count, sizeof(size_t));
+    animator->groups = tmxCalloc(TMX_MAX(tiles, 1), sizeof(TMXanimgroup));
+    if (!lookup || !animator->groups)
+    {
+        tmxFree(lookup);
+        return NULL;
+    }
+
+    for (i = 0; i < map->tileset_count; i++)
+    {
+        const TMXtileset *tileset = map->tilesets[i].tileset;
+        if (!tileset)
+            continue;
+        for (k = 0; k < tileset->tile_count && tileset->tiles; k++)
+        {
+            const TMXtile *tile = &tileset->tiles[k];
+            TMXgid gid          = map->tilesets[i].first_gid + tile->id;
+            if (!tile->animation.count || lookup[gid])
+                continue;
+
+            TMXanimgroup *group = &animator->groups[animator->groupCount];
+            group->animation    = &tile->animation;
+            group->firstGid     = map->tilesets[i].first_gid;
+            lookup[gid]         = ++animator->groupCount;
+        }
+    }
+
+    *lookupCount = count;
+    return lookup;
+}
+
+TMXanimator *
+tmxAnimatorCreate(const TMXmap *map, const TMXlayer *layer)
+{
+    if (!map || !layer)
+    {
+        tmxError(TMX_ERR_VALUE);
+        return NULL;
+    }
+    if (layer->type != TMX_LAYER_TILE && layer->type != TMX_LAYER_CHUNK)
+    {
+        tmxErrorMessage(TMX_ERR_PARAM, "Only tile layers can be animated.");
+        return NULL;
+    }
+
+    TMXanimator *animator = tmxCalloc(1, sizeof(TMXanimator));
+    if (!animator)
+        return NULL;
+
+    size_t i, used = 0, lookupCount = 0;
+    size_t *lookup = tmxAnimatorLookup(animator, map, &lookupCount);
+    if (!lookup)
+    {
+        tmxFreeAnimator(animator);
+        return NULL;
+    }
+
+    // Count the cells of each tile, then drop the tiles that are not used by the layer and assign each a range of cells.
+    // Groups were created in order of GID, so they can be compacted in place.
+    tmxAnimatorScan(animator, layer, lookup, lookupCount, TMX_FALSE);
+    for (i = 0; i < lookupCount; i++)
+    {
+        if (!lookup[i])
+            continue;
+        TMXanimgroup group = animator->groups[lookup[i] - 1];
+        if (!group.count)
+        {
+            lookup[i] = 0;
+            continue;
+        }
+
+        group.first            = animator->cellCount;
+        animator->cellCount += group.count;
+        group.count            = 0;
+        animator->groups[used] = group;
+        lookup[i]              = ++used;
+    }
+    animator->groupCount = used;
+
+    animator->cells   = tmxMalloc(TMX_MAX(animator->cellCount, 1) * sizeof(TMXanimcell));
+    animator->changes = tmxMalloc(TMX_MAX(animator->cellCount, 1) * sizeof(TMXanimcell));
+    animator->queue   = tmxMalloc(TMX_MAX(animator->groupCount, 1) * sizeof(size_t));
+    if (!animator->cells || !animator->changes || !animator->queue)
+    {
+        tmxFree(lookup);
+        tmxFreeAnimator(animator);
+        return NULL;
+    }
+
+    tmxAnimatorScan(animator, layer, lookup, lookupCount, TMX_TRUE);
+    tmxFree(lookup);
+
+    for (i = 0; i < animator->groupCount; i++)
+    {
+        TMXanimgroup *group = &animator->groups[i];
+        size_t k;
+        for (k = 0; k < group->animation->count; k++)
+            group->period += group->animation->frames[k].duration;
+    }
+
+    tmxAnimatorReset(animator);
+    return animator;
+}
+
+size_t
+tmxAnimatorCells(const TMXanimator *animator, const TMXanimcell **cells)
+{
+    if (!animator || !cells)
+    {
+        tmxError(TMX_ERR_VALUE);
+        return 0;
+    }
+
+    *cells = animator->cells;
+    return animator->cellCount;
+}
+
+size_t
+tmxAnimatorAdvance(TMXanimator *animator, double milliseconds, const TMXanimcell **changes)
+{
+    if (!animator || !changes)
+    {
+        tmxError(TMX_ERR_VALUE);
+        return 0;
+    }
+
+    size_t count = 0;
+    *changes     = animator->changes;
+    if (milliseconds > 0.0)
+        animator->time += milliseconds;
+
+    // Each group at the top of the queue moves to the frame displayed at the current time and is sifted back down, so
+    // only the groups with at least one elapsed frame are visited.
+    while (animator->queueCount && animator->groups[animator->queue[0]].end <= animator->time)
+    {
+        TMXanimgroup *group           = &animator->groups[animator->queue[0]];
+        const TMXanimation *animation = group->animation;
+        TMXtid previous               = animation->frames[group->frame].id;
+
+        if (animator->time - group->end >= group->period)
+            group->end += floor((animator->time - group->end) / group->period) * group->period;
+        while (group->end <= animator->time)
+        {
+            group->frame = (group->frame + 1) % animation->count;
+            group->end += animation->frames[group->frame].duration;
+        }
+
+        if (animation->frames[group->frame].id != previous)
+        {
+            tmxAnimatorApply(animator, group);
+            memcpy(&animator->changes[count], &animator->cells[group->first], group->count * sizeof(TMXanimcell));
+            count += group->count;
+        }
+        tmxAnimatorSiftDown(animator, 0);
+    }
+
+    return count;
+}
+
+void
+tmxAnimatorReset(TMXanimator *animator)
+{
+    if (!animator)
+    {
+        tmxError(TMX_ERR_VALUE);
+        return;
+    }
+
+    size_t i;
+    animator->time       = 0.0;
+    animator->queueCount = 0;
+    for (i = 0; i < animator->groupCount; i++)
+    {
+        TMXanimgroup *group = &animator->groups[i];
+        group->frame        = 0;
+        group->end          = group->animation->frames[0].duration;
+        tmxAnimatorApply(animator, group);
+
+        // Animations with a single frame, or without any duration, never change.
+        if (group->animation->count > 1 && group->period > 0)
+            animator->queue[animator->queueCount++] = i;
+    }
+
+    for (i = animator->queueCount / 2; i-- > 0;)
+        tmxAnimatorSiftDown(animator, i);
+}
+
+void
+tmxFreeAnimator(TMXanimator *animator)
+{
+    if (!animator)
+        return;
+
+    tmxFree(animator->groups);
+    tmxFree(animator->queue);
+    tmxFree(animator->cells);
+    tmxFree(animator->changes);
+    tmxFree(animator);
+}
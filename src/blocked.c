@@ -0,0 +1,432 @@
+#include "tmx/blocked.h"
+#include "internal.h"
+#include <string.h>
+
+struct TMXblocked
+{
+    TMXrect region;          /** The cells of the layout, in tile units. */
+    TMX_BLOCKED_ORDER order; /** The order of the cells within each block. */
+    int shift;               /** The base-2 logarithm of the width and height of each block. */
+    int columns;             /** The number of blocks in each row of blocks. */
+    int rows;                /** The number of rows of blocks. */
+    TMXgid *gids;            /** The cells of each block, with the blocks in row-major order and padded to full blocks. */
+};
+
+/**
+ * @brief Spreads the bits of a column or row within a block apart, so that the bits of the other can be interleaved.
+ */
+static TMX_INLINE uint32_t
+tmxBlockedSpread(uint32_t value)
+{
+    value = (value | (value << 4)) & 0x0F0FU;
+    value = (value | (value << 2)) & 0x3333U;
+    value = (value | (value << 1)) & 0x5555U;
+    return value;
+}
+
+/**
+ * @brief Computes the index of a cell within its block.
+ */
+static TMX_INLINE size_t
+tmxBlockedOffset(const TMXblocked *blocked, uint32_t x, uint32_t y)
+{
+    if (blocked->order == TMX_BLOCKED_MORTON)
+        return tmxBlockedSpread(x) | (tmxBlockedSpread(y) << 1);
+    return ((size_t) y << blocked->shift) | x;
+}
+
+/**
+ * @brief Computes the index of the first cell of the block containing a cell, from its column and row relative to the
+ * region.
+ */
+static TMX_INLINE size_t
+tmxBlockedBase(const TMXblocked *blocked, uint32_t cx, uint32_t cy)
+{
+    size_t block = (size_t) (cy >> blocked->shift) * (size_t) blocked->columns + (cx >> blocked->shift);
+    return block << (2 * blocked->shift);
+}
+
+static TMX_INLINE size_t
+tmxBlockedIndex(const TMXblocked *blocked, uint32_t cx, uint32_t cy)
+{
+    uint32_t mask = ((uint32_t) 1 << blocked->shift) - 1;
+    return tmxBlockedBase(blocked, cx, cy) + tmxBlockedOffset(blocked, cx & mask, cy & mask);
+}
+
+/**
+ * @brief Converts a cell to its column and row relative to the region, when it is within the layout.
+ */
+static TMX_INLINE TMX_BOOL
+tmxBlockedLocate(const TMXblocked *blocked, int x, int y, uint32_t *cx, uint32_t *cy)
+{
+    // Cells left of or above the region wrap around to large unsigned values, so a single comparison checks both sides.
+    *cx = (uint32_t) x - (uint32_t) blocked->region.x;
+    *cy = (uint32_t) y - (uint32_t) blocked->region.y;
+    return *cx < (uint32_t) blocked->region.w && *cy < (uint32_t) blocked->region.h;
+}
+
+/**
+ * @brief Copies a span of cells along a row, which must be within the layout, into an array of GIDs. Spans are copied one
+ * block at a time, and the rows of blocks in row-major order are copied whole.
+ */
+static void
+tmxBlockedRead(const TMXblocked *blocked, uint32_t cx, uint32_t cy, size_t count, TMXgid *output)
+{
+    uint32_t size = (uint32_t) 1 << blocked->shift, mask = size - 1;
+    size_t i, n;
+
+    for (; count; count -= n, cx += (uint32_t) n, output += n)
+    {
+        const TMXgid *block = blocked->gids + tmxBlockedBase(blocked, cx, cy);
+        n                   = TMX_MIN(count, (size_t) (size - (cx & mask)));
+        if (blocked->order == TMX_BLOCKED_ROWS)
+        {
+            memcpy(output, block + ((size_t) (cy & mask) << blocked->shift) + (cx & mask), n * sizeof(TMXgid));
+            continue;
+        }
+
+        // The bits of the row are the same for every cell of the span, and only those of the column change.
+        const TMXgid *row = block + (tmxBlockedSpread(cy & mask) << 1);
+        for (i = 0; i < n; i++)
+            output[i] = row[tmxBlockedSpread((cx & mask) + (uint32_t) i)];
+    }
+}
+
+/**
+ * @brief Copies an array of GIDs into a span of cells along a row, which must be within the layout.
+ */
+static void
+tmxBlockedWrite(TMXblocked *blocked, uint32_t cx, uint32_t cy, size_t count, const TMXgid *input)
+{
+    uint32_t size = (uint32_t) 1 << blocked->shift, mask = size - 1;
+    size_t i, n;
+
+    for (; count; count -= n, cx += (uint32_t) n, input += n)
+    {
+        TMXgid *block = blocked->gids + tmxBlockedBase(blocked, cx, cy);
+        n             = TMX_MIN(count, (size_t) (size - (cx & mask)));
+        if (blocked->order == TMX_BLOCKED_ROWS)
+        {
+            memcpy(block + ((size_t) (cy & mask) << blocked->shift) + (cx & mask), input, n * sizeof(TMXgid));
+            continue;
+        }
+
+        TMXgid *row = block + (tmxBlockedSpread(cy & mask) << 1);
+        for (i = 0; i < n; i++)
+            row[tmxBlockedSpread((cx & mask) + (uint32_t) i)] = input[i];
+    }
+}
+
+static TMXblocked *
+tmxBlockedAlloc(TMXrect region, int size, TMX_BLOCKED_ORDER order)
+{
+    if (region.w < 0 || region.h < 0 || size < TMX_BLOCKED_MIN_BLOCK || size > TMX_BLOCKED_MAX_BLOCK || (size & (size - 1)))
+    {
+        tmxErrorMessage(TMX_ERR_PARAM, "Block size must be a power of two from TMX_BLOCKED_MIN_BLOCK to TMX_BLOCKED_MAX_BLOCK.");
+        return NULL;
+    }
+    if (order != TMX_BLOCKED_ROWS && order != TMX_BLOCKED_MORTON)
+    {
+        tmxErrorMessage(TMX_ERR_PARAM, "Invalid order of the cells of a block.");
+        return NULL;
+    }
+
+    TMXblocked *blocked = TMX_ALLOC(TMXblocked);
+    if (!blocked)
+        return NULL;
+
+    blocked->region = region;
+    blocked->order  = order;
+    for (blocked->shift = 0; (1 << blocked->shift) < size; blocked->shift++)
+        ;
+    blocked->columns = (int) (((int64_t) region.w + size - 1) >> blocked->shift);
+    blocked->rows    = (int) (((int64_t) region.h + size - 1) >> blocked->shift);
+
+    // The padding of the blocks along the edges is empty, and is never written.
+    size_t cells  = ((size_t) blocked->columns * (size_t) blocked->rows) << (2 * blocked->shift);
+    blocked->gids = tmxMallocCategory(TMX_MAX(cells, 1) * sizeof(TMXgid), TMX_MEMORY_TILES);
+    if (!blocked->gids)
+    {
+        tmxFree(blocked);
+        return NULL;
+    }
+    memset(blocked->gids, 0, TMX_MAX(cells, 1) * sizeof(TMXgid));
+    return blocked;
+}
+
+TMXblocked *
+tmxBlockedCreateGrid(const TMXgid *gids, TMXrect region, int size, TMX_BLOCKED_ORDER order)
+{
+    int bx, by, y;
+    if (!gids && region.w > 0 && region.h > 0)
+    {
+        tmxError(TMX_ERR_VALUE);
+        return NULL;
+    }
+
+    TMXblocked *blocked = tmxBlockedAlloc(region, size, order);
+    if (!blocked)
+        return NULL;
+
+    // Each block is filled in turn, so that the storage is written in order.
+    for (by = 0; by < blocked->rows; by++)
+    {
+        int top    = by << blocked->shift;
+        int bottom = (int) TMX_MIN((int64_t) top + size, (int64_t) region.h);
+        for (bx = 0; bx < blocked->columns; bx++)
+        {
+            int left = bx << blocked->shift;
+            size_t n = (size_t) TMX_MIN((int64_t) size, (int64_t) region.w - left);
+            for (y = top; y < bottom; y++)
+                tmxBlockedWrite(blocked, (uint32_t) left, (uint32_t) y, n, gids + (size_t) y * (size_t) region.w + left);
+        }
+    }
+    return blocked;
+}
+
+TMXblocked *
+tmxBlockedCreate(const TMXlayer *layer, int size, TMX_BLOCKED_ORDER order)
+{
+    size_t i;
+    int y;
+
+    if (!layer)
+    {
+        tmxError(TMX_ERR_VALUE);
+        return NULL;
+    }
+    if (layer->type != TMX_LAYER_TILE && layer->type != TMX_LAYER_CHUNK)
+    {
+        tmxErrorMessage(TMX_ERR_PARAM, "Blocked layouts can only be created from tile layers.");
+        return NULL;
+    }
+    if (layer->type == TMX_LAYER_TILE && layer->data.tiles)
+    {
+        TMXrect region = {.x = 0, .y = 0, .w = layer->size.w, .h = layer->size.h};
+        return tmxBlockedCreateGrid(layer->data.tiles, region, size, order);
+    }
+
+    // The cells of infinite layers are copied from each chunk into a layout covering all of them.
+    TMXrect region = {.x = 0, .y = 0, .w = layer->size.w, .h = layer->size.h};
+    if (layer->type == TMX_LAYER_CHUNK)
+        region = tmxLayerChunkBounds(layer);
+
+    TMXblocked *blocked = tmxBlockedAlloc(region, size, order);
+    if (!blocked)
+        return NULL;
+
+    for (i = 0; layer->type == TMX_LAYER_CHUNK && i < layer->count; i++)
+    {
+        const TMXchunk *chunk = &layer->data.chunks[i];
+        for (y = 0; chunk->gids && y < chunk->bounds.h; y++)
+        {
+            tmxBlockedWrite(blocked, (uint32_t) (chunk->bounds.x - region.x), (uint32_t) (chunk->bounds.y - region.y + y),
+                            (size_t) chunk->bounds.w, chunk->gids + (size_t) y * (size_t) chunk->bounds.w);
+        }
+    }
+    return blocked;
+}
+
+TMXrect
+tmxBlockedRegion(const TMXblocked *blocked)
+{
+    TMXrect region = {0};
+    if (!blocked)
+    {
+        tmxError(TMX_ERR_VALUE);
+        return region;
+    }
+    return blocked->region;
+}
+
+TMXgid
+tmxBlockedGet(const TMXblocked *blocked, int x, int y)
+{
+    uint32_t cx, cy;
+    if (!blocked)
+    {
+        tmxError(TMX_ERR_VALUE);
+        return 0;
+    }
+    if (!tmxBlockedLocate(blocked, x, y, &cx, &cy))
+        return 0;
+    return blocked->gids[tmxBlockedIndex(blocked, cx, cy)];
+}
+
+void
+tmxBlockedNeighborhood(const TMXblocked *blocked, int x, int y, TMXgid output[9])
+{
+    uint32_t cx, cy, mask, lx, ly;
+    int dx, dy;
+    if (!blocked || !output)
+    {
+        tmxError(TMX_ERR_VALUE);
+        return;
+    }
+
+    // The neighbors of a cell away from the edges of its block are in the same block. Those past the right or bottom edge
+    // of the layout are in the padding, which is empty.
+    mask = ((uint32_t) 1 << blocked->shift) - 1;
+    if (!tmxBlockedLocate(blocked, x, y, &cx, &cy) || !(cx & mask) || (cx & mask) == mask || !(cy & mask) || (cy & mask) == mask)
+    {
+        for (dy = 0; dy < 3; dy++)
+        {
+            for (dx = 0; dx < 3; dx++)
+            {
+                uint32_t nx = cx + (uint32_t) dx - 1, ny = cy + (uint32_t) dy - 1;
+                TMX_BOOL inside = nx < (uint32_t) blocked->region.w && ny < (uint32_t) blocked->region.h;
+                output[dy * 3 + dx] = inside ? blocked->gids[tmxBlockedIndex(blocked, nx, ny)] : 0;
+            }
+        }
+        return;
+    }
+
+    lx = cx & mask;
+    ly = cy & mask;
+    if (blocked->order == TMX_BLOCKED_ROWS)
+    {
+        const TMXgid *center = blocked->gids + tmxBlockedIndex(blocked, cx, cy);
+        size_t stride        = (size_t) 1 << blocked->shift;
+        memcpy(output, center - stride - 1, 3 * sizeof(TMXgid));
+        memcpy(output + 3, center - 1, 3 * sizeof(TMXgid));
+        memcpy(output + 6, center + stride - 1, 3 * sizeof(TMXgid));
+        return;
+    }
+
+    const TMXgid *block = blocked->gids + tmxBlockedBase(blocked, cx, cy);
+    uint32_t columns[3] = {tmxBlockedSpread(lx - 1), tmxBlockedSpread(lx), tmxBlockedSpread(lx + 1)};
+    for (dy = 0; dy < 3; dy++)
+    {
+        uint32_t row = tmxBlockedSpread(ly + (uint32_t) dy - 1) << 1;
+        for (dx = 0; dx < 3; dx++)
+            output[dy * 3 + dx] = block[row | columns[dx]];
+    }
+}
+
+const TMXgid *
+tmxBlockedSpan(const TMXblocked *blocked, int x, int y, size_t *count)
+{
+    uint32_t cx, cy;
+    if (!blocked || !count)
+    {
+        tmxError(TMX_ERR_VALUE);
+        return NULL;
+    }
+    if (!tmxBlockedLocate(blocked, x, y, &cx, &cy))
+    {
+        *count = 0;
+        return NULL;
+    }
+
+    uint32_t mask = ((uint32_t) 1 << blocked->shift) - 1;
+    uint32_t run  = blocked->order == TMX_BLOCKED_ROWS ? mask + 1 - (cx & mask) : 2 - (cx & 1);
+    *count        = TMX_MIN((size_t) run, (size_t) blocked->region.w - cx);
+    return blocked->gids + tmxBlockedIndex(blocked, cx, cy);
+}
+
+void
+tmxBlockedDecode(const TMXblocked *blocked, int x, int y, size_t count, TMXgid *output)
+{
+    if (!blocked || (!output && count))
+    {
+        tmxError(TMX_ERR_VALUE);
+        return;
+    }
+
+    // Cells outside of the layout are empty, and the rest are copied one block at a time.
+    int64_t cx = (int64_t) x - blocked->region.x, cy = (int64_t) y - blocked->region.y;
+    int64_t first = TMX_MIN(TMX_MAX(-cx, 0), (int64_t) count);
+    int64_t last  = TMX_MAX(TMX_MIN((int64_t) blocked->region.w - cx, (int64_t) count), first);
+    if (cy < 0 || cy >= blocked->region.h)
+        first = last = (int64_t) count;
+
+    memset(output, 0, (size_t) first * sizeof(TMXgid));
+    memset(output + last, 0, (count - (size_t) last) * sizeof(TMXgid));
+    if (first < last)
+        tmxBlockedRead(blocked, (uint32_t) (cx + first), (uint32_t) cy, (size_t) (last - first), output + first);
+}
+
+void
+tmxBlockedToGrid(const TMXblocked *blocked, TMXgid *output)
+{
+    int bx, by, y;
+    if (!blocked || (!output && blocked->region.w && blocked->region.h))
+    {
+        tmxError(TMX_ERR_VALUE);
+        return;
+    }
+
+    // Each block is copied in turn, so that the storage is read in order.
+    int size = 1 << blocked->shift;
+    for (by = 0; by < blocked->rows; by++)
+    {
+        int top    = by << blocked->shift;
+        int bottom = (int) TMX_MIN((int64_t) top + size, (int64_t) blocked->region.h);
+        for (bx = 0; bx < blocked->columns; bx++)
+        {
+            int left = bx << blocked->shift;
+            size_t n = (size_t) TMX_MIN((int64_t) size, (int64_t) blocked->region.w - left);
+            for (y = top; y < bottom; y++)
+                tmxBlockedRead(blocked, (uint32_t) left, (uint32_t) y, n, output + (size_t) y * (size_t) blocked->region.w + left);
+        }
+    }
+}
+
+TMX_BOOL
+tmxBlockedSet(TMXblocked *blocked, int x, int y, TMXgid gid)
+{
+    uint32_t cx, cy;
+    if (!blocked)
+    {
+        tmxError(TMX_ERR_VALUE);
+        return TMX_FALSE;
+    }
+    if (!tmxBlockedLocate(blocked, x, y, &cx, &cy))
+    {
+        tmxErrorMessage(TMX_ERR_PARAM, "Cell is outside of the blocked layout.");
+        return TMX_FALSE;
+    }
+    blocked->gids[tmxBlockedIndex(blocked, cx, cy)] = gid;
+    return TMX_TRUE;
+}
+
+TMX_BOOL
+tmxBlockedEncode(TMXblocked *blocked, int x, int y, size_t count, const TMXgid *gids)
+{
+    uint32_t cx, cy;
+    if (!blocked || (!gids && count))
+    {
+        tmxError(TMX_ERR_VALUE);
+        return TMX_FALSE;
+    }
+    if (!count)
+        return TMX_TRUE;
+    if (!tmxBlockedLocate(blocked, x, y, &cx, &cy) || count > (size_t) blocked->region.w - cx)
+    {
+        tmxErrorMessage(TMX_ERR_PARAM, "Span is outside of the blocked layout.");
+        return TMX_FALSE;
+    }
+
+    tmxBlockedWrite(blocked, cx, cy, count, gids);
+    return TMX_TRUE;
+}
+
+size_t
+tmxBlockedMemory(const TMXblocked *blocked)
+{
+    if (!blocked)
+    {
+        tmxError(TMX_ERR_VALUE);
+        return 0;
+    }
+    return sizeof(TMXblocked) + TMX_MAX(((size_t) blocked->columns * (size_t) blocked->rows) << (2 * blocked->shift), 1) * sizeof(TMXgid);
+}
+
+void
+tmxFreeBlocked(TMXblocked *blocked)
+{
+    if (!blocked)
+        return;
+    tmxFree(blocked->gids);
+    tmxFree(blocked);
+}
@@ -0,0 +1,783 @@
+#include "tmx/colliders.h"
+#include "internal.h"
+#include <limits.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief The distance in pixel units within which edges are considered to touch, and coordinates equal.
+ */
+#define TMX_COLLIDER_EPSILON 1e-3f
+
+/**
+ * @brief The number of points used to approximate rotated ellipses as polygons.
+ */
+#define TMX_COLLIDER_ELLIPSE_POINTS 16
+
+#define TMX_COLLIDER_PI 3.14159265358979323846
+
+typedef struct TMXcolliderrect
+{
+    float x0, y0, x1, y1;
+} TMXcolliderrect;
+
+/**
+ * @brief The placement of a tile within its cell, mapping tile-local positions to the map.
+ */
+typedef struct TMXcolliderplace
+{
+    float left;        /** The left edge of the drawn tile. */
+    float top;         /** The top edge of the drawn tile. */
+    float width;       /** The drawn width of the tile, after a diagonal flip. */
+    float height;      /** The drawn height of the tile, after a diagonal flip. */
+    float imageWidth;  /** The width of the tile in its image, which tile-local positions are relative to. */
+    float imageHeight; /** The height of the tile in its image. */
+    TMX_BOOL flipH;
+    TMX_BOOL flipV;
+    TMX_BOOL diagonal;
+    int degrees;       /** The clockwise rotation around the center of the tile on hexagonal maps. */
+} TMXcolliderplace;
+
+typedef struct TMXcolliderbaker
+{
+    const TMXmap *map;
+    TMXgrid grid;
+    TMXcolliders *colliders;
+    TMX_BOOL hexagonal;
+    TMX_BOOL failed;           /** Indicates memory could not be allocated. */
+    TMXcolliderrect *rects;    /** The axis-aligned rectangles, which are merged before being added as colliders. */
+    size_t rectCount;
+    size_t rectCapacity;
+    TMXgid first;              /** The first GID of the most recently used tileset. */
+    TMXgid end;                /** The GID past the last of the most recently used tileset, or 0 when none is cached. */
+    const TMXtileset *tileset; /** The most recently used tileset. */
+} TMXcolliderbaker;
+
+#pragma region Storage
+
+TMXcolliders *
+tmxCollidersCreate(void)
+{
+    return TMX_ALLOC(TMXcolliders);
+}
+
+void
+tmxFreeColliders(TMXcolliders *colliders)
+{
+    if (!colliders)
+        return;
+
+    tmxFree(colliders->colliders);
+    tmxFree(colliders->outlines);
+    tmxFree(colliders->points);
+    tmxFree(colliders);
+}
+
+/**
+ * @brief Ensures an array has room for at least @a count elements, doubling its capacity as needed.
+ */
+static TMX_BOOL
+tmxCollidersGrow(void **array, size_t *capacity, size_t count, size_t size)
+{
+    if (count <= *capacity)
+        return TMX_TRUE;
+
+    size_t grown = TMX_MAX(count, TMX_MAX(*capacity * 2, 16));
+    void *result = tmxRealloc(*array, grown * size);
+    if (!result)
+        return TMX_FALSE;
+
+    *array    = result;
+    *capacity = grown;
+    return TMX_TRUE;
+}
+
+static TMXcollider *
+tmxCollidersPush(TMXcolliderbaker *baker, TMX_OBJECT_TYPE type, size_t points)
+{
+    TMXcolliders *colliders = baker->colliders;
+    if (!tmxCollidersGrow((void **) &colliders->colliders, &colliders->capacity, colliders->count + 1, sizeof(TMXcollider)) ||
+        !tmxCollidersGrow((void **) &colliders->points, &colliders->point_capacity, colliders->point_count + points, sizeof(TMXvec2)))
+    {
+        baker->failed = TMX_TRUE;
+        return NULL;
+    }
+
+    TMXcollider *collider = &colliders->colliders[colliders->count++];
+    memset(collider, 0, sizeof(TMXcollider));
+    collider->type  = type;
+    collider->first = colliders->point_count;
+    collider->count = points;
+    colliders->point_count += points;
+    return collider;
+}
+
+static void
+tmxCollidersPushRect(TMXcolliderbaker *baker, TMXvec2 a, TMXvec2 b)
+{
+    if (!tmxCollidersGrow((void **) &baker->rects, &baker->rectCapacity, baker->rectCount + 1, sizeof(TMXcolliderrect)))
+    {
+        baker->failed = TMX_TRUE;
+        return;
+    }
+
+    TMXcolliderrect *rect = &baker->rects[baker->rectCount++];
+    rect->x0              = TMX_MIN(a.x, b.x);
+    rect->y0              = TMX_MIN(a.y, b.y);
+    rect->x1              = TMX_MAX(a.x, b.x);
+    rect->y1              = TMX_MAX(a.y, b.y);
+}
+
+/**
+ * @brief Computes the bounding rectangle of the points of a collider.
+ */
+static void
+tmxCollidersBound(const TMXcolliders *colliders, TMXcollider *collider)
+{
+    const TMXvec2 *points = &colliders->points[collider->first];
+    TMXvec2 min = points[0], max = points[0];
+    size_t i;
+
+    for (i = 1; i < collider->count; i++)
+    {
+        min.x = TMX_MIN(min.x, points[i].x);
+        min.y = TMX_MIN(min.y, points[i].y);
+        max.x = TMX_MAX(max.x, points[i].x);
+        max.y = TMX_MAX(max.y, points[i].y);
+    }
+    collider->position = min;
+    collider->size.x   = max.x - min.x;
+    collider->size.y   = max.y - min.y;
+}
+
+#pragma endregion
+
+#pragma region Placement
+
+/**
+ * @brief Maps a position relative to the top-left of a tile in its image to the map.
+ */
+static TMXvec2
+tmxColliderPlace(const TMXcolliderplace *place, float x, float y)
+{
+    float u = x / place->imageWidth;
+    float v = y / place->imageHeight;
+    if (place->diagonal)
+    {
+        float swap = u;
+        u          = v;
+        v          = swap;
+    }
+    if (place->flipH)
+        u = 1.0f - u;
+    if (place->flipV)
+        v = 1.0f - v;
+
+    TMXvec2 result = {place->left + u * place->width, place->top + v * place->height};
+    if (place->degrees)
+    {
+        // Rotations are multiples of 60 degrees, clockwise with the y-axis pointing down, as in the quad baker.
+        static const float cosines[6] = {1.0f, 0.5f, -0.5f, -1.0f, -0.5f, 0.5f};
+        static const float sines[6]   = {0.0f, 0.8660254f, 0.8660254f, 0.0f, -0.8660254f, -0.8660254f};
+
+        int step = (place->degrees / 60) % 6;
+        float cx = place->left + place->width * 0.5f;
+        float cy = place->top + place->height * 0.5f;
+        float dx = result.x - cx;
+        float dy = result.y - cy;
+        result.x = cx + dx * cosines[step] - dy * sines[step];
+        result.y = cy + dx * sines[step] + dy * cosines[step];
+    }
+    return result;
+}
+
+/**
+ * @brief Maps a point of an object, relative to its position and before its rotation, to the map.
+ */
+static TMXvec2
+tmxColliderObjectPoint(const TMXcolliderplace *place, const TMXobject *object, float x, float y, float cosine, float sine)
+{
+    return tmxColliderPlace(place, object->position.x + x * cosine - y * sine, object->position.y + x * sine + y * cosine);
+}
+
+static void
+tmxColliderObject(TMXcolliderbaker *baker, const TMXcolliderplace *place, const TMXobject *object)
+{
+    float radians        = object->rotation * (float) (TMX_COLLIDER_PI / 180.0);
+    float cosine         = object->rotation != 0.0f ? cosf(radians) : 1.0f;
+    float sine           = object->rotation != 0.0f ? sinf(radians) : 0.0f;
+    TMX_BOOL axisAligned = object->rotation == 0.0f && !place->degrees;
+    TMXcollider *collider;
+    size_t i;
+
+    switch (object->type)
+    {
+        case TMX_OBJECT_RECT:
+            if (object->size.x <= 0.0f || object->size.y <= 0.0f)
+                return;
+            if (axisAligned)
+            {
+                tmxCollidersPushRect(baker, tmxColliderPlace(place, object->position.x, object->position.y),
+                                     tmxColliderPlace(place, object->position.x + object->size.x, object->position.y + object->size.y));
+                return;
+            }
+            if (!(collider = tmxCollidersPush(baker, TMX_OBJECT_POLYGON, 4)))
+                return;
+            for (i = 0; i < 4; i++)
+            {
+                float x = (i == 1 || i == 2) ? object->size.x : 0.0f;
+                float y = (i >= 2) ? object->size.y : 0.0f;
+                baker->colliders->points[collider->first + i] = tmxColliderObjectPoint(place, object, x, y, cosine, sine);
+            }
+            break;
+        case TMX_OBJECT_ELLIPSE:
+            if (object->size.x <= 0.0f || object->size.y <= 0.0f)
+                return;
+            if (axisAligned)
+            {
+                TMXvec2 a = tmxColliderPlace(place, object->position.x, object->position.y);
+                TMXvec2 b = tmxColliderPlace(place, object->position.x + object->size.x, object->position.y + object->size.y);
+                if (!(collider = tmxCollidersPush(baker, TMX_OBJECT_ELLIPSE, 0)))
+                    return;
+                collider->position.x = TMX_MIN(a.x, b.x);
+                collider->position.y = TMX_MIN(a.y, b.y);
+                collider->size.x     = fabsf(b.x - a.x);
+                collider->size.y     = fabsf(b.y - a.y);
+                return;
+            }
+            if (!(collider = tmxCollidersPush(baker, TMX_OBJECT_POLYGON, TMX_COLLIDER_ELLIPSE_POINTS)))
+                return;
+            for (i = 0; i < TMX_COLLIDER_ELLIPSE_POINTS; i++)
+            {
+                float angle = (float) i * (float) (2.0 * TMX_COLLIDER_PI / TMX_COLLIDER_ELLIPSE_POINTS);
+                float x     = object->size.x * 0.5f * (1.0f + cosf(angle));
+                float y     = object->size.y * 0.5f * (1.0f + sinf(angle));
+                baker->colliders->points[collider->first + i] = tmxColliderObjectPoint(place, object, x, y, cosine, sine);
+            }
+            break;
+        case TMX_OBJECT_POLYGON:
+        case TMX_OBJECT_POLYLINE:
+            if (object->poly.count < 2 || !object->poly.points)
+                return;
+            if (!(collider = tmxCollidersPush(baker, object->type, object->poly.count)))
+                return;
+            for (i = 0; i < object->poly.count; i++)
+            {
+                TMXvec2 point                                 = object->poly.points[i];
+                baker->colliders->points[collider->first + i] = tmxColliderObjectPoint(place, object, point.x, point.y, cosine, sine);
+            }
+            break;
+        default:
+            return;
+    }
+    tmxCollidersBound(baker->colliders, collider);
+}
+
+static TMX_INLINE const TMXtileset *
+tmxColliderTileset(TMXcolliderbaker *baker, TMXgid gid, TMXtid *id)
+{
+    // Neighboring cells mostly use the same tileset, so the range of the last one is checked before searching.
+    if (gid >= baker->first && gid < baker->end)
+    {
+        *id = gid - baker->first;
+        return baker->tileset;
+    }
+
+    const TMXtileset *tileset = tmxMapTileset(baker->map, gid, id);
+    if (!tileset || !tileset->rects)
+        return NULL;
+
+    baker->tileset = tileset;
+    baker->first   = gid - *id;
+    baker->end     = baker->first + (TMXgid) tileset->rects->count;
+    return tileset;
+}
+
+static void
+tmxColliderCell(TMXcolliderbaker *baker, int x, int y, TMXgid gid)
+{
+    TMXtid id;
+    TMXgid clean = gid & TMX_GID_TILE_MASK;
+    if (!clean)
+        return;
+
+    const TMXtileset *tileset = tmxColliderTileset(baker, clean, &id);
+    if (!tileset)
+        return;
+
+    const TMXtile *tile = tmxTilesetTile(tileset, id);
+    if (!tile || !tile->collision.count || !tileset->rects->width[id] || !tileset->rects->height[id])
+        return;
+
+    // The tile is placed as by the quad baker: aligned to the bottom-left corner of the bounding rectangle of its cell.
+    TMXcolliderplace place;
+    TMXvec2 cell      = tmxGridCellOrigin(&baker->grid, x, y);
+    place.imageWidth  = (float) tileset->rects->width[id];
+    place.imageHeight = (float) tileset->rects->height[id];
+    place.width       = place.imageWidth;
+    place.height      = place.imageHeight;
+    place.left        = cell.x + (float) tileset->offset.x;
+    float bottom      = cell.y + baker->grid.tileHeight + (float) tileset->offset.y;
+
+    if (tileset->render_size == TMX_RENDER_SIZE_GRID)
+    {
+        float scaleX = baker->grid.tileWidth / place.width;
+        float scaleY = baker->grid.tileHeight / place.height;
+        if (tileset->fill_mode == TMX_FILL_MODE_PRESERVE)
+        {
+            float scale = TMX_MIN(scaleX, scaleY);
+            place.left += (baker->grid.tileWidth - place.width * scale) * 0.5f;
+            bottom -= (baker->grid.tileHeight - place.height * scale) * 0.5f;
+            scaleX = scaleY = scale;
+        }
+        place.width *= scaleX;
+        place.height *= scaleY;
+    }
+
+    place.flipH    = TMX_HAS_FLAG(gid, TMX_GID_FLIP_HORIZONTAL);
+    place.flipV    = TMX_HAS_FLAG(gid, TMX_GID_FLIP_VERTICAL);
+    place.diagonal = TMX_HAS_FLAG(gid, TMX_GID_FLIP_DIAGONAL) && !baker->hexagonal;
+    place.degrees  = 0;
+    if (place.diagonal)
+    {
+        float swap   = place.width;
+        place.width  = place.height;
+        place.height = swap;
+    }
+    if (baker->hexagonal)
+        place.degrees = (TMX_HAS_FLAG(gid, TMX_GID_FLIP_DIAGONAL) ? 60 : 0) + (TMX_HAS_FLAG(gid, TMX_GID_ROTATE_120) ? 120 : 0);
+    place.top = bottom - place.height;
+
+    size_t i;
+    for (i = 0; i < tile->collision.count; i++)
+        tmxColliderObject(baker, &place, tile->collision.objects[i]);
+}
+
+#pragma endregion
+
+#pragma region Merging
+
+static int
+tmxCompareRows(const void *a, const void *b)
+{
+    const TMXcolliderrect *r1 = a, *r2 = b;
+    if (r1->y0 != r2->y0)
+        return r1->y0 < r2->y0 ? -1 : 1;
+    if (r1->y1 != r2->y1)
+        return r1->y1 < r2->y1 ? -1 : 1;
+    if (r1->x0 != r2->x0)
+        return r1->x0 < r2->x0 ? -1 : 1;
+    return 0;
+}
+
+static int
+tmxCompareColumns(const void *a, const void *b)
+{
+    const TMXcolliderrect *r1 = a, *r2 = b;
+    if (r1->x0 != r2->x0)
+        return r1->x0 < r2->x0 ? -1 : 1;
+    if (r1->x1 != r2->x1)
+        return r1->x1 < r2->x1 ? -1 : 1;
+    if (r1->y0 != r2->y0)
+        return r1->y0 < r2->y0 ? -1 : 1;
+    return 0;
+}
+
+/**
+ * @brief Merges rectangles spanning the same rows into runs that touch or overlap, then runs spanning the same columns.
+ * @return The number of rectangles remaining.
+ */
+static size_t
+tmxCollidersMerge(TMXcolliderrect *rects, size_t count)
+{
+    size_t i, n;
+    if (count < 2)
+        return count;
+
+    qsort(rects, count, sizeof(TMXcolliderrect), tmxCompareRows);
+    for (i = 1, n = 1; i < count; i++)
+    {
+        TMXcolliderrect *last = &rects[n - 1];
+        if (rects[i].y0 == last->y0 && rects[i].y1 == last->y1 && rects[i].x0 <= last->x1 + TMX_COLLIDER_EPSILON)
+            last->x1 = TMX_MAX(last->x1, rects[i].x1);
+        else
+            rects[n++] = rects[i];
+    }
+
+    count = n;
+    qsort(rects, count, sizeof(TMXcolliderrect), tmxCompareColumns);
+    for (i = 1, n = 1; i < count; i++)
+    {
+        TMXcolliderrect *last = &rects[n - 1];
+        if (rects[i].x0 == last->x0 && rects[i].x1 == last->x1 && rects[i].y0 <= last->y1 + TMX_COLLIDER_EPSILON)
+            last->y1 = TMX_MAX(last->y1, rects[i].y1);
+        else
+            rects[n++] = rects[i];
+    }
+    return n;
+}
+
+#pragma endregion
+
+#pragma region Outlines
+
+static int
+tmxCompareFloats(const void *a, const void *b)
+{
+    float f1 = *(const float *) a, f2 = *(const float *) b;
+    return f1 < f2 ? -1 : (f1 > f2 ? 1 : 0);
+}
+
+/**
+ * @brief Sorts coordinates and removes those within the epsilon of the previous one.
+ * @return The number of distinct coordinates.
+ */
+static size_t
+tmxOutlineCoords(float *coords, size_t count)
+{
+    size_t i, n = 1;
+    qsort(coords, count, sizeof(float), tmxCompareFloats);
+    for (i = 1; i < count; i++)
+    {
+        if (coords[i] > coords[n - 1] + TMX_COLLIDER_EPSILON)
+            coords[n++] = coords[i];
+    }
+    return n;
+}
+
+static size_t
+tmxOutlineIndex(const float *coords, size_t count, float value)
+{
+    size_t low = 0, high = count;
+    while (low < high)
+    {
+        size_t mid = low + (high - low) / 2;
+        if (coords[mid] < value - TMX_COLLIDER_EPSILON)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    return TMX_MIN(low, count - 1);
+}
+
+/**
+ * @brief The directions of the edges leaving a vertex of the outline grid, in clockwise order with the y-axis down.
+ */
+enum
+{
+    TMX_OUTLINE_RIGHT = 0,
+    TMX_OUTLINE_DOWN  = 1,
+    TMX_OUTLINE_LEFT  = 2,
+    TMX_OUTLINE_UP    = 3
+};
+
+/**
+ * @brief Traces the outlines of the area covered by a set of rectangles.
+ *
+ * @details The distinct edges of the rectangles divide the area into a grid of cells, each either covered or not. The
+ * edges between covered and uncovered cells are directed to keep the covered cell on their right, and followed from
+ * vertex to vertex, preferring to turn right so that cells touching only at a corner are kept apart.
+ */
+static TMX_BOOL
+tmxCollidersTrace(TMXcolliders *colliders, const TMXcolliderrect *rects, size_t count)
+{
+    static const int steps[4][2] = {{1, 0}, {0, 1}, {-1, 0}, {0, -1}};
+    size_t i, k, nx, ny;
+    int x, y;
+
+    if (!count)
+        return TMX_TRUE;
+
+    float *xs = tmxMallocCategory(count * 4 * sizeof(float), TMX_MEMORY_TEMPORARY);
+    if (!xs)
+        return TMX_FALSE;
+    float *ys = xs + count * 2;
+    for (i = 0; i < count; i++)
+    {
+        xs[i * 2]     = rects[i].x0;
+        xs[i * 2 + 1] = rects[i].x1;
+        ys[i * 2]     = rects[i].y0;
+        ys[i * 2 + 1] = rects[i].y1;
+    }
+    nx = tmxOutlineCoords(xs, count * 2);
+    ny = tmxOutlineCoords(ys, count * 2);
+
+    // Cells are padded by one on each side, so that every edge has a cell on both sides.
+    size_t columns    = nx + 1;
+    uint8_t *covered  = tmxCalloc(columns * (ny + 1), 1);
+    uint8_t *outgoing = tmxCalloc(nx * ny, 1);
+    if (!covered || !outgoing)
+    {
+        tmxFree(xs);
+        tmxFree(covered);
+        tmxFree(outgoing);
+        return TMX_FALSE;
+    }
+
+    for (i = 0; i < count; i++)
+    {
+        size_t x0 = tmxOutlineIndex(xs, nx, rects[i].x0), x1 = tmxOutlineIndex(xs, nx, rects[i].x1);
+        size_t y0 = tmxOutlineIndex(ys, ny, rects[i].y0), y1 = tmxOutlineIndex(ys, ny, rects[i].y1);
+        size_t row;
+        for (row = y0; row < y1; row++)
+            memset(&covered[(row + 1) * columns + x0 + 1], 1, x1 - x0);
+    }
+
+#define TMX_COVERED(cx, cy) covered[(size_t) ((cy) + 1) * columns + (size_t) ((cx) + 1)]
+#define TMX_VERTEX(vx, vy)  ((size_t) (vy) * nx + (size_t) (vx))
+
+    for (y = 0; y < (int) ny; y++)
+    {
+        for (x = 0; x < (int) nx; x++)
+        {
+            // The cells to the top-left, top-right, bottom-left, and bottom-right of the vertex.
+            int tl = TMX_COVERED(x - 1, y - 1), tr = TMX_COVERED(x, y - 1);
+            int bl = TMX_COVERED(x - 1, y), br = TMX_COVERED(x, y);
+            uint8_t mask = 0;
+            if (br && !tr)
+                mask |= 1 << TMX_OUTLINE_RIGHT;
+            if (bl && !br)
+                mask |= 1 << TMX_OUTLINE_DOWN;
+            if (tl && !bl)
+                mask |= 1 << TMX_OUTLINE_LEFT;
+            if (tr && !tl)
+                mask |= 1 << TMX_OUTLINE_UP;
+            outgoing[TMX_VERTEX(x, y)] = mask;
+        }
+    }
+
+    TMX_BOOL ok = TMX_TRUE;
+    for (k = 0; k < nx * ny && ok; k++)
+    {
+        while (outgoing[k] && ok)
+        {
+            int startX = (int) (k % nx), startY = (int) (k / nx);
+            int direction = 0, start, turn;
+            while (!(outgoing[k] & (1 << direction)))
+                direction++;
+            start = direction;
+
+            size_t first = colliders->point_count;
+            x            = startX;
+            y            = startY;
+            for (;;)
+            {
+                outgoing[TMX_VERTEX(x, y)] &= (uint8_t) ~(1 << direction);
+                x += steps[direction][0];
+                y += steps[direction][1];
+
+                int next = -1;
+                for (turn = 0; turn < 3 && next < 0; turn++)
+                {
+                    int candidate = (direction + (turn == 0 ? 1 : (turn == 1 ? 0 : 3))) % 4;
+                    if (x == startX && y == startY && candidate == start)
+                        break;
+                    if (outgoing[TMX_VERTEX(x, y)] & (1 << candidate))
+                        next = candidate;
+                }
+
+                // Only the corners of the outline are kept.
+                int turned = next < 0 ? start != direction : next != direction;
+                if (turned)
+                {
+                    if (!tmxCollidersGrow((void **) &colliders->points, &colliders->point_capacity, colliders->point_count + 1,
+                                          sizeof(TMXvec2)))
+                    {
+                        ok = TMX_FALSE;
+                        break;
+                    }
+                    colliders->points[colliders->point_count].x   = xs[x];
+                    colliders->points[colliders->point_count++].y = ys[y];
+                }
+                if (next < 0)
+                    break;
+                direction = next;
+            }
+
+            if (!ok || !tmxCollidersGrow((void **) &colliders->outlines, &colliders->outline_capacity, colliders->outline_count + 1,
+                                         sizeof(TMXoutline)))
+            {
+                ok = TMX_FALSE;
+                break;
+            }
+
+            // Outer outlines have a positive area with the y-axis pointing down, and holes a negative one.
+            const TMXvec2 *points = &colliders->points[first];
+            size_t n              = colliders->point_count - first;
+            double area           = 0.0;
+            for (i = 0; i < n; i++)
+            {
+                const TMXvec2 *a = &points[i], *b = &points[(i + 1) % n];
+                area += (double) a->x * b->y - (double) b->x * a->y;
+            }
+
+            TMXoutline *outline = &colliders->outlines[colliders->outline_count++];
+            outline->first      = first;
+            outline->count      = n;
+            outline->hole       = area < 0.0;
+        }
+    }
+
+#undef TMX_COVERED
+#undef TMX_VERTEX
+
+    tmxFree(xs);
+    tmxFree(covered);
+    tmxFree(outgoing);
+    return ok;
+}
+
+#pragma endregion
+
+static TMXrect
+tmxCollidersIntersect(TMXrect a, TMXrect b)
+{
+    TMXrect result;
+    result.x = TMX_MAX(a.x, b.x);
+    result.y = TMX_MAX(a.y, b.y);
+    result.w = TMX_MIN(a.x + a.w, b.x + b.w) - result.x;
+    result.h = TMX_MIN(a.y + a.h, b.y + b.h) - result.y;
+    if (result.w < 0 || result.h < 0)
+        result.w = result.h = 0;
+    return result;
+}
+
+/**
+ * @brief Bakes the tiles of a rectangular array within a region, skipping the empty blocks of a tile layer when its
+ * @a occupancy pyramid is given.
+ */
+static void
+tmxCollidersCells(TMXcolliderbaker *baker, const TMXgid *gids, TMXrect bounds, const TMXoccupancy *occupancy, TMXrect region)
+{
+    int x, y, end, right = region.x + region.w;
+    for (y = region.y; y < region.y + region.h && !baker->failed; y++)
+    {
+        const TMXgid *row = &gids[(y - bounds.y) * bounds.w];
+        for (x = region.x; x < right; x = end)
+        {
+            end = right;
+            if (occupancy && (x = tmxOccupancyNext(occupancy, x, y, right)) < right)
+                end = tmxOccupancyRunEnd(occupancy, x, y, right);
+            for (; x < end; x++)
+            {
+                if (row[x - bounds.x])
+                    tmxColliderCell(baker, x, y, row[x - bounds.x]);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Bakes the colliders of a layer within a region, optionally limited to a single chunk.
+ *
+ * @param[in] chunk The index of the only chunk to bake, or @c SIZE_MAX to bake every chunk of an infinite layer.
+ */
+static TMX_BOOL
+tmxBakeColliders(const TMXmap *map, const TMXlayer *layer, TMXrect region, size_t chunk, TMXcolliders *colliders)
+{
+    if (!map || !layer || !colliders)
+    {
+        tmxError(TMX_ERR_VALUE);
+        return TMX_FALSE;
+    }
+    if (layer->type != TMX_LAYER_TILE && layer->type != TMX_LAYER_CHUNK)
+    {
+        tmxErrorMessage(TMX_ERR_PARAM, "Only tile layers can be baked.");
+        return TMX_FALSE;
+    }
+    if (layer->type == TMX_LAYER_CHUNK && chunk != SIZE_MAX && chunk >= layer->count)
+    {
+        tmxErrorMessage(TMX_ERR_PARAM, "Chunk index is out of range.");
+        return TMX_FALSE;
+    }
+
+    TMXcolliderbaker baker;
+    memset(&baker, 0, sizeof(TMXcolliderbaker));
+    baker.map       = map;
+    baker.colliders = colliders;
+    baker.hexagonal = map->orientation == TMX_ORIENTATION_HEXAGONAL;
+    tmxGridInit(&baker.grid, map);
+
+    colliders->count         = 0;
+    colliders->outline_count = 0;
+    colliders->point_count   = 0;
+
+    size_t i;
+    if (layer->type == TMX_LAYER_TILE)
+    {
+        TMXrect bounds = {.x = 0, .y = 0, .w = layer->size.w, .h = layer->size.h};
+        if (layer->data.tiles)
+            tmxCollidersCells(&baker, layer->data.tiles, bounds, layer->occupancy, tmxCollidersIntersect(region, bounds));
+    }
+    else
+    {
+        size_t first = chunk == SIZE_MAX ? 0 : chunk;
+        size_t last  = chunk == SIZE_MAX ? layer->count : chunk + 1;
+        for (i = first; i < last; i++)
+        {
+            const TMXchunk *c = &layer->data.chunks[i];
+            if (c->gids)
+                tmxCollidersCells(&baker, c->gids, c->bounds, NULL, tmxCollidersIntersect(region, c->bounds));
+        }
+    }
+
+    // The merged rectangles are placed before the other shapes, which are moved up to make room.
+    size_t rects = tmxCollidersMerge(baker.rects, baker.rectCount);
+    if (!baker.failed && rects)
+    {
+        if (tmxCollidersGrow((void **) &colliders->colliders, &colliders->capacity, colliders->count + rects, sizeof(TMXcollider)))
+        {
+            memmove(&colliders->colliders[rects], colliders->colliders, colliders->count * sizeof(TMXcollider));
+            for (i = 0; i < rects; i++)
+            {
+                TMXcollider *collider = &colliders->colliders[i];
+                memset(collider, 0, sizeof(TMXcollider));
+                collider->type       = TMX_OBJECT_RECT;
+                collider->position.x = baker.rects[i].x0;
+                collider->position.y = baker.rects[i].y0;
+                collider->size.x     = baker.rects[i].x1 - baker.rects[i].x0;
+                collider->size.y     = baker.rects[i].y1 - baker.rects[i].y0;
+            }
+            colliders->count += rects;
+        }
+        else
+        {
+            baker.failed = TMX_TRUE;
+        }
+    }
+
+    if (!baker.failed && !tmxCollidersTrace(colliders, baker.rects, rects))
+        baker.failed = TMX_TRUE;
+    tmxFree(baker.rects);
+
+    // The list is left empty rather than partially baked.
+    if (baker.failed)
+    {
+        colliders->count         = 0;
+        colliders->outline_count = 0;
+        colliders->point_count   = 0;
+        return TMX_FALSE;
+    }
+    return TMX_TRUE;
+}
+
+TMX_BOOL
+tmxBakeCollidersRegion(const TMXmap *map, const TMXlayer *layer, TMXrect region, TMXcolliders *colliders)
+{
+    return tmxBakeColliders(map, layer, region, SIZE_MAX, colliders);
+}
+
+TMX_BOOL
+tmxBakeCollidersChunk(const TMXmap *map, const TMXlayer *layer, size_t index, TMXcolliders *colliders)
+{
+    if (layer && layer->type != TMX_LAYER_CHUNK)
+    {
+        tmxErrorMessage(TMX_ERR_PARAM, "Only layers of infinite maps have chunks.");
+        return TMX_FALSE;
+    }
+
+    TMXrect all = {.x = INT_MIN / 2, .y = INT_MIN / 2, .w = INT_MAX, .h = INT_MAX};
+    return tmxBakeColliders(map, layer, all, index, colliders);
+}
@@ -47,7 +47,11 @@ tmxImageUserLoad(TMXimage *image, const char *basePath)
 {
     if (!imageLoad)
         return;
+    TMX_STATS_BEGIN(TMX_PHASE_IMAGE);
+    TMX_TRACE_BEGIN("image", image->source);
     image->user_data = imageLoad(image, basePath, imageUserPtr);
+    TMX_TRACE_END();
+    TMX_STATS_END(TMX_PHASE_IMAGE, 0);
 }
 
 void
@@ -77,7 +81,7 @@ struct TMXcache
 TMX_BOOL
 tmxCacheTryGet(TMXcache *cache, const char *key, void **result, TMX_CACHE_TARGET target)
 {
-    if (!cache || !key || !*result || target == TMX_CACHE_NONE)
+    if (!cache || !key || !result || target == TMX_CACHE_NONE)
         return TMX_FALSE;
 
     size_t len = strlen(key);
@@ -259,7 +263,7 @@ tmxStringCopy(const char *input, size_t inputSize)
         return NULL;
 
     size_t len   = inputSize ? inputSize : strlen(input);
-    char *result = tmxMalloc(len + 1);
+    char *result = tmxMallocCategory(len + 1, TMX_MEMORY_STRINGS);
     memcpy(result, input, len);
     result[len] = '\0';
     return result;
@@ -267,84 +271,170 @@ tmxStringCopy(const char *input, size_t inputSize)
 
 static TMX_INLINE TMXtile *tmxGetTile(TMXmap *map, TMXgid gid)
 {
-    for (size_t i = 0; i < map->tileset_count; i++)
+    TMXtid id;
+    TMXtileset *tileset = tmxMapTileset(map, gid, &id);
+    return tileset ? tmxTilesetTile(tileset, id) : NULL;
+}
+
+/**
+ * @brief Invokes the function for each cell along a row of a chunk, skipping the cells its mask marks as empty.
+ */
+static TMX_BOOL
+tmxChunkForeachRow(TMXmap *map, TMXlayer *layer, const TMXchunk *chunk, int row, TMX_BOOL left, TMX_BOOL includeEmpty,
+                   TMXforeachfunc foreachFunc)
+{
+    int i, x, width = chunk->bounds.w;
+    size_t index, offset = (size_t) row * (size_t) width;
+    TMXtile *tile;
+    TMXgid gid;
+
+    for (i = 0; i < width; i++)
     {
+        x     = left ? width - 1 - i : i;
+        index = offset + (size_t) x;
+        if (!includeEmpty && chunk->mask && !((chunk->mask[index >> 6] >> (index & 63)) & 1))
+            continue;
+
+        gid  = chunk->gids ? chunk->gids[index] : 0;
+        tile = tmxGetTile(map, gid & TMX_GID_TILE_MASK);
+        if ((tile || includeEmpty) && !foreachFunc(map, layer, tile, chunk->bounds.x + x, chunk->bounds.y + row, gid))
+            return TMX_FALSE;
+    }
+    return TMX_TRUE;
+}
 
+/**
+ * @brief Visits the cells of a chunk layer in render order. Chunks of the same row, sorted by position as they are after
+ * loading, are visited together one row of cells at a time.
+ */
+static void
+tmxChunkForeach(TMXmap *map, TMXlayer *layer, TMX_BOOL includeEmpty, TMXforeachfunc foreachFunc)
+{
+    const TMXchunk *chunks = layer->data.chunks;
+    size_t count = layer->count, start, first, last, k;
+    TMX_BOOL up, left;
+    int r, row, height;
+
+    switch (map->render_order)
+    {
+        case TMX_RENDER_RIGHT_DOWN: up = TMX_FALSE, left = TMX_FALSE; break;
+        case TMX_RENDER_RIGHT_UP: up = TMX_TRUE, left = TMX_FALSE; break;
+        case TMX_RENDER_LEFT_DOWN: up = TMX_FALSE, left = TMX_TRUE; break;
+        case TMX_RENDER_LEFT_UP: up = TMX_TRUE, left = TMX_TRUE; break;
+        default: tmxError(TMX_ERR_PARAM); return;
+    }
+
+    start = up ? count : 0;
+    while (up ? start > 0 : start < count)
+    {
+        // Find the run of chunks sharing the next row, [first, last).
+        if (up)
+        {
+            last = start;
+            for (first = last - 1; first > 0 && chunks[first - 1].bounds.y == chunks[last - 1].bounds.y &&
+                                   chunks[first - 1].bounds.h == chunks[last - 1].bounds.h;
+                 first--)
+                ;
+            start = first;
+        }
+        else
+        {
+            first = start;
+            for (last = first + 1; last < count && chunks[last].bounds.y == chunks[first].bounds.y &&
+                                   chunks[last].bounds.h == chunks[first].bounds.h;
+                 last++)
+                ;
+            start = last;
+        }
 
-        // TODO: Tilesets are ordered by first GID, but maybe still check range Just-In-Case™ 
-        // What if someone sorts the list to suit their own needs?
-        if (gid >= map->tilesets[i].first_gid)
-            return &map->tilesets[i].tileset->tiles[gid - map->tilesets[i].first_gid];
+        height = chunks[first].bounds.h;
+        for (r = 0; r < height; r++)
+        {
+            row = up ? height - 1 - r : r;
+            for (k = 0; k < last - first; k++)
+            {
+                if (!tmxChunkForeachRow(map, layer, &chunks[left ? last - 1 - k : first + k], row, left, includeEmpty, foreachFunc))
+                    return;
+            }
+        }
     }
-    return NULL;
+}
+
+/**
+ * @brief Invokes the function for each cell along a row of a tile layer, skipping the empty blocks of its occupancy
+ * pyramid when it has one and empty cells are not yielded.
+ */
+static TMX_BOOL
+tmxTileForeachRow(TMXmap *map, TMXlayer *layer, int y, TMX_BOOL left, TMX_BOOL includeEmpty, TMXforeachfunc foreachFunc)
+{
+    const TMXoccupancy *occupancy = includeEmpty ? NULL : layer->occupancy;
+    int x, stop, width = layer->size.w;
+    const TMXgid *row = layer->data.tiles + (size_t) y * (size_t) width;
+    TMXtile *tile;
+
+    if (left)
+    {
+        for (x = width - 1; x >= 0; x = stop - 1)
+        {
+            stop = 0;
+            if (occupancy && (x = tmxOccupancyPrevious(occupancy, x, y, 0)) >= 0)
+                stop = tmxOccupancyRunStart(occupancy, x, y, 0);
+            for (; x >= stop; x--)
+            {
+                tile = tmxGetTile(map, row[x] & TMX_GID_TILE_MASK);
+                if ((tile || includeEmpty) && !foreachFunc(map, layer, tile, x, y, row[x]))
+                    return TMX_FALSE;
+            }
+        }
+        return TMX_TRUE;
+    }
+
+    for (x = 0; x < width; x = stop)
+    {
+        stop = width;
+        if (occupancy && (x = tmxOccupancyNext(occupancy, x, y, width)) < width)
+            stop = tmxOccupancyRunEnd(occupancy, x, y, width);
+        for (; x < stop; x++)
+        {
+            tile = tmxGetTile(map, row[x] & TMX_GID_TILE_MASK);
+            if ((tile || includeEmpty) && !foreachFunc(map, layer, tile, x, y, row[x]))
+                return TMX_FALSE;
+        }
+    }
+    return TMX_TRUE;
 }
 
 void
 tmxTileForeach(TMXmap *map, TMXlayer *layer, TMX_BOOL includeEmpty, TMXforeachfunc foreachFunc)
 {
-    if (!map || !layer || !foreachFunc || layer->type != TMX_LAYER_TILE)
+    if (!map || !layer || !foreachFunc || (layer->type != TMX_LAYER_TILE && layer->type != TMX_LAYER_CHUNK))
     {
         tmxError(TMX_ERR_VALUE);
         return;
     }
+    if (layer->type == TMX_LAYER_CHUNK)
+    {
+        tmxChunkForeach(map, layer, includeEmpty, foreachFunc);
+        return;
+    }
+
+    TMX_BOOL up, left;
+    int r, height = layer->data.tiles ? layer->size.h : 0;
 
-    int i, count = (int) layer->count;
-    int width = (int) layer->size.w;
-    int height = (int) layer->size.h;
-    TMXtile *tile = NULL;
-    TMXgid gid = 0;
- 
     switch (map->render_order)
     {
-        case TMX_RENDER_RIGHT_DOWN: 
-            for (i = 0; i < count; i++)
-            {
-                gid = layer->data.tiles[i];
-                tile = tmxGetTile(map, gid & TMX_GID_TILE_MASK);
-                if (tile || includeEmpty)
-                {
-                    if (!foreachFunc(map, layer, tile, i % width, i / width, gid))
-                        break;
-                }
-            }
-            break;
-        case TMX_RENDER_RIGHT_UP: 
-            for (i = 0; i < count; i++)
-            {
-                gid = layer->data.tiles[i];
-                tile = tmxGetTile(map, gid & TMX_GID_TILE_MASK);
-                if (tile || includeEmpty)
-                {
-                    if (!foreachFunc(map, layer, tile, i % width, height - (i / width), gid))
-                        break;
-                }
-            }
-            break;
-        case TMX_RENDER_LEFT_DOWN:
-            for (i = 0; i < count; i++)
-            {
-                gid = layer->data.tiles[i];
-                tile = tmxGetTile(map, gid & TMX_GID_TILE_MASK);
-                if (tile || includeEmpty)
-                {
-                    if (!foreachFunc(map, layer, tile, width - (i % width), i / width, gid))
-                        break;
-                }
-            }
-            break;
-        case TMX_RENDER_LEFT_UP: 
-            for (i = 0; i < count; i++)
-            {
-                gid = layer->data.tiles[i];
-                tile = tmxGetTile(map, gid & TMX_GID_TILE_MASK);
-                if (tile || includeEmpty)
-                {
-                    if (!foreachFunc(map, layer, tile, width - (i % width), height - (i / width), gid))
-                        break;
-                }
-            }
-            break;
-        default: tmxError(TMX_ERR_PARAM); break;
+        case TMX_RENDER_RIGHT_DOWN: up = TMX_FALSE, left = TMX_FALSE; break;
+        case TMX_RENDER_RIGHT_UP: up = TMX_TRUE, left = TMX_FALSE; break;
+        case TMX_RENDER_LEFT_DOWN: up = TMX_FALSE, left = TMX_TRUE; break;
+        case TMX_RENDER_LEFT_UP: up = TMX_TRUE, left = TMX_TRUE; break;
+        default: tmxError(TMX_ERR_PARAM); return;
+    }
+
+    // Cells are yielded at their own coordinates, with the rows and columns visited in the render order.
+    for (r = 0; r < height; r++)
+    {
+        if (!tmxTileForeachRow(map, layer, up ? height - 1 - r : r, left, includeEmpty, foreachFunc))
+            return;
     }
 }
 
@@ -383,7 +473,7 @@ tmxObjectMergeTemplate(TMXobject *dst, TMXobject *src)
     if (dst->type == TMX_OBJECT_TEXT)
     {
         if (!dst->text)
-            dst->text = TMX_ALLOC(struct TMXtext);
+            dst->text = TMX_POOL_ALLOC(struct TMXtext, TMX_POOL_TEXT);
 
         if (!dst->text->string && !TMX_HAS_FLAG(dst->flags, TMX_FLAG_TEXT) && src->text->string)
             dst->text->string = tmxStringDup(src->text->string);
@@ -0,0 +1,615 @@
+#include "tmx/compact.h"
+#include "internal.h"
+#include <string.h>
+
+/**
+ * @brief The largest number of GIDs in a palette, which is the number of distinct 16-bit indices.
+ */
+#define TMX_COMPACT_MAX_PALETTE 65536U
+
+/**
+ * @brief The block shift of a single block covering every cell.
+ */
+#define TMX_COMPACT_SINGLE 31
+
+typedef struct TMXcompactblock
+{
+    TMXgid *palette;  /** The distinct GIDs of the block, with room for a power of two not less than their count. */
+    uint64_t *words;  /** The index of each cell into the palette in row-major order, followed by padding, or @c NULL. */
+    size_t cells;     /** The number of cells in the block, which is smaller than a full block along the edges of the grid. */
+    uint32_t width;   /** The number of cells in each row of the block. */
+    uint32_t count;   /** The number of GIDs in the palette. */
+    unsigned bits;    /** The number of bits of each index, or 0 when the palette has a single GID and no indices are stored. */
+} TMXcompactblock;
+
+struct TMXcompact
+{
+    TMXrect region;          /** The cells of the storage, in tile units. */
+    int shift;               /** The base-2 logarithm of the width and height of each block. */
+    int columns;             /** The number of blocks in each row of blocks. */
+    int rows;                /** The number of rows of blocks. */
+    TMXcompactblock *blocks; /** The blocks, in row-major order. */
+};
+
+/**
+ * @brief Scratch memory for packing the cells of blocks, with a hash table from each distinct GID to its index.
+ */
+typedef struct TMXcompactscratch
+{
+    TMXgid *palette; /** The distinct GIDs of the block being packed, in order of their first cell. */
+    uint32_t *slots; /** One more than the index in the palette of the GID in each slot, or 0 when the slot is empty. */
+    size_t mask;     /** One less than the number of slots, which is a power of two. */
+} TMXcompactscratch;
+
+/**
+ * @brief Rounds a number of GIDs up to the capacity of a palette, a power of two.
+ */
+static TMX_INLINE size_t
+tmxCompactCapacity(size_t count)
+{
+    size_t capacity = 1;
+    while (capacity < count)
+        capacity <<= 1;
+    return capacity;
+}
+
+/**
+ * @brief Computes the number of words for the indices of a block, with padding so that the word after the one containing
+ * the end of the last index can always be read.
+ */
+static TMX_INLINE size_t
+tmxCompactWords(size_t cells, unsigned bits)
+{
+    return bits ? cells * bits / 64 + 2 : 0;
+}
+
+static TMX_INLINE uint32_t
+tmxCompactRead(const uint64_t *words, size_t index, unsigned bits)
+{
+    size_t bit       = index * bits;
+    unsigned shift   = (unsigned) (bit & 63);
+    const uint64_t *w = words + (bit >> 6);
+    return (uint32_t) (((w[0] >> shift) | ((w[1] << 1) << (63 - shift))) & ((1U << bits) - 1));
+}
+
+static TMX_INLINE void
+tmxCompactWrite(uint64_t *words, size_t index, unsigned bits, uint32_t value)
+{
+    size_t bit     = index * bits;
+    unsigned shift = (unsigned) (bit & 63);
+    uint64_t *w    = words + (bit >> 6);
+    uint64_t mask  = ((uint64_t) 1 << bits) - 1;
+
+    w[0] = (w[0] & ~(mask << shift)) | ((uint64_t) value << shift);
+    if (shift + bits > 64)
+        w[1] = (w[1] & ~(mask >> (64 - shift))) | ((uint64_t) value >> (64 - shift));
+}
+
+/**
+ * @brief Finds the slot of a GID in the hash table of a scratch, which is either its own or the empty slot to insert it.
+ */
+static TMX_INLINE uint32_t *
+tmxCompactSlot(const TMXcompactscratch *scratch, TMXgid gid)
+{
+    // The flip flags are in the high bits, and mixed down so that flipped tiles do not collide with each other.
+    uint32_t hash = gid ^ (gid >> 16);
+    hash *= 0x45D9F3BU;
+    hash ^= hash >> 16;
+
+    size_t i = hash & scratch->mask;
+    while (scratch->slots[i] && scratch->palette[scratch->slots[i] - 1] != gid)
+        i = (i + 1) & scratch->mask;
+    return &scratch->slots[i];
+}
+
+/**
+ * @brief Packs the cells of a block from an array of GIDs, finding the palette with a first pass over the cells, and
+ * writing the indices with a second.
+ */
+static TMX_BOOL
+tmxCompactPack(TMXcompactblock *block, const TMXgid *gids, size_t stride, uint32_t width, uint32_t height, TMXcompactscratch *scratch)
+{
+    uint32_t count = 0, x, y, i;
+    size_t index   = 0;
+    block->width   = width;
+    block->cells   = (size_t) width * (size_t) height;
+
+    for (y = 0; y < height; y++)
+    {
+        const TMXgid *row = gids + (size_t) y * stride;
+        for (x = 0; x < width; x++)
+        {
+            uint32_t *slot = tmxCompactSlot(scratch, row[x]);
+            if (*slot)
+                continue;
+            if (count == TMX_COMPACT_MAX_PALETTE)
+            {
+                tmxErrorMessage(TMX_ERR_PARAM, "Too many distinct GIDs for the palette of a single block.");
+                for (i = count; i > 0; i--)
+                    *tmxCompactSlot(scratch, scratch->palette[i - 1]) = 0;
+                return TMX_FALSE;
+            }
+            scratch->palette[count++] = row[x];
+            *slot                     = count;
+        }
+    }
+
+    block->count = count;
+    block->bits  = 0;
+    while ((1U << block->bits) < count)
+        block->bits++;
+
+    block->palette = tmxMallocCategory(tmxCompactCapacity(count) * sizeof(TMXgid), TMX_MEMORY_TILES);
+    if (block->palette)
+        memcpy(block->palette, scratch->palette, count * sizeof(TMXgid));
+    if (block->palette && block->bits)
+    {
+        block->words = tmxMallocCategory(tmxCompactWords(block->cells, block->bits) * sizeof(uint64_t), TMX_MEMORY_TILES);
+        if (block->words)
+        {
+            memset(block->words, 0, tmxCompactWords(block->cells, block->bits) * sizeof(uint64_t));
+            for (y = 0; y < height; y++)
+            {
+                const TMXgid *row = gids + (size_t) y * stride;
+                for (x = 0; x < width; x++, index++)
+                    tmxCompactWrite(block->words, index, block->bits, *tmxCompactSlot(scratch, row[x]) - 1);
+            }
+        }
+    }
+
+    // Only the slots that were used are cleared, rather than the entire table. Removing the GIDs in the reverse order of
+    // their insertion undoes each insertion in turn, so every GID is still found along its probe sequence.
+    for (i = count; i > 0; i--)
+        *tmxCompactSlot(scratch, scratch->palette[i - 1]) = 0;
+    return block->palette && (!block->bits || block->words);
+}
+
+static TMXcompact *
+tmxCompactAlloc(TMXrect region, int size)
+{
+    if (region.w < 0 || region.h < 0 || (size && (size < 4 || size > TMX_COMPACT_MAX_BLOCK || (size & (size - 1)))))
+    {
+        tmxErrorMessage(TMX_ERR_PARAM, "Block size must be 0, or a power of two from 4 to TMX_COMPACT_MAX_BLOCK.");
+        return NULL;
+    }
+
+    TMXcompact *compact = TMX_ALLOC(TMXcompact);
+    if (!compact)
+        return NULL;
+
+    compact->region = region;
+    compact->shift  = TMX_COMPACT_SINGLE;
+    if (size)
+    {
+        for (compact->shift = 0; (1 << compact->shift) < size; compact->shift++)
+            ;
+    }
+    compact->columns = (int) (((int64_t) region.w + ((int64_t) 1 << compact->shift) - 1) >> compact->shift);
+    compact->rows    = (int) (((int64_t) region.h + ((int64_t) 1 << compact->shift) - 1) >> compact->shift);
+    compact->blocks  = tmxCalloc(TMX_MAX((size_t) compact->columns * (size_t) compact->rows, 1), sizeof(TMXcompactblock));
+    if (!compact->blocks)
+    {
+        tmxFree(compact);
+        return NULL;
+    }
+    return compact;
+}
+
+/**
+ * @brief Packs a row of blocks from an array of GIDs beginning at the first cell of the row.
+ */
+static TMX_BOOL
+tmxCompactPackRow(TMXcompact *compact, int row, const TMXgid *gids, size_t stride, TMXcompactscratch *scratch)
+{
+    int64_t block  = (int64_t) 1 << compact->shift;
+    uint32_t height = (uint32_t) TMX_MIN(block, (int64_t) compact->region.h - (int64_t) row * block);
+    int column;
+
+    for (column = 0; column < compact->columns; column++)
+    {
+        uint32_t width = (uint32_t) TMX_MIN(block, (int64_t) compact->region.w - (int64_t) column * block);
+        TMXcompactblock *b = &compact->blocks[(size_t) row * (size_t) compact->columns + (size_t) column];
+        if (!tmxCompactPack(b, gids + (size_t) column * (size_t) block, stride, width, height, scratch))
+            return TMX_FALSE;
+    }
+    return TMX_TRUE;
+}
+
+/**
+ * @brief Allocates the scratch memory for packing the blocks of a storage.
+ */
+static TMX_BOOL
+tmxCompactScratchInit(const TMXcompact *compact, TMXcompactscratch *scratch)
+{
+    size_t block = (size_t) 1 << compact->shift;
+    size_t cells = TMX_MIN(TMX_MIN(block, (size_t) compact->region.w) * TMX_MIN(block, (size_t) compact->region.h),
+                           (size_t) TMX_COMPACT_MAX_PALETTE + 1);
+
+    // The table is at most half full, which keeps the probes short.
+    scratch->mask    = tmxCompactCapacity(cells * 2) - 1;
+    scratch->palette = tmxMallocCategory(TMX_MAX(cells, 1) * sizeof(TMXgid), TMX_MEMORY_TEMPORARY);
+    scratch->slots   = tmxCalloc(scratch->mask + 1, sizeof(uint32_t));
+    return scratch->palette && scratch->slots;
+}
+
+TMXcompact *
+tmxCompactCreateGrid(const TMXgid *gids, TMXrect region, int size)
+{
+    TMXcompactscratch scratch = {0};
+    TMX_BOOL success          = TMX_TRUE;
+    int row;
+    if (!gids && region.w > 0 && region.h > 0)
+    {
+        tmxError(TMX_ERR_VALUE);
+        return NULL;
+    }
+
+    TMXcompact *compact = tmxCompactAlloc(region, size);
+    if (!compact)
+        return NULL;
+
+    success = tmxCompactScratchInit(compact, &scratch);
+    for (row = 0; success && row < compact->rows; row++)
+    {
+        size_t offset = ((size_t) row << compact->shift) * (size_t) region.w;
+        success       = tmxCompactPackRow(compact, row, gids + offset, (size_t) region.w, &scratch);
+    }
+
+    tmxFree(scratch.palette);
+    tmxFree(scratch.slots);
+    if (!success)
+    {
+        tmxFreeCompact(compact);
+        return NULL;
+    }
+    return compact;
+}
+
+TMXcompact *
+tmxCompactCreate(const TMXlayer *layer, int size)
+{
+    TMXcompactscratch scratch = {0};
+    TMX_BOOL success;
+    size_t i;
+    int row;
+
+    if (!layer)
+    {
+        tmxError(TMX_ERR_VALUE);
+        return NULL;
+    }
+    if (layer->type != TMX_LAYER_TILE && layer->type != TMX_LAYER_CHUNK)
+    {
+        tmxErrorMessage(TMX_ERR_PARAM, "Compact storage can only be created from tile layers.");
+        return NULL;
+    }
+    if (layer->type == TMX_LAYER_TILE && layer->data.tiles)
+    {
+        TMXrect region = {.x = 0, .y = 0, .w = layer->size.w, .h = layer->size.h};
+        return tmxCompactCreateGrid(layer->data.tiles, region, size);
+    }
+
+    // The cells of infinite layers are combined from the chunks into a band of one row of blocks at a time.
+    TMXrect region = {.x = 0, .y = 0, .w = layer->size.w, .h = layer->size.h};
+    if (layer->type == TMX_LAYER_CHUNK)
+        region = tmxLayerChunkBounds(layer);
+
+    TMXcompact *compact = tmxCompactAlloc(region, size);
+    if (!compact)
+        return NULL;
+
+    size_t height = TMX_MIN((size_t) 1 << compact->shift, (size_t) region.h);
+    TMXgid *band  = tmxMallocCategory(TMX_MAX((size_t) region.w * height, 1) * sizeof(TMXgid), TMX_MEMORY_TEMPORARY);
+    success       = band && tmxCompactScratchInit(compact, &scratch);
+    for (row = 0; success && row < compact->rows; row++)
+    {
+        int top    = region.y + (int) ((size_t) row * height);
+        int bottom = (int) TMX_MIN((int64_t) top + (int64_t) height, (int64_t) region.y + region.h);
+        memset(band, 0, (size_t) region.w * height * sizeof(TMXgid));
+        for (i = 0; layer->type == TMX_LAYER_CHUNK && i < layer->count; i++)
+        {
+            const TMXchunk *chunk = &layer->data.chunks[i];
+            int y                 = TMX_MAX(top, chunk->bounds.y);
+            if (!chunk->gids)
+                continue;
+            for (; y < TMX_MIN(bottom, chunk->bounds.y + chunk->bounds.h); y++)
+            {
+                memcpy(band + (size_t) (y - top) * (size_t) region.w + (size_t) (chunk->bounds.x - region.x),
+                       chunk->gids + (size_t) (y - chunk->bounds.y) * (size_t) chunk->bounds.w, (size_t) chunk->bounds.w * sizeof(TMXgid));
+            }
+        }
+        success = tmxCompactPackRow(compact, row, band, (size_t) region.w, &scratch);
+    }
+
+    tmxFree(band);
+    tmxFree(scratch.palette);
+    tmxFree(scratch.slots);
+    if (!success)
+    {
+        tmxFreeCompact(compact);
+        return NULL;
+    }
+    return compact;
+}
+
+TMXrect
+tmxCompactRegion(const TMXcompact *compact)
+{
+    TMXrect region = {0};
+    if (!compact)
+    {
+        tmxError(TMX_ERR_VALUE);
+        return region;
+    }
+    return compact->region;
+}
+
+/**
+ * @brief Finds the block of a cell and the index of the cell within it.
+ */
+static TMX_INLINE TMXcompactblock *
+tmxCompactLocate(const TMXcompact *compact, int x, int y, size_t *index)
+{
+    uint32_t cx = (uint32_t) ((int64_t) x - compact->region.x), cy = (uint32_t) ((int64_t) y - compact->region.y);
+    uint32_t mask = ((uint32_t) 1 << compact->shift) - 1;
+    if ((int64_t) x < compact->region.x || (int64_t) y < compact->region.y || cx >= (uint32_t) compact->region.w ||
+        cy >= (uint32_t) compact->region.h)
+        return NULL;
+
+    TMXcompactblock *block = &compact->blocks[(size_t) (cy >> compact->shift) * (size_t) compact->columns + (cx >> compact->shift)];
+    *index                 = (size_t) (cy & mask) * block->width + (cx & mask);
+    return block;
+}
+
+TMXgid
+tmxCompactGet(const TMXcompact *compact, int x, int y)
+{
+    size_t index;
+    if (!compact)
+    {
+        tmxError(TMX_ERR_VALUE);
+        return 0;
+    }
+
+    const TMXcompactblock *block = tmxCompactLocate(compact, x, y, &index);
+    if (!block)
+        return 0;
+    return block->palette[block->bits ? tmxCompactRead(block->words, index, block->bits) : 0];
+}
+
+/**
+ * @brief Decodes consecutive indices of a block, carrying the current pair of words from one index to the next.
+ */
+static void
+tmxCompactUnpack(const TMXcompactblock *block, size_t index, size_t count, TMXgid *output)
+{
+    const TMXgid *palette = block->palette;
+    size_t i;
+    if (!block->bits)
+    {
+        for (i = 0; i < count; i++)
+            output[i] = palette[0];
+        return;
+    }
+
+    unsigned bits     = block->bits;
+    uint64_t mask     = ((uint64_t) 1 << bits) - 1;
+    size_t bit        = index * bits;
+    unsigned shift    = (unsigned) (bit & 63);
+    const uint64_t *w = block->words + (bit >> 6);
+    uint64_t low = w[0], high = w[1];
+
+    for (i = 0; i < count; i++)
+    {
+        output[i] = palette[((low >> shift) | ((high << 1) << (63 - shift))) & mask];
+        shift += bits;
+        if (shift >= 64)
+        {
+            shift -= 64;
+            low  = high;
+            high = *(++w + 1);
+        }
+    }
+}
+
+void
+tmxCompactDecode(const TMXcompact *compact, int x, int y, size_t count, TMXgid *output)
+{
+    if (!compact || (!output && count))
+    {
+        tmxError(TMX_ERR_VALUE);
+        return;
+    }
+
+    // Cells outside of the storage are empty, and the rest are decoded one block at a time.
+    int64_t cx = (int64_t) x - compact->region.x, cy = (int64_t) y - compact->region.y;
+    int64_t first = TMX_MIN(TMX_MAX(-cx, 0), (int64_t) count);
+    int64_t last  = TMX_MAX(TMX_MIN((int64_t) compact->region.w - cx, (int64_t) count), first);
+    if (cy < 0 || cy >= compact->region.h)
+        first = last = (int64_t) count;
+
+    memset(output, 0, (size_t) first * sizeof(TMXgid));
+    memset(output + last, 0, (count - (size_t) last) * sizeof(TMXgid));
+
+    uint32_t mask = ((uint32_t) 1 << compact->shift) - 1;
+    size_t offset = (size_t) (cy >> compact->shift) * (size_t) compact->columns;
+    while (first < last)
+    {
+        uint32_t column              = (uint32_t) (cx + first);
+        const TMXcompactblock *block = &compact->blocks[offset + (column >> compact->shift)];
+        size_t n                     = (size_t) TMX_MIN(last - first, (int64_t) (block->width - (column & mask)));
+        tmxCompactUnpack(block, ((size_t) ((uint32_t) cy & mask)) * block->width + (column & mask), n, output + first);
+        first += (int64_t) n;
+    }
+}
+
+/**
+ * @brief Changes the number of bits of each index of a block.
+ */
+static TMX_BOOL
+tmxCompactRepack(TMXcompactblock *block, unsigned bits)
+{
+    uint64_t *words = NULL;
+    size_t i;
+    if (bits)
+    {
+        size_t count = tmxCompactWords(block->cells, bits);
+        if (!(words = tmxMallocCategory(count * sizeof(uint64_t), TMX_MEMORY_TILES)))
+            return TMX_FALSE;
+        memset(words, 0, count * sizeof(uint64_t));
+        for (i = 0; block->bits && i < block->cells; i++)
+            tmxCompactWrite(words, i, bits, tmxCompactRead(block->words, i, block->bits));
+    }
+
+    tmxFree(block->words);
+    block->words = words;
+    block->bits  = bits;
+    return TMX_TRUE;
+}
+
+/**
+ * @brief Makes room in a full palette for another GID, by removing the GIDs no longer used by any cell other than the
+ * one about to be written, or otherwise by widening the indices.
+ */
+static TMX_BOOL
+tmxCompactGrow(TMXcompactblock *block, size_t skip)
+{
+    uint32_t used = 0, i;
+    size_t k;
+
+    uint32_t *remap = tmxMallocCategory(block->count * sizeof(uint32_t), TMX_MEMORY_TEMPORARY);
+    if (!remap)
+        return TMX_FALSE;
+    memset(remap, 0xFF, block->count * sizeof(uint32_t));
+    for (k = 0; k < block->cells; k++)
+    {
+        if (k != skip)
+            remap[block->bits ? tmxCompactRead(block->words, k, block->bits) : 0] = 0;
+    }
+
+    // The palette keeps its order, and the indices of the cells are rewritten in place.
+    for (i = 0; i < block->count; i++)
+    {
+        if (remap[i])
+            continue;
+        block->palette[used] = block->palette[i];
+        remap[i]             = used++;
+    }
+    if (used < block->count)
+    {
+        for (k = 0; block->bits && k < block->cells; k++)
+        {
+            uint32_t index = remap[tmxCompactRead(block->words, k, block->bits)];
+            tmxCompactWrite(block->words, k, block->bits, index == UINT32_MAX ? 0 : index);
+        }
+        block->count = used;
+        tmxFree(remap);
+
+        TMXgid *palette = tmxRealloc(block->palette, tmxCompactCapacity(used) * sizeof(TMXgid));
+        if (palette)
+            block->palette = palette;
+        return TMX_TRUE;
+    }
+
+    tmxFree(remap);
+    if (block->bits == 16)
+    {
+        tmxErrorMessage(TMX_ERR_PARAM, "Too many distinct GIDs for the palette of a single block.");
+        return TMX_FALSE;
+    }
+    return tmxCompactRepack(block, block->bits + 1);
+}
+
+TMX_BOOL
+tmxCompactSet(TMXcompact *compact, int x, int y, TMXgid gid)
+{
+    size_t index;
+    uint32_t i;
+    if (!compact)
+    {
+        tmxError(TMX_ERR_VALUE);
+        return TMX_FALSE;
+    }
+
+    TMXcompactblock *block = tmxCompactLocate(compact, x, y, &index);
+    if (!block)
+    {
+        tmxErrorMessage(TMX_ERR_PARAM, "Cell is outside of the compact storage.");
+        return TMX_FALSE;
+    }
+
+    for (i = 0; i < block->count && block->palette[i] != gid; i++)
+        ;
+    if (i == block->count)
+    {
+        if (block->count == (1U << block->bits) && !tmxCompactGrow(block, index))
+            return TMX_FALSE;
+
+        // Palettes are allocated to the power of two at or above their count, so they only grow when it passes one.
+        i = block->count;
+        if (tmxCompactCapacity(i + 1) > tmxCompactCapacity(i))
+        {
+            TMXgid *palette = tmxRealloc(block->palette, tmxCompactCapacity(i + 1) * sizeof(TMXgid));
+            if (!palette)
+                return TMX_FALSE;
+            block->palette = palette;
+        }
+        block->palette[block->count++] = gid;
+    }
+
+    if (block->bits)
+        tmxCompactWrite(block->words, index, block->bits, i);
+    return TMX_TRUE;
+}
+
+TMX_BOOL
+tmxCompactEncode(TMXcompact *compact, int x, int y, size_t count, const TMXgid *gids)
+{
+    size_t i;
+    if (!compact || (!gids && count))
+    {
+        tmxError(TMX_ERR_VALUE);
+        return TMX_FALSE;
+    }
+    for (i = 0; i < count; i++)
+    {
+        if (!tmxCompactSet(compact, x + (int) i, y, gids[i]))
+            return TMX_FALSE;
+    }
+    return TMX_TRUE;
+}
+
+size_t
+tmxCompactMemory(const TMXcompact *compact)
+{
+    size_t i, blocks, size = sizeof(TMXcompact);
+    if (!compact)
+    {
+        tmxError(TMX_ERR_VALUE);
+        return 0;
+    }
+
+    blocks = (size_t) compact->columns * (size_t) compact->rows;
+    size += blocks * sizeof(TMXcompactblock);
+    for (i = 0; i < blocks; i++)
+    {
+        const TMXcompactblock *block = &compact->blocks[i];
+        size += tmxCompactCapacity(block->count) * sizeof(TMXgid) + tmxCompactWords(block->cells, block->bits) * sizeof(uint64_t);
+    }
+    return size;
+}
+
+void
+tmxFreeCompact(TMXcompact *compact)
+{
+    size_t i;
+    if (!compact)
+        return;
+    for (i = 0; i < (size_t) compact->columns * (size_t) compact->rows; i++)
+    {
+        tmxFree(compact->blocks[i].palette);
+        tmxFree(compact->blocks[i].words);
+    }
+    tmxFree(compact->blocks);
+    tmxFree(compact);
+}
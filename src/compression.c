@@ -4,17 +4,32 @@
 #include "parse.h"
 #include <string.h>
 
-#define MINIZ_NO_MALLOC
-#define MINIZ_NO_STDIO
-#define MINIZ_NO_ARCHIVE_APIS
-#define MINIZ_NO_DEFLATE_APIS
-
-#define MZ_MALLOC  tmxMalloc
-#define MZ_FREE    tmxFree
-#define MZ_REALLOC tmxRealloc
-#include "miniz.h"
-
-#define TMX_GZIP_HEADER_SIZE 10
+#include "inflate.h"
+
+#define TMX_GZIP_HEADER_SIZE  10
+#define TMX_GZIP_TRAILER_SIZE 8
+#define TMX_ZLIB_HEADER_SIZE  2
+#define TMX_ZLIB_TRAILER_SIZE 4
+
+// Gzip header flags (RFC 1952, section 2.3.1)
+#define TMX_GZIP_FTEXT     0x01
+#define TMX_GZIP_FHCRC     0x02
+#define TMX_GZIP_FEXTRA    0x04
+#define TMX_GZIP_FNAME     0x08
+#define TMX_GZIP_FCOMMENT  0x10
+#define TMX_GZIP_FRESERVED 0xE0
+
+// https://nachtimwald.com/2017/11/18/base64-encode-and-decode-in-c/
+// Indexed by character value, offset by '+' (43), the lowest valid character.
+static const int decodeTable[80] = {62, -1, -1, -1, 63, 52, 53, 54, 55, 56, 57, 58, 59, 60, 61, -1, -1, -1, -1, -1,
+                                    -1, -1, 0,  1,  2,  3,  4,  5,  6,  7,  8,  9,  10, 11, 12, 13, 14, 15, 16, 17,
+                                    18, 19, 20, 21, 22, 23, 24, 25, -1, -1, -1, -1, -1, -1, 26, 27, 28, 29, 30, 31,
+                                    32, 33, 34, 35, 36, 37, 38, 39, 40, 41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51};
+
+// Decodes a group of 4 Base64 characters into its 24-bit value.
+#define TMX_BASE64_QUAD(p)                                                                                                                 \
+    (((uint32_t) decodeTable[(p)[0] - 43] << 18) | ((uint32_t) decodeTable[(p)[1] - 43] << 12) |                                          \
+     ((uint32_t) decodeTable[(p)[2] - 43] << 6) | (uint32_t) decodeTable[(p)[3] - 43])
 
 int
 tmxBase64IsValid(const char *input, size_t inputSize)
@@ -63,12 +78,6 @@ tmxBase64DecodedSize(const char *input, size_t inputSize)
 size_t
 tmxBase64Decode(const char *input, size_t inputSize, void *output, size_t outputSize)
 {
-    // https://nachtimwald.com/2017/11/18/base64-encode-and-decode-in-c/
-
-    static const int decodeTable[80] = {62, -1, -1, -1, 63, 52, 53, 54, 55, 56, 57, 58, 59, 60, 61, -1, -1, -1, -1, -1,
-                                        -1, -1, 0,  1,  2,  3,  4,  5,  6,  7,  8,  9,  10, 11, 12, 13, 14, 15, 16, 17,
-                                        18, 19, 20, 21, 22, 23, 24, 25, -1, -1, -1, -1, -1, -1, 26, 27, 28, 29, 30, 31,
-                                        32, 33, 34, 35, 36, 37, 38, 39, 40, 41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51};
 
     size_t i, j, b64Size;
     int v;
@@ -109,33 +118,166 @@ tmxBase64Decode(const char *input, size_t inputSize, void *output, size_t output
     return b64Size;
 }
 
+/**
+ * @brief Skips over a NUL-terminated string field of a Gzip header.
+ *
+ * @param[in] data The header.
+ * @param[in] size The number of bytes in @a data.
+ * @param[in,out] offset The offset of the field, which receives the offset of the byte following the terminator.
+ *
+ * @return @ref TMX_TRUE if the terminator was found, otherwise @ref TMX_FALSE if the field is truncated.
+ */
+static TMX_BOOL
+tmxGzipSkipString(const uint8_t *data, size_t size, size_t *offset)
+{
+    const uint8_t *end = memchr(&data[*offset], 0, size - *offset);
+    if (!end)
+        return TMX_FALSE;
+    *offset = (size_t) (end - data) + 1;
+    return TMX_TRUE;
+}
+
+static uint32_t
+tmxAdler32(const uint8_t *data, size_t size)
+{
+    // Largest n (a multiple of 8) such that 255n(n+1)/2 + (n+1)(65520) fits in 32 bits, allowing the modulo to be deferred.
+    static const size_t nmax = 5552;
+
+    uint32_t a = 1, b = 0;
+    size_t i, n;
+
+    while (size)
+    {
+        n = TMX_MIN(size, nmax);
+        size -= n;
+
+        // Process 8 bytes at a time, expanding the running sum so that each byte is weighted by its distance from the end
+        // of the group rather than creating a dependency chain through "b".
+        for (i = 0; i + 8 <= n; i += 8)
+        {
+            b += 8 * a + 8 * data[i] + 7 * data[i + 1] + 6 * data[i + 2] + 5 * data[i + 3] + 4 * data[i + 4] + 3 * data[i + 5] +
+                 2 * data[i + 6] + data[i + 7];
+            a += (uint32_t) data[i] + data[i + 1] + data[i + 2] + data[i + 3] + data[i + 4] + data[i + 5] + data[i + 6] + data[i + 7];
+        }
+        for (; i < n; i++)
+        {
+            a += data[i];
+            b += a;
+        }
+        data += n;
+        a %= 65521U;
+        b %= 65521U;
+    }
+    return (b << 16) | a;
+}
+
 size_t
 tmxInflateGzip(const void *input, size_t inputSize, void *output, size_t outputSize)
 {
-    if (inputSize <= TMX_GZIP_HEADER_SIZE)
+    const uint8_t *data = input;
+    size_t offset, inputUsed, outputUsed;
+    uint8_t flags;
+
+    // Validate the magic number and compression method (8 = DEFLATE).
+    if (inputSize < TMX_GZIP_HEADER_SIZE + TMX_GZIP_TRAILER_SIZE || data[0] != 0x1F || data[1] != 0x8B || data[2] != 8)
     {
-        tmxError(TMX_ERR_FORMAT);
+        tmxErrorMessage(TMX_ERR_FORMAT, "Invalid Gzip header.");
         return 0;
     }
-    size_t result = tinfl_decompress_mem_to_mem(output, outputSize, &input[TMX_GZIP_HEADER_SIZE], inputSize - TMX_GZIP_HEADER_SIZE, 0);
-    if (result == (size_t) TINFL_STATUS_FAILED)
+
+    flags = data[3];
+    if (flags & TMX_GZIP_FRESERVED)
     {
-        tmxError(TMX_ERR_FORMAT);
+        tmxErrorMessage(TMX_ERR_FORMAT, "Reserved Gzip header flags are set.");
         return 0;
     }
-    return result;
+
+    // Skip the optional fields, in the order they are specified to appear.
+    offset = TMX_GZIP_HEADER_SIZE;
+    if (flags & TMX_GZIP_FEXTRA)
+    {
+        if (inputSize - offset < 2)
+            goto truncated;
+        size_t extraSize = data[offset] | (data[offset + 1] << 8);
+        offset += 2;
+        if (inputSize - offset < extraSize)
+            goto truncated;
+        offset += extraSize;
+    }
+    if ((flags & TMX_GZIP_FNAME) && !tmxGzipSkipString(data, inputSize, &offset))
+        goto truncated;
+    if ((flags & TMX_GZIP_FCOMMENT) && !tmxGzipSkipString(data, inputSize, &offset))
+        goto truncated;
+    if (flags & TMX_GZIP_FHCRC)
+        offset += 2;
+    if (offset > inputSize || inputSize - offset < TMX_GZIP_TRAILER_SIZE)
+        goto truncated;
+
+    if (!tmxInflateRaw(&data[offset], inputSize - offset, &inputUsed, output, outputSize, &outputUsed))
+    {
+        tmxErrorMessage(TMX_ERR_FORMAT, "Invalid or truncated Gzip data.");
+        return 0;
+    }
+
+    // The trailer contains the CRC-32 followed by the size of the uncompressed data (modulo 2^32). Only the size is verified,
+    // as a bytewise CRC-32 would cost more than inflating the data did.
+    offset += inputUsed;
+    if (inputSize - offset < TMX_GZIP_TRAILER_SIZE)
+        goto truncated;
+
+    const uint8_t *isize = &data[offset + 4];
+    if (((uint32_t) isize[0] | ((uint32_t) isize[1] << 8) | ((uint32_t) isize[2] << 16) | ((uint32_t) isize[3] << 24)) !=
+        (uint32_t) outputUsed)
+    {
+        tmxErrorMessage(TMX_ERR_FORMAT, "Gzip data does not match its expected size.");
+        return 0;
+    }
+    return outputUsed;
+
+truncated:
+    tmxErrorMessage(TMX_ERR_FORMAT, "Truncated Gzip data.");
+    return 0;
 }
 
 size_t
 tmxInflateZlib(const void *input, size_t inputSize, void *output, size_t outputSize)
 {
-    size_t result = tinfl_decompress_mem_to_mem(output, outputSize, input, inputSize, TINFL_FLAG_PARSE_ZLIB_HEADER);
-    if (result == (size_t) TINFL_STATUS_FAILED)
+    const uint8_t *data = input;
+    size_t inputUsed, outputUsed;
+
+    // Compression method must be DEFLATE with a window size no greater than 32K, and the header check bits must be valid.
+    if (inputSize < TMX_ZLIB_HEADER_SIZE + TMX_ZLIB_TRAILER_SIZE || (data[0] & 0x0F) != 8 || (data[0] >> 4) > 7 ||
+        ((data[0] << 8) | data[1]) % 31 != 0)
     {
-        tmxError(TMX_ERR_FORMAT);
+        tmxErrorMessage(TMX_ERR_FORMAT, "Invalid Zlib header.");
         return 0;
     }
-    return result;
+    if (data[1] & 0x20)
+    {
+        tmxErrorMessage(TMX_ERR_UNSUPPORTED, "Zlib preset dictionaries are not supported.");
+        return 0;
+    }
+
+    if (!tmxInflateRaw(&data[TMX_ZLIB_HEADER_SIZE], inputSize - TMX_ZLIB_HEADER_SIZE, &inputUsed, output, outputSize, &outputUsed))
+    {
+        tmxErrorMessage(TMX_ERR_FORMAT, "Invalid or truncated Zlib data.");
+        return 0;
+    }
+
+    const uint8_t *trailer = &data[TMX_ZLIB_HEADER_SIZE + inputUsed];
+    if (inputSize - TMX_ZLIB_HEADER_SIZE - inputUsed < TMX_ZLIB_TRAILER_SIZE)
+    {
+        tmxErrorMessage(TMX_ERR_FORMAT, "Truncated Zlib data.");
+        return 0;
+    }
+
+    uint32_t checksum = ((uint32_t) trailer[0] << 24) | ((uint32_t) trailer[1] << 16) | ((uint32_t) trailer[2] << 8) | trailer[3];
+    if (checksum != tmxAdler32(output, outputUsed))
+    {
+        tmxErrorMessage(TMX_ERR_FORMAT, "Zlib checksum mismatch.");
+        return 0;
+    }
+    return outputUsed;
 }
 
 #ifdef TMX_NO_ZSTD
@@ -170,31 +312,101 @@ tmxInflateZstd(const void *input, size_t inputSize, void *output, size_t outputS
 
 #endif
 
+/**
+ * @brief Decodes Base64 containing uncompressed tile data directly into an array of global tile IDs.
+ *
+ * @details Every 16 characters decode to exactly 3 little-endian GIDs, which are assembled from the decoded bytes in a
+ * single pass. This is independent of the host byte order, so no separate fix-up is required on big-endian systems.
+ *
+ * @param[in] input The Base64-encoded string to decode.
+ * @param[in] inputSize The size of the @a input string, in bytes.
+ * @param[in,out] output An array to receive the decoded tile IDs.
+ * @param[in] outputCount The maximum number of elements that can be written to @a output.
+ *
+ * @return The number of tile IDs written to the @a output array.
+ */
+static size_t
+tmxBase64DecodeGids(const char *input, size_t inputSize, TMXgid *output, size_t outputCount)
+{
+    uint8_t tail[12];
+    uint32_t v0, v1, v2, v3;
+    size_t i, count = 0, tailSize;
+
+    if (inputSize % 4 != 0)
+    {
+        tmxErrorMessage(TMX_ERR_FORMAT, "Invalid length input for Base64, expected factor of 4.");
+        return 0;
+    }
+
+    // Padding can only be present in the final group, which is handled with the remainder below.
+    for (i = 0; inputSize - i >= 16 && outputCount - count >= 3 && input[i + 15] != '='; i += 16, count += 3)
+    {
+        v0 = TMX_BASE64_QUAD(&input[i]);
+        v1 = TMX_BASE64_QUAD(&input[i + 4]);
+        v2 = TMX_BASE64_QUAD(&input[i + 8]);
+        v3 = TMX_BASE64_QUAD(&input[i + 12]);
+
+        output[count]     = (v0 >> 16) | (v0 & 0xFF00U) | ((v0 & 0xFFU) << 16) | ((v1 >> 16) << 24);
+        output[count + 1] = ((v1 >> 8) & 0xFFU) | ((v1 & 0xFFU) << 8) | ((v2 >> 16) << 16) | (((v2 >> 8) & 0xFFU) << 24);
+        output[count + 2] = (v2 & 0xFFU) | ((v3 >> 16) << 8) | (((v3 >> 8) & 0xFFU) << 16) | ((v3 & 0xFFU) << 24);
+    }
+
+    if (i == inputSize || count == outputCount)
+        return count;
+
+    // Fewer than 16 characters remain (or the final group is padded), which is less than 3 GIDs.
+    tailSize = tmxBase64Decode(&input[i], TMX_MIN(inputSize - i, 16), tail, sizeof(tail));
+    for (i = 0; i + 4 <= tailSize && count < outputCount; i += 4)
+        output[count++] = tail[i] | (tail[i + 1] << 8) | (tail[i + 2] << 16) | ((TMXgid) tail[i + 3] << 24);
+
+    return count;
+}
+
 size_t
 tmxInflate(const char *input, size_t inputSize, TMXgid *output, size_t outputCount, TMX_COMPRESSION compression)
 {
     size_t outputSize, base64Size, result = 0;
     void *base64Data;
 
+    TMX_STATS_BEGIN(TMX_PHASE_BASE64);
+    TMX_TRACE_BEGIN("base64", NULL);
+    if (compression == TMX_COMPRESSION_NONE)
+    {
+        result = tmxBase64DecodeGids(input, inputSize, output, outputCount);
+        TMX_TRACE_END();
+        TMX_STATS_END(TMX_PHASE_BASE64, inputSize);
+        return result;
+    }
+
     outputSize = outputCount * sizeof(TMXgid);
     base64Size = tmxBase64DecodedSize(input, inputSize);
-    base64Data = tmxMalloc(base64Size);
+    base64Data = tmxMallocCategory(base64Size, TMX_MEMORY_TEMPORARY);
     base64Size = tmxBase64Decode(input, inputSize, base64Data, base64Size);
+    TMX_TRACE_END();
+    TMX_STATS_END(TMX_PHASE_BASE64, inputSize);
 
+    TMX_STATS_BEGIN(TMX_PHASE_INFLATE);
     switch (compression)
     {
-        case TMX_COMPRESSION_GZIP: result = tmxInflateGzip(base64Data, base64Size, output, outputSize); break;
-        case TMX_COMPRESSION_ZLIB: result = tmxInflateZlib(base64Data, base64Size, output, outputSize); break;
-        case TMX_COMPRESSION_ZSTD: result = tmxInflateZstd(base64Data, base64Size, output, outputSize); break;
-        case TMX_COMPRESSION_NONE:
-            result = TMX_MIN(base64Size, outputSize);
-            memcpy(output, base64Data, result);
+        case TMX_COMPRESSION_GZIP:
+            TMX_TRACE_BEGIN("inflate", "gzip");
+            result = tmxInflateGzip(base64Data, base64Size, output, outputSize);
+            break;
+        case TMX_COMPRESSION_ZLIB:
+            TMX_TRACE_BEGIN("inflate", "zlib");
+            result = tmxInflateZlib(base64Data, base64Size, output, outputSize);
+            break;
+        case TMX_COMPRESSION_ZSTD:
+            TMX_TRACE_BEGIN("inflate", "zstd");
+            result = tmxInflateZstd(base64Data, base64Size, output, outputSize);
             break;
         default:
-            tmxFree(base64Data);
+            TMX_TRACE_BEGIN("inflate", NULL);
             tmxError(TMX_ERR_PARAM);
-            return 0;
+            break;
     }
+    TMX_TRACE_END();
+    TMX_STATS_END(TMX_PHASE_INFLATE, base64Size);
 
     tmxFree(base64Data);
     result /= sizeof(TMXgid);
@@ -206,7 +418,7 @@ tmxInflate(const char *input, size_t inputSize, TMXgid *output, size_t outputCou
     for (i = 0; i < result; i++)
     {
         gid       = output[i];
-        output[i] = TMX_ENDIAN_SWAP32(gid);
+        output[i] = TMX_ENDIAN_SWAP(gid);
     }
 #endif
     return result;
@@ -234,8 +446,12 @@ tmxCsvDecode(const char *input, size_t inputSize, TMXgid *output, size_t outputC
 
     static const char *delim = ", \t\r\n";
 
+    TMX_STATS_BEGIN(TMX_PHASE_CSV);
+    TMX_TRACE_BEGIN("csv", NULL);
     size_t i  = 0;
-    char *p   = tmxStringCopy(input, inputSize);
+    char *p   = tmxMallocCategory(inputSize + 1, TMX_MEMORY_TEMPORARY);
+    memcpy(p, input, inputSize);
+    p[inputSize] = '\0';
 
     char *token = strtok(p, delim);
     while (token && i < outputCount)
@@ -245,5 +461,7 @@ tmxCsvDecode(const char *input, size_t inputSize, TMXgid *output, size_t outputC
     }
 
     tmxFree(p);
+    TMX_TRACE_END();
+    TMX_STATS_END(TMX_PHASE_CSV, inputSize);
     return i;
 }
\ No newline at end of file
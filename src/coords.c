@@ -0,0 +1,371 @@
+#include "tmx/coords.h"
+#include "internal.h"
+#include <math.h>
+
+#if defined(__SSE2__) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TMX_COORDS_SSE2
+#include <emmintrin.h>
+#endif
+
+/**
+ * @brief The constants used to convert coordinates, derived from the grid of a map.
+ *
+ * @details Staggered and hexagonal maps are described along two axes, which are swapped for maps staggered on the
+ * x-axis: the staggered axis, along which each index is either shifted or not, and the cross axis, along which the cells
+ * of a single index are laid out side by side.
+ */
+typedef struct TMXlayout
+{
+    TMXgrid grid;
+    float halfWidth;  /** Half the width of a cell. */
+    float halfHeight; /** Half the height of a cell. */
+    float half;       /** Half the extent of a cell along the cross axis, which is also the shift of shifted indices. */
+    float cross;      /** The distance between adjacent cells along the cross axis. */
+    float step;       /** The distance between adjacent indices along the staggered axis. */
+    float extent;     /** Half the extent of a cell along the staggered axis. */
+    float side;       /** Half the length of the flat side of a hexagon. */
+    float slope;      /** The distance between the flat side and the tip of a cell along the staggered axis. */
+    int shifted;      /** The value of the lowest bit of shifted indices. */
+} TMXlayout;
+
+void
+tmxGridInit(TMXgrid *grid, const TMXmap *map)
+{
+    grid->orientation = map->orientation;
+    grid->tileWidth   = (float) map->tile_size.w;
+    grid->tileHeight  = (float) map->tile_size.h;
+    grid->originX     = (float) map->size.h * grid->tileWidth * 0.5f;
+    grid->staggerX    = map->stagger.axis == TMX_AXIS_X;
+    grid->staggerEven = map->stagger.index == TMX_INDEX_EVEN;
+
+    // The length of the flat side of a hexagon only applies along the staggered axis, and is 0 for staggered maps.
+    float side        = map->orientation == TMX_ORIENTATION_HEXAGONAL ? (float) map->hex_side : 0.0f;
+    float sideX       = grid->staggerX ? side : 0.0f;
+    float sideY       = grid->staggerX ? 0.0f : side;
+    grid->sideLength  = side;
+    grid->columnWidth = (grid->tileWidth - sideX) * 0.5f + sideX;
+    grid->rowHeight   = (grid->tileHeight - sideY) * 0.5f + sideY;
+}
+
+TMXvec2
+tmxGridCellOrigin(const TMXgrid *grid, int x, int y)
+{
+    TMXvec2 origin;
+    switch (grid->orientation)
+    {
+        case TMX_ORIENTATION_ISOMETRIC:
+            origin.x = (float) (x - y - 1) * grid->tileWidth * 0.5f + grid->originX;
+            origin.y = (float) (x + y) * grid->tileHeight * 0.5f;
+            break;
+        case TMX_ORIENTATION_STAGGERED:
+        case TMX_ORIENTATION_HEXAGONAL:
+            if (grid->staggerX)
+            {
+                origin.x = (float) x * grid->columnWidth;
+                origin.y = (float) y * grid->tileHeight + (TMX_GRID_SHIFTED(grid, x) ? grid->rowHeight : 0.0f);
+            }
+            else
+            {
+                origin.x = (float) x * grid->tileWidth + (TMX_GRID_SHIFTED(grid, y) ? grid->columnWidth : 0.0f);
+                origin.y = (float) y * grid->rowHeight;
+            }
+            break;
+        default:
+            origin.x = (float) x * grid->tileWidth;
+            origin.y = (float) y * grid->tileHeight;
+            break;
+    }
+    return origin;
+}
+
+static void
+tmxLayoutInit(TMXlayout *layout, const TMXmap *map)
+{
+    TMXgrid *grid = &layout->grid;
+    tmxGridInit(grid, map);
+
+    layout->halfWidth  = grid->tileWidth * 0.5f;
+    layout->halfHeight = grid->tileHeight * 0.5f;
+    layout->half       = grid->staggerX ? grid->rowHeight : grid->columnWidth;
+    layout->cross      = layout->half * 2.0f;
+    layout->step       = grid->staggerX ? grid->columnWidth : grid->rowHeight;
+    layout->extent     = grid->staggerX ? layout->halfWidth : layout->halfHeight;
+    layout->side       = grid->sideLength * 0.5f;
+    layout->slope      = layout->extent - layout->side;
+    layout->shifted    = grid->staggerEven ? 0 : 1;
+}
+
+static TMX_INLINE TMX_BOOL
+tmxLayoutStaggered(const TMXlayout *layout)
+{
+    return layout->grid.orientation == TMX_ORIENTATION_STAGGERED || layout->grid.orientation == TMX_ORIENTATION_HEXAGONAL;
+}
+
+/**
+ * @brief Finds the cell at index @a k of the staggered axis that spans @a u on the cross axis.
+ *
+ * @param[out] metric Receives a measure of the distance of the point from the shape of the cell. Of the two cells that may
+ * contain a point, the one that does has the smaller measure.
+ * @return The index of the cell along the cross axis.
+ */
+static TMX_INLINE int
+tmxStaggerCell(const TMXlayout *layout, float u, float v, int k, float *metric)
+{
+    float offset = (k & 1) == layout->shifted ? layout->half : 0.0f;
+    int c        = (int) floorf((u - offset) / layout->cross);
+    float du     = u - ((float) c * layout->cross + offset + layout->half);
+    float dv     = v - ((float) k * layout->step + layout->extent);
+
+    // The point is within the shape when (|dv| - side) / slope + |du| / half <= 1. Multiplying through by both divisors
+    // avoids dividing by a slope of 0, and preserves the order between cells, which share the same divisors.
+    *metric = (fabsf(dv) - layout->side) * layout->half + fabsf(du) * layout->slope;
+    return c;
+}
+
+static TMX_INLINE TMXpoint
+tmxLayoutPixelToTile(const TMXlayout *layout, float x, float y)
+{
+    const TMXgrid *grid = &layout->grid;
+    TMXpoint tile;
+
+    if (grid->orientation == TMX_ORIENTATION_ISOMETRIC)
+    {
+        float a = y / grid->tileHeight;
+        float b = (x - grid->originX) / grid->tileWidth;
+        tile.x  = (int) floorf(a + b);
+        tile.y  = (int) floorf(a - b);
+    }
+    else if (tmxLayoutStaggered(layout))
+    {
+        // Cells of adjacent indices overlap along the staggered axis, so the point is within either the cell of the index
+        // it falls into, or the one of the index before it.
+        float u = grid->staggerX ? y : x;
+        float v = grid->staggerX ? x : y;
+        float m0, m1;
+        int k  = (int) floorf(v / layout->step);
+        int c0 = tmxStaggerCell(layout, u, v, k, &m0);
+        int c1 = tmxStaggerCell(layout, u, v, k - 1, &m1);
+        int c  = c0;
+        if (m1 < m0)
+        {
+            c = c1;
+            k--;
+        }
+        tile.x = grid->staggerX ? k : c;
+        tile.y = grid->staggerX ? c : k;
+    }
+    else
+    {
+        tile.x = (int) floorf(x / grid->tileWidth);
+        tile.y = (int) floorf(y / grid->tileHeight);
+    }
+    return tile;
+}
+
+static TMX_INLINE TMXvec2
+tmxLayoutTileToPixel(const TMXlayout *layout, int x, int y)
+{
+    const TMXgrid *grid = &layout->grid;
+    TMXvec2 pixel;
+
+    if (grid->orientation == TMX_ORIENTATION_ISOMETRIC)
+    {
+        pixel.x = (float) (x - y) * layout->halfWidth + grid->originX;
+        pixel.y = (float) (x + y + 1) * layout->halfHeight;
+    }
+    else if (tmxLayoutStaggered(layout))
+    {
+        int k        = grid->staggerX ? x : y;
+        int c        = grid->staggerX ? y : x;
+        float offset = (k & 1) == layout->shifted ? layout->half : 0.0f;
+        float u      = (float) c * layout->cross + offset + layout->half;
+        float v      = (float) k * layout->step + layout->extent;
+        pixel.x      = grid->staggerX ? v : u;
+        pixel.y      = grid->staggerX ? u : v;
+    }
+    else
+    {
+        pixel.x = (float) x * grid->tileWidth + layout->halfWidth;
+        pixel.y = (float) y * grid->tileHeight + layout->halfHeight;
+    }
+    return pixel;
+}
+
+#ifdef TMX_COORDS_SSE2
+
+/**
+ * @brief Computes the floor of each lane as an integer, identical to a scalar @c floorf followed by a cast.
+ */
+static TMX_INLINE __m128i
+tmxFloor4(__m128 value)
+{
+    // Truncation rounds toward zero, so negative values with a fraction are one too large. The comparison mask is -1
+    // in exactly those lanes.
+    __m128i i = _mm_cvttps_epi32(value);
+    return _mm_add_epi32(i, _mm_castps_si128(_mm_cmpgt_ps(_mm_cvtepi32_ps(i), value)));
+}
+
+static TMX_INLINE __m128
+tmxAbs4(__m128 value)
+{
+    return _mm_andnot_ps(_mm_set1_ps(-0.0f), value);
+}
+
+static TMX_INLINE __m128i
+tmxSelect4(__m128i mask, __m128i a, __m128i b)
+{
+    return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+/**
+ * @brief Computes the shift of each lane at index @a k of the staggered axis, see @ref tmxStaggerCell.
+ */
+static TMX_INLINE __m128
+tmxStaggerOffset4(const TMXlayout *layout, __m128i k)
+{
+    __m128i shifted = _mm_cmpeq_epi32(_mm_and_si128(k, _mm_set1_epi32(1)), _mm_set1_epi32(layout->shifted));
+    return _mm_and_ps(_mm_castsi128_ps(shifted), _mm_set1_ps(layout->half));
+}
+
+static TMX_INLINE __m128i
+tmxStaggerCell4(const TMXlayout *layout, __m128 u, __m128 v, __m128i k, __m128 *metric)
+{
+    __m128 half   = _mm_set1_ps(layout->half);
+    __m128 cross  = _mm_set1_ps(layout->cross);
+    __m128 slope  = _mm_set1_ps(layout->slope);
+    __m128 offset = tmxStaggerOffset4(layout, k);
+    __m128i c     = tmxFloor4(_mm_div_ps(_mm_sub_ps(u, offset), cross));
+    __m128 du     = _mm_sub_ps(u, _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(c), cross), offset), half));
+    __m128 dv     = _mm_sub_ps(v, _mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(k), _mm_set1_ps(layout->step)), _mm_set1_ps(layout->extent)));
+
+    *metric = _mm_add_ps(_mm_mul_ps(_mm_sub_ps(tmxAbs4(dv), _mm_set1_ps(layout->side)), half), _mm_mul_ps(tmxAbs4(du), slope));
+    return c;
+}
+
+static TMX_INLINE void
+tmxLayoutPixelToTile4(const TMXlayout *layout, __m128 x, __m128 y, __m128i *tx, __m128i *ty)
+{
+    const TMXgrid *grid = &layout->grid;
+
+    if (grid->orientation == TMX_ORIENTATION_ISOMETRIC)
+    {
+        __m128 a = _mm_div_ps(y, _mm_set1_ps(grid->tileHeight));
+        __m128 b = _mm_div_ps(_mm_sub_ps(x, _mm_set1_ps(grid->originX)), _mm_set1_ps(grid->tileWidth));
+        *tx      = tmxFloor4(_mm_add_ps(a, b));
+        *ty      = tmxFloor4(_mm_sub_ps(a, b));
+    }
+    else if (tmxLayoutStaggered(layout))
+    {
+        __m128 u = grid->staggerX ? y : x;
+        __m128 v = grid->staggerX ? x : y;
+        __m128 m0, m1;
+        __m128i k0   = tmxFloor4(_mm_div_ps(v, _mm_set1_ps(layout->step)));
+        __m128i k1   = _mm_sub_epi32(k0, _mm_set1_epi32(1));
+        __m128i c0   = tmxStaggerCell4(layout, u, v, k0, &m0);
+        __m128i c1   = tmxStaggerCell4(layout, u, v, k1, &m1);
+        __m128i mask = _mm_castps_si128(_mm_cmplt_ps(m1, m0));
+        __m128i k    = tmxSelect4(mask, k1, k0);
+        __m128i c    = tmxSelect4(mask, c1, c0);
+        *tx          = grid->staggerX ? k : c;
+        *ty          = grid->staggerX ? c : k;
+    }
+    else
+    {
+        *tx = tmxFloor4(_mm_div_ps(x, _mm_set1_ps(grid->tileWidth)));
+        *ty = tmxFloor4(_mm_div_ps(y, _mm_set1_ps(grid->tileHeight)));
+    }
+}
+
+static TMX_INLINE void
+tmxLayoutTileToPixel4(const TMXlayout *layout, __m128i x, __m128i y, __m128 *px, __m128 *py)
+{
+    const TMXgrid *grid = &layout->grid;
+
+    if (grid->orientation == TMX_ORIENTATION_ISOMETRIC)
+    {
+        __m128 sum = _mm_cvtepi32_ps(_mm_add_epi32(_mm_add_epi32(x, y), _mm_set1_epi32(1)));
+        *px        = _mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(_mm_sub_epi32(x, y)), _mm_set1_ps(layout->halfWidth)), _mm_set1_ps(grid->originX));
+        *py        = _mm_mul_ps(sum, _mm_set1_ps(layout->halfHeight));
+    }
+    else if (tmxLayoutStaggered(layout))
+    {
+        __m128i k     = grid->staggerX ? x : y;
+        __m128i c     = grid->staggerX ? y : x;
+        __m128 offset = tmxStaggerOffset4(layout, k);
+        __m128 u      = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(c), _mm_set1_ps(layout->cross)), offset), _mm_set1_ps(layout->half));
+        __m128 v      = _mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(k), _mm_set1_ps(layout->step)), _mm_set1_ps(layout->extent));
+        *px           = grid->staggerX ? v : u;
+        *py           = grid->staggerX ? u : v;
+    }
+    else
+    {
+        *px = _mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(x), _mm_set1_ps(grid->tileWidth)), _mm_set1_ps(layout->halfWidth));
+        *py = _mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(y), _mm_set1_ps(grid->tileHeight)), _mm_set1_ps(layout->halfHeight));
+    }
+}
+
+#endif /* TMX_COORDS_SSE2 */
+
+TMXpoint
+tmxPixelToTile(const TMXmap *map, TMXvec2 pixel)
+{
+    TMXlayout layout;
+    tmxLayoutInit(&layout, map);
+    return tmxLayoutPixelToTile(&layout, pixel.x, pixel.y);
+}
+
+TMXvec2
+tmxTileToPixel(const TMXmap *map, TMXpoint tile)
+{
+    TMXlayout layout;
+    tmxLayoutInit(&layout, map);
+    return tmxLayoutTileToPixel(&layout, tile.x, tile.y);
+}
+
+void
+tmxPixelsToTiles(const TMXmap *map, const TMXvec2 *pixels, TMXpoint *tiles, size_t count)
+{
+    TMXlayout layout;
+    size_t i = 0;
+    tmxLayoutInit(&layout, map);
+
+#ifdef TMX_COORDS_SSE2
+    // Four points are loaded as two pairs of interleaved x/y components, and split into a vector for each axis.
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 a = _mm_loadu_ps(&pixels[i].x);
+        __m128 b = _mm_loadu_ps(&pixels[i + 2].x);
+        __m128i x, y;
+        tmxLayoutPixelToTile4(&layout, _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)), _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)), &x, &y);
+        _mm_storeu_si128((__m128i *) &tiles[i], _mm_unpacklo_epi32(x, y));
+        _mm_storeu_si128((__m128i *) &tiles[i + 2], _mm_unpackhi_epi32(x, y));
+    }
+#endif
+
+    for (; i < count; i++)
+        tiles[i] = tmxLayoutPixelToTile(&layout, pixels[i].x, pixels[i].y);
+}
+
+void
+tmxTilesToPixels(const TMXmap *map, const TMXpoint *tiles, TMXvec2 *pixels, size_t count)
+{
+    TMXlayout layout;
+    size_t i = 0;
+    tmxLayoutInit(&layout, map);
+
+#ifdef TMX_COORDS_SSE2
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 a = _mm_castsi128_ps(_mm_loadu_si128((const __m128i *) &tiles[i]));
+        __m128 b = _mm_castsi128_ps(_mm_loadu_si128((const __m128i *) &tiles[i + 2]));
+        __m128 x, y;
+        tmxLayoutTileToPixel4(&layout, _mm_castps_si128(_mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0))),
+                              _mm_castps_si128(_mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1))), &x, &y);
+        _mm_storeu_ps(&pixels[i].x, _mm_unpacklo_ps(x, y));
+        _mm_storeu_ps(&pixels[i + 2].x, _mm_unpackhi_ps(x, y));
+    }
+#endif
+
+    for (; i < count; i++)
+        pixels[i] = tmxLayoutTileToPixel(&layout, tiles[i].x, tiles[i].y);
+}
@@ -0,0 +1,623 @@
+#include "tmx/cull.h"
+#include "internal.h"
+#include <limits.h>
+#include <math.h>
+#include <stdlib.h>
+
+/**
+ * @brief The number of cells a chunk index may have beyond four per chunk, before the chunks are sorted instead.
+ */
+#define TMX_CULL_INDEX_SLACK 64
+
+typedef struct TMXchunkkey
+{
+    int y;        /** The top row of the chunk, in tile units. */
+    int x;        /** The left column of the chunk, in tile units. */
+    size_t chunk; /** The index of the chunk within the layer. */
+} TMXchunkkey;
+
+typedef struct TMXchunkindex
+{
+    TMXrect bounds;    /** The rectangle containing every tile of the layer, in tile units. */
+    TMXsize size;      /** The size shared by all chunks, in tile units. */
+    TMXpoint origin;   /** The cell of the first column/row of the index, in chunk units. */
+    int columns;       /** The number of columns of the index. */
+    int rows;          /** The number of rows of the index. */
+    size_t *cells;     /** One plus the index of the chunk in each cell, or 0 when empty. NULL when chunks are sorted. */
+    TMXsize largest;   /** The largest width and height of any chunk, in tile units. */
+    TMXchunkkey *keys; /** The chunks sorted by row and then column, when they are not in a dense index. */
+} TMXchunkindex;
+
+typedef struct TMXcullrange
+{
+    size_t span;  /** The index of the first span of a visible layer. */
+    size_t chunk; /** The index of the first chunk of a visible layer. */
+} TMXcullrange;
+
+struct TMXculler
+{
+    const TMXmap *map;
+    const TMXflatlayers *layers;
+    TMXgrid grid;
+    TMXchunkindex *indices;   /** The bounds and chunk index of each layer, parallel to the flattened layers. */
+    TMXvisiblelayer *visible; /** The result of the last query. */
+    TMXcullrange *ranges;     /** The position of each visible layer's spans and chunks within the shared buffers. */
+    TMXtilespan *spans;
+    size_t spanCount;
+    size_t spanCapacity;
+    size_t *chunks;
+    size_t chunkCount;
+    size_t chunkCapacity;
+};
+
+static TMX_INLINE int
+tmxFloorDiv(int a, int b)
+{
+    int q = a / b;
+    return (a % b != 0 && (a < 0) != (b < 0)) ? q - 1 : q;
+}
+
+/**
+ * @brief Computes the smallest integer strictly greater than @a value, clamped to the range of @a min to @a max + 1.
+ */
+static TMX_INLINE int
+tmxCullAbove(double value, int min, int max)
+{
+    if (value < min)
+        return min;
+    if (value >= max)
+        return max + 1;
+    return (int) floor(value) + 1;
+}
+
+/**
+ * @brief Computes the largest integer strictly less than @a value, clamped to the range of @a min - 1 to @a max.
+ */
+static TMX_INLINE int
+tmxCullBelow(double value, int min, int max)
+{
+    if (value > max)
+        return max;
+    if (value <= min)
+        return min - 1;
+    return (int) ceil(value) - 1;
+}
+
+static TMX_BOOL
+tmxCullPushSpan(TMXculler *culler, int y, int first, int last)
+{
+    if (first > last)
+        return TMX_TRUE;
+
+    if (culler->spanCount == culler->spanCapacity)
+    {
+        size_t capacity    = culler->spanCapacity ? culler->spanCapacity * 2 : 256;
+        TMXtilespan *spans = tmxRealloc(culler->spans, capacity * sizeof(TMXtilespan));
+        if (!spans)
+            return TMX_FALSE;
+        culler->spans        = spans;
+        culler->spanCapacity = capacity;
+    }
+
+    TMXtilespan *span = &culler->spans[culler->spanCount++];
+    span->y           = y;
+    span->first       = first;
+    span->last        = last;
+    return TMX_TRUE;
+}
+
+/**
+ * @brief Trims the ends of the spans of a tile layer to the blocks its occupancy pyramid does not rule out, removing the
+ * spans that are entirely empty.
+ */
+static void
+tmxCullTrimSpans(TMXculler *culler, const TMXlayer *layer, size_t spanStart)
+{
+    const TMXoccupancy *occupancy = layer->occupancy;
+    size_t i, count               = spanStart;
+    int first, last, y;
+
+    for (i = spanStart; i < culler->spanCount; i++)
+    {
+        TMXtilespan span = culler->spans[i];
+        y                = span.y - layer->position.y;
+        first            = tmxOccupancyNext(occupancy, span.first - layer->position.x, y, span.last - layer->position.x + 1);
+        if (first > span.last - layer->position.x)
+            continue;
+
+        last       = tmxOccupancyPrevious(occupancy, span.last - layer->position.x, y, first);
+        span.first = first + layer->position.x;
+        span.last  = last + layer->position.x;
+
+        culler->spans[count++] = span;
+    }
+    culler->spanCount = count;
+}
+
+static TMX_BOOL
+tmxCullPushChunk(TMXculler *culler, size_t index)
+{
+    if (culler->chunkCount == culler->chunkCapacity)
+    {
+        size_t capacity = culler->chunkCapacity ? culler->chunkCapacity * 2 : 64;
+        size_t *chunks  = tmxRealloc(culler->chunks, capacity * sizeof(size_t));
+        if (!chunks)
+            return TMX_FALSE;
+        culler->chunks        = chunks;
+        culler->chunkCapacity = capacity;
+    }
+
+    culler->chunks[culler->chunkCount++] = index;
+    return TMX_TRUE;
+}
+
+static TMX_BOOL
+tmxCullOrthogonal(TMXculler *culler, const TMXrect *bounds, double x0, double y0, double x1, double y1)
+{
+    const TMXgrid *grid = &culler->grid;
+    int right           = bounds->x + bounds->w - 1;
+    int bottom          = bounds->y + bounds->h - 1;
+
+    int first = tmxCullAbove(x0 / grid->tileWidth - 1.0, bounds->x, right);
+    int last  = tmxCullBelow(x1 / grid->tileWidth, bounds->x, right);
+    int top   = tmxCullAbove(y0 / grid->tileHeight - 1.0, bounds->y, bottom);
+    int end   = tmxCullBelow(y1 / grid->tileHeight, bounds->y, bottom);
+
+    for (int y = top; y <= end; y++)
+    {
+        if (!tmxCullPushSpan(culler, y, first, last))
+            return TMX_FALSE;
+    }
+    return TMX_TRUE;
+}
+
+static TMX_BOOL
+tmxCullIsometric(TMXculler *culler, const TMXrect *bounds, double x0, double y0, double x1, double y1)
+{
+    const TMXgrid *grid = &culler->grid;
+    double halfWidth    = grid->tileWidth * 0.5;
+    double halfHeight   = grid->tileHeight * 0.5;
+    int right           = bounds->x + bounds->w - 1;
+    int bottom          = bounds->y + bounds->h - 1;
+
+    // The bounding box of a cell only depends on the diagonals u = x - y (horizontally) and v = x + y (vertically).
+    int uMin = tmxCullAbove((x0 - grid->originX) / halfWidth - 1.0, bounds->x - bottom, right - bounds->y);
+    int uMax = tmxCullBelow((x1 - grid->originX) / halfWidth + 1.0, bounds->x - bottom, right - bounds->y);
+    int vMin = tmxCullAbove(y0 / halfHeight - 2.0, bounds->x + bounds->y, right + bottom);
+    int vMax = tmxCullBelow(y1 / halfHeight, bounds->x + bounds->y, right + bottom);
+    if (uMin > uMax || vMin > vMax)
+        return TMX_TRUE;
+
+    int top = TMX_MAX(bounds->y, tmxFloorDiv(vMin - uMax + 1, 2));
+    int end = TMX_MIN(bottom, tmxFloorDiv(vMax - uMin, 2));
+
+    for (int y = top; y <= end; y++)
+    {
+        int first = TMX_MAX(bounds->x, TMX_MAX(uMin + y, vMin - y));
+        int last  = TMX_MIN(right, TMX_MIN(uMax + y, vMax - y));
+        if (!tmxCullPushSpan(culler, y, first, last))
+            return TMX_FALSE;
+    }
+    return TMX_TRUE;
+}
+
+static TMX_BOOL
+tmxCullStaggered(TMXculler *culler, const TMXrect *bounds, double x0, double y0, double x1, double y1)
+{
+    const TMXgrid *grid = &culler->grid;
+    int right           = bounds->x + bounds->w - 1;
+    int bottom          = bounds->y + bounds->h - 1;
+    int y, first, last;
+
+    if (!grid->staggerX)
+    {
+        // Rows are placed in steps of the row height, and every other row is shifted by half of a cell.
+        double step = grid->columnWidth * 2.0;
+        int top     = tmxCullAbove((y0 - grid->tileHeight) / grid->rowHeight, bounds->y, bottom);
+        int end     = tmxCullBelow(y1 / grid->rowHeight, bounds->y, bottom);
+
+        for (y = top; y <= end; y++)
+        {
+            double shift = TMX_GRID_SHIFTED(grid, y) ? grid->columnWidth : 0.0;
+            first        = tmxCullAbove((x0 - shift - grid->tileWidth) / step, bounds->x, right);
+            last         = tmxCullBelow((x1 - shift) / step, bounds->x, right);
+            if (!tmxCullPushSpan(culler, y, first, last))
+                return TMX_FALSE;
+        }
+        return TMX_TRUE;
+    }
+
+    // Columns are staggered instead, so the visible rows differ between shifted and unshifted columns.
+    double step = grid->rowHeight * 2.0;
+    first       = tmxCullAbove((x0 - grid->tileWidth) / grid->columnWidth, bounds->x, right);
+    last        = tmxCullBelow(x1 / grid->columnWidth, bounds->x, right);
+    if (first > last)
+        return TMX_TRUE;
+
+    int topPlain   = tmxCullAbove((y0 - grid->tileHeight) / step, bounds->y, bottom);
+    int endPlain   = tmxCullBelow(y1 / step, bounds->y, bottom);
+    int topShifted = tmxCullAbove((y0 - grid->rowHeight - grid->tileHeight) / step, bounds->y, bottom);
+    int endShifted = tmxCullBelow((y1 - grid->rowHeight) / step, bounds->y, bottom);
+    int top        = TMX_MIN(topPlain, topShifted);
+    int end        = TMX_MAX(endPlain, endShifted);
+
+    for (y = top; y <= end; y++)
+    {
+        TMX_BOOL plain   = y >= topPlain && y <= endPlain;
+        TMX_BOOL shifted = y >= topShifted && y <= endShifted;
+        int spanFirst    = first;
+        int spanLast     = last;
+
+        // At the edges only one kind of column is visible, so trim the ends of the span to columns of that kind.
+        if (plain != shifted)
+        {
+            if ((TMX_GRID_SHIFTED(grid, spanFirst) != 0) != shifted)
+                spanFirst++;
+            if ((TMX_GRID_SHIFTED(grid, spanLast) != 0) != shifted)
+                spanLast--;
+        }
+        if (!tmxCullPushSpan(culler, y, spanFirst, spanLast))
+            return TMX_FALSE;
+    }
+    return TMX_TRUE;
+}
+
+static TMX_BOOL
+tmxCullChunkVisible(const TMXrect *rect, const TMXtilespan *spans, size_t count)
+{
+    // Spans are ordered by row, so find the first row of the chunk with a binary search.
+    size_t lo = 0, hi = count, mid;
+    while (lo < hi)
+    {
+        mid = lo + (hi - lo) / 2;
+        if (spans[mid].y < rect->y)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    for (; lo < count && spans[lo].y < rect->y + rect->h; lo++)
+    {
+        if (spans[lo].last >= rect->x && spans[lo].first < rect->x + rect->w)
+            return TMX_TRUE;
+    }
+    return TMX_FALSE;
+}
+
+/**
+ * @brief Finds the first key at or after @a start that is not ordered before the position @a x, @a y.
+ */
+static size_t
+tmxCullFindKey(const TMXchunkkey *keys, size_t start, size_t count, int x, int y)
+{
+    size_t lo = start, hi = count, mid;
+    while (lo < hi)
+    {
+        mid = lo + (hi - lo) / 2;
+        if (keys[mid].y < y || (keys[mid].y == y && keys[mid].x < x))
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+static TMX_BOOL
+tmxCullSortedChunks(TMXculler *culler, const TMXlayer *layer, const TMXchunkindex *index, const TMXrect *visible, size_t spanStart)
+{
+    const TMXtilespan *spans = culler->spans + spanStart;
+    size_t spanCount         = culler->spanCount - spanStart;
+    const TMXchunkkey *keys  = index->keys;
+    size_t i, count = layer->count;
+
+    // A chunk can only reach the visible tiles if it begins less than the largest chunk size above or left of them.
+    int top    = visible->y - index->largest.h + 1;
+    int bottom = visible->y + visible->h - 1;
+    int left   = visible->x - index->largest.w + 1;
+    int right  = visible->x + visible->w - 1;
+
+    // Each row of chunks that may be visible is searched for its first candidate column, so the cost depends on the
+    // number of rows and visible chunks rather than the total number of chunks.
+    i = tmxCullFindKey(keys, 0, count, INT_MIN, top);
+    while (i < count && keys[i].y <= bottom)
+    {
+        int row = keys[i].y;
+        for (i = tmxCullFindKey(keys, i, count, left, row); i < count && keys[i].y == row && keys[i].x <= right; i++)
+        {
+            if (tmxCullChunkVisible(&layer->data.chunks[keys[i].chunk].bounds, spans, spanCount) &&
+                !tmxCullPushChunk(culler, keys[i].chunk))
+                return TMX_FALSE;
+        }
+        if (row == INT_MAX)
+            break;
+        i = tmxCullFindKey(keys, i, count, INT_MIN, row + 1);
+    }
+    return TMX_TRUE;
+}
+
+static TMX_BOOL
+tmxCullChunks(TMXculler *culler, const TMXlayer *layer, const TMXchunkindex *index, const TMXrect *visible, size_t spanStart)
+{
+    const TMXtilespan *spans = culler->spans + spanStart;
+    size_t spanCount         = culler->spanCount - spanStart;
+
+    if (!index->cells)
+        return tmxCullSortedChunks(culler, layer, index, visible, spanStart);
+
+    int left   = TMX_MAX(0, tmxFloorDiv(visible->x, index->size.w) - index->origin.x);
+    int right  = TMX_MIN(index->columns - 1, tmxFloorDiv(visible->x + visible->w - 1, index->size.w) - index->origin.x);
+    int top    = TMX_MAX(0, tmxFloorDiv(visible->y, index->size.h) - index->origin.y);
+    int bottom = TMX_MIN(index->rows - 1, tmxFloorDiv(visible->y + visible->h - 1, index->size.h) - index->origin.y);
+
+    for (int y = top; y <= bottom; y++)
+    {
+        for (int x = left; x <= right; x++)
+        {
+            size_t cell = index->cells[(size_t) y * (size_t) index->columns + (size_t) x];
+            if (!cell || !tmxCullChunkVisible(&layer->data.chunks[cell - 1].bounds, spans, spanCount))
+                continue;
+            if (!tmxCullPushChunk(culler, cell - 1))
+                return TMX_FALSE;
+        }
+    }
+    return TMX_TRUE;
+}
+
+static int
+tmxCullCompareKeys(const void *a, const void *b)
+{
+    const TMXchunkkey *ka = a, *kb = b;
+    if (ka->y != kb->y)
+        return ka->y < kb->y ? -1 : 1;
+    if (ka->x != kb->x)
+        return ka->x < kb->x ? -1 : 1;
+    return ka->chunk < kb->chunk ? -1 : ka->chunk > kb->chunk;
+}
+
+static TMX_BOOL
+tmxCullSortChunks(TMXchunkindex *index, const TMXlayer *layer)
+{
+    size_t i;
+
+    index->keys = tmxMalloc(layer->count * sizeof(TMXchunkkey));
+    if (!index->keys)
+        return TMX_FALSE;
+
+    index->largest.w = 1;
+    index->largest.h = 1;
+    for (i = 0; i < layer->count; i++)
+    {
+        const TMXrect *bounds = &layer->data.chunks[i].bounds;
+        index->keys[i].y      = bounds->y;
+        index->keys[i].x      = bounds->x;
+        index->keys[i].chunk  = i;
+        index->largest.w      = TMX_MAX(index->largest.w, bounds->w);
+        index->largest.h      = TMX_MAX(index->largest.h, bounds->h);
+    }
+    qsort(index->keys, layer->count, sizeof(TMXchunkkey), tmxCullCompareKeys);
+    return TMX_TRUE;
+}
+
+static TMX_BOOL
+tmxCullIndexChunks(TMXchunkindex *index, const TMXlayer *layer)
+{
+    if (!layer->count)
+        return TMX_TRUE;
+
+    const TMXchunk *chunk = &layer->data.chunks[0];
+    TMX_BOOL uniform      = chunk->bounds.w > 0 && chunk->bounds.h > 0;
+    int left = chunk->bounds.x, top = chunk->bounds.y;
+    int right = left + chunk->bounds.w, bottom = top + chunk->bounds.h;
+    size_t i;
+
+    index->size = chunk->bounds.size;
+    for (i = 0; i < layer->count; i++)
+    {
+        chunk  = &layer->data.chunks[i];
+        left   = TMX_MIN(left, chunk->bounds.x);
+        top    = TMX_MIN(top, chunk->bounds.y);
+        right  = TMX_MAX(right, chunk->bounds.x + chunk->bounds.w);
+        bottom = TMX_MAX(bottom, chunk->bounds.y + chunk->bounds.h);
+
+        // Tiled always writes chunks of one size, aligned to multiples of it, but other editors might not.
+        if (uniform && (chunk->bounds.w != index->size.w || chunk->bounds.h != index->size.h ||
+                        chunk->bounds.x % index->size.w || chunk->bounds.y % index->size.h))
+            uniform = TMX_FALSE;
+    }
+
+    index->bounds.x = left;
+    index->bounds.y = top;
+    index->bounds.w = right - left;
+    index->bounds.h = bottom - top;
+    if (!uniform)
+        return tmxCullSortChunks(index, layer);
+
+    index->origin.x = tmxFloorDiv(left, index->size.w);
+    index->origin.y = tmxFloorDiv(top, index->size.h);
+    index->columns  = tmxFloorDiv(right - 1, index->size.w) - index->origin.x + 1;
+    index->rows     = tmxFloorDiv(bottom - 1, index->size.h) - index->origin.y + 1;
+
+    // Chunks that are far apart would make a dense index mostly empty, so those layers are sorted instead.
+    size_t cells = (size_t) index->columns * (size_t) index->rows;
+    if (cells > layer->count * 4 + TMX_CULL_INDEX_SLACK)
+        return tmxCullSortChunks(index, layer);
+
+    index->cells = tmxCalloc(cells, sizeof(size_t));
+    if (!index->cells)
+        return TMX_FALSE;
+
+    for (i = 0; i < layer->count; i++)
+    {
+        chunk = &layer->data.chunks[i];
+        int x = chunk->bounds.x / index->size.w - index->origin.x;
+        int y = chunk->bounds.y / index->size.h - index->origin.y;
+        index->cells[(size_t) y * (size_t) index->columns + (size_t) x] = i + 1;
+    }
+    return TMX_TRUE;
+}
+
+TMXculler *
+tmxCullerCreate(const TMXmap *map, const TMXflatlayers *layers)
+{
+    if (!map || !layers)
+    {
+        tmxError(TMX_ERR_VALUE);
+        return NULL;
+    }
+
+    TMXculler *culler = TMX_ALLOC(TMXculler);
+    if (!culler)
+        return NULL;
+
+    culler->map     = map;
+    culler->layers  = layers;
+    culler->indices = tmxCalloc(TMX_MAX(layers->count, 1), sizeof(TMXchunkindex));
+    culler->visible = tmxCalloc(TMX_MAX(layers->count, 1), sizeof(TMXvisiblelayer));
+    culler->ranges  = tmxCalloc(TMX_MAX(layers->count, 1), sizeof(TMXcullrange));
+    if (!culler->indices || !culler->visible || !culler->ranges)
+    {
+        tmxFreeCuller(culler);
+        return NULL;
+    }
+    tmxGridInit(&culler->grid, map);
+
+    size_t i;
+    const TMXlayer *layer;
+    for (i = 0; i < layers->count; i++)
+    {
+        layer = layers->layers[i].layer;
+        if (layer->type == TMX_LAYER_TILE)
+        {
+            culler->indices[i].bounds.x = layer->position.x;
+            culler->indices[i].bounds.y = layer->position.y;
+            culler->indices[i].bounds.w = layer->size.w;
+            culler->indices[i].bounds.h = layer->size.h;
+        }
+        else if (layer->type == TMX_LAYER_CHUNK && !tmxCullIndexChunks(&culler->indices[i], layer))
+        {
+            tmxFreeCuller(culler);
+            return NULL;
+        }
+    }
+
+    return culler;
+}
+
+size_t
+tmxCull(TMXculler *culler, float x, float y, float width, float height, const TMXvisiblelayer **layers)
+{
+    if (!culler || !layers)
+    {
+        tmxError(TMX_ERR_VALUE);
+        return 0;
+    }
+
+    const TMXflatlayer *flat;
+    const TMXchunkindex *index;
+    TMXvisiblelayer *visible;
+    TMX_BOOL result;
+    size_t i, count = 0;
+
+    // Parallax scrolling is relative to the center of the viewport, as in Tiled.
+    double centerX = x + width * 0.5 - culler->map->parallax_origin.x;
+    double centerY = y + height * 0.5 - culler->map->parallax_origin.y;
+
+    culler->spanCount  = 0;
+    culler->chunkCount = 0;
+    *layers            = culler->visible;
+
+    for (i = 0; i < culler->layers->count; i++)
+    {
+        flat  = &culler->layers->layers[i];
+        index = &culler->indices[i];
+        if (!flat->visible || index->bounds.w <= 0 || index->bounds.h <= 0)
+            continue;
+
+        double offsetX   = flat->offset.x + (1.0 - flat->parallax.x) * centerX;
+        double offsetY   = flat->offset.y + (1.0 - flat->parallax.y) * centerY;
+        double x0        = x - offsetX;
+        double y0        = y - offsetY;
+        double x1        = x0 + width;
+        double y1        = y0 + height;
+        size_t spanStart = culler->spanCount;
+
+        switch (culler->grid.orientation)
+        {
+            case TMX_ORIENTATION_ISOMETRIC: result = tmxCullIsometric(culler, &index->bounds, x0, y0, x1, y1); break;
+            case TMX_ORIENTATION_STAGGERED:
+            case TMX_ORIENTATION_HEXAGONAL: result = tmxCullStaggered(culler, &index->bounds, x0, y0, x1, y1); break;
+            default: result = tmxCullOrthogonal(culler, &index->bounds, x0, y0, x1, y1); break;
+        }
+        if (!result)
+            return 0;
+        if (flat->layer->type == TMX_LAYER_TILE && flat->layer->occupancy)
+            tmxCullTrimSpans(culler, flat->layer, spanStart);
+        if (culler->spanCount == spanStart)
+            continue;
+
+        visible           = &culler->visible[count];
+        visible->flat     = flat;
+        visible->offset.x = (float) offsetX;
+        visible->offset.y = (float) offsetY;
+
+        // Spans are ordered by row, so only the columns need to be searched for the extent of the visible tiles.
+        const TMXtilespan *spans = culler->spans + spanStart;
+        size_t spanCount         = culler->spanCount - spanStart;
+        int left = spans[0].first, right = spans[0].last;
+        for (size_t s = 1; s < spanCount; s++)
+        {
+            left  = TMX_MIN(left, spans[s].first);
+            right = TMX_MAX(right, spans[s].last);
+        }
+        visible->bounds.x   = left;
+        visible->bounds.y   = spans[0].y;
+        visible->bounds.w   = right - left + 1;
+        visible->bounds.h   = spans[spanCount - 1].y - spans[0].y + 1;
+        visible->span_count = spanCount;
+
+        culler->ranges[count].span  = spanStart;
+        culler->ranges[count].chunk = culler->chunkCount;
+        if (flat->layer->type == TMX_LAYER_CHUNK && !tmxCullChunks(culler, flat->layer, index, &visible->bounds, spanStart))
+            return 0;
+        visible->chunk_count = culler->chunkCount - culler->ranges[count].chunk;
+
+        // A viewport between the chunks of a layer has nothing to draw, and the layer is omitted like an empty one.
+        if (flat->layer->type == TMX_LAYER_CHUNK && !visible->chunk_count)
+        {
+            culler->spanCount  = spanStart;
+            culler->chunkCount = culler->ranges[count].chunk;
+            continue;
+        }
+        count++;
+    }
+
+    // The buffers may have moved while growing, so the arrays of each layer are only assigned once they are complete.
+    for (i = 0; i < count; i++)
+    {
+        culler->visible[i].spans  = culler->spans + culler->ranges[i].span;
+        culler->visible[i].chunks = culler->visible[i].chunk_count ? culler->chunks + culler->ranges[i].chunk : NULL;
+    }
+    return count;
+}
+
+void
+tmxFreeCuller(TMXculler *culler)
+{
+    if (!culler)
+        return;
+
+    if (culler->indices && culler->layers)
+    {
+        for (size_t i = 0; i < culler->layers->count; i++)
+        {
+            tmxFree(culler->indices[i].cells);
+            tmxFree(culler->indices[i].keys);
+        }
+    }
+    tmxFree(culler->indices);
+    tmxFree(culler->visible);
+    tmxFree(culler->ranges);
+    tmxFree(culler->spans);
+    tmxFree(culler->chunks);
+    tmxFree(culler);
+}
@@ -0,0 +1,310 @@
+#include "tmx/distance.h"
+#include "internal.h"
+#include <math.h>
+
+struct TMXdistance
+{
+    const uint8_t *values;      /** The grid of feature cells. */
+    uint8_t *owned;             /** The grid when filled from layers, otherwise @c NULL. */
+    uint32_t *columns;          /** The distance from each cell to the nearest feature in its column, from the first phase. */
+    TMXrect region;             /** The cells of the grid, in tile units. */
+    uint32_t infinity;          /** The distance of cells without a feature in their column, greater than any actual distance. */
+    TMX_DISTANCE_METRIC metric;
+};
+
+/**
+ * @brief Divides two integers, rounding towards negative infinity.
+ */
+static TMX_INLINE int64_t
+tmxDistanceFloorDiv(int64_t a, int64_t b)
+{
+    int64_t q = a / b;
+    return (a % b != 0 && ((a < 0) != (b < 0))) ? q - 1 : q;
+}
+
+/**
+ * @brief Computes the distance of column @a x of a row from the nearest feature of column @a i, which is @a g away from
+ * the row. Euclidean distances are squared.
+ */
+static TMX_INLINE int64_t
+tmxDistanceF(TMX_DISTANCE_METRIC metric, int64_t x, int64_t i, int64_t g)
+{
+    int64_t dx = x - i;
+    switch (metric)
+    {
+        case TMX_DISTANCE_MANHATTAN: return (dx < 0 ? -dx : dx) + g;
+        case TMX_DISTANCE_CHEBYSHEV: return TMX_MAX(dx < 0 ? -dx : dx, g);
+        default: return dx * dx + g * g;
+    }
+}
+
+/**
+ * @brief Computes the first column after which column @a u of a row is nearer to its feature than column @a i (where
+ * `i < u`), as the point where their distance functions intersect.
+ */
+static TMX_INLINE int64_t
+tmxDistanceSep(TMX_DISTANCE_METRIC metric, int64_t i, int64_t u, int64_t gi, int64_t gu)
+{
+    switch (metric)
+    {
+        case TMX_DISTANCE_MANHATTAN:
+            if (gu >= gi + u - i)
+                return INT32_MAX;
+            if (gi > gu + u - i)
+                return INT32_MIN;
+            return tmxDistanceFloorDiv(gu - gi + u + i, 2);
+        case TMX_DISTANCE_CHEBYSHEV:
+            if (gi <= gu)
+                return TMX_MAX(i + gu, tmxDistanceFloorDiv(i + u, 2));
+            return TMX_MIN(u - gi, tmxDistanceFloorDiv(i + u, 2));
+        default: return tmxDistanceFloorDiv(u * u - i * i + gu * gu - gi * gi, 2 * (u - i));
+    }
+}
+
+static TMXdistance *
+tmxDistanceAlloc(TMXrect region, TMX_DISTANCE_METRIC metric)
+{
+    if ((uint64_t) region.w * (uint64_t) region.h >= UINT32_MAX)
+    {
+        tmxErrorMessage(TMX_ERR_PARAM, "Grid is too large for a distance field.");
+        return NULL;
+    }
+
+    TMXdistance *distance = TMX_ALLOC(TMXdistance);
+    if (!distance)
+        return NULL;
+
+    distance->region   = region;
+    distance->metric   = metric;
+    distance->infinity = (uint32_t) region.w + (uint32_t) region.h;
+    distance->columns  = tmxMalloc(TMX_MAX((size_t) region.w * (size_t) region.h, 1) * sizeof(uint32_t));
+    if (!distance->columns)
+    {
+        tmxFreeDistance(distance);
+        return NULL;
+    }
+    return distance;
+}
+
+TMXdistance *
+tmxDistanceCreate(const TMXlayer *const *layers, size_t count, const TMXtiletable *table, TMX_DISTANCE_METRIC metric)
+{
+    size_t i, k;
+    if (!layers || !count || !table)
+    {
+        tmxError(TMX_ERR_VALUE);
+        return NULL;
+    }
+
+    // The grid covers every layer, including each chunk of infinite layers.
+    TMXrect region = {0};
+    int right = 0, bottom = 0;
+    TMX_BOOL first = TMX_TRUE;
+    for (i = 0; i < count; i++)
+    {
+        const TMXlayer *layer = layers[i];
+        if (!layer || (layer->type != TMX_LAYER_TILE && layer->type != TMX_LAYER_CHUNK))
+        {
+            tmxErrorMessage(TMX_ERR_PARAM, "Distance fields can only be created from tile layers.");
+            return NULL;
+        }
+        for (k = 0; k < (layer->type == TMX_LAYER_TILE ? 1 : layer->count); k++)
+        {
+            TMXrect bounds = {.x = 0, .y = 0, .w = layer->size.w, .h = layer->size.h};
+            if (layer->type == TMX_LAYER_CHUNK)
+                bounds = layer->data.chunks[k].bounds;
+            region.x = first ? bounds.x : TMX_MIN(region.x, bounds.x);
+            region.y = first ? bounds.y : TMX_MIN(region.y, bounds.y);
+            right    = first ? bounds.x + bounds.w : TMX_MAX(right, bounds.x + bounds.w);
+            bottom   = first ? bounds.y + bounds.h : TMX_MAX(bottom, bounds.y + bounds.h);
+            first    = TMX_FALSE;
+        }
+    }
+    region.w = right - region.x;
+    region.h = bottom - region.y;
+
+    TMXdistance *distance = tmxDistanceAlloc(region, metric);
+    if (!distance)
+        return NULL;
+
+    size_t cells    = (size_t) region.w * (size_t) region.h;
+    distance->owned = tmxMalloc(TMX_MAX(cells, 1));
+    distance->values = distance->owned;
+    if (!distance->owned || (cells && !tmxGridFill(layers, count, table, region, TMX_GRID_MAX, distance->owned)))
+    {
+        tmxFreeDistance(distance);
+        return NULL;
+    }
+    return distance;
+}
+
+TMXdistance *
+tmxDistanceCreateGrid(const uint8_t *values, TMXrect region, TMX_DISTANCE_METRIC metric)
+{
+    if (!values || region.w < 0 || region.h < 0)
+    {
+        tmxError(TMX_ERR_VALUE);
+        return NULL;
+    }
+
+    TMXdistance *distance = tmxDistanceAlloc(region, metric);
+    if (distance)
+        distance->values = values;
+    return distance;
+}
+
+TMXrect
+tmxDistanceRegion(const TMXdistance *distance)
+{
+    TMXrect region = {0};
+    if (!distance)
+    {
+        tmxError(TMX_ERR_VALUE);
+        return region;
+    }
+    return distance->region;
+}
+
+void
+tmxDistanceColumns(TMXdistance *distance, int first, int count)
+{
+    if (!distance)
+    {
+        tmxError(TMX_ERR_VALUE);
+        return;
+    }
+
+    size_t width   = (size_t) distance->region.w;
+    int last       = TMX_MIN(first + count, distance->region.w);
+    uint32_t limit = distance->infinity;
+    int x, y;
+    first = TMX_MAX(first, 0);
+    if (first >= last || !distance->region.h)
+        return;
+
+    // Each row of the range is swept at once, down the columns and then back up.
+    const uint8_t *values = distance->values;
+    uint32_t *columns     = distance->columns;
+    for (x = first; x < last; x++)
+        columns[x] = values[x] ? 0 : limit;
+    for (y = 1; y < distance->region.h; y++)
+    {
+        const uint8_t *row    = values + (size_t) y * width;
+        uint32_t *current     = columns + (size_t) y * width;
+        const uint32_t *above = current - width;
+        for (x = first; x < last; x++)
+            current[x] = row[x] ? 0 : TMX_MIN(above[x] + 1, limit);
+    }
+    for (y = distance->region.h - 2; y >= 0; y--)
+    {
+        uint32_t *current     = columns + (size_t) y * width;
+        const uint32_t *below = current + width;
+        for (x = first; x < last; x++)
+            current[x] = TMX_MIN(current[x], below[x] + 1);
+    }
+}
+
+/**
+ * @brief Writes a distance to the field, where the Euclidean distance is squared.
+ */
+static TMX_INLINE void
+tmxDistanceStore(const TMXdistance *distance, TMX_DISTANCE_FORMAT format, void *output, size_t index, int64_t value)
+{
+    double result;
+    int64_t limit = distance->infinity;
+    if (distance->metric == TMX_DISTANCE_EUCLIDEAN)
+    {
+        limit *= limit;
+        result = sqrt((double) value);
+    }
+    else
+        result = (double) value;
+
+    if (format == TMX_DISTANCE_UINT16)
+        ((uint16_t *) output)[index] = value >= limit ? UINT16_MAX : (uint16_t) TMX_MIN(result + 0.5, (double) UINT16_MAX);
+    else
+        ((float *) output)[index] = value >= limit ? INFINITY : (float) result;
+}
+
+TMX_BOOL
+tmxDistanceRows(const TMXdistance *distance, int first, int count, TMX_DISTANCE_FORMAT format, void *output)
+{
+    if (!distance || !output)
+    {
+        tmxError(TMX_ERR_VALUE);
+        return TMX_FALSE;
+    }
+
+    int width = distance->region.w, last = TMX_MIN(first + count, distance->region.h);
+    int q, u, y;
+    first = TMX_MAX(first, 0);
+    if (first >= last || !width)
+        return TMX_TRUE;
+
+    // The nearest columns of the lower envelope, and the first column each is nearest to.
+    int *s = tmxMallocCategory((size_t) width * 2 * sizeof(int), TMX_MEMORY_TEMPORARY);
+    if (!s)
+        return TMX_FALSE;
+    int *t = s + width;
+
+    TMX_DISTANCE_METRIC metric = distance->metric;
+    for (y = first; y < last; y++)
+    {
+        const uint32_t *g = distance->columns + (size_t) y * (size_t) width;
+        size_t offset     = (size_t) y * (size_t) width;
+
+        q    = 0;
+        s[0] = 0;
+        t[0] = 0;
+        for (u = 1; u < width; u++)
+        {
+            while (q >= 0 && tmxDistanceF(metric, t[q], s[q], g[s[q]]) > tmxDistanceF(metric, t[q], u, g[u]))
+                q--;
+            if (q < 0)
+            {
+                q    = 0;
+                s[0] = u;
+                continue;
+            }
+
+            int64_t w = 1 + tmxDistanceSep(metric, s[q], u, g[s[q]], g[u]);
+            if (w < width)
+            {
+                q++;
+                s[q] = u;
+                t[q] = (int) w;
+            }
+        }
+        for (u = width - 1; u >= 0; u--)
+        {
+            tmxDistanceStore(distance, format, output, offset + (size_t) u, tmxDistanceF(metric, u, s[q], g[s[q]]));
+            if (u == t[q])
+                q--;
+        }
+    }
+
+    tmxFree(s);
+    return TMX_TRUE;
+}
+
+TMX_BOOL
+tmxDistanceTransform(TMXdistance *distance, TMX_DISTANCE_FORMAT format, void *output)
+{
+    if (!distance || !output)
+    {
+        tmxError(TMX_ERR_VALUE);
+        return TMX_FALSE;
+    }
+    tmxDistanceColumns(distance, 0, distance->region.w);
+    return tmxDistanceRows(distance, 0, distance->region.h, format, output);
+}
+
+void
+tmxFreeDistance(TMXdistance *distance)
+{
+    if (!distance)
+        return;
+    tmxFree(distance->owned);
+    tmxFree(distance->columns);
+    tmxFree(distance);
+}
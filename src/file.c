@@ -1,4 +1,5 @@
 #include "cwalk.h"
+#include "internal.h"
 #include "tmx/file.h"
 #include "tmx/memory.h"
 #include <stdio.h>
@@ -12,8 +13,18 @@ size_t
 tmxFileAbsolutePath(const char *path, const char *basePath, char *buffer, size_t bufferSize)
 {
     size_t dirLen;
-    ;
-    cwk_path_get_dirname(basePath, &dirLen);
+
+    // Documents parsed from memory (or in the working directory) have no location, so paths are used as-is.
+    if (basePath)
+        cwk_path_get_dirname(basePath, &dirLen);
+    if (!basePath || !dirLen)
+    {
+        dirLen = strlen(path);
+        if (dirLen >= bufferSize)
+            return 0;
+        memcpy(buffer, path, dirLen + 1);
+        return dirLen;
+    }
 
     char dirBuffer[dirLen + 1];
     memcpy(dirBuffer, basePath, dirLen);
@@ -63,7 +74,7 @@ tmxFileReadImpl(const char *path, const char *basePath)
 
     if (len)
     {
-        result = tmxMalloc(len + 1);
+        result = tmxMallocCategory(len + 1, TMX_MEMORY_TEMPORARY);
         if (fread(result, 1, len, fp) != len)
         {
             tmxFree(result);
@@ -79,29 +90,43 @@ tmxFileReadImpl(const char *path, const char *basePath)
     return result;
 }
 
+static char *
+tmxFileReadUser(const char *path, const char *basePath)
+{
+    char *result = NULL;
+    size_t len;
+
+    const char *userBuffer = fileRead(path, basePath, fileUserPtr);
+    if (userBuffer)
+    {
+        len    = strlen(userBuffer);
+        result = tmxMallocCategory(len + 1, TMX_MEMORY_TEMPORARY);
+        memcpy(result, userBuffer, len);
+        result[len] = '\0';
+        if (fileFree)
+            fileFree((void *) userBuffer, fileUserPtr);
+    }
+    return result;
+}
+
 char *
 tmxFileRead(const char *path, const char *basePath)
 {
     if (!path)
         return NULL;
 
-    if (fileRead)
-    {
-        char *result = NULL;
-        size_t len;
-
-        const char *userBuffer = fileRead(path, basePath, fileUserPtr);
-        if (userBuffer)
-        {
-            len    = strlen(userBuffer);
-            result = tmxMalloc(len + 1);
-            memcpy(result, userBuffer, len);
-            result[len] = '\0';
-            if (fileFree)
-                fileFree((void *) userBuffer, fileUserPtr);
-            return result;
-        }
-    }
+    char *result = NULL;
+    TMX_STATS_BEGIN(TMX_PHASE_READ);
+    TMX_TRACE_BEGIN("read", path);
 
-    return tmxFileReadImpl(path, basePath);
+    if (fileRead)
+        result = tmxFileReadUser(path, basePath);
+    if (!result)
+        result = tmxFileReadImpl(path, basePath);
+
+    if (result)
+        TMX_STATS_COUNT(files_read);
+    TMX_TRACE_END();
+    TMX_STATS_END(TMX_PHASE_READ, result ? strlen(result) : 0);
+    return result;
 }
\ No newline at end of file
@@ -0,0 +1,254 @@
+#include "tmx/grids.h"
+#include "internal.h"
+#include <string.h>
+
+/**
+ * @brief Describes how a row of tiles is written to a grid.
+ */
+typedef enum TMX_GRID_WRITE
+{
+    TMX_GRID_WRITE_COPY, /** The value of every cell is written, including empty cells. */
+    TMX_GRID_WRITE_OVER  /** Only the values of cells with a tile are written. */
+} TMX_GRID_WRITE;
+
+TMXtiletable *
+tmxTileTableCreate(const TMXmap *map, TMXtilefunc func, void *user, uint8_t empty)
+{
+    if (!map || !func)
+    {
+        tmxError(TMX_ERR_VALUE);
+        return NULL;
+    }
+
+    size_t i, k, count = 1;
+    for (i = 0; i < map->tileset_count; i++)
+    {
+        const TMXtileset *tileset = map->tilesets[i].tileset;
+        if (tileset)
+            count = TMX_MAX(count, (size_t) map->tilesets[i].first_gid + (tileset->rects ? tileset->rects->count : tileset->tile_count));
+    }
+
+    // The values directly follow the table, with an extra element for GIDs beyond the last tileset.
+    TMXtiletable *table = tmxMallocCategory(sizeof(TMXtiletable) + count + 1, TMX_MEMORY_TILESETS);
+    if (!table)
+        return NULL;
+    table->count  = count;
+    table->values = (uint8_t *) (table + 1);
+    memset(table->values, empty, count + 1);
+
+    for (i = 0; i < map->tileset_count; i++)
+    {
+        const TMXtileset *tileset = map->tilesets[i].tileset;
+        TMXgid first              = map->tilesets[i].first_gid;
+        TMXgid end                = i + 1 < map->tileset_count ? map->tilesets[i + 1].first_gid : (TMXgid) count;
+        if (!tileset || !tileset->tiles)
+            continue;
+
+        // A GID belongs to the last tileset that begins at or before it, as with tmxMapTileset.
+        for (k = 0; k < tileset->tile_count; k++)
+        {
+            TMXgid gid = first + tileset->tiles[k].id;
+            if (gid < end)
+                table->values[gid] = func(map, tileset, &tileset->tiles[k], user);
+        }
+    }
+    return table;
+}
+
+void
+tmxFreeTileTable(TMXtiletable *table)
+{
+    tmxFree(table);
+}
+
+/**
+ * @brief Writes the value of each of a row of tiles, which is the innermost loop of filling a grid.
+ */
+static void
+tmxGridGather(uint8_t *output, const TMXgid *gids, size_t count, const TMXtiletable *table, TMX_GRID_WRITE write)
+{
+    const uint8_t *values = table->values;
+    size_t last           = table->count;
+    size_t i;
+
+    // GIDs beyond the table are clamped to its extra element, which keeps the loop free of branches.
+    if (write == TMX_GRID_WRITE_COPY)
+    {
+        for (i = 0; i < count; i++)
+        {
+            size_t gid = gids[i] & TMX_GID_TILE_MASK;
+            output[i]  = values[gid < last ? gid : last];
+        }
+    }
+    else
+    {
+        for (i = 0; i < count; i++)
+        {
+            size_t gid = gids[i] & TMX_GID_TILE_MASK;
+            uint8_t v  = values[gid < last ? gid : last];
+            output[i]  = gid ? v : output[i];
+        }
+    }
+}
+
+static TMXrect
+tmxGridIntersect(TMXrect a, TMXrect b)
+{
+    TMXrect result;
+    result.x = TMX_MAX(a.x, b.x);
+    result.y = TMX_MAX(a.y, b.y);
+    result.w = TMX_MIN(a.x + a.w, b.x + b.w) - result.x;
+    result.h = TMX_MIN(a.y + a.h, b.y + b.h) - result.y;
+    if (result.w < 0 || result.h < 0)
+        result.w = result.h = 0;
+    return result;
+}
+
+/**
+ * @brief Writes the values of an array of tiles that intersect the region of a grid.
+ */
+static void
+tmxGridGatherArea(uint8_t *output, TMXrect region, const TMXgid *gids, TMXrect bounds, const TMXtiletable *table, TMX_GRID_WRITE write)
+{
+    TMXrect area = tmxGridIntersect(region, bounds);
+    int y;
+    if (!gids || area.w <= 0 || area.h <= 0)
+        return;
+
+    for (y = area.y; y < area.y + area.h; y++)
+    {
+        uint8_t *row       = &output[(size_t) (y - region.y) * (size_t) region.w + (size_t) (area.x - region.x)];
+        const TMXgid *tile = &gids[(size_t) (y - bounds.y) * (size_t) bounds.w + (size_t) (area.x - bounds.x)];
+        tmxGridGather(row, tile, (size_t) area.w, table, write);
+    }
+}
+
+static void
+tmxGridGatherLayer(uint8_t *output, TMXrect region, const TMXlayer *layer, const TMXtiletable *table, TMX_GRID_WRITE write)
+{
+    size_t i;
+    if (layer->type == TMX_LAYER_TILE)
+    {
+        TMXrect bounds = {.x = 0, .y = 0, .w = layer->size.w, .h = layer->size.h};
+        tmxGridGatherArea(output, region, layer->data.tiles, bounds, table, write);
+        return;
+    }
+
+    for (i = 0; i < layer->count; i++)
+        tmxGridGatherArea(output, region, layer->data.chunks[i].gids, layer->data.chunks[i].bounds, table, write);
+}
+
+TMX_BOOL
+tmxGridFill(const TMXlayer *const *layers, size_t count, const TMXtiletable *table, TMXrect region, TMX_GRID_COMBINE combine,
+            uint8_t *output)
+{
+    size_t i, k;
+    if ((!layers && count) || !table || !output || region.w < 0 || region.h < 0)
+    {
+        tmxError(TMX_ERR_VALUE);
+        return TMX_FALSE;
+    }
+    for (i = 0; i < count; i++)
+    {
+        if (!layers[i] || (layers[i]->type != TMX_LAYER_TILE && layers[i]->type != TMX_LAYER_CHUNK))
+        {
+            tmxErrorMessage(TMX_ERR_PARAM, "Grids can only be filled from tile layers.");
+            return TMX_FALSE;
+        }
+    }
+
+    size_t cells  = (size_t) region.w * (size_t) region.h;
+    uint8_t empty = table->values[table->count];
+    memset(output, empty, cells);
+    if (!count || !cells)
+        return TMX_TRUE;
+
+    // The first layer is written directly, and each further layer either over it, or to a separate buffer to be combined.
+    uint8_t *buffer = NULL;
+    if (count > 1 && combine != TMX_GRID_TOP)
+    {
+        if (!(buffer = tmxMallocCategory(cells, TMX_MEMORY_TEMPORARY)))
+            return TMX_FALSE;
+    }
+
+    tmxGridGatherLayer(output, region, layers[0], table, TMX_GRID_WRITE_COPY);
+    for (i = 1; i < count; i++)
+    {
+        if (combine == TMX_GRID_TOP)
+        {
+            tmxGridGatherLayer(output, region, layers[i], table, TMX_GRID_WRITE_OVER);
+            continue;
+        }
+
+        memset(buffer, empty, cells);
+        tmxGridGatherLayer(buffer, region, layers[i], table, TMX_GRID_WRITE_COPY);
+        if (combine == TMX_GRID_MIN)
+        {
+            for (k = 0; k < cells; k++)
+                output[k] = TMX_MIN(output[k], buffer[k]);
+        }
+        else
+        {
+            for (k = 0; k < cells; k++)
+                output[k] = TMX_MAX(output[k], buffer[k]);
+        }
+    }
+
+    tmxFree(buffer);
+    return TMX_TRUE;
+}
+
+/**
+ * @brief Packs a row of bytes into bits, setting the bit of each non-zero byte.
+ */
+static void
+tmxGridPack(uint64_t *output, const uint8_t *bytes, size_t count)
+{
+    size_t i, words = (count + 63) / 64;
+    memset(output, 0, words * sizeof(uint64_t));
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    // Eight bytes at a time: the high bit of each non-zero byte is set, and the multiplication gathers them into the top
+    // byte of the product, in order.
+    const uint64_t low  = 0x7F7F7F7F7F7F7F7FULL;
+    const uint64_t high = 0x8080808080808080ULL;
+    for (i = 0; i + 8 <= count; i += 8)
+    {
+        uint64_t v;
+        memcpy(&v, &bytes[i], sizeof(uint64_t));
+        v = ((((v & low) + low) | v) & high) >> 7;
+        output[i / 64] |= ((v * 0x0102040810204080ULL) >> 56) << (i % 64);
+    }
+#else
+    i = 0;
+#endif
+    for (; i < count; i++)
+        output[i / 64] |= (uint64_t) (bytes[i] != 0) << (i % 64);
+}
+
+TMX_BOOL
+tmxGridFillBits(const TMXlayer *const *layers, size_t count, const TMXtiletable *table, TMXrect region, TMX_GRID_COMBINE combine,
+                uint64_t *output)
+{
+    if (!output || region.w < 0 || region.h < 0)
+    {
+        tmxError(TMX_ERR_VALUE);
+        return TMX_FALSE;
+    }
+
+    size_t cells   = (size_t) region.w * (size_t) region.h;
+    uint8_t *bytes = tmxMallocCategory(TMX_MAX(cells, 1), TMX_MEMORY_TEMPORARY);
+    if (!bytes)
+        return TMX_FALSE;
+
+    TMX_BOOL result = tmxGridFill(layers, count, table, region, combine, bytes);
+    if (result)
+    {
+        size_t y, words = ((size_t) region.w + 63) / 64;
+        for (y = 0; y < (size_t) region.h; y++)
+            tmxGridPack(&output[y * words], &bytes[y * (size_t) region.w], (size_t) region.w);
+    }
+
+    tmxFree(bytes);
+    return result;
+}
@@ -0,0 +1,512 @@
+#include "inflate.h"
+#include "tmx/compression.h"
+#include <string.h>
+
+// A whole-buffer DEFLATE decoder. Because TMX tile data is always decompressed from one buffer into another of known size,
+// none of the state-machine machinery of a streaming decoder is required. The hot loop refills a 64-bit bit-buffer with a
+// single unaligned load, which guarantees enough bits for a complete literal/length + distance pair, and decodes each
+// symbol with one (or two, for long codes) table lookups.
+
+#define TMX_LITLEN_TABLEBITS  11
+#define TMX_DIST_TABLEBITS    8
+#define TMX_PRECODE_TABLEBITS 7
+
+// Maximum table sizes including subtables, as computed by zlib's "enough" utility for complete codes.
+#define TMX_LITLEN_ENOUGH  2342 /* enough 288 11 15 */
+#define TMX_DIST_ENOUGH    402  /* enough 32 8 15 */
+#define TMX_PRECODE_ENOUGH 128  /* enough 19 7 7 */
+
+#define TMX_MAX_CODE_LEN     15
+#define TMX_MAX_PRECODE_LEN  7
+#define TMX_NUM_LITLEN_SYMS  288
+#define TMX_NUM_DIST_SYMS    32
+#define TMX_NUM_PRECODE_SYMS 19
+
+// Layout of a decode table entry:
+//   bits 0-3   Number of bits to consume (codeword length, or the table bits for a subtable pointer)
+//   bits 4-7   Number of extra bits following the symbol, or the index bits of the subtable for a pointer
+//   bits 8-10  Entry kind
+//   bits 16-31 Literal value, base length/distance, or offset of the subtable
+#define TMX_ENTRY_LITERAL  (0U << 8)
+#define TMX_ENTRY_MATCH    (1U << 8)
+#define TMX_ENTRY_END      (2U << 8)
+#define TMX_ENTRY_SUBTABLE (3U << 8)
+#define TMX_ENTRY_INVALID  (4U << 8)
+#define TMX_ENTRY_KIND     (7U << 8)
+
+#define TMX_ENTRY(kind, extra, value) ((kind) | ((uint32_t) (extra) << 4) | ((uint32_t) (value) << 16))
+#define TMX_ENTRY_BITS(e)             ((e) & 0xFU)
+#define TMX_ENTRY_EXTRA(e)            (((e) >> 4) & 0xFU)
+#define TMX_ENTRY_VALUE(e)            ((e) >> 16)
+
+typedef enum
+{
+    TMX_CODE_PRECODE,
+    TMX_CODE_LITLEN,
+    TMX_CODE_DIST,
+} TMX_CODE;
+
+typedef struct TMXinflater
+{
+    uint32_t litlen[TMX_LITLEN_ENOUGH];
+    uint32_t dist[TMX_DIST_ENOUGH];
+    uint32_t precode[TMX_PRECODE_ENOUGH];
+    uint8_t lens[TMX_NUM_LITLEN_SYMS + TMX_NUM_DIST_SYMS];
+} TMXinflater;
+
+static const uint16_t lengthBase[29] = {3,  4,  5,  6,  7,  8,  9,  10, 11,  13,  15,  17,  19,  23, 27,
+                                        31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+static const uint8_t lengthExtra[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+
+static const uint16_t distBase[30] = {1,   2,   3,   4,   5,   7,    9,    13,   17,   25,   33,   49,   65,    97,    129,
+                                      193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+static const uint8_t distExtra[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+static const uint8_t precodeOrder[TMX_NUM_PRECODE_SYMS] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+
+static TMX_INLINE uint32_t
+tmxInflateSymbol(TMX_CODE code, unsigned sym)
+{
+    switch (code)
+    {
+        case TMX_CODE_PRECODE: return TMX_ENTRY(TMX_ENTRY_LITERAL, 0, sym);
+        case TMX_CODE_LITLEN:
+            if (sym < 256)
+                return TMX_ENTRY(TMX_ENTRY_LITERAL, 0, sym);
+            if (sym == 256)
+                return TMX_ENTRY(TMX_ENTRY_END, 0, 0);
+            if (sym < 286)
+                return TMX_ENTRY(TMX_ENTRY_MATCH, lengthExtra[sym - 257], lengthBase[sym - 257]);
+            return TMX_ENTRY_INVALID;
+        case TMX_CODE_DIST:
+            if (sym < 30)
+                return TMX_ENTRY(TMX_ENTRY_MATCH, distExtra[sym], distBase[sym]);
+            return TMX_ENTRY_INVALID;
+    }
+    return TMX_ENTRY_INVALID;
+}
+
+static TMX_INLINE unsigned
+tmxBitReverse(unsigned code, unsigned len)
+{
+    unsigned result = 0;
+    while (len--)
+    {
+        result = (result << 1) | (code & 1);
+        code >>= 1;
+    }
+    return result;
+}
+
+/**
+ * @brief Builds a decode table for a canonical Huffman code from the specified codeword lengths.
+ *
+ * @param[in,out] table The table to populate.
+ * @param[in] tableBits The number of bits indexing the primary table.
+ * @param[in] enough The total capacity of @a table, including subtables.
+ * @param[in] lens The codeword length of each symbol, where @c 0 indicates the symbol is unused.
+ * @param[in] symCount The number of symbols in @a lens.
+ * @param[in] code The kind of code being built, determining what each symbol decodes to.
+ *
+ * @return @ref TMX_TRUE on success, otherwise @ref TMX_FALSE if the code is over-subscribed or incomplete.
+ */
+static TMX_BOOL
+tmxInflateBuildTable(uint32_t *table, unsigned tableBits, size_t enough, const uint8_t *lens, unsigned symCount, TMX_CODE code)
+{
+    uint16_t count[TMX_MAX_CODE_LEN + 1] = {0};
+    uint16_t remaining[TMX_MAX_CODE_LEN + 1];
+    uint16_t offsets[TMX_MAX_CODE_LEN + 2];
+    uint16_t sorted[TMX_NUM_LITLEN_SYMS];
+    unsigned sym, len, i, used = 0;
+    int left;
+
+    for (sym = 0; sym < symCount; sym++)
+        count[lens[sym]]++;
+    count[0] = 0;
+
+    // Reject over-subscribed codes. Incomplete codes are only permitted when there is at most a single codeword, which
+    // is the case for a distance code in a block without matches.
+    left = 1;
+    for (len = 1; len <= TMX_MAX_CODE_LEN; len++)
+    {
+        left = (left << 1) - count[len];
+        if (left < 0)
+            return TMX_FALSE;
+        used += count[len];
+    }
+
+    for (i = 0; i < (1U << tableBits); i++)
+        table[i] = TMX_ENTRY_INVALID;
+
+    if (left > 0 && (used > 1 || code == TMX_CODE_PRECODE))
+        return TMX_FALSE;
+    if (!used)
+        return TMX_TRUE;
+
+    // Sort the symbols into canonical order (by length, then by symbol value).
+    offsets[1] = 0;
+    for (len = 1; len <= TMX_MAX_CODE_LEN; len++)
+        offsets[len + 1] = offsets[len] + count[len];
+    for (sym = 0; sym < symCount; sym++)
+    {
+        if (lens[sym])
+            sorted[offsets[lens[sym]]++] = (uint16_t) sym;
+    }
+
+    unsigned codeword = 0, reversed, stride, end, root;
+    unsigned subRoot = ~0U, subBits = 0, subStart = 0;
+    size_t next = (size_t) 1 << tableBits;
+    uint32_t entry;
+
+    memcpy(remaining, count, sizeof(remaining));
+    i = 0;
+    for (len = 1; len <= TMX_MAX_CODE_LEN; len++)
+    {
+        for (end = i + count[len]; i < end; i++, codeword++, remaining[len]--)
+        {
+            sym      = sorted[i];
+            entry    = tmxInflateSymbol(code, sym);
+            reversed = tmxBitReverse(codeword, len);
+
+            if (len <= tableBits)
+            {
+                entry |= len;
+                for (stride = 1U << len; reversed < (1U << tableBits); reversed += stride)
+                    table[reversed] = entry;
+                continue;
+            }
+
+            // Codes longer than the primary table are resolved through a subtable keyed on the remaining bits. All codes
+            // that share the same primary prefix are contiguous in canonical order, and the last of them is the longest.
+            root = reversed & ((1U << tableBits) - 1);
+            if (root != subRoot)
+            {
+                // Size the subtable by how many of the remaining (longer) codewords it must hold before it is full.
+                int room;
+                subBits = len - tableBits;
+                room    = 1 << subBits;
+                while (subBits + tableBits < TMX_MAX_CODE_LEN)
+                {
+                    room -= remaining[subBits + tableBits];
+                    if (room <= 0)
+                        break;
+                    subBits++;
+                    room <<= 1;
+                }
+
+                subRoot  = root;
+                subStart = (unsigned) next;
+                next += (size_t) 1 << subBits;
+                if (next > enough)
+                    return TMX_FALSE;
+
+                for (stride = 0; stride < (1U << subBits); stride++)
+                    table[subStart + stride] = TMX_ENTRY_INVALID;
+                table[root] = TMX_ENTRY(TMX_ENTRY_SUBTABLE, subBits, subStart) | tableBits;
+            }
+
+            entry |= (len - tableBits);
+            for (reversed >>= tableBits, stride = 1U << (len - tableBits); reversed < (1U << subBits); reversed += stride)
+                table[subStart + reversed] = entry;
+        }
+        codeword <<= 1;
+    }
+
+    return TMX_TRUE;
+}
+
+static TMX_INLINE uint64_t
+tmxLoad64(const uint8_t *p)
+{
+#if defined(TMX_BIG_ENDIAN)
+    return (uint64_t) p[0] | ((uint64_t) p[1] << 8) | ((uint64_t) p[2] << 16) | ((uint64_t) p[3] << 24) | ((uint64_t) p[4] << 32) |
+           ((uint64_t) p[5] << 40) | ((uint64_t) p[6] << 48) | ((uint64_t) p[7] << 56);
+#else
+    uint64_t value;
+    memcpy(&value, p, sizeof(uint64_t));
+    return value;
+#endif
+}
+
+// Ensures at least 56 bits are in the bit-buffer. When fewer than 8 bytes of input remain, zero bytes are shifted in past
+// the end and counted, so that reading beyond the stream can be detected once decoding finishes.
+#define TMX_REFILL()                                                                                                                       \
+    do                                                                                                                                     \
+    {                                                                                                                                      \
+        if (inEnd - in >= 8)                                                                                                               \
+        {                                                                                                                                  \
+            bitbuf |= tmxLoad64(in) << bitsleft;                                                                                           \
+            in += (63 - bitsleft) >> 3;                                                                                                    \
+            bitsleft |= 56;                                                                                                                \
+        }                                                                                                                                  \
+        else                                                                                                                               \
+        {                                                                                                                                  \
+            while (bitsleft < 56)                                                                                                           \
+            {                                                                                                                              \
+                if (in < inEnd)                                                                                                            \
+                    bitbuf |= (uint64_t) *in++ << bitsleft;                                                                                \
+                else                                                                                                                       \
+                    overrun++;                                                                                                             \
+                bitsleft += 8;                                                                                                             \
+            }                                                                                                                              \
+        }                                                                                                                                  \
+    } while (0)
+
+#define TMX_BITS(n)    ((unsigned) (bitbuf & ((1U << (n)) - 1)))
+#define TMX_CONSUME(n) (bitbuf >>= (n), bitsleft -= (n))
+
+#define TMX_DECODE(entry, table, tableBits)                                                                                                \
+    do                                                                                                                                     \
+    {                                                                                                                                      \
+        entry = table[TMX_BITS(tableBits)];                                                                                                \
+        if ((entry & TMX_ENTRY_KIND) == TMX_ENTRY_SUBTABLE)                                                                                \
+        {                                                                                                                                  \
+            TMX_CONSUME(tableBits);                                                                                                        \
+            entry = table[TMX_ENTRY_VALUE(entry) + TMX_BITS(TMX_ENTRY_EXTRA(entry))];                                                      \
+        }                                                                                                                                  \
+        TMX_CONSUME(TMX_ENTRY_BITS(entry));                                                                                                \
+    } while (0)
+
+static TMX_BOOL
+tmxInflateFixedTables(TMXinflater *state)
+{
+    unsigned i;
+    for (i = 0; i < 144; i++)
+        state->lens[i] = 8;
+    for (; i < 256; i++)
+        state->lens[i] = 9;
+    for (; i < 280; i++)
+        state->lens[i] = 7;
+    for (; i < TMX_NUM_LITLEN_SYMS; i++)
+        state->lens[i] = 8;
+    for (i = 0; i < TMX_NUM_DIST_SYMS; i++)
+        state->lens[TMX_NUM_LITLEN_SYMS + i] = 5;
+
+    return tmxInflateBuildTable(state->litlen, TMX_LITLEN_TABLEBITS, TMX_LITLEN_ENOUGH, state->lens, TMX_NUM_LITLEN_SYMS,
+                                TMX_CODE_LITLEN) &&
+           tmxInflateBuildTable(state->dist, TMX_DIST_TABLEBITS, TMX_DIST_ENOUGH, state->lens + TMX_NUM_LITLEN_SYMS, TMX_NUM_DIST_SYMS,
+                                TMX_CODE_DIST);
+}
+
+TMX_BOOL
+tmxInflateRaw(const void *input, size_t inputSize, size_t *inputUsed, void *output, size_t outputSize, size_t *outputUsed)
+{
+    TMXinflater state;
+
+    const uint8_t *in    = input;
+    const uint8_t *inEnd = in + inputSize;
+    uint8_t *outStart    = output;
+    uint8_t *out         = outStart;
+    uint8_t *outEnd      = outStart + outputSize;
+
+    uint64_t bitbuf   = 0;
+    unsigned bitsleft = 0;
+    size_t overrun    = 0;
+
+    unsigned final, type, i;
+    uint32_t entry;
+
+    *inputUsed  = 0;
+    *outputUsed = 0;
+
+    do
+    {
+        TMX_REFILL();
+        final = TMX_BITS(1);
+        TMX_CONSUME(1);
+        type = TMX_BITS(2);
+        TMX_CONSUME(2);
+
+        if (type == 0)
+        {
+            // Stored block: discard to the byte boundary and copy LEN bytes verbatim. Rewind the input to account for
+            // whole bytes still sitting in the bit-buffer, and start with a clean buffer afterwards.
+            TMX_CONSUME(bitsleft & 7);
+            if (overrun * 8 > bitsleft)
+                return TMX_FALSE;
+            in -= (bitsleft >> 3) - overrun;
+            bitbuf   = 0;
+            bitsleft = 0;
+            overrun  = 0;
+
+            if (inEnd - in < 4)
+                return TMX_FALSE;
+            unsigned len  = in[0] | (in[1] << 8);
+            unsigned nlen = in[2] | (in[3] << 8);
+            in += 4;
+            if (len != (~nlen & 0xFFFFU) || (size_t) (inEnd - in) < len || (size_t) (outEnd - out) < len)
+                return TMX_FALSE;
+
+            memcpy(out, in, len);
+            in += len;
+            out += len;
+            continue;
+        }
+
+        if (type == 1)
+        {
+            if (!tmxInflateFixedTables(&state))
+                return TMX_FALSE;
+        }
+        else if (type == 2)
+        {
+            TMX_REFILL();
+            unsigned hlit  = TMX_BITS(5) + 257;
+            TMX_CONSUME(5);
+            unsigned hdist = TMX_BITS(5) + 1;
+            TMX_CONSUME(5);
+            unsigned hclen = TMX_BITS(4) + 4;
+            TMX_CONSUME(4);
+
+            if (hlit > 286 || hdist > 30)
+                return TMX_FALSE;
+
+            uint8_t precodeLens[TMX_NUM_PRECODE_SYMS] = {0};
+            for (i = 0; i < hclen; i++)
+            {
+                if (bitsleft < 3)
+                    TMX_REFILL();
+                precodeLens[precodeOrder[i]] = (uint8_t) TMX_BITS(3);
+                TMX_CONSUME(3);
+            }
+            if (!tmxInflateBuildTable(state.precode, TMX_PRECODE_TABLEBITS, TMX_PRECODE_ENOUGH, precodeLens, TMX_NUM_PRECODE_SYMS,
+                                      TMX_CODE_PRECODE))
+                return TMX_FALSE;
+
+            // The literal/length and distance lengths are a single sequence, and runs may span the boundary.
+            unsigned total = hlit + hdist, sym, rep;
+            uint8_t fill;
+            for (i = 0; i < total;)
+            {
+                TMX_REFILL();
+                TMX_DECODE(entry, state.precode, TMX_PRECODE_TABLEBITS);
+                sym = TMX_ENTRY_VALUE(entry);
+
+                if (sym < 16)
+                {
+                    state.lens[i++] = (uint8_t) sym;
+                    continue;
+                }
+
+                if (sym == 16)
+                {
+                    if (!i)
+                        return TMX_FALSE;
+                    fill = state.lens[i - 1];
+                    rep  = 3 + TMX_BITS(2);
+                    TMX_CONSUME(2);
+                }
+                else if (sym == 17)
+                {
+                    fill = 0;
+                    rep  = 3 + TMX_BITS(3);
+                    TMX_CONSUME(3);
+                }
+                else
+                {
+                    fill = 0;
+                    rep  = 11 + TMX_BITS(7);
+                    TMX_CONSUME(7);
+                }
+
+                if (i + rep > total)
+                    return TMX_FALSE;
+                memset(&state.lens[i], fill, rep);
+                i += rep;
+            }
+
+            // The end-of-block symbol must be decodable.
+            if (!state.lens[256])
+                return TMX_FALSE;
+
+            // Move the distance lengths after the full literal/length alphabet, zeroing the unused symbols between.
+            memmove(&state.lens[TMX_NUM_LITLEN_SYMS], &state.lens[hlit], hdist);
+            memset(&state.lens[hlit], 0, TMX_NUM_LITLEN_SYMS - hlit);
+            memset(&state.lens[TMX_NUM_LITLEN_SYMS + hdist], 0, TMX_NUM_DIST_SYMS - hdist);
+
+            if (!tmxInflateBuildTable(state.litlen, TMX_LITLEN_TABLEBITS, TMX_LITLEN_ENOUGH, state.lens, TMX_NUM_LITLEN_SYMS,
+                                      TMX_CODE_LITLEN))
+                return TMX_FALSE;
+            if (!tmxInflateBuildTable(state.dist, TMX_DIST_TABLEBITS, TMX_DIST_ENOUGH, &state.lens[TMX_NUM_LITLEN_SYMS],
+                                      TMX_NUM_DIST_SYMS, TMX_CODE_DIST))
+                return TMX_FALSE;
+        }
+        else
+        {
+            return TMX_FALSE;
+        }
+
+        // Decode the Huffman-compressed block. A single refill provides enough bits for the longest possible sequence of
+        // length code (15), length extra (5), distance code (15), and distance extra (13) bits.
+        for (;;)
+        {
+            TMX_REFILL();
+            TMX_DECODE(entry, state.litlen, TMX_LITLEN_TABLEBITS);
+
+            if ((entry & TMX_ENTRY_KIND) == TMX_ENTRY_LITERAL)
+            {
+                if (out == outEnd)
+                    return TMX_FALSE;
+                *out++ = (uint8_t) TMX_ENTRY_VALUE(entry);
+                continue;
+            }
+
+            if ((entry & TMX_ENTRY_KIND) == TMX_ENTRY_END)
+                break;
+            if ((entry & TMX_ENTRY_KIND) != TMX_ENTRY_MATCH)
+                return TMX_FALSE;
+
+            size_t length = TMX_ENTRY_VALUE(entry) + TMX_BITS(TMX_ENTRY_EXTRA(entry));
+            TMX_CONSUME(TMX_ENTRY_EXTRA(entry));
+
+            TMX_DECODE(entry, state.dist, TMX_DIST_TABLEBITS);
+            if ((entry & TMX_ENTRY_KIND) != TMX_ENTRY_MATCH)
+                return TMX_FALSE;
+            size_t distance = TMX_ENTRY_VALUE(entry) + TMX_BITS(TMX_ENTRY_EXTRA(entry));
+            TMX_CONSUME(TMX_ENTRY_EXTRA(entry));
+
+            if (distance > (size_t) (out - outStart) || length > (size_t) (outEnd - out))
+                return TMX_FALSE;
+
+            const uint8_t *src = out - distance;
+            uint8_t *dst       = out;
+            out += length;
+
+            if (distance >= 8 && (size_t) (outEnd - out) >= 8)
+            {
+                // Copy a word at a time, possibly writing up to 7 bytes past the end of the match, which is fine as there
+                // is room for them and they will be overwritten by subsequent output.
+                do
+                {
+                    memcpy(dst, src, 8);
+                    dst += 8;
+                    src += 8;
+                } while (dst < out);
+            }
+            else if (distance == 1)
+            {
+                memset(dst, *src, length);
+            }
+            else
+            {
+                while (dst < out)
+                    *dst++ = *src++;
+            }
+        }
+    } while (!final);
+
+    // Whole bytes remaining in the bit-buffer were never consumed. If any of the zero padding was consumed, the stream was
+    // truncated.
+    if (overrun > (bitsleft >> 3))
+        return TMX_FALSE;
+
+    *inputUsed  = (size_t) (in - (const uint8_t *) input) - ((bitsleft >> 3) - overrun);
+    *outputUsed = (size_t) (out - outStart);
+    return TMX_TRUE;
+}
+
+const char *
+tmxInflateBackend(void)
+{
+    return "builtin";
+}
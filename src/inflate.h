@@ -0,0 +1,37 @@
+/**
+ * @file inflate.h
+ * @brief Backend interface for decompressing raw DEFLATE streams, shared by the Gzip and Zlib decoders.
+ * @version 0.1
+ *
+ * @details Exactly one backend is compiled into the library, selected with the @c TMX_INFLATE_BACKEND CMake option:
+ *
+ * * @c builtin - A whole-buffer inflater using a 64-bit bit-buffer and table-driven Huffman decoding (inflate.c).
+ * * @c miniz - The streaming @c tinfl decoder from miniz (inflate_miniz.c).
+ *
+ * The container formats (RFC 1950/1952 headers and trailers) are handled in compression.c, so a backend only needs to
+ * implement @ref tmxInflateRaw and @ref tmxInflateBackend.
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#ifndef TMX_INFLATE_H
+#define TMX_INFLATE_H
+
+#include "tmx.h"
+
+/**
+ * @brief Decompresses a raw DEFLATE (RFC 1951) stream in a single call.
+ *
+ * @param[in] input The compressed stream.
+ * @param[in] inputSize The number of bytes available in @a input. May extend past the end of the stream (i.e. a trailer).
+ * @param[out] inputUsed Receives the number of bytes of @a input that make up the stream, rounded up to a whole byte.
+ * @param[in,out] output A buffer to receive the decompressed data.
+ * @param[in] outputSize The number of bytes available in the @a output buffer.
+ * @param[out] outputUsed Receives the number of bytes written to @a output.
+ *
+ * @return @ref TMX_TRUE if the final block was decoded successfully, otherwise @ref TMX_FALSE if the stream is malformed,
+ * truncated, or does not fit within @a output. No error is emitted, that is the responsibility of the caller.
+ */
+TMX_BOOL tmxInflateRaw(const void *input, size_t inputSize, size_t *inputUsed, void *output, size_t outputSize, size_t *outputUsed);
+
+#endif /* TMX_INFLATE_H */
@@ -0,0 +1,42 @@
+#include "inflate.h"
+#include "tmx/compression.h"
+#include "tmx/memory.h"
+
+#define MINIZ_NO_MALLOC
+#define MINIZ_NO_STDIO
+#define MINIZ_NO_ARCHIVE_APIS
+#define MINIZ_NO_DEFLATE_APIS
+
+#define MZ_MALLOC  tmxMalloc
+#define MZ_FREE    tmxFree
+#define MZ_REALLOC tmxRealloc
+
+// The vendored miniz defines all of its functions as static, including helpers that are not used here.
+#if defined(__GNUC__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-function"
+#endif
+#include "miniz.h"
+#if defined(__GNUC__)
+#pragma GCC diagnostic pop
+#endif
+
+TMX_BOOL
+tmxInflateRaw(const void *input, size_t inputSize, size_t *inputUsed, void *output, size_t outputSize, size_t *outputUsed)
+{
+    tinfl_decompressor decompressor;
+    tinfl_status status;
+
+    *inputUsed  = inputSize;
+    *outputUsed = outputSize;
+
+    tinfl_init(&decompressor);
+    status = tinfl_decompress(&decompressor, input, inputUsed, output, output, outputUsed, TINFL_FLAG_USING_NON_WRAPPING_OUTPUT_BUF);
+    return status == TINFL_STATUS_DONE;
+}
+
+const char *
+tmxInflateBackend(void)
+{
+    return "miniz";
+}
@@ -13,6 +13,7 @@
 
 #include "tmx.h"
 #include "tmx/memory.h"
+#include "tmx/stats.h"
 
 #define uthash_malloc(sz)    tmxMalloc(sz)
 #define uthash_free(ptr, sz) tmxFree(ptr)
@@ -25,6 +26,14 @@ struct TMXproperties
     UT_hash_handle hh;
 };
 
+/**
+ * @brief Allocates memory for a specific category, regardless of the current category.
+ * @param[in] size The size of the memory block, in bytes.
+ * @param[in] category The category the allocation is accounted to.
+ * @return A pointer to the allocated memory, or @c NULL if the request fails.
+ */
+void *tmxMallocCategory(size_t size, TMX_MEMORY_CATEGORY category);
+
 /**
  * @brief Allocates an object of the specified @a type with zeroed memory.
  * @param[in] type The type to allocate.
@@ -32,6 +41,184 @@ struct TMXproperties
  */
 #define TMX_ALLOC(type) ((type *) tmxCalloc(1, sizeof(type)))
 
+/**
+ * @brief Identifies a pool of fixed-size nodes.
+ */
+typedef enum TMX_POOL
+{
+    TMX_POOL_OBJECT,
+    TMX_POOL_LAYER,
+    TMX_POOL_TEXT,
+    TMX_POOL_PROPERTY,
+    TMX_POOL_COUNT
+} TMX_POOL;
+
+/**
+ * @brief Allocates a zeroed node from a pool, or from the heap when pools are disabled.
+ * @param[in] pool The pool to allocate from.
+ * @param[in] size The size of the node, in bytes, which must match the type the pool was created for.
+ * @return A pointer to the node, which is freed with @ref tmxFree, or @c NULL if the request fails.
+ */
+void *tmxPoolAlloc(TMX_POOL pool, size_t size);
+
+/**
+ * @brief Retrieves the number of bytes reserved by all pools.
+ * @return The size of all slabs, in bytes.
+ */
+size_t tmxPoolReservedBytes(void);
+
+/**
+ * @brief Allocates zeroed memory in the current category from a pool allocator, unless a user allocator is installed.
+ * @param[in] pool The allocator of the pool.
+ * @param[in] size The size of the memory block, in bytes.
+ * @return A pointer to the allocated memory, or @c NULL if the request fails.
+ */
+void *tmxCallocPooled(const TMXallocator *pool, size_t size);
+
+/**
+ * @brief Allocates memory with the default (compile-time) functions, without a header or accounting.
+ * @param[in] size The size of the memory block, in bytes.
+ * @return A pointer to the allocated memory, or @c NULL if the request fails.
+ */
+void *tmxMemoryRawAlloc(size_t size);
+
+/**
+ * @brief Frees memory allocated with @ref tmxMemoryRawAlloc.
+ * @param[in] memory The memory to free.
+ */
+void tmxMemoryRawFree(void *memory);
+
+/**
+ * @brief Rounds an array length up so that the following array begins on a 16-byte boundary.
+ */
+#define TMX_VIEW_ALIGN(count, type) (((count) * sizeof(type) + 15) & ~(size_t) 15)
+
+/**
+ * @brief Builds the object view of each object layer in a newly loaded map, if enabled with @ref tmxObjectViews.
+ * @param[in] map The map to process.
+ */
+void tmxMapBuildObjectViews(TMXmap *map);
+
+/**
+ * @brief Sorts the chunks of each chunk layer in a newly loaded map by position, and stores sparse layers as chunks if
+ * enabled with @ref tmxSparseLayers.
+ * @param[in] map The map to process.
+ */
+void tmxMapBuildSparseLayers(TMXmap *map);
+
+/**
+ * @brief Builds the occupancy pyramid of each tile layer in a newly loaded map, if enabled with @ref tmxOccupancyPyramids.
+ * @param[in] map The map to process.
+ */
+void tmxMapBuildOccupancy(TMXmap *map);
+
+/**
+ * @brief Finds the chunk of a chunk layer containing a cell, with a binary search over chunks in row-major order.
+ * @param[in] layer A chunk layer.
+ * @param[in] x The column of the cell, in tile units.
+ * @param[in] y The row of the cell, in tile units.
+ * @return The chunk, or @c NULL if no chunk contains the cell.
+ */
+TMXchunk *tmxLayerChunk(const TMXlayer *layer, int x, int y);
+
+/**
+ * @brief Computes the rectangle containing every chunk of a chunk layer.
+ * @param[in] layer A chunk layer.
+ * @return The rectangle in tile units, which is empty at the origin when the layer has no chunks.
+ */
+TMXrect tmxLayerChunkBounds(const TMXlayer *layer);
+
+/**
+ * @brief Finds the first column at or after @a x along a row of a layer that is not within an empty block.
+ * @param[in] occupancy The occupancy pyramid of the layer.
+ * @param[in] x The column to begin at, within the layer.
+ * @param[in] y The row, within the layer.
+ * @param[in] end The column to stop at, no greater than the width of the layer.
+ * @return The column, or @a end if every remaining column is empty.
+ */
+int tmxOccupancyNext(const TMXoccupancy *occupancy, int x, int y, int end);
+
+/**
+ * @brief Finds the last column at or before @a x along a row of a layer that is not within an empty block.
+ * @param[in] occupancy The occupancy pyramid of the layer.
+ * @param[in] x The column to begin at, within the layer.
+ * @param[in] y The row, within the layer.
+ * @param[in] begin The first column to search, no less than 0.
+ * @return The column, or `begin - 1` if every remaining column is empty.
+ */
+int tmxOccupancyPrevious(const TMXoccupancy *occupancy, int x, int y, int begin);
+
+/**
+ * @brief Finds the end of the run of occupied 8x8 blocks along a row, beginning at column @a x.
+ * @return The first column after @a x within an empty block, or @a end.
+ */
+int tmxOccupancyRunEnd(const TMXoccupancy *occupancy, int x, int y, int end);
+
+/**
+ * @brief Finds the start of the run of occupied 8x8 blocks along a row, ending at column @a x.
+ * @return The first column of the run, no less than @a begin.
+ */
+int tmxOccupancyRunStart(const TMXoccupancy *occupancy, int x, int y, int begin);
+
+/**
+ * @brief Retrieves the definition of a tile within a tileset by its local ID.
+ * @param[in] tileset The tileset to search.
+ * @param[in] id The local ID of the tile.
+ * @return The tile, or @c NULL if the tileset does not define it.
+ */
+TMXtile *tmxTilesetTile(const TMXtileset *tileset, TMXtid id);
+
+/**
+ * @brief Describes the placement of tiles on the grid of a map, following the conventions of Tiled.
+ *
+ * @details Staggered maps are treated as hexagonal maps with a side length of 0. For staggered and hexagonal maps,
+ * cells are placed in steps of `columnWidth` and `rowHeight`, with every other row (or column) shifted by one step.
+ */
+typedef struct TMXgrid
+{
+    TMX_ORIENTATION orientation; /** The orientation of the map. */
+    float tileWidth;             /** The width of a cell, in pixel units. */
+    float tileHeight;            /** The height of a cell, in pixel units. */
+    float originX;               /** For isometric maps, the position of the top corner of the first cell on the x-axis. */
+    float columnWidth;           /** For staggered/hexagonal maps, the horizontal distance between adjacent columns. */
+    float rowHeight;             /** For staggered/hexagonal maps, the vertical distance between adjacent rows. */
+    float sideLength;            /** For hexagonal maps, the length of the flat side of a cell along the staggered axis. */
+    TMX_BOOL staggerX;           /** For staggered/hexagonal maps, indicates columns are staggered rather than rows. */
+    TMX_BOOL staggerEven;        /** For staggered/hexagonal maps, indicates even indices are shifted rather than odd. */
+} TMXgrid;
+
+/**
+ * @brief Initializes the grid description of a map.
+ * @param[out] grid The grid to initialize.
+ * @param[in] map The map to describe.
+ */
+void tmxGridInit(TMXgrid *grid, const TMXmap *map);
+
+/**
+ * @brief Computes the top-left corner of the bounding rectangle of a cell, in pixel units.
+ * @param[in] grid The grid of the map.
+ * @param[in] x The column of the cell.
+ * @param[in] y The row of the cell.
+ * @return The position of the corner.
+ */
+TMXvec2 tmxGridCellOrigin(const TMXgrid *grid, int x, int y);
+
+/**
+ * @brief Tests whether a row (or column for the x-axis) of a staggered/hexagonal grid is shifted.
+ * @param[in] grid The grid to test.
+ * @param[in] index The index of the row or column along the staggered axis.
+ * @return Non-zero if the row or column is shifted.
+ */
+#define TMX_GRID_SHIFTED(grid, index) (((index) & 1) ^ (grid)->staggerEven)
+
+/**
+ * @brief Allocates a node of the specified @a type from a pool with zeroed memory.
+ * @param[in] type The type to allocate.
+ * @param[in] pool The pool to allocate from.
+ * @return A pointer to the newly allocated node.
+ */
+#define TMX_POOL_ALLOC(type, pool) ((type *) tmxPoolAlloc(pool, sizeof(type)))
+
 /**
  * @brief Emits an error of the specified type with a generic error message.
  * @param errno An error code indicating the general type of error that occurred.
@@ -164,4 +351,136 @@ TMXproperties *tmxPropertiesMerge(TMXproperties *dst, TMXproperties *src);
  */
 void tmxPropertiesUpdateLinkage(TMXproperties *properties);
 
+/**
+ * @brief Retrieves the time from a monotonic clock with an unspecified origin.
+ * @return The current time, in seconds.
+ */
+double tmxTimeNow(void);
+
+/**
+ * @brief The structure receiving load statistics, or @c NULL when statistics are disabled.
+ */
+extern TMXloadstats *tmxStatsTarget;
+
+/**
+ * @brief Marks the beginning of a phase. Must be balanced with a call to @ref tmxStatsEnd.
+ * @param[in] phase The phase that is entered.
+ * @return Always @c TMX_TRUE, indicating that a frame was pushed.
+ */
+TMX_BOOL tmxStatsBegin(TMX_PHASE phase);
+
+/**
+ * @brief Marks the end of the most recently entered phase.
+ * @param[in] phase The phase that is exited.
+ * @param[in] bytes The number of input bytes processed by the phase.
+ */
+void tmxStatsEnd(TMX_PHASE phase, size_t bytes);
+
+/**
+ * @brief Records an allocation made during a load.
+ * @param[in] size The requested size of the allocation, in bytes.
+ */
+void tmxStatsAlloc(size_t size);
+
+/**
+ * @brief The name of the local variable recording whether the frame of a phase was pushed.
+ * @param phase A @ref TMX_PHASE value.
+ */
+#define TMX_STATS_FRAME(phase) tmxStatsFrame_##phase
+
+/**
+ * @brief Enters a phase when load statistics are enabled, declaring a local variable that records whether it did.
+ * @details Statistics can be enabled while a load is in progress (i.e. from an image callback), so only phases that were
+ * entered while they were enabled are exited. Must be used at the scope of the matching @ref TMX_STATS_END.
+ * @param phase A @ref TMX_PHASE value.
+ */
+#define TMX_STATS_BEGIN(phase) TMX_BOOL TMX_STATS_FRAME(phase) = tmxStatsTarget ? tmxStatsBegin(phase) : TMX_FALSE
+
+/**
+ * @brief Exits a phase if it was entered with load statistics enabled.
+ * @param phase A @ref TMX_PHASE value.
+ * @param bytes The number of input bytes processed by the phase.
+ */
+#define TMX_STATS_END(phase, bytes)                                                                                                        \
+    do                                                                                                                                     \
+    {                                                                                                                                      \
+        if (TMX_STATS_FRAME(phase))                                                                                                        \
+            tmxStatsEnd(phase, bytes);                                                                                                     \
+    } while (0)
+
+/**
+ * @brief Increments a counter of the load statistics when they are enabled.
+ * @param field The name of the @ref TMXloadstats field to increment.
+ */
+#define TMX_STATS_COUNT(field)                                                                                                             \
+    do                                                                                                                                     \
+    {                                                                                                                                      \
+        if (tmxStatsTarget)                                                                                                                \
+            tmxStatsTarget->field++;                                                                                                       \
+    } while (0)
+
+/**
+ * @brief Indicates if a trace is being recorded.
+ */
+extern TMX_BOOL tmxTraceActive;
+
+#ifdef TMX_TRACE
+
+/**
+ * @brief Opens a nested span in the active trace. Must be balanced with a call to @ref tmxTraceEnd.
+ * @param[in] name A static string naming the kind of span.
+ * @param[in] detail An optional string describing the span, such as a layer name or path. It is copied.
+ */
+void tmxTraceBegin(const char *name, const char *detail);
+
+/**
+ * @brief Replaces the detail of the innermost open span, for when it is not known until after parsing has begun.
+ * @param[in] detail A string describing the span, or @c NULL to leave it unchanged. It is copied.
+ */
+void tmxTraceDetail(const char *detail);
+
+/**
+ * @brief Closes the innermost open span and writes it to the trace.
+ */
+void tmxTraceEnd(void);
+
+/**
+ * @brief Opens a nested span when a trace is being recorded.
+ * @param name A static string naming the kind of span.
+ * @param detail An optional string describing the span.
+ */
+#define TMX_TRACE_BEGIN(name, detail)                                                                                                      \
+    do                                                                                                                                     \
+    {                                                                                                                                      \
+        if (tmxTraceActive)                                                                                                                \
+            tmxTraceBegin(name, detail);                                                                                                   \
+    } while (0)
+
+/**
+ * @brief Replaces the detail of the innermost span when a trace is being recorded.
+ * @param detail A string describing the span.
+ */
+#define TMX_TRACE_DETAIL(detail)                                                                                                           \
+    do                                                                                                                                     \
+    {                                                                                                                                      \
+        if (tmxTraceActive)                                                                                                                \
+            tmxTraceDetail(detail);                                                                                                        \
+    } while (0)
+
+/**
+ * @brief Closes the innermost span when a trace is being recorded.
+ */
+#define TMX_TRACE_END()                                                                                                                    \
+    do                                                                                                                                     \
+    {                                                                                                                                      \
+        if (tmxTraceActive)                                                                                                                \
+            tmxTraceEnd();                                                                                                                 \
+    } while (0)
+
+#else
+#define TMX_TRACE_BEGIN(name, detail) ((void) 0)
+#define TMX_TRACE_DETAIL(detail)      ((void) 0)
+#define TMX_TRACE_END()               ((void) 0)
+#endif
+
 #endif /* TMX_UTILS_H */
\ No newline at end of file
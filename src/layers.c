@@ -0,0 +1,240 @@
+#include "internal.h"
+
+#define TMX_FLAT_ROOT ((size_t) -1)
+
+typedef struct TMXflatgroup
+{
+    TMXflatlayer effective; /** The group with the attributes of its ancestors applied. */
+    size_t parent;          /** The index of the parent group, or TMX_FLAT_ROOT. */
+    size_t end;             /** The index past the last group nested within this group. */
+    size_t first;           /** The index of the first leaf layer within this group. */
+    size_t last;            /** The index past the last leaf layer within this group. */
+} TMXflatgroup;
+
+struct TMXflatgroups
+{
+    size_t count;
+    TMXflatgroup *items;
+    size_t *leafParents; /** The index of the group containing each leaf layer, or TMX_FLAT_ROOT. */
+};
+
+static TMX_INLINE TMXcolorf
+tmxFlatTint(const TMXlayer *layer)
+{
+    if (!TMX_HAS_FLAG(layer->flags, TMX_FLAG_COLOR))
+    {
+        TMXcolorf white = {1.0f, 1.0f, 1.0f, 1.0f};
+        return white;
+    }
+#ifdef TMX_VECTOR_COLOR
+    return layer->tint_color;
+#else
+    return tmxColorF(layer->tint_color);
+#endif
+}
+
+static void
+tmxFlatApply(TMXflatlayer *dst, const TMXlayer *layer, const TMXflatlayer *parent)
+{
+    TMXcolorf tint = tmxFlatTint(layer);
+
+    dst->layer = layer;
+    if (!parent)
+    {
+        dst->parent   = NULL;
+        dst->opacity  = layer->opacity;
+        dst->visible  = layer->visible;
+        dst->offset   = layer->offset;
+        dst->tint     = tint;
+        dst->parallax = layer->parallax;
+        return;
+    }
+
+    dst->parent     = parent->layer;
+    dst->opacity    = parent->opacity * layer->opacity;
+    dst->visible    = parent->visible && layer->visible;
+    dst->offset.x   = parent->offset.x + layer->offset.x;
+    dst->offset.y   = parent->offset.y + layer->offset.y;
+    dst->tint.r     = parent->tint.r * tint.r;
+    dst->tint.g     = parent->tint.g * tint.g;
+    dst->tint.b     = parent->tint.b * tint.b;
+    dst->tint.a     = parent->tint.a * tint.a;
+    dst->parallax.x = parent->parallax.x * layer->parallax.x;
+    dst->parallax.y = parent->parallax.y * layer->parallax.y;
+}
+
+static void
+tmxFlatCount(TMXlayer **layers, size_t count, size_t *leaves, size_t *groups)
+{
+    size_t i;
+    for (i = 0; i < count; i++)
+    {
+        if (!layers[i])
+            continue;
+        if (layers[i]->type == TMX_LAYER_GROUP)
+        {
+            (*groups)++;
+            tmxFlatCount(layers[i]->data.group, layers[i]->count, leaves, groups);
+        }
+        else
+        {
+            (*leaves)++;
+        }
+    }
+}
+
+static void
+tmxFlatCollect(TMXflatlayers *flat, TMXlayer **layers, size_t count, size_t parent)
+{
+    struct TMXflatgroups *groups = flat->groups;
+    TMXflatgroup *group;
+    size_t i, index;
+
+    for (i = 0; i < count; i++)
+    {
+        if (!layers[i])
+            continue;
+
+        // Groups and leaves are both recorded in depth-first order, so each group spans a contiguous range of either.
+        if (layers[i]->type == TMX_LAYER_GROUP)
+        {
+            index                  = groups->count++;
+            group                  = &groups->items[index];
+            group->parent          = parent;
+            group->first           = flat->count;
+            group->effective.layer = layers[i];
+            tmxFlatCollect(flat, layers[i]->data.group, layers[i]->count, index);
+            group->end  = groups->count;
+            group->last = flat->count;
+        }
+        else
+        {
+            groups->leafParents[flat->count]  = parent;
+            flat->layers[flat->count++].layer = layers[i];
+        }
+    }
+}
+
+static TMX_INLINE const TMXflatlayer *
+tmxFlatParent(const struct TMXflatgroups *groups, size_t parent)
+{
+    return parent == TMX_FLAT_ROOT ? NULL : &groups->items[parent].effective;
+}
+
+static void
+tmxFlatUpdateRange(TMXflatlayers *flat, size_t firstGroup, size_t endGroup, size_t firstLeaf, size_t lastLeaf)
+{
+    struct TMXflatgroups *groups = flat->groups;
+    TMXflatgroup *group;
+    size_t i;
+
+    // Parents always precede their children, so each group is applied on top of an already updated parent.
+    for (i = firstGroup; i < endGroup; i++)
+    {
+        group = &groups->items[i];
+        tmxFlatApply(&group->effective, group->effective.layer, tmxFlatParent(groups, group->parent));
+    }
+
+    for (i = firstLeaf; i < lastLeaf; i++)
+        tmxFlatApply(&flat->layers[i], flat->layers[i].layer, tmxFlatParent(groups, groups->leafParents[i]));
+}
+
+TMXflatlayers *
+tmxMapFlattenLayers(const TMXmap *map)
+{
+    if (!map)
+    {
+        tmxError(TMX_ERR_VALUE);
+        return NULL;
+    }
+
+    size_t leaves = 0, groupCount = 0;
+    tmxFlatCount(map->layers, map->layer_count, &leaves, &groupCount);
+
+    TMXflatlayers *flat = TMX_ALLOC(TMXflatlayers);
+    if (!flat)
+        return NULL;
+
+    flat->groups = TMX_ALLOC(struct TMXflatgroups);
+    if (!flat->groups)
+    {
+        tmxFreeFlatLayers(flat);
+        return NULL;
+    }
+
+    // Zero-sized arrays are still allocated, so that a NULL pointer always indicates a failure.
+    flat->layers              = tmxCalloc(TMX_MAX(leaves, 1), sizeof(TMXflatlayer));
+    flat->groups->items       = tmxCalloc(TMX_MAX(groupCount, 1), sizeof(TMXflatgroup));
+    flat->groups->leafParents = tmxCalloc(TMX_MAX(leaves, 1), sizeof(size_t));
+    if (!flat->layers || !flat->groups->items || !flat->groups->leafParents)
+    {
+        tmxFreeFlatLayers(flat);
+        return NULL;
+    }
+
+    tmxFlatCollect(flat, map->layers, map->layer_count, TMX_FLAT_ROOT);
+    tmxFlatUpdateRange(flat, 0, flat->groups->count, 0, flat->count);
+    return flat;
+}
+
+TMX_BOOL
+tmxFlatLayersUpdate(TMXflatlayers *flat, const TMXlayer *layer)
+{
+    if (!flat)
+    {
+        tmxError(TMX_ERR_VALUE);
+        return TMX_FALSE;
+    }
+
+    struct TMXflatgroups *groups = flat->groups;
+    size_t i;
+
+    if (!layer)
+    {
+        tmxFlatUpdateRange(flat, 0, groups->count, 0, flat->count);
+        return TMX_TRUE;
+    }
+
+    if (layer->type == TMX_LAYER_GROUP)
+    {
+        for (i = 0; i < groups->count; i++)
+        {
+            TMXflatgroup *group = &groups->items[i];
+            if (group->effective.layer == layer)
+            {
+                tmxFlatUpdateRange(flat, i, group->end, group->first, group->last);
+                return TMX_TRUE;
+            }
+        }
+    }
+    else
+    {
+        for (i = 0; i < flat->count; i++)
+        {
+            if (flat->layers[i].layer == layer)
+            {
+                tmxFlatUpdateRange(flat, 0, 0, i, i + 1);
+                return TMX_TRUE;
+            }
+        }
+    }
+
+    tmxErrorMessage(TMX_ERR_PARAM, "Layer is not part of the flattened layers.");
+    return TMX_FALSE;
+}
+
+void
+tmxFreeFlatLayers(TMXflatlayers *flat)
+{
+    if (!flat)
+        return;
+
+    if (flat->groups)
+    {
+        tmxFree(flat->groups->items);
+        tmxFree(flat->groups->leafParents);
+        tmxFree(flat->groups);
+    }
+    tmxFree(flat->layers);
+    tmxFree(flat);
+}
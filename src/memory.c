@@ -1,9 +1,6 @@
 #include "internal.h"
-
-#ifdef TMX_DEBUG
-static size_t allocationCount;
-static size_t deallocationCount;
-#endif
+#include <stdio.h>
+#include <string.h>
 
 #if !defined(TMX_REALLOC)
 
@@ -29,7 +26,7 @@ static size_t deallocationCount;
 
 #if !defined(TMX_CALLOC)
 static void *
-TMC_CALLOC(size_t elemCount, size_t elemSize, TMXuserptr user)
+TMX_CALLOC(size_t elemCount, size_t elemSize, TMXuserptr user)
 {
     size_t size  = elemCount * elemSize;
     void *memory = TMX_REALLOC(NULL, size, user);
@@ -41,7 +38,65 @@ TMC_CALLOC(size_t elemCount, size_t elemSize, TMXuserptr user)
 #endif
 #endif
 
+/**
+ * @brief Prefixed to each allocation to record its size, category, and allocator, padded to preserve the alignment of
+ * the block. The category is packed into the high byte of the size.
+ */
+typedef union TMXmemoryheader
+{
+    struct
+    {
+        uint64_t bits;
+        const TMXallocator *allocator;
+    } info;
+    long double align;
+    unsigned char pad[16];
+} TMXmemoryheader;
+
+#define TMX_HEADER_SIZE          sizeof(TMXmemoryheader)
+#define TMX_HEADER(memory)       (((TMXmemoryheader *) (memory)) - 1)
+#define TMX_MEMORY(header)       ((void *) (((TMXmemoryheader *) (header)) + 1))
+#define TMX_SIZE_BITS            56
+#define TMX_SIZE_MASK            ((UINT64_C(1) << TMX_SIZE_BITS) - 1)
+#define TMX_SIZE_VALID(size)     ((uint64_t) (size) <= TMX_SIZE_MASK && (size) <= (size_t) -1 - TMX_HEADER_SIZE)
+#define TMX_HEADER_SIZEOF(h)     ((size_t) ((h)->info.bits & TMX_SIZE_MASK))
+#define TMX_HEADER_CATEGORY(h)   ((TMX_MEMORY_CATEGORY) ((h)->info.bits >> TMX_SIZE_BITS))
+#define TMX_HEADER_BITS(size, c) ((uint64_t) (size) | ((uint64_t) (c) << TMX_SIZE_BITS))
+
 static TMXuserptr memoryUserPtr;
+static TMX_MEMORY_CATEGORY memoryCategory;
+static const TMXallocator *memoryAllocator;
+static TMXmemorystats memoryStats;
+
+static TMX_INLINE void
+tmxMemoryTrackAdd(TMX_MEMORY_CATEGORY category, size_t size)
+{
+    TMXmemoryusage *usage = &memoryStats.categories[category];
+    usage->count++;
+    usage->live_count++;
+    usage->live_bytes += size;
+    if (usage->live_bytes > usage->peak_bytes)
+        usage->peak_bytes = usage->live_bytes;
+
+    usage = &memoryStats.total;
+    usage->count++;
+    usage->live_count++;
+    usage->live_bytes += size;
+    if (usage->live_bytes > usage->peak_bytes)
+        usage->peak_bytes = usage->live_bytes;
+}
+
+static TMX_INLINE void
+tmxMemoryTrackRemove(TMX_MEMORY_CATEGORY category, size_t size)
+{
+    TMXmemoryusage *usage = &memoryStats.categories[category];
+    usage->live_count--;
+    usage->live_bytes -= size;
+
+    usage = &memoryStats.total;
+    usage->live_count--;
+    usage->live_bytes -= size;
+}
 
 void
 tmxMemoryUserPtr(TMXuserptr user)
@@ -49,41 +104,179 @@ tmxMemoryUserPtr(TMXuserptr user)
     memoryUserPtr = user;
 }
 
-void *
-tmxMalloc(size_t size)
+const TMXallocator *
+tmxMemoryAllocator(const TMXallocator *allocator)
 {
-    if (!size)
+    if (allocator && (!allocator->alloc || !allocator->free))
+    {
+        tmxErrorMessage(TMX_ERR_VALUE, "An allocator must define both alloc and free functions.");
+        return memoryAllocator;
+    }
+
+    const TMXallocator *previous = memoryAllocator;
+    memoryAllocator              = allocator;
+    return previous;
+}
+
+TMX_MEMORY_CATEGORY
+tmxMemoryCategory(TMX_MEMORY_CATEGORY category)
+{
+    TMX_MEMORY_CATEGORY previous = memoryCategory;
+    memoryCategory               = category;
+    return previous;
+}
+
+void
+tmxMemoryStats(TMXmemorystats *stats)
+{
+    if (!stats)
+    {
+        tmxError(TMX_ERR_VALUE);
+        return;
+    }
+    memcpy(stats, &memoryStats, sizeof(TMXmemorystats));
+    stats->pool_bytes = tmxPoolReservedBytes();
+}
+
+void
+tmxMemoryStatsReset(void)
+{
+    size_t i;
+    for (i = 0; i < TMX_MEMORY_CATEGORY_COUNT; i++)
+    {
+        memoryStats.categories[i].count      = memoryStats.categories[i].live_count;
+        memoryStats.categories[i].peak_bytes = memoryStats.categories[i].live_bytes;
+    }
+    memoryStats.total.count      = memoryStats.total.live_count;
+    memoryStats.total.peak_bytes = memoryStats.total.live_bytes;
+}
+
+const char *
+tmxMemoryCategoryName(TMX_MEMORY_CATEGORY category)
+{
+    static const char *names[TMX_MEMORY_CATEGORY_COUNT] = {"general", "tiles", "objects", "properties", "strings", "tilesets", "temporary"};
+    if ((unsigned) category >= TMX_MEMORY_CATEGORY_COUNT)
+        return NULL;
+    return names[category];
+}
+
+size_t
+tmxMemorySize(const void *memory)
+{
+    if (!memory)
+        return 0;
+    return TMX_HEADER_SIZEOF(TMX_HEADER(memory));
+}
+
+static TMX_INLINE void *
+tmxAllocatorAlloc(const TMXallocator *allocator, size_t size, TMX_BOOL zero)
+{
+    void *memory;
+    if (!allocator)
+        return zero ? TMX_CALLOC(1, size, memoryUserPtr) : TMX_MALLOC(size, memoryUserPtr);
+
+    memory = allocator->alloc(size, allocator->user);
+    if (memory && zero)
+        memset(memory, 0, size);
+    return memory;
+}
+
+static TMX_INLINE void *
+tmxAllocatorRealloc(const TMXallocator *allocator, void *previous, size_t oldSize, size_t newSize)
+{
+    void *memory;
+    if (!allocator)
+        return TMX_REALLOC(previous, newSize, memoryUserPtr);
+    if (allocator->realloc)
+        return allocator->realloc(previous, oldSize, newSize, allocator->user);
+
+    // Emulated for allocators that cannot resize in-place, such as fixed-size pools.
+    memory = allocator->alloc(newSize, allocator->user);
+    if (!memory)
         return NULL;
+    memcpy(memory, previous, TMX_MIN(oldSize, newSize));
+    allocator->free(previous, oldSize, allocator->user);
+    return memory;
+}
+
+static TMX_INLINE void
+tmxAllocatorFree(const TMXallocator *allocator, void *memory, size_t size)
+{
+    if (allocator)
+        allocator->free(memory, size, allocator->user);
+    else
+        TMX_FREE(memory, memoryUserPtr);
+}
 
-    void *ptr = TMX_MALLOC(size, memoryUserPtr);
-    if (!ptr)
+static TMX_INLINE void *
+tmxMemoryAlloc(const TMXallocator *allocator, size_t size, TMX_MEMORY_CATEGORY category, TMX_BOOL zero)
+{
+    TMXmemoryheader *header = TMX_SIZE_VALID(size) ? tmxAllocatorAlloc(allocator, size + TMX_HEADER_SIZE, zero) : NULL;
+    if (!header)
+    {
         tmxError(TMX_ERR_MEMORY);
+        return NULL;
+    }
 
-#ifdef TMX_DEBUG
-    if (ptr)
-        allocationCount++;
-#endif
-    return ptr;
+    header->info.bits      = TMX_HEADER_BITS(size, category);
+    header->info.allocator = allocator;
+    tmxMemoryTrackAdd(category, size);
+    if (tmxStatsTarget)
+        tmxStatsAlloc(size);
+    return TMX_MEMORY(header);
+}
+
+void *
+tmxMallocCategory(size_t size, TMX_MEMORY_CATEGORY category)
+{
+    if (!size)
+        return NULL;
+    return tmxMemoryAlloc(memoryAllocator, size, category, TMX_FALSE);
+}
+
+void *
+tmxMalloc(size_t size)
+{
+    if (!size)
+        return NULL;
+    return tmxMemoryAlloc(memoryAllocator, size, memoryCategory, TMX_FALSE);
 }
 
 void *
 tmxRealloc(void *previous, size_t newSize)
 {
-    if (!previous && !newSize)
+    if (!previous)
+        return tmxMalloc(newSize);
+
+    if (!newSize)
+    {
+        tmxFree(previous);
         return NULL;
+    }
 
-    void *ptr = TMX_REALLOC(previous, newSize, memoryUserPtr);
-    if (!ptr && newSize)
-        tmxError(TMX_ERR_MEMORY);
+    // The block is always resized by the allocator that created it, which may not be the current one.
+    TMXmemoryheader *header      = TMX_HEADER(previous);
+    const TMXallocator *allocator = header->info.allocator;
+    TMX_MEMORY_CATEGORY category  = TMX_HEADER_CATEGORY(header);
+    size_t oldSize                = TMX_HEADER_SIZEOF(header);
 
-#ifdef TMX_DEBUG
-    if (previous && newSize == 0)
-        deallocationCount++;
-    if (!previous && newSize > 0 && ptr)
-        allocationCount++;
-#endif
+    if (!TMX_SIZE_VALID(newSize))
+        header = NULL;
+    else
+        header = tmxAllocatorRealloc(allocator, header, oldSize + TMX_HEADER_SIZE, newSize + TMX_HEADER_SIZE);
 
-    return ptr;
+    if (!header)
+    {
+        tmxError(TMX_ERR_MEMORY);
+        return NULL;
+    }
+
+    header->info.bits = TMX_HEADER_BITS(newSize, category);
+    tmxMemoryTrackRemove(category, oldSize);
+    tmxMemoryTrackAdd(category, newSize);
+    if (tmxStatsTarget)
+        tmxStatsAlloc(newSize);
+    return TMX_MEMORY(header);
 }
 
 void *
@@ -92,16 +285,31 @@ tmxCalloc(size_t elemCount, size_t elemSize)
     if (!elemCount || !elemSize)
         return NULL;
 
-    void *ptr = TMX_CALLOC(elemCount, elemSize, memoryUserPtr);
-    if (!ptr)
+    if (elemCount > ((size_t) -1 - TMX_HEADER_SIZE) / elemSize)
     {
         tmxError(TMX_ERR_MEMORY);
         return NULL;
     }
-#ifdef TMX_DEBUG
-    allocationCount++;
-#endif
-    return ptr;
+    return tmxMemoryAlloc(memoryAllocator, elemCount * elemSize, memoryCategory, TMX_TRUE);
+}
+
+void *
+tmxCallocPooled(const TMXallocator *pool, size_t size)
+{
+    // An installed allocator takes precedence, so that all memory of a load is taken from it.
+    return tmxMemoryAlloc(memoryAllocator ? memoryAllocator : pool, size, memoryCategory, TMX_TRUE);
+}
+
+void *
+tmxMemoryRawAlloc(size_t size)
+{
+    return TMX_MALLOC(size, memoryUserPtr);
+}
+
+void
+tmxMemoryRawFree(void *memory)
+{
+    TMX_FREE(memory, memoryUserPtr);
 }
 
 void
@@ -109,10 +317,11 @@ tmxFree(void *memory)
 {
     if (!memory)
         return;
-#ifdef TMX_DEBUG
-    deallocationCount++;
-#endif
-    TMX_FREE(memory, memoryUserPtr);
+
+    TMXmemoryheader *header = TMX_HEADER(memory);
+    size_t size             = TMX_HEADER_SIZEOF(header);
+    tmxMemoryTrackRemove(TMX_HEADER_CATEGORY(header), size);
+    tmxAllocatorFree(header->info.allocator, header, size + TMX_HEADER_SIZE);
 }
 
 static void
@@ -194,6 +403,7 @@ tmxFreeLayer(TMXlayer *layer)
     tmxFree((void *) layer->name);
     tmxFree((void *) layer->class);
     tmxFreeProperties(layer->properties);
+    tmxFree(layer->occupancy);
     switch (layer->type)
     {
         case TMX_LAYER_TILE:
@@ -204,7 +414,10 @@ tmxFreeLayer(TMXlayer *layer)
         case TMX_LAYER_CHUNK:
         {
             for (i = 0; i < layer->count; i++)
+            {
                 tmxFree(layer->data.chunks[i].gids);
+                tmxFree(layer->data.chunks[i].mask);
+            }
             tmxFree(layer->data.chunks);
             break;
         }
@@ -218,6 +431,7 @@ tmxFreeLayer(TMXlayer *layer)
             for (i = 0; i < layer->count; i++)
                 tmxFreeObject(layer->data.objects[i]);
             tmxFree(layer->data.objects);
+            tmxFree(layer->view);
             break;
         }
         case TMX_LAYER_GROUP:
@@ -310,6 +524,7 @@ tmxFreeTileset(TMXtileset *tileset)
         tmxFree(tileset->tiles);
     }
 
+    tmxFree(tileset->rects);
     tmxFree(tileset);
 }
 
@@ -329,9 +544,158 @@ tmxFreeTemplate(TMXtemplate *template)
     tmxFree(template);
 }
 
-#ifdef TMX_DEBUG
+#pragma region Memory Usage
 
-#include <stdio.h>
+static size_t tmxTilesetMemoryUsage(const TMXtileset *tileset);
+
+static size_t
+tmxPropertiesMemoryUsage(const TMXproperties *properties)
+{
+    if (!properties)
+        return 0;
+
+    // The hash table and its buckets are shared by all entries, and allocated through tmxMalloc as well.
+    size_t total = tmxMemorySize(properties->hh.tbl) + tmxMemorySize(properties->hh.tbl->buckets);
+
+    const struct TMXproperties *entry;
+    for (entry = properties; entry; entry = entry->hh.next)
+    {
+        total += tmxMemorySize(entry) + tmxMemorySize(entry->value.name) + tmxMemorySize(entry->value.class);
+        switch (entry->value.type)
+        {
+            case TMX_PROPERTY_UNSPECIFIED:
+            case TMX_PROPERTY_STRING:
+            case TMX_PROPERTY_FILE: total += tmxMemorySize(entry->value.value.string); break;
+            case TMX_PROPERTY_CLASS: total += tmxPropertiesMemoryUsage(entry->value.value.properties); break;
+            default: break;
+        }
+    }
+    return total;
+}
+
+static size_t
+tmxImageMemoryUsage(const TMXimage *image)
+{
+    if (!image)
+        return 0;
+    return tmxMemorySize(image) + tmxMemorySize(image->source) + tmxMemorySize(image->format) + tmxMemorySize(image->data);
+}
+
+static size_t
+tmxObjectMemoryUsage(const TMXobject *object)
+{
+    if (!object)
+        return 0;
+
+    size_t total = tmxMemorySize(object) + tmxMemorySize(object->name) + tmxMemorySize(object->class);
+    total += tmxPropertiesMemoryUsage(object->properties);
+
+    if (object->template && !TMX_HAS_FLAG(object->template->flags, TMX_FLAG_CACHED))
+    {
+        total += tmxMemorySize(object->template) + tmxObjectMemoryUsage(object->template->object);
+        if (object->template->tileset && !TMX_HAS_FLAG(object->template->tileset->flags, TMX_FLAG_CACHED))
+            total += tmxTilesetMemoryUsage(object->template->tileset);
+    }
+
+    switch (object->type)
+    {
+        case TMX_OBJECT_POLYGON:
+        case TMX_OBJECT_POLYLINE: total += tmxMemorySize(object->poly.points); break;
+        case TMX_OBJECT_TEXT:
+            if (object->text)
+                total += tmxMemorySize(object->text) + tmxMemorySize(object->text->font) + tmxMemorySize(object->text->string);
+            break;
+        default: break;
+    }
+    return total;
+}
+
+static size_t
+tmxLayerMemoryUsage(const TMXlayer *layer)
+{
+    if (!layer)
+        return 0;
+
+    size_t i;
+    size_t total = tmxMemorySize(layer) + tmxMemorySize(layer->name) + tmxMemorySize(layer->class);
+    total += tmxPropertiesMemoryUsage(layer->properties) + tmxMemorySize(layer->occupancy);
+
+    switch (layer->type)
+    {
+        case TMX_LAYER_TILE: total += tmxMemorySize(layer->data.tiles); break;
+        case TMX_LAYER_CHUNK:
+            total += tmxMemorySize(layer->data.chunks);
+            for (i = 0; i < layer->count; i++)
+                total += tmxMemorySize(layer->data.chunks[i].gids) + tmxMemorySize(layer->data.chunks[i].mask);
+            break;
+        case TMX_LAYER_IMAGE: total += tmxImageMemoryUsage(layer->data.image); break;
+        case TMX_LAYER_OBJGROUP:
+            total += tmxMemorySize(layer->data.objects) + tmxMemorySize(layer->view);
+            for (i = 0; i < layer->count; i++)
+                total += tmxObjectMemoryUsage(layer->data.objects[i]);
+            break;
+        case TMX_LAYER_GROUP:
+            total += tmxMemorySize(layer->data.group);
+            for (i = 0; i < layer->count; i++)
+                total += tmxLayerMemoryUsage(layer->data.group[i]);
+            break;
+        default: break;
+    }
+    return total;
+}
+
+static size_t
+tmxTilesetMemoryUsage(const TMXtileset *tileset)
+{
+    size_t i, j;
+    size_t total = tmxMemorySize(tileset) + tmxMemorySize(tileset->version) + tmxMemorySize(tileset->tiled_version) +
+                   tmxMemorySize(tileset->name) + tmxMemorySize(tileset->class);
+    total += tmxImageMemoryUsage(tileset->image) + tmxPropertiesMemoryUsage(tileset->properties);
+    total += tmxMemorySize(tileset->rects);
+
+    if (!tileset->tiles)
+        return total;
+
+    total += tmxMemorySize(tileset->tiles);
+    for (i = 0; i < tileset->tile_count; i++)
+    {
+        const TMXtile *tile = &tileset->tiles[i];
+        total += tmxMemorySize(tile->class) + tmxImageMemoryUsage(tile->image) + tmxMemorySize(tile->animation.frames);
+        total += tmxPropertiesMemoryUsage(tile->properties);
+        if (tile->collision.objects)
+        {
+            total += tmxMemorySize(tile->collision.objects);
+            for (j = 0; j < tile->collision.count; j++)
+                total += tmxObjectMemoryUsage(tile->collision.objects[j]);
+        }
+    }
+    return total;
+}
+
+size_t
+tmxMapMemoryUsage(const TMXmap *map)
+{
+    if (!map)
+        return 0;
+
+    size_t i;
+    size_t total = tmxMemorySize(map) + tmxMemorySize(map->version) + tmxMemorySize(map->tiled_version) + tmxMemorySize(map->class);
+    total += tmxPropertiesMemoryUsage(map->properties);
+    total += tmxMemorySize(map->layers) + tmxMemorySize(map->tilesets);
+
+    for (i = 0; i < map->layer_count; i++)
+        total += tmxLayerMemoryUsage(map->layers[i]);
+
+    for (i = 0; i < map->tileset_count; i++)
+    {
+        if (!map->tilesets[i].tileset || TMX_HAS_FLAG(map->tilesets[i].tileset->flags, TMX_FLAG_CACHED))
+            continue;
+        total += tmxTilesetMemoryUsage(map->tilesets[i].tileset);
+    }
+    return total;
+}
+
+#pragma endregion
 
 #define BLUE   "\033[34m"
 #define YELLOW "\033[33m"
@@ -343,9 +707,11 @@ tmxFreeTemplate(TMXtemplate *template)
 void
 tmxMemoryLeakCheck(void)
 {
+    size_t allocations   = memoryStats.total.count;
+    size_t deallocations = memoryStats.total.count - memoryStats.total.live_count;
+
     printf("\n" BLUE ":: " RESET BRIGHT "Leak Check\n" RESET);
-    printf(YELLOW " -> " RESET "Allocations:    %5zu\n", allocationCount);
-    printf(YELLOW " -> " RESET "Deallocations:  %5zu\n", deallocationCount);
-    printf(YELLOW " -> " RESET "Result:          " BRIGHT "%s\n\n" RESET, allocationCount == deallocationCount ? GREEN "PASS" : RED "FAIL");
+    printf(YELLOW " -> " RESET "Allocations:    %5zu\n", allocations);
+    printf(YELLOW " -> " RESET "Deallocations:  %5zu\n", deallocations);
+    printf(YELLOW " -> " RESET "Result:          " BRIGHT "%s\n\n" RESET, allocations == deallocations ? GREEN "PASS" : RED "FAIL");
 }
-#endif
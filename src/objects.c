@@ -0,0 +1,92 @@
+#include "internal.h"
+
+static TMX_BOOL objectViewsEnabled;
+
+void
+tmxObjectViews(TMX_BOOL enabled)
+{
+    objectViewsEnabled = enabled;
+}
+
+const TMXobjectview *
+tmxLayerObjectView(TMXlayer *layer)
+{
+    if (!layer || layer->type != TMX_LAYER_OBJGROUP)
+    {
+        tmxErrorMessage(TMX_ERR_PARAM, "Object views can only be built for object layers.");
+        return NULL;
+    }
+
+    size_t i, count = layer->count;
+    size_t floats   = TMX_VIEW_ALIGN(count, float);
+    size_t size     = TMX_VIEW_ALIGN(1, TMXobjectview) + TMX_VIEW_ALIGN(count, int) + floats * 5 + TMX_VIEW_ALIGN(count, TMXgid) +
+                  TMX_VIEW_ALIGN(count, TMX_OBJECT_TYPE) + TMX_VIEW_ALIGN(count, TMX_BOOL);
+
+    // The view and its arrays are a single block, so it can be replaced or freed as a whole.
+    TMXobjectview *view = tmxMallocCategory(size, TMX_MEMORY_OBJECTS);
+    if (!view)
+        return NULL;
+
+    unsigned char *block = (unsigned char *) view + TMX_VIEW_ALIGN(1, TMXobjectview);
+    view->count          = count;
+    view->id             = (int *) block;
+    block += TMX_VIEW_ALIGN(count, int);
+    view->x = (float *) block;
+    block += floats;
+    view->y = (float *) block;
+    block += floats;
+    view->width = (float *) block;
+    block += floats;
+    view->height = (float *) block;
+    block += floats;
+    view->rotation = (float *) block;
+    block += floats;
+    view->gid = (TMXgid *) block;
+    block += TMX_VIEW_ALIGN(count, TMXgid);
+    view->type = (TMX_OBJECT_TYPE *) block;
+    block += TMX_VIEW_ALIGN(count, TMX_OBJECT_TYPE);
+    view->visible = (TMX_BOOL *) block;
+
+    static const TMXobject empty = {0};
+    const TMXobject *object;
+    for (i = 0; i < count; i++)
+    {
+        // Objects that failed to parse are left as NULL, and appear as empty entries to keep indices aligned.
+        object            = layer->data.objects[i] ? layer->data.objects[i] : &empty;
+        view->id[i]       = object->id;
+        view->x[i]        = object->position.x;
+        view->y[i]        = object->position.y;
+        view->width[i]    = object->size.x;
+        view->height[i]   = object->size.y;
+        view->rotation[i] = object->rotation;
+        view->gid[i]      = object->gid;
+        view->type[i]     = object->type;
+        view->visible[i]  = object->visible;
+    }
+
+    tmxFree(layer->view);
+    layer->view = view;
+    return view;
+}
+
+static void
+tmxLayersBuildObjectViews(TMXlayer **layers, size_t count)
+{
+    size_t i;
+    for (i = 0; i < count; i++)
+    {
+        if (!layers[i])
+            continue;
+        if (layers[i]->type == TMX_LAYER_OBJGROUP)
+            tmxLayerObjectView(layers[i]);
+        else if (layers[i]->type == TMX_LAYER_GROUP)
+            tmxLayersBuildObjectViews(layers[i]->data.group, layers[i]->count);
+    }
+}
+
+void
+tmxMapBuildObjectViews(TMXmap *map)
+{
+    if (map && objectViewsEnabled)
+        tmxLayersBuildObjectViews(map->layers, map->layer_count);
+}
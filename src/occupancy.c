@@ -0,0 +1,432 @@
+#include "internal.h"
+#include <string.h>
+
+static TMX_BOOL occupancyPyramids = TMX_FALSE;
+
+#define TMX_OCCUPANCY_BLOCK_SHIFT(level) (TMX_OCCUPANCY_SHIFT * ((level) + 1))
+
+void
+tmxOccupancyPyramids(TMX_BOOL enabled)
+{
+    occupancyPyramids = enabled;
+}
+
+static TMX_INLINE TMX_BOOL
+tmxOccupancyBit(const TMXoccupancy *occupancy, int level, int x, int y)
+{
+    size_t bx = (size_t) (x >> TMX_OCCUPANCY_BLOCK_SHIFT(level)), by = (size_t) (y >> TMX_OCCUPANCY_BLOCK_SHIFT(level));
+    return (occupancy->bits[level][by * occupancy->stride[level] + (bx >> 6)] >> (bx & 63)) & 1;
+}
+
+static TMX_INLINE void
+tmxOccupancyAssign(TMXoccupancy *occupancy, int level, int bx, int by, TMX_BOOL value)
+{
+    uint64_t *word = &occupancy->bits[level][(size_t) by * occupancy->stride[level] + (size_t) (bx >> 6)];
+    uint64_t bit   = (uint64_t) 1 << (bx & 63);
+    *word          = value ? (*word | bit) : (*word & ~bit);
+}
+
+/**
+ * @brief Recomputes the blocks of every level that intersect a region, which must be within the layer, from its tiles.
+ */
+static void
+tmxOccupancyRefresh(TMXoccupancy *occupancy, const TMXgid *tiles, TMXsize size, TMXrect region)
+{
+    int level, x, y, bx, by, row;
+    int x0 = region.x, y0 = region.y, x1 = region.x + region.w - 1, y1 = region.y + region.h - 1;
+    if (region.w <= 0 || region.h <= 0)
+        return;
+
+    // The first level is computed from the tiles one row of blocks at a time, reading each row of tiles in order.
+    for (by = y0 >> TMX_OCCUPANCY_SHIFT; by <= y1 >> TMX_OCCUPANCY_SHIFT; by++)
+    {
+        int left = (x0 >> TMX_OCCUPANCY_SHIFT) << TMX_OCCUPANCY_SHIFT;
+        int end  = TMX_MIN(((x1 >> TMX_OCCUPANCY_SHIFT) + 1) << TMX_OCCUPANCY_SHIFT, size.w);
+        int top  = by << TMX_OCCUPANCY_SHIFT;
+        int last = TMX_MIN(top + (1 << TMX_OCCUPANCY_SHIFT), size.h);
+
+        for (bx = left >> TMX_OCCUPANCY_SHIFT; bx <= x1 >> TMX_OCCUPANCY_SHIFT; bx++)
+            tmxOccupancyAssign(occupancy, 0, bx, by, TMX_FALSE);
+        for (y = top; y < last; y++)
+        {
+            const TMXgid *cells = tiles + (size_t) y * (size_t) size.w;
+            for (x = left; x < end; x++)
+            {
+                if (!cells[x])
+                    continue;
+
+                // The rest of the block is already known to be occupied.
+                tmxOccupancyAssign(occupancy, 0, x >> TMX_OCCUPANCY_SHIFT, by, TMX_TRUE);
+                x |= (1 << TMX_OCCUPANCY_SHIFT) - 1;
+            }
+        }
+    }
+
+    // Each block of the other levels covers 8x8 blocks of the level below, which are 8 bits aligned within a single word.
+    for (level = 1; level < TMX_OCCUPANCY_LEVELS; level++)
+    {
+        int shift = TMX_OCCUPANCY_BLOCK_SHIFT(level);
+        for (by = y0 >> shift; by <= y1 >> shift; by++)
+        {
+            for (bx = x0 >> shift; bx <= x1 >> shift; bx++)
+            {
+                uint64_t any = 0;
+                int first    = by << TMX_OCCUPANCY_SHIFT;
+                int stop     = TMX_MIN(first + (1 << TMX_OCCUPANCY_SHIFT), occupancy->size[level - 1].h);
+                size_t word  = (size_t) (bx << TMX_OCCUPANCY_SHIFT) >> 6;
+                int bit      = (bx << TMX_OCCUPANCY_SHIFT) & 63;
+                for (row = first; row < stop; row++)
+                    any |= occupancy->bits[level - 1][(size_t) row * occupancy->stride[level - 1] + word] >> bit;
+                tmxOccupancyAssign(occupancy, level, bx, by, (any & 0xFF) != 0);
+            }
+        }
+    }
+}
+
+const TMXoccupancy *
+tmxLayerOccupancy(TMXlayer *layer)
+{
+    if (!layer)
+    {
+        tmxError(TMX_ERR_VALUE);
+        return NULL;
+    }
+    if (layer->type != TMX_LAYER_TILE || !layer->data.tiles || layer->size.w <= 0 || layer->size.h <= 0)
+        return NULL;
+
+    // The pyramid and its bitmaps are a single allocation.
+    size_t words = 0, offset;
+    int level;
+    TMXoccupancy shape;
+    for (level = 0; level < TMX_OCCUPANCY_LEVELS; level++)
+    {
+        int shift                = TMX_OCCUPANCY_BLOCK_SHIFT(level);
+        int mask                 = (1 << shift) - 1;
+        shape.size[level].w      = (layer->size.w + mask) >> shift;
+        shape.size[level].h      = (layer->size.h + mask) >> shift;
+        shape.stride[level]      = ((size_t) shape.size[level].w + 63) / 64;
+        words                   += shape.stride[level] * (size_t) shape.size[level].h;
+    }
+
+    size_t size             = sizeof(TMXoccupancy) + words * sizeof(uint64_t);
+    TMXoccupancy *occupancy = layer->occupancy;
+    if (!occupancy || tmxMemorySize(occupancy) < size)
+    {
+        tmxFree(layer->occupancy);
+        layer->occupancy = NULL;
+        if (!(occupancy = tmxMallocCategory(size, TMX_MEMORY_TILES)))
+            return NULL;
+    }
+
+    memset(occupancy, 0, size);
+    offset = 0;
+    for (level = 0; level < TMX_OCCUPANCY_LEVELS; level++)
+    {
+        occupancy->size[level]   = shape.size[level];
+        occupancy->stride[level] = shape.stride[level];
+        occupancy->bits[level]   = (uint64_t *) (occupancy + 1) + offset;
+        offset                  += shape.stride[level] * (size_t) shape.size[level].h;
+    }
+
+    tmxOccupancyRefresh(occupancy, layer->data.tiles, layer->size, (TMXrect){.x = 0, .y = 0, .w = layer->size.w, .h = layer->size.h});
+    layer->occupancy = occupancy;
+    return occupancy;
+}
+
+static TMXrect
+tmxOccupancyIntersect(TMXrect a, TMXrect b)
+{
+    TMXrect result;
+    result.x = TMX_MAX(a.x, b.x);
+    result.y = TMX_MAX(a.y, b.y);
+    result.w = TMX_MIN(a.x + a.w, b.x + b.w) - result.x;
+    result.h = TMX_MIN(a.y + a.h, b.y + b.h) - result.y;
+    if (result.w < 0 || result.h < 0)
+        result.w = result.h = 0;
+    return result;
+}
+
+static TMX_INLINE void
+tmxOccupancyMaskAssign(TMXchunk *chunk, size_t index)
+{
+    uint64_t bit = (uint64_t) 1 << (index & 63);
+    if (chunk->gids[index])
+        chunk->mask[index >> 6] |= bit;
+    else
+        chunk->mask[index >> 6] &= ~bit;
+}
+
+void
+tmxLayerUpdateOccupancy(TMXlayer *layer, TMXrect region)
+{
+    size_t i;
+    int x, y;
+    if (!layer)
+    {
+        tmxError(TMX_ERR_VALUE);
+        return;
+    }
+
+    if (layer->type == TMX_LAYER_TILE)
+    {
+        if (layer->occupancy && layer->data.tiles)
+        {
+            TMXrect bounds = {.x = 0, .y = 0, .w = layer->size.w, .h = layer->size.h};
+            tmxOccupancyRefresh(layer->occupancy, layer->data.tiles, layer->size, tmxOccupancyIntersect(region, bounds));
+        }
+        return;
+    }
+    if (layer->type != TMX_LAYER_CHUNK)
+        return;
+
+    for (i = 0; i < layer->count; i++)
+    {
+        TMXchunk *chunk = &layer->data.chunks[i];
+        TMXrect area    = tmxOccupancyIntersect(region, chunk->bounds);
+        if (!chunk->mask || !chunk->gids || !area.w || !area.h)
+            continue;
+        for (y = area.y; y < area.y + area.h; y++)
+        {
+            for (x = area.x; x < area.x + area.w; x++)
+                tmxOccupancyMaskAssign(chunk, (size_t) (y - chunk->bounds.y) * (size_t) chunk->bounds.w + (size_t) (x - chunk->bounds.x));
+        }
+    }
+}
+
+TMX_BOOL
+tmxLayerSetGid(TMXlayer *layer, int x, int y, TMXgid gid)
+{
+    if (!layer)
+    {
+        tmxError(TMX_ERR_VALUE);
+        return TMX_FALSE;
+    }
+
+    if (layer->type == TMX_LAYER_TILE)
+    {
+        if (!layer->data.tiles || x < 0 || y < 0 || x >= layer->size.w || y >= layer->size.h)
+            return TMX_FALSE;
+
+        TMXgid *cell = &layer->data.tiles[(size_t) y * (size_t) layer->size.w + (size_t) x];
+        TMXgid old   = *cell;
+        *cell        = gid;
+        if (!layer->occupancy || !old == !gid)
+            return TMX_TRUE;
+
+        // Adding a tile sets its block at every level, while removing one may empty them, which requires a rescan.
+        if (gid)
+        {
+            for (int level = 0; level < TMX_OCCUPANCY_LEVELS; level++)
+            {
+                int shift = TMX_OCCUPANCY_BLOCK_SHIFT(level);
+                tmxOccupancyAssign(layer->occupancy, level, x >> shift, y >> shift, TMX_TRUE);
+            }
+        }
+        else
+        {
+            tmxOccupancyRefresh(layer->occupancy, layer->data.tiles, layer->size, (TMXrect){.x = x, .y = y, .w = 1, .h = 1});
+        }
+        return TMX_TRUE;
+    }
+    if (layer->type != TMX_LAYER_CHUNK)
+    {
+        tmxErrorMessage(TMX_ERR_PARAM, "Layer is not a tile layer.");
+        return TMX_FALSE;
+    }
+
+    TMXchunk *chunk = tmxLayerChunk(layer, x, y);
+    if (!chunk || !chunk->gids)
+        return TMX_FALSE;
+
+    size_t index       = (size_t) (y - chunk->bounds.y) * (size_t) chunk->bounds.w + (size_t) (x - chunk->bounds.x);
+    chunk->gids[index] = gid;
+    if (chunk->mask)
+        tmxOccupancyMaskAssign(chunk, index);
+    return TMX_TRUE;
+}
+
+int
+tmxOccupancyNext(const TMXoccupancy *occupancy, int x, int y, int end)
+{
+    int level, shift;
+    while (x < end)
+    {
+        // Jump past the largest empty block containing the cell.
+        for (level = TMX_OCCUPANCY_LEVELS - 1; level >= 0; level--)
+        {
+            if (!tmxOccupancyBit(occupancy, level, x, y))
+                break;
+        }
+        if (level < 0)
+            return x;
+        shift = TMX_OCCUPANCY_BLOCK_SHIFT(level);
+        x     = ((x >> shift) + 1) << shift;
+    }
+    return end;
+}
+
+int
+tmxOccupancyPrevious(const TMXoccupancy *occupancy, int x, int y, int begin)
+{
+    int level, shift;
+    while (x >= begin)
+    {
+        for (level = TMX_OCCUPANCY_LEVELS - 1; level >= 0; level--)
+        {
+            if (!tmxOccupancyBit(occupancy, level, x, y))
+                break;
+        }
+        if (level < 0)
+            return x;
+        shift = TMX_OCCUPANCY_BLOCK_SHIFT(level);
+        x     = ((x >> shift) << shift) - 1;
+    }
+    return begin - 1;
+}
+
+static TMX_INLINE int
+tmxOccupancyLowestBit(uint64_t bits)
+{
+#if defined(__GNUC__)
+    return __builtin_ctzll(bits);
+#else
+    int i = 0;
+    for (; !(bits & 1); bits >>= 1)
+        i++;
+    return i;
+#endif
+}
+
+static TMX_INLINE int
+tmxOccupancyHighestBit(uint64_t bits)
+{
+#if defined(__GNUC__)
+    return 63 - __builtin_clzll(bits);
+#else
+    int i = 63;
+    for (; !(bits >> 63); bits <<= 1)
+        i--;
+    return i;
+#endif
+}
+
+int
+tmxOccupancyRunEnd(const TMXoccupancy *occupancy, int x, int y, int end)
+{
+    // The first empty block is found a word of blocks at a time. The bits past the last block of a row are clear.
+    const uint64_t *row = occupancy->bits[0] + (size_t) (y >> TMX_OCCUPANCY_SHIFT) * occupancy->stride[0];
+    int bx = x >> TMX_OCCUPANCY_SHIFT, words = (int) occupancy->stride[0];
+    while ((bx >> 6) < words)
+    {
+        uint64_t empty = ~row[bx >> 6] >> (bx & 63);
+        if (empty)
+        {
+            bx += tmxOccupancyLowestBit(empty);
+            break;
+        }
+        bx = ((bx >> 6) + 1) << 6;
+    }
+    return bx == x >> TMX_OCCUPANCY_SHIFT ? TMX_MIN(x, end) : TMX_MIN(bx << TMX_OCCUPANCY_SHIFT, end);
+}
+
+int
+tmxOccupancyRunStart(const TMXoccupancy *occupancy, int x, int y, int begin)
+{
+    const uint64_t *row = occupancy->bits[0] + (size_t) (y >> TMX_OCCUPANCY_SHIFT) * occupancy->stride[0];
+    int bx              = x >> TMX_OCCUPANCY_SHIFT;
+    while (bx >= 0)
+    {
+        uint64_t empty = ~row[bx >> 6] << (63 - (bx & 63));
+        if (empty)
+        {
+            bx -= 63 - tmxOccupancyHighestBit(empty);
+            break;
+        }
+        bx = ((bx >> 6) << 6) - 1;
+    }
+    return bx == x >> TMX_OCCUPANCY_SHIFT ? TMX_MAX(x + 1, begin) : TMX_MAX((bx + 1) << TMX_OCCUPANCY_SHIFT, begin);
+}
+
+TMX_BOOL
+tmxLayerRegionEmpty(const TMXlayer *layer, TMXrect region)
+{
+    size_t i;
+    int x, y, end;
+    if (!layer)
+    {
+        tmxError(TMX_ERR_VALUE);
+        return TMX_TRUE;
+    }
+
+    if (layer->type == TMX_LAYER_TILE)
+    {
+        TMXrect area = tmxOccupancyIntersect(region, (TMXrect){.x = 0, .y = 0, .w = layer->size.w, .h = layer->size.h});
+        if (!layer->data.tiles || !area.w || !area.h)
+            return TMX_TRUE;
+
+        for (y = area.y; y < area.y + area.h; y++)
+        {
+            const TMXgid *row = layer->data.tiles + (size_t) y * (size_t) layer->size.w;
+            for (x = area.x; x < area.x + area.w; x = end)
+            {
+                end = area.x + area.w;
+                if (layer->occupancy)
+                {
+                    // Only the cells of occupied blocks are read.
+                    if ((x = tmxOccupancyNext(layer->occupancy, x, y, end)) == end)
+                        break;
+                    end = tmxOccupancyRunEnd(layer->occupancy, x, y, end);
+                }
+                for (; x < end; x++)
+                {
+                    if (row[x])
+                        return TMX_FALSE;
+                }
+            }
+        }
+        return TMX_TRUE;
+    }
+    if (layer->type != TMX_LAYER_CHUNK)
+        return TMX_TRUE;
+
+    for (i = 0; i < layer->count; i++)
+    {
+        const TMXchunk *chunk = &layer->data.chunks[i];
+        TMXrect area          = tmxOccupancyIntersect(region, chunk->bounds);
+        if (!chunk->gids || !area.w || !area.h)
+            continue;
+        for (y = area.y; y < area.y + area.h; y++)
+        {
+            size_t index = (size_t) (y - chunk->bounds.y) * (size_t) chunk->bounds.w + (size_t) (area.x - chunk->bounds.x);
+            for (x = 0; x < area.w; x++, index++)
+            {
+                if (chunk->mask ? (chunk->mask[index >> 6] >> (index & 63)) & 1 : chunk->gids[index] != 0)
+                    return TMX_FALSE;
+            }
+        }
+    }
+    return TMX_TRUE;
+}
+
+static void
+tmxOccupancyBuildLayers(TMXlayer **layers, size_t count)
+{
+    size_t i;
+    for (i = 0; i < count; i++)
+    {
+        TMXlayer *layer = layers[i];
+        if (!layer)
+            continue;
+        if (layer->type == TMX_LAYER_GROUP)
+            tmxOccupancyBuildLayers(layer->data.group, layer->count);
+        else if (layer->type == TMX_LAYER_TILE)
+            tmxLayerOccupancy(layer);
+    }
+}
+
+void
+tmxMapBuildOccupancy(TMXmap *map)
+{
+    if (map && occupancyPyramids)
+        tmxOccupancyBuildLayers(map->layers, map->layer_count);
+}
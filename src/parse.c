@@ -17,7 +17,7 @@ tmxParseColor(const char *str)
 
     // Calculate the value as an unsigned integer, accounting for different formats/lengths
 	size_t len = strlen(str);
-	uint32_t u32 = (uint32_t) tmxParseUint(str);
+	uint32_t u32 = (uint32_t) strtoul(str, NULL, 16);
 	if (len < 6) {
 		u32 = (u32 & 0xF000u) << 16 | (u32 & 0xF000u) << 12
 		    | (u32 & 0x0F00u) << 12 | (u32 & 0x0F00u) <<  8
@@ -34,7 +34,11 @@ tmxParseColor(const char *str)
     color.g = ((u32 >>  8) & 0xFF) / 255.0f;
     color.b = ((u32 >>  0) & 0xFF) / 255.0f;
     #else
-    color.value = u32;
+    // Assigned by component, as the layout of the packed value depends on the byte order of the platform.
+    color.a = (uint8_t) (u32 >> 24);
+    color.r = (uint8_t) (u32 >> 16);
+    color.g = (uint8_t) (u32 >>  8);
+    color.b = (uint8_t) (u32 >>  0);
     #endif
 
     // clang-format on
@@ -298,8 +302,8 @@ tmxInitTilesetTiles(TMXtileset *tileset, TMX_BOOL isCollection)
         size_t i;
         for (i = 0; i < tileset->tile_count; i++)
         {
-            x = (i % tileset->columns) * tileset->tile_size.w;
-            y = (i / tileset->columns) * tileset->tile_size.h;
+            x = tileset->margin + (int) (i % tileset->columns) * (tileset->tile_size.w + tileset->spacing);
+            y = tileset->margin + (int) (i / tileset->columns) * (tileset->tile_size.h + tileset->spacing);
 
             tileset->tiles[i].id   = (TMXtid) i;
             tileset->tiles[i].rect = (TMXrect){.x = x, .y = y, .w = tileset->tile_size.w, .h = tileset->tile_size.h};
@@ -393,10 +397,14 @@ tmxParseMapImpl(const char *text, const char *filename, TMXcache *cache, TMX_FOR
     TMXmap *map;
     TMXcontext context;
 
+    TMX_STATS_BEGIN(TMX_PHASE_LOAD);
+    TMX_TRACE_BEGIN("map", filename);
     tmxContextInit(&context, text, filename, cache);
     if (format == TMX_FORMAT_AUTO)
         format = tmxDetectFormat(context.text);
 
+    TMX_STATS_BEGIN(TMX_PHASE_PARSE);
+    TMX_TRACE_BEGIN("parse", NULL);
     switch (format)
     {
         case TMX_FORMAT_JSON: map = tmxParseMapJson(&context); break;
@@ -406,8 +414,15 @@ tmxParseMapImpl(const char *text, const char *filename, TMXcache *cache, TMX_FOR
             map = NULL;
             break;
     }
+    TMX_TRACE_END();
+    TMX_STATS_END(TMX_PHASE_PARSE, strlen(context.text));
     tmxContextDeinit(&context);
+    tmxMapBuildSparseLayers(map);
+    tmxMapBuildOccupancy(map);
+    tmxMapBuildObjectViews(map);
 
+    TMX_TRACE_END();
+    TMX_STATS_END(TMX_PHASE_LOAD, 0);
     return map;
 }
 
@@ -451,13 +466,26 @@ tmxParseTilesetImpl(const char *text, const char *filename, TMXcache *cache, TMX
     TMXtileset *tileset;
     TMXcontext context;
 
-    if (cache && filename && tmxCacheTryGetTileset(cache, filename, &tileset))
-        return tileset;
+    TMX_STATS_BEGIN(TMX_PHASE_TILESET);
+    TMX_TRACE_BEGIN("tileset", filename);
+    if (cache && filename)
+    {
+        if (tmxCacheTryGetTileset(cache, filename, &tileset))
+        {
+            TMX_STATS_COUNT(cache_hits);
+            TMX_TRACE_END();
+            TMX_STATS_END(TMX_PHASE_TILESET, 0);
+            return tileset;
+        }
+        TMX_STATS_COUNT(cache_misses);
+    }
 
     tmxContextInit(&context, text, filename, cache);
     if (format == TMX_FORMAT_AUTO)
         format = tmxDetectFormat(context.text);
 
+    TMX_STATS_BEGIN(TMX_PHASE_PARSE);
+    TMX_TRACE_BEGIN("parse", NULL);
     switch (format)
     {
         case TMX_FORMAT_JSON: tileset = tmxParseTilesetJson(&context); break;
@@ -467,7 +495,11 @@ tmxParseTilesetImpl(const char *text, const char *filename, TMXcache *cache, TMX
             tileset = NULL;
             break;
     }
+    TMX_TRACE_END();
+    TMX_STATS_END(TMX_PHASE_PARSE, strlen(context.text));
     tmxContextDeinit(&context);
+    TMX_TRACE_END();
+    TMX_STATS_END(TMX_PHASE_TILESET, 0);
 
     if (tileset)
     {
@@ -521,13 +553,27 @@ tmxParseTemplateImpl(const char *text, const char *filename, TMXcache *cache, TM
     TMXtemplate *template;
     TMXcontext context;
 
-    if (cache && filename && tmxCacheTryGetTemplate(cache, filename, &template))
-        return template;
+    TMX_STATS_BEGIN(TMX_PHASE_TEMPLATE);
+    TMX_TRACE_BEGIN("template", filename);
+    if (cache && filename)
+    {
+        if (tmxCacheTryGetTemplate(cache, filename, &template))
+        {
+            TMX_STATS_COUNT(cache_hits);
+            TMX_TRACE_END();
+            TMX_STATS_END(TMX_PHASE_TEMPLATE, 0);
+            return template;
+        }
+        TMX_STATS_COUNT(cache_misses);
+    }
 
     tmxContextInit(&context, text, filename, cache);
     if (format == TMX_FORMAT_AUTO)
         format = tmxDetectFormat(context.text);
 
+    TMX_STATS_BEGIN(TMX_PHASE_PARSE);
+    TMX_TRACE_BEGIN("parse", NULL);
+    TMX_MEMORY_CATEGORY previousCategory = tmxMemoryCategory(TMX_MEMORY_OBJECTS);
     switch (format)
     {
         case TMX_FORMAT_JSON: template = tmxParseTemplateJson(&context); break;
@@ -537,7 +583,12 @@ tmxParseTemplateImpl(const char *text, const char *filename, TMXcache *cache, TM
             template = NULL;
             break;
     }
+    tmxMemoryCategory(previousCategory);
+    TMX_TRACE_END();
+    TMX_STATS_END(TMX_PHASE_PARSE, strlen(context.text));
     tmxContextDeinit(&context);
+    TMX_TRACE_END();
+    TMX_STATS_END(TMX_PHASE_TEMPLATE, 0);
 
     if (template && cache && filename)
         tmxCacheAddTemplate(cache, filename, template);
@@ -4,8 +4,15 @@
 #include "parse.h"
 #include "tmx/compression.h"
 #include <ctype.h>
+#include <string.h>
 
-static cJSON_Hooks jsonHooks = {tmxMalloc, tmxFree};
+static void *
+tmxJsonMalloc(size_t size)
+{
+    return tmxMallocCategory(size, TMX_MEMORY_TEMPORARY);
+}
+
+static cJSON_Hooks jsonHooks = {tmxJsonMalloc, tmxFree};
 
 static TMXobject *tmxJsonParseObject(TMXcontext *context, cJSON *obj);
 static TMXtileset *tmxJsonParseTileset(TMXcontext *context, cJSON *obj, TMXgid *firstGid);
@@ -89,10 +96,11 @@ tmxJsonParseProperties(TMXcontext *context, cJSON *array)
     if (!array)
         return NULL;
     TMX_ASSERT(cJSON_IsArray(array));
+    TMX_MEMORY_CATEGORY previousCategory = tmxMemoryCategory(TMX_MEMORY_PROPERTIES);
 
     cJSON_ArrayForEach(item, array)
     {
-        entry             = TMX_ALLOC(TMXproperties);
+        entry             = TMX_POOL_ALLOC(TMXproperties, TMX_POOL_PROPERTY);
         entry->value.name = JSON_STRING(item, TMX_WORD_NAME);
         entry->key        = entry->value.name;
         if (!entry->value.name)
@@ -129,6 +137,7 @@ tmxJsonParseProperties(TMXcontext *context, cJSON *array)
     }
 
     tmxPropertiesUpdateLinkage(properties);
+    tmxMemoryCategory(previousCategory);
     return properties;
 }
 
@@ -163,7 +172,7 @@ tmxJsonParseObjectText(TMXcontext *context, cJSON *obj, TMXobject *object)
 {
     TMX_UNUSED(context);
 
-    struct TMXtext *text = TMX_ALLOC(struct TMXtext);
+    struct TMXtext *text = TMX_POOL_ALLOC(struct TMXtext, TMX_POOL_TEXT);
     TMX_ALIGN halign     = TMX_ALIGN_LEFT;
     TMX_ALIGN valign     = TMX_ALIGN_TOP;
     text->pixel_size     = 16;
@@ -262,7 +271,8 @@ tmxJsonParseObjectText(TMXcontext *context, cJSON *obj, TMXobject *object)
 static TMXobject *
 tmxJsonParseObject(TMXcontext *context, cJSON *obj)
 {
-    TMXobject *object = TMX_ALLOC(TMXobject);
+    TMX_MEMORY_CATEGORY previousCategory = tmxMemoryCategory(TMX_MEMORY_OBJECTS);
+    TMXobject *object = TMX_POOL_ALLOC(TMXobject, TMX_POOL_OBJECT);
 
     cJSON *child;
     const char *name;
@@ -368,6 +378,7 @@ tmxJsonParseObject(TMXcontext *context, cJSON *obj)
     if (object->template && object->template->object)
         tmxObjectMergeTemplate(object, object->template->object);
 
+    tmxMemoryCategory(previousCategory);
     return object;
 }
 
@@ -395,13 +406,17 @@ tmxJsonParseTileData(cJSON *obj, TMX_ENCODING encoding, TMX_COMPRESSION compress
 
     cJSON *child;
     size_t i     = 0;
-    TMXgid *gids = tmxMalloc(count * sizeof(TMXgid));
+    TMXgid *gids = tmxMallocCategory(count * sizeof(TMXgid), TMX_MEMORY_TILES);
 
     if (cJSON_IsArray(obj))
     {
         TMX_ASSERT(encoding == TMX_ENCODING_CSV);
         TMX_ASSERT(count == (size_t) cJSON_GetArraySize(obj));
-        cJSON_ArrayForEach(child, obj) gids[i++] = (TMXgid) child->valueint;
+        TMX_STATS_BEGIN(TMX_PHASE_CSV);
+        TMX_TRACE_BEGIN("csv", NULL);
+        cJSON_ArrayForEach(child, obj) gids[i++] = (TMXgid) child->valuedouble;
+        TMX_TRACE_END();
+        TMX_STATS_END(TMX_PHASE_CSV, 0);
         return gids;
     }
 
@@ -421,17 +436,21 @@ tmxJsonParseTileData(cJSON *obj, TMX_ENCODING encoding, TMX_COMPRESSION compress
         len--;
     }
 
-    TMX_ASSERT(tmxInflate(str, len, gids, count, compression) == count);
+    // Decode outside of an assertion, which would otherwise be compiled out with NDEBUG.
+    i = tmxInflate(str, len, gids, count, compression);
+    if (i < count)
+        memset(&gids[i], 0, (count - i) * sizeof(TMXgid));
     return gids;
 }
 
 static TMXlayer *
 tmxJsonParseLayer(TMXcontext *context, cJSON *obj)
 {
-    TMXlayer *layer = TMX_ALLOC(TMXlayer);
+    TMXlayer *layer = TMX_POOL_ALLOC(TMXlayer, TMX_POOL_LAYER);
     layer->parallax = (TMXvec2){1.0f, 1.0f};
     layer->visible  = TMX_TRUE;
     layer->opacity  = 1.0f;
+    TMX_TRACE_BEGIN("layer", NULL);
 
     size_t i;
     cJSON *child, *arrayChild;
@@ -559,7 +578,7 @@ tmxJsonParseLayer(TMXcontext *context, cJSON *obj)
             i = 0;
             TMXchunk *chunk;
             cJSON *data;
-            layer->data.chunks = tmxMalloc(layer->count * sizeof(TMXchunk));
+            layer->data.chunks = tmxMallocCategory(layer->count * sizeof(TMXchunk), TMX_MEMORY_TILES);
             cJSON_ArrayForEach(arrayChild, child)
             {
                 chunk           = &layer->data.chunks[i++];
@@ -568,6 +587,7 @@ tmxJsonParseLayer(TMXcontext *context, cJSON *obj)
                 chunk->bounds.w = JSON_INTEGER(arrayChild, TMX_WORD_WIDTH, 0);
                 chunk->bounds.h = JSON_INTEGER(arrayChild, TMX_WORD_HEIGHT, 0);
                 chunk->count    = chunk->bounds.w * chunk->bounds.h;
+                chunk->mask     = NULL;
 
                 if (!chunk->count)
                 {
@@ -595,6 +615,8 @@ tmxJsonParseLayer(TMXcontext *context, cJSON *obj)
     if (layer->type == TMX_LAYER_IMAGE)
         tmxImageUserLoad(layer->data.image, context->basePath);
 
+    TMX_TRACE_DETAIL(layer->name);
+    TMX_TRACE_END();
     return layer;
 }
 
@@ -642,7 +664,7 @@ tmxJsonParseTile(TMXcontext *context, cJSON *obj, TMXtile *tiles, TMX_BOOL isCol
     cJSON *child;
     const char *name;
     TMXtile *tile;
-    TMXimage *image;
+    TMXimage *image = NULL;
 
     TMXtid id = (TMXtid) JSON_INTEGER(obj, TMX_WORD_ID, 0);
     if (!isCollection)
@@ -715,15 +737,18 @@ tmxJsonParseTile(TMXcontext *context, cJSON *obj, TMXtile *tiles, TMX_BOOL isCol
         }
     }
 
-    if (tile->image)
+    if (image)
+    {
+        tile->image = image;
         tmxImageUserLoad(tile->image, context->basePath);
+    }
 
     if (tile->image && !tile->rect.w && !tile->rect.h)
         tile->rect.size = tile->image->size;
 }
 
 static TMXtileset *
-tmxJsonParseTileset(TMXcontext *context, cJSON *obj, TMXgid *firstGid)
+tmxJsonParseTilesetImpl(TMXcontext *context, cJSON *obj, TMXgid *firstGid)
 {
     TMXtileset *tileset;
     TMXimage *image = NULL;
@@ -849,19 +874,30 @@ tmxJsonParseTileset(TMXcontext *context, cJSON *obj, TMXgid *firstGid)
         tileset->image = image;
     }
 
+    // Tiles are created even without a "tiles" array, which only lists tiles that define additional data.
+    size_t tileIndex      = 0;
+    TMX_BOOL isCollection = (TMX_BOOL) tileset->columns == 0;
+    tmxInitTilesetTiles(tileset, isCollection);
     if (tiles)
     {
         TMX_ASSERT(cJSON_IsArray(tiles));
-
-        size_t tileIndex      = 0;
-        TMX_BOOL isCollection = (TMX_BOOL) tileset->columns == 0;
-        tmxInitTilesetTiles(tileset, isCollection);
         cJSON_ArrayForEach(child, tiles) { tmxJsonParseTile(context, child, tileset->tiles, isCollection, tileIndex++); }
     }
 
     return tileset;
 }
 
+static TMXtileset *
+tmxJsonParseTileset(TMXcontext *context, cJSON *obj, TMXgid *firstGid)
+{
+    TMX_MEMORY_CATEGORY previousCategory = tmxMemoryCategory(TMX_MEMORY_TILESETS);
+    TMXtileset *tileset                  = tmxJsonParseTilesetImpl(context, obj, firstGid);
+    if (tileset && !tileset->rects)
+        tmxTilesetRects(tileset);
+    tmxMemoryCategory(previousCategory);
+    return tileset;
+}
+
 static TMXmap *
 tmxJsonParseMap(TMXcontext *context, cJSON *obj)
 {
@@ -957,13 +993,21 @@ tmxJsonParseMap(TMXcontext *context, cJSON *obj)
     return map;
 }
 
-TMXmap *
-tmxParseMapJson(TMXcontext *context)
+static void
+tmxJsonParseDocument(TMXcontext *context)
 {
-    TMXmap *map;
     cJSON_InitHooks(&jsonHooks);
+    TMX_TRACE_BEGIN("tokenize", NULL);
     context->json = cJSON_Parse(context->text);
+    TMX_TRACE_END();
     TMX_ASSERT(context->json);
+}
+
+TMXmap *
+tmxParseMapJson(TMXcontext *context)
+{
+    TMXmap *map;
+    tmxJsonParseDocument(context);
     map = tmxJsonParseMap(context, context->json);
     cJSON_Delete(context->json);
     return map;
@@ -973,9 +1017,7 @@ TMXtileset *
 tmxParseTilesetJson(TMXcontext *context)
 {
     TMXtileset *tileset;
-    cJSON_InitHooks(&jsonHooks);
-    context->json = cJSON_Parse(context->text);
-    TMX_ASSERT(context->json);
+    tmxJsonParseDocument(context);
     tileset = tmxJsonParseTileset(context, context->json, NULL);
     cJSON_Delete(context->json);
     return tileset;
@@ -985,9 +1027,7 @@ TMXtemplate *
 tmxParseTemplateJson(TMXcontext *context)
 {
     TMXtemplate *template;
-    cJSON_InitHooks(&jsonHooks);
-    context->json = cJSON_Parse(context->text);
-    TMX_ASSERT(context->json);
+    tmxJsonParseDocument(context);
     template = tmxJsonParseTemplate(context, context->json);
     cJSON_Delete(context->json);
     return template;
@@ -82,13 +82,14 @@ tmxXmlParseProperties(TMXcontext *context)
     size_t size;
     TMXproperties *entry, *properties = NULL;
     TMXproperty *property;
+    TMX_MEMORY_CATEGORY previousCategory = tmxMemoryCategory(TMX_MEMORY_PROPERTIES);
 
     while (tmxXmlReadElement(context->xml, &name, &size))
     {
         if (!STREQL(name, TMX_WORD_PROPERTY))
             continue;
 
-        entry    = tmxCalloc(1, sizeof(TMXproperties));
+        entry    = TMX_POOL_ALLOC(TMXproperties, TMX_POOL_PROPERTY);
         property = &entry->value;
         while (tmxXmlReadAttr(context->xml, &name, &value))
         {
@@ -128,6 +129,7 @@ tmxXmlParseProperties(TMXcontext *context)
     }
 
     tmxPropertiesUpdateLinkage(properties);
+    tmxMemoryCategory(previousCategory);
     return properties;
 }
 
@@ -203,7 +205,7 @@ tmxXmlParseImage(TMXcontext *context)
 static struct TMXtext *
 tmxXmlParseObjectText(TMXcontext *context, TMXobject *obj)
 {
-    struct TMXtext *text = TMX_ALLOC(struct TMXtext);
+    struct TMXtext *text = TMX_POOL_ALLOC(struct TMXtext, TMX_POOL_TEXT);
 
     const char *name;
     const char *value;
@@ -312,7 +314,8 @@ tmxXmlParseObjectText(TMXcontext *context, TMXobject *obj)
 static TMXobject *
 tmxXmlParseObject(TMXcontext *context)
 {
-    TMXobject *object = TMX_ALLOC(TMXobject);
+    TMX_MEMORY_CATEGORY previousCategory = tmxMemoryCategory(TMX_MEMORY_OBJECTS);
+    TMXobject *object = TMX_POOL_ALLOC(TMXobject, TMX_POOL_OBJECT);
 
     const char *name;
     const char *value;
@@ -383,7 +386,10 @@ tmxXmlParseObject(TMXcontext *context)
 
     // Move to contents. Return early if there is none.
     if (!tmxXmlMoveToContent(context->xml))
+    {
+        tmxMemoryCategory(previousCategory);
         return object;
+    }
 
     while (tmxXmlReadElement(context->xml, &name, &size))
     {
@@ -396,19 +402,23 @@ tmxXmlParseObject(TMXcontext *context)
         else if (STREQL(name, TMX_WORD_POINT))
         {
             object->type = TMX_OBJECT_POINT;
+            tmxXmlSkipElement(context->xml);
         }
         else if (STREQL(name, TMX_WORD_ELLIPSE))
         {
             object->type = TMX_OBJECT_ELLIPSE;
+            tmxXmlSkipElement(context->xml);
         }
         else if (STREQL(name, TMX_WORD_POLYGON) || STREQL(name, TMX_WORD_POLYLINE))
         {
             object->type = STREQL(name, TMX_WORD_POLYGON) ? TMX_OBJECT_POLYGON : TMX_OBJECT_POLYLINE;
-            tmxXmlReadAttr(context->xml, &name, &value);
+            // It is safe to stomp all over this pointer, it is temporary and no longer valid once the reader moves
+            if (tmxXmlReadAttr(context->xml, &name, &value))
+            {
+                tmxParsePoints((char *) value, &object->poly);
+                object->flags |= TMX_FLAG_POINTS;
+            }
             tmxXmlMoveToContent(context->xml);
-            // It is safe to stomp all over this pointer, it is temporary and no longer valid on the next loop
-            tmxParsePoints((char *) value, &object->poly);
-            object->flags |= TMX_FLAG_POINTS;
         }
         else if (STREQL(name, TMX_WORD_TEXT))
         {
@@ -425,6 +435,7 @@ tmxXmlParseObject(TMXcontext *context)
     if (object->template && object->template->object)
         tmxObjectMergeTemplate(object, object->template->object);
 
+    tmxMemoryCategory(previousCategory);
     return object;
 }
 
@@ -454,16 +465,17 @@ tmxXmlParseTileIds(TMXcontext *context, TMX_ENCODING encoding, TMX_COMPRESSION c
             gid = 0;
             while (tmxXmlReadAttr(context->xml, &str, &value))
             {
-                if (STREQL(str, TMX_WORD_ID))
+                if (STREQL(str, TMX_WORD_GID))
                 {
-                    gid = tmxParseUint(str);
+                    gid = tmxParseUint(value);
                 }
                 else
                 {
                     tmxXmlWarnAttribute(TMX_WORD_TILE, str);
                 }
             }
-            output[i++] = gid;
+            if (i < outputCount)
+                output[i++] = gid;
         }
         return;
     }
@@ -488,6 +500,7 @@ tmxXmlParseTileData(TMXcontext *context, TMXlayer *layer)
     TMX_COMPRESSION compression;
 
     tmxXmlParseDataType(context, &encoding, &compression);
+    TMX_MEMORY_CATEGORY previousCategory = tmxMemoryCategory(TMX_MEMORY_TILES);
 
     if (context->map->infinite)
     {
@@ -539,6 +552,8 @@ tmxXmlParseTileData(TMXcontext *context, TMXlayer *layer)
         layer->data.tiles = tmxCalloc(layer->count, sizeof(TMXgid));
         tmxXmlParseTileIds(context, encoding, compression, layer->data.tiles, layer->count);
     }
+
+    tmxMemoryCategory(previousCategory);
 }
 
 static TMXlayer *
@@ -548,11 +563,12 @@ tmxXmlParseLayer(TMXcontext *context, const char *layerType)
     const char *value;
     size_t size;
 
-    TMXlayer *layer = TMX_ALLOC(TMXlayer);
+    TMXlayer *layer = TMX_POOL_ALLOC(TMXlayer, TMX_POOL_LAYER);
     layer->type     = tmxParseLayerType(layerType, context->map->infinite);
     layer->parallax = (TMXvec2){1.0f, 1.0f};
     layer->visible  = TMX_TRUE;
     layer->opacity  = 1.0f;
+    TMX_TRACE_BEGIN("layer", NULL);
 
     while (tmxXmlReadAttr(context->xml, &name, &value))
     {
@@ -599,9 +615,12 @@ tmxXmlParseLayer(TMXcontext *context, const char *layerType)
         }
     }
 
+    TMX_TRACE_DETAIL(layer->name);
+
+    // Layers without children, such as empty object groups, are valid and end here.
     if (!tmxXmlMoveToContent(context->xml))
     {
-        tmxError(TMX_ERR_PARSE);
+        TMX_TRACE_END();
         return layer;
     }
 
@@ -631,7 +650,7 @@ tmxXmlParseLayer(TMXcontext *context, const char *layerType)
 
             if (!layer->data.objects)
                 layer->data.objects = tmxMalloc(objectCapa * sizeof(TMXobject *));
-            tmxArrayPush(TMXobject *, layer->data.objects, obj, layer->count, layerCapa);
+            tmxArrayPush(TMXobject *, layer->data.objects, obj, layer->count, objectCapa);
         }
         else if (STREQL(name, TMX_WORD_IMAGE)) // <imagelayer>
         {
@@ -660,6 +679,7 @@ tmxXmlParseLayer(TMXcontext *context, const char *layerType)
     else if (layer->type == TMX_LAYER_GROUP && layer->data.group)
         tmxArrayFinish(TMXlayer *, layer->data.group, layer->count, layerCapa);
 
+    TMX_TRACE_END();
     return layer;
 }
 
@@ -788,7 +808,7 @@ tmxXmlParseTile(TMXcontext *context, TMXtile *tiles, TMX_BOOL isCollection, size
 }
 
 static TMXtileset *
-tmxXmlParseTileset(TMXcontext *context, TMXgid *firstGid)
+tmxXmlParseTilesetImpl(TMXcontext *context, TMXgid *firstGid)
 {
     TMXtileset *tileset = NULL;
     const char *name;
@@ -918,6 +938,17 @@ tmxXmlParseTileset(TMXcontext *context, TMXgid *firstGid)
     return tileset;
 }
 
+static TMXtileset *
+tmxXmlParseTileset(TMXcontext *context, TMXgid *firstGid)
+{
+    TMX_MEMORY_CATEGORY previousCategory = tmxMemoryCategory(TMX_MEMORY_TILESETS);
+    TMXtileset *tileset                  = tmxXmlParseTilesetImpl(context, firstGid);
+    if (tileset && !tileset->rects)
+        tmxTilesetRects(tileset);
+    tmxMemoryCategory(previousCategory);
+    return tileset;
+}
+
 static TMXmap *
 tmxXmlParseMap(TMXcontext *context)
 {
@@ -0,0 +1,762 @@
+#include "tmx/paths.h"
+#include "internal.h"
+#include <string.h>
+
+/**
+ * @brief Marks the absence of a cell, such as the parent of the start of a search.
+ */
+#define TMX_PATH_NONE UINT32_MAX
+
+/**
+ * @brief An entry of the open list, ordered by its key.
+ */
+typedef struct TMXpathnode
+{
+    uint64_t key;   /** The estimated total cost in the high 32 bits, and the heuristic in the low, favoring cells nearer the goal. */
+    uint32_t index; /** The index of the cell. */
+} TMXpathnode;
+
+struct TMXpathfinder
+{
+    const uint8_t *costs;
+    int width;
+    int height;
+    TMXpoint offset;              /** The position of the first cell, in tile units. */
+    TMX_PATH_NEIGHBORS neighbors;
+    TMX_BOOL staggerX;
+    TMX_BOOL staggerEven;
+    uint32_t *g;                  /** The cost of the best known path to each cell, valid where its `seen` bit is set. */
+    uint32_t *parents;            /** The previous cell of the best known path to each cell (or the previous jump point). */
+    uint64_t *seen;               /** Bitset of the cells that have been reached, and are either open or closed. */
+    uint64_t *closed;             /** Bitset of the cells that have been expanded. */
+    uint64_t *rows;               /** For jump point search, bitmap of the open cells with a line of words for each row. */
+    uint64_t *columns;            /** For jump point search, bitmap of the open cells with a line of words for each column. */
+    size_t rowStride;             /** The number of words in each row of `rows`. */
+    size_t columnStride;          /** The number of words in each column of `columns`. */
+    size_t dirtyFirst;            /** The first word of the bitsets modified by the last search. */
+    size_t dirtyEnd;              /** One past the last word of the bitsets modified by the last search. */
+    TMXpathnode *heap;            /** A binary min-heap of open cells. A cell may appear more than once, and later entries are skipped. */
+    size_t heapCount;
+    size_t heapCapacity;
+    int goalX;                    /** The column of the goal of the current search, relative to the first cell. */
+    int goalY;                    /** The row of the goal of the current search, relative to the first cell. */
+};
+
+/**
+ * @brief Ensures an array has room for at least @a count elements, doubling its capacity as needed.
+ */
+static TMX_BOOL
+tmxPathGrow(void **array, size_t *capacity, size_t count, size_t size)
+{
+    if (count <= *capacity)
+        return TMX_TRUE;
+
+    size_t grown = TMX_MAX(count, TMX_MAX(*capacity * 2, 16));
+    void *result = tmxRealloc(*array, grown * size);
+    if (!result)
+        return TMX_FALSE;
+
+    *array    = result;
+    *capacity = grown;
+    return TMX_TRUE;
+}
+
+static TMX_INLINE int
+tmxPathAbs(int value)
+{
+    return value < 0 ? -value : value;
+}
+
+static TMX_INLINE int
+tmxPathSign(int value)
+{
+    return (value > 0) - (value < 0);
+}
+
+/**
+ * @brief Divides by two, rounding towards negative infinity.
+ */
+static TMX_INLINE int
+tmxPathHalf(int value)
+{
+    return value >= 0 ? value / 2 : -((1 - value) / 2);
+}
+
+static TMX_INLINE TMX_BOOL
+tmxPathOpen(const TMXpathfinder *finder, int x, int y)
+{
+    return x >= 0 && y >= 0 && x < finder->width && y < finder->height && finder->costs[(size_t) y * (size_t) finder->width + (size_t) x];
+}
+
+static TMX_INLINE TMX_BOOL
+tmxPathTest(const uint64_t *bits, uint32_t index)
+{
+    return (bits[index >> 6] >> (index & 63)) & 1;
+}
+
+static TMX_INLINE void
+tmxPathMark(TMXpathfinder *finder, uint64_t *bits, uint32_t index)
+{
+    size_t word = index >> 6;
+    bits[word] |= (uint64_t) 1 << (index & 63);
+    finder->dirtyFirst = TMX_MIN(finder->dirtyFirst, word);
+    finder->dirtyEnd   = TMX_MAX(finder->dirtyEnd, word + 1);
+}
+
+/**
+ * @brief Estimates the cost from a cell to the goal, never exceeding the cost of a path, as every cell costs at least 1.
+ */
+static uint32_t
+tmxPathHeuristic(const TMXpathfinder *finder, int x, int y)
+{
+    int dx = tmxPathAbs(finder->goalX - x);
+    int dy = tmxPathAbs(finder->goalY - y);
+
+    switch (finder->neighbors)
+    {
+        case TMX_PATH_EIGHT:
+            return (uint32_t) (TMX_PATH_STRAIGHT_COST * TMX_MAX(dx, dy) +
+                               (TMX_PATH_DIAGONAL_COST - TMX_PATH_STRAIGHT_COST) * TMX_MIN(dx, dy));
+        case TMX_PATH_HEX:
+        {
+            // Offset coordinates are converted to axial coordinates, where the distance is the larger of the three cube deltas.
+            int ax = x + finder->offset.x, ay = y + finder->offset.y;
+            int bx = finder->goalX + finder->offset.x, by = finder->goalY + finder->offset.y;
+            int q, r;
+            if (finder->staggerX)
+            {
+                q = (by - tmxPathHalf(bx + finder->staggerEven)) - (ay - tmxPathHalf(ax + finder->staggerEven));
+                r = bx - ax;
+            }
+            else
+            {
+                q = (bx - tmxPathHalf(by + finder->staggerEven)) - (ax - tmxPathHalf(ay + finder->staggerEven));
+                r = by - ay;
+            }
+            return (uint32_t) (TMX_PATH_STRAIGHT_COST * (tmxPathAbs(q) + tmxPathAbs(r) + tmxPathAbs(q + r)) / 2);
+        }
+        default: return (uint32_t) (TMX_PATH_STRAIGHT_COST * (dx + dy));
+    }
+}
+
+static TMX_BOOL
+tmxPathPush(TMXpathfinder *finder, uint64_t key, uint32_t index)
+{
+    if (!tmxPathGrow((void **) &finder->heap, &finder->heapCapacity, finder->heapCount + 1, sizeof(TMXpathnode)))
+        return TMX_FALSE;
+
+    size_t i = finder->heapCount++;
+    while (i > 0)
+    {
+        size_t parent = (i - 1) / 2;
+        if (finder->heap[parent].key <= key)
+            break;
+        finder->heap[i] = finder->heap[parent];
+        i               = parent;
+    }
+    finder->heap[i].key   = key;
+    finder->heap[i].index = index;
+    return TMX_TRUE;
+}
+
+static uint32_t
+tmxPathPop(TMXpathfinder *finder)
+{
+    uint32_t result  = finder->heap[0].index;
+    TMXpathnode last = finder->heap[--finder->heapCount];
+    size_t i = 0, count = finder->heapCount;
+
+    for (;;)
+    {
+        size_t least = i * 2 + 1;
+        if (least >= count)
+            break;
+        if (least + 1 < count && finder->heap[least + 1].key < finder->heap[least].key)
+            least++;
+        if (last.key <= finder->heap[least].key)
+            break;
+        finder->heap[i] = finder->heap[least];
+        i               = least;
+    }
+    if (count)
+        finder->heap[i] = last;
+    return result;
+}
+
+/**
+ * @brief Reaches a cell from another with a step of the specified cost, opening it if the path is better than any known.
+ *
+ * @return @c TMX_FALSE if memory could not be allocated.
+ */
+static TMX_BOOL
+tmxPathReach(TMXpathfinder *finder, uint32_t from, int x, int y, uint64_t step)
+{
+    uint32_t index = (uint32_t) y * (uint32_t) finder->width + (uint32_t) x;
+    if (tmxPathTest(finder->closed, index))
+        return TMX_TRUE;
+
+    uint64_t g = finder->g[from] + step;
+    if (tmxPathTest(finder->seen, index) && g >= finder->g[index])
+        return TMX_TRUE;
+
+    uint64_t h = tmxPathHeuristic(finder, x, y);
+    if (g + h > UINT32_MAX)
+        return TMX_TRUE;
+
+    tmxPathMark(finder, finder->seen, index);
+    finder->g[index]       = (uint32_t) g;
+    finder->parents[index] = from;
+    return tmxPathPush(finder, ((g + h) << 32) | h, index);
+}
+
+/**
+ * @brief Reaches a neighbor of a cell if it is open, with the cost of the step scaled by the cost of the neighbor.
+ */
+static TMX_INLINE TMX_BOOL
+tmxPathStep(TMXpathfinder *finder, uint32_t from, int x, int y, uint64_t unit)
+{
+    if (!tmxPathOpen(finder, x, y))
+        return TMX_TRUE;
+    return tmxPathReach(finder, from, x, y, unit * finder->costs[(size_t) y * (size_t) finder->width + (size_t) x]);
+}
+
+/**
+ * @brief Reaches each open neighbor of a cell.
+ */
+static TMX_BOOL
+tmxPathExpand(TMXpathfinder *finder, uint32_t index, int x, int y)
+{
+    static const int straight[4][2] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
+    static const int diagonal[4][2] = {{1, 1}, {-1, 1}, {1, -1}, {-1, -1}};
+    int i, nx, ny;
+
+    if (finder->neighbors == TMX_PATH_HEX)
+    {
+        // Along the staggered axis, a shifted row (or column) neighbors the same and the next index, and others the previous.
+        int along = finder->staggerX ? x + finder->offset.x : y + finder->offset.y;
+        int lo    = ((along & 1) ^ finder->staggerEven) ? 0 : -1;
+        int hex[6][2];
+        if (finder->staggerX)
+        {
+            int cells[6][2] = {{0, -1}, {0, 1}, {-1, lo}, {-1, lo + 1}, {1, lo}, {1, lo + 1}};
+            memcpy(hex, cells, sizeof(hex));
+        }
+        else
+        {
+            int cells[6][2] = {{-1, 0}, {1, 0}, {lo, -1}, {lo + 1, -1}, {lo, 1}, {lo + 1, 1}};
+            memcpy(hex, cells, sizeof(hex));
+        }
+        for (i = 0; i < 6; i++)
+        {
+            if (!tmxPathStep(finder, index, x + hex[i][0], y + hex[i][1], TMX_PATH_STRAIGHT_COST))
+                return TMX_FALSE;
+        }
+        return TMX_TRUE;
+    }
+
+    for (i = 0; i < 4; i++)
+    {
+        if (!tmxPathStep(finder, index, x + straight[i][0], y + straight[i][1], TMX_PATH_STRAIGHT_COST))
+            return TMX_FALSE;
+    }
+    if (finder->neighbors != TMX_PATH_EIGHT)
+        return TMX_TRUE;
+
+    for (i = 0; i < 4; i++)
+    {
+        nx = x + diagonal[i][0];
+        ny = y + diagonal[i][1];
+        if (tmxPathOpen(finder, nx, y) && tmxPathOpen(finder, x, ny) && !tmxPathStep(finder, index, nx, ny, TMX_PATH_DIAGONAL_COST))
+            return TMX_FALSE;
+    }
+    return TMX_TRUE;
+}
+
+static TMX_INLINE int
+tmxPathLowestBit(uint64_t bits)
+{
+#if defined(__GNUC__)
+    return __builtin_ctzll(bits);
+#else
+    int i = 0;
+    for (; !(bits & 1); bits >>= 1)
+        i++;
+    return i;
+#endif
+}
+
+static TMX_INLINE int
+tmxPathHighestBit(uint64_t bits)
+{
+#if defined(__GNUC__)
+    return 63 - __builtin_clzll(bits);
+#else
+    int i = 63;
+    for (; !(bits >> 63); bits <<= 1)
+        i--;
+    return i;
+#endif
+}
+
+/**
+ * @brief Describes a line of a bitmap (a row or a column) being scanned for a jump point.
+ */
+typedef struct TMXpathscan
+{
+    const uint64_t *bits; /** The bitmap of open cells. */
+    size_t stride;        /** The number of words in each line. */
+    int lines;            /** The number of lines. */
+    int length;           /** The number of cells in each line. */
+    int line;             /** The line being scanned. */
+    int goalLine;         /** The line of the goal. */
+    int goalPos;          /** The position of the goal along its line. */
+} TMXpathscan;
+
+/**
+ * @brief Retrieves the bits of 64 consecutive cells of a line, where cells outside of the grid are clear.
+ */
+static TMX_INLINE uint64_t
+tmxPathBits(const TMXpathscan *scan, int line, int pos)
+{
+    if (line < 0 || line >= scan->lines || pos >= scan->length || pos <= -64)
+        return 0;
+
+    const uint64_t *words = &scan->bits[(size_t) line * scan->stride];
+    if (pos < 0)
+        return words[0] << -pos;
+
+    size_t word    = (size_t) pos >> 6;
+    unsigned shift = (unsigned) pos & 63;
+    uint64_t bits  = words[word] >> shift;
+    if (shift && word + 1 < scan->stride)
+        bits |= words[word + 1] << (64 - shift);
+    return bits;
+}
+
+/**
+ * @brief Scans along a line from a position, 64 cells at a time, until reaching the goal, a cell with a forced neighbor,
+ * or a blocked cell.
+ *
+ * @details A neighbor on an adjacent line is forced when it is open and the cell behind it is blocked, as it could not
+ * have been reached diagonally without cutting a corner.
+ *
+ * @return The position of the jump point along the line, or -1 if there is none in this direction.
+ */
+static int
+tmxPathScan(const TMXpathscan *scan, int pos, int dir)
+{
+    int p, i;
+    if (dir > 0)
+    {
+        for (p = pos + 1;; p += 64)
+        {
+            uint64_t before = tmxPathBits(scan, scan->line - 1, p), after = tmxPathBits(scan, scan->line + 1, p);
+            uint64_t stop   = (before & ~tmxPathBits(scan, scan->line - 1, p - 1)) | (after & ~tmxPathBits(scan, scan->line + 1, p - 1));
+            uint64_t open   = tmxPathBits(scan, scan->line, p);
+            if (scan->goalLine == scan->line && scan->goalPos >= p && scan->goalPos < p + 64)
+                stop |= (uint64_t) 1 << (scan->goalPos - p);
+            if ((stop |= ~open))
+            {
+                i = tmxPathLowestBit(stop);
+                return (open >> i) & 1 ? p + i : -1;
+            }
+        }
+    }
+
+    // Backwards, each window ends at the next cell, and the scan stops at its highest bit.
+    for (p = pos - 64;; p -= 64)
+    {
+        uint64_t before = tmxPathBits(scan, scan->line - 1, p), after = tmxPathBits(scan, scan->line + 1, p);
+        uint64_t stop   = (before & ~tmxPathBits(scan, scan->line - 1, p + 1)) | (after & ~tmxPathBits(scan, scan->line + 1, p + 1));
+        uint64_t open   = tmxPathBits(scan, scan->line, p);
+        if (scan->goalLine == scan->line && scan->goalPos >= p && scan->goalPos < p + 64)
+            stop |= (uint64_t) 1 << (scan->goalPos - p);
+        if ((stop |= ~open))
+        {
+            i = tmxPathHighestBit(stop);
+            return (open >> i) & 1 ? p + i : -1;
+        }
+    }
+}
+
+/**
+ * @brief Moves from a cell in a straight line until reaching the goal, a cell with a forced neighbor, or a blocked cell.
+ *
+ * @return The index of the jump point, or @ref TMX_PATH_NONE if there is none in this direction.
+ */
+static uint32_t
+tmxPathJumpStraight(const TMXpathfinder *finder, int x, int y, int dx, int dy)
+{
+    TMXpathscan scan;
+    int pos;
+    if (dx)
+    {
+        scan = (TMXpathscan){finder->rows, finder->rowStride, finder->height, finder->width, y, finder->goalY, finder->goalX};
+        if ((pos = tmxPathScan(&scan, x, dx)) < 0)
+            return TMX_PATH_NONE;
+        x = pos;
+    }
+    else
+    {
+        scan = (TMXpathscan){finder->columns, finder->columnStride, finder->width, finder->height, x, finder->goalX, finder->goalY};
+        if ((pos = tmxPathScan(&scan, y, dy)) < 0)
+            return TMX_PATH_NONE;
+        y = pos;
+    }
+    return (uint32_t) y * (uint32_t) finder->width + (uint32_t) x;
+}
+
+/**
+ * @brief Moves from a cell diagonally until reaching the goal, a cell from which a straight jump finds a jump point, or a
+ * step that would cut a corner.
+ *
+ * @return The index of the jump point, or @ref TMX_PATH_NONE if there is none in this direction.
+ */
+static uint32_t
+tmxPathJumpDiagonal(const TMXpathfinder *finder, int x, int y, int dx, int dy)
+{
+    for (;;)
+    {
+        if (!tmxPathOpen(finder, x + dx, y) || !tmxPathOpen(finder, x, y + dy))
+            return TMX_PATH_NONE;
+        x += dx;
+        y += dy;
+        if (!tmxPathOpen(finder, x, y))
+            return TMX_PATH_NONE;
+        if ((x == finder->goalX && y == finder->goalY) || tmxPathJumpStraight(finder, x, y, dx, 0) != TMX_PATH_NONE ||
+            tmxPathJumpStraight(finder, x, y, 0, dy) != TMX_PATH_NONE)
+            return (uint32_t) y * (uint32_t) finder->width + (uint32_t) x;
+    }
+}
+
+/**
+ * @brief Jumps from a cell in each direction that may lead to a shorter path than through its parent, and reaches each
+ * jump point found with the uniform cost of the run.
+ */
+static TMX_BOOL
+tmxPathExpandJump(TMXpathfinder *finder, uint32_t index, int x, int y)
+{
+    int directions[8][2], i, count = 0;
+    uint32_t parent = finder->parents[index];
+
+    if (parent == TMX_PATH_NONE)
+    {
+        static const int all[8][2] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}, {1, 1}, {-1, 1}, {1, -1}, {-1, -1}};
+        memcpy(directions, all, sizeof(all));
+        count = 8;
+    }
+    else
+    {
+        int dx = tmxPathSign(x - (int) (parent % (uint32_t) finder->width));
+        int dy = tmxPathSign(y - (int) (parent / (uint32_t) finder->width));
+
+        // Only the natural neighbors in the direction of travel, and the neighbors to the side forced by obstacles.
+        if (dx && dy)
+        {
+            directions[count][0] = dx, directions[count++][1] = 0;
+            directions[count][0] = 0, directions[count++][1] = dy;
+            directions[count][0] = dx, directions[count++][1] = dy;
+        }
+        else if (dx)
+        {
+            directions[count][0] = dx, directions[count++][1] = 0;
+            directions[count][0] = dx, directions[count++][1] = -1;
+            directions[count][0] = dx, directions[count++][1] = 1;
+            directions[count][0] = 0, directions[count++][1] = -1;
+            directions[count][0] = 0, directions[count++][1] = 1;
+        }
+        else
+        {
+            directions[count][0] = 0, directions[count++][1] = dy;
+            directions[count][0] = -1, directions[count++][1] = dy;
+            directions[count][0] = 1, directions[count++][1] = dy;
+            directions[count][0] = -1, directions[count++][1] = 0;
+            directions[count][0] = 1, directions[count++][1] = 0;
+        }
+    }
+
+    for (i = 0; i < count; i++)
+    {
+        int dx = directions[i][0], dy = directions[i][1];
+        uint32_t jump = dx && dy ? tmxPathJumpDiagonal(finder, x, y, dx, dy) : tmxPathJumpStraight(finder, x, y, dx, dy);
+        if (jump == TMX_PATH_NONE)
+            continue;
+
+        int jx = (int) (jump % (uint32_t) finder->width), jy = (int) (jump / (uint32_t) finder->width);
+        int run = TMX_MAX(tmxPathAbs(jx - x), tmxPathAbs(jy - y));
+        if (!tmxPathReach(finder, index, jx, jy, (uint64_t) run * (dx && dy ? TMX_PATH_DIAGONAL_COST : TMX_PATH_STRAIGHT_COST)))
+            return TMX_FALSE;
+    }
+    return TMX_TRUE;
+}
+
+/**
+ * @brief Searches for a path, leaving the parent of each cell along it in the workspace.
+ *
+ * @return The index of the goal if a path was found, otherwise @ref TMX_PATH_NONE.
+ */
+static uint32_t
+tmxPathSearch(TMXpathfinder *finder, TMXpoint start, TMXpoint goal, TMX_PATH_METHOD method)
+{
+    int sx = start.x - finder->offset.x, sy = start.y - finder->offset.y;
+    if (finder->dirtyFirst < finder->dirtyEnd)
+    {
+        memset(&finder->seen[finder->dirtyFirst], 0, (finder->dirtyEnd - finder->dirtyFirst) * sizeof(uint64_t));
+        memset(&finder->closed[finder->dirtyFirst], 0, (finder->dirtyEnd - finder->dirtyFirst) * sizeof(uint64_t));
+    }
+    finder->dirtyFirst = SIZE_MAX;
+    finder->dirtyEnd   = 0;
+    finder->heapCount  = 0;
+    finder->goalX      = goal.x - finder->offset.x;
+    finder->goalY      = goal.y - finder->offset.y;
+
+    if (sx < 0 || sy < 0 || sx >= finder->width || sy >= finder->height || finder->goalX < 0 || finder->goalY < 0 ||
+        finder->goalX >= finder->width || finder->goalY >= finder->height)
+    {
+        tmxErrorMessage(TMX_ERR_PARAM, "Path endpoints must be within the grid.");
+        return TMX_PATH_NONE;
+    }
+    if (!tmxPathOpen(finder, sx, sy) || !tmxPathOpen(finder, finder->goalX, finder->goalY))
+        return TMX_PATH_NONE;
+
+    TMX_BOOL jump   = method == TMX_PATH_JPS && finder->neighbors == TMX_PATH_EIGHT;
+    uint32_t target = (uint32_t) finder->goalY * (uint32_t) finder->width + (uint32_t) finder->goalX;
+    uint32_t index  = (uint32_t) sy * (uint32_t) finder->width + (uint32_t) sx;
+    uint64_t h      = tmxPathHeuristic(finder, sx, sy);
+
+    tmxPathMark(finder, finder->seen, index);
+    finder->g[index]       = 0;
+    finder->parents[index] = TMX_PATH_NONE;
+    if (!tmxPathPush(finder, (h << 32) | h, index))
+        return TMX_PATH_NONE;
+
+    while (finder->heapCount)
+    {
+        index = tmxPathPop(finder);
+        if (tmxPathTest(finder->closed, index))
+            continue;
+        if (index == target)
+            return target;
+        tmxPathMark(finder, finder->closed, index);
+
+        int x = (int) (index % (uint32_t) finder->width), y = (int) (index / (uint32_t) finder->width);
+        if (!(jump ? tmxPathExpandJump(finder, index, x, y) : tmxPathExpand(finder, index, x, y)))
+            return TMX_PATH_NONE;
+    }
+    return TMX_PATH_NONE;
+}
+
+/**
+ * @brief Searches for a path and appends its result to a path list, with a point for every cell along it.
+ *
+ * @return @c TMX_TRUE if a path was found, otherwise @c TMX_FALSE.
+ */
+static TMX_BOOL
+tmxPathAppend(TMXpathfinder *finder, TMXpoint start, TMXpoint goal, TMX_PATH_METHOD method, TMXpathlist *paths)
+{
+    if (!tmxPathGrow((void **) &paths->paths, &paths->capacity, paths->count + 1, sizeof(TMXpath)))
+        return TMX_FALSE;
+
+    TMXpath *path = &paths->paths[paths->count++];
+    path->first   = paths->point_count;
+    path->count   = 0;
+    path->cost    = 0;
+
+    uint32_t goalIndex = tmxPathSearch(finder, start, goal, method);
+    if (goalIndex == TMX_PATH_NONE)
+        return TMX_FALSE;
+
+    // Jump points are joined by straight or diagonal runs, so each link of the chain is stepped through cell by cell.
+    uint32_t index, parent, width = (uint32_t) finder->width;
+    size_t count = 1;
+    for (index = goalIndex; (parent = finder->parents[index]) != TMX_PATH_NONE; index = parent)
+    {
+        int dx = tmxPathAbs((int) (index % width) - (int) (parent % width));
+        int dy = tmxPathAbs((int) (index / width) - (int) (parent / width));
+        count += (size_t) TMX_MAX(dx, dy);
+    }
+    if (!tmxPathGrow((void **) &paths->points, &paths->point_capacity, paths->point_count + count, sizeof(TMXpoint)))
+        return TMX_FALSE;
+
+    TMXpoint *point = &paths->points[path->first + count];
+    for (index = goalIndex;; index = parent)
+    {
+        int x = (int) (index % width), y = (int) (index / width);
+        parent = finder->parents[index];
+        if (parent == TMX_PATH_NONE)
+        {
+            (--point)->x = x + finder->offset.x;
+            point->y     = y + finder->offset.y;
+            break;
+        }
+
+        int dx = tmxPathSign((int) (parent % width) - x), dy = tmxPathSign((int) (parent / width) - y);
+        while ((uint32_t) y * width + (uint32_t) x != parent)
+        {
+            (--point)->x = x + finder->offset.x;
+            point->y     = y + finder->offset.y;
+            x += dx;
+            y += dy;
+        }
+    }
+
+    path->count = count;
+    path->cost  = finder->g[goalIndex];
+    paths->point_count += count;
+    return TMX_TRUE;
+}
+
+TMXpathfinder *
+tmxPathfinderCreate(const TMXmap *map, const uint8_t *costs, TMXrect region, TMX_PATH_NEIGHBORS neighbors)
+{
+    if (!map || !costs || region.w <= 0 || region.h <= 0)
+    {
+        tmxError(TMX_ERR_VALUE);
+        return NULL;
+    }
+    if ((uint64_t) region.w * (uint64_t) region.h >= TMX_PATH_NONE)
+    {
+        tmxErrorMessage(TMX_ERR_PARAM, "Grid is too large to search.");
+        return NULL;
+    }
+    if (neighbors == TMX_PATH_HEX && map->orientation != TMX_ORIENTATION_HEXAGONAL && map->orientation != TMX_ORIENTATION_STAGGERED)
+    {
+        tmxErrorMessage(TMX_ERR_PARAM, "Hexagonal neighbors require a hexagonal or staggered map.");
+        return NULL;
+    }
+
+    TMXpathfinder *finder = tmxCalloc(1, sizeof(TMXpathfinder));
+    if (!finder)
+        return NULL;
+
+    size_t cells        = (size_t) region.w * (size_t) region.h;
+    size_t words        = (cells + 63) / 64;
+    finder->costs       = costs;
+    finder->width       = region.w;
+    finder->height      = region.h;
+    finder->offset.x    = region.x;
+    finder->offset.y    = region.y;
+    finder->neighbors   = neighbors;
+    finder->staggerX    = map->stagger.axis == TMX_AXIS_X;
+    finder->staggerEven = map->stagger.index == TMX_INDEX_EVEN;
+    finder->g           = tmxMalloc(cells * sizeof(uint32_t));
+    finder->parents     = tmxMalloc(cells * sizeof(uint32_t));
+    finder->seen        = tmxCalloc(words, sizeof(uint64_t));
+    finder->closed      = tmxCalloc(words, sizeof(uint64_t));
+    finder->dirtyFirst  = SIZE_MAX;
+
+    if (neighbors == TMX_PATH_EIGHT)
+    {
+        finder->rowStride    = ((size_t) region.w + 63) / 64;
+        finder->columnStride = ((size_t) region.h + 63) / 64;
+        finder->rows         = tmxMalloc(finder->rowStride * (size_t) region.h * sizeof(uint64_t));
+        finder->columns      = tmxMalloc(finder->columnStride * (size_t) region.w * sizeof(uint64_t));
+        if (finder->rows && finder->columns)
+            tmxPathfinderUpdate(finder);
+    }
+
+    // The frontier of a search is usually proportional to the perimeter of the grid rather than its area.
+    if (!finder->g || !finder->parents || !finder->seen || !finder->closed ||
+        (neighbors == TMX_PATH_EIGHT && (!finder->rows || !finder->columns)) ||
+        !tmxPathGrow((void **) &finder->heap, &finder->heapCapacity, (size_t) (region.w + region.h) * 4, sizeof(TMXpathnode)))
+    {
+        tmxFreePathfinder(finder);
+        return NULL;
+    }
+    return finder;
+}
+
+void
+tmxPathfinderUpdate(TMXpathfinder *finder)
+{
+    int x, y;
+    if (!finder)
+    {
+        tmxError(TMX_ERR_VALUE);
+        return;
+    }
+    if (!finder->rows)
+        return;
+
+    memset(finder->rows, 0, finder->rowStride * (size_t) finder->height * sizeof(uint64_t));
+    memset(finder->columns, 0, finder->columnStride * (size_t) finder->width * sizeof(uint64_t));
+    for (y = 0; y < finder->height; y++)
+    {
+        const uint8_t *row = &finder->costs[(size_t) y * (size_t) finder->width];
+        for (x = 0; x < finder->width; x++)
+        {
+            if (!row[x])
+                continue;
+            finder->rows[(size_t) y * finder->rowStride + (size_t) (x >> 6)] |= (uint64_t) 1 << (x & 63);
+            finder->columns[(size_t) x * finder->columnStride + (size_t) (y >> 6)] |= (uint64_t) 1 << (y & 63);
+        }
+    }
+}
+
+TMXpathlist *
+tmxPathListCreate(void)
+{
+    return TMX_ALLOC(TMXpathlist);
+}
+
+TMX_BOOL
+tmxPathFind(TMXpathfinder *finder, TMXpoint start, TMXpoint goal, TMX_PATH_METHOD method, TMXpathlist *paths)
+{
+    if (!finder || !paths)
+    {
+        tmxError(TMX_ERR_VALUE);
+        return TMX_FALSE;
+    }
+
+    paths->count       = 0;
+    paths->point_count = 0;
+    return tmxPathAppend(finder, start, goal, method, paths);
+}
+
+size_t
+tmxPathFindBatch(TMXpathfinder *finder, const TMXpoint *starts, const TMXpoint *goals, size_t count, TMX_PATH_METHOD method,
+                 TMXpathlist *paths)
+{
+    size_t i, found = 0;
+    if (!finder || !paths || (count && (!starts || !goals)))
+    {
+        tmxError(TMX_ERR_VALUE);
+        return 0;
+    }
+
+    paths->count       = 0;
+    paths->point_count = 0;
+    if (!tmxPathGrow((void **) &paths->paths, &paths->capacity, count, sizeof(TMXpath)))
+        return 0;
+
+    for (i = 0; i < count; i++)
+        found += tmxPathAppend(finder, starts[i], goals[i], method, paths);
+    return found;
+}
+
+void
+tmxFreePathList(TMXpathlist *paths)
+{
+    if (!paths)
+        return;
+
+    tmxFree(paths->paths);
+    tmxFree(paths->points);
+    tmxFree(paths);
+}
+
+void
+tmxFreePathfinder(TMXpathfinder *finder)
+{
+    if (!finder)
+        return;
+
+    tmxFree(finder->g);
+    tmxFree(finder->parents);
+    tmxFree(finder->seen);
+    tmxFree(finder->closed);
+    tmxFree(finder->rows);
+    tmxFree(finder->columns);
+    tmxFree(finder->heap);
+    tmxFree(finder);
+}
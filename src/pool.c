@@ -0,0 +1,159 @@
+#include "internal.h"
+
+/**
+ * @brief The size of a slab, in bytes. Each slab holds as many nodes as fit, with a minimum of one.
+ */
+#define TMX_POOL_SLAB_SIZE 16384
+
+/**
+ * @brief The alignment of nodes within a slab, matching the alignment of the memory header.
+ */
+#define TMX_POOL_ALIGN 16
+
+typedef union TMXpoolnode
+{
+    union TMXpoolnode *next;
+    unsigned char pad[TMX_POOL_ALIGN];
+} TMXpoolnode;
+
+typedef union TMXpoolslab
+{
+    union TMXpoolslab *next;
+    unsigned char pad[TMX_POOL_ALIGN];
+} TMXpoolslab;
+
+typedef struct TMXpool
+{
+    TMXallocator allocator;
+    size_t nodeSize;   /** The size of the type stored in the pool. */
+    size_t stride;     /** The size of each node, including the memory header, or 0 before the first allocation. */
+    size_t live;       /** The number of nodes currently in use. */
+    TMXpoolnode *free; /** Singly-linked list of nodes available for reuse. */
+    TMXpoolslab *slabs;
+} TMXpool;
+
+static void *tmxPoolNodeAlloc(size_t size, TMXuserptr user);
+static void tmxPoolNodeFree(void *memory, size_t size, TMXuserptr user);
+
+#define TMX_POOL_INIT(type, index) {{tmxPoolNodeAlloc, NULL, tmxPoolNodeFree, {.id = index}}, sizeof(type), 0, 0, NULL, NULL}
+
+static TMXpool pools[TMX_POOL_COUNT] = {
+    TMX_POOL_INIT(TMXobject, TMX_POOL_OBJECT),
+    TMX_POOL_INIT(TMXlayer, TMX_POOL_LAYER),
+    TMX_POOL_INIT(struct TMXtext, TMX_POOL_TEXT),
+    TMX_POOL_INIT(TMXproperties, TMX_POOL_PROPERTY),
+};
+
+static TMX_BOOL poolsEnabled;
+static size_t poolReserved;
+
+static TMX_INLINE size_t
+tmxPoolSlabCount(const TMXpool *pool)
+{
+    size_t count = (TMX_POOL_SLAB_SIZE - sizeof(TMXpoolslab)) / pool->stride;
+    return TMX_MAX(count, 1);
+}
+
+static TMX_BOOL
+tmxPoolGrow(TMXpool *pool)
+{
+    size_t count      = tmxPoolSlabCount(pool);
+    size_t size       = sizeof(TMXpoolslab) + count * pool->stride;
+    TMXpoolslab *slab = tmxMemoryRawAlloc(size);
+    if (!slab)
+        return TMX_FALSE;
+
+    slab->next  = pool->slabs;
+    pool->slabs = slab;
+    poolReserved += size;
+
+    // Thread the new nodes onto the free list in address order, so consecutive allocations are adjacent in memory.
+    unsigned char *nodes = (unsigned char *) (slab + 1);
+    size_t i             = count;
+    while (i--)
+    {
+        TMXpoolnode *node = (TMXpoolnode *) (nodes + i * pool->stride);
+        node->next        = pool->free;
+        pool->free        = node;
+    }
+    return TMX_TRUE;
+}
+
+static void *
+tmxPoolNodeAlloc(size_t size, TMXuserptr user)
+{
+    TMXpool *pool = &pools[user.id];
+
+    // The size is only known to include the memory header once requested, and is the same for every node of a pool.
+    if (!pool->stride)
+        pool->stride = (size + TMX_POOL_ALIGN - 1) & ~((size_t) TMX_POOL_ALIGN - 1);
+    else if (size > pool->stride)
+        return NULL;
+
+    if (!pool->free && !tmxPoolGrow(pool))
+        return NULL;
+
+    TMXpoolnode *node = pool->free;
+    pool->free        = node->next;
+    pool->live++;
+    return node;
+}
+
+static void
+tmxPoolNodeFree(void *memory, size_t size, TMXuserptr user)
+{
+    TMX_UNUSED(size);
+    TMXpool *pool     = &pools[user.id];
+    TMXpoolnode *node = memory;
+
+    TMX_ASSERT(pool->live > 0);
+    node->next = pool->free;
+    pool->free = node;
+    pool->live--;
+}
+
+void *
+tmxPoolAlloc(TMX_POOL pool, size_t size)
+{
+    TMX_ASSERT((unsigned) pool < TMX_POOL_COUNT);
+    TMX_ASSERT(size == pools[pool].nodeSize);
+    if (!poolsEnabled)
+        return tmxCalloc(1, size);
+    return tmxCallocPooled(&pools[pool].allocator, size);
+}
+
+size_t
+tmxPoolReservedBytes(void)
+{
+    return poolReserved;
+}
+
+void
+tmxMemoryPools(TMX_BOOL enabled)
+{
+    poolsEnabled = enabled;
+}
+
+void
+tmxMemoryTrim(void)
+{
+    TMXpool *pool;
+    TMXpoolslab *slab;
+
+    for (int i = 0; i < TMX_POOL_COUNT; i++)
+    {
+        pool = &pools[i];
+        if (pool->live || !pool->slabs)
+            continue;
+
+        size_t size = sizeof(TMXpoolslab) + tmxPoolSlabCount(pool) * pool->stride;
+        while (pool->slabs)
+        {
+            slab        = pool->slabs;
+            pool->slabs = slab->next;
+            tmxMemoryRawFree(slab);
+            poolReserved -= size;
+        }
+        pool->free = NULL;
+    }
+}
@@ -10,12 +10,12 @@ tmxTryGetProperty(const TMXproperties *properties, const char *name, TMXproperty
     HASH_FIND(hh, properties, name, strlen(name), entry);
     if (entry)
     {
-        if (*property)
+        if (property)
             *property = &entry->value;
         return TMX_TRUE;
     }
 
-    if (*property)
+    if (property)
         *property = NULL;
     return TMX_FALSE;
 }
@@ -44,7 +44,7 @@ tmxGetPropertiesHead(const TMXproperties *properties)
 static TMXproperties *
 tmxPropertyDup(TMXproperties *src)
 {
-    TMXproperties *dst = tmxCalloc(1, sizeof(TMXproperties));
+    TMXproperties *dst = TMX_POOL_ALLOC(TMXproperties, TMX_POOL_PROPERTY);
     size_t keyLen      = strlen(src->key);
 
     dst->value.name  = tmxStringCopy(src->value.name, keyLen);
@@ -76,6 +76,7 @@ tmxPropertiesDup(TMXproperties *properties)
 
     TMXproperties *result = NULL;
     TMXproperties *temp, *src, *dst;
+    TMX_MEMORY_CATEGORY previousCategory = tmxMemoryCategory(TMX_MEMORY_PROPERTIES);
 
     HASH_ITER(hh, properties, src, temp)
     {
@@ -84,6 +85,7 @@ tmxPropertiesDup(TMXproperties *properties)
     }
 
     tmxPropertiesUpdateLinkage(result);
+    tmxMemoryCategory(previousCategory);
     return result;
 }
 
@@ -0,0 +1,437 @@
+#include "tmx/quads.h"
+#include "internal.h"
+#include <limits.h>
+#include <stdint.h>
+#include <string.h>
+
+typedef struct TMXbaker
+{
+    const TMXmap *map;
+    TMXgrid grid;
+    TMXquadmesh *mesh;
+    TMX_BOOL hexagonal;
+    TMX_BOOL failed;           /** Indicates memory for a range could not be allocated. */
+    TMXgid first;              /** The first GID of the most recently used tileset. */
+    TMXgid end;                /** The GID past the last of the most recently used tileset, or 0 when none is cached. */
+    const TMXtileset *tileset; /** The most recently used tileset. */
+} TMXbaker;
+
+/**
+ * @brief Ensures the mesh has room for at least @a quads quads, writing the indices of any new quads.
+ */
+static TMX_BOOL
+tmxQuadMeshReserve(TMXquadmesh *mesh, size_t quads)
+{
+    size_t i, capacity;
+    if (quads <= mesh->capacity)
+        return TMX_TRUE;
+
+    capacity = TMX_MAX(quads, mesh->capacity * 2);
+
+    TMXvertex *vertices = tmxRealloc(mesh->vertices, capacity * 4 * sizeof(TMXvertex));
+    if (!vertices)
+        return TMX_FALSE;
+    mesh->vertices = vertices;
+
+    uint32_t *indices = tmxRealloc(mesh->indices, capacity * 6 * sizeof(uint32_t));
+    if (!indices)
+        return TMX_FALSE;
+    mesh->indices = indices;
+
+    // The indices of a quad only depend on its position in the mesh, so they are written once as the mesh grows.
+    for (i = mesh->capacity; i < capacity; i++)
+    {
+        uint32_t vertex    = (uint32_t) (i * 4);
+        uint32_t *quad     = &indices[i * 6];
+        quad[0]            = vertex;
+        quad[1]            = vertex + 1;
+        quad[2]            = vertex + 2;
+        quad[3]            = vertex + 2;
+        quad[4]            = vertex + 3;
+        quad[5]            = vertex;
+    }
+    mesh->capacity = capacity;
+    return TMX_TRUE;
+}
+
+static TMX_BOOL
+tmxQuadMeshReserveRanges(TMXquadmesh *mesh, size_t ranges)
+{
+    if (ranges <= mesh->range_capacity)
+        return TMX_TRUE;
+
+    size_t capacity      = TMX_MAX(ranges, mesh->range_capacity * 2);
+    TMXquadrange *result = tmxRealloc(mesh->ranges, capacity * sizeof(TMXquadrange));
+    if (!result)
+        return TMX_FALSE;
+
+    mesh->ranges         = result;
+    mesh->range_capacity = capacity;
+    return TMX_TRUE;
+}
+
+TMXquadmesh *
+tmxQuadMeshCreate(void)
+{
+    return TMX_ALLOC(TMXquadmesh);
+}
+
+void
+tmxFreeQuadMesh(TMXquadmesh *mesh)
+{
+    if (!mesh)
+        return;
+
+    tmxFree(mesh->vertices);
+    tmxFree(mesh->indices);
+    tmxFree(mesh->ranges);
+    tmxFree(mesh);
+}
+
+static TMX_INLINE const TMXtileset *
+tmxBakeTileset(TMXbaker *baker, TMXgid gid, TMXtid *id)
+{
+    // Neighboring cells mostly use the same tileset, so the range of the last one is checked before searching.
+    if (gid >= baker->first && gid < baker->end)
+    {
+        *id = gid - baker->first;
+        return baker->tileset;
+    }
+
+    const TMXtileset *tileset = tmxMapTileset(baker->map, gid, id);
+    if (!tileset || !tileset->rects)
+        return NULL;
+
+    baker->tileset = tileset;
+    baker->first   = gid - *id;
+    baker->end     = baker->first + (TMXgid) tileset->rects->count;
+    return tileset;
+}
+
+static void
+tmxBakeRotate(TMXvertex *quad, int degrees)
+{
+    // Rotations are multiples of 60 degrees, clockwise with the y-axis pointing down.
+    static const float cosines[6] = {1.0f, 0.5f, -0.5f, -1.0f, -0.5f, 0.5f};
+    static const float sines[6]   = {0.0f, 0.8660254f, 0.8660254f, 0.0f, -0.8660254f, -0.8660254f};
+
+    int step = (degrees / 60) % 6;
+    float cx = (quad[0].x + quad[2].x) * 0.5f;
+    float cy = (quad[0].y + quad[2].y) * 0.5f;
+    int i;
+    for (i = 0; i < 4; i++)
+    {
+        float dx  = quad[i].x - cx;
+        float dy  = quad[i].y - cy;
+        quad[i].x = cx + dx * cosines[step] - dy * sines[step];
+        quad[i].y = cy + dx * sines[step] + dy * cosines[step];
+    }
+}
+
+static void
+tmxBakeCell(TMXbaker *baker, int x, int y, TMXgid gid)
+{
+    TMXtid id;
+    TMXgid clean = gid & TMX_GID_TILE_MASK;
+    if (!clean)
+        return;
+
+    const TMXtileset *tileset = tmxBakeTileset(baker, clean, &id);
+    if (!tileset)
+        return;
+
+    const TMXtilerects *rects = tileset->rects;
+    if (!rects->width[id] || !rects->height[id])
+        return;
+
+    // Tiles are aligned to the bottom-left corner of the bounding rectangle of their cell.
+    float width  = (float) rects->width[id];
+    float height = (float) rects->height[id];
+    TMXvec2 cell = tmxGridCellOrigin(&baker->grid, x, y);
+    float left   = cell.x + (float) tileset->offset.x;
+    float bottom = cell.y + baker->grid.tileHeight + (float) tileset->offset.y;
+
+    if (tileset->render_size == TMX_RENDER_SIZE_GRID)
+    {
+        float scaleX = baker->grid.tileWidth / width;
+        float scaleY = baker->grid.tileHeight / height;
+        if (tileset->fill_mode == TMX_FILL_MODE_PRESERVE)
+        {
+            // The tile is centered within the cell, at the largest size that preserves its aspect ratio.
+            float scale = TMX_MIN(scaleX, scaleY);
+            left += (baker->grid.tileWidth - width * scale) * 0.5f;
+            bottom -= (baker->grid.tileHeight - height * scale) * 0.5f;
+            scaleX = scaleY = scale;
+        }
+        width *= scaleX;
+        height *= scaleY;
+    }
+
+    TMX_BOOL flipH    = TMX_HAS_FLAG(gid, TMX_GID_FLIP_HORIZONTAL);
+    TMX_BOOL flipV    = TMX_HAS_FLAG(gid, TMX_GID_FLIP_VERTICAL);
+    TMX_BOOL diagonal = TMX_HAS_FLAG(gid, TMX_GID_FLIP_DIAGONAL) && !baker->hexagonal;
+    if (diagonal)
+    {
+        float swap = width;
+        width      = height;
+        height     = swap;
+    }
+
+    TMXquadmesh *mesh = baker->mesh;
+    TMXvertex *quad   = &mesh->vertices[mesh->quad_count * 4];
+    quad[0].x = quad[3].x = left;
+    quad[1].x = quad[2].x = left + width;
+    quad[0].y = quad[1].y = bottom - height;
+    quad[2].y = quad[3].y = bottom;
+
+    // Each corner samples the opposite edge along a flipped axis, and a diagonal flip swaps the axes it samples from.
+    const float us[2] = {rects->u0[id], rects->u1[id]};
+    const float vs[2] = {rects->v0[id], rects->v1[id]};
+    static const int corners[4][2] = {{0, 0}, {1, 0}, {1, 1}, {0, 1}};
+    int i;
+    for (i = 0; i < 4; i++)
+    {
+        int s = corners[i][0] ^ flipH;
+        int t = corners[i][1] ^ flipV;
+        quad[i].u = us[diagonal ? t : s];
+        quad[i].v = vs[diagonal ? s : t];
+    }
+
+    if (baker->hexagonal)
+    {
+        int degrees = (TMX_HAS_FLAG(gid, TMX_GID_FLIP_DIAGONAL) ? 60 : 0) + (TMX_HAS_FLAG(gid, TMX_GID_ROTATE_120) ? 120 : 0);
+        if (degrees)
+            tmxBakeRotate(quad, degrees);
+    }
+
+    const TMXimage *image = rects->images[id];
+    if (!mesh->range_count || mesh->ranges[mesh->range_count - 1].image != image)
+    {
+        if (!tmxQuadMeshReserveRanges(mesh, mesh->range_count + 1))
+        {
+            baker->failed = TMX_TRUE;
+            return;
+        }
+        TMXquadrange *range = &mesh->ranges[mesh->range_count++];
+        range->image        = image;
+        range->first        = mesh->quad_count;
+        range->count        = 0;
+    }
+    mesh->ranges[mesh->range_count - 1].count++;
+    mesh->quad_count++;
+}
+
+/**
+ * @brief Bakes the cells of a row from column @a x0 up to @a x1 (exclusive), skipping the empty blocks of a tile layer.
+ */
+static void
+tmxBakeRow(TMXbaker *baker, const TMXgid *gids, TMXrect bounds, const TMXoccupancy *occupancy, int y, int x0, int x1, TMX_BOOL left)
+{
+    const TMXgid *row = gids + (size_t) (y - bounds.y) * (size_t) bounds.w;
+    int x, stop;
+
+    if (left)
+    {
+        for (x = x1 - 1; x >= x0; x = stop - 1)
+        {
+            stop = x0;
+            if (occupancy && (x = tmxOccupancyPrevious(occupancy, x, y, x0)) >= x0)
+                stop = tmxOccupancyRunStart(occupancy, x, y, x0);
+            for (; x >= stop; x--)
+                tmxBakeCell(baker, x, y, row[x - bounds.x]);
+        }
+        return;
+    }
+
+    for (x = x0; x < x1; x = stop)
+    {
+        stop = x1;
+        if (occupancy && (x = tmxOccupancyNext(occupancy, x, y, x1)) < x1)
+            stop = tmxOccupancyRunEnd(occupancy, x, y, x1);
+        for (; x < stop; x++)
+            tmxBakeCell(baker, x, y, row[x - bounds.x]);
+    }
+}
+
+/**
+ * @brief Bakes the cells of a rectangular array of tiles within a region, in draw order.
+ *
+ * @param[in] gids The tiles, with a row length of `bounds.w`.
+ * @param[in] bounds The cells of the @a gids array, in tile units.
+ * @param[in] occupancy The occupancy pyramid of a tile layer, used to skip empty blocks of rows, or @c NULL.
+ * @param[in] region The cells to bake, which must be within @a bounds.
+ */
+static void
+tmxBakeCells(TMXbaker *baker, const TMXgid *gids, TMXrect bounds, const TMXoccupancy *occupancy, TMXrect region)
+{
+    int x, y, d, x0 = region.x, y0 = region.y, x1 = region.x + region.w, y1 = region.y + region.h;
+    if (region.w <= 0 || region.h <= 0)
+        return;
+
+#define TMX_BAKE_CELL(cx, cy) tmxBakeCell(baker, (cx), (cy), gids[((cy) - bounds.y) * bounds.w + ((cx) - bounds.x)])
+
+    switch (baker->grid.orientation)
+    {
+        case TMX_ORIENTATION_ISOMETRIC:
+            // Cells on the same diagonal are on the same row of the screen, which is drawn from the top down.
+            for (d = x0 + y0; d <= x1 + y1 - 2; d++)
+            {
+                for (x = TMX_MAX(x0, d - (y1 - 1)); x <= TMX_MIN(x1 - 1, d - y0); x++)
+                    TMX_BAKE_CELL(x, d - x);
+            }
+            break;
+        case TMX_ORIENTATION_STAGGERED:
+        case TMX_ORIENTATION_HEXAGONAL:
+            for (y = y0; y < y1; y++)
+            {
+                if (!baker->grid.staggerX)
+                {
+                    tmxBakeRow(baker, gids, bounds, occupancy, y, x0, x1, TMX_FALSE);
+                    continue;
+                }
+
+                // The shifted columns of a row are lower, so they are drawn after the columns between them.
+                for (x = TMX_GRID_SHIFTED(&baker->grid, x0) ? x0 + 1 : x0; x < x1; x += 2)
+                    TMX_BAKE_CELL(x, y);
+                for (x = TMX_GRID_SHIFTED(&baker->grid, x0) ? x0 : x0 + 1; x < x1; x += 2)
+                    TMX_BAKE_CELL(x, y);
+            }
+            break;
+        default:
+        {
+            TMX_BOOL up   = baker->map->render_order == TMX_RENDER_RIGHT_UP || baker->map->render_order == TMX_RENDER_LEFT_UP;
+            TMX_BOOL left = baker->map->render_order == TMX_RENDER_LEFT_DOWN || baker->map->render_order == TMX_RENDER_LEFT_UP;
+            for (d = 0; d < region.h; d++)
+            {
+                y = up ? y1 - 1 - d : y0 + d;
+                tmxBakeRow(baker, gids, bounds, occupancy, y, x0, x1, left);
+            }
+            break;
+        }
+    }
+
+#undef TMX_BAKE_CELL
+}
+
+static TMXrect
+tmxBakeIntersect(TMXrect a, TMXrect b)
+{
+    TMXrect result;
+    result.x = TMX_MAX(a.x, b.x);
+    result.y = TMX_MAX(a.y, b.y);
+    result.w = TMX_MIN(a.x + a.w, b.x + b.w) - result.x;
+    result.h = TMX_MIN(a.y + a.h, b.y + b.h) - result.y;
+    if (result.w < 0 || result.h < 0)
+        result.w = result.h = 0;
+    return result;
+}
+
+/**
+ * @brief Bakes the cells of a layer within a region, optionally limited to a single chunk.
+ *
+ * @param[in] chunk The index of the only chunk to bake, or @c SIZE_MAX to bake every chunk of an infinite layer.
+ */
+static TMX_BOOL
+tmxBake(const TMXmap *map, const TMXlayer *layer, TMXrect region, size_t chunk, TMXquadmesh *mesh)
+{
+    if (!map || !layer || !mesh)
+    {
+        tmxError(TMX_ERR_VALUE);
+        return TMX_FALSE;
+    }
+    if (layer->type != TMX_LAYER_TILE && layer->type != TMX_LAYER_CHUNK)
+    {
+        tmxErrorMessage(TMX_ERR_PARAM, "Only tile layers can be baked.");
+        return TMX_FALSE;
+    }
+
+    TMXbaker baker;
+    memset(&baker, 0, sizeof(TMXbaker));
+    baker.map       = map;
+    baker.mesh      = mesh;
+    baker.hexagonal = map->orientation == TMX_ORIENTATION_HEXAGONAL;
+    tmxGridInit(&baker.grid, map);
+
+    mesh->quad_count  = 0;
+    mesh->range_count = 0;
+
+    // Quads are reserved for every cell up front, so that the inner loop never needs to check the capacity. Ranges are
+    // only added when the image changes, and grow as needed.
+    size_t i, cells = 0, first = 0, last = 0;
+    TMXrect bounds;
+    if (layer->type == TMX_LAYER_TILE)
+    {
+        if (!layer->data.tiles)
+            return TMX_TRUE;
+        bounds = (TMXrect){.x = 0, .y = 0, .w = layer->size.w, .h = layer->size.h};
+        region = tmxBakeIntersect(region, bounds);
+        cells  = (size_t) region.w * (size_t) region.h;
+    }
+    else
+    {
+        if (chunk != SIZE_MAX && chunk >= layer->count)
+        {
+            tmxErrorMessage(TMX_ERR_PARAM, "Chunk index is out of range.");
+            return TMX_FALSE;
+        }
+        first = chunk == SIZE_MAX ? 0 : chunk;
+        last  = chunk == SIZE_MAX ? layer->count : chunk + 1;
+        for (i = first; i < last; i++)
+        {
+            TMXrect area = tmxBakeIntersect(region, layer->data.chunks[i].bounds);
+            cells += (size_t) area.w * (size_t) area.h;
+        }
+    }
+
+    if (!tmxQuadMeshReserve(mesh, cells))
+        return TMX_FALSE;
+
+    if (layer->type == TMX_LAYER_TILE)
+    {
+        tmxBakeCells(&baker, layer->data.tiles, bounds, layer->occupancy, region);
+    }
+    else
+    {
+        for (i = first; i < last; i++)
+        {
+            const TMXchunk *c = &layer->data.chunks[i];
+            if (c->gids)
+                tmxBakeCells(&baker, c->gids, c->bounds, NULL, tmxBakeIntersect(region, c->bounds));
+        }
+    }
+
+    // The mesh is left empty rather than partially baked.
+    if (baker.failed)
+    {
+        mesh->quad_count  = 0;
+        mesh->range_count = 0;
+        return TMX_FALSE;
+    }
+    return TMX_TRUE;
+}
+
+TMX_BOOL
+tmxBakeLayer(const TMXmap *map, const TMXlayer *layer, TMXquadmesh *mesh)
+{
+    TMXrect all = {.x = INT_MIN / 2, .y = INT_MIN / 2, .w = INT_MAX, .h = INT_MAX};
+    return tmxBake(map, layer, all, SIZE_MAX, mesh);
+}
+
+TMX_BOOL
+tmxBakeRegion(const TMXmap *map, const TMXlayer *layer, TMXrect region, TMXquadmesh *mesh)
+{
+    return tmxBake(map, layer, region, SIZE_MAX, mesh);
+}
+
+TMX_BOOL
+tmxBakeChunk(const TMXmap *map, const TMXlayer *layer, size_t index, TMXquadmesh *mesh)
+{
+    if (layer && layer->type != TMX_LAYER_CHUNK)
+    {
+        tmxErrorMessage(TMX_ERR_PARAM, "Only layers of infinite maps have chunks.");
+        return TMX_FALSE;
+    }
+
+    TMXrect all = {.x = INT_MIN / 2, .y = INT_MIN / 2, .w = INT_MAX, .h = INT_MAX};
+    return tmxBake(map, layer, all, index, mesh);
+}
@@ -0,0 +1,403 @@
+#include "tmx/raycast.h"
+#include "internal.h"
+#include <math.h>
+#include <string.h>
+
+struct TMXraycaster
+{
+    const uint64_t *bits; /** The bitmap of solid cells. */
+    uint64_t *owned;      /** The bitmap when filled from layers, otherwise @c NULL. */
+    TMXrect region;       /** The cells of the bitmap, in tile units. */
+    size_t stride;        /** The number of words in each row of the bitmap. */
+};
+
+/**
+ * @brief Describes the octants around the origin of a field of view, each mapping its columns and rows onto the grid.
+ */
+static const int tmxOctants[8][4] = {
+    {1, 0, 0, 1}, {0, 1, 1, 0}, {0, -1, 1, 0}, {-1, 0, 0, 1}, {-1, 0, 0, -1}, {0, -1, -1, 0}, {0, 1, -1, 0}, {1, 0, 0, -1},
+};
+
+static TMX_INLINE TMX_BOOL
+tmxRaycastSolid(const TMXraycaster *caster, int x, int y)
+{
+    x -= caster->region.x;
+    y -= caster->region.y;
+    if (x < 0 || y < 0 || x >= caster->region.w || y >= caster->region.h)
+        return TMX_FALSE;
+    return (caster->bits[(size_t) y * caster->stride + (size_t) (x >> 6)] >> (x & 63)) & 1;
+}
+
+/**
+ * @brief Clips a segment to the bounds of the grid.
+ *
+ * @param[in,out] t0 The parameter of the start of the segment, moved to where it enters the bounds.
+ * @param[in,out] t1 The parameter of the end of the segment, moved to where it leaves the bounds.
+ * @return @c TMX_FALSE if the segment does not intersect the bounds.
+ */
+static TMX_BOOL
+tmxRaycastClip(const TMXrect *region, double sx, double sy, double dx, double dy, double *t0, double *t1)
+{
+    double lo[2] = {region->x, region->y}, hi[2] = {(double) region->x + region->w, (double) region->y + region->h};
+    double origin[2] = {sx, sy}, delta[2] = {dx, dy};
+    int axis;
+
+    for (axis = 0; axis < 2; axis++)
+    {
+        if (delta[axis] == 0.0)
+        {
+            if (origin[axis] < lo[axis] || origin[axis] >= hi[axis])
+                return TMX_FALSE;
+            continue;
+        }
+        double a = (lo[axis] - origin[axis]) / delta[axis];
+        double b = (hi[axis] - origin[axis]) / delta[axis];
+        *t0      = TMX_MAX(*t0, TMX_MIN(a, b));
+        *t1      = TMX_MIN(*t1, TMX_MAX(a, b));
+    }
+    return *t0 < *t1;
+}
+
+static TMX_INLINE TMX_BOOL
+tmxRaycastHit(TMXrayhit *hit, int x, int y, double distance)
+{
+    hit->hit      = TMX_TRUE;
+    hit->cell.x   = x;
+    hit->cell.y   = y;
+    hit->distance = (float) distance;
+    return TMX_TRUE;
+}
+
+/**
+ * @brief Steps through the cells along a ray until entering a solid cell or reaching its end.
+ */
+static TMX_BOOL
+tmxRaycastOne(const TMXraycaster *caster, const TMXray *ray, TMXrayhit *hit)
+{
+    double sx = ray->start.x, sy = ray->start.y;
+    double dx = (double) ray->end.x - sx, dy = (double) ray->end.y - sy;
+    double length = sqrt(dx * dx + dy * dy), t0 = 0.0, t1 = 1.0, t;
+    int cx = (int) floor(sx), cy = (int) floor(sy);
+
+    hit->hit      = TMX_FALSE;
+    hit->distance = (float) length;
+    if (!tmxRaycastClip(&caster->region, sx, sy, dx, dy, &t0, &t1))
+        return TMX_FALSE;
+
+    // A ray beginning outside of the grid starts from where it enters, and the cell it enters is tested.
+    if (t0 > 0.0)
+    {
+        double px = sx + dx * t0, py = sy + dy * t0;
+        cx        = dx < 0.0 ? (int) ceil(px) - 1 : (int) floor(px);
+        cy        = dy < 0.0 ? (int) ceil(py) - 1 : (int) floor(py);
+        if (tmxRaycastSolid(caster, cx, cy))
+            return tmxRaycastHit(hit, cx, cy, t0 * length);
+    }
+
+    int stepX = dx > 0.0 ? 1 : -1, stepY = dy > 0.0 ? 1 : -1;
+    double deltaX = dx != 0.0 ? fabs(1.0 / dx) : INFINITY;
+    double deltaY = dy != 0.0 ? fabs(1.0 / dy) : INFINITY;
+    double nextX  = dx != 0.0 ? ((double) (dx > 0.0 ? cx + 1 : cx) - sx) / dx : INFINITY;
+    double nextY  = dy != 0.0 ? ((double) (dy > 0.0 ? cy + 1 : cy) - sy) / dy : INFINITY;
+
+    for (;;)
+    {
+        if (nextX < nextY)
+        {
+            if ((t = nextX) >= t1)
+                return TMX_FALSE;
+            cx += stepX;
+            nextX += deltaX;
+        }
+        else if (nextY < nextX)
+        {
+            if ((t = nextY) >= t1)
+                return TMX_FALSE;
+            cy += stepY;
+            nextY += deltaY;
+        }
+        else
+        {
+            // Passing exactly through a corner only touches the two cells beside it, so step diagonally past them.
+            if ((t = nextX) >= t1)
+                return TMX_FALSE;
+            cx += stepX;
+            cy += stepY;
+            nextX += deltaX;
+            nextY += deltaY;
+        }
+        if (tmxRaycastSolid(caster, cx, cy))
+            return tmxRaycastHit(hit, cx, cy, t * length);
+    }
+}
+
+TMXraycaster *
+tmxRaycasterCreate(const TMXlayer *const *layers, size_t count, const TMXtiletable *table)
+{
+    size_t i, k;
+    if (!layers || !count || !table)
+    {
+        tmxError(TMX_ERR_VALUE);
+        return NULL;
+    }
+
+    // The grid covers every layer, including each chunk of infinite layers.
+    TMXrect bounds = {.x = INT32_MAX, .y = INT32_MAX, .w = 0, .h = 0};
+    int right = INT32_MIN, bottom = INT32_MIN;
+    for (i = 0; i < count; i++)
+    {
+        const TMXlayer *layer = layers[i];
+        if (!layer || (layer->type != TMX_LAYER_TILE && layer->type != TMX_LAYER_CHUNK))
+        {
+            tmxErrorMessage(TMX_ERR_PARAM, "Raycasters can only be created from tile layers.");
+            return NULL;
+        }
+        if (layer->type == TMX_LAYER_TILE)
+        {
+            bounds.x = TMX_MIN(bounds.x, 0);
+            bounds.y = TMX_MIN(bounds.y, 0);
+            right    = TMX_MAX(right, layer->size.w);
+            bottom   = TMX_MAX(bottom, layer->size.h);
+            continue;
+        }
+        for (k = 0; k < layer->count; k++)
+        {
+            const TMXrect *chunk = &layer->data.chunks[k].bounds;
+            bounds.x             = TMX_MIN(bounds.x, chunk->x);
+            bounds.y             = TMX_MIN(bounds.y, chunk->y);
+            right                = TMX_MAX(right, chunk->x + chunk->w);
+            bottom               = TMX_MAX(bottom, chunk->y + chunk->h);
+        }
+    }
+    if (right == INT32_MIN)
+        bounds.x = bounds.y = right = bottom = 0;
+    bounds.w = right - bounds.x;
+    bounds.h = bottom - bounds.y;
+
+    TMXraycaster *caster = TMX_ALLOC(TMXraycaster);
+    if (!caster)
+        return NULL;
+
+    caster->region = bounds;
+    caster->stride = ((size_t) bounds.w + 63) / 64;
+    caster->owned  = tmxMalloc(TMX_MAX(caster->stride * (size_t) bounds.h, 1) * sizeof(uint64_t));
+    caster->bits   = caster->owned;
+    if (!caster->owned || !tmxGridFillBits(layers, count, table, bounds, TMX_GRID_MAX, caster->owned))
+    {
+        tmxFreeRaycaster(caster);
+        return NULL;
+    }
+    return caster;
+}
+
+TMXraycaster *
+tmxRaycasterCreateBits(const uint64_t *bits, TMXrect region)
+{
+    if (!bits || region.w < 0 || region.h < 0)
+    {
+        tmxError(TMX_ERR_VALUE);
+        return NULL;
+    }
+
+    TMXraycaster *caster = TMX_ALLOC(TMXraycaster);
+    if (!caster)
+        return NULL;
+
+    caster->bits   = bits;
+    caster->region = region;
+    caster->stride = ((size_t) region.w + 63) / 64;
+    return caster;
+}
+
+const uint64_t *
+tmxRaycasterBits(const TMXraycaster *caster, TMXrect *region)
+{
+    if (!caster)
+    {
+        tmxError(TMX_ERR_VALUE);
+        return NULL;
+    }
+    if (region)
+        *region = caster->region;
+    return caster->bits;
+}
+
+void
+tmxRaycasterSetCell(TMXraycaster *caster, TMXpoint cell, TMX_BOOL solid)
+{
+    if (!caster)
+    {
+        tmxError(TMX_ERR_VALUE);
+        return;
+    }
+    if (!caster->owned)
+    {
+        tmxErrorMessage(TMX_ERR_PARAM, "Only raycasters created from layers can be modified.");
+        return;
+    }
+
+    int x = cell.x - caster->region.x, y = cell.y - caster->region.y;
+    if (x < 0 || y < 0 || x >= caster->region.w || y >= caster->region.h)
+        return;
+
+    uint64_t *word = &caster->owned[(size_t) y * caster->stride + (size_t) (x >> 6)];
+    uint64_t bit   = (uint64_t) 1 << (x & 63);
+    *word          = solid ? *word | bit : *word & ~bit;
+}
+
+size_t
+tmxRaycast(const TMXraycaster *caster, const TMXray *rays, size_t count, TMXrayhit *hits)
+{
+    size_t i, result = 0;
+    if (!caster || (count && (!rays || !hits)))
+    {
+        tmxError(TMX_ERR_VALUE);
+        return 0;
+    }
+
+    for (i = 0; i < count; i++)
+        result += tmxRaycastOne(caster, &rays[i], &hits[i]);
+    return result;
+}
+
+size_t
+tmxLineOfSight(const TMXraycaster *caster, const TMXray *rays, size_t count, uint8_t *visible)
+{
+    TMXrayhit hit;
+    size_t i, result = 0;
+    if (!caster || (count && (!rays || !visible)))
+    {
+        tmxError(TMX_ERR_VALUE);
+        return 0;
+    }
+
+    for (i = 0; i < count; i++)
+    {
+        visible[i] = !tmxRaycastOne(caster, &rays[i], &hit);
+        result += visible[i];
+    }
+    return result;
+}
+
+size_t
+tmxFieldOfViewSize(int radius)
+{
+    if (radius < 0)
+        return 0;
+    return (size_t) (2 * radius + 1) * (size_t) ((2 * radius + 64) / 64);
+}
+
+/**
+ * @brief The state of a field of view computation.
+ */
+typedef struct TMXfov
+{
+    const TMXraycaster *caster;
+    TMXpoint origin;
+    int radius;
+    uint64_t *output;
+    size_t stride; /** The number of words in each row of the output. */
+    size_t count;  /** The number of visible cells. */
+} TMXfov;
+
+static void
+tmxFieldOfViewLight(TMXfov *fov, int x, int y)
+{
+    size_t i       = (size_t) (x - fov->origin.x + fov->radius);
+    size_t j       = (size_t) (y - fov->origin.y + fov->radius);
+    uint64_t *word = &fov->output[j * fov->stride + i / 64];
+    uint64_t bit   = (uint64_t) 1 << (i % 64);
+    if (!(*word & bit))
+    {
+        *word |= bit;
+        fov->count++;
+    }
+}
+
+/**
+ * @brief Lights the cells of an octant between two slopes, row by row outwards from the origin, recursing into the
+ * light that passes each run of solid cells.
+ *
+ * @param[in] row The distance of the first row from the origin.
+ * @param[in] start The slope of the first cell that may be lit, where 1 is the diagonal and 0 the axis.
+ * @param[in] end The slope of the last cell that may be lit.
+ */
+static void
+tmxFieldOfViewCast(TMXfov *fov, int row, double start, double end, const int *octant)
+{
+    double next = start;
+    int j, radius2 = fov->radius * fov->radius;
+    if (start < end)
+        return;
+
+    for (j = row; j <= fov->radius; j++)
+    {
+        TMX_BOOL blocked = TMX_FALSE;
+        int dx, dy = -j;
+        for (dx = -j; dx <= 0; dx++)
+        {
+            int x        = fov->origin.x + dx * octant[0] + dy * octant[1];
+            int y        = fov->origin.y + dx * octant[2] + dy * octant[3];
+            double left  = (dx - 0.5) / (dy + 0.5);
+            double right = (dx + 0.5) / (dy - 0.5);
+            if (start < right)
+                continue;
+            if (end > left)
+                break;
+
+            if (dx * dx + dy * dy <= radius2)
+                tmxFieldOfViewLight(fov, x, y);
+
+            TMX_BOOL solid = tmxRaycastSolid(fov->caster, x, y);
+            if (blocked)
+            {
+                if (solid)
+                {
+                    next = right;
+                    continue;
+                }
+                // The light below a run of solid cells may be narrower than a single slope, leaving none to pass.
+                blocked = TMX_FALSE;
+                start   = next;
+                if (start < end)
+                    return;
+            }
+            else if (solid && j < fov->radius)
+            {
+                blocked = TMX_TRUE;
+                tmxFieldOfViewCast(fov, j + 1, start, left, octant);
+                next = right;
+            }
+        }
+        if (blocked)
+            break;
+    }
+}
+
+size_t
+tmxFieldOfView(const TMXraycaster *caster, TMXpoint origin, int radius, uint64_t *output)
+{
+    int i;
+    if (!caster || !output || radius < 0)
+    {
+        tmxError(TMX_ERR_VALUE);
+        return 0;
+    }
+
+    TMXfov fov = {.caster = caster, .origin = origin, .radius = radius, .output = output, .stride = (size_t) ((2 * radius + 64) / 64)};
+    memset(output, 0, tmxFieldOfViewSize(radius) * sizeof(uint64_t));
+    tmxFieldOfViewLight(&fov, origin.x, origin.y);
+    for (i = 0; i < 8; i++)
+        tmxFieldOfViewCast(&fov, 1, 1.0, 0.0, tmxOctants[i]);
+    return fov.count;
+}
+
+void
+tmxFreeRaycaster(TMXraycaster *caster)
+{
+    if (!caster)
+        return;
+
+    tmxFree(caster->owned);
+    tmxFree(caster);
+}
@@ -0,0 +1,702 @@
+#include "tmx/regions.h"
+#include "internal.h"
+#include <string.h>
+
+/**
+ * @brief A run of filled cells in a single row, whose neighboring rows have yet to be filled.
+ */
+typedef struct TMXfillspan
+{
+    int first; /** The column of the first cell. */
+    int last;  /** The column of the last cell. */
+    int row;   /** The row of the cells. */
+} TMXfillspan;
+
+struct TMXlabeler
+{
+    const uint8_t *values;      /** The value of each cell, when reading a grid of bytes. */
+    uint8_t *owned;             /** The grid of bytes when combined from chunks, otherwise @c NULL. */
+    const TMXgid *gids;         /** The tiles of each cell, when reading a finite layer. */
+    const TMXchunk **chunks;    /** The chunk of each tile, when reading the chunks of an infinite layer in place. */
+    const uint8_t *table;       /** The value of each GID, when reading a layer. */
+    size_t tableCount;          /** The number of GIDs in the table, which is also the index of the empty value. */
+    TMXrect region;             /** The cells of the grid, in tile units. */
+    int tileWidth;              /** The width of each tile of a labeling, in cells. */
+    int tileHeight;             /** The height of each tile of a labeling, in cells. */
+    int tilesX;                 /** The number of tiles in each row. */
+    int tilesY;                 /** The number of rows of tiles. */
+    TMX_BOOL staggerX;
+    TMX_BOOL staggerEven;
+    TMX_BOOL hex;
+    int neighbors[2][8][2];     /** The neighbors of a cell that is not shifted and one that is, along the stagger axis. */
+    int neighborCount;
+    int backward[2][4][2];      /** The neighbors that come before a cell in row-major order. */
+    int backwardCount[2];
+    TMXfillspan *stack;         /** The spans of a flood fill that have yet to be expanded. */
+    size_t stackCapacity;
+};
+
+/**
+ * @brief Ensures an array has room for at least @a count elements, doubling its capacity as needed.
+ */
+static TMX_BOOL
+tmxRegionsGrow(void **array, size_t *capacity, size_t count, size_t size)
+{
+    if (count <= *capacity)
+        return TMX_TRUE;
+
+    size_t grown = TMX_MAX(count, TMX_MAX(*capacity * 2, 16));
+    void *result = tmxRealloc(*array, grown * size);
+    if (!result)
+        return TMX_FALSE;
+
+    *array    = result;
+    *capacity = grown;
+    return TMX_TRUE;
+}
+
+/**
+ * @brief Determines whether a cell is shifted along the stagger axis, which selects its neighbors on hexagonal maps.
+ */
+static TMX_INLINE int
+tmxLabelerShifted(const TMXlabeler *labeler, int x, int y)
+{
+    if (!labeler->hex)
+        return 0;
+    int along = labeler->staggerX ? x + labeler->region.x : y + labeler->region.y;
+    return (along & 1) ^ labeler->staggerEven;
+}
+
+static TMX_INLINE TMX_BOOL
+tmxLabelerOpenGid(const TMXlabeler *labeler, TMXgid gid)
+{
+    gid = TMX_GID_CLEAN(gid);
+    return labeler->table[gid < labeler->tableCount ? gid : labeler->tableCount] != 0;
+}
+
+/**
+ * @brief Tests whether a cell is open, relative to the first cell of the grid.
+ */
+static TMX_INLINE TMX_BOOL
+tmxLabelerOpen(const TMXlabeler *labeler, int x, int y)
+{
+    if (labeler->values)
+        return labeler->values[(size_t) y * (size_t) labeler->region.w + (size_t) x] != 0;
+    if (labeler->gids)
+        return tmxLabelerOpenGid(labeler, labeler->gids[(size_t) y * (size_t) labeler->region.w + (size_t) x]);
+
+    const TMXchunk *chunk = labeler->chunks[(y / labeler->tileHeight) * labeler->tilesX + x / labeler->tileWidth];
+    if (!chunk)
+        return labeler->table[labeler->tableCount] != 0;
+    return tmxLabelerOpenGid(labeler, chunk->gids[(y % labeler->tileHeight) * labeler->tileWidth + x % labeler->tileWidth]);
+}
+
+/**
+ * @brief Writes 1 for each open cell and 0 for each closed cell of a run of cells within a single tile.
+ */
+static void
+tmxLabelerRow(const TMXlabeler *labeler, int x, int y, int count, uint32_t *output)
+{
+    const TMXgid *gids;
+    int i;
+
+    if (labeler->values)
+    {
+        const uint8_t *values = labeler->values + (size_t) y * (size_t) labeler->region.w + (size_t) x;
+        for (i = 0; i < count; i++)
+            output[i] = values[i] != 0;
+        return;
+    }
+
+    if (labeler->gids)
+        gids = labeler->gids + (size_t) y * (size_t) labeler->region.w + (size_t) x;
+    else
+    {
+        const TMXchunk *chunk = labeler->chunks[(y / labeler->tileHeight) * labeler->tilesX + x / labeler->tileWidth];
+        if (!chunk)
+        {
+            uint32_t empty = labeler->table[labeler->tableCount] != 0;
+            for (i = 0; i < count; i++)
+                output[i] = empty;
+            return;
+        }
+        gids = chunk->gids + (y % labeler->tileHeight) * labeler->tileWidth + x % labeler->tileWidth;
+    }
+    for (i = 0; i < count; i++)
+        output[i] = tmxLabelerOpenGid(labeler, gids[i]);
+}
+
+/**
+ * @brief Finds the root of the label of a cell, halving the path to it. Every label links to a smaller one, and a root to itself.
+ */
+static TMX_INLINE uint32_t
+tmxLabelFind(uint32_t *labels, uint32_t label)
+{
+    while (labels[label - 1] != label)
+    {
+        labels[label - 1] = labels[labels[label - 1] - 1];
+        label             = labels[label - 1];
+    }
+    return label;
+}
+
+/**
+ * @brief Joins the sets of two labels, linking the larger root to the smaller.
+ */
+static TMX_INLINE void
+tmxLabelUnion(uint32_t *labels, uint32_t a, uint32_t b)
+{
+    a = tmxLabelFind(labels, a);
+    b = tmxLabelFind(labels, b);
+    if (a < b)
+        labels[b - 1] = a;
+    else if (b < a)
+        labels[a - 1] = b;
+}
+
+static TMXlabeler *
+tmxLabelerAlloc(const TMXmap *map, TMXrect region, TMX_REGION_CONNECT connect)
+{
+    static const int four[4][2]  = {{-1, 0}, {1, 0}, {0, -1}, {0, 1}};
+    static const int eight[8][2] = {{-1, -1}, {0, -1}, {1, -1}, {-1, 0}, {1, 0}, {-1, 1}, {0, 1}, {1, 1}};
+    int shifted, i;
+
+    if ((uint64_t) region.w * (uint64_t) region.h >= UINT32_MAX)
+    {
+        tmxErrorMessage(TMX_ERR_PARAM, "Grid is too large to label.");
+        return NULL;
+    }
+    if (connect == TMX_REGION_HEX && map->orientation != TMX_ORIENTATION_HEXAGONAL && map->orientation != TMX_ORIENTATION_STAGGERED)
+    {
+        tmxErrorMessage(TMX_ERR_PARAM, "Hexagonal neighbors require a hexagonal or staggered map.");
+        return NULL;
+    }
+
+    TMXlabeler *labeler = TMX_ALLOC(TMXlabeler);
+    if (!labeler)
+        return NULL;
+
+    labeler->region      = region;
+    labeler->hex         = connect == TMX_REGION_HEX;
+    labeler->staggerX    = map->stagger.axis == TMX_AXIS_X;
+    labeler->staggerEven = map->stagger.index == TMX_INDEX_EVEN;
+
+    for (shifted = 0; shifted < 2; shifted++)
+    {
+        int (*neighbors)[2] = labeler->neighbors[shifted];
+        if (connect == TMX_REGION_HEX)
+        {
+            // Along the staggered axis, a shifted row (or column) neighbors the same and the next index, and others the previous.
+            int lo = shifted ? 0 : -1;
+            if (labeler->staggerX)
+            {
+                int cells[6][2] = {{0, -1}, {0, 1}, {-1, lo}, {-1, lo + 1}, {1, lo}, {1, lo + 1}};
+                memcpy(neighbors, cells, sizeof(cells));
+            }
+            else
+            {
+                int cells[6][2] = {{-1, 0}, {1, 0}, {lo, -1}, {lo + 1, -1}, {lo, 1}, {lo + 1, 1}};
+                memcpy(neighbors, cells, sizeof(cells));
+            }
+            labeler->neighborCount = 6;
+        }
+        else if (connect == TMX_REGION_EIGHT)
+        {
+            memcpy(neighbors, eight, sizeof(eight));
+            labeler->neighborCount = 8;
+        }
+        else
+        {
+            memcpy(neighbors, four, sizeof(four));
+            labeler->neighborCount = 4;
+        }
+
+        // Every edge is joined once, from the cell that comes later in row-major order.
+        for (i = 0; i < labeler->neighborCount; i++)
+        {
+            if (neighbors[i][1] < 0 || (neighbors[i][1] == 0 && neighbors[i][0] < 0))
+            {
+                int *backward = labeler->backward[shifted][labeler->backwardCount[shifted]++];
+                backward[0]   = neighbors[i][0];
+                backward[1]   = neighbors[i][1];
+            }
+        }
+    }
+    return labeler;
+}
+
+TMXlabeler *
+tmxLabelerCreate(const TMXmap *map, const uint8_t *values, TMXrect region, TMX_REGION_CONNECT connect)
+{
+    if (!map || !values || region.w < 0 || region.h < 0)
+    {
+        tmxError(TMX_ERR_VALUE);
+        return NULL;
+    }
+
+    TMXlabeler *labeler = tmxLabelerAlloc(map, region, connect);
+    if (labeler)
+        labeler->values = values;
+    return labeler;
+}
+
+/**
+ * @brief Reads the chunks of an infinite layer in place when they are all the same size and aligned to it.
+ */
+static TMX_BOOL
+tmxLabelerIndexChunks(TMXlabeler *labeler, const TMXlayer *layer)
+{
+    const TMXrect *first = &layer->data.chunks[0].bounds;
+    size_t i;
+
+    if (first->w <= 0 || first->h <= 0)
+        return TMX_FALSE;
+    for (i = 0; i < layer->count; i++)
+    {
+        const TMXchunk *chunk = &layer->data.chunks[i];
+        if (chunk->bounds.w != first->w || chunk->bounds.h != first->h || chunk->count < (size_t) first->w * (size_t) first->h ||
+            (chunk->bounds.x - labeler->region.x) % first->w || (chunk->bounds.y - labeler->region.y) % first->h)
+            return TMX_FALSE;
+    }
+
+    labeler->tileWidth  = first->w;
+    labeler->tileHeight = first->h;
+    labeler->tilesX     = labeler->region.w / first->w;
+    labeler->tilesY     = labeler->region.h / first->h;
+    labeler->chunks     = tmxCalloc((size_t) labeler->tilesX * (size_t) labeler->tilesY, sizeof(TMXchunk *));
+    if (!labeler->chunks)
+        return TMX_FALSE;
+
+    for (i = 0; i < layer->count; i++)
+    {
+        const TMXchunk *chunk = &layer->data.chunks[i];
+        int tx                = (chunk->bounds.x - labeler->region.x) / first->w;
+        int ty                = (chunk->bounds.y - labeler->region.y) / first->h;
+        labeler->chunks[ty * labeler->tilesX + tx] = chunk;
+    }
+    return TMX_TRUE;
+}
+
+TMXlabeler *
+tmxLabelerCreateLayer(const TMXmap *map, const TMXlayer *layer, const TMXtiletable *table, TMX_REGION_CONNECT connect)
+{
+    size_t i;
+    if (!map || !layer || !table)
+    {
+        tmxError(TMX_ERR_VALUE);
+        return NULL;
+    }
+    if (layer->type != TMX_LAYER_TILE && layer->type != TMX_LAYER_CHUNK)
+    {
+        tmxErrorMessage(TMX_ERR_PARAM, "Labelers can only be created from tile layers.");
+        return NULL;
+    }
+
+    // The grid of an infinite layer covers each of its chunks.
+    TMXrect region = {.x = 0, .y = 0, .w = layer->size.w, .h = layer->size.h};
+    if (layer->type == TMX_LAYER_CHUNK)
+    {
+        int right = 0, bottom = 0;
+        for (i = 0; i < layer->count; i++)
+        {
+            const TMXrect *chunk = &layer->data.chunks[i].bounds;
+            region.x             = i ? TMX_MIN(region.x, chunk->x) : chunk->x;
+            region.y             = i ? TMX_MIN(region.y, chunk->y) : chunk->y;
+            right                = i ? TMX_MAX(right, chunk->x + chunk->w) : chunk->x + chunk->w;
+            bottom               = i ? TMX_MAX(bottom, chunk->y + chunk->h) : chunk->y + chunk->h;
+        }
+        region.w = right - region.x;
+        region.h = bottom - region.y;
+    }
+
+    TMXlabeler *labeler = tmxLabelerAlloc(map, region, connect);
+    if (!labeler)
+        return NULL;
+
+    labeler->table      = table->values;
+    labeler->tableCount = table->count;
+    if (layer->type == TMX_LAYER_TILE)
+    {
+        labeler->gids = layer->data.tiles;
+        if (!labeler->gids && region.w && region.h)
+        {
+            tmxErrorMessage(TMX_ERR_PARAM, "Layer has no tile data.");
+            tmxFreeLabeler(labeler);
+            return NULL;
+        }
+    }
+    else if (!layer->count || !tmxLabelerIndexChunks(labeler, layer))
+    {
+        // Chunks of differing sizes are combined into a grid of bytes instead.
+        size_t cells   = (size_t) region.w * (size_t) region.h;
+        labeler->owned = tmxMalloc(TMX_MAX(cells, 1));
+        labeler->values = labeler->owned;
+        if (!labeler->owned || (cells && !tmxGridFill(&layer, 1, table, region, TMX_GRID_TOP, labeler->owned)))
+        {
+            tmxFreeLabeler(labeler);
+            return NULL;
+        }
+        tmxFree(labeler->chunks);
+        labeler->chunks = NULL;
+    }
+    return labeler;
+}
+
+TMXregions *
+tmxRegionsCreate(void)
+{
+    return TMX_ALLOC(TMXregions);
+}
+
+TMX_BOOL
+tmxLabelBegin(TMXlabeler *labeler, TMXregions *regions, int size, size_t *tiles)
+{
+    if (!labeler || !regions || !tiles)
+    {
+        tmxError(TMX_ERR_VALUE);
+        return TMX_FALSE;
+    }
+
+    *tiles         = 0;
+    size_t cells   = (size_t) labeler->region.w * (size_t) labeler->region.h;
+    regions->count = 0;
+    if (!tmxRegionsGrow((void **) &regions->labels, &regions->label_capacity, cells, sizeof(uint32_t)))
+        return TMX_FALSE;
+    regions->bounds = labeler->region;
+    if (!cells)
+        return TMX_TRUE;
+
+    // Chunks that are read in place are always their own tiles.
+    if (!labeler->chunks)
+    {
+        labeler->tileWidth  = size > 0 ? TMX_MIN(size, labeler->region.w) : labeler->region.w;
+        labeler->tileHeight = size > 0 ? TMX_MIN(size, labeler->region.h) : labeler->region.h;
+        labeler->tilesX     = (labeler->region.w + labeler->tileWidth - 1) / labeler->tileWidth;
+        labeler->tilesY     = (labeler->region.h + labeler->tileHeight - 1) / labeler->tileHeight;
+    }
+    *tiles = (size_t) labeler->tilesX * (size_t) labeler->tilesY;
+    return TMX_TRUE;
+}
+
+void
+tmxLabelTile(const TMXlabeler *labeler, TMXregions *regions, size_t index)
+{
+    int x, y, i;
+    if (!labeler || !regions)
+    {
+        tmxError(TMX_ERR_VALUE);
+        return;
+    }
+
+    size_t width     = (size_t) labeler->region.w;
+    int left         = (int) (index % (size_t) labeler->tilesX) * labeler->tileWidth;
+    int top          = (int) (index / (size_t) labeler->tilesX) * labeler->tileHeight;
+    int right        = TMX_MIN(left + labeler->tileWidth, labeler->region.w);
+    int bottom       = TMX_MIN(top + labeler->tileHeight, labeler->region.h);
+    uint32_t *labels = regions->labels;
+
+    // Cells ahead of the current one hold 1 when open, and those behind it the label they link to.
+    for (y = top; y < bottom; y++)
+    {
+        uint32_t *row = labels + (size_t) y * width;
+        tmxLabelerRow(labeler, left, y, right - left, row + left);
+        for (x = left; x < right; x++)
+        {
+            if (!row[x])
+                continue;
+
+            int shifted              = tmxLabelerShifted(labeler, x, y);
+            const int (*backward)[2] = labeler->backward[shifted];
+            uint32_t label           = 0;
+            for (i = 0; i < labeler->backwardCount[shifted]; i++)
+            {
+                int nx = x + backward[i][0], ny = y + backward[i][1];
+                if (nx < left || nx >= right || ny < top)
+                    continue;
+
+                uint32_t neighbor = labels[(size_t) ny * width + (size_t) nx];
+                if (!neighbor)
+                    continue;
+
+                neighbor = tmxLabelFind(labels, neighbor);
+                if (!label)
+                    label = neighbor;
+                else if (neighbor < label)
+                {
+                    labels[label - 1] = neighbor;
+                    label             = neighbor;
+                }
+                else if (neighbor > label)
+                    labels[neighbor - 1] = label;
+            }
+            row[x] = label ? label : (uint32_t) ((size_t) y * width + (size_t) x + 1);
+        }
+    }
+}
+
+/**
+ * @brief Joins the cells along the edges of a tile to their neighbors in other tiles that come before them.
+ */
+static void
+tmxLabelSeams(const TMXlabeler *labeler, uint32_t *labels, size_t index)
+{
+    size_t width = (size_t) labeler->region.w;
+    int left     = (int) (index % (size_t) labeler->tilesX) * labeler->tileWidth;
+    int top      = (int) (index / (size_t) labeler->tilesX) * labeler->tileHeight;
+    int right    = TMX_MIN(left + labeler->tileWidth, labeler->region.w);
+    int bottom   = TMX_MIN(top + labeler->tileHeight, labeler->region.h);
+    int x, y, i;
+
+    for (y = top; y < bottom; y++)
+    {
+        // Below the first row, only the first and last columns have neighbors in the rows above outside of the tile.
+        int step = y == top ? 1 : TMX_MAX(right - left - 1, 1);
+        for (x = left; x < right; x += step)
+        {
+            uint32_t label = labels[(size_t) y * width + (size_t) x];
+            if (!label)
+                continue;
+
+            int shifted              = tmxLabelerShifted(labeler, x, y);
+            const int (*backward)[2] = labeler->backward[shifted];
+            for (i = 0; i < labeler->backwardCount[shifted]; i++)
+            {
+                int nx = x + backward[i][0], ny = y + backward[i][1];
+                if (nx < 0 || nx >= labeler->region.w || ny < 0 || (nx >= left && nx < right && ny >= top))
+                    continue;
+
+                uint32_t neighbor = labels[(size_t) ny * width + (size_t) nx];
+                if (neighbor)
+                    tmxLabelUnion(labels, label, neighbor);
+            }
+        }
+    }
+}
+
+TMX_BOOL
+tmxLabelEnd(const TMXlabeler *labeler, TMXregions *regions)
+{
+    if (!labeler || !regions)
+    {
+        tmxError(TMX_ERR_VALUE);
+        return TMX_FALSE;
+    }
+
+    size_t cells     = (size_t) labeler->region.w * (size_t) labeler->region.h;
+    size_t tiles     = cells ? (size_t) labeler->tilesX * (size_t) labeler->tilesY : 0;
+    uint32_t *labels = regions->labels;
+    size_t i;
+    int x, y;
+
+    if (tiles > 1)
+    {
+        for (i = 0; i < tiles; i++)
+            tmxLabelSeams(labeler, labels, i);
+    }
+
+    // Roots are the first cell of their region, and every other cell links to an earlier one, whose final label is known.
+    regions->count = 0;
+    for (i = 0, y = 0; y < labeler->region.h; y++)
+    {
+        for (x = 0; x < labeler->region.w; x++, i++)
+        {
+            uint32_t label = labels[i];
+            if (!label)
+                continue;
+
+            if (label == i + 1)
+            {
+                if (!tmxRegionsGrow((void **) &regions->regions, &regions->capacity, regions->count + 1, sizeof(TMXregion)))
+                    return TMX_FALSE;
+
+                TMXregion *region = &regions->regions[regions->count];
+                region->bounds.x  = region->bounds.w = x;
+                region->bounds.y  = region->bounds.h = y;
+                region->cells     = 1;
+                labels[i]         = (uint32_t) ++regions->count;
+                continue;
+            }
+
+            // While labeling, the bounds hold the first and last column and row of the region.
+            label             = labels[label - 1];
+            labels[i]         = label;
+            TMXregion *region = &regions->regions[label - 1];
+            region->bounds.x  = TMX_MIN(region->bounds.x, x);
+            region->bounds.w  = TMX_MAX(region->bounds.w, x);
+            region->bounds.h  = y;
+            region->cells++;
+        }
+    }
+
+    for (i = 0; i < regions->count; i++)
+    {
+        TMXrect *bounds = &regions->regions[i].bounds;
+        bounds->w       = bounds->w - bounds->x + 1;
+        bounds->h       = bounds->h - bounds->y + 1;
+        bounds->x += labeler->region.x;
+        bounds->y += labeler->region.y;
+    }
+    return TMX_TRUE;
+}
+
+TMX_BOOL
+tmxLabel(TMXlabeler *labeler, TMXregions *regions)
+{
+    size_t i, tiles;
+    if (!tmxLabelBegin(labeler, regions, 0, &tiles))
+        return TMX_FALSE;
+    for (i = 0; i < tiles; i++)
+        tmxLabelTile(labeler, regions, i);
+    return tmxLabelEnd(labeler, regions);
+}
+
+static TMX_INLINE TMX_BOOL
+tmxFloodFilled(const uint64_t *row, int x)
+{
+    return (row[x >> 6] >> (x & 63)) & 1;
+}
+
+/**
+ * @brief Sets the bits of a run of cells in a single row of a bitmap.
+ */
+static void
+tmxFloodSet(uint64_t *row, int first, int last)
+{
+    int word = first >> 6, end = last >> 6;
+    uint64_t head = ~UINT64_C(0) << (first & 63), tail = ~UINT64_C(0) >> (63 - (last & 63));
+    if (word == end)
+    {
+        row[word] |= head & tail;
+        return;
+    }
+    row[word++] |= head;
+    while (word < end)
+        row[word++] = ~UINT64_C(0);
+    row[end] |= tail;
+}
+
+size_t
+tmxFloodFill(TMXlabeler *labeler, TMXpoint seed, uint64_t *output, TMXrect *bounds)
+{
+    if (!labeler || !output)
+    {
+        tmxError(TMX_ERR_VALUE);
+        return 0;
+    }
+    if (bounds)
+        memset(bounds, 0, sizeof(TMXrect));
+
+    int width     = labeler->region.w;
+    int height    = labeler->region.h;
+    int x         = seed.x - labeler->region.x;
+    int y         = seed.y - labeler->region.y;
+    size_t stride = ((size_t) width + 63) / 64;
+    if (x < 0 || y < 0 || x >= width || y >= height || tmxFloodFilled(output + (size_t) y * stride, x) || !tmxLabelerOpen(labeler, x, y))
+        return 0;
+
+    TMXrect extent = {.x = x, .y = y, .w = x, .h = y};
+    size_t count = 0, pending = 0;
+    int first = x, last = x, dy, i;
+
+    // Every span is filled when it is found, and expanded into the rows above and below it later.
+    while (first > 0 && tmxLabelerOpen(labeler, first - 1, y) && !tmxFloodFilled(output + (size_t) y * stride, first - 1))
+        first--;
+    while (last + 1 < width && tmxLabelerOpen(labeler, last + 1, y) && !tmxFloodFilled(output + (size_t) y * stride, last + 1))
+        last++;
+    if (!tmxRegionsGrow((void **) &labeler->stack, &labeler->stackCapacity, 1, sizeof(TMXfillspan)))
+        return 0;
+    tmxFloodSet(output + (size_t) y * stride, first, last);
+    labeler->stack[pending++] = (TMXfillspan){first, last, y};
+    count += (size_t) (last - first + 1);
+
+    while (pending)
+    {
+        TMXfillspan span = labeler->stack[--pending];
+        extent.x         = TMX_MIN(extent.x, span.first);
+        extent.w         = TMX_MAX(extent.w, span.last);
+        extent.y         = TMX_MIN(extent.y, span.row);
+        extent.h         = TMX_MAX(extent.h, span.row);
+
+        for (dy = -1; dy <= 1; dy += 2)
+        {
+            y = span.row + dy;
+            if (y < 0 || y >= height)
+                continue;
+
+            // The cells of the next row touching the span lie between the leftmost neighbor of its first cell and the
+            // rightmost neighbor of its last.
+            const int (*head)[2] = labeler->neighbors[tmxLabelerShifted(labeler, span.first, span.row)];
+            const int (*tail)[2] = labeler->neighbors[tmxLabelerShifted(labeler, span.last, span.row)];
+            int from = width, to = -1;
+            for (i = 0; i < labeler->neighborCount; i++)
+            {
+                if (head[i][1] == dy)
+                    from = TMX_MIN(from, span.first + head[i][0]);
+                if (tail[i][1] == dy)
+                    to = TMX_MAX(to, span.last + tail[i][0]);
+            }
+
+            uint64_t *row = output + (size_t) y * stride;
+            for (x = TMX_MAX(from, 0), to = TMX_MIN(to, width - 1); x <= to; x++)
+            {
+                if (tmxFloodFilled(row, x) || !tmxLabelerOpen(labeler, x, y))
+                    continue;
+
+                first = last = x;
+                while (first > 0 && tmxLabelerOpen(labeler, first - 1, y) && !tmxFloodFilled(row, first - 1))
+                    first--;
+                while (last + 1 < width && tmxLabelerOpen(labeler, last + 1, y) && !tmxFloodFilled(row, last + 1))
+                    last++;
+                if (!tmxRegionsGrow((void **) &labeler->stack, &labeler->stackCapacity, pending + 1, sizeof(TMXfillspan)))
+                    return 0;
+
+                tmxFloodSet(row, first, last);
+                labeler->stack[pending++] = (TMXfillspan){first, last, y};
+                count += (size_t) (last - first + 1);
+                x = last + 1;
+            }
+        }
+    }
+
+    if (bounds)
+    {
+        bounds->x = extent.x + labeler->region.x;
+        bounds->y = extent.y + labeler->region.y;
+        bounds->w = extent.w - extent.x + 1;
+        bounds->h = extent.h - extent.y + 1;
+    }
+    return count;
+}
+
+TMXrect
+tmxLabelerRegion(const TMXlabeler *labeler)
+{
+    TMXrect region = {0};
+    if (!labeler)
+    {
+        tmxError(TMX_ERR_VALUE);
+        return region;
+    }
+    return labeler->region;
+}
+
+void
+tmxFreeRegions(TMXregions *regions)
+{
+    if (!regions)
+        return;
+    tmxFree(regions->labels);
+    tmxFree(regions->regions);
+    tmxFree(regions);
+}
+
+void
+tmxFreeLabeler(TMXlabeler *labeler)
+{
+    if (!labeler)
+        return;
+    tmxFree(labeler->owned);
+    tmxFree(labeler->chunks);
+    tmxFree(labeler->stack);
+    tmxFree(labeler);
+}
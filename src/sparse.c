@@ -0,0 +1,291 @@
+#include "internal.h"
+#include <string.h>
+
+static float sparseThreshold = -1.0f;
+
+void
+tmxSparseLayers(float threshold)
+{
+    sparseThreshold = threshold;
+}
+
+/**
+ * @brief Compares the positions of two chunks in row-major order.
+ */
+static int
+tmxSparseCompare(const void *a, const void *b)
+{
+    const TMXrect *left = &((const TMXchunk *) a)->bounds, *right = &((const TMXchunk *) b)->bounds;
+    if (left->y != right->y)
+        return left->y < right->y ? -1 : 1;
+    return left->x < right->x ? -1 : (left->x > right->x);
+}
+
+/**
+ * @brief Builds the mask of the non-empty cells of a chunk.
+ */
+static TMX_BOOL
+tmxSparseMask(TMXchunk *chunk)
+{
+    size_t i, words = (chunk->count + 63) / 64;
+    chunk->mask     = tmxMallocCategory(TMX_MAX(words, 1) * sizeof(uint64_t), TMX_MEMORY_TILES);
+    if (!chunk->mask)
+        return TMX_FALSE;
+
+    memset(chunk->mask, 0, TMX_MAX(words, 1) * sizeof(uint64_t));
+    for (i = 0; chunk->gids && i < chunk->count; i++)
+        chunk->mask[i >> 6] |= (uint64_t) (chunk->gids[i] != 0) << (i & 63);
+    return TMX_TRUE;
+}
+
+static void
+tmxSparseFreeChunks(TMXchunk *chunks, size_t count)
+{
+    size_t i;
+    for (i = 0; i < count; i++)
+    {
+        tmxFree(chunks[i].gids);
+        tmxFree(chunks[i].mask);
+    }
+    tmxFree(chunks);
+}
+
+/**
+ * @brief Stores a finite tile layer as a chunk for each occupied block, when the occupancy is at or below the threshold.
+ */
+static void
+tmxSparseConvert(TMXlayer *layer, float threshold)
+{
+    const int size      = TMX_SPARSE_CHUNK_SIZE;
+    const TMXgid *tiles = layer->data.tiles;
+    int width = layer->size.w, height = layer->size.h;
+    int x, y, bx, by;
+    if (!tiles || width <= 0 || height <= 0 || (size_t) width * (size_t) height != layer->count)
+        return;
+
+    int columns   = (width + size - 1) / size;
+    int rows      = (height + size - 1) / size;
+    size_t blocks = (size_t) columns * (size_t) rows, occupied = 0, i;
+
+    uint8_t *used = tmxMallocCategory(blocks, TMX_MEMORY_TEMPORARY);
+    if (!used)
+        return;
+    memset(used, 0, blocks);
+    for (y = 0; y < height; y++)
+    {
+        const TMXgid *row = tiles + (size_t) y * (size_t) width;
+        uint8_t *flags    = used + (size_t) (y / size) * (size_t) columns;
+        for (x = 0; x < width; x++)
+            flags[x / size] |= row[x] != 0;
+    }
+    for (i = 0; i < blocks; i++)
+        occupied += used[i];
+
+    if ((double) occupied > (double) threshold * (double) blocks)
+    {
+        tmxFree(used);
+        return;
+    }
+
+    // Chunks are created in row-major order of the blocks, which keeps them sorted for tmxLayerGid.
+    TMXchunk *chunks = NULL;
+    if (occupied && !(chunks = tmxMallocCategory(occupied * sizeof(TMXchunk), TMX_MEMORY_TILES)))
+    {
+        tmxFree(used);
+        return;
+    }
+
+    size_t count = 0;
+    for (by = 0; by < rows; by++)
+    {
+        for (bx = 0; bx < columns; bx++)
+        {
+            if (!used[(size_t) by * (size_t) columns + (size_t) bx])
+                continue;
+
+            TMXchunk *chunk = &chunks[count++];
+            chunk->bounds.x = bx * size;
+            chunk->bounds.y = by * size;
+            chunk->bounds.w = TMX_MIN(size, width - chunk->bounds.x);
+            chunk->bounds.h = TMX_MIN(size, height - chunk->bounds.y);
+            chunk->count    = (size_t) chunk->bounds.w * (size_t) chunk->bounds.h;
+            chunk->mask     = NULL;
+            chunk->gids     = tmxMallocCategory(chunk->count * sizeof(TMXgid), TMX_MEMORY_TILES);
+            if (!chunk->gids)
+            {
+                tmxSparseFreeChunks(chunks, count);
+                tmxFree(used);
+                return;
+            }
+
+            for (y = 0; y < chunk->bounds.h; y++)
+            {
+                memcpy(chunk->gids + (size_t) y * (size_t) chunk->bounds.w,
+                       tiles + (size_t) (chunk->bounds.y + y) * (size_t) width + (size_t) chunk->bounds.x,
+                       (size_t) chunk->bounds.w * sizeof(TMXgid));
+            }
+            if (!tmxSparseMask(chunk))
+            {
+                tmxSparseFreeChunks(chunks, count);
+                tmxFree(used);
+                return;
+            }
+        }
+    }
+
+    tmxFree(used);
+    tmxFree(layer->data.tiles);
+    layer->type        = TMX_LAYER_CHUNK;
+    layer->count       = occupied;
+    layer->data.chunks = chunks;
+}
+
+/**
+ * @brief Removes the chunks of a chunk layer without any tiles, and builds the mask of the others.
+ */
+static void
+tmxSparseChunks(TMXlayer *layer)
+{
+    size_t i, k, count = 0;
+    for (i = 0; i < layer->count; i++)
+    {
+        TMXchunk *chunk = &layer->data.chunks[i];
+        for (k = 0; chunk->gids && k < chunk->count && !chunk->gids[k]; k++)
+            ;
+        if (!chunk->gids || k == chunk->count)
+        {
+            tmxFree(chunk->gids);
+            tmxFree(chunk->mask);
+            continue;
+        }
+        if (!chunk->mask)
+            tmxSparseMask(chunk);
+        layer->data.chunks[count++] = *chunk;
+    }
+
+    layer->count = count;
+    if (!count)
+    {
+        tmxFree(layer->data.chunks);
+        layer->data.chunks = NULL;
+    }
+}
+
+static void
+tmxSparseBuildLayers(TMXlayer **layers, size_t count, TMX_BOOL infinite)
+{
+    size_t i, k;
+    for (i = 0; i < count; i++)
+    {
+        TMXlayer *layer = layers[i];
+        if (!layer)
+            continue;
+        if (layer->type == TMX_LAYER_GROUP)
+        {
+            tmxSparseBuildLayers(layer->data.group, layer->count, infinite);
+            continue;
+        }
+        if (layer->type == TMX_LAYER_TILE && !infinite && sparseThreshold >= 0.0f)
+            tmxSparseConvert(layer, sparseThreshold);
+        if (layer->type != TMX_LAYER_CHUNK)
+            continue;
+
+        // Chunks are kept in row-major order, so that the chunk of a cell can be found with a binary search.
+        for (k = 1; k < layer->count && tmxSparseCompare(&layer->data.chunks[k - 1], &layer->data.chunks[k]) <= 0; k++)
+            ;
+        if (k < layer->count)
+            qsort(layer->data.chunks, layer->count, sizeof(TMXchunk), tmxSparseCompare);
+        if (infinite && sparseThreshold >= 0.0f)
+            tmxSparseChunks(layer);
+    }
+}
+
+void
+tmxMapBuildSparseLayers(TMXmap *map)
+{
+    if (map)
+        tmxSparseBuildLayers(map->layers, map->layer_count, map->infinite);
+}
+
+TMXchunk *
+tmxLayerChunk(const TMXlayer *layer, int x, int y)
+{
+    // Find the row of chunks beginning at or above the cell, and then the chunk beginning at or left of it within the row.
+    TMXchunk *chunks = layer->data.chunks;
+    size_t lo = 0, hi = layer->count, mid;
+    while (lo < hi)
+    {
+        mid = lo + (hi - lo) / 2;
+        if (chunks[mid].bounds.y <= y)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    if (!lo)
+        return NULL;
+
+    int top = chunks[lo - 1].bounds.y;
+    hi      = lo;
+    lo      = 0;
+    while (lo < hi)
+    {
+        mid = lo + (hi - lo) / 2;
+        if (chunks[mid].bounds.y < top || (chunks[mid].bounds.y == top && chunks[mid].bounds.x <= x))
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    if (!lo)
+        return NULL;
+
+    TMXchunk *chunk = &chunks[lo - 1];
+    if (chunk->bounds.y != top || x >= chunk->bounds.x + chunk->bounds.w || y >= chunk->bounds.y + chunk->bounds.h)
+        return NULL;
+    return chunk;
+}
+
+TMXgid
+tmxLayerGid(const TMXlayer *layer, int x, int y)
+{
+    if (!layer)
+    {
+        tmxError(TMX_ERR_VALUE);
+        return 0;
+    }
+    if (layer->type == TMX_LAYER_TILE)
+    {
+        if (!layer->data.tiles || x < 0 || y < 0 || x >= layer->size.w || y >= layer->size.h)
+            return 0;
+        return layer->data.tiles[(size_t) y * (size_t) layer->size.w + (size_t) x];
+    }
+    if (layer->type != TMX_LAYER_CHUNK)
+    {
+        tmxErrorMessage(TMX_ERR_PARAM, "Layer is not a tile layer.");
+        return 0;
+    }
+
+    const TMXchunk *chunk = tmxLayerChunk(layer, x, y);
+    if (!chunk || !chunk->gids)
+        return 0;
+    return chunk->gids[(size_t) (y - chunk->bounds.y) * (size_t) chunk->bounds.w + (size_t) (x - chunk->bounds.x)];
+}
+
+TMXrect
+tmxLayerChunkBounds(const TMXlayer *layer)
+{
+    TMXrect region = {0};
+    int right = 0, bottom = 0;
+    size_t i;
+
+    for (i = 0; i < layer->count; i++)
+    {
+        TMXrect bounds = layer->data.chunks[i].bounds;
+        region.x       = i ? TMX_MIN(region.x, bounds.x) : bounds.x;
+        region.y       = i ? TMX_MIN(region.y, bounds.y) : bounds.y;
+        right          = i ? TMX_MAX(right, bounds.x + bounds.w) : bounds.x + bounds.w;
+        bottom         = i ? TMX_MAX(bottom, bounds.y + bounds.h) : bounds.y + bounds.h;
+    }
+    region.w = right - region.x;
+    region.h = bottom - region.y;
+    return region;
+}
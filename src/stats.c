@@ -0,0 +1,123 @@
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 199309L
+#endif
+
+#include "internal.h"
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#define TMX_STATS_MAX_DEPTH 32
+
+struct TMXstatsframe
+{
+    TMX_PHASE phase;
+    double start;
+};
+
+TMXloadstats *tmxStatsTarget;
+
+static struct TMXstatsframe statsStack[TMX_STATS_MAX_DEPTH];
+static size_t statsDepth;
+static size_t statsPhaseDepth[TMX_PHASE_COUNT];
+static double statsMark;
+
+double
+tmxTimeNow(void)
+{
+#ifdef _WIN32
+    LARGE_INTEGER counter, frequency;
+    QueryPerformanceCounter(&counter);
+    QueryPerformanceFrequency(&frequency);
+    return (double) counter.QuadPart / (double) frequency.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec + (double) ts.tv_nsec * 1e-9;
+#endif
+}
+
+void
+tmxLoadStats(TMXloadstats *stats)
+{
+    // Changing the target in the middle of a load (i.e. from an image callback) would leave unbalanced frames.
+    if (statsDepth)
+    {
+        tmxErrorMessage(TMX_ERR_INVALID_OPERATION, "Cannot change statistics target while loading.");
+        return;
+    }
+    tmxStatsTarget = stats;
+}
+
+const char *
+tmxPhaseName(TMX_PHASE phase)
+{
+    static const char *names[TMX_PHASE_COUNT] = {"load", "read", "parse", "csv", "base64", "inflate", "tileset", "template", "image"};
+    if ((unsigned) phase >= TMX_PHASE_COUNT)
+        return NULL;
+    return names[phase];
+}
+
+TMX_BOOL
+tmxStatsBegin(TMX_PHASE phase)
+{
+    double now = tmxTimeNow();
+
+    if (statsDepth == 0)
+    {
+        memset(tmxStatsTarget, 0, sizeof(TMXloadstats));
+    }
+    else if (statsDepth <= TMX_STATS_MAX_DEPTH)
+    {
+        tmxStatsTarget->phases[statsStack[statsDepth - 1].phase].self_seconds += now - statsMark;
+    }
+
+    // Frames nested beyond the maximum depth are still counted, but their time belongs to the deepest tracked frame.
+    if (statsDepth < TMX_STATS_MAX_DEPTH)
+    {
+        statsStack[statsDepth].phase = phase;
+        statsStack[statsDepth].start = now;
+        statsPhaseDepth[phase]++;
+        statsMark = now;
+    }
+    statsDepth++;
+    return TMX_TRUE;
+}
+
+void
+tmxStatsEnd(TMX_PHASE phase, size_t bytes)
+{
+    TMXphasestats *stats = &tmxStatsTarget->phases[phase];
+    stats->bytes += bytes;
+    stats->count++;
+
+    TMX_ASSERT(statsDepth > 0);
+    if (--statsDepth >= TMX_STATS_MAX_DEPTH)
+        return;
+
+    double now = tmxTimeNow();
+    TMX_ASSERT(statsStack[statsDepth].phase == phase);
+    stats->self_seconds += now - statsMark;
+    statsMark = now;
+
+    // Only the outermost frame of a phase contributes to the inclusive time, so recursion is not counted twice.
+    if (--statsPhaseDepth[phase] == 0)
+        stats->seconds += now - statsStack[statsDepth].start;
+
+    if (statsDepth == 0)
+        tmxStatsTarget->seconds = now - statsStack[0].start;
+}
+
+void
+tmxStatsAlloc(size_t size)
+{
+    // Only allocations made during a load are attributed to it.
+    if (!statsDepth)
+        return;
+    tmxStatsTarget->allocations++;
+    tmxStatsTarget->allocated_bytes += size;
+}
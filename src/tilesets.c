@@ -0,0 +1,161 @@
+#include "internal.h"
+
+/**
+ * @brief Computes the size of the image of a tileset, falling back to the extent of its tiles when not specified.
+ */
+static TMXsize
+tmxTilesetImageSize(const TMXtileset *tileset)
+{
+    TMXsize size = {0, 0};
+    if (tileset->image && tileset->image->size.w > 0 && tileset->image->size.h > 0)
+        return tileset->image->size;
+
+    if (tileset->columns > 0)
+    {
+        int rows = (int) ((tileset->tile_count + (size_t) tileset->columns - 1) / (size_t) tileset->columns);
+        size.w   = tileset->margin * 2 + tileset->columns * tileset->tile_size.w + (tileset->columns - 1) * tileset->spacing;
+        size.h   = tileset->margin * 2 + rows * tileset->tile_size.h + TMX_MAX(rows - 1, 0) * tileset->spacing;
+    }
+    return size;
+}
+
+const TMXtilerects *
+tmxTilesetRects(TMXtileset *tileset)
+{
+    if (!tileset)
+    {
+        tmxError(TMX_ERR_VALUE);
+        return NULL;
+    }
+
+    // Image tilesets have a tile for each ID, while the IDs of a collection may have gaps.
+    size_t i, id, count = 0;
+    for (i = 0; i < tileset->tile_count && tileset->tiles; i++)
+        count = TMX_MAX(count, (size_t) tileset->tiles[i].id + 1);
+
+    size_t ints   = TMX_VIEW_ALIGN(count, int);
+    size_t floats = TMX_VIEW_ALIGN(count, float);
+    size_t size   = TMX_VIEW_ALIGN(1, TMXtilerects) + ints * 4 + floats * 4 + TMX_VIEW_ALIGN(count, const TMXimage *);
+
+    // The table and its arrays are a single block, so it can be replaced or freed as a whole.
+    TMXtilerects *rects = tmxMallocCategory(size, TMX_MEMORY_TILESETS);
+    if (!rects)
+        return NULL;
+    memset(rects, 0, size);
+
+    unsigned char *block = (unsigned char *) rects + TMX_VIEW_ALIGN(1, TMXtilerects);
+    rects->count         = count;
+    rects->x             = (int *) block;
+    rects->y             = (int *) (block += ints);
+    rects->width         = (int *) (block += ints);
+    rects->height        = (int *) (block += ints);
+    rects->u0            = (float *) (block += ints);
+    rects->v0            = (float *) (block += floats);
+    rects->u1            = (float *) (block += floats);
+    rects->v1            = (float *) (block += floats);
+    rects->images        = (const TMXimage **) (block += floats);
+
+    TMXsize tilesetSize = tmxTilesetImageSize(tileset);
+    for (i = 0; i < tileset->tile_count && tileset->tiles; i++)
+    {
+        const TMXtile *tile = &tileset->tiles[i];
+        const TMXimage *image;
+        TMXsize imageSize;
+        TMXrect rect = tile->rect;
+
+        if (tile->image)
+        {
+            // A tile of a collection uses its whole image unless a sub-rectangle is defined.
+            image     = tile->image;
+            imageSize = image->size;
+            if (rect.w <= 0 || rect.h <= 0)
+            {
+                rect.w = imageSize.w;
+                rect.h = imageSize.h;
+            }
+        }
+        else
+        {
+            image     = tileset->image;
+            imageSize = tilesetSize;
+        }
+
+        id                = tile->id;
+        rects->x[id]      = rect.x;
+        rects->y[id]      = rect.y;
+        rects->width[id]  = rect.w;
+        rects->height[id] = rect.h;
+        rects->images[id] = image;
+        if (imageSize.w > 0 && imageSize.h > 0)
+        {
+            rects->u0[id] = (float) rect.x / (float) imageSize.w;
+            rects->v0[id] = (float) rect.y / (float) imageSize.h;
+            rects->u1[id] = (float) (rect.x + rect.w) / (float) imageSize.w;
+            rects->v1[id] = (float) (rect.y + rect.h) / (float) imageSize.h;
+        }
+    }
+
+    tmxFree(tileset->rects);
+    tileset->rects = rects;
+    return rects;
+}
+
+TMXtileset *
+tmxMapTileset(const TMXmap *map, TMXgid gid, TMXtid *id)
+{
+    if (!map)
+    {
+        tmxError(TMX_ERR_VALUE);
+        return NULL;
+    }
+
+    gid &= TMX_GID_TILE_MASK;
+    if (!gid || !map->tileset_count)
+        return NULL;
+
+    // Tilesets are ordered by their first GID, so find the last one that begins at or before the GID.
+    size_t low = 0, high = map->tileset_count;
+    while (high - low > 1)
+    {
+        size_t mid = low + (high - low) / 2;
+        if (map->tilesets[mid].first_gid <= gid)
+            low = mid;
+        else
+            high = mid;
+    }
+
+    const TMXmaptileset *entry = &map->tilesets[low];
+    if (gid < entry->first_gid || !entry->tileset)
+        return NULL;
+
+    TMXtid local = gid - entry->first_gid;
+    size_t count = entry->tileset->rects ? entry->tileset->rects->count : entry->tileset->tile_count;
+    if (local >= count)
+        return NULL;
+
+    if (id)
+        *id = local;
+    return entry->tileset;
+}
+
+TMXtile *
+tmxTilesetTile(const TMXtileset *tileset, TMXtid id)
+{
+    if (!tileset->tiles)
+        return NULL;
+
+    // Tiles of an image tileset are indexed by ID, while Tiled writes the tiles of a collection ordered by ID.
+    if (tileset->columns > 0)
+        return id < tileset->tile_count ? &tileset->tiles[id] : NULL;
+
+    size_t low = 0, high = tileset->tile_count;
+    while (low < high)
+    {
+        size_t mid = low + (high - low) / 2;
+        if (tileset->tiles[mid].id < id)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    return low < tileset->tile_count && tileset->tiles[low].id == id ? &tileset->tiles[low] : NULL;
+}
@@ -0,0 +1,153 @@
+#include "internal.h"
+#include "tmx/trace.h"
+#include <stdio.h>
+#include <string.h>
+
+TMX_BOOL tmxTraceActive;
+
+#ifdef TMX_TRACE
+
+#define TMX_TRACE_MAX_DEPTH  32
+#define TMX_TRACE_MAX_DETAIL 128
+
+struct TMXtraceframe
+{
+    const char *name;
+    char detail[TMX_TRACE_MAX_DETAIL];
+    double start;
+};
+
+static FILE *traceFile;
+static double traceEpoch;
+static size_t traceDepth;
+static struct TMXtraceframe traceStack[TMX_TRACE_MAX_DEPTH];
+
+static void
+tmxTraceWriteString(const char *str)
+{
+    fputc('"', traceFile);
+    for (; *str; str++)
+    {
+        unsigned char c = (unsigned char) *str;
+        if (c == '"' || c == '\\')
+            fprintf(traceFile, "\\%c", c);
+        else if (c < 0x20)
+            fprintf(traceFile, "\\u%04x", c);
+        else
+            fputc(c, traceFile);
+    }
+    fputc('"', traceFile);
+}
+
+TMX_BOOL
+tmxTraceStart(const char *filename)
+{
+    if (tmxTraceActive)
+    {
+        tmxErrorMessage(TMX_ERR_INVALID_OPERATION, "A trace is already active.");
+        return TMX_FALSE;
+    }
+
+    traceFile = fopen(filename, "w");
+    if (!traceFile)
+    {
+        tmxErrorFormat(TMX_ERR_IO, "Failed to open trace file \"%s\".", filename);
+        return TMX_FALSE;
+    }
+
+    traceEpoch     = tmxTimeNow();
+    traceDepth     = 0;
+    tmxTraceActive = TMX_TRUE;
+
+    fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n", traceFile);
+    fputs("{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"tmx\"}}", traceFile);
+    return TMX_TRUE;
+}
+
+void
+tmxTraceStop(void)
+{
+    if (!tmxTraceActive)
+        return;
+
+    // Close any spans left open, i.e. when stopped from within a callback.
+    while (traceDepth)
+        tmxTraceEnd();
+
+    fputs("\n]}\n", traceFile);
+    fclose(traceFile);
+    traceFile      = NULL;
+    tmxTraceActive = TMX_FALSE;
+}
+
+void
+tmxTraceBegin(const char *name, const char *detail)
+{
+    if (traceDepth < TMX_TRACE_MAX_DEPTH)
+    {
+        struct TMXtraceframe *frame = &traceStack[traceDepth];
+        frame->name                 = name;
+        frame->detail[0]            = '\0';
+        if (detail)
+            snprintf(frame->detail, TMX_TRACE_MAX_DETAIL, "%s", detail);
+        frame->start = tmxTimeNow();
+    }
+    traceDepth++;
+}
+
+void
+tmxTraceDetail(const char *detail)
+{
+    if (!traceDepth || traceDepth > TMX_TRACE_MAX_DEPTH || !detail)
+        return;
+    snprintf(traceStack[traceDepth - 1].detail, TMX_TRACE_MAX_DETAIL, "%s", detail);
+}
+
+void
+tmxTraceEnd(void)
+{
+    if (!traceDepth)
+        return;
+
+    // Spans nested beyond the maximum depth are dropped, their time is included in the deepest recorded span.
+    if (--traceDepth >= TMX_TRACE_MAX_DEPTH)
+        return;
+
+    struct TMXtraceframe *frame = &traceStack[traceDepth];
+    double end                  = tmxTimeNow();
+    char name[TMX_TRACE_MAX_DETAIL + 32];
+
+    if (frame->detail[0])
+        snprintf(name, sizeof(name), "%s %s", frame->name, frame->detail);
+    else
+        snprintf(name, sizeof(name), "%s", frame->name);
+
+    fputs(",\n{\"name\":", traceFile);
+    tmxTraceWriteString(name);
+    fprintf(traceFile, ",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":1", frame->name,
+            (frame->start - traceEpoch) * 1e6, (end - frame->start) * 1e6);
+    if (frame->detail[0])
+    {
+        fputs(",\"args\":{\"detail\":", traceFile);
+        tmxTraceWriteString(frame->detail);
+        fputc('}', traceFile);
+    }
+    fputc('}', traceFile);
+}
+
+#else
+
+TMX_BOOL
+tmxTraceStart(const char *filename)
+{
+    TMX_UNUSED(filename);
+    tmxErrorMessage(TMX_ERR_UNSUPPORTED, "Tracing is not enabled, build with the TMX_TRACE option.");
+    return TMX_FALSE;
+}
+
+void
+tmxTraceStop(void)
+{
+}
+
+#endif
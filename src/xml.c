@@ -119,6 +119,11 @@ tmxXmlReadStringContents(TMXxmlreader *xml, const char **contents, size_t *conte
         tmxXmlNextToken(xml);
     }
 
+    // Finish positioned on the closing tag, as the caller expects when an element has been consumed. Otherwise the "<"
+    // that ended the content is where the next read begins, and the end of this element is mistaken for its parent's.
+    while (xml->token == YXML_OK && *xml->str)
+        tmxXmlNextToken(xml);
+
     // Set null-terminator
     *xml->ptr = '\0';
 
@@ -223,9 +228,11 @@ tmxXmlReaderInit(const char *input)
     size_t bufferSize = strlen(input); // TODO
 
     TMXxmlreader *reader;
+    TMX_MEMORY_CATEGORY previousCategory = tmxMemoryCategory(TMX_MEMORY_TEMPORARY);
     reader         = tmxCalloc(1, sizeof(TMXxmlreader));
     reader->buffer = tmxMalloc(bufferSize);
     reader->memory = tmxMalloc(bufferSize);
+    tmxMemoryCategory(previousCategory);
     reader->str    = input;
 
     yxml_init(&reader->reader, reader->memory, bufferSize);